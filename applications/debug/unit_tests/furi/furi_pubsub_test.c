@@ -43,3 +43,105 @@ void test_furi_pubsub() {
     // delete pubsub case
     furi_pubsub_free(test_pubsub);
 }
+
+#define PUBSUB_CHURN_COUNT 200
+#define PUBSUB_CONTEXT_ALIVE 0xA11FE
+#define PUBSUB_CONTEXT_DEAD 0xDEAD
+
+typedef struct {
+    FuriPubSub* pubsub;
+    FuriPubSubSubscription* nested;
+    volatile bool stop;
+    volatile uint32_t published;
+    volatile uint32_t delivered;
+    volatile uint32_t late;
+} PubSubConcurrentContext;
+
+static PubSubConcurrentContext* pubsub_concurrent;
+
+static void test_pubsub_counter_handler(const void* arg, void* ctx) {
+    UNUSED(arg);
+    UNUSED(ctx);
+    pubsub_concurrent->delivered++;
+}
+
+static void test_pubsub_churn_handler(const void* arg, void* ctx) {
+    UNUSED(arg);
+    if(*(volatile uint32_t*)ctx != PUBSUB_CONTEXT_ALIVE) {
+        pubsub_concurrent->late++;
+    }
+}
+
+static void test_pubsub_nested_handler(const void* arg, void* ctx) {
+    UNUSED(ctx);
+    // Subscribing from callback is allowed, takes effect on next message
+    if(*(uint32_t*)arg == notify_value_0 && !pubsub_concurrent->nested) {
+        pubsub_concurrent->nested = furi_pubsub_subscribe(
+            pubsub_concurrent->pubsub, test_pubsub_counter_handler, NULL);
+    }
+}
+
+static int32_t test_pubsub_publisher(void* ctx) {
+    PubSubConcurrentContext* context = ctx;
+    uint32_t value = 0;
+    while(!context->stop) {
+        furi_pubsub_publish(context->pubsub, &value);
+        context->published++;
+        value++;
+        if(value % 16 == 0) furi_delay_tick(1);
+    }
+    return 0;
+}
+
+void test_furi_pubsub_concurrent() {
+    PubSubConcurrentContext context = {0};
+    pubsub_concurrent = &context;
+    context.pubsub = furi_pubsub_alloc();
+
+    // subscribe from callback case
+    FuriPubSubSubscription* nested_subscription =
+        furi_pubsub_subscribe(context.pubsub, test_pubsub_nested_handler, NULL);
+    furi_pubsub_publish(context.pubsub, (void*)&notify_value_0);
+    mu_assert_pointers_not_eq(context.nested, NULL);
+    mu_assert_int_eq(context.delivered, 0);
+    furi_pubsub_publish(context.pubsub, (void*)&notify_value_1);
+    mu_assert_int_eq(context.delivered, 1);
+    furi_pubsub_unsubscribe(context.pubsub, nested_subscription);
+    furi_pubsub_unsubscribe(context.pubsub, context.nested);
+    context.delivered = 0;
+
+    // subscription churn while publishing case
+    FuriPubSubSubscription* counter_subscription =
+        furi_pubsub_subscribe(context.pubsub, test_pubsub_counter_handler, NULL);
+
+    FuriThread* publisher = furi_thread_alloc();
+    furi_thread_set_name(publisher, "PubSubTest");
+    furi_thread_set_stack_size(publisher, 1024);
+    furi_thread_set_context(publisher, &context);
+    furi_thread_set_callback(publisher, test_pubsub_publisher);
+    furi_thread_start(publisher);
+
+    for(size_t i = 0; i < PUBSUB_CHURN_COUNT; i++) {
+        uint32_t* churn_context = malloc(sizeof(uint32_t));
+        *churn_context = PUBSUB_CONTEXT_ALIVE;
+        FuriPubSubSubscription* churn_subscription =
+            furi_pubsub_subscribe(context.pubsub, test_pubsub_churn_handler, churn_context);
+        furi_delay_tick(i % 3);
+        furi_pubsub_unsubscribe(context.pubsub, churn_subscription);
+        // no callback may run past unsubscribe
+        *churn_context = PUBSUB_CONTEXT_DEAD;
+        furi_delay_tick(i % 2);
+        free(churn_context);
+    }
+
+    context.stop = true;
+    furi_thread_join(publisher);
+    furi_thread_free(publisher);
+
+    mu_assert_int_eq(context.late, 0);
+    mu_assert_int_eq(context.delivered, context.published);
+
+    furi_pubsub_unsubscribe(context.pubsub, counter_subscription);
+    furi_pubsub_free(context.pubsub);
+    pubsub_concurrent = NULL;
+}
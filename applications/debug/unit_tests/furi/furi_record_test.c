@@ -1,8 +1,24 @@
 #include <stdio.h>
 #include <string.h>
 #include <furi.h>
+#include <bt/bt_service/bt.h>
+#include <cli/cli.h>
+#include <dialogs/dialogs.h>
+#include <dolphin/dolphin.h>
+#include <gui/gui.h>
+#include <input/input.h>
+#include <loader/loader.h>
+#include <notification/notification.h>
+#include <power/power_service/power.h>
+#include <rpc/rpc.h>
+#include <storage/storage.h>
 #include "../minunit.h"
 
+#define TEST_RECORD_RACE_OPENERS 3
+#define TEST_RECORD_RACE_CYCLES 100
+#define TEST_RECORD_ALIVE 0xA11FE
+#define TEST_RECORD_DEAD 0xDEAD
+
 void test_furi_create_open() {
     // 1. Create record
     uint8_t test_data = 0;
@@ -18,3 +34,98 @@ void test_furi_create_open() {
     // 4. Clean up
     furi_record_destroy("test/holding");
 }
+
+static void test_furi_record_id_check(FuriRecordId id, const char* name) {
+    if(!furi_record_exists(name)) return;
+
+    // Interned name and id must resolve to the same record
+    void* by_name = furi_record_open(name);
+    void* by_id = furi_record_open_id(id);
+    mu_assert_pointers_eq(by_name, by_id);
+    furi_record_close_id(id);
+    furi_record_close(name);
+}
+
+void test_furi_record_id() {
+    test_furi_record_id_check(FuriRecordIdBt, RECORD_BT);
+    test_furi_record_id_check(FuriRecordIdCli, RECORD_CLI);
+    test_furi_record_id_check(FuriRecordIdDialogs, RECORD_DIALOGS);
+    test_furi_record_id_check(FuriRecordIdDolphin, RECORD_DOLPHIN);
+    test_furi_record_id_check(FuriRecordIdGui, RECORD_GUI);
+    test_furi_record_id_check(FuriRecordIdInputEvents, RECORD_INPUT_EVENTS);
+    test_furi_record_id_check(FuriRecordIdLoader, RECORD_LOADER);
+    test_furi_record_id_check(FuriRecordIdNotification, RECORD_NOTIFICATION);
+    test_furi_record_id_check(FuriRecordIdPower, RECORD_POWER);
+    test_furi_record_id_check(FuriRecordIdRpc, RECORD_RPC);
+    test_furi_record_id_check(FuriRecordIdStorage, RECORD_STORAGE);
+
+    mu_check(furi_record_exists(RECORD_STORAGE));
+    mu_check(!furi_record_exists("test/missing"));
+}
+
+typedef struct {
+    volatile bool stop;
+    volatile uint32_t opens;
+    volatile uint32_t dead;
+} TestRecordRace;
+
+static int32_t test_furi_record_race_opener(void* context) {
+    TestRecordRace* race = context;
+    while(!race->stop) {
+        volatile uint32_t* data = furi_record_open("test/race");
+        if(*data != TEST_RECORD_ALIVE) race->dead++;
+        furi_record_close("test/race");
+        race->opens++;
+        if(race->opens % 8 == 0) furi_delay_tick(1);
+    }
+    return 0;
+}
+
+void test_furi_record_race() {
+    TestRecordRace race = {0};
+    FuriThread* openers[TEST_RECORD_RACE_OPENERS];
+
+    uint32_t* data = malloc(sizeof(uint32_t));
+    *data = TEST_RECORD_ALIVE;
+    furi_record_create("test/race", data);
+
+    // destroy must fail while record is held
+    furi_record_open("test/race");
+    mu_check(!furi_record_destroy("test/race"));
+    furi_record_close("test/race");
+
+    for(size_t i = 0; i < TEST_RECORD_RACE_OPENERS; i++) {
+        openers[i] = furi_thread_alloc();
+        furi_thread_set_name(openers[i], "RecordTest");
+        furi_thread_set_stack_size(openers[i], 1024);
+        furi_thread_set_context(openers[i], &race);
+        furi_thread_set_callback(openers[i], test_furi_record_race_opener);
+        furi_thread_start(openers[i]);
+    }
+
+    for(size_t cycle = 0; cycle < TEST_RECORD_RACE_CYCLES;) {
+        if(!furi_record_destroy("test/race")) {
+            furi_delay_tick(1);
+            continue;
+        }
+        // Openers block until record is created again
+        *data = TEST_RECORD_DEAD;
+        furi_delay_tick(cycle % 2);
+        *data = TEST_RECORD_ALIVE;
+        furi_record_create("test/race", data);
+        cycle++;
+    }
+
+    race.stop = true;
+    for(size_t i = 0; i < TEST_RECORD_RACE_OPENERS; i++) {
+        furi_thread_join(openers[i]);
+        furi_thread_free(openers[i]);
+    }
+
+    mu_assert_int_eq(race.dead, 0);
+    mu_check(race.opens > 0);
+
+    mu_check(furi_record_destroy("test/race"));
+    mu_check(!furi_record_exists("test/race"));
+    free(data);
+}
@@ -5,9 +5,16 @@
 
 // v2 tests
 void test_furi_create_open();
+void test_furi_record_id();
+void test_furi_record_race();
 void test_furi_valuemutex();
 void test_furi_concurrent_access();
 void test_furi_pubsub();
+void test_furi_pubsub_concurrent();
+void test_furi_work_queue_priority();
+void test_furi_work_queue_delayed();
+void test_furi_work_queue_resubmit();
+void test_furi_work_queue_heap();
 
 void test_furi_memmgr();
 
@@ -30,6 +37,14 @@ MU_TEST(mu_test_furi_create_open) {
     test_furi_create_open();
 }
 
+MU_TEST(mu_test_furi_record_id) {
+    test_furi_record_id();
+}
+
+MU_TEST(mu_test_furi_record_race) {
+    test_furi_record_race();
+}
+
 MU_TEST(mu_test_furi_valuemutex) {
     test_furi_valuemutex();
 }
@@ -38,6 +53,26 @@ MU_TEST(mu_test_furi_pubsub) {
     test_furi_pubsub();
 }
 
+MU_TEST(mu_test_furi_pubsub_concurrent) {
+    test_furi_pubsub_concurrent();
+}
+
+MU_TEST(mu_test_furi_work_queue_priority) {
+    test_furi_work_queue_priority();
+}
+
+MU_TEST(mu_test_furi_work_queue_delayed) {
+    test_furi_work_queue_delayed();
+}
+
+MU_TEST(mu_test_furi_work_queue_resubmit) {
+    test_furi_work_queue_resubmit();
+}
+
+MU_TEST(mu_test_furi_work_queue_heap) {
+    test_furi_work_queue_heap();
+}
+
 MU_TEST(mu_test_furi_memmgr) {
     // this test is not accurate, but gives a basic understanding
     // that memory management is working fine
@@ -51,8 +86,15 @@ MU_TEST_SUITE(test_suite) {
 
     // v2 tests
     MU_RUN_TEST(mu_test_furi_create_open);
+    MU_RUN_TEST(mu_test_furi_record_id);
+    MU_RUN_TEST(mu_test_furi_record_race);
     MU_RUN_TEST(mu_test_furi_valuemutex);
     MU_RUN_TEST(mu_test_furi_pubsub);
+    MU_RUN_TEST(mu_test_furi_pubsub_concurrent);
+    MU_RUN_TEST(mu_test_furi_work_queue_priority);
+    MU_RUN_TEST(mu_test_furi_work_queue_delayed);
+    MU_RUN_TEST(mu_test_furi_work_queue_resubmit);
+    MU_RUN_TEST(mu_test_furi_work_queue_heap);
     MU_RUN_TEST(mu_test_furi_memmgr);
 }
 
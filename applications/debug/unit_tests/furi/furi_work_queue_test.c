@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <string.h>
+#include <furi.h>
+#include <furi_hal.h>
+#include <core/memmgr.h>
+#include "../minunit.h"
+
+#define TAG "WorkQueueTest"
+
+#define TEST_WORK_COUNT 4
+#define TEST_WORK_RESUBMITS 3
+#define TEST_WORK_LATENCY_ROUNDS 100
+
+typedef struct {
+    FuriSemaphore* gate;
+    char order[TEST_WORK_COUNT + 1];
+    volatile size_t order_pos;
+} TestWorkOrder;
+
+typedef struct {
+    TestWorkOrder* order;
+    char tag;
+} TestWorkTag;
+
+typedef struct {
+    FuriWork* work;
+    FuriSemaphore* done;
+    volatile uint32_t runs;
+    volatile uint32_t started;
+    volatile bool resubmit_failed;
+} TestWorkRun;
+
+static void test_furi_work_gate(void* context) {
+    TestWorkOrder* order = context;
+    furi_semaphore_acquire(order->gate, FuriWaitForever);
+}
+
+static void test_furi_work_order(void* context) {
+    TestWorkTag* tag = context;
+    tag->order->order[tag->order->order_pos++] = tag->tag;
+}
+
+static void test_furi_work_run(void* context) {
+    TestWorkRun* run = context;
+    run->started = DWT->CYCCNT;
+    if(++run->runs < TEST_WORK_RESUBMITS) {
+        // Second submit must see work pending already
+        if(!furi_work_submit(run->work) || furi_work_submit(run->work)) {
+            run->resubmit_failed = true;
+        }
+    } else {
+        furi_semaphore_release(run->done);
+    }
+}
+
+static void test_furi_work_nop(void* context) {
+    UNUSED(context);
+}
+
+static int32_t test_furi_work_thread(void* context) {
+    UNUSED(context);
+    furi_thread_flags_wait(1, FuriFlagWaitAny, FuriWaitForever);
+    return 0;
+}
+
+void test_furi_work_queue_priority() {
+    TestWorkOrder order = {.gate = furi_semaphore_alloc(1, 0)};
+    TestWorkTag tags[TEST_WORK_COUNT] = {
+        {&order, 'l'},
+        {&order, 'n'},
+        {&order, 'h'},
+        {&order, 'H'},
+    };
+    const FuriWorkPriority priorities[TEST_WORK_COUNT] = {
+        FuriWorkPriorityLow,
+        FuriWorkPriorityNormal,
+        FuriWorkPriorityHigh,
+        FuriWorkPriorityHigh,
+    };
+
+    // Single worker is held by gate work until everything is queued
+    FuriWorkQueue* queue = furi_work_queue_alloc("WorkQueueTest", 1, 1024);
+    FuriWork* gate = furi_work_alloc(queue, test_furi_work_gate, &order);
+    mu_check(furi_work_submit(gate));
+    furi_delay_tick(10);
+
+    FuriWork* works[TEST_WORK_COUNT];
+    for(size_t i = 0; i < TEST_WORK_COUNT; i++) {
+        works[i] = furi_work_alloc(queue, test_furi_work_order, &tags[i]);
+        furi_work_set_priority(works[i], priorities[i]);
+        mu_check(furi_work_submit(works[i]));
+    }
+    mu_check(!furi_work_submit(works[0]));
+
+    // Cancelled work leaves queue and never runs
+    mu_check(furi_work_cancel(works[1]));
+    mu_check(!furi_work_is_pending(works[1]));
+    mu_check(!furi_work_cancel(works[1]));
+
+    furi_semaphore_release(order.gate);
+    while(order.order_pos < TEST_WORK_COUNT - 1) furi_delay_tick(1);
+    furi_delay_tick(10);
+    mu_assert_string_eq("hHl", order.order);
+
+    for(size_t i = 0; i < TEST_WORK_COUNT; i++) {
+        furi_work_free(works[i]);
+    }
+    furi_work_free(gate);
+    furi_work_queue_free(queue);
+    furi_semaphore_free(order.gate);
+}
+
+void test_furi_work_queue_delayed() {
+    TestWorkRun run = {.done = furi_semaphore_alloc(1, 0), .runs = TEST_WORK_RESUBMITS - 1};
+    run.work = furi_work_alloc(furi_work_queue_get_system(), test_furi_work_run, &run);
+
+    // Cancelled before firing
+    mu_check(furi_work_submit_delayed(run.work, 20));
+    mu_check(furi_work_is_pending(run.work));
+    mu_check(furi_work_cancel(run.work));
+    furi_delay_tick(40);
+    mu_assert_int_eq(TEST_WORK_RESUBMITS - 1, run.runs);
+
+    // Fires after delay
+    uint32_t start = furi_get_tick();
+    mu_check(furi_work_submit_delayed(run.work, 50));
+    mu_check(!furi_work_submit_delayed(run.work, 10));
+    mu_assert_int_eq(FuriStatusOk, furi_semaphore_acquire(run.done, 1000));
+    mu_check(furi_get_tick() - start >= 50);
+    mu_assert_int_eq(TEST_WORK_RESUBMITS, run.runs);
+
+    furi_work_free(run.work);
+    furi_semaphore_free(run.done);
+}
+
+void test_furi_work_queue_resubmit() {
+    TestWorkRun run = {.done = furi_semaphore_alloc(1, 0)};
+    run.work = furi_work_alloc(furi_work_queue_get_system(), test_furi_work_run, &run);
+
+    // Callback submits itself again until enough runs are done
+    mu_check(furi_work_submit(run.work));
+    mu_assert_int_eq(FuriStatusOk, furi_semaphore_acquire(run.done, 1000));
+    mu_assert_int_eq(TEST_WORK_RESUBMITS, run.runs);
+    mu_check(!run.resubmit_failed);
+
+    // Latency from submit to callback start
+    uint32_t latency_max = 0;
+    uint32_t latency_sum = 0;
+    for(size_t i = 0; i < TEST_WORK_LATENCY_ROUNDS; i++) {
+        run.runs = TEST_WORK_RESUBMITS - 1;
+        uint32_t submitted = DWT->CYCCNT;
+        furi_work_submit(run.work);
+        furi_semaphore_acquire(run.done, FuriWaitForever);
+        uint32_t latency = run.started - submitted;
+        latency_sum += latency;
+        if(latency > latency_max) latency_max = latency;
+    }
+    FURI_LOG_I(
+        TAG,
+        "Submit to callback: avg %lu us, max %lu us",
+        latency_sum / TEST_WORK_LATENCY_ROUNDS / furi_hal_cortex_instructions_per_microsecond(),
+        latency_max / furi_hal_cortex_instructions_per_microsecond());
+
+    furi_work_free(run.work);
+    furi_semaphore_free(run.done);
+}
+
+void test_furi_work_queue_heap() {
+    // Heap taken by deferred work compared to dedicated worker thread
+    size_t heap_before = memmgr_get_free_heap();
+    FuriWork* work = furi_work_alloc(furi_work_queue_get_system(), test_furi_work_nop, NULL);
+    size_t work_heap = heap_before - memmgr_get_free_heap();
+    furi_work_free(work);
+
+    heap_before = memmgr_get_free_heap();
+    FuriThread* thread =
+        furi_thread_alloc_ex("WorkQueueTest", 2048, test_furi_work_thread, NULL);
+    furi_thread_start(thread);
+    size_t thread_heap = heap_before - memmgr_get_free_heap();
+    furi_thread_flags_set(furi_thread_get_id(thread), 1);
+    furi_thread_join(thread);
+    furi_thread_free(thread);
+
+    FURI_LOG_I(TAG, "Heap: work %u bytes, 2K worker thread %u bytes", work_heap, thread_heap);
+    mu_check(work_heap < thread_heap);
+}
@@ -0,0 +1,92 @@
+#include <furi.h>
+#include "../minunit.h"
+#include <toolbox/protocols/protocol_dict.h>
+#include <one_wire/ibutton/protocols/ibutton_protocols.h>
+
+#define IBUTTON_TEST_DATA_SIZE 4
+#define IBUTTON_TEST_CYFRAL_FRAME (9 * 4 * 2)
+#define IBUTTON_TEST_METAKOM_FRAME (1 + 3 * 2 + 32 * 2)
+
+/*
+ * Replays encoder output as comparator sees it, starting at given frame phase:
+ * adjacent equal levels are merged. Returns decoded protocol or PROTOCOL_NO
+ * if nothing is decoded within three frames.
+ */
+static ProtocolId ibutton_test_replay(
+    ProtocolDict* encoders,
+    ProtocolDict* decoders,
+    iButtonProtocol protocol,
+    size_t frame,
+    size_t phase) {
+    protocol_dict_encoder_start(encoders, protocol);
+    for(size_t i = 0; i < phase; i++) {
+        protocol_dict_encoder_yield(encoders, protocol);
+    }
+
+    protocol_dict_decoders_start(decoders);
+
+    ProtocolId decoded = PROTOCOL_NO;
+    LevelDuration segment = protocol_dict_encoder_yield(encoders, protocol);
+    bool level = level_duration_get_level(segment);
+    uint32_t duration = level_duration_get_duration(segment);
+
+    for(size_t i = 1; i < frame * 3 && decoded == PROTOCOL_NO; i++) {
+        segment = protocol_dict_encoder_yield(encoders, protocol);
+        if(level_duration_get_level(segment) == level) {
+            duration += level_duration_get_duration(segment);
+        } else {
+            decoded = protocol_dict_decoders_feed(decoders, level, duration);
+            level = level_duration_get_level(segment);
+            duration = level_duration_get_duration(segment);
+        }
+    }
+
+    return decoded;
+}
+
+static void ibutton_test_read_any_phase(
+    iButtonProtocol protocol,
+    size_t frame,
+    const uint8_t* data,
+    size_t data_size) {
+    ProtocolDict* encoders = protocol_dict_alloc(ibutton_protocols, iButtonProtocolMax);
+    ProtocolDict* decoders = protocol_dict_alloc(ibutton_protocols, iButtonProtocolMax);
+    mu_assert_int_eq(data_size, protocol_dict_get_data_size(encoders, protocol));
+
+    protocol_dict_set_data(encoders, protocol, data, data_size);
+
+    for(size_t phase = 0; phase < frame; phase++) {
+        ProtocolId decoded = ibutton_test_replay(encoders, decoders, protocol, frame, phase);
+        mu_assert_int_eq(protocol, decoded);
+
+        uint8_t received_data[IBUTTON_TEST_DATA_SIZE] = {0};
+        protocol_dict_get_data(decoders, decoded, received_data, data_size);
+        mu_assert_mem_eq(data, received_data, data_size);
+    }
+
+    protocol_dict_free(encoders);
+    protocol_dict_free(decoders);
+}
+
+MU_TEST(test_ibutton_protocol_cyfral_read_any_phase) {
+    const uint8_t data[] = {0x50, 0x1D};
+    ibutton_test_read_any_phase(
+        iButtonProtocolCyfral, IBUTTON_TEST_CYFRAL_FRAME, data, sizeof(data));
+}
+
+MU_TEST(test_ibutton_protocol_metakom_read_any_phase) {
+    // every byte has even parity
+    const uint8_t data[] = {0xD1, 0x69, 0xA6, 0x5A};
+    ibutton_test_read_any_phase(
+        iButtonProtocolMetakom, IBUTTON_TEST_METAKOM_FRAME, data, sizeof(data));
+}
+
+MU_TEST_SUITE(test_ibutton_protocols_suite) {
+    MU_RUN_TEST(test_ibutton_protocol_cyfral_read_any_phase);
+    MU_RUN_TEST(test_ibutton_protocol_metakom_read_any_phase);
+}
+
+int run_minunit_test_ibutton_protocols() {
+    MU_RUN_SUITE(test_ibutton_protocols_suite);
+    return MU_EXIT_CODE;
+}
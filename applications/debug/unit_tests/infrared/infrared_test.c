@@ -1,6 +1,8 @@
 #include <furi.h>
+#include <furi_hal.h>
 #include <flipper_format.h>
 #include <infrared.h>
+#include <infrared_raw.h>
 #include <common/infrared_common_i.h>
 #include "../minunit.h"
 
@@ -511,6 +513,118 @@ MU_TEST(infrared_test_encoder_decoder_all) {
     infrared_test_run_encoder_decoder(InfraredProtocolKaseikyo, 1);
 }
 
+/* Runs decoder over decoder_input vector and checks that foreign decoders were skipped */
+static void
+    infrared_test_run_decoder_dispatch(InfraredProtocol protocol, InfraredProtocol foreign) {
+    uint32_t* timings;
+    uint32_t timings_count;
+
+    mu_assert(
+        infrared_test_prepare_file(infrared_get_protocol_name(protocol)),
+        "Failed to prepare test file");
+    mu_assert(
+        infrared_test_load_raw_signal(test->ff, "decoder_input1", &timings, &timings_count),
+        "Failed to load raw signal from file");
+    flipper_format_buffered_file_close(test->ff);
+
+    InfraredDecoderHandler* decoder = infrared_alloc_decoder();
+    bool level = false;
+
+    uint32_t time = DWT->CYCCNT;
+    for(uint32_t i = 0; i < timings_count; ++i) {
+        if(timings[i] > INFRARED_RAW_RX_TIMING_DELAY_US) {
+            infrared_check_decoder_ready(decoder);
+        }
+        infrared_decode(decoder, level, timings[i]);
+        level = !level;
+    }
+    time = (DWT->CYCCNT - time) / furi_hal_cortex_instructions_per_microsecond();
+
+    uint32_t total_edges = infrared_get_decoder_total_edge_count(decoder);
+    uint32_t own_edges = infrared_get_decoder_edge_count(decoder, protocol);
+    uint32_t foreign_edges = infrared_get_decoder_edge_count(decoder, foreign);
+    FURI_LOG_I(
+        "InfraredTest",
+        "%s: %lu timings in %lu us, own decoder %lu, %s decoder %lu",
+        infrared_get_protocol_name(protocol),
+        total_edges,
+        time,
+        own_edges,
+        infrared_get_protocol_name(foreign),
+        foreign_edges);
+
+    mu_assert_int_eq(timings_count, total_edges);
+    mu_check(own_edges > 0);
+    mu_check(foreign_edges < total_edges);
+
+    infrared_free_decoder(decoder);
+    free(timings);
+}
+
+MU_TEST(infrared_test_decoder_dispatch) {
+    infrared_test_run_decoder_dispatch(InfraredProtocolNEC, InfraredProtocolSIRC);
+    infrared_test_run_decoder_dispatch(InfraredProtocolSamsung32, InfraredProtocolKaseikyo);
+    infrared_test_run_decoder_dispatch(InfraredProtocolSIRC, InfraredProtocolNEC);
+    infrared_test_run_decoder_dispatch(InfraredProtocolKaseikyo, InfraredProtocolRC6);
+}
+
+/* Builds a pulse-distance frame repeated `repeats` times, with per-timing jitter */
+static size_t infrared_test_fill_raw_frames(
+    uint32_t* timings,
+    uint8_t command,
+    size_t repeats,
+    uint32_t jitter) {
+    size_t size = 0;
+    for(size_t repeat = 0; repeat < repeats; ++repeat) {
+        timings[size++] = 9000 + jitter;
+        timings[size++] = 4500 - jitter;
+        for(size_t bit = 0; bit < 8; ++bit) {
+            timings[size++] = 560 + ((bit + repeat) % 3) * jitter;
+            timings[size++] = ((command >> bit) & 1) ? 1690 - jitter : 560 + jitter;
+        }
+        timings[size++] = 560 - jitter;
+        if(repeat + 1 < repeats) {
+            timings[size++] = 40000 + repeat * jitter;
+        }
+    }
+    return size;
+}
+
+MU_TEST(infrared_test_raw_normalize) {
+    uint32_t timings_a[64];
+    uint32_t timings_b[64];
+    uint32_t timings_c[64];
+
+    size_t size_a = infrared_test_fill_raw_frames(timings_a, 0xA5, 3, 40);
+    size_t size_b = infrared_test_fill_raw_frames(timings_b, 0xA5, 1, 0);
+    size_t size_c = infrared_test_fill_raw_frames(timings_c, 0x5A, 3, 20);
+    mu_assert_int_eq(59, size_a);
+    mu_assert_int_eq(19, size_b);
+
+    size_a = infrared_raw_normalize(timings_a, size_a);
+    size_b = infrared_raw_normalize(timings_b, size_b);
+    size_c = infrared_raw_normalize(timings_c, size_c);
+
+    /* Repeated frames are collapsed into a single one */
+    mu_assert_int_eq(19, size_a);
+    mu_assert_int_eq(19, size_c);
+
+    mu_check(infrared_raw_is_similar(timings_a, size_a, timings_b, size_b));
+    mu_check(
+        infrared_raw_get_fingerprint(timings_a, size_a) ==
+        infrared_raw_get_fingerprint(timings_b, size_b));
+
+    mu_check(!infrared_raw_is_similar(timings_a, size_a, timings_c, size_c));
+    mu_check(
+        infrared_raw_get_fingerprint(timings_a, size_a) !=
+        infrared_raw_get_fingerprint(timings_c, size_c));
+
+    /* Normalization is idempotent */
+    memcpy(timings_c, timings_a, size_a * sizeof(uint32_t));
+    mu_assert_int_eq(size_a, infrared_raw_normalize(timings_c, size_a));
+    mu_check(!memcmp(timings_a, timings_c, size_a * sizeof(uint32_t)));
+}
+
 MU_TEST_SUITE(infrared_test) {
     MU_SUITE_CONFIGURE(&infrared_test_alloc, &infrared_test_free);
 
@@ -529,6 +643,8 @@ MU_TEST_SUITE(infrared_test) {
     MU_RUN_TEST(infrared_test_decoder_kaseikyo);
     MU_RUN_TEST(infrared_test_decoder_mixed);
     MU_RUN_TEST(infrared_test_encoder_decoder_all);
+    MU_RUN_TEST(infrared_test_decoder_dispatch);
+    MU_RUN_TEST(infrared_test_raw_normalize);
 }
 
 int run_minunit_test_infrared() {
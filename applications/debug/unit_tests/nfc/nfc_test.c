@@ -7,6 +7,8 @@
 #include <lib/digital_signal/digital_signal.h>
 #include <lib/nfc/nfc_device.h>
 #include <lib/nfc/helpers/nfc_generators.h>
+#include <lib/nfc/helpers/nfc_crc.h>
+#include <lib/nfc/protocols/nfc_util.h>
 
 #include <lib/flipper_format/flipper_format_i.h>
 #include <lib/toolbox/stream/file_stream.h>
@@ -112,7 +114,6 @@ static bool nfc_test_digital_signal_test_encode(
         time = DWT->CYCCNT;
         nfca_signal_encode(
             nfc_test->signal, nfc_test->test_data, nfc_test->test_data_len * 8, parity);
-        digital_signal_prepare_arr(nfc_test->signal->tx_signal);
         time = (DWT->CYCCNT - time) / furi_hal_cortex_instructions_per_microsecond();
         FURI_CRITICAL_EXIT();
 
@@ -179,6 +180,96 @@ MU_TEST(nfc_digital_signal_test) {
         "NFC long digital signal test failed\r\n");
 }
 
+MU_TEST(nfc_signal_cache_test) {
+    uint8_t data[] = {0x44, 0x00};
+    uint8_t parity[1] = {0x80};
+    DigitalSignal* tx_signal = nfc_test->signal->tx_signal;
+
+    // Reference frame encoded without cache
+    nfca_signal_encode(nfc_test->signal, data, sizeof(data) * 8, parity);
+    uint32_t edge_cnt = tx_signal->edge_cnt;
+    uint32_t* ref = malloc(edge_cnt * sizeof(uint32_t));
+    memcpy(ref, tx_signal->reload_reg_buff, edge_cnt * sizeof(uint32_t));
+
+    mu_assert(
+        nfca_signal_cache_add(nfc_test->signal, data, sizeof(data) * 8, parity),
+        "nfca_signal_cache_add == true assert failed\r\n");
+
+    // Other frame must not be served from cache
+    uint8_t other[] = {0x04, 0x00};
+    nfca_signal_encode(nfc_test->signal, other, sizeof(other) * 8, parity);
+    mu_assert(
+        memcmp(tx_signal->reload_reg_buff, ref, edge_cnt * sizeof(uint32_t)) != 0,
+        "other frame encoded from cache\r\n");
+
+    nfca_signal_encode(nfc_test->signal, data, sizeof(data) * 8, parity);
+    mu_assert(tx_signal->edge_cnt == edge_cnt, "cached frame edge count mismatch\r\n");
+    mu_assert(
+        memcmp(tx_signal->reload_reg_buff, ref, edge_cnt * sizeof(uint32_t)) == 0,
+        "cached frame reload values mismatch\r\n");
+
+    free(ref);
+}
+
+// Bitwise CRC update as it was done before tables
+static uint16_t nfc_test_crc16_bitwise(uint16_t crc, const uint8_t* data, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i] ^ (uint8_t)(crc & 0xff);
+        byte ^= byte << 4;
+        crc = (crc >> 8) ^ (((uint16_t)byte) << 8) ^ (((uint16_t)byte) << 3) ^
+              (((uint16_t)byte) >> 4);
+    }
+    return crc;
+}
+
+MU_TEST(nfc_crc_test) {
+    // ISO/IEC 14443-3 examples
+    uint8_t crc_a_data[] = {0x12, 0x34, 0x00, 0x00};
+    nfc_crc_a_append(crc_a_data, 2);
+    mu_assert(crc_a_data[2] == 0x26 && crc_a_data[3] == 0xCF, "CRC_A 0x12 0x34 mismatch\r\n");
+    uint8_t crc_b_data[] = {0x0F, 0xAA, 0xFF, 0x00, 0x00};
+    nfc_crc_b_append(crc_b_data, 3);
+    mu_assert(crc_b_data[3] == 0xFC && crc_b_data[4] == 0xD1, "CRC_B 0x0F 0xAA 0xFF mismatch\r\n");
+
+    uint8_t data[64];
+    for(size_t i = 0; i < sizeof(data); i++) {
+        data[i] = rand();
+    }
+    for(size_t len = 0; len <= sizeof(data); len++) {
+        mu_assert_int_eq(nfc_test_crc16_bitwise(NFC_CRC_A_INIT, data, len), nfc_crc_a(data, len));
+        mu_assert_int_eq(
+            (uint16_t)~nfc_test_crc16_bitwise(NFC_CRC_B_INIT, data, len), nfc_crc_b(data, len));
+        mu_assert_int_eq(
+            nfc_test_crc16_bitwise(NFC_CRC_ICLASS_INIT, data, len), nfc_crc_iclass(data, len));
+    }
+
+    // Incremental update equals CRC over whole changed frame
+    uint16_t crc_a = nfc_crc_a(data, sizeof(data));
+    uint16_t crc_b = nfc_crc_b(data, sizeof(data));
+    for(size_t i = 0; i < sizeof(data); i++) {
+        uint8_t new_byte = rand();
+        size_t bytes_after = sizeof(data) - i - 1;
+        crc_a = nfc_crc16_patch(crc_a, data[i], new_byte, bytes_after);
+        crc_b = nfc_crc16_patch(crc_b, data[i], new_byte, bytes_after);
+        data[i] = new_byte;
+        mu_assert_int_eq(nfc_crc_a(data, sizeof(data)), crc_a);
+        mu_assert_int_eq(nfc_crc_b(data, sizeof(data)), crc_b);
+    }
+}
+
+MU_TEST(nfc_parity_test) {
+    for(size_t i = 0; i < 1000; i++) {
+        uint32_t value = rand();
+        mu_assert_int_eq(__builtin_parity(value), nfc_util_even_parity32(value));
+    }
+
+    uint8_t data[] = {0x00, 0x01, 0x03, 0x07, 0xFF, 0x80, 0x7F, 0x54, 0x55};
+    uint8_t parity[2] = {};
+    nfc_util_odd_parity(data, parity, sizeof(data));
+    mu_assert_int_eq(0xA8, parity[0]);
+    mu_assert_int_eq(0x80, parity[1]);
+}
+
 MU_TEST(mf_classic_dict_test) {
     MfClassicDict* instance = NULL;
     uint64_t key = 0;
@@ -491,6 +582,9 @@ MU_TEST_SUITE(nfc) {
     MU_RUN_TEST(mf_classic_1k_7b_file_test);
     MU_RUN_TEST(mf_classic_4k_7b_file_test);
     MU_RUN_TEST(nfc_digital_signal_test);
+    MU_RUN_TEST(nfc_signal_cache_test);
+    MU_RUN_TEST(nfc_crc_test);
+    MU_RUN_TEST(nfc_parity_test);
     MU_RUN_TEST(mf_classic_dict_test);
     MU_RUN_TEST(mf_classic_dict_load_test);
 
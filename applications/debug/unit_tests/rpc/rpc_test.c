@@ -18,6 +18,7 @@
 #include <cli/cli.h>
 #include <loader/loader.h>
 #include <protobuf_version.h>
+#include <furi_hal_compress.h>
 #include <semphr.h>
 
 LIST_DEF(MsgList, PB_Main, M_POD_OPLIST)
@@ -44,7 +45,8 @@ static RpcSessionContext rpc_session[TEST_RPC_SESSIONS];
 #define TAG "UnitTestsRpc"
 #define MAX_RECEIVE_OUTPUT_TIMEOUT 3000
 #define MAX_NAME_LENGTH 255
-#define MAX_DATA_SIZE 512u // have to be exact as in rpc_storage.c
+#define MAX_DATA_SIZE RPC_TRANSFER_CHUNK_SIZE_DEFAULT // have to be exact as in rpc_storage.c
+#define COMPRESS_OUTPUT_SIZE(size) ((size) + (size) / 8 + 8) // same as in rpc_storage.c
 #define TEST_DIR TEST_DIR_NAME "/"
 #define TEST_DIR_NAME EXT_PATH("unit_tests_tmp")
 #define MD5SUM_SIZE 16
@@ -719,10 +721,14 @@ static void
 static void test_rpc_add_read_to_list_by_reading_real_file(
     MsgList_t msg_list,
     const char* path,
-    uint32_t command_id) {
+    uint32_t command_id,
+    size_t chunk_size,
+    bool compressed) {
     furi_check(MsgList_empty_p(msg_list));
     Storage* fs_api = furi_record_open(RECORD_STORAGE);
     File* file = storage_file_alloc(fs_api);
+    FuriHalCompress* compress = compressed ? furi_hal_compress_alloc(chunk_size) : NULL;
+    uint8_t* read_buffer = compressed ? malloc(chunk_size) : NULL;
 
     bool result = false;
 
@@ -737,15 +743,24 @@ static void test_rpc_add_read_to_list_by_reading_real_file(
             response->which_content = PB_Main_storage_read_response_tag;
             response->content.storage_read_response.has_file = true;
 
+            size_t read_size = MIN(size_left, chunk_size);
+            size_t data_size = compressed ? COMPRESS_OUTPUT_SIZE(read_size) : read_size;
             response->content.storage_read_response.file.data =
-                malloc(PB_BYTES_ARRAY_T_ALLOCSIZE(MIN(size_left, MAX_DATA_SIZE)));
+                malloc(PB_BYTES_ARRAY_T_ALLOCSIZE(data_size));
             uint8_t* buffer = response->content.storage_read_response.file.data->bytes;
             uint16_t* read_size_msg = &response->content.storage_read_response.file.data->size;
-            size_t read_size = MIN(size_left, MAX_DATA_SIZE);
-            *read_size_msg = storage_file_read(file, buffer, read_size);
+            uint8_t* read_to = compressed ? read_buffer : buffer;
+            *read_size_msg = storage_file_read(file, read_to, read_size);
             size_left -= read_size;
             result = (*read_size_msg == read_size);
 
+            if(result && compressed) {
+                size_t encoded_size = 0;
+                result = furi_hal_compress_encode(
+                    compress, read_buffer, read_size, buffer, data_size, &encoded_size);
+                *read_size_msg = encoded_size;
+            }
+
             if(result) {
                 response->has_next = (size_left > 0);
             }
@@ -759,18 +774,27 @@ static void test_rpc_add_read_to_list_by_reading_real_file(
         test_rpc_add_empty_to_list(msg_list, test_rpc_storage_get_file_error(file), command_id);
     }
 
+    if(compressed) {
+        furi_hal_compress_free(compress);
+        free(read_buffer);
+    }
     storage_file_close(file);
     storage_file_free(file);
 
     furi_record_close(RECORD_STORAGE);
 }
 
-static void test_storage_read_run(const char* path, uint32_t command_id) {
+static void test_storage_read_run_ex(
+    const char* path,
+    uint32_t command_id,
+    size_t chunk_size,
+    bool compressed) {
     PB_Main request;
     MsgList_t expected_msg_list;
     MsgList_init(expected_msg_list);
 
-    test_rpc_add_read_to_list_by_reading_real_file(expected_msg_list, path, command_id);
+    test_rpc_add_read_to_list_by_reading_real_file(
+        expected_msg_list, path, command_id, chunk_size, compressed);
     test_rpc_create_simple_message(&request, PB_Main_storage_read_request_tag, path, command_id);
     test_rpc_encode_and_feed_one(&request, 0);
     test_rpc_decode_and_compare(expected_msg_list, 0);
@@ -779,6 +803,10 @@ static void test_storage_read_run(const char* path, uint32_t command_id) {
     test_rpc_free_msg_list(expected_msg_list);
 }
 
+static void test_storage_read_run(const char* path, uint32_t command_id) {
+    test_storage_read_run_ex(path, command_id, MAX_DATA_SIZE, false);
+}
+
 static bool test_is_exists(const char* path) {
     Storage* fs_api = furi_record_open(RECORD_STORAGE);
     FileInfo fileinfo;
@@ -925,6 +953,20 @@ MU_TEST(test_storage_read) {
     test_storage_read_run(TEST_DIR "file4.txt", ++command_id);
 }
 
+MU_TEST(test_storage_read_transfer_options) {
+    test_create_file(TEST_DIR "file5.txt", (MAX_DATA_SIZE * 9) + 1);
+
+    rpc_session_set_transfer_chunk_size(rpc_session[0].session, MAX_DATA_SIZE * 4);
+    test_storage_read_run_ex(TEST_DIR "file5.txt", ++command_id, MAX_DATA_SIZE * 4, false);
+
+    rpc_session_set_transfer_compression(rpc_session[0].session, true);
+    test_storage_read_run_ex(TEST_DIR "file5.txt", ++command_id, MAX_DATA_SIZE * 4, true);
+
+    rpc_session_set_transfer_chunk_size(rpc_session[0].session, RPC_TRANSFER_CHUNK_SIZE_DEFAULT);
+    rpc_session_set_transfer_compression(rpc_session[0].session, false);
+    test_storage_read_run(TEST_DIR "file5.txt", ++command_id);
+}
+
 static void test_storage_write_run(
     const char* path,
     size_t write_size,
@@ -1317,6 +1359,25 @@ MU_TEST(test_storage_md5sum) {
     test_storage_md5sum_run(TEST_DIR "file3.txt", ++command_id, md5sum3, PB_CommandStatus_OK);
     test_storage_md5sum_run(TEST_DIR "file1.txt", ++command_id, md5sum1, PB_CommandStatus_OK);
     test_storage_md5sum_run(TEST_DIR "file2.txt", ++command_id, md5sum2, PB_CommandStatus_OK);
+
+    /* Same size, new contents: cached digest must not be returned */
+    Storage* fs_api = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(fs_api);
+    furi_check(storage_file_open(file, TEST_DIR "file3.txt", FSAM_WRITE, FSOM_OPEN_EXISTING));
+    furi_check(storage_file_write(file, "X", 1) == 1);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    test_storage_calculate_md5sum(TEST_DIR "file3.txt", md5sum3, MD5SUM_SIZE * 2 + 1);
+    test_storage_md5sum_run(TEST_DIR "file3.txt", ++command_id, md5sum3, PB_CommandStatus_OK);
+    test_storage_md5sum_run(TEST_DIR "file3.txt", ++command_id, md5sum3, PB_CommandStatus_OK);
+
+    /* Larger than one read chunk, hashed with read-ahead */
+    test_create_file(TEST_DIR "file4.txt", 10000);
+    test_storage_calculate_md5sum(TEST_DIR "file4.txt", md5sum1, MD5SUM_SIZE * 2 + 1);
+    test_storage_md5sum_run(TEST_DIR "file4.txt", ++command_id, md5sum1, PB_CommandStatus_OK);
+    test_storage_md5sum_run(TEST_DIR "file4.txt", ++command_id, md5sum1, PB_CommandStatus_OK);
 }
 
 static void test_rpc_storage_rename_run(
@@ -1435,6 +1496,7 @@ MU_TEST_SUITE(test_rpc_storage) {
     MU_RUN_TEST(test_storage_stat);
     MU_RUN_TEST(test_storage_list);
     MU_RUN_TEST(test_storage_read);
+    MU_RUN_TEST(test_storage_read_transfer_options);
     MU_RUN_TEST(test_storage_write_read);
     MU_RUN_TEST(test_storage_write);
     MU_RUN_TEST(test_storage_delete);
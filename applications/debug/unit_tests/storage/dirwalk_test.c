@@ -254,6 +254,85 @@ MU_TEST_1(test_dirwalk_filter, Storage* storage) {
     storage_test_paths_free(paths);
 }
 
+MU_TEST_1(test_dirwalk_parent_first, Storage* storage) {
+    FuriString* path;
+    path = furi_string_alloc();
+    FuriString* parent;
+    parent = furi_string_alloc();
+    FileInfo fileinfo;
+
+    StorageTestPathDict_t* paths =
+        storage_test_paths_alloc(storage_test_dirwalk_full, COUNT_OF(storage_test_dirwalk_full));
+
+    DirWalk* dir_walk = dir_walk_alloc(storage);
+    mu_check(dir_walk_open(dir_walk, EXT_PATH("dirwalk")));
+
+    while(dir_walk_read(dir_walk, path, &fileinfo) == DirWalkOK) {
+        furi_string_right(path, strlen(EXT_PATH("dirwalk/")));
+
+        // directory must be returned before its contents
+        size_t last_char = furi_string_search_rchar(path, '/');
+        if(last_char != FURI_STRING_FAILURE) {
+            furi_string_set_n(parent, path, 0, last_char);
+            StorageTestPath* record = StorageTestPathDict_get(*paths, parent);
+            mu_check(record && record->visited);
+        }
+
+        mu_check(storage_test_paths_mark(paths, path, (fileinfo.flags & FSF_DIRECTORY)));
+    }
+
+    mu_check(dir_walk_get_error(dir_walk) == FSE_NOT_EXIST);
+
+    dir_walk_free(dir_walk);
+    furi_string_free(parent);
+    furi_string_free(path);
+
+    mu_check(storage_test_paths_check(paths) == false);
+
+    storage_test_paths_free(paths);
+}
+
+static void test_dir_read_batch_size(Storage* storage, size_t buffer_size) {
+    StorageTestPathDict_t* paths = storage_test_paths_alloc(
+        storage_test_dirwalk_no_recursive, COUNT_OF(storage_test_dirwalk_no_recursive));
+    FuriString* name;
+    name = furi_string_alloc();
+    uint8_t* batch = malloc(buffer_size);
+    uint16_t count;
+
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_dir_open(file, EXT_PATH("dirwalk")));
+
+    while((count = storage_dir_read_batch(file, batch, buffer_size))) {
+        mu_check(count <= buffer_size / STORAGE_DIR_RECORD_SIZE(0));
+        StorageDirRecord* record = (StorageDirRecord*)batch;
+        for(uint16_t i = 0; i < count; i++, record = storage_dir_record_next(record)) {
+            mu_check(record->record_size == STORAGE_DIR_RECORD_SIZE(strlen(record->name)));
+            furi_string_set(name, record->name);
+            mu_check(
+                storage_test_paths_mark(paths, name, (record->fileinfo.flags & FSF_DIRECTORY)));
+        }
+    }
+
+    mu_check(storage_file_get_error(file) == FSE_NOT_EXIST);
+
+    storage_dir_close(file);
+    storage_file_free(file);
+    free(batch);
+    furi_string_free(name);
+
+    mu_check(storage_test_paths_check(paths) == false);
+
+    storage_test_paths_free(paths);
+}
+
+MU_TEST_1(test_dir_read_batch, Storage* storage) {
+    // one record per call
+    test_dir_read_batch_size(storage, STORAGE_DIR_RECORD_MAX_SIZE);
+    // whole directory in one call
+    test_dir_read_batch_size(storage, 2048);
+}
+
 MU_TEST_SUITE(test_dirwalk_suite) {
     Storage* storage = furi_record_open(RECORD_STORAGE);
     storage_dirs_create(storage, EXT_PATH("dirwalk"));
@@ -261,6 +340,8 @@ MU_TEST_SUITE(test_dirwalk_suite) {
     MU_RUN_TEST_1(test_dirwalk_full, storage);
     MU_RUN_TEST_1(test_dirwalk_no_recursive, storage);
     MU_RUN_TEST_1(test_dirwalk_filter, storage);
+    MU_RUN_TEST_1(test_dirwalk_parent_first, storage);
+    MU_RUN_TEST_1(test_dir_read_batch, storage);
 
     storage_simply_remove_recursive(storage, EXT_PATH("dirwalk"));
     furi_record_close(RECORD_STORAGE);
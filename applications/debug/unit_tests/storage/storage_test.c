@@ -1,6 +1,10 @@
 #include "../minunit.h"
 #include <furi.h>
 #include <storage/storage.h>
+#include <update_util/lfs_backup.h>
+#include <toolbox/tar/tar_archive.h>
+#include <toolbox/tar/tar_stream.h>
+#include <heatshrink_encoder.h>
 
 #define STORAGE_LOCKED_FILE EXT_PATH("locked_file.test")
 #define STORAGE_LOCKED_DIR STORAGE_INT_PATH_PREFIX
@@ -293,19 +297,277 @@ MU_TEST(storage_dir_rename) {
     furi_record_close(RECORD_STORAGE);
 }
 
+MU_TEST(storage_rename_exist) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    mu_check(write_file_13DA(storage, EXT_PATH("file.old")));
+    mu_check(write_file_13DA(storage, EXT_PATH("file.new")));
+    mu_assert_int_eq(
+        FSE_EXIST, storage_common_rename(storage, EXT_PATH("file.old"), EXT_PATH("file.new")));
+    mu_check(check_file_13DA(storage, EXT_PATH("file.old")));
+    mu_assert_int_eq(FSE_OK, storage_common_remove(storage, EXT_PATH("file.old")));
+    mu_assert_int_eq(FSE_OK, storage_common_remove(storage, EXT_PATH("file.new")));
+
+    storage_dir_create(storage, EXT_PATH("dir.old"));
+    mu_assert_int_eq(
+        FSE_INVALID_PARAMETER,
+        storage_common_copy(storage, EXT_PATH("dir.old"), EXT_PATH("dir.old/dir.new")));
+    storage_dir_remove(storage, EXT_PATH("dir.old"));
+
+    furi_record_close(RECORD_STORAGE);
+}
+
+typedef struct {
+    uint64_t copied;
+    uint64_t total;
+    bool cancel;
+} StorageTestCopyProgress;
+
+static bool storage_test_copy_callback(uint64_t copied, uint64_t total, void* context) {
+    StorageTestCopyProgress* progress = context;
+    progress->copied = copied;
+    progress->total = total;
+    return !progress->cancel;
+}
+
+MU_TEST(storage_dir_move_between_storages) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    StorageTestCopyProgress progress = {0};
+
+    storage_dir_create(storage, EXT_PATH("dir.old"));
+
+    mu_assert_int_eq(
+        FSE_OK,
+        storage_common_move(
+            storage,
+            EXT_PATH("dir.old"),
+            INT_PATH("dir.new"),
+            storage_test_copy_callback,
+            &progress));
+    mu_assert_int_eq(FSE_NOT_EXIST, storage_common_stat(storage, EXT_PATH("dir.old"), NULL));
+    mu_check(storage_dir_rename_check(storage, INT_PATH("dir.new")));
+    mu_assert_int_eq(COUNT_OF(storage_copy_test_files) * 4, progress.total);
+    mu_assert_int_eq(progress.total, progress.copied);
+
+    mu_assert_int_eq(
+        FSE_OK, storage_common_rename(storage, INT_PATH("dir.new"), EXT_PATH("dir.new")));
+    mu_assert_int_eq(FSE_NOT_EXIST, storage_common_stat(storage, INT_PATH("dir.new"), NULL));
+    mu_check(storage_dir_rename_check(storage, EXT_PATH("dir.new")));
+
+    storage_dir_remove(storage, EXT_PATH("dir.new"));
+    furi_record_close(RECORD_STORAGE);
+}
+
+MU_TEST(storage_file_copy_cancel) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    StorageTestCopyProgress progress = {.cancel = true};
+
+    mu_check(write_file_13DA(storage, EXT_PATH("file.old")));
+    mu_assert_int_eq(
+        FSE_DENIED,
+        storage_common_copy_ex(
+            storage,
+            EXT_PATH("file.old"),
+            INT_PATH("file.new"),
+            storage_test_copy_callback,
+            &progress));
+    mu_assert_int_eq(4, progress.copied);
+    // partially written file is removed, source is kept
+    mu_assert_int_eq(FSE_NOT_EXIST, storage_common_stat(storage, INT_PATH("file.new"), NULL));
+    mu_check(check_file_13DA(storage, EXT_PATH("file.old")));
+    mu_assert_int_eq(FSE_OK, storage_common_remove(storage, EXT_PATH("file.old")));
+
+    furi_record_close(RECORD_STORAGE);
+}
+
 MU_TEST_SUITE(storage_rename) {
     MU_RUN_TEST(storage_file_rename);
     MU_RUN_TEST(storage_dir_rename);
+    MU_RUN_TEST(storage_rename_exist);
+    MU_RUN_TEST(storage_dir_move_between_storages);
+    MU_RUN_TEST(storage_file_copy_cancel);
 
     Storage* storage = furi_record_open(RECORD_STORAGE);
     storage_dir_remove(storage, EXT_PATH("dir.old"));
     storage_dir_remove(storage, EXT_PATH("dir.new"));
+    storage_dir_remove(storage, INT_PATH("dir.new"));
+    furi_record_close(RECORD_STORAGE);
+}
+
+#define STORAGE_BACKUP_ARCHIVE EXT_PATH(".backup_test.tar")
+#define STORAGE_BACKUP_MANIFEST STORAGE_BACKUP_ARCHIVE LFS_BACKUP_MANIFEST_SUFFIX
+#define STORAGE_BACKUP_FILE INT_PATH(".backup_test")
+
+static uint64_t storage_test_file_size(Storage* storage, const char* path) {
+    FileInfo fileinfo = {0};
+    storage_common_stat(storage, path, &fileinfo);
+    return fileinfo.size;
+}
+
+MU_TEST(storage_lfs_backup_incremental) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    mu_check(write_file_13DA(storage, STORAGE_BACKUP_FILE));
+    mu_check(lfs_backup_create_incremental(storage, STORAGE_BACKUP_ARCHIVE, NULL, NULL));
+    mu_assert_int_eq(FSE_OK, storage_common_stat(storage, STORAGE_BACKUP_MANIFEST, NULL));
+    uint64_t full_size = storage_test_file_size(storage, STORAGE_BACKUP_ARCHIVE);
+
+    // nothing changed: archive is left as is
+    mu_check(lfs_backup_create_incremental(storage, STORAGE_BACKUP_ARCHIVE, NULL, NULL));
+    mu_assert_int_eq(full_size, storage_test_file_size(storage, STORAGE_BACKUP_ARCHIVE));
+
+    // same size, other contents: only that file is appended, header and one record
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_file_open(file, STORAGE_BACKUP_FILE, FSAM_WRITE, FSOM_CREATE_ALWAYS));
+    mu_check(storage_file_write(file, "ABCD", 4) == 4);
+    storage_file_close(file);
+    mu_check(lfs_backup_create_incremental(storage, STORAGE_BACKUP_ARCHIVE, NULL, NULL));
+    mu_assert_int_eq(full_size + 1024, storage_test_file_size(storage, STORAGE_BACKUP_ARCHIVE));
+
+    // restore brings back latest version
+    mu_check(write_file_13DA(storage, STORAGE_BACKUP_FILE));
+    mu_check(lfs_backup_unpack_incremental(storage, STORAGE_BACKUP_ARCHIVE, NULL, NULL));
+    mu_check(storage_file_open(file, STORAGE_BACKUP_FILE, FSAM_READ, FSOM_OPEN_EXISTING));
+    char data[4] = {0};
+    mu_check(storage_file_read(file, data, 4) == 4);
+    mu_check(memcmp(data, "ABCD", 4) == 0);
+    storage_file_close(file);
+    storage_file_free(file);
+
+    storage_simply_remove(storage, STORAGE_BACKUP_FILE);
+    storage_simply_remove(storage, STORAGE_BACKUP_ARCHIVE);
+    storage_simply_remove(storage, STORAGE_BACKUP_MANIFEST);
+    furi_record_close(RECORD_STORAGE);
+}
+
+MU_TEST_SUITE(storage_lfs_backup) {
+    MU_RUN_TEST(storage_lfs_backup_incremental);
+}
+
+#define STORAGE_TAR_ARCHIVE EXT_PATH(".tar_test.tar")
+#define STORAGE_TAR_COMPRESSED EXT_PATH(".tar_test" TAR_HEATSHRINK_EXTENSION)
+#define STORAGE_TAR_UNPACKED EXT_PATH(".tar_test")
+#define STORAGE_TAR_FILE_SIZE 5000
+#define STORAGE_TAR_WINDOW_SZ2 8
+#define STORAGE_TAR_LOOKAHEAD_SZ2 4
+
+static bool storage_test_tar_compress(Storage* storage, const char* source, const char* dest) {
+    File* file = storage_file_alloc(storage);
+    uint8_t* input = malloc(4 * STORAGE_TAR_FILE_SIZE);
+    size_t input_size = 0;
+    if(storage_file_open(file, source, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        input_size = storage_file_read(file, input, 4 * STORAGE_TAR_FILE_SIZE);
+    }
+    storage_file_close(file);
+
+    uint8_t* output = malloc(8 * STORAGE_TAR_FILE_SIZE);
+    TarHeatshrinkHeader* header = (TarHeatshrinkHeader*)output;
+    header->magic = TAR_HEATSHRINK_MAGIC;
+    header->version = TAR_HEATSHRINK_VERSION;
+    header->window_sz2 = STORAGE_TAR_WINDOW_SZ2;
+    header->lookahead_sz2 = STORAGE_TAR_LOOKAHEAD_SZ2;
+    size_t output_size = sizeof(TarHeatshrinkHeader);
+
+    uint8_t* window = malloc(2 << STORAGE_TAR_WINDOW_SZ2);
+    heatshrink_encoder* encoder =
+        heatshrink_encoder_alloc(window, STORAGE_TAR_WINDOW_SZ2, STORAGE_TAR_LOOKAHEAD_SZ2);
+    size_t input_pos = 0;
+    size_t size = 0;
+    while(input_pos < input_size) {
+        heatshrink_encoder_sink(encoder, input + input_pos, input_size - input_pos, &size);
+        input_pos += size;
+        while(heatshrink_encoder_poll(
+                  encoder, output + output_size, 8 * STORAGE_TAR_FILE_SIZE - output_size, &size) ==
+              HSER_POLL_MORE) {
+            output_size += size;
+        }
+        output_size += size;
+    }
+    while(heatshrink_encoder_finish(encoder) == HSER_FINISH_MORE) {
+        heatshrink_encoder_poll(
+            encoder, output + output_size, 8 * STORAGE_TAR_FILE_SIZE - output_size, &size);
+        output_size += size;
+    }
+    heatshrink_encoder_free(encoder);
+    free(window);
+
+    bool success = input_size && storage_file_open(file, dest, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, output, output_size) == output_size;
+    storage_file_free(file);
+    free(output);
+    free(input);
+    return success;
+}
+
+static void storage_test_tar_check_unpacked(Storage* storage, const uint8_t* expected) {
+    File* file = storage_file_alloc(storage);
+    uint8_t* data = malloc(STORAGE_TAR_FILE_SIZE);
+    mu_check(storage_file_open(
+        file, STORAGE_TAR_UNPACKED "/dir/file", FSAM_READ, FSOM_OPEN_EXISTING));
+    mu_assert_int_eq(STORAGE_TAR_FILE_SIZE, storage_file_size(file));
+    mu_assert_int_eq(STORAGE_TAR_FILE_SIZE, storage_file_read(file, data, STORAGE_TAR_FILE_SIZE));
+    mu_check(memcmp(data, expected, STORAGE_TAR_FILE_SIZE) == 0);
+    storage_file_free(file);
+    free(data);
+    storage_simply_remove_recursive(storage, STORAGE_TAR_UNPACKED);
+}
+
+MU_TEST(storage_tar_heatshrink) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    uint8_t* data = malloc(STORAGE_TAR_FILE_SIZE);
+    for(size_t i = 0; i < STORAGE_TAR_FILE_SIZE; i++) {
+        data[i] = (i % 97) ^ (i >> 8);
+    }
+
+    // written in small pieces, tar stream coalesces them
+    TarArchive* archive = tar_archive_alloc(storage);
+    mu_check(tar_archive_open(archive, STORAGE_TAR_ARCHIVE, TAR_OPEN_MODE_WRITE));
+    mu_check(tar_archive_dir_add_element(archive, "dir"));
+    mu_check(tar_archive_file_add_header(archive, "dir/file", STORAGE_TAR_FILE_SIZE));
+    for(size_t offset = 0; offset < STORAGE_TAR_FILE_SIZE; offset += 100) {
+        mu_check(tar_archive_file_add_data_block(archive, data + offset, 100));
+    }
+    mu_check(tar_archive_file_finalize(archive));
+    mu_check(tar_archive_finalize(archive));
+    tar_archive_free(archive);
+
+    mu_check(storage_test_tar_compress(storage, STORAGE_TAR_ARCHIVE, STORAGE_TAR_COMPRESSED));
+    mu_assert_int_eq(
+        TAR_OPEN_MODE_READ_HEATSHRINK, tar_archive_get_mode_for_path(STORAGE_TAR_COMPRESSED));
+    mu_assert_int_eq(TAR_OPEN_MODE_READ, tar_archive_get_mode_for_path(STORAGE_TAR_ARCHIVE));
+
+    const char* archives[] = {STORAGE_TAR_ARCHIVE, STORAGE_TAR_COMPRESSED};
+    for(size_t i = 0; i < COUNT_OF(archives); i++) {
+        archive = tar_archive_alloc(storage);
+        mu_check(
+            tar_archive_open(archive, archives[i], tar_archive_get_mode_for_path(archives[i])));
+        // second pass rewinds, compressed stream is decoded again
+        mu_assert_int_eq(2, tar_archive_get_entries_count(archive));
+        mu_check(tar_archive_unpack_to(archive, STORAGE_TAR_UNPACKED, NULL));
+        tar_archive_free(archive);
+        storage_test_tar_check_unpacked(storage, data);
+    }
+
+    // plain tar is not accepted as compressed one
+    archive = tar_archive_alloc(storage);
+    mu_check(!tar_archive_open(archive, STORAGE_TAR_ARCHIVE, TAR_OPEN_MODE_READ_HEATSHRINK));
+    tar_archive_free(archive);
+
+    free(data);
+    storage_simply_remove(storage, STORAGE_TAR_ARCHIVE);
+    storage_simply_remove(storage, STORAGE_TAR_COMPRESSED);
     furi_record_close(RECORD_STORAGE);
 }
 
+MU_TEST_SUITE(storage_tar) {
+    MU_RUN_TEST(storage_tar_heatshrink);
+}
+
 int run_minunit_test_storage() {
     MU_RUN_SUITE(storage_file);
     MU_RUN_SUITE(storage_dir);
     MU_RUN_SUITE(storage_rename);
+    MU_RUN_SUITE(storage_lfs_backup);
+    MU_RUN_SUITE(storage_tar);
     return MU_EXIT_CODE;
 }
@@ -22,6 +22,7 @@ int run_minunit_test_dirwalk();
 int run_minunit_test_power();
 int run_minunit_test_protocol_dict();
 int run_minunit_test_lfrfid_protocols();
+int run_minunit_test_ibutton_protocols();
 int run_minunit_test_nfc();
 int run_minunit_test_bit_lib();
 int run_minunit_test_bt();
@@ -49,6 +50,7 @@ const UnitTest unit_tests[] = {
     {.name = "power", .entry = run_minunit_test_power},
     {.name = "protocol_dict", .entry = run_minunit_test_protocol_dict},
     {.name = "lfrfid", .entry = run_minunit_test_lfrfid_protocols},
+    {.name = "ibutton", .entry = run_minunit_test_ibutton_protocols},
     {.name = "bit_lib", .entry = run_minunit_test_bit_lib},
     {.name = "bt", .entry = run_minunit_test_bt},
 };
@@ -401,6 +401,7 @@ void infrared_signal_received_callback(void* context, InfraredWorkerSignal* rece
             timings_size,
             INFRARED_COMMON_CARRIER_FREQUENCY,
             INFRARED_COMMON_DUTY_CYCLE);
+        infrared_signal_normalize(infrared->received_signal);
     }
 
     view_dispatcher_send_custom_event(
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <m-array.h>
+#include <m-dict.h>
 #include <toolbox/path.h>
 #include <storage/storage.h>
 #include <core/common_defines.h>
@@ -11,9 +12,11 @@
 #define TAG "InfraredRemote"
 
 ARRAY_DEF(InfraredButtonArray, InfraredRemoteButton*, M_PTR_OPLIST);
+DICT_DEF2(InfraredFingerprintDict, uint32_t, M_DEFAULT_OPLIST, size_t, M_DEFAULT_OPLIST)
 
 struct InfraredRemote {
     InfraredButtonArray_t buttons;
+    InfraredFingerprintDict_t fingerprints;
     FuriString* name;
     FuriString* path;
 };
@@ -25,11 +28,29 @@ static void infrared_remote_clear_buttons(InfraredRemote* remote) {
         infrared_remote_button_free(*InfraredButtonArray_cref(it));
     }
     InfraredButtonArray_reset(remote->buttons);
+    InfraredFingerprintDict_reset(remote->fingerprints);
+}
+
+static void infrared_remote_index_button(InfraredRemote* remote, size_t index) {
+    InfraredRemoteButton* button = *InfraredButtonArray_get(remote->buttons, index);
+    uint32_t fingerprint =
+        infrared_signal_get_fingerprint(infrared_remote_button_get_signal(button));
+    if(!InfraredFingerprintDict_get(remote->fingerprints, fingerprint)) {
+        InfraredFingerprintDict_set_at(remote->fingerprints, fingerprint, index);
+    }
+}
+
+static void infrared_remote_reindex_buttons(InfraredRemote* remote) {
+    InfraredFingerprintDict_reset(remote->fingerprints);
+    for(size_t i = 0; i < InfraredButtonArray_size(remote->buttons); i++) {
+        infrared_remote_index_button(remote, i);
+    }
 }
 
 InfraredRemote* infrared_remote_alloc() {
     InfraredRemote* remote = malloc(sizeof(InfraredRemote));
     InfraredButtonArray_init(remote->buttons);
+    InfraredFingerprintDict_init(remote->fingerprints);
     remote->name = furi_string_alloc();
     remote->path = furi_string_alloc();
     return remote;
@@ -38,6 +59,7 @@ InfraredRemote* infrared_remote_alloc() {
 void infrared_remote_free(InfraredRemote* remote) {
     infrared_remote_clear_buttons(remote);
     InfraredButtonArray_clear(remote->buttons);
+    InfraredFingerprintDict_clear(remote->fingerprints);
     furi_string_free(remote->path);
     furi_string_free(remote->name);
     free(remote);
@@ -85,11 +107,39 @@ bool infrared_remote_find_button_by_name(InfraredRemote* remote, const char* nam
     return false;
 }
 
+bool infrared_remote_find_button_by_signal(
+    InfraredRemote* remote,
+    InfraredSignal* signal,
+    size_t* index) {
+    const size_t* found =
+        InfraredFingerprintDict_get(remote->fingerprints, infrared_signal_get_fingerprint(signal));
+    if(found) {
+        InfraredRemoteButton* button = *InfraredButtonArray_get(remote->buttons, *found);
+        if(infrared_signal_is_similar(infrared_remote_button_get_signal(button), signal)) {
+            *index = *found;
+            return true;
+        }
+    }
+
+    /* Fingerprint is only a fast path: a capture with timings near the symbol
+     * boundaries or a collision misses it, so fall back to comparing every button */
+    for(size_t i = 0; i < InfraredButtonArray_size(remote->buttons); i++) {
+        if(found && (i == *found)) continue;
+        InfraredRemoteButton* button = *InfraredButtonArray_get(remote->buttons, i);
+        if(infrared_signal_is_similar(infrared_remote_button_get_signal(button), signal)) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool infrared_remote_add_button(InfraredRemote* remote, const char* name, InfraredSignal* signal) {
     InfraredRemoteButton* button = infrared_remote_button_alloc();
     infrared_remote_button_set_name(button, name);
     infrared_remote_button_set_signal(button, signal);
     InfraredButtonArray_push_back(remote->buttons, button);
+    infrared_remote_index_button(remote, InfraredButtonArray_size(remote->buttons) - 1);
     return infrared_remote_store(remote);
 }
 
@@ -105,6 +155,7 @@ bool infrared_remote_delete_button(InfraredRemote* remote, size_t index) {
     InfraredRemoteButton* button;
     InfraredButtonArray_pop_at(&button, remote->buttons, index);
     infrared_remote_button_free(button);
+    infrared_remote_reindex_buttons(remote);
     return infrared_remote_store(remote);
 }
 
@@ -165,6 +216,8 @@ bool infrared_remote_load(InfraredRemote* remote, FuriString* path) {
             if(can_read) {
                 infrared_remote_button_set_name(button, furi_string_get_cstr(buf));
                 InfraredButtonArray_push_back(remote->buttons, button);
+                infrared_remote_index_button(
+                    remote, InfraredButtonArray_size(remote->buttons) - 1);
             } else {
                 infrared_remote_button_free(button);
             }
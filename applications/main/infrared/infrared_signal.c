@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <core/check.h>
+#include <infrared_raw.h>
 #include <infrared_worker.h>
 #include <infrared_transmit.h>
 
@@ -223,6 +224,47 @@ InfraredRawSignal* infrared_signal_get_raw_signal(InfraredSignal* signal) {
     return &signal->payload.raw;
 }
 
+void infrared_signal_normalize(InfraredSignal* signal) {
+    if(!signal->is_raw) return;
+
+    InfraredRawSignal* raw = &signal->payload.raw;
+    size_t timings_size = infrared_raw_normalize(raw->timings, raw->timings_size);
+
+    if(timings_size < raw->timings_size) {
+        FURI_LOG_D(TAG, "Normalized %u timings to %u", raw->timings_size, timings_size);
+        raw->timings_size = timings_size;
+        raw->timings = realloc(raw->timings, timings_size * sizeof(uint32_t));
+    }
+}
+
+uint32_t infrared_signal_get_fingerprint(InfraredSignal* signal) {
+    if(signal->is_raw) {
+        const InfraredRawSignal* raw = &signal->payload.raw;
+        return infrared_raw_get_fingerprint(raw->timings, raw->timings_size);
+    } else {
+        const InfraredMessage* message = &signal->payload.message;
+        return (message->protocol << 24) ^ (message->address * 2654435761UL) ^ message->command;
+    }
+}
+
+bool infrared_signal_is_similar(InfraredSignal* signal, InfraredSignal* other) {
+    if(signal->is_raw != other->is_raw) {
+        return false;
+    } else if(signal->is_raw) {
+        const InfraredRawSignal* raw = &signal->payload.raw;
+        const InfraredRawSignal* other_raw = &other->payload.raw;
+        return (raw->frequency == other_raw->frequency) &&
+               infrared_raw_is_similar(
+                   raw->timings, raw->timings_size, other_raw->timings, other_raw->timings_size);
+    } else {
+        const InfraredMessage* message = &signal->payload.message;
+        const InfraredMessage* other_message = &other->payload.message;
+        return (message->protocol == other_message->protocol) &&
+               (message->address == other_message->address) &&
+               (message->command == other_message->command);
+    }
+}
+
 void infrared_signal_set_message(InfraredSignal* signal, const InfraredMessage* message) {
     infrared_signal_clear_timings(signal);
 
@@ -32,6 +32,10 @@ void infrared_signal_set_raw_signal(
     float duty_cycle);
 InfraredRawSignal* infrared_signal_get_raw_signal(InfraredSignal* signal);
 
+void infrared_signal_normalize(InfraredSignal* signal);
+uint32_t infrared_signal_get_fingerprint(InfraredSignal* signal);
+bool infrared_signal_is_similar(InfraredSignal* signal, InfraredSignal* other);
+
 void infrared_signal_set_message(InfraredSignal* signal, const InfraredMessage* message);
 InfraredMessage* infrared_signal_get_message(InfraredSignal* signal);
 
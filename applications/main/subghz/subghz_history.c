@@ -1,17 +1,64 @@
 #include "subghz_history.h"
 #include <lib/subghz/receiver.h>
-#include <lib/subghz/protocols/came.h>
+#include <lib/subghz/blocks/generic.h>
+#include <lib/flipper_format/flipper_format_i.h>
+#include <lib/toolbox/stream/stream.h>
 
 #include <furi.h>
 
-#define SUBGHZ_HISTORY_MAX 50
+#define SUBGHZ_HISTORY_MAX 300
 #define TAG "SubGhzHistory"
 
 typedef struct {
-    FuriString* item_str;
-    FlipperFormat* flipper_string;
-    uint8_t type;
-    SubGhzRadioPreset* preset;
+    FuriString* name;
+    uint8_t* data;
+    size_t data_size;
+} SubGhzHistoryPreset;
+
+ARRAY_DEF(SubGhzHistoryPresetArray, SubGhzHistoryPreset, M_POD_OPLIST)
+
+#define M_OPL_SubGhzHistoryPresetArray_t() ARRAY_OPLIST(SubGhzHistoryPresetArray, M_POD_OPLIST)
+
+ARRAY_DEF(SubGhzHistoryStringArray, FuriString*, M_PTR_OPLIST)
+
+#define M_OPL_SubGhzHistoryStringArray_t() ARRAY_OPLIST(SubGhzHistoryStringArray, M_PTR_OPLIST)
+
+typedef enum {
+    SubGhzHistoryFieldTypeUint32,
+    SubGhzHistoryFieldTypeHex64,
+    SubGhzHistoryFieldTypeString, /**< Value is index in shared strings */
+} SubGhzHistoryFieldType;
+
+/** Protocol specific field written after Bit and Key */
+typedef struct {
+    const char* key;
+    SubGhzHistoryFieldType type;
+} SubGhzHistoryField;
+
+static const SubGhzHistoryField subghz_history_fields[] = {
+    {"TE", SubGhzHistoryFieldTypeUint32},
+    {"Duration_Counter", SubGhzHistoryFieldTypeUint32},
+    {"Manufacture", SubGhzHistoryFieldTypeString},
+    {"Secplus_packet_1", SubGhzHistoryFieldTypeHex64},
+};
+
+#define SUBGHZ_HISTORY_FIELD_NONE UINT8_MAX
+
+/** Compact history record, serialized to FlipperFormat only on demand
+ * Bit, Key and one known protocol field are kept in binary form, other
+ * protocols keep their full serialized text in `extra`
+ */
+typedef struct {
+    const SubGhzProtocol* protocol;
+    FuriString* extra;
+    uint64_t key;
+    uint64_t field_value;
+    uint32_t frequency;
+    uint32_t timestamp;
+    float rssi;
+    uint8_t preset_index;
+    uint8_t bit_count;
+    uint8_t field;
 } SubGhzHistoryItem;
 
 ARRAY_DEF(SubGhzHistoryItemArray, SubGhzHistoryItem, M_POD_OPLIST)
@@ -20,6 +67,8 @@ ARRAY_DEF(SubGhzHistoryItemArray, SubGhzHistoryItem, M_POD_OPLIST)
 
 typedef struct {
     SubGhzHistoryItemArray_t data;
+    SubGhzHistoryPresetArray_t presets;
+    SubGhzHistoryStringArray_t strings;
 } SubGhzHistoryStruct;
 
 struct SubGhzHistory {
@@ -27,63 +76,127 @@ struct SubGhzHistory {
     uint16_t last_index_write;
     uint8_t code_last_hash_data;
     FuriString* tmp_string;
+    FlipperFormat* flipper_string;
+    FlipperFormat* flipper_string_check;
+    SubGhzRadioPreset preset;
     SubGhzHistoryStruct* history;
 };
 
 SubGhzHistory* subghz_history_alloc(void) {
     SubGhzHistory* instance = malloc(sizeof(SubGhzHistory));
     instance->tmp_string = furi_string_alloc();
+    instance->flipper_string = flipper_format_string_alloc();
+    instance->flipper_string_check = flipper_format_string_alloc();
+    instance->preset.name = furi_string_alloc();
     instance->history = malloc(sizeof(SubGhzHistoryStruct));
     SubGhzHistoryItemArray_init(instance->history->data);
+    SubGhzHistoryPresetArray_init(instance->history->presets);
+    SubGhzHistoryStringArray_init(instance->history->strings);
     return instance;
 }
 
-void subghz_history_free(SubGhzHistory* instance) {
-    furi_assert(instance);
-    furi_string_free(instance->tmp_string);
+static void subghz_history_clean(SubGhzHistory* instance) {
     for
         M_EACH(item, instance->history->data, SubGhzHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
+            if(item->extra) {
+                furi_string_free(item->extra);
+            }
         }
+    SubGhzHistoryItemArray_reset(instance->history->data);
+    for
+        M_EACH(preset, instance->history->presets, SubGhzHistoryPresetArray_t) {
+            furi_string_free(preset->name);
+        }
+    SubGhzHistoryPresetArray_reset(instance->history->presets);
+    for
+        M_EACH(string, instance->history->strings, SubGhzHistoryStringArray_t) {
+            furi_string_free(*string);
+        }
+    SubGhzHistoryStringArray_reset(instance->history->strings);
+}
+
+void subghz_history_free(SubGhzHistory* instance) {
+    furi_assert(instance);
+    subghz_history_clean(instance);
+    furi_string_free(instance->tmp_string);
+    flipper_format_free(instance->flipper_string);
+    flipper_format_free(instance->flipper_string_check);
+    furi_string_free(instance->preset.name);
     SubGhzHistoryItemArray_clear(instance->history->data);
+    SubGhzHistoryPresetArray_clear(instance->history->presets);
+    SubGhzHistoryStringArray_clear(instance->history->strings);
     free(instance->history);
     free(instance);
 }
 
+static SubGhzHistoryPreset* subghz_history_get_item_preset(SubGhzHistory* instance, uint16_t idx) {
+    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
+    return SubGhzHistoryPresetArray_get(instance->history->presets, item->preset_index);
+}
+
+static uint8_t subghz_history_add_preset(SubGhzHistory* instance, SubGhzRadioPreset* preset) {
+    // Only a handful of presets is used during one session, so they are shared by all items
+    size_t preset_count = SubGhzHistoryPresetArray_size(instance->history->presets);
+    for(size_t i = 0; i < preset_count; i++) {
+        SubGhzHistoryPreset* history_preset =
+            SubGhzHistoryPresetArray_get(instance->history->presets, i);
+        if((history_preset->data == preset->data) &&
+           (history_preset->data_size == preset->data_size) &&
+           (furi_string_cmp(history_preset->name, preset->name) == 0)) {
+            return i;
+        }
+    }
+    furi_check(preset_count <= UINT8_MAX);
+
+    SubGhzHistoryPreset* history_preset =
+        SubGhzHistoryPresetArray_push_raw(instance->history->presets);
+    history_preset->name = furi_string_alloc_set(preset->name);
+    history_preset->data = preset->data;
+    history_preset->data_size = preset->data_size;
+    return preset_count;
+}
+
+static uint8_t subghz_history_add_string(SubGhzHistory* instance, FuriString* string) {
+    // Manufacturer names repeat a lot, so they are shared like presets
+    size_t string_count = SubGhzHistoryStringArray_size(instance->history->strings);
+    for(size_t i = 0; i < string_count; i++) {
+        if(furi_string_cmp(*SubGhzHistoryStringArray_get(instance->history->strings, i), string) ==
+           0) {
+            return i;
+        }
+    }
+    if(string_count >= SUBGHZ_HISTORY_FIELD_NONE) return SUBGHZ_HISTORY_FIELD_NONE;
+
+    SubGhzHistoryStringArray_push_back(instance->history->strings, furi_string_alloc_set(string));
+    return string_count;
+}
+
 uint32_t subghz_history_get_frequency(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
     SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return item->preset->frequency;
+    return item->frequency;
 }
 
 SubGhzRadioPreset* subghz_history_get_radio_preset(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
     SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return item->preset;
+    SubGhzHistoryPreset* history_preset = subghz_history_get_item_preset(instance, idx);
+    furi_string_set(instance->preset.name, history_preset->name);
+    instance->preset.frequency = item->frequency;
+    instance->preset.data = history_preset->data;
+    instance->preset.data_size = history_preset->data_size;
+    return &instance->preset;
 }
 
 const char* subghz_history_get_preset(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return furi_string_get_cstr(item->preset->name);
+    return furi_string_get_cstr(subghz_history_get_item_preset(instance, idx)->name);
 }
 
 void subghz_history_reset(SubGhzHistory* instance) {
     furi_assert(instance);
     furi_string_reset(instance->tmp_string);
-    for
-        M_EACH(item, instance->history->data, SubGhzHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
-        }
-    SubGhzHistoryItemArray_reset(instance->history->data);
+    subghz_history_clean(instance);
     instance->last_index_write = 0;
     instance->code_last_hash_data = 0;
 }
@@ -96,29 +209,99 @@ uint16_t subghz_history_get_item(SubGhzHistory* instance) {
 uint8_t subghz_history_get_type_protocol(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
     SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return item->type;
+    return item->protocol->type;
 }
 
 const char* subghz_history_get_protocol_name(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
     SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    flipper_format_rewind(item->flipper_string);
-    if(!flipper_format_read_string(item->flipper_string, "Protocol", instance->tmp_string)) {
-        FURI_LOG_E(TAG, "Missing Protocol");
-        furi_string_reset(instance->tmp_string);
+    return item->protocol->name;
+}
+
+static bool subghz_history_serialize_compact(
+    SubGhzHistory* instance,
+    SubGhzHistoryItem* item,
+    FlipperFormat* flipper_format,
+    SubGhzRadioPreset* preset) {
+    SubGhzBlockGeneric generic = {
+        .protocol_name = item->protocol->name,
+        .data = item->key,
+        .data_count_bit = item->bit_count,
+    };
+    if(!subghz_block_generic_serialize(&generic, flipper_format, preset)) return false;
+    if(item->field == SUBGHZ_HISTORY_FIELD_NONE) return true;
+
+    const SubGhzHistoryField* field = &subghz_history_fields[item->field];
+    if(field->type == SubGhzHistoryFieldTypeUint32) {
+        uint32_t value = item->field_value;
+        return flipper_format_write_uint32(flipper_format, field->key, &value, 1);
+    } else if(field->type == SubGhzHistoryFieldTypeHex64) {
+        uint8_t value[sizeof(uint64_t)];
+        for(size_t i = 0; i < sizeof(uint64_t); i++) {
+            value[sizeof(uint64_t) - i - 1] = (item->field_value >> i * 8) & 0xFF;
+        }
+        return flipper_format_write_hex(flipper_format, field->key, value, sizeof(uint64_t));
+    } else {
+        FuriString* value =
+            *SubGhzHistoryStringArray_get(instance->history->strings, item->field_value);
+        return flipper_format_write_string(flipper_format, field->key, value);
+    }
+}
+
+static bool subghz_history_read_field(
+    SubGhzHistory* instance,
+    SubGhzHistoryItem* item,
+    FlipperFormat* flipper_format) {
+    for(size_t i = 0; i < COUNT_OF(subghz_history_fields); i++) {
+        const SubGhzHistoryField* field = &subghz_history_fields[i];
+        if(!flipper_format_rewind(flipper_format)) return false;
+
+        if(field->type == SubGhzHistoryFieldTypeUint32) {
+            uint32_t value = 0;
+            if(!flipper_format_read_uint32(flipper_format, field->key, &value, 1)) continue;
+            item->field_value = value;
+        } else if(field->type == SubGhzHistoryFieldTypeHex64) {
+            uint8_t value[sizeof(uint64_t)] = {0};
+            if(!flipper_format_read_hex(flipper_format, field->key, value, sizeof(uint64_t)))
+                continue;
+            item->field_value = 0;
+            for(size_t j = 0; j < sizeof(uint64_t); j++) {
+                item->field_value = (item->field_value << 8) | value[j];
+            }
+        } else {
+            if(!flipper_format_read_string(flipper_format, field->key, instance->tmp_string))
+                continue;
+            uint8_t index = subghz_history_add_string(instance, instance->tmp_string);
+            if(index == SUBGHZ_HISTORY_FIELD_NONE) return false;
+            item->field_value = index;
+        }
+
+        // Protocols write at most one of these, the check below catches any other
+        item->field = i;
+        return true;
     }
-    return furi_string_get_cstr(instance->tmp_string);
+    return true;
 }
 
 FlipperFormat* subghz_history_get_raw_data(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
     SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    if(item->flipper_string) {
-        return item->flipper_string;
+    Stream* stream = flipper_format_get_raw_stream(instance->flipper_string);
+    stream_clean(stream);
+
+    if(item->extra) {
+        stream_write_string(stream, item->extra);
     } else {
-        return NULL;
+        SubGhzRadioPreset* preset = subghz_history_get_radio_preset(instance, idx);
+        if(!subghz_history_serialize_compact(instance, item, instance->flipper_string, preset)) {
+            FURI_LOG_E(TAG, "Serialize error");
+            return NULL;
+        }
     }
+    stream_rewind(stream);
+    return instance->flipper_string;
 }
+
 bool subghz_history_get_text_space_left(SubGhzHistory* instance, FuriString* output) {
     furi_assert(instance);
     if(instance->last_index_write == SUBGHZ_HISTORY_MAX) {
@@ -130,76 +313,52 @@ bool subghz_history_get_text_space_left(SubGhzHistory* instance, FuriString* out
     return false;
 }
 
-void subghz_history_get_text_item_menu(SubGhzHistory* instance, FuriString* output, uint16_t idx) {
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    furi_string_set(output, item->item_str);
+static void subghz_history_print_key(FuriString* output, const char* name, uint64_t data) {
+    if(!(uint32_t)(data >> 32)) {
+        furi_string_printf(output, "%s %lX", name, (uint32_t)(data & 0xFFFFFFFF));
+    } else {
+        furi_string_printf(
+            output, "%s %lX%08lX", name, (uint32_t)(data >> 32), (uint32_t)(data & 0xFFFFFFFF));
+    }
 }
 
-bool subghz_history_add_to_history(
+static void subghz_history_get_text_item_menu_extra(
     SubGhzHistory* instance,
-    void* context,
-    SubGhzRadioPreset* preset) {
-    furi_assert(instance);
-    furi_assert(context);
-
-    if(instance->last_index_write >= SUBGHZ_HISTORY_MAX) return false;
-
-    SubGhzProtocolDecoderBase* decoder_base = context;
-    if((instance->code_last_hash_data ==
-        subghz_protocol_decoder_base_get_hash_data(decoder_base)) &&
-       ((furi_get_tick() - instance->last_update_timestamp) < 500)) {
-        instance->last_update_timestamp = furi_get_tick();
-        return false;
-    }
-
-    instance->code_last_hash_data = subghz_protocol_decoder_base_get_hash_data(decoder_base);
-    instance->last_update_timestamp = furi_get_tick();
-
+    FlipperFormat* flipper_string,
+    FuriString* output) {
     FuriString* text;
     text = furi_string_alloc();
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_push_raw(instance->history->data);
-    item->preset = malloc(sizeof(SubGhzRadioPreset));
-    item->type = decoder_base->protocol->type;
-    item->preset->frequency = preset->frequency;
-    item->preset->name = furi_string_alloc();
-    furi_string_set(item->preset->name, preset->name);
-    item->preset->data = preset->data;
-    item->preset->data_size = preset->data_size;
-
-    item->item_str = furi_string_alloc();
-    item->flipper_string = flipper_format_string_alloc();
-    subghz_protocol_decoder_base_serialize(decoder_base, item->flipper_string, preset);
 
     do {
-        if(!flipper_format_rewind(item->flipper_string)) {
+        if(!flipper_format_rewind(flipper_string)) {
             FURI_LOG_E(TAG, "Rewind error");
             break;
         }
-        if(!flipper_format_read_string(item->flipper_string, "Protocol", instance->tmp_string)) {
+        if(!flipper_format_read_string(flipper_string, "Protocol", instance->tmp_string)) {
             FURI_LOG_E(TAG, "Missing Protocol");
             break;
         }
         if(!strcmp(furi_string_get_cstr(instance->tmp_string), "KeeLoq")) {
             furi_string_set(instance->tmp_string, "KL ");
-            if(!flipper_format_read_string(item->flipper_string, "Manufacture", text)) {
+            if(!flipper_format_read_string(flipper_string, "Manufacture", text)) {
                 FURI_LOG_E(TAG, "Missing Protocol");
                 break;
             }
             furi_string_cat(instance->tmp_string, text);
         } else if(!strcmp(furi_string_get_cstr(instance->tmp_string), "Star Line")) {
             furi_string_set(instance->tmp_string, "SL ");
-            if(!flipper_format_read_string(item->flipper_string, "Manufacture", text)) {
+            if(!flipper_format_read_string(flipper_string, "Manufacture", text)) {
                 FURI_LOG_E(TAG, "Missing Protocol");
                 break;
             }
             furi_string_cat(instance->tmp_string, text);
         }
-        if(!flipper_format_rewind(item->flipper_string)) {
+        if(!flipper_format_rewind(flipper_string)) {
             FURI_LOG_E(TAG, "Rewind error");
             break;
         }
         uint8_t key_data[sizeof(uint64_t)] = {0};
-        if(!flipper_format_read_hex(item->flipper_string, "Key", key_data, sizeof(uint64_t))) {
+        if(!flipper_format_read_hex(flipper_string, "Key", key_data, sizeof(uint64_t))) {
             FURI_LOG_E(TAG, "Missing Key");
             break;
         }
@@ -207,23 +366,117 @@ bool subghz_history_add_to_history(
         for(uint8_t i = 0; i < sizeof(uint64_t); i++) {
             data = (data << 8) | key_data[i];
         }
-        if(!(uint32_t)(data >> 32)) {
-            furi_string_printf(
-                item->item_str,
-                "%s %lX",
-                furi_string_get_cstr(instance->tmp_string),
-                (uint32_t)(data & 0xFFFFFFFF));
-        } else {
-            furi_string_printf(
-                item->item_str,
-                "%s %lX%08lX",
-                furi_string_get_cstr(instance->tmp_string),
-                (uint32_t)(data >> 32),
-                (uint32_t)(data & 0xFFFFFFFF));
-        }
+        subghz_history_print_key(output, furi_string_get_cstr(instance->tmp_string), data);
     } while(false);
 
     furi_string_free(text);
+}
+
+void subghz_history_get_text_item_menu(SubGhzHistory* instance, FuriString* output, uint16_t idx) {
+    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
+    furi_string_reset(output);
+    if(item->extra || item->field != SUBGHZ_HISTORY_FIELD_NONE) {
+        FlipperFormat* flipper_string = subghz_history_get_raw_data(instance, idx);
+        subghz_history_get_text_item_menu_extra(instance, flipper_string, output);
+    } else {
+        subghz_history_print_key(output, item->protocol->name, item->key);
+    }
+}
+
+static bool subghz_history_stream_equal(Stream* stream_a, Stream* stream_b) {
+    if(stream_size(stream_a) != stream_size(stream_b)) return false;
+    stream_rewind(stream_a);
+    stream_rewind(stream_b);
+
+    uint8_t buffer_a[32];
+    uint8_t buffer_b[32];
+    while(true) {
+        size_t read_a = stream_read(stream_a, buffer_a, sizeof(buffer_a));
+        size_t read_b = stream_read(stream_b, buffer_b, sizeof(buffer_b));
+        if(read_a != read_b) return false;
+        if(read_a == 0) return true;
+        if(memcmp(buffer_a, buffer_b, read_a) != 0) return false;
+    }
+}
+
+static bool subghz_history_item_read_compact(
+    SubGhzHistory* instance,
+    SubGhzHistoryItem* item,
+    SubGhzRadioPreset* preset) {
+    bool result = false;
+    FlipperFormat* flipper_string = instance->flipper_string;
+
+    do {
+        if(!flipper_format_rewind(flipper_string)) break;
+        uint32_t bit_count = 0;
+        if(!flipper_format_read_uint32(flipper_string, "Bit", &bit_count, 1)) break;
+        uint8_t key_data[sizeof(uint64_t)] = {0};
+        if(!flipper_format_read_hex(flipper_string, "Key", key_data, sizeof(uint64_t))) break;
+
+        item->bit_count = bit_count;
+        item->key = 0;
+        for(uint8_t i = 0; i < sizeof(uint64_t); i++) {
+            item->key = (item->key << 8) | key_data[i];
+        }
+        if(!subghz_history_read_field(instance, item, flipper_string)) break;
+
+        // Compact form is used only if it reproduces the decoder output exactly
+        if(!subghz_history_serialize_compact(
+               instance, item, instance->flipper_string_check, preset))
+            break;
+        result = subghz_history_stream_equal(
+            flipper_format_get_raw_stream(flipper_string),
+            flipper_format_get_raw_stream(instance->flipper_string_check));
+    } while(false);
+
+    return result;
+}
+
+bool subghz_history_add_to_history(
+    SubGhzHistory* instance,
+    void* context,
+    SubGhzRadioPreset* preset) {
+    furi_assert(instance);
+    furi_assert(context);
+
+    if(instance->last_index_write >= SUBGHZ_HISTORY_MAX) return false;
+
+    SubGhzProtocolDecoderBase* decoder_base = context;
+    if((instance->code_last_hash_data ==
+        subghz_protocol_decoder_base_get_hash_data(decoder_base)) &&
+       ((furi_get_tick() - instance->last_update_timestamp) < 500)) {
+        instance->last_update_timestamp = furi_get_tick();
+        return false;
+    }
+
+    instance->code_last_hash_data = subghz_protocol_decoder_base_get_hash_data(decoder_base);
+    instance->last_update_timestamp = furi_get_tick();
+
+    SubGhzHistoryItem* item = SubGhzHistoryItemArray_push_raw(instance->history->data);
+    item->protocol = decoder_base->protocol;
+    item->extra = NULL;
+    item->key = 0;
+    item->field_value = 0;
+    item->bit_count = 0;
+    item->field = SUBGHZ_HISTORY_FIELD_NONE;
+    item->frequency = preset->frequency;
+    item->timestamp = instance->last_update_timestamp;
+    item->rssi = furi_hal_subghz_get_rssi();
+    item->preset_index = subghz_history_add_preset(instance, preset);
+
+    subghz_protocol_decoder_base_serialize(decoder_base, instance->flipper_string, preset);
+    if(!subghz_history_item_read_compact(instance, item, preset)) {
+        item->field = SUBGHZ_HISTORY_FIELD_NONE;
+        item->extra = furi_string_alloc();
+        Stream* stream = flipper_format_get_raw_stream(instance->flipper_string);
+        stream_rewind(stream);
+        uint8_t buffer[32];
+        size_t read = 0;
+        while((read = stream_read(stream, buffer, sizeof(buffer))) > 0) {
+            furi_string_cat_printf(item->extra, "%.*s", (int)read, buffer);
+        }
+    }
+
     instance->last_index_write++;
     return true;
 }
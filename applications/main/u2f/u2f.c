@@ -79,6 +79,7 @@ static const uint8_t state_wrong_data[] = {0x6A, 0x80};
 
 struct U2fData {
     uint8_t device_key[32];
+    hmac_sha256_key device_hmac_key;
     uint8_t cert_key[32];
     uint32_t counter;
     const struct uECC_Curve_t* p_curve;
@@ -129,6 +130,9 @@ bool u2f_init(U2fData* U2F) {
         }
     }
 
+    // Key handles and private keys are HMACs with device key, hash its key blocks once
+    hmac_sha256_key_init(&U2F->device_hmac_key, U2F->device_key);
+
     U2F->p_curve = uECC_secp256r1();
     uECC_set_rng(u2f_uecc_random);
 
@@ -209,16 +213,16 @@ static uint16_t u2f_register(U2fData* U2F, uint8_t* buf) {
     furi_hal_random_fill_buf(handle.nonce, 32);
 
     // Generate private key
-    hmac_sha256_init(&hmac_ctx, U2F->device_key);
+    hmac_sha256_key_start(&hmac_ctx, &U2F->device_hmac_key);
     hmac_sha256_update(&hmac_ctx, req->app_id, 32);
     hmac_sha256_update(&hmac_ctx, handle.nonce, 32);
-    hmac_sha256_finish(&hmac_ctx, U2F->device_key, private);
+    hmac_sha256_key_finish(&hmac_ctx, &U2F->device_hmac_key, private);
 
     // Generate private key handle
-    hmac_sha256_init(&hmac_ctx, U2F->device_key);
+    hmac_sha256_key_start(&hmac_ctx, &U2F->device_hmac_key);
     hmac_sha256_update(&hmac_ctx, private, 32);
     hmac_sha256_update(&hmac_ctx, req->app_id, 32);
-    hmac_sha256_finish(&hmac_ctx, U2F->device_key, handle.hash);
+    hmac_sha256_key_finish(&hmac_ctx, &U2F->device_hmac_key, handle.hash);
 
     // Generate public key
     pub_key.format = 0x04; // Uncompressed point
@@ -289,16 +293,16 @@ static uint16_t u2f_authenticate(U2fData* U2F, uint8_t* buf) {
     sha256_finish(&sha_ctx, hash);
 
     // Recover private key
-    hmac_sha256_init(&hmac_ctx, U2F->device_key);
+    hmac_sha256_key_start(&hmac_ctx, &U2F->device_hmac_key);
     hmac_sha256_update(&hmac_ctx, req->app_id, 32);
     hmac_sha256_update(&hmac_ctx, req->key_handle.nonce, 32);
-    hmac_sha256_finish(&hmac_ctx, U2F->device_key, priv_key);
+    hmac_sha256_key_finish(&hmac_ctx, &U2F->device_hmac_key, priv_key);
 
     // Generate and verify private key handle
-    hmac_sha256_init(&hmac_ctx, U2F->device_key);
+    hmac_sha256_key_start(&hmac_ctx, &U2F->device_hmac_key);
     hmac_sha256_update(&hmac_ctx, priv_key, 32);
     hmac_sha256_update(&hmac_ctx, req->app_id, 32);
-    hmac_sha256_finish(&hmac_ctx, U2F->device_key, mac_control);
+    hmac_sha256_key_finish(&hmac_ctx, &U2F->device_hmac_key, mac_control);
 
     if(memcmp(req->key_handle.hash, mac_control, 32) != 0) {
         FURI_LOG_W(TAG, "Wrong handle!");
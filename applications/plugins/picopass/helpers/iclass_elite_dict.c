@@ -5,14 +5,31 @@
 
 #define ICLASS_ELITE_DICT_FLIPPER_PATH EXT_PATH("picopass/assets/iclass_elite_dict.txt")
 #define ICLASS_ELITE_DICT_USER_PATH EXT_PATH("picopass/assets/iclass_elite_dict_user.txt")
+#define ICLASS_ELITE_DICT_FLIPPER_INDEX_PATH EXT_PATH("picopass/assets/iclass_elite_dict.bin")
+#define ICLASS_ELITE_DICT_USER_INDEX_PATH EXT_PATH("picopass/assets/iclass_elite_dict_user.bin")
 
 #define TAG "IclassEliteDict"
 
 #define ICLASS_ELITE_KEY_LINE_LEN (17)
-#define ICLASS_ELITE_KEY_LEN (8)
+
+#define ICLASS_ELITE_DICT_INDEX_MAGIC (0x44454349) // "ICED"
+#define ICLASS_ELITE_DICT_INDEX_VERSION (1)
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t key_len;
+    uint32_t total_keys;
+    // Text dictionary the index was built from
+    uint32_t source_size;
+    uint32_t source_timestamp;
+} IclassEliteDictHeader;
 
 struct IclassEliteDict {
+    Storage* storage;
     Stream* stream;
+    const char* path;
+    const char* index_path;
     uint32_t total_keys;
 };
 
@@ -32,51 +49,173 @@ bool iclass_elite_dict_check_presence(IclassEliteDictType dict_type) {
     return dict_present;
 }
 
+static bool iclass_elite_dict_parse_line(FuriString* line, uint8_t* key) {
+    if(furi_string_get_char(line, 0) == '#') return false;
+    if(furi_string_size(line) != ICLASS_ELITE_KEY_LINE_LEN) return false;
+
+    for(size_t i = 0; i < ICLASS_ELITE_KEY_LEN; i++) {
+        char hi = furi_string_get_char(line, i * 2);
+        char lo = furi_string_get_char(line, i * 2 + 1);
+        if(!args_char_to_hex(hi, lo, &key[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int iclass_elite_dict_key_cmp(const void* a, const void* b) {
+    return memcmp(a, b, ICLASS_ELITE_KEY_LEN);
+}
+
+static bool
+    iclass_elite_dict_get_source_info(IclassEliteDict* dict, IclassEliteDictHeader* header) {
+    FileInfo file_info;
+    if(storage_common_stat(dict->storage, dict->path, &file_info) != FSE_OK) return false;
+    if(storage_common_timestamp(dict->storage, dict->path, &header->source_timestamp) != FSE_OK)
+        return false;
+
+    header->magic = ICLASS_ELITE_DICT_INDEX_MAGIC;
+    header->version = ICLASS_ELITE_DICT_INDEX_VERSION;
+    header->key_len = ICLASS_ELITE_KEY_LEN;
+    header->source_size = file_info.size;
+    return true;
+}
+
+static bool iclass_elite_dict_build_index(IclassEliteDict* dict, IclassEliteDictHeader* header) {
+    Stream* source = buffered_file_stream_alloc(dict->storage);
+    FuriString* next_line = furi_string_alloc();
+    uint8_t* keys = NULL;
+    uint8_t key[ICLASS_ELITE_KEY_LEN];
+
+    bool index_built = false;
+    do {
+        if(!buffered_file_stream_open(source, dict->path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+
+        // Count keys to allocate them at once
+        size_t keys_count = 0;
+        while(stream_read_line(source, next_line)) {
+            if(iclass_elite_dict_parse_line(next_line, key)) keys_count++;
+        }
+        stream_rewind(source);
+
+        keys = malloc(keys_count * ICLASS_ELITE_KEY_LEN + 1);
+        size_t keys_read = 0;
+        while(keys_read < keys_count && stream_read_line(source, next_line)) {
+            if(iclass_elite_dict_parse_line(next_line, &keys[keys_read * ICLASS_ELITE_KEY_LEN]))
+                keys_read++;
+        }
+        if(keys_read != keys_count) break;
+
+        // Sorted and without duplicates
+        qsort(keys, keys_count, ICLASS_ELITE_KEY_LEN, iclass_elite_dict_key_cmp);
+        size_t unique_count = keys_count ? 1 : 0;
+        for(size_t i = 1; i < keys_count; i++) {
+            uint8_t* next_key = &keys[i * ICLASS_ELITE_KEY_LEN];
+            uint8_t* last_key = &keys[(unique_count - 1) * ICLASS_ELITE_KEY_LEN];
+            if(!memcmp(next_key, last_key, ICLASS_ELITE_KEY_LEN)) continue;
+            memmove(last_key + ICLASS_ELITE_KEY_LEN, next_key, ICLASS_ELITE_KEY_LEN);
+            unique_count++;
+        }
+        header->total_keys = unique_count;
+
+        size_t keys_size = unique_count * ICLASS_ELITE_KEY_LEN;
+        if(!file_stream_open(dict->stream, dict->index_path, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+            break;
+        if(stream_write(dict->stream, (uint8_t*)header, sizeof(IclassEliteDictHeader)) !=
+           sizeof(IclassEliteDictHeader))
+            break;
+        if(stream_write(dict->stream, keys, keys_size) != keys_size) break;
+
+        index_built = true;
+        FURI_LOG_I(TAG, "Indexed %u keys out of %u lines", unique_count, keys_count);
+    } while(false);
+
+    file_stream_close(dict->stream);
+    buffered_file_stream_close(source);
+    stream_free(source);
+    furi_string_free(next_line);
+    free(keys);
+
+    if(!index_built) {
+        storage_common_remove(dict->storage, dict->index_path);
+    }
+
+    return index_built;
+}
+
+static bool iclass_elite_dict_open_index(IclassEliteDict* dict) {
+    IclassEliteDictHeader source;
+    IclassEliteDictHeader header;
+
+    if(!iclass_elite_dict_get_source_info(dict, &source)) return false;
+
+    bool index_valid = false;
+    if(file_stream_open(dict->stream, dict->index_path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       stream_read(dict->stream, (uint8_t*)&header, sizeof(header)) == sizeof(header)) {
+        index_valid = header.magic == source.magic && header.version == source.version &&
+                      header.key_len == source.key_len &&
+                      header.source_size == source.source_size &&
+                      header.source_timestamp == source.source_timestamp &&
+                      stream_size(dict->stream) ==
+                          sizeof(header) + header.total_keys * ICLASS_ELITE_KEY_LEN;
+    }
+
+    if(!index_valid) {
+        file_stream_close(dict->stream);
+        FURI_LOG_I(TAG, "Building index for %s", dict->path);
+        if(!iclass_elite_dict_build_index(dict, &source)) return false;
+        if(!file_stream_open(dict->stream, dict->index_path, FSAM_READ, FSOM_OPEN_EXISTING))
+            return false;
+        header = source;
+    }
+
+    dict->total_keys = header.total_keys;
+    return stream_seek(dict->stream, sizeof(IclassEliteDictHeader), StreamOffsetFromStart);
+}
+
 IclassEliteDict* iclass_elite_dict_alloc(IclassEliteDictType dict_type) {
     IclassEliteDict* dict = malloc(sizeof(IclassEliteDict));
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    dict->stream = buffered_file_stream_alloc(storage);
-    furi_record_close(RECORD_STORAGE);
-    FuriString* next_line = furi_string_alloc();
+    dict->storage = furi_record_open(RECORD_STORAGE);
+    dict->stream = file_stream_alloc(dict->storage);
+    dict->total_keys = 0;
 
     bool dict_loaded = false;
     do {
         if(dict_type == IclassEliteDictTypeFlipper) {
-            if(!buffered_file_stream_open(
-                   dict->stream, ICLASS_ELITE_DICT_FLIPPER_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
-                buffered_file_stream_close(dict->stream);
-                break;
-            }
+            dict->path = ICLASS_ELITE_DICT_FLIPPER_PATH;
+            dict->index_path = ICLASS_ELITE_DICT_FLIPPER_INDEX_PATH;
         } else if(dict_type == IclassEliteDictTypeUser) {
-            if(!buffered_file_stream_open(
+            dict->path = ICLASS_ELITE_DICT_USER_PATH;
+            dict->index_path = ICLASS_ELITE_DICT_USER_INDEX_PATH;
+
+            // User dictionary is created on first use
+            if(!file_stream_open(
                    dict->stream, ICLASS_ELITE_DICT_USER_PATH, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS)) {
-                buffered_file_stream_close(dict->stream);
+                file_stream_close(dict->stream);
                 break;
             }
+            file_stream_close(dict->stream);
+        } else {
+            break;
         }
 
-        // Read total amount of keys
-        while(true) {
-            if(!stream_read_line(dict->stream, next_line)) break;
-            if(furi_string_get_char(next_line, 0) == '#') continue;
-            if(furi_string_size(next_line) != ICLASS_ELITE_KEY_LINE_LEN) continue;
-            dict->total_keys++;
+        if(!iclass_elite_dict_open_index(dict)) {
+            file_stream_close(dict->stream);
+            break;
         }
-        furi_string_reset(next_line);
-        stream_rewind(dict->stream);
 
         dict_loaded = true;
         FURI_LOG_I(TAG, "Loaded dictionary with %lu keys", dict->total_keys);
     } while(false);
 
     if(!dict_loaded) {
-        buffered_file_stream_close(dict->stream);
+        stream_free(dict->stream);
+        furi_record_close(RECORD_STORAGE);
         free(dict);
         dict = NULL;
     }
 
-    furi_string_free(next_line);
-
     return dict;
 }
 
@@ -84,8 +223,9 @@ void iclass_elite_dict_free(IclassEliteDict* dict) {
     furi_assert(dict);
     furi_assert(dict->stream);
 
-    buffered_file_stream_close(dict->stream);
+    file_stream_close(dict->stream);
     stream_free(dict->stream);
+    furi_record_close(RECORD_STORAGE);
     free(dict);
 }
 
@@ -96,56 +236,89 @@ uint32_t iclass_elite_dict_get_total_keys(IclassEliteDict* dict) {
 }
 
 bool iclass_elite_dict_get_next_key(IclassEliteDict* dict, uint8_t* key) {
+    return iclass_elite_dict_get_next_keys(dict, key, 1) == 1;
+}
+
+size_t iclass_elite_dict_get_next_keys(IclassEliteDict* dict, uint8_t* keys, size_t count) {
     furi_assert(dict);
     furi_assert(dict->stream);
+    furi_assert(keys);
 
-    uint8_t key_byte_tmp = 0;
-    FuriString* next_line = furi_string_alloc();
+    size_t bytes_read = stream_read(dict->stream, keys, count * ICLASS_ELITE_KEY_LEN);
+    return bytes_read / ICLASS_ELITE_KEY_LEN;
+}
+
+bool iclass_elite_dict_is_key_present(IclassEliteDict* dict, uint8_t* key) {
+    furi_assert(dict);
+    furi_assert(dict->stream);
+
+    size_t position = stream_tell(dict->stream);
+    uint8_t probe[ICLASS_ELITE_KEY_LEN];
 
-    bool key_read = false;
-    *key = 0ULL;
-    while(!key_read) {
-        if(!stream_read_line(dict->stream, next_line)) break;
-        if(furi_string_get_char(next_line, 0) == '#') continue;
-        if(furi_string_size(next_line) != ICLASS_ELITE_KEY_LINE_LEN) continue;
-        for(uint8_t i = 0; i < ICLASS_ELITE_KEY_LEN * 2; i += 2) {
-            args_char_to_hex(
-                furi_string_get_char(next_line, i),
-                furi_string_get_char(next_line, i + 1),
-                &key_byte_tmp);
-            key[i / 2] = key_byte_tmp;
+    // Binary search over sorted keys
+    bool key_found = false;
+    uint32_t left = 0;
+    uint32_t right = dict->total_keys;
+    while(left < right) {
+        uint32_t middle = left + (right - left) / 2;
+        if(!stream_seek(
+               dict->stream,
+               sizeof(IclassEliteDictHeader) + middle * ICLASS_ELITE_KEY_LEN,
+               StreamOffsetFromStart))
+            break;
+        if(stream_read(dict->stream, probe, ICLASS_ELITE_KEY_LEN) != ICLASS_ELITE_KEY_LEN) break;
+
+        int cmp = memcmp(key, probe, ICLASS_ELITE_KEY_LEN);
+        if(cmp == 0) {
+            key_found = true;
+            break;
+        } else if(cmp < 0) {
+            right = middle;
+        } else {
+            left = middle + 1;
         }
-        key_read = true;
     }
 
-    furi_string_free(next_line);
-    return key_read;
+    stream_seek(dict->stream, position, StreamOffsetFromStart);
+    return key_found;
 }
 
 bool iclass_elite_dict_rewind(IclassEliteDict* dict) {
     furi_assert(dict);
     furi_assert(dict->stream);
 
-    return stream_rewind(dict->stream);
+    return stream_seek(dict->stream, sizeof(IclassEliteDictHeader), StreamOffsetFromStart);
 }
 
 bool iclass_elite_dict_add_key(IclassEliteDict* dict, uint8_t* key) {
     furi_assert(dict);
     furi_assert(dict->stream);
 
+    if(iclass_elite_dict_is_key_present(dict, key)) return true;
+
     FuriString* key_str = furi_string_alloc();
-    for(size_t i = 0; i < 6; i++) {
+    for(size_t i = 0; i < ICLASS_ELITE_KEY_LEN; i++) {
         furi_string_cat_printf(key_str, "%02X", key[i]);
     }
     furi_string_cat_printf(key_str, "\n");
 
+    Stream* source = file_stream_alloc(dict->storage);
     bool key_added = false;
     do {
-        if(!stream_seek(dict->stream, 0, StreamOffsetFromEnd)) break;
-        if(!stream_insert_string(dict->stream, key_str)) break;
+        if(!file_stream_open(source, dict->path, FSAM_READ_WRITE, FSOM_OPEN_EXISTING)) break;
+        if(!stream_seek(source, 0, StreamOffsetFromEnd)) break;
+        if(stream_write_string(source, key_str) != furi_string_size(key_str)) break;
         key_added = true;
     } while(false);
+    file_stream_close(source);
+    stream_free(source);
+
+    // Text dictionary has changed, index is rebuilt and read from start
+    file_stream_close(dict->stream);
+    if(!iclass_elite_dict_open_index(dict)) {
+        key_added = false;
+    }
 
     furi_string_free(key_str);
     return key_added;
-}
\ No newline at end of file
+}
@@ -6,6 +6,8 @@
 #include <lib/toolbox/stream/file_stream.h>
 #include <lib/toolbox/stream/buffered_file_stream.h>
 
+#define ICLASS_ELITE_KEY_LEN (8)
+
 typedef enum {
     IclassEliteDictTypeUser,
     IclassEliteDictTypeFlipper,
@@ -15,6 +17,16 @@ typedef struct IclassEliteDict IclassEliteDict;
 
 bool iclass_elite_dict_check_presence(IclassEliteDictType dict_type);
 
+/** Allocate IclassEliteDict instance
+ *
+ * Keys are read from binary index stored next to text dictionary: header
+ * with keys count followed by sorted unique 8 byte keys. Index is built from
+ * text dictionary when missing or when text dictionary has changed.
+ *
+ * @param[in]  dict_type  The dictionary type
+ *
+ * @return     IclassEliteDict instance or NULL on failure
+ */
 IclassEliteDict* iclass_elite_dict_alloc(IclassEliteDictType dict_type);
 
 void iclass_elite_dict_free(IclassEliteDict* dict);
@@ -23,6 +35,18 @@ uint32_t iclass_elite_dict_get_total_keys(IclassEliteDict* dict);
 
 bool iclass_elite_dict_get_next_key(IclassEliteDict* dict, uint8_t* key);
 
+/** Read several next keys at once
+ *
+ * @param      dict   IclassEliteDict instance
+ * @param[out] keys   buffer for count * ICLASS_ELITE_KEY_LEN bytes
+ * @param      count  maximum keys count to read
+ *
+ * @return     keys count read, 0 when there are no keys left
+ */
+size_t iclass_elite_dict_get_next_keys(IclassEliteDict* dict, uint8_t* keys, size_t count);
+
+bool iclass_elite_dict_is_key_present(IclassEliteDict* dict, uint8_t* key);
+
 bool iclass_elite_dict_rewind(IclassEliteDict* dict);
 
-bool iclass_elite_dict_add_key(IclassEliteDict* dict, uint8_t* key);
\ No newline at end of file
+bool iclass_elite_dict_add_key(IclassEliteDict* dict, uint8_t* key);
@@ -0,0 +1,85 @@
+#include "iclass_elite_recovery.h"
+
+#include <optimized_cipher.h>
+#include <optimized_cipher_bs.h>
+#include <optimized_elite.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ICLASS_ELITE_KEY_LEN (8)
+
+struct IclassEliteRecovery {
+    IclassEliteMac* macs;
+    // loclass_hash1 of every captured CSN
+    uint8_t (*key_index)[8];
+    size_t macs_count;
+};
+
+IclassEliteRecovery* iclass_elite_recovery_alloc(const IclassEliteMac* macs, size_t macs_count) {
+    IclassEliteRecovery* instance = malloc(sizeof(IclassEliteRecovery));
+    instance->macs = malloc(sizeof(IclassEliteMac) * macs_count);
+    instance->key_index = malloc(sizeof(*instance->key_index) * macs_count);
+    instance->macs_count = macs_count;
+
+    memcpy(instance->macs, macs, sizeof(IclassEliteMac) * macs_count);
+    for(size_t i = 0; i < macs_count; i++) {
+        loclass_hash1(instance->macs[i].csn, instance->key_index[i]);
+    }
+
+    return instance;
+}
+
+void iclass_elite_recovery_free(IclassEliteRecovery* instance) {
+    free(instance->key_index);
+    free(instance->macs);
+    free(instance);
+}
+
+static bool iclass_elite_recovery_check_key(IclassEliteRecovery* instance, uint8_t* key) {
+    uint8_t div_key[8];
+    uint8_t mac[4];
+
+    for(size_t i = 1; i < instance->macs_count; i++) {
+        IclassEliteMac* captured = &instance->macs[i];
+        loclass_iclass_calc_elite_div_key(captured->csn, instance->key_index[i], key, div_key);
+        loclass_opt_doReaderMAC(captured->cc_nr, div_key, mac);
+        if(memcmp(mac, captured->mac, sizeof(mac))) return false;
+    }
+
+    return true;
+}
+
+bool iclass_elite_recovery_check_keys(
+    IclassEliteRecovery* instance,
+    const uint8_t* keys,
+    size_t keys_count,
+    size_t* key_found) {
+    IclassEliteMac* first = &instance->macs[0];
+    uint8_t div_keys[LOCLASS_BS_LANES][8];
+    uint8_t key[ICLASS_ELITE_KEY_LEN];
+
+    for(size_t offset = 0; offset < keys_count; offset += LOCLASS_BS_LANES) {
+        size_t count = keys_count - offset;
+        if(count > LOCLASS_BS_LANES) count = LOCLASS_BS_LANES;
+
+        for(size_t i = 0; i < count; i++) {
+            memcpy(key, &keys[(offset + i) * ICLASS_ELITE_KEY_LEN], ICLASS_ELITE_KEY_LEN);
+            loclass_iclass_calc_elite_div_key(
+                first->csn, instance->key_index[0], key, div_keys[i]);
+        }
+
+        LoclassBsWord match = loclass_opt_doReaderMAC_bs(
+            first->cc_nr, (const uint8_t(*)[8])div_keys, count, first->mac);
+        for(size_t i = 0; match && i < count; i++) {
+            if(!((match >> i) & 1)) continue;
+            memcpy(key, &keys[(offset + i) * ICLASS_ELITE_KEY_LEN], ICLASS_ELITE_KEY_LEN);
+            if(iclass_elite_recovery_check_key(instance, key)) {
+                *key_found = offset + i;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Reader MAC from iClass reader authenticating to a card, see iclass_mac_log.h */
+typedef struct {
+    uint8_t csn[8];
+    uint8_t cc_nr[12];
+    uint8_t mac[4];
+} IclassEliteMac;
+
+typedef struct IclassEliteRecovery IclassEliteRecovery;
+
+/** Allocate elite key recovery
+ *
+ * Engine has no dependencies besides loclass, so the same code runs on device
+ * and in host tools.
+ *
+ * @param      macs        captured reader MACs, copied
+ * @param      macs_count  number of captured MACs, at least 1
+ *
+ * @return     IclassEliteRecovery instance
+ */
+IclassEliteRecovery* iclass_elite_recovery_alloc(const IclassEliteMac* macs, size_t macs_count);
+
+void iclass_elite_recovery_free(IclassEliteRecovery* instance);
+
+/** Check candidate elite keys against captured MACs
+ *
+ * Candidates are diversified for first captured CSN and their reader MACs are
+ * compared in bitsliced batches, keys that match are checked against every
+ * other captured MAC. Safe to call from several threads at once.
+ *
+ * @param      instance    IclassEliteRecovery instance
+ * @param      keys        keys_count * 8 bytes of candidate keys
+ * @param      keys_count  number of candidate keys
+ * @param[out] key_found   index of the key matching all captured MACs
+ *
+ * @return     true if key was found
+ */
+bool iclass_elite_recovery_check_keys(
+    IclassEliteRecovery* instance,
+    const uint8_t* keys,
+    size_t keys_count,
+    size_t* key_found);
+
+#ifdef __cplusplus
+}
+#endif
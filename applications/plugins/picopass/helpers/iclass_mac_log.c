@@ -0,0 +1,58 @@
+#include "iclass_mac_log.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+#include <lib/toolbox/args.h>
+#include <lib/toolbox/stream/stream.h>
+#include <lib/toolbox/stream/buffered_file_stream.h>
+
+#define TAG "IclassMacLog"
+
+#define ICLASS_MAC_LOG_PATH EXT_PATH("picopass/.loclass.log")
+
+static bool iclass_mac_log_read_field(
+    FuriString* line,
+    FuriString* word,
+    const char* name,
+    uint8_t* data,
+    size_t len) {
+    if(!args_read_string_and_trim(line, word)) return false;
+    if(furi_string_cmp_str(word, name)) return false;
+    return args_read_hex_bytes(line, data, len) && args_read_string_and_trim(line, word);
+}
+
+size_t iclass_mac_log_load(IclassEliteMac* macs, size_t max_count) {
+    furi_assert(macs);
+
+    size_t count = 0;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* file_stream = buffered_file_stream_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    FuriString* word = furi_string_alloc();
+
+    do {
+        if(!buffered_file_stream_open(
+               file_stream, ICLASS_MAC_LOG_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+            break;
+        while(count < max_count && stream_read_line(file_stream, line)) {
+            IclassEliteMac* mac = &macs[count];
+            furi_string_trim(line);
+            if(iclass_mac_log_read_field(line, word, "csn", mac->csn, sizeof(mac->csn)) &&
+               iclass_mac_log_read_field(
+                   line, word, "cc_nr", mac->cc_nr, sizeof(mac->cc_nr)) &&
+               iclass_mac_log_read_field(line, word, "mac", mac->mac, sizeof(mac->mac))) {
+                count++;
+            }
+        }
+    } while(false);
+
+    FURI_LOG_I(TAG, "Loaded %u MACs", count);
+
+    furi_string_free(word);
+    furi_string_free(line);
+    buffered_file_stream_close(file_stream);
+    stream_free(file_stream);
+    furi_record_close(RECORD_STORAGE);
+
+    return count;
+}
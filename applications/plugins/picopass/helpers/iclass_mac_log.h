@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "iclass_elite_recovery.h"
+
+/** Read reader MACs from log on SD card
+ *
+ * Log is produced off-device, by a sniffer or an emulator capturing reader
+ * authentication, one line per MAC: "csn <hex> cc_nr <hex> mac <hex>".
+ *
+ * @param[out] macs       buffer for MACs
+ * @param      max_count  buffer size
+ *
+ * @return     count of MACs read
+ */
+size_t iclass_mac_log_load(IclassEliteMac* macs, size_t max_count);
@@ -299,19 +299,27 @@ void loclass_opt_doTagMAC_2(
     loclass_opt_output(div_key_p, &_init, mac);
 }
 
+void loclass_iclass_calc_elite_div_key(
+    uint8_t* csn,
+    const uint8_t* key_index,
+    uint8_t* key,
+    uint8_t* div_key) {
+    uint8_t keytable[128] = {0};
+    uint8_t key_sel[8] = {0};
+    uint8_t key_sel_p[8] = {0};
+    loclass_hash2(key, keytable);
+    for(uint8_t i = 0; i < 8; i++) key_sel[i] = keytable[key_index[i]];
+
+    //Permute from iclass format to standard format
+    loclass_permutekey_rev(key_sel, key_sel_p);
+    loclass_diversifyKey(csn, key_sel_p, div_key);
+}
+
 void loclass_iclass_calc_div_key(uint8_t* csn, uint8_t* key, uint8_t* div_key, bool elite) {
     if(elite) {
-        uint8_t keytable[128] = {0};
         uint8_t key_index[8] = {0};
-        uint8_t key_sel[8] = {0};
-        uint8_t key_sel_p[8] = {0};
-        loclass_hash2(key, keytable);
         loclass_hash1(csn, key_index);
-        for(uint8_t i = 0; i < 8; i++) key_sel[i] = keytable[key_index[i]];
-
-        //Permute from iclass format to standard format
-        loclass_permutekey_rev(key_sel, key_sel_p);
-        loclass_diversifyKey(csn, key_sel_p, div_key);
+        loclass_iclass_calc_elite_div_key(csn, key_index, key, div_key);
     } else {
         loclass_diversifyKey(csn, key, div_key);
     }
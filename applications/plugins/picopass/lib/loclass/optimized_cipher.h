@@ -95,4 +95,17 @@ void loclass_opt_doTagMAC_2(
 
 void loclass_doMAC_N(uint8_t* in_p, uint8_t in_size, uint8_t* div_key_p, uint8_t mac[4]);
 void loclass_iclass_calc_div_key(uint8_t* csn, uint8_t* key, uint8_t* div_key, bool elite);
+/**
+ * Elite key diversification for many keys and the same CSN, loclass_hash1 of the CSN
+ * is calculated once by caller instead of once per key.
+ * @param csn - card serial number
+ * @param key_index - loclass_hash1(csn)
+ * @param key - elite key
+ * @param div_key - where to store the diversified key
+ */
+void loclass_iclass_calc_elite_div_key(
+    uint8_t* csn,
+    const uint8_t* key_index,
+    uint8_t* key,
+    uint8_t* div_key);
 #endif // OPTIMIZED_CIPHER_H
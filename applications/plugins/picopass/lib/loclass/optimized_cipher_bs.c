@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------------
+// Bitsliced variant of the iClass cipher from optimized_cipher.c
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// WARNING
+//
+// THIS CODE IS CREATED FOR EXPERIMENTATION AND EDUCATIONAL USE ONLY.
+//
+// USAGE OF THIS CODE IN OTHER WAYS MAY INFRINGE UPON THE INTELLECTUAL
+// PROPERTY OF OTHER PARTIES, SUCH AS INSIDE SECURE AND HID GLOBAL,
+// AND MAY EXPOSE YOU TO AN INFRINGEMENT ACTION FROM THOSE PARTIES.
+//
+// THIS CODE SHOULD NEVER BE USED TO INFRINGE PATENTS OR INTELLECTUAL PROPERTY RIGHTS.
+//-----------------------------------------------------------------------------
+#include "optimized_cipher_bs.h"
+
+#include <string.h>
+
+#define LOCLASS_BS_ALL ((LoclassBsWord)~(LoclassBsWord)0)
+#define LOCLASS_BS_BIT(value, bit) (((value) >> (bit)) & 1 ? LOCLASS_BS_ALL : 0)
+
+/**
+ * Cipher state with one word per bit, lane i of every word belongs to key i
+ */
+typedef struct {
+    LoclassBsWord l[8];
+    LoclassBsWord r[8];
+    LoclassBsWord b[8];
+    LoclassBsWord t[16];
+} LoclassBsState_t;
+
+/**
+ * Same as loclass_opt_successor, with select function and additions written
+ * out as logic so all lanes take the same path.
+ */
+static void
+    loclass_bs_successor(const LoclassBsWord k[8][8], LoclassBsState_t* s, LoclassBsWord y) {
+    const LoclassBsWord* r = s->r;
+
+    // Only bit 0 of Tt is used: parity of t masked with 0xc533
+    LoclassBsWord tt = s->t[0] ^ s->t[1] ^ s->t[4] ^ s->t[5] ^ s->t[8] ^ s->t[10] ^ s->t[14] ^
+                       s->t[15];
+    LoclassBsWord t_in = tt ^ r[7] ^ r[3];
+    LoclassBsWord b_in = s->b[0] ^ s->b[4] ^ s->b[5] ^ s->b[6] ^ r[0];
+
+    memmove(&s->t[0], &s->t[1], sizeof(LoclassBsWord) * 15);
+    s->t[15] = t_in;
+    memmove(&s->b[0], &s->b[1], sizeof(LoclassBsWord) * 7);
+    s->b[7] = b_in;
+
+    // Bits of loclass_opt_select_LUT[r] mixed with Tt and y
+    LoclassBsWord sel2 = (r[7] & r[5]) ^ (r[6] & ~r[4]) ^ (r[5] | r[3]);
+    LoclassBsWord sel1 = (r[7] | r[5]) ^ (r[2] | r[0]) ^ r[6] ^ r[1] ^ tt ^ y;
+    LoclassBsWord sel0 = (r[4] & ~r[2]) ^ (r[3] & r[1]) ^ r[0] ^ tt;
+
+    // r = (k[select] ^ b) + l, l = r + old r
+    LoclassBsWord r_new[8];
+    LoclassBsWord carry = 0;
+    for(int i = 0; i < 8; i++) {
+        LoclassBsWord k01 = k[0][i] ^ (sel0 & (k[0][i] ^ k[1][i]));
+        LoclassBsWord k23 = k[2][i] ^ (sel0 & (k[2][i] ^ k[3][i]));
+        LoclassBsWord k45 = k[4][i] ^ (sel0 & (k[4][i] ^ k[5][i]));
+        LoclassBsWord k67 = k[6][i] ^ (sel0 & (k[6][i] ^ k[7][i]));
+        LoclassBsWord k03 = k01 ^ (sel1 & (k01 ^ k23));
+        LoclassBsWord k47 = k45 ^ (sel1 & (k45 ^ k67));
+        LoclassBsWord x = (k03 ^ (sel2 & (k03 ^ k47))) ^ s->b[i];
+
+        LoclassBsWord x_xor_l = x ^ s->l[i];
+        r_new[i] = x_xor_l ^ carry;
+        carry = (x & s->l[i]) | (carry & x_xor_l);
+    }
+
+    carry = 0;
+    for(int i = 0; i < 8; i++) {
+        LoclassBsWord r_xor = r_new[i] ^ r[i];
+        s->l[i] = r_xor ^ carry;
+        carry = (r_new[i] & r[i]) | (carry & r_xor);
+    }
+    memcpy(s->r, r_new, sizeof(r_new));
+}
+
+LoclassBsWord loclass_opt_doReaderMAC_bs(
+    const uint8_t* cc_nr,
+    const uint8_t (*div_keys)[8],
+    size_t count,
+    const uint8_t mac[4]) {
+    LoclassBsWord k[8][8];
+    LoclassBsState_t s;
+
+    memset(k, 0, sizeof(k));
+    memset(&s, 0, sizeof(s));
+
+    // Transpose keys and initial state into bit slices
+    for(size_t lane = 0; lane < count; lane++) {
+        LoclassBsWord lane_bit = (LoclassBsWord)1 << lane;
+        uint8_t l = ((div_keys[lane][0] ^ 0x4c) + 0xEC) & 0xFF;
+        uint8_t r = ((div_keys[lane][0] ^ 0x4c) + 0x21) & 0xFF;
+        for(int i = 0; i < 8; i++) {
+            for(int j = 0; j < 8; j++) {
+                if((div_keys[lane][i] >> j) & 1) k[i][j] |= lane_bit;
+            }
+            if((l >> i) & 1) s.l[i] |= lane_bit;
+            if((r >> i) & 1) s.r[i] |= lane_bit;
+        }
+    }
+    for(int i = 0; i < 8; i++) s.b[i] = LOCLASS_BS_BIT(0x4c, i);
+    for(int i = 0; i < 16; i++) s.t[i] = LOCLASS_BS_BIT(0xE012, i);
+
+    for(int i = 0; i < 12; i++) {
+        for(int j = 0; j < 8; j++) {
+            loclass_bs_successor(k, &s, LOCLASS_BS_BIT(cc_nr[i], j));
+        }
+    }
+
+    LoclassBsWord match = LOCLASS_BS_ALL;
+    if(count < LOCLASS_BS_LANES) {
+        match = ((LoclassBsWord)1 << count) - 1;
+    }
+
+    // Output bits are compared while they are produced, stop once every lane differs
+    for(int i = 0; i < 4 && match; i++) {
+        for(int j = 0; j < 8 && match; j++) {
+            match &= ~(s.r[2] ^ LOCLASS_BS_BIT(mac[i], j));
+            loclass_bs_successor(k, &s, 0);
+        }
+    }
+
+    return match;
+}
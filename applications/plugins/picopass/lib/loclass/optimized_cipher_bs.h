@@ -0,0 +1,59 @@
+//-----------------------------------------------------------------------------
+// Bitsliced variant of the iClass cipher from optimized_cipher.c
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// WARNING
+//
+// THIS CODE IS CREATED FOR EXPERIMENTATION AND EDUCATIONAL USE ONLY.
+//
+// USAGE OF THIS CODE IN OTHER WAYS MAY INFRINGE UPON THE INTELLECTUAL
+// PROPERTY OF OTHER PARTIES, SUCH AS INSIDE SECURE AND HID GLOBAL,
+// AND MAY EXPOSE YOU TO AN INFRINGEMENT ACTION FROM THOSE PARTIES.
+//
+// THIS CODE SHOULD NEVER BE USED TO INFRINGE PATENTS OR INTELLECTUAL PROPERTY RIGHTS.
+//-----------------------------------------------------------------------------
+#ifndef OPTIMIZED_CIPHER_BS_H
+#define OPTIMIZED_CIPHER_BS_H
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * One bit of every cipher state runs in its own lane of machine word, so one pass
+ * over the cipher computes MACs for LOCLASS_BS_LANES keys. Define LOCLASS_BS_WORD
+ * as uint64_t to get 64 lanes on 64 bit hosts.
+ */
+#ifndef LOCLASS_BS_WORD
+#define LOCLASS_BS_WORD uint32_t
+#endif
+
+typedef LOCLASS_BS_WORD LoclassBsWord;
+
+#define LOCLASS_BS_LANES (sizeof(LoclassBsWord) * 8)
+
+/**
+ * Reader MAC, MAC(key, CC * NR), for up to LOCLASS_BS_LANES diversified keys at once
+ * compared to expected MAC.
+ * @param cc_nr - card challenge and reader nonce, 12 bytes
+ * @param div_keys - diversified keys
+ * @param count - number of keys, at most LOCLASS_BS_LANES
+ * @param mac - expected MAC
+ * @return lane mask, bit i is set when MAC of div_keys[i] equals expected one
+ */
+LoclassBsWord loclass_opt_doReaderMAC_bs(
+    const uint8_t* cc_nr,
+    const uint8_t (*div_keys)[8],
+    size_t count,
+    const uint8_t mac[4]);
+
+#endif // OPTIMIZED_CIPHER_BS_H
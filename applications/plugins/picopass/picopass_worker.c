@@ -1,9 +1,33 @@
 #include "picopass_worker_i.h"
 
 #include <flipper_format/flipper_format.h>
+#include <optimized_elite.h>
+
+#include "helpers/iclass_elite_recovery.h"
+#include "helpers/iclass_mac_log.h"
 
 #define TAG "PicopassWorker"
 
+#define PICOPASS_ELITE_BATCH_SIZE (16)
+#define PICOPASS_ELITE_RECOVERY_CHUNK_SIZE (256)
+#define PICOPASS_ELITE_RECOVERY_MACS_MAX (16)
+
+typedef struct {
+    uint8_t keys[PICOPASS_ELITE_BATCH_SIZE][PICOPASS_BLOCK_LEN];
+    uint8_t div_keys[PICOPASS_ELITE_BATCH_SIZE][PICOPASS_BLOCK_LEN];
+    size_t count;
+} PicopassEliteBatch;
+
+typedef struct {
+    IclassEliteDict* dict;
+    uint8_t csn[PICOPASS_BLOCK_LEN];
+    uint8_t key_index[PICOPASS_BLOCK_LEN];
+    PicopassEliteBatch batch[2];
+    PicopassEliteBatch* next;
+    FuriSemaphore* ready;
+    FuriWork* work;
+} PicopassEliteBatches;
+
 const uint8_t picopass_iclass_key[] = {0xaf, 0xa7, 0x85, 0xa7, 0xda, 0xb3, 0x33, 0x78};
 const uint8_t picopass_factory_key[] = {0x76, 0x65, 0x54, 0x43, 0x32, 0x21, 0x10, 0x00};
 
@@ -79,6 +103,18 @@ void picopass_worker_stop(PicopassWorker* picopass_worker) {
     furi_thread_join(picopass_worker->thread);
 }
 
+void picopass_worker_get_elite_recovery_progress(
+    PicopassWorker* picopass_worker,
+    uint32_t* macs_count,
+    uint32_t* keys_checked,
+    uint32_t* keys_total) {
+    furi_assert(picopass_worker);
+
+    *macs_count = picopass_worker->elite_macs_count;
+    *keys_checked = picopass_worker->elite_keys_checked;
+    *keys_total = picopass_worker->elite_keys_total;
+}
+
 void picopass_worker_change_state(PicopassWorker* picopass_worker, PicopassWorkerState state) {
     picopass_worker->state = state;
 }
@@ -175,6 +211,62 @@ ReturnCode picopass_read_preauth(PicopassBlock* AA1) {
     return ERR_NONE;
 }
 
+/*
+ * Elite keys are diversified for card CSN in batches on system work queue: while
+ * worker exchanges with the card using one batch the next one is read from
+ * dictionary and diversified. Only reader MAC is left for worker since it
+ * depends on card challenge.
+ */
+static void picopass_elite_batch_fill(void* context) {
+    PicopassEliteBatches* batches = context;
+    PicopassEliteBatch* batch = batches->next;
+
+    batch->count =
+        iclass_elite_dict_get_next_keys(batches->dict, batch->keys[0], PICOPASS_ELITE_BATCH_SIZE);
+    for(size_t i = 0; i < batch->count; i++) {
+        loclass_iclass_calc_elite_div_key(
+            batches->csn, batches->key_index, batch->keys[i], batch->div_keys[i]);
+    }
+
+    furi_semaphore_release(batches->ready);
+}
+
+static PicopassEliteBatches*
+    picopass_elite_batches_alloc(IclassEliteDict* dict, PicopassBlock* AA1) {
+    PicopassEliteBatches* batches = malloc(sizeof(PicopassEliteBatches));
+    batches->dict = dict;
+    memcpy(batches->csn, AA1[PICOPASS_CSN_BLOCK_INDEX].data, PICOPASS_BLOCK_LEN);
+    loclass_hash1(batches->csn, batches->key_index);
+    batches->next = &batches->batch[0];
+    batches->ready = furi_semaphore_alloc(1, 0);
+    batches->work =
+        furi_work_alloc(furi_work_queue_get_system(), picopass_elite_batch_fill, batches);
+
+    furi_work_submit(batches->work);
+    return batches;
+}
+
+static void picopass_elite_batches_free(PicopassEliteBatches* batches) {
+    furi_work_free(batches->work);
+    furi_semaphore_free(batches->ready);
+    free(batches);
+}
+
+static PicopassEliteBatch* picopass_elite_batches_take(PicopassEliteBatches* batches) {
+    furi_semaphore_acquire(batches->ready, FuriWaitForever);
+
+    PicopassEliteBatch* batch = batches->next;
+    if(!batch->count) return NULL;
+
+    // Keys left in dictionary are diversified while this batch is tried
+    if(batch->count == PICOPASS_ELITE_BATCH_SIZE) {
+        batches->next = (batch == &batches->batch[0]) ? &batches->batch[1] : &batches->batch[0];
+        furi_work_submit(batches->work);
+    }
+
+    return batch;
+}
+
 ReturnCode picopass_auth(PicopassBlock* AA1, PicopassPacs* pacs) {
     rfalPicoPassReadCheckRes rcRes;
     rfalPicoPassCheckRes chkRes;
@@ -203,9 +295,6 @@ ReturnCode picopass_auth(PicopassBlock* AA1, PicopassPacs* pacs) {
 
     FURI_LOG_E(TAG, "Starting dictionary attack");
 
-    size_t index = 0;
-    uint8_t key[PICOPASS_BLOCK_LEN] = {0};
-
     if(!iclass_elite_dict_check_presence(IclassEliteDictTypeFlipper)) {
         FURI_LOG_E(TAG, "Dictionary not found");
         return ERR_PARAM;
@@ -218,40 +307,48 @@ ReturnCode picopass_auth(PicopassBlock* AA1, PicopassPacs* pacs) {
     }
 
     FURI_LOG_D(TAG, "Loaded %lu keys", iclass_elite_dict_get_total_keys(dict));
-    while(iclass_elite_dict_get_next_key(dict, key)) {
-        FURI_LOG_D(
-            TAG,
-            "Try to auth with key %d %02x%02x%02x%02x%02x%02x%02x%02x",
-            index++,
-            key[0],
-            key[1],
-            key[2],
-            key[3],
-            key[4],
-            key[5],
-            key[6],
-            key[7]);
-
-        err = rfalPicoPassPollerReadCheck(&rcRes);
-        if(err != ERR_NONE) {
-            FURI_LOG_E(TAG, "rfalPicoPassPollerReadCheck error %d", err);
-            return err;
-        }
-        memcpy(ccnr, rcRes.CCNR, sizeof(rcRes.CCNR)); // last 4 bytes left 0
+    PicopassEliteBatches* batches = picopass_elite_batches_alloc(dict, AA1);
 
-        loclass_iclass_calc_div_key(AA1[PICOPASS_CSN_BLOCK_INDEX].data, key, div_key, true);
-        loclass_opt_doReaderMAC(ccnr, div_key, mac);
+    size_t index = 0;
+    PicopassEliteBatch* batch;
+    while((batch = picopass_elite_batches_take(batches)) != NULL) {
+        size_t i;
+        for(i = 0; i < batch->count; i++) {
+            uint8_t* key = batch->keys[i];
+            FURI_LOG_D(
+                TAG,
+                "Try to auth with key %d %02x%02x%02x%02x%02x%02x%02x%02x",
+                index++,
+                key[0],
+                key[1],
+                key[2],
+                key[3],
+                key[4],
+                key[5],
+                key[6],
+                key[7]);
+
+            err = rfalPicoPassPollerReadCheck(&rcRes);
+            if(err != ERR_NONE) {
+                FURI_LOG_E(TAG, "rfalPicoPassPollerReadCheck error %d", err);
+                break;
+            }
+            memcpy(ccnr, rcRes.CCNR, sizeof(rcRes.CCNR)); // last 4 bytes left 0
 
-        err = rfalPicoPassPollerCheck(mac, &chkRes);
-        if(err == ERR_NONE) {
-            memcpy(pacs->key, key, PICOPASS_BLOCK_LEN);
-            break;
+            loclass_opt_doReaderMAC(ccnr, batch->div_keys[i], mac);
+
+            err = rfalPicoPassPollerCheck(mac, &chkRes);
+            if(err == ERR_NONE) {
+                memcpy(pacs->key, key, PICOPASS_BLOCK_LEN);
+                break;
+            }
         }
+        // Authenticated, lost card or dictionary is over
+        if(i < batch->count || batch->count < PICOPASS_ELITE_BATCH_SIZE) break;
     }
 
-    if(dict) {
-        iclass_elite_dict_free(dict);
-    }
+    picopass_elite_batches_free(batches);
+    iclass_elite_dict_free(dict);
 
     return err;
 }
@@ -366,13 +463,18 @@ ReturnCode picopass_write_card(PicopassBlock* AA1) {
 int32_t picopass_worker_task(void* context) {
     PicopassWorker* picopass_worker = context;
 
-    picopass_worker_enable_field();
-    if(picopass_worker->state == PicopassWorkerStateDetect) {
-        picopass_worker_detect(picopass_worker);
-    } else if(picopass_worker->state == PicopassWorkerStateWrite) {
-        picopass_worker_write(picopass_worker);
+    if(picopass_worker->state == PicopassWorkerStateEliteRecovery) {
+        // Works on captured MACs only, card and field are not needed
+        picopass_worker_elite_recovery(picopass_worker);
+    } else {
+        picopass_worker_enable_field();
+        if(picopass_worker->state == PicopassWorkerStateDetect) {
+            picopass_worker_detect(picopass_worker);
+        } else if(picopass_worker->state == PicopassWorkerStateWrite) {
+            picopass_worker_write(picopass_worker);
+        }
+        picopass_worker_disable_field(ERR_NONE);
     }
-    picopass_worker_disable_field(ERR_NONE);
 
     picopass_worker_change_state(picopass_worker, PicopassWorkerStateReady);
 
@@ -477,3 +579,89 @@ void picopass_worker_write(PicopassWorker* picopass_worker) {
         furi_delay_ms(100);
     }
 }
+
+static bool picopass_worker_elite_recovery_dict(
+    PicopassWorker* picopass_worker,
+    IclassEliteRecovery* recovery,
+    IclassEliteDictType dict_type,
+    uint8_t* keys,
+    uint8_t* key) {
+    if(!iclass_elite_dict_check_presence(dict_type)) return false;
+    IclassEliteDict* dict = iclass_elite_dict_alloc(dict_type);
+    if(!dict) return false;
+
+    bool found = false;
+    size_t count;
+    while(picopass_worker->state == PicopassWorkerStateEliteRecovery &&
+          (count = iclass_elite_dict_get_next_keys(
+               dict, keys, PICOPASS_ELITE_RECOVERY_CHUNK_SIZE)) > 0) {
+        size_t key_found;
+        found = iclass_elite_recovery_check_keys(recovery, keys, count, &key_found);
+        picopass_worker->elite_keys_checked += found ? key_found + 1 : count;
+        if(found) {
+            memcpy(key, &keys[key_found * ICLASS_ELITE_KEY_LEN], ICLASS_ELITE_KEY_LEN);
+            break;
+        }
+        picopass_worker->callback(
+            PicopassWorkerEventEliteRecoveryProgress, picopass_worker->context);
+    }
+
+    iclass_elite_dict_free(dict);
+    return found;
+}
+
+void picopass_worker_elite_recovery(PicopassWorker* picopass_worker) {
+    PicopassPacs* pacs = &picopass_worker->dev_data->pacs;
+    PicopassWorkerEvent event = PicopassWorkerEventFail;
+
+    picopass_worker->elite_keys_checked = 0;
+    picopass_worker->elite_keys_total = 0;
+
+    IclassEliteMac* macs = malloc(sizeof(IclassEliteMac) * PICOPASS_ELITE_RECOVERY_MACS_MAX);
+    picopass_worker->elite_macs_count =
+        iclass_mac_log_load(macs, PICOPASS_ELITE_RECOVERY_MACS_MAX);
+
+    if(picopass_worker->elite_macs_count) {
+        const IclassEliteDictType dict_types[] = {
+            IclassEliteDictTypeUser,
+            IclassEliteDictTypeFlipper,
+        };
+        for(size_t i = 0; i < COUNT_OF(dict_types); i++) {
+            if(!iclass_elite_dict_check_presence(dict_types[i])) continue;
+            IclassEliteDict* dict = iclass_elite_dict_alloc(dict_types[i]);
+            if(!dict) continue;
+            picopass_worker->elite_keys_total += iclass_elite_dict_get_total_keys(dict);
+            iclass_elite_dict_free(dict);
+        }
+
+        IclassEliteRecovery* recovery =
+            iclass_elite_recovery_alloc(macs, picopass_worker->elite_macs_count);
+        uint8_t* keys = malloc(PICOPASS_ELITE_RECOVERY_CHUNK_SIZE * ICLASS_ELITE_KEY_LEN);
+        uint32_t start = furi_get_tick();
+
+        for(size_t i = 0; i < COUNT_OF(dict_types); i++) {
+            if(picopass_worker_elite_recovery_dict(
+                   picopass_worker, recovery, dict_types[i], keys, pacs->key)) {
+                event = PicopassWorkerEventSuccess;
+                break;
+            }
+        }
+
+        uint32_t elapsed = furi_get_tick() - start;
+        FURI_LOG_I(
+            TAG,
+            "Checked %lu keys against %lu MACs in %lu ms, %lu keys/s",
+            picopass_worker->elite_keys_checked,
+            picopass_worker->elite_macs_count,
+            elapsed,
+            elapsed ? picopass_worker->elite_keys_checked * 1000 / elapsed : 0);
+
+        free(keys);
+        iclass_elite_recovery_free(recovery);
+    }
+    free(macs);
+
+    if(picopass_worker->state == PicopassWorkerStateEliteRecovery) {
+        picopass_worker->callback(event, picopass_worker->context);
+    }
+}
@@ -12,6 +12,7 @@ typedef enum {
     // Main worker states
     PicopassWorkerStateDetect,
     PicopassWorkerStateWrite,
+    PicopassWorkerStateEliteRecovery,
     // Transition
     PicopassWorkerStateStop,
 } PicopassWorkerState;
@@ -27,6 +28,7 @@ typedef enum {
     PicopassWorkerEventSeEnabled,
 
     PicopassWorkerEventStartReading,
+    PicopassWorkerEventEliteRecoveryProgress,
 } PicopassWorkerEvent;
 
 typedef void (*PicopassWorkerCallback)(PicopassWorkerEvent event, void* context);
@@ -45,3 +47,16 @@ void picopass_worker_start(
     void* context);
 
 void picopass_worker_stop(PicopassWorker* picopass_worker);
+
+/** Get progress of elite key recovery from captured reader MACs
+ *
+ * @param      picopass_worker  PicopassWorker instance
+ * @param[out] macs_count       captured MACs count, 0 when there is nothing to recover from
+ * @param[out] keys_checked     dictionary keys checked so far
+ * @param[out] keys_total       dictionary keys total
+ */
+void picopass_worker_get_elite_recovery_progress(
+    PicopassWorker* picopass_worker,
+    uint32_t* macs_count,
+    uint32_t* keys_checked,
+    uint32_t* keys_total);
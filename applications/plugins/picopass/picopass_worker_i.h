@@ -23,6 +23,10 @@ struct PicopassWorker {
     void* context;
 
     PicopassWorkerState state;
+
+    uint32_t elite_macs_count;
+    uint32_t elite_keys_checked;
+    uint32_t elite_keys_total;
 };
 
 void picopass_worker_change_state(PicopassWorker* picopass_worker, PicopassWorkerState state);
@@ -31,3 +35,4 @@ int32_t picopass_worker_task(void* context);
 
 void picopass_worker_detect(PicopassWorker* picopass_worker);
 void picopass_worker_write(PicopassWorker* picopass_worker);
+void picopass_worker_elite_recovery(PicopassWorker* picopass_worker);
@@ -1,4 +1,5 @@
 #include "rfal_picopass.h"
+#include <lib/nfc/helpers/nfc_crc.h>
 
 #define RFAL_PICOPASS_TXRX_FLAGS                                                    \
     (FURI_HAL_NFC_LL_TXRX_FLAGS_CRC_TX_MANUAL | FURI_HAL_NFC_LL_TXRX_FLAGS_AGC_ON | \
@@ -17,30 +18,6 @@ typedef struct {
     uint8_t mac[4];
 } rfalPicoPassCheckReq;
 
-static uint16_t rfalPicoPassUpdateCcitt(uint16_t crcSeed, uint8_t dataByte) {
-    uint16_t crc = crcSeed;
-    uint8_t dat = dataByte;
-
-    dat ^= (uint8_t)(crc & 0xFFU);
-    dat ^= (dat << 4);
-
-    crc = (crc >> 8) ^ (((uint16_t)dat) << 8) ^ (((uint16_t)dat) << 3) ^ (((uint16_t)dat) >> 4);
-
-    return crc;
-}
-
-static uint16_t
-    rfalPicoPassCalculateCcitt(uint16_t preloadValue, const uint8_t* buf, uint16_t length) {
-    uint16_t crc = preloadValue;
-    uint16_t index;
-
-    for(index = 0; index < length; index++) {
-        crc = rfalPicoPassUpdateCcitt(crc, buf[index]);
-    }
-
-    return crc;
-}
-
 FuriHalNfcReturn rfalPicoPassPollerInitialize(void) {
     FuriHalNfcReturn ret;
 
@@ -173,8 +150,7 @@ FuriHalNfcReturn rfalPicoPassPollerReadBlock(uint8_t blockNum, rfalPicoPassReadB
 
     uint8_t txBuf[4] = {RFAL_PICOPASS_CMD_READ, 0, 0, 0};
     txBuf[1] = blockNum;
-    uint16_t crc = rfalPicoPassCalculateCcitt(0xE012, txBuf + 1, 1);
-    memcpy(txBuf + 2, &crc, sizeof(uint16_t));
+    nfc_crc_iclass_append(txBuf + 1, 1);
 
     uint16_t recvLen = 0;
     uint32_t flags = RFAL_PICOPASS_TXRX_FLAGS;
@@ -0,0 +1,89 @@
+#include "../picopass_i.h"
+#include <dolphin/dolphin.h>
+
+void picopass_elite_log_import_worker_callback(PicopassWorkerEvent event, void* context) {
+    Picopass* picopass = context;
+    view_dispatcher_send_custom_event(picopass->view_dispatcher, event);
+}
+
+static void picopass_scene_elite_log_import_update_progress(Picopass* picopass) {
+    uint32_t macs_count, keys_checked, keys_total;
+    picopass_worker_get_elite_recovery_progress(
+        picopass->worker, &macs_count, &keys_checked, &keys_total);
+
+    picopass_text_store_set(
+        picopass, "%lu MACs\n%lu/%lu keys", macs_count, keys_checked, keys_total);
+    popup_set_text(picopass->popup, picopass->text_store, 68, 46, AlignLeft, AlignTop);
+}
+
+void picopass_scene_elite_log_import_on_enter(void* context) {
+    Picopass* picopass = context;
+
+    // Setup view
+    Popup* popup = picopass->popup;
+    popup_set_header(popup, "Importing\nMAC log", 68, 20, AlignLeft, AlignTop);
+    popup_set_icon(popup, 0, 3, &I_RFIDDolphinReceive_97x61);
+
+    // Start worker
+    view_dispatcher_switch_to_view(picopass->view_dispatcher, PicopassViewPopup);
+    picopass_worker_start(
+        picopass->worker,
+        PicopassWorkerStateEliteRecovery,
+        &picopass->dev->dev_data,
+        picopass_elite_log_import_worker_callback,
+        picopass);
+}
+
+bool picopass_scene_elite_log_import_on_event(void* context, SceneManagerEvent event) {
+    Picopass* picopass = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        PicopassPacs* pacs = &picopass->dev->dev_data.pacs;
+        Popup* popup = picopass->popup;
+        if(event.event == PicopassWorkerEventEliteRecoveryProgress) {
+            picopass_scene_elite_log_import_update_progress(picopass);
+            consumed = true;
+        } else if(event.event == PicopassWorkerEventSuccess) {
+            DOLPHIN_DEED(DolphinDeedNfcReadSuccess);
+            notification_message(picopass->notifications, &sequence_success);
+            picopass_text_store_set(
+                picopass,
+                "%02X%02X%02X%02X\n%02X%02X%02X%02X",
+                pacs->key[0],
+                pacs->key[1],
+                pacs->key[2],
+                pacs->key[3],
+                pacs->key[4],
+                pacs->key[5],
+                pacs->key[6],
+                pacs->key[7]);
+            popup_set_header(popup, "Elite key\nfound", 68, 20, AlignLeft, AlignTop);
+            popup_set_text(popup, picopass->text_store, 68, 46, AlignLeft, AlignTop);
+            consumed = true;
+        } else if(event.event == PicopassWorkerEventFail) {
+            uint32_t macs_count, keys_checked, keys_total;
+            picopass_worker_get_elite_recovery_progress(
+                picopass->worker, &macs_count, &keys_checked, &keys_total);
+            notification_message(picopass->notifications, &sequence_error);
+            popup_set_header(
+                popup,
+                macs_count ? "Key not in\ndictionary" : "No MACs\nin log",
+                68,
+                20,
+                AlignLeft,
+                AlignTop);
+            consumed = true;
+        }
+    }
+    return consumed;
+}
+
+void picopass_scene_elite_log_import_on_exit(void* context) {
+    Picopass* picopass = context;
+
+    // Stop worker
+    picopass_worker_stop(picopass->worker);
+    // Clear view
+    popup_reset(picopass->popup);
+}
@@ -5,6 +5,7 @@ enum SubmenuIndex {
     SubmenuIndexSaved,
     SubmenuIndexAddManualy,
     SubmenuIndexDebug,
+    SubmenuIndexEliteLogImport,
 };
 
 void picopass_scene_start_submenu_callback(void* context, uint32_t index) {
@@ -19,6 +20,12 @@ void picopass_scene_start_on_enter(void* context) {
         submenu, "Read Card", SubmenuIndexRead, picopass_scene_start_submenu_callback, picopass);
     submenu_add_item(
         submenu, "Saved", SubmenuIndexSaved, picopass_scene_start_submenu_callback, picopass);
+    submenu_add_item(
+        submenu,
+        "Elite Key from MAC Log",
+        SubmenuIndexEliteLogImport,
+        picopass_scene_start_submenu_callback,
+        picopass);
 
     submenu_set_selected_item(
         submenu, scene_manager_get_scene_state(picopass->scene_manager, PicopassSceneStart));
@@ -37,6 +44,9 @@ bool picopass_scene_start_on_event(void* context, SceneManagerEvent event) {
         } else if(event.event == SubmenuIndexSaved) {
             scene_manager_next_scene(picopass->scene_manager, PicopassSceneFileSelect);
             consumed = true;
+        } else if(event.event == SubmenuIndexEliteLogImport) {
+            scene_manager_next_scene(picopass->scene_manager, PicopassSceneEliteLogImport);
+            consumed = true;
         }
         scene_manager_set_scene_state(picopass->scene_manager, PicopassSceneStart, event.event);
     }
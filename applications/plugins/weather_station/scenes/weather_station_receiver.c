@@ -115,7 +115,7 @@ void weather_station_scene_receiver_on_enter(void* context) {
 
     //Load history to receiver
     ws_view_receiver_exit(app->ws_receiver);
-    for(uint8_t i = 0; i < ws_history_get_item(app->txrx->history); i++) {
+    for(uint16_t i = 0; i < ws_history_get_item(app->txrx->history); i++) {
         furi_string_reset(str_buff);
         ws_history_get_text_item_menu(app->txrx->history, str_buff, i);
         ws_view_receiver_add_item_to_menu(
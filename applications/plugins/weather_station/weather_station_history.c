@@ -6,15 +6,29 @@
 
 #include <furi.h>
 
-#define WS_HISTORY_MAX 50
+#define WS_HISTORY_MAX 300
 #define TAG "WSHistory"
 
 typedef struct {
-    FuriString* item_str;
-    FlipperFormat* flipper_string;
-    uint8_t type;
-    uint32_t id;
-    SubGhzRadioPreset* preset;
+    FuriString* name;
+    uint8_t* data;
+    size_t data_size;
+} WSHistoryPreset;
+
+ARRAY_DEF(WSHistoryPresetArray, WSHistoryPreset, M_POD_OPLIST)
+
+#define M_OPL_WSHistoryPresetArray_t() ARRAY_OPLIST(WSHistoryPresetArray, M_POD_OPLIST)
+
+/** Compact history record, serialized to FlipperFormat only on demand
+ * Protocols that store more than WSBlockGeneric keep their full serialized text in `extra`
+ */
+typedef struct {
+    const SubGhzProtocol* protocol;
+    FuriString* extra;
+    WSBlockGeneric generic;
+    uint32_t frequency;
+    float rssi;
+    uint8_t preset_index;
 } WSHistoryItem;
 
 ARRAY_DEF(WSHistoryItemArray, WSHistoryItem, M_POD_OPLIST)
@@ -23,6 +37,7 @@ ARRAY_DEF(WSHistoryItemArray, WSHistoryItem, M_POD_OPLIST)
 
 typedef struct {
     WSHistoryItemArray_t data;
+    WSHistoryPresetArray_t presets;
 } WSHistoryStruct;
 
 struct WSHistory {
@@ -30,63 +45,103 @@ struct WSHistory {
     uint16_t last_index_write;
     uint8_t code_last_hash_data;
     FuriString* tmp_string;
+    FlipperFormat* flipper_string;
+    FlipperFormat* flipper_string_check;
+    SubGhzRadioPreset preset;
     WSHistoryStruct* history;
 };
 
 WSHistory* ws_history_alloc(void) {
     WSHistory* instance = malloc(sizeof(WSHistory));
     instance->tmp_string = furi_string_alloc();
+    instance->flipper_string = flipper_format_string_alloc();
+    instance->flipper_string_check = flipper_format_string_alloc();
+    instance->preset.name = furi_string_alloc();
     instance->history = malloc(sizeof(WSHistoryStruct));
     WSHistoryItemArray_init(instance->history->data);
+    WSHistoryPresetArray_init(instance->history->presets);
     return instance;
 }
 
-void ws_history_free(WSHistory* instance) {
-    furi_assert(instance);
-    furi_string_free(instance->tmp_string);
+static void ws_history_clean(WSHistory* instance) {
     for
         M_EACH(item, instance->history->data, WSHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
+            if(item->extra) {
+                furi_string_free(item->extra);
+            }
         }
+    WSHistoryItemArray_reset(instance->history->data);
+    for
+        M_EACH(preset, instance->history->presets, WSHistoryPresetArray_t) {
+            furi_string_free(preset->name);
+        }
+    WSHistoryPresetArray_reset(instance->history->presets);
+}
+
+void ws_history_free(WSHistory* instance) {
+    furi_assert(instance);
+    ws_history_clean(instance);
+    furi_string_free(instance->tmp_string);
+    flipper_format_free(instance->flipper_string);
+    flipper_format_free(instance->flipper_string_check);
+    furi_string_free(instance->preset.name);
     WSHistoryItemArray_clear(instance->history->data);
+    WSHistoryPresetArray_clear(instance->history->presets);
     free(instance->history);
     free(instance);
 }
 
+static WSHistoryPreset* ws_history_get_item_preset(WSHistory* instance, uint16_t idx) {
+    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
+    return WSHistoryPresetArray_get(instance->history->presets, item->preset_index);
+}
+
+static uint8_t ws_history_add_preset(WSHistory* instance, SubGhzRadioPreset* preset) {
+    // Only a handful of presets is used during one session, so they are shared by all items
+    size_t preset_count = WSHistoryPresetArray_size(instance->history->presets);
+    for(size_t i = 0; i < preset_count; i++) {
+        WSHistoryPreset* history_preset = WSHistoryPresetArray_get(instance->history->presets, i);
+        if((history_preset->data == preset->data) &&
+           (history_preset->data_size == preset->data_size) &&
+           (furi_string_cmp(history_preset->name, preset->name) == 0)) {
+            return i;
+        }
+    }
+    furi_check(preset_count <= UINT8_MAX);
+
+    WSHistoryPreset* history_preset = WSHistoryPresetArray_push_raw(instance->history->presets);
+    history_preset->name = furi_string_alloc_set(preset->name);
+    history_preset->data = preset->data;
+    history_preset->data_size = preset->data_size;
+    return preset_count;
+}
+
 uint32_t ws_history_get_frequency(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
     WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return item->preset->frequency;
+    return item->frequency;
 }
 
 SubGhzRadioPreset* ws_history_get_radio_preset(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
     WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return item->preset;
+    WSHistoryPreset* history_preset = ws_history_get_item_preset(instance, idx);
+    furi_string_set(instance->preset.name, history_preset->name);
+    instance->preset.frequency = item->frequency;
+    instance->preset.data = history_preset->data;
+    instance->preset.data_size = history_preset->data_size;
+    return &instance->preset;
 }
 
 const char* ws_history_get_preset(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return furi_string_get_cstr(item->preset->name);
+    return furi_string_get_cstr(ws_history_get_item_preset(instance, idx)->name);
 }
 
 void ws_history_reset(WSHistory* instance) {
     furi_assert(instance);
     furi_string_reset(instance->tmp_string);
-    for
-        M_EACH(item, instance->history->data, WSHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
-        }
-    WSHistoryItemArray_reset(instance->history->data);
+    ws_history_clean(instance);
     instance->last_index_write = 0;
     instance->code_last_hash_data = 0;
 }
@@ -99,29 +154,43 @@ uint16_t ws_history_get_item(WSHistory* instance) {
 uint8_t ws_history_get_type_protocol(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
     WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return item->type;
+    return item->protocol->type;
 }
 
 const char* ws_history_get_protocol_name(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
     WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    flipper_format_rewind(item->flipper_string);
-    if(!flipper_format_read_string(item->flipper_string, "Protocol", instance->tmp_string)) {
-        FURI_LOG_E(TAG, "Missing Protocol");
-        furi_string_reset(instance->tmp_string);
-    }
-    return furi_string_get_cstr(instance->tmp_string);
+    return item->protocol->name;
+}
+
+static bool ws_history_serialize_compact(
+    WSHistoryItem* item,
+    FlipperFormat* flipper_format,
+    SubGhzRadioPreset* preset) {
+    if(!ws_block_generic_serialize(&item->generic, flipper_format, preset)) return false;
+    // Serializer stamps current time, keep the time of reception instead
+    return flipper_format_update_uint32(flipper_format, "Ts", &item->generic.timestamp, 1);
 }
 
 FlipperFormat* ws_history_get_raw_data(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
     WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    if(item->flipper_string) {
-        return item->flipper_string;
+    Stream* stream = flipper_format_get_raw_stream(instance->flipper_string);
+    stream_clean(stream);
+
+    if(item->extra) {
+        stream_write_string(stream, item->extra);
     } else {
-        return NULL;
+        SubGhzRadioPreset* preset = ws_history_get_radio_preset(instance, idx);
+        if(!ws_history_serialize_compact(item, instance->flipper_string, preset)) {
+            FURI_LOG_E(TAG, "Serialize error");
+            return NULL;
+        }
     }
+    stream_rewind(stream);
+    return instance->flipper_string;
 }
+
 bool ws_history_get_text_space_left(WSHistory* instance, FuriString* output) {
     furi_assert(instance);
     if(instance->last_index_write == WS_HISTORY_MAX) {
@@ -133,9 +202,110 @@ bool ws_history_get_text_space_left(WSHistory* instance, FuriString* output) {
     return false;
 }
 
+static void ws_history_print_item(
+    FuriString* output,
+    const char* name,
+    uint32_t channel,
+    uint64_t data) {
+    if(channel != WS_NO_CHANNEL) {
+        furi_string_printf(output, "%s Ch:%X %llX", name, (uint8_t)channel, data);
+    } else {
+        furi_string_printf(output, "%s %llX", name, data);
+    }
+}
+
+static void ws_history_get_text_item_menu_extra(
+    WSHistory* instance,
+    FlipperFormat* flipper_string,
+    FuriString* output) {
+    do {
+        if(!flipper_format_rewind(flipper_string)) {
+            FURI_LOG_E(TAG, "Rewind error");
+            break;
+        }
+        if(!flipper_format_read_string(flipper_string, "Protocol", instance->tmp_string)) {
+            FURI_LOG_E(TAG, "Missing Protocol");
+            break;
+        }
+
+        if(!flipper_format_rewind(flipper_string)) {
+            FURI_LOG_E(TAG, "Rewind error");
+            break;
+        }
+        uint8_t key_data[sizeof(uint64_t)] = {0};
+        if(!flipper_format_read_hex(flipper_string, "Data", key_data, sizeof(uint64_t))) {
+            FURI_LOG_E(TAG, "Missing Data");
+            break;
+        }
+        uint64_t data = 0;
+        for(uint8_t i = 0; i < sizeof(uint64_t); i++) {
+            data = (data << 8) | key_data[i];
+        }
+        uint32_t temp_data = 0;
+        if(!flipper_format_read_uint32(flipper_string, "Ch", (uint32_t*)&temp_data, 1)) {
+            FURI_LOG_E(TAG, "Missing Channel");
+            break;
+        }
+        ws_history_print_item(output, furi_string_get_cstr(instance->tmp_string), temp_data, data);
+    } while(false);
+}
+
 void ws_history_get_text_item_menu(WSHistory* instance, FuriString* output, uint16_t idx) {
     WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    furi_string_set(output, item->item_str);
+    furi_string_reset(output);
+    if(item->extra) {
+        FlipperFormat* flipper_string = ws_history_get_raw_data(instance, idx);
+        ws_history_get_text_item_menu_extra(instance, flipper_string, output);
+    } else {
+        ws_history_print_item(
+            output, item->protocol->name, item->generic.channel, item->generic.data);
+    }
+}
+
+static bool ws_history_stream_equal(Stream* stream_a, Stream* stream_b) {
+    if(stream_size(stream_a) != stream_size(stream_b)) return false;
+    stream_rewind(stream_a);
+    stream_rewind(stream_b);
+
+    uint8_t buffer_a[32];
+    uint8_t buffer_b[32];
+    while(true) {
+        size_t read_a = stream_read(stream_a, buffer_a, sizeof(buffer_a));
+        size_t read_b = stream_read(stream_b, buffer_b, sizeof(buffer_b));
+        if(read_a != read_b) return false;
+        if(read_a == 0) return true;
+        if(memcmp(buffer_a, buffer_b, read_a) != 0) return false;
+    }
+}
+
+/** Fill item from instance->flipper_string, keep full text if compact form is lossy */
+static void
+    ws_history_item_fill(WSHistory* instance, WSHistoryItem* item, SubGhzRadioPreset* preset) {
+    if(item->extra) {
+        furi_string_free(item->extra);
+        item->extra = NULL;
+    }
+
+    memset(&item->generic, 0, sizeof(WSBlockGeneric));
+    item->generic.protocol_name = item->protocol->name;
+
+    bool is_compact =
+        ws_block_generic_deserialize(&item->generic, instance->flipper_string) &&
+        ws_history_serialize_compact(item, instance->flipper_string_check, preset) &&
+        ws_history_stream_equal(
+            flipper_format_get_raw_stream(instance->flipper_string),
+            flipper_format_get_raw_stream(instance->flipper_string_check));
+
+    if(!is_compact) {
+        item->extra = furi_string_alloc();
+        Stream* stream = flipper_format_get_raw_stream(instance->flipper_string);
+        stream_rewind(stream);
+        uint8_t buffer[32];
+        size_t read = 0;
+        while((read = stream_read(stream, buffer, sizeof(buffer))) > 0) {
+            furi_string_cat_printf(item->extra, "%.*s", (int)read, buffer);
+        }
+    }
 }
 
 WSHistoryStateAddKey
@@ -156,7 +326,7 @@ WSHistoryStateAddKey
     instance->code_last_hash_data = subghz_protocol_decoder_base_get_hash_data(decoder_base);
     instance->last_update_timestamp = furi_get_tick();
 
-    FlipperFormat* fff = flipper_format_string_alloc();
+    FlipperFormat* fff = instance->flipper_string;
     uint32_t id = 0;
     subghz_protocol_decoder_base_serialize(decoder_base, fff, preset);
 
@@ -170,76 +340,32 @@ WSHistoryStateAddKey
             break;
         }
     } while(false);
-    flipper_format_free(fff);
 
     //Update record if found
-    bool sensor_found = false;
     for(size_t i = 0; i < WSHistoryItemArray_size(instance->history->data); i++) {
         WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, i);
-        if(item->id == id) {
-            sensor_found = true;
-            Stream* flipper_string_stream = flipper_format_get_raw_stream(item->flipper_string);
-            stream_clean(flipper_string_stream);
-            subghz_protocol_decoder_base_serialize(decoder_base, item->flipper_string, preset);
+        if(item->generic.id == id) {
+            item->protocol = decoder_base->protocol;
+            item->frequency = preset->frequency;
+            item->rssi = furi_hal_subghz_get_rssi();
+            item->preset_index = ws_history_add_preset(instance, preset);
+            ws_history_item_fill(instance, item, preset);
+            item->generic.id = id;
             return WSHistoryStateAddKeyUpdateData;
         }
     }
 
     // or add new record
-    if(!sensor_found) {
-        WSHistoryItem* item = WSHistoryItemArray_push_raw(instance->history->data);
-        item->preset = malloc(sizeof(SubGhzRadioPreset));
-        item->type = decoder_base->protocol->type;
-        item->preset->frequency = preset->frequency;
-        item->preset->name = furi_string_alloc();
-        furi_string_set(item->preset->name, preset->name);
-        item->preset->data = preset->data;
-        item->preset->data_size = preset->data_size;
-        item->id = id;
-
-        item->item_str = furi_string_alloc();
-        item->flipper_string = flipper_format_string_alloc();
-        subghz_protocol_decoder_base_serialize(decoder_base, item->flipper_string, preset);
-
-        do {
-            if(!flipper_format_rewind(item->flipper_string)) {
-                FURI_LOG_E(TAG, "Rewind error");
-                break;
-            }
-            if(!flipper_format_read_string(
-                   item->flipper_string, "Protocol", instance->tmp_string)) {
-                FURI_LOG_E(TAG, "Missing Protocol");
-                break;
-            }
-
-            if(!flipper_format_rewind(item->flipper_string)) {
-                FURI_LOG_E(TAG, "Rewind error");
-                break;
-            }
-            uint8_t key_data[sizeof(uint64_t)] = {0};
-            if(!flipper_format_read_hex(item->flipper_string, "Data", key_data, sizeof(uint64_t))) {
-                FURI_LOG_E(TAG, "Missing Data");
-                break;
-            }
-            uint64_t data = 0;
-            for(uint8_t i = 0; i < sizeof(uint64_t); i++) {
-                data = (data << 8) | key_data[i];
-            }
-            uint32_t temp_data = 0;
-            if(!flipper_format_read_uint32(item->flipper_string, "Ch", (uint32_t*)&temp_data, 1)) {
-                FURI_LOG_E(TAG, "Missing Channel");
-                break;
-            }
-            if(temp_data != WS_NO_CHANNEL) {
-                furi_string_cat_printf(instance->tmp_string, " Ch:%X", (uint8_t)temp_data);
-            }
+    WSHistoryItem* item = WSHistoryItemArray_push_raw(instance->history->data);
+    item->protocol = decoder_base->protocol;
+    item->extra = NULL;
+    item->frequency = preset->frequency;
+    item->rssi = furi_hal_subghz_get_rssi();
+    item->preset_index = ws_history_add_preset(instance, preset);
+    ws_history_item_fill(instance, item, preset);
+    // Id is the lookup key, keep it even if the record is stored as text
+    item->generic.id = id;
 
-            furi_string_printf(
-                item->item_str, "%s %llX", furi_string_get_cstr(instance->tmp_string), data);
-
-        } while(false);
-        instance->last_index_write++;
-        return WSHistoryStateAddKeyNewDada;
-    }
-    return WSHistoryStateAddKeyUnknown;
+    instance->last_index_write++;
+    return WSHistoryStateAddKeyNewDada;
 }
@@ -44,6 +44,8 @@ struct AnimationManager {
     BubbleAnimationView* animation_view;
     OneShotView* one_shot_view;
     FuriTimer* idle_animation_timer;
+    FuriWork* preload_work;
+    StorageAnimation* preloaded_animation;
     StorageAnimation* current_animation;
     AnimationManagerInteractCallback interact_callback;
     AnimationManagerSetNewIdleAnimationCallback new_idle_callback;
@@ -62,6 +64,7 @@ static void animation_manager_replace_current_animation(
     StorageAnimation* storage_animation);
 static void animation_manager_start_new_idle(AnimationManager* animation_manager);
 static bool animation_manager_check_blocking(AnimationManager* animation_manager);
+static void animation_manager_drop_preloaded(AnimationManager* animation_manager);
 static bool animation_manager_is_valid_idle_animation(
     const StorageAnimationManifestInfo* info,
     const DolphinStats* stats);
@@ -97,6 +100,7 @@ void animation_manager_set_interact_callback(
 void animation_manager_set_dummy_mode_state(AnimationManager* animation_manager, bool enabled) {
     furi_assert(animation_manager);
     animation_manager->dummy_mode = enabled;
+    animation_manager_drop_preloaded(animation_manager);
     animation_manager_start_new_idle(animation_manager);
 }
 
@@ -119,14 +123,32 @@ static void animation_manager_check_blocking_callback(const void* message, void*
     }
 }
 
-static void animation_manager_timer_callback(void* context) {
+/* Selecting and loading next idle animation reads SD card, keep it off desktop thread */
+static void animation_manager_preload_work(void* context) {
     furi_assert(context);
     AnimationManager* animation_manager = context;
+    if(!animation_manager->preloaded_animation) {
+        animation_manager->preloaded_animation =
+            animation_manager_select_idle_animation(animation_manager);
+    }
     if(animation_manager->new_idle_callback) {
         animation_manager->new_idle_callback(animation_manager->context);
     }
 }
 
+static void animation_manager_drop_preloaded(AnimationManager* animation_manager) {
+    furi_work_cancel(animation_manager->preload_work);
+    if(animation_manager->preloaded_animation) {
+        animation_storage_free_storage_animation(&animation_manager->preloaded_animation);
+    }
+}
+
+static void animation_manager_timer_callback(void* context) {
+    furi_assert(context);
+    AnimationManager* animation_manager = context;
+    furi_work_submit(animation_manager->preload_work);
+}
+
 static void animation_manager_interact_callback(void* context) {
     furi_assert(context);
     AnimationManager* animation_manager = context;
@@ -199,7 +221,13 @@ bool animation_manager_interact_process(AnimationManager* animation_manager) {
 static void animation_manager_start_new_idle(AnimationManager* animation_manager) {
     furi_assert(animation_manager);
 
-    StorageAnimation* new_animation = animation_manager_select_idle_animation(animation_manager);
+    // Waits for preload in progress, otherwise selects in place
+    furi_work_cancel(animation_manager->preload_work);
+    StorageAnimation* new_animation = animation_manager->preloaded_animation;
+    animation_manager->preloaded_animation = NULL;
+    if(!new_animation) {
+        new_animation = animation_manager_select_idle_animation(animation_manager);
+    }
     animation_manager_replace_current_animation(animation_manager, new_animation);
     const BubbleAnimation* bubble_animation =
         animation_storage_get_bubble_animation(animation_manager->current_animation);
@@ -252,6 +280,7 @@ static bool animation_manager_check_blocking(AnimationManager* animation_manager
 
     if(blocking_animation) {
         furi_timer_stop(animation_manager->idle_animation_timer);
+        animation_manager_drop_preloaded(animation_manager);
         animation_manager_replace_current_animation(animation_manager, blocking_animation);
         /* no timer starting because this is blocking animation */
         animation_manager->state = AnimationManagerStateBlocked;
@@ -289,6 +318,9 @@ AnimationManager* animation_manager_alloc(void) {
 
     animation_manager->idle_animation_timer =
         furi_timer_alloc(animation_manager_timer_callback, FuriTimerTypeOnce, animation_manager);
+    animation_manager->preload_work = furi_work_alloc(
+        furi_work_queue_get_system(), animation_manager_preload_work, animation_manager);
+    furi_work_set_priority(animation_manager->preload_work, FuriWorkPriorityLow);
     bubble_animation_view_set_interact_callback(
         animation_manager->animation_view, animation_manager_interact_callback, animation_manager);
 
@@ -323,11 +355,14 @@ void animation_manager_free(AnimationManager* animation_manager) {
         storage_get_pubsub(storage), animation_manager->pubsub_subscription_storage);
     furi_record_close(RECORD_STORAGE);
 
+    furi_timer_free(animation_manager->idle_animation_timer);
+    animation_manager_drop_preloaded(animation_manager);
+    furi_work_free(animation_manager->preload_work);
+
     furi_string_free(animation_manager->freezed_animation_name);
     View* animation_view = bubble_animation_get_view(animation_manager->animation_view);
     view_stack_remove_view(animation_manager->view_stack, animation_view);
     bubble_animation_view_free(animation_manager->animation_view);
-    furi_timer_free(animation_manager->idle_animation_timer);
 }
 
 View* animation_manager_get_animation_view(AnimationManager* animation_manager) {
@@ -460,6 +495,7 @@ void animation_manager_unload_and_stall_animation(AnimationManager* animation_ma
     } else {
         furi_assert(0);
     }
+    animation_manager_drop_preloaded(animation_manager);
 
     FURI_LOG_I(
         TAG,
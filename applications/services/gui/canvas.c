@@ -20,6 +20,9 @@ Canvas* canvas_init() {
     // Setup u8g2
     u8g2_Setup_st756x_flipper(&canvas->fb, U8G2_R0, u8x8_hw_spi_stm32, u8g2_gpio_and_delay_stm32);
     canvas->orientation = CanvasOrientationHorizontal;
+    // Glyph widths are measured lazily on first use
+    canvas->font = FontTotalNumber;
+    memset(canvas->glyph_width, CANVAS_GLYPH_WIDTH_UNKNOWN, sizeof(canvas->glyph_width));
     // Initialize display
     u8g2_InitDisplay(&canvas->fb);
     // Wake up display
@@ -135,6 +138,7 @@ void canvas_set_font(Canvas* canvas, Font font) {
     } else {
         furi_crash(NULL);
     }
+    canvas->font = font;
 }
 
 void canvas_draw_str(Canvas* canvas, uint8_t x, uint8_t y, const char* str) {
@@ -196,7 +200,17 @@ uint16_t canvas_string_width(Canvas* canvas, const char* str) {
 
 uint8_t canvas_glyph_width(Canvas* canvas, char symbol) {
     furi_assert(canvas);
-    return u8g2_GetGlyphWidth(&canvas->fb, symbol);
+    if(canvas->font >= FontTotalNumber || symbol < CANVAS_GLYPH_CACHE_FIRST ||
+       symbol > CANVAS_GLYPH_CACHE_LAST) {
+        return u8g2_GetGlyphWidth(&canvas->fb, symbol);
+    }
+
+    uint8_t* glyph_width =
+        &canvas->glyph_width[canvas->font][symbol - CANVAS_GLYPH_CACHE_FIRST];
+    if(*glyph_width == CANVAS_GLYPH_WIDTH_UNKNOWN) {
+        *glyph_width = u8g2_GetGlyphWidth(&canvas->fb, symbol);
+    }
+    return *glyph_width;
 }
 
 void canvas_draw_bitmap(
@@ -8,6 +8,13 @@
 #include "canvas.h"
 #include <u8g2.h>
 
+/** First and last glyph covered by glyph width cache */
+#define CANVAS_GLYPH_CACHE_FIRST ' '
+#define CANVAS_GLYPH_CACHE_LAST '~'
+#define CANVAS_GLYPH_CACHE_SIZE (CANVAS_GLYPH_CACHE_LAST - CANVAS_GLYPH_CACHE_FIRST + 1)
+/** Marker for glyph width that was not measured yet */
+#define CANVAS_GLYPH_WIDTH_UNKNOWN 0xFF
+
 /** Canvas structure
  */
 struct Canvas {
@@ -17,6 +24,8 @@ struct Canvas {
     uint8_t offset_y;
     uint8_t width;
     uint8_t height;
+    Font font;
+    uint8_t glyph_width[FontTotalNumber][CANVAS_GLYPH_CACHE_SIZE];
 };
 
 /** Allocate memory and initialize canvas
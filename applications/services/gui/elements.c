@@ -539,6 +539,21 @@ void elements_string_fit_width(Canvas* canvas, FuriString* string, uint8_t width
     uint16_t len_px = canvas_string_width(canvas, furi_string_get_cstr(string));
     if(len_px > width) {
         width -= canvas_string_width(canvas, "...");
+
+        // Cut at the first glyph that doesn't fit, in one pass over cached glyph widths
+        const char* str = furi_string_get_cstr(string);
+        size_t str_len = furi_string_size(string);
+        size_t fit_len = 0;
+        uint16_t fit_px = 0;
+        while(fit_len < str_len) {
+            uint8_t glyph_px = canvas_glyph_width(canvas, str[fit_len]);
+            if(fit_px + glyph_px > width) break;
+            fit_px += glyph_px;
+            fit_len++;
+        }
+        // Last glyph is measured by its bounding box, not advance: one more may still fit
+        furi_string_left(string, fit_len + 2);
+
         do {
             furi_string_left(string, furi_string_size(string) - 1);
             len_px = canvas_string_width(canvas, furi_string_get_cstr(string));
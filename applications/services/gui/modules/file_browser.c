@@ -233,6 +233,7 @@ void file_browser_start(FileBrowser* browser, FuriString* path) {
     file_browser_worker_set_list_callback(browser->worker, browser_list_load_cb);
     file_browser_worker_set_item_callback(browser->worker, browser_list_item_cb);
     file_browser_worker_set_long_load_callback(browser->worker, browser_long_load_cb);
+    file_browser_worker_set_sort(browser->worker, true);
 }
 
 void file_browser_stop(FileBrowser* browser) {
@@ -7,6 +7,8 @@
 #include <storage/storage.h>
 #include <furi.h>
 #include <stddef.h>
+#include <stdatomic.h>
+#include <strings.h>
 #include "toolbox/path.h"
 
 #define TAG "BrowserWorker"
@@ -16,23 +18,86 @@
 #define FILE_NAME_LEN_MAX 256
 #define LONG_LOAD_THRESHOLD 100
 
+#define CACHE_NAMES_BLOCK_SIZE 1024
+#define CACHE_RAM_MAX (16 * 1024)
+/* Sorted runs merged at once, each keeps its head record in RAM */
+#define CACHE_MERGE_WAYS 8
+
 typedef enum {
-    WorkerEvtStop = (1 << 0),
-    WorkerEvtLoad = (1 << 1),
-    WorkerEvtFolderEnter = (1 << 2),
-    WorkerEvtFolderExit = (1 << 3),
-    WorkerEvtFolderRefresh = (1 << 4),
-    WorkerEvtConfigChange = (1 << 5),
+    WorkerEvtLoad = (1 << 0),
+    WorkerEvtFolderEnter = (1 << 1),
+    WorkerEvtFolderExit = (1 << 2),
+    WorkerEvtFolderRefresh = (1 << 3),
+    WorkerEvtConfigChange = (1 << 4),
 } WorkerEvtFlags;
 
-#define WORKER_FLAGS_ALL                                                          \
-    (WorkerEvtStop | WorkerEvtLoad | WorkerEvtFolderEnter | WorkerEvtFolderExit | \
-     WorkerEvtFolderRefresh | WorkerEvtConfigChange)
-
 ARRAY_DEF(idx_last_array, int32_t)
 
+typedef struct {
+    const char* name;
+    uint32_t size;
+    bool is_folder;
+} BrowserCacheItem;
+
+ARRAY_DEF(BrowserCacheItemArray, BrowserCacheItem, M_POD_OPLIST)
+ARRAY_DEF(BrowserCacheRunArray, uint32_t, M_POD_OPLIST)
+
+typedef struct BrowserCacheNameBlock BrowserCacheNameBlock;
+
+struct BrowserCacheNameBlock {
+    BrowserCacheNameBlock* next;
+    size_t used;
+    char data[CACHE_NAMES_BLOCK_SIZE];
+};
+
+/** Record of spilled listing in cache file, fixed size for O(1) seek */
+typedef struct {
+    uint32_t size;
+    uint8_t is_folder;
+    char name[FILE_NAME_LEN_MAX];
+} BrowserCacheRecord;
+
+typedef enum {
+    BrowserCacheTypeNone, /**< No listing, folder is read directly */
+    BrowserCacheTypeRam, /**< Listing is held in RAM */
+    BrowserCacheTypeFile, /**< Listing is too big for RAM and spilled to cache file */
+} BrowserCacheType;
+
+/** Listing of the current folder, filtered and optionally sorted
+ *
+ * Spilled listing is sorted as in external merge sort: RAM is filled, sorted
+ * and appended to cache file as a run, then runs are merged into the second
+ * file, CACHE_MERGE_WAYS at a time, until one run is left.
+ */
+typedef struct {
+    BrowserCacheType type;
+    bool sort;
+    FuriString* path;
+    uint32_t generation;
+    uint32_t items_cnt;
+
+    BrowserCacheItemArray_t items;
+    BrowserCacheNameBlock* names;
+    size_t ram_used;
+
+    // Files are per instance, several browsers may be open at once
+    File* file;
+    FuriString* file_path;
+    File* merge_file;
+    FuriString* merge_path;
+    uint32_t file_cnt;
+    BrowserCacheRunArray_t runs;
+    BrowserCacheRecord record;
+} BrowserCache;
+
+/** Events are accumulated in flags and handled by work on system work queue */
 struct BrowserWorker {
-    FuriThread* thread;
+    FuriWork* work;
+    atomic_uint flags;
+
+    FuriString* path;
+    FuriString* filename;
+    uint32_t items_cnt;
 
     FuriString* filter_extension;
     FuriString* path_start;
@@ -43,8 +108,12 @@ struct BrowserWorker {
     uint32_t load_count;
     bool skip_assets;
     bool hide_dot_files;
+    bool sort_items;
     idx_last_array_t idx_last;
 
+    Storage* storage;
+    BrowserCache cache;
+
     void* cb_ctx;
     BrowserWorkerFolderOpenCallback folder_cb;
     BrowserWorkerListLoadCallback list_load_cb;
@@ -76,7 +145,20 @@ static bool browser_path_trim(FuriString* path) {
     return is_root;
 }
 
-static bool browser_filter_by_name(BrowserWorker* browser, FuriString* name, bool is_folder) {
+static bool browser_is_service_file(FuriString* path, FuriString* name) {
+    if((furi_string_cmp_str(path, STORAGE_EXT_PATH_PREFIX) != 0) &&
+       (furi_string_cmp_str(path, STORAGE_ANY_PATH_PREFIX) != 0)) {
+        return false;
+    }
+    return furi_string_start_with_str(name, strrchr(STORAGE_BROWSER_CACHE_PATH, '/') + 1) ||
+           (furi_string_cmp_str(name, strrchr(STORAGE_HASH_CACHE_PATH, '/') + 1) == 0);
+}
+
+static bool browser_filter_by_name(
+    BrowserWorker* browser,
+    FuriString* path,
+    FuriString* name,
+    bool is_folder) {
     // Skip dot files if enabled
     if(browser->hide_dot_files) {
         if(furi_string_start_with_str(name, ".")) {
@@ -92,6 +174,10 @@ static bool browser_filter_by_name(BrowserWorker* browser, FuriString* name, boo
             return true;
         }
     } else {
+        // Skip storage own cache files
+        if(browser_is_service_file(path, name)) {
+            return false;
+        }
         // Filter files by extension
         if((furi_string_empty(browser->filter_extension)) ||
            (furi_string_cmp_str(browser->filter_extension, "*") == 0)) {
@@ -129,6 +215,356 @@ static bool browser_folder_check_and_switch(FuriString* path) {
     return is_root;
 }
 
+static void browser_cache_init(BrowserCache* cache, Storage* storage) {
+    static atomic_uint instance_id = 0;
+    uint32_t id = atomic_fetch_add(&instance_id, 1);
+
+    cache->type = BrowserCacheTypeNone;
+    cache->sort = false;
+    cache->path = furi_string_alloc();
+    cache->generation = 0;
+    cache->items_cnt = 0;
+    BrowserCacheItemArray_init(cache->items);
+    cache->names = NULL;
+    cache->ram_used = 0;
+    cache->file = storage_file_alloc(storage);
+    cache->file_path = furi_string_alloc_printf("%s.%lu", STORAGE_BROWSER_CACHE_PATH, id);
+    cache->merge_file = storage_file_alloc(storage);
+    cache->merge_path = furi_string_alloc_printf("%s.%lu.tmp", STORAGE_BROWSER_CACHE_PATH, id);
+    cache->file_cnt = 0;
+    BrowserCacheRunArray_init(cache->runs);
+}
+
+static void browser_cache_free_names(BrowserCache* cache) {
+    while(cache->names) {
+        BrowserCacheNameBlock* block = cache->names;
+        cache->names = block->next;
+        free(block);
+    }
+    cache->ram_used = 0;
+    BrowserCacheItemArray_reset(cache->items);
+}
+
+static void browser_cache_reset(BrowserCache* cache, Storage* storage) {
+    browser_cache_free_names(cache);
+
+    if(cache->type == BrowserCacheTypeFile) {
+        storage_file_close(cache->file);
+        storage_simply_remove(storage, furi_string_get_cstr(cache->file_path));
+        storage_file_close(cache->merge_file);
+        storage_simply_remove(storage, furi_string_get_cstr(cache->merge_path));
+    }
+
+    cache->type = BrowserCacheTypeNone;
+    cache->items_cnt = 0;
+    cache->file_cnt = 0;
+    BrowserCacheRunArray_reset(cache->runs);
+    furi_string_reset(cache->path);
+}
+
+static void browser_cache_deinit(BrowserCache* cache, Storage* storage) {
+    browser_cache_reset(cache, storage);
+    storage_file_free(cache->file);
+    storage_file_free(cache->merge_file);
+    furi_string_free(cache->file_path);
+    furi_string_free(cache->merge_path);
+    BrowserCacheRunArray_clear(cache->runs);
+    BrowserCacheItemArray_clear(cache->items);
+    furi_string_free(cache->path);
+}
+
+static int browser_cache_name_cmp(
+    const char* name_a,
+    bool is_folder_a,
+    const char* name_b,
+    bool is_folder_b) {
+    // Folders go first
+    if(is_folder_a != is_folder_b) {
+        return is_folder_a ? -1 : 1;
+    }
+    return strcasecmp(name_a, name_b);
+}
+
+static int browser_cache_item_cmp(const void* a, const void* b) {
+    const BrowserCacheItem* item_a = a;
+    const BrowserCacheItem* item_b = b;
+    return browser_cache_name_cmp(
+        item_a->name, item_a->is_folder, item_b->name, item_b->is_folder);
+}
+
+static int browser_cache_record_cmp(const BrowserCacheRecord* a, const BrowserCacheRecord* b) {
+    return browser_cache_name_cmp(a->name, a->is_folder, b->name, b->is_folder);
+}
+
+static bool browser_cache_write_record(
+    BrowserCache* cache,
+    File* file,
+    const char* name,
+    uint32_t size,
+    bool is_folder) {
+    memset(&cache->record, 0, sizeof(BrowserCacheRecord));
+    cache->record.size = size;
+    cache->record.is_folder = is_folder;
+    strlcpy(cache->record.name, name, FILE_NAME_LEN_MAX);
+    return storage_file_write(file, &cache->record, sizeof(BrowserCacheRecord)) ==
+           sizeof(BrowserCacheRecord);
+}
+
+static bool browser_cache_read_record(File* file, uint32_t idx, BrowserCacheRecord* record) {
+    if(!storage_file_seek(file, idx * sizeof(BrowserCacheRecord), true)) return false;
+    if(storage_file_read(file, record, sizeof(BrowserCacheRecord)) != sizeof(BrowserCacheRecord))
+        return false;
+    record->name[FILE_NAME_LEN_MAX - 1] = '\0';
+    return true;
+}
+
+/** Append items held in RAM to cache file, as a sorted run if sorting is on */
+static bool browser_cache_write_run(BrowserCache* cache) {
+    size_t count = BrowserCacheItemArray_size(cache->items);
+    if(!count) return true;
+
+    if(cache->sort) {
+        qsort(
+            BrowserCacheItemArray_get(cache->items, 0),
+            count,
+            sizeof(BrowserCacheItem),
+            browser_cache_item_cmp);
+        BrowserCacheRunArray_push_back(cache->runs, cache->file_cnt);
+    }
+
+    if(!storage_file_seek(cache->file, cache->file_cnt * sizeof(BrowserCacheRecord), true)) {
+        return false;
+    }
+
+    BrowserCacheItemArray_it_t it;
+    for(BrowserCacheItemArray_it(it, cache->items); !BrowserCacheItemArray_end_p(it);
+        BrowserCacheItemArray_next(it)) {
+        const BrowserCacheItem* item = BrowserCacheItemArray_cref(it);
+        if(!browser_cache_write_record(
+               cache, cache->file, item->name, item->size, item->is_folder)) {
+            return false;
+        }
+        cache->file_cnt++;
+    }
+
+    // Names are in the file now, release RAM
+    browser_cache_free_names(cache);
+    return true;
+}
+
+static void browser_cache_spill(BrowserCache* cache, Storage* storage) {
+    bool success = false;
+    if(storage_file_open(
+           cache->file,
+           furi_string_get_cstr(cache->file_path),
+           FSAM_READ_WRITE,
+           FSOM_CREATE_ALWAYS)) {
+        cache->type = BrowserCacheTypeFile;
+        success = browser_cache_write_run(cache);
+    } else {
+        storage_file_close(cache->file);
+    }
+
+    if(!success) {
+        FURI_LOG_W(TAG, "Cache spill failed, folder will be read directly");
+        browser_cache_reset(cache, storage);
+    }
+}
+
+/** Merge up to CACHE_MERGE_WAYS runs starting at run index first into merge file */
+static bool browser_cache_merge_runs(
+    BrowserCache* cache,
+    size_t first,
+    size_t ways,
+    BrowserCacheRecord* heads,
+    uint32_t* next,
+    uint32_t* end) {
+    size_t runs_cnt = BrowserCacheRunArray_size(cache->runs);
+    for(size_t i = 0; i < ways; i++) {
+        size_t run = first + i;
+        next[i] = *BrowserCacheRunArray_get(cache->runs, run);
+        end[i] = (run + 1 < runs_cnt) ? *BrowserCacheRunArray_get(cache->runs, run + 1) :
+                                        cache->file_cnt;
+        if(!browser_cache_read_record(cache->file, next[i]++, &heads[i])) return false;
+    }
+
+    while(true) {
+        // Head of run is valid while next does not pass its end
+        size_t min = ways;
+        for(size_t i = 0; i < ways; i++) {
+            if(next[i] > end[i]) continue;
+            if(min == ways || browser_cache_record_cmp(&heads[i], &heads[min]) < 0) {
+                min = i;
+            }
+        }
+        if(min == ways) break;
+
+        if(storage_file_write(cache->merge_file, &heads[min], sizeof(BrowserCacheRecord)) !=
+           sizeof(BrowserCacheRecord)) {
+            return false;
+        }
+
+        if(next[min] < end[min]) {
+            if(!browser_cache_read_record(cache->file, next[min], &heads[min])) return false;
+        }
+        next[min]++;
+    }
+    return true;
+}
+
+/** Merge sorted runs until whole cache file is one sorted run */
+static bool browser_cache_merge(BrowserCache* cache) {
+    BrowserCacheRecord* heads = malloc(sizeof(BrowserCacheRecord) * CACHE_MERGE_WAYS);
+    uint32_t next[CACHE_MERGE_WAYS];
+    uint32_t end[CACHE_MERGE_WAYS];
+    BrowserCacheRunArray_t merged;
+    BrowserCacheRunArray_init(merged);
+    bool success = true;
+
+    while(BrowserCacheRunArray_size(cache->runs) > 1) {
+        if(!storage_file_open(
+               cache->merge_file,
+               furi_string_get_cstr(cache->merge_path),
+               FSAM_READ_WRITE,
+               FSOM_CREATE_ALWAYS)) {
+            success = false;
+            break;
+        }
+
+        // Groups of runs are written in order, merged run starts where its first one did
+        BrowserCacheRunArray_reset(merged);
+        size_t runs_cnt = BrowserCacheRunArray_size(cache->runs);
+        for(size_t first = 0; success && first < runs_cnt; first += CACHE_MERGE_WAYS) {
+            size_t ways = MIN((size_t)CACHE_MERGE_WAYS, runs_cnt - first);
+            BrowserCacheRunArray_push_back(merged, *BrowserCacheRunArray_get(cache->runs, first));
+            success = browser_cache_merge_runs(cache, first, ways, heads, next, end);
+        }
+        if(!success) break;
+
+        // Merged file becomes cache file, old one is reused for next pass
+        storage_file_close(cache->file);
+        File* file = cache->file;
+        cache->file = cache->merge_file;
+        cache->merge_file = file;
+        FuriString* path = cache->file_path;
+        cache->file_path = cache->merge_path;
+        cache->merge_path = path;
+        BrowserCacheRunArray_swap(cache->runs, merged);
+    }
+
+    BrowserCacheRunArray_clear(merged);
+    free(heads);
+    return success;
+}
+
+static void browser_cache_add(
+    BrowserCache* cache,
+    Storage* storage,
+    const char* name,
+    const FileInfo* file_info) {
+    bool is_folder = (file_info->flags & FSF_DIRECTORY);
+    size_t name_size = strlen(name) + 1;
+
+    // Spilled listing is still staged in RAM when it is to be sorted
+    bool to_ram = (cache->type == BrowserCacheTypeRam) ||
+                  (cache->type == BrowserCacheTypeFile && cache->sort);
+
+    if(to_ram) {
+        size_t item_cost = name_size + sizeof(BrowserCacheItem);
+        if(cache->ram_used + item_cost > CACHE_RAM_MAX) {
+            if(cache->type == BrowserCacheTypeRam) {
+                browser_cache_spill(cache, storage);
+            } else if(!browser_cache_write_run(cache)) {
+                FURI_LOG_W(TAG, "Cache write failed, folder will be read directly");
+                browser_cache_reset(cache, storage);
+            }
+            to_ram = (cache->type == BrowserCacheTypeFile && cache->sort);
+        }
+    }
+
+    if(to_ram) {
+        if(!cache->names || (cache->names->used + name_size > CACHE_NAMES_BLOCK_SIZE)) {
+            BrowserCacheNameBlock* block = malloc(sizeof(BrowserCacheNameBlock));
+            block->used = 0;
+            block->next = cache->names;
+            cache->names = block;
+        }
+        char* name_ptr = &cache->names->data[cache->names->used];
+        memcpy(name_ptr, name, name_size);
+        cache->names->used += name_size;
+        cache->ram_used += name_size + sizeof(BrowserCacheItem);
+
+        BrowserCacheItem item = {
+            .name = name_ptr,
+            .size = file_info->size,
+            .is_folder = is_folder,
+        };
+        BrowserCacheItemArray_push_back(cache->items, item);
+    } else if(cache->type == BrowserCacheTypeFile) {
+        if(browser_cache_write_record(cache, cache->file, name, file_info->size, is_folder)) {
+            cache->file_cnt++;
+        } else {
+            FURI_LOG_W(TAG, "Cache write failed, folder will be read directly");
+            browser_cache_reset(cache, storage);
+        }
+    }
+
+    cache->items_cnt++;
+}
+
+/** Sort listing if enabled, spilled runs are written out and merged */
+static void browser_cache_finish(BrowserCache* cache, Storage* storage) {
+    if(cache->type == BrowserCacheTypeRam) {
+        if(cache->sort && BrowserCacheItemArray_size(cache->items) > 1) {
+            qsort(
+                BrowserCacheItemArray_get(cache->items, 0),
+                BrowserCacheItemArray_size(cache->items),
+                sizeof(BrowserCacheItem),
+                browser_cache_item_cmp);
+        }
+    } else if(cache->type == BrowserCacheTypeFile && cache->sort) {
+        if(!browser_cache_write_run(cache) || !browser_cache_merge(cache)) {
+            FURI_LOG_W(TAG, "Cache merge failed, folder will be read directly");
+            browser_cache_reset(cache, storage);
+        }
+    }
+}
+
+static bool browser_cache_get(
+    BrowserCache* cache,
+    uint32_t idx,
+    const char** name,
+    bool* is_folder) {
+    if(idx >= cache->items_cnt) return false;
+
+    if(cache->type == BrowserCacheTypeRam) {
+        const BrowserCacheItem* item = BrowserCacheItemArray_cget(cache->items, idx);
+        *name = item->name;
+        *is_folder = item->is_folder;
+        return true;
+    } else if(cache->type == BrowserCacheTypeFile) {
+        if(!browser_cache_read_record(cache->file, idx, &cache->record)) return false;
+        *name = cache->record.name;
+        *is_folder = cache->record.is_folder;
+        return true;
+    }
+    return false;
+}
+
+static bool browser_cache_is_valid(BrowserWorker* browser, FuriString* path) {
+    BrowserCache* cache = &browser->cache;
+    if(cache->type == BrowserCacheTypeNone) return false;
+    if(furi_string_cmp(cache->path, path) != 0) return false;
+
+    // Folder generation changes when an entry may have been created or removed in it
+    uint32_t generation = 0;
+    if(storage_common_generation(browser->storage, furi_string_get_cstr(path), &generation) !=
+       FSE_OK) {
+        return false;
+    }
+    return generation == cache->generation;
+}
+
 static bool browser_folder_init(
     BrowserWorker* browser,
     FuriString* path,
@@ -139,8 +575,13 @@ static bool browser_folder_init(
     FileInfo file_info;
     uint32_t total_files_cnt = 0;
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* directory = storage_file_alloc(storage);
+    BrowserCache* cache = &browser->cache;
+    browser_cache_reset(cache, browser->storage);
+    furi_string_set(cache->path, path);
+    cache->type = BrowserCacheTypeRam;
+    cache->sort = browser->sort_items;
+
+    File* directory = storage_file_alloc(browser->storage);
 
     char name_temp[FILE_NAME_LEN_MAX];
     FuriString* name_str;
@@ -158,12 +599,14 @@ static bool browser_folder_init(
             if((storage_file_get_error(directory) == FSE_OK) && (name_temp[0] != '\0')) {
                 total_files_cnt++;
                 furi_string_set(name_str, name_temp);
-                if(browser_filter_by_name(browser, name_str, (file_info.flags & FSF_DIRECTORY))) {
+                if(browser_filter_by_name(
+                       browser, path, name_str, (file_info.flags & FSF_DIRECTORY))) {
                     if(!furi_string_empty(filename)) {
                         if(furi_string_cmp(name_str, filename) == 0) {
                             *file_idx = *item_cnt;
                         }
                     }
+                    browser_cache_add(cache, browser->storage, name_temp, &file_info);
                     (*item_cnt)++;
                 }
                 if(total_files_cnt == LONG_LOAD_THRESHOLD) {
@@ -181,17 +624,108 @@ static bool browser_folder_init(
     storage_dir_close(directory);
     storage_file_free(directory);
 
-    furi_record_close(RECORD_STORAGE);
+    if(!state) {
+        browser_cache_reset(cache, browser->storage);
+    }
+
+    browser_cache_finish(cache, browser->storage);
+    if(cache->type != BrowserCacheTypeNone && cache->sort && *file_idx >= 0) {
+        // Index was taken in directory order
+        *file_idx = -1;
+        const char* name = NULL;
+        bool is_folder = false;
+        for(uint32_t i = 0; browser_cache_get(cache, i, &name, &is_folder); i++) {
+            if(furi_string_cmp_str(filename, name) == 0) {
+                *file_idx = i;
+                break;
+            }
+        }
+    }
+
+    // Taken after the listing is built, so entries created meanwhile are caught on next load
+    if(cache->type != BrowserCacheTypeNone) {
+        if(storage_common_generation(
+               browser->storage, furi_string_get_cstr(path), &cache->generation) != FSE_OK) {
+            browser_cache_reset(cache, browser->storage);
+        }
+    }
 
     return state;
 }
 
+static bool browser_folder_load_cached(
+    BrowserWorker* browser,
+    FuriString* path,
+    uint32_t offset,
+    uint32_t count) {
+    BrowserCache* cache = &browser->cache;
+    FuriString* name_str;
+    name_str = furi_string_alloc();
+
+    uint32_t items_cnt = 0;
+    const char* name = NULL;
+    bool is_folder = false;
+
+    if(offset <= cache->items_cnt) {
+        if(browser->list_load_cb) {
+            browser->list_load_cb(browser->cb_ctx, offset);
+        }
+
+        while(items_cnt < count) {
+            if(!browser_cache_get(cache, offset + items_cnt, &name, &is_folder)) {
+                break;
+            }
+            furi_string_printf(name_str, "%s/%s", furi_string_get_cstr(path), name);
+            if(browser->list_item_cb) {
+                browser->list_item_cb(browser->cb_ctx, name_str, is_folder, false);
+            }
+            items_cnt++;
+        }
+        if(browser->list_item_cb) {
+            browser->list_item_cb(browser->cb_ctx, NULL, false, true);
+        }
+    }
+
+    furi_string_free(name_str);
+
+    return (items_cnt == count);
+}
+
 static bool
     browser_folder_load(BrowserWorker* browser, FuriString* path, uint32_t offset, uint32_t count) {
+    if(!browser_cache_is_valid(browser, path)) {
+        // Folder changed since it was listed, rebuild listing in place
+        uint32_t items_cnt_prev = browser->items_cnt;
+        bool is_root = browser_folder_check_and_switch(path);
+        int32_t file_idx = 0;
+        FuriString* filename;
+        filename = furi_string_alloc();
+        browser_folder_init(browser, path, filename, &browser->items_cnt, &file_idx);
+        furi_string_free(filename);
+        furi_string_set(browser->path_current, path);
+
+        if(browser->items_cnt != items_cnt_prev) {
+            // Requested page is meaningless now, app reloads it with new item count
+            FURI_LOG_D(
+                TAG,
+                "Folder changed: %s items: %lu",
+                furi_string_get_cstr(path),
+                browser->items_cnt);
+            if(browser->folder_cb) {
+                browser->folder_cb(
+                    browser->cb_ctx, browser->items_cnt, browser->item_sel_idx, is_root);
+            }
+            return false;
+        }
+    }
+
+    if(browser->cache.type != BrowserCacheTypeNone) {
+        return browser_folder_load_cached(browser, path, offset, count);
+    }
+
     FileInfo file_info;
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* directory = storage_file_alloc(storage);
+    File* directory = storage_file_alloc(browser->storage);
 
     char name_temp[FILE_NAME_LEN_MAX];
     FuriString* name_str;
@@ -211,7 +745,8 @@ static bool
             }
             if(storage_file_get_error(directory) == FSE_OK) {
                 furi_string_set(name_str, name_temp);
-                if(browser_filter_by_name(browser, name_str, (file_info.flags & FSF_DIRECTORY))) {
+                if(browser_filter_by_name(
+                       browser, path, name_str, (file_info.flags & FSF_DIRECTORY))) {
                     items_cnt++;
                 }
             } else {
@@ -233,7 +768,8 @@ static bool
             }
             if(storage_file_get_error(directory) == FSE_OK) {
                 furi_string_set(name_str, name_temp);
-                if(browser_filter_by_name(browser, name_str, (file_info.flags & FSF_DIRECTORY))) {
+                if(browser_filter_by_name(
+                       browser, path, name_str, (file_info.flags & FSF_DIRECTORY))) {
                     furi_string_printf(name_str, "%s/%s", furi_string_get_cstr(path), name_temp);
                     if(browser->list_item_cb) {
                         browser->list_item_cb(
@@ -255,118 +791,103 @@ static bool
     storage_dir_close(directory);
     storage_file_free(directory);
 
-    furi_record_close(RECORD_STORAGE);
-
     return (items_cnt == count);
 }
 
-static int32_t browser_worker(void* context) {
+static void browser_worker_notify(BrowserWorker* browser, uint32_t flags) {
+    atomic_fetch_or(&browser->flags, flags);
+    furi_work_submit(browser->work);
+}
+
+static void browser_worker(void* context) {
     BrowserWorker* browser = (BrowserWorker*)context;
     furi_assert(browser);
-    FURI_LOG_D(TAG, "Start");
 
-    uint32_t items_cnt = 0;
-    FuriString* path;
-    path = furi_string_alloc_set(BROWSER_ROOT);
-    browser->item_sel_idx = -1;
-
-    FuriString* filename;
-    filename = furi_string_alloc();
-
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtConfigChange);
-
-    while(1) {
-        uint32_t flags =
-            furi_thread_flags_wait(WORKER_FLAGS_ALL, FuriFlagWaitAny, FuriWaitForever);
-        furi_assert((flags & FuriFlagError) == 0);
-
-        if(flags & WorkerEvtConfigChange) {
-            // If start path is a path to the file - try finding index of this file in a folder
-            if(browser_path_is_file(browser->path_next)) {
-                path_extract_filename(browser->path_next, filename, false);
-            }
-            idx_last_array_reset(browser->idx_last);
+    uint32_t flags = atomic_exchange(&browser->flags, 0);
+    FuriString* path = browser->path;
+    FuriString* filename = browser->filename;
 
-            furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtFolderEnter);
+    if(flags & WorkerEvtConfigChange) {
+        // If start path is a path to the file - try finding index of this file in a folder
+        if(browser_path_is_file(browser->path_next)) {
+            path_extract_filename(browser->path_next, filename, false);
         }
+        idx_last_array_reset(browser->idx_last);
 
-        if(flags & WorkerEvtFolderEnter) {
-            furi_string_set(path, browser->path_next);
-            bool is_root = browser_folder_check_and_switch(path);
+        flags |= WorkerEvtFolderEnter;
+    }
 
-            // Push previous selected item index to history array
-            idx_last_array_push_back(browser->idx_last, browser->item_sel_idx);
+    if(flags & (WorkerEvtFolderEnter | WorkerEvtFolderExit)) {
+        // Listing is rebuilt anyway
+        flags &= ~WorkerEvtFolderRefresh;
+    }
 
-            int32_t file_idx = 0;
-            browser_folder_init(browser, path, filename, &items_cnt, &file_idx);
-            furi_string_set(browser->path_current, path);
-            FURI_LOG_D(
-                TAG,
-                "Enter folder: %s items: %lu idx: %ld",
-                furi_string_get_cstr(path),
-                items_cnt,
-                file_idx);
-            if(browser->folder_cb) {
-                browser->folder_cb(browser->cb_ctx, items_cnt, file_idx, is_root);
-            }
-            furi_string_reset(filename);
-        }
-
-        if(flags & WorkerEvtFolderExit) {
-            browser_path_trim(path);
-            bool is_root = browser_folder_check_and_switch(path);
-
-            int32_t file_idx = 0;
-            browser_folder_init(browser, path, filename, &items_cnt, &file_idx);
-            if(idx_last_array_size(browser->idx_last) > 0) {
-                // Pop previous selected item index from history array
-                idx_last_array_pop_back(&file_idx, browser->idx_last);
-            }
-            furi_string_set(browser->path_current, path);
-            FURI_LOG_D(
-                TAG,
-                "Exit to: %s items: %lu idx: %ld",
-                furi_string_get_cstr(path),
-                items_cnt,
-                file_idx);
-            if(browser->folder_cb) {
-                browser->folder_cb(browser->cb_ctx, items_cnt, file_idx, is_root);
-            }
+    if(flags & WorkerEvtFolderEnter) {
+        furi_string_set(path, browser->path_next);
+        bool is_root = browser_folder_check_and_switch(path);
+
+        // Push previous selected item index to history array
+        idx_last_array_push_back(browser->idx_last, browser->item_sel_idx);
+
+        int32_t file_idx = 0;
+        browser_folder_init(browser, path, filename, &browser->items_cnt, &file_idx);
+        furi_string_set(browser->path_current, path);
+        FURI_LOG_D(
+            TAG,
+            "Enter folder: %s items: %lu idx: %ld",
+            furi_string_get_cstr(path),
+            browser->items_cnt,
+            file_idx);
+        if(browser->folder_cb) {
+            browser->folder_cb(browser->cb_ctx, browser->items_cnt, file_idx, is_root);
         }
+        furi_string_reset(filename);
+    }
 
-        if(flags & WorkerEvtFolderRefresh) {
-            bool is_root = browser_folder_check_and_switch(path);
+    if(flags & WorkerEvtFolderExit) {
+        browser_path_trim(path);
+        bool is_root = browser_folder_check_and_switch(path);
 
-            int32_t file_idx = 0;
-            furi_string_reset(filename);
-            browser_folder_init(browser, path, filename, &items_cnt, &file_idx);
-            FURI_LOG_D(
-                TAG,
-                "Refresh folder: %s items: %lu idx: %ld",
-                furi_string_get_cstr(path),
-                items_cnt,
-                browser->item_sel_idx);
-            if(browser->folder_cb) {
-                browser->folder_cb(browser->cb_ctx, items_cnt, browser->item_sel_idx, is_root);
-            }
+        int32_t file_idx = 0;
+        browser_folder_init(browser, path, filename, &browser->items_cnt, &file_idx);
+        if(idx_last_array_size(browser->idx_last) > 0) {
+            // Pop previous selected item index from history array
+            idx_last_array_pop_back(&file_idx, browser->idx_last);
         }
-
-        if(flags & WorkerEvtLoad) {
-            FURI_LOG_D(
-                TAG, "Load offset: %lu cnt: %lu", browser->load_offset, browser->load_count);
-            browser_folder_load(browser, path, browser->load_offset, browser->load_count);
+        furi_string_set(browser->path_current, path);
+        FURI_LOG_D(
+            TAG,
+            "Exit to: %s items: %lu idx: %ld",
+            furi_string_get_cstr(path),
+            browser->items_cnt,
+            file_idx);
+        if(browser->folder_cb) {
+            browser->folder_cb(browser->cb_ctx, browser->items_cnt, file_idx, is_root);
         }
+    }
 
-        if(flags & WorkerEvtStop) {
-            break;
+    if(flags & WorkerEvtFolderRefresh) {
+        bool is_root = browser_folder_check_and_switch(path);
+
+        int32_t file_idx = 0;
+        furi_string_reset(filename);
+        browser_folder_init(browser, path, filename, &browser->items_cnt, &file_idx);
+        FURI_LOG_D(
+            TAG,
+            "Refresh folder: %s items: %lu idx: %ld",
+            furi_string_get_cstr(path),
+            browser->items_cnt,
+            browser->item_sel_idx);
+        if(browser->folder_cb) {
+            browser->folder_cb(
+                browser->cb_ctx, browser->items_cnt, browser->item_sel_idx, is_root);
         }
     }
 
-    furi_string_free(filename);
-    furi_string_free(path);
-
-    FURI_LOG_D(TAG, "End");
-    return 0;
+    if(flags & WorkerEvtLoad) {
+        FURI_LOG_D(TAG, "Load offset: %lu cnt: %lu", browser->load_offset, browser->load_count);
+        browser_folder_load(browser, path, browser->load_offset, browser->load_count);
+    }
 }
 
 BrowserWorker* file_browser_worker_alloc(
@@ -382,6 +903,7 @@ BrowserWorker* file_browser_worker_alloc(
     browser->filter_extension = furi_string_alloc_set(filter_ext);
     browser->skip_assets = skip_assets;
     browser->hide_dot_files = hide_dot_files;
+    browser->sort_items = false;
 
     browser->path_current = furi_string_alloc_set(path);
     browser->path_next = furi_string_alloc_set(path);
@@ -391,8 +913,17 @@ BrowserWorker* file_browser_worker_alloc(
         furi_string_set_str(browser->path_start, base_path);
     }
 
-    browser->thread = furi_thread_alloc_ex("BrowserWorker", 2048, browser_worker, browser);
-    furi_thread_start(browser->thread);
+    browser->path = furi_string_alloc_set(BROWSER_ROOT);
+    browser->filename = furi_string_alloc();
+    browser->items_cnt = 0;
+    browser->item_sel_idx = -1;
+
+    browser->storage = furi_record_open(RECORD_STORAGE);
+    browser_cache_init(&browser->cache, browser->storage);
+
+    atomic_init(&browser->flags, 0);
+    browser->work = furi_work_alloc(furi_work_queue_get_system(), browser_worker, browser);
+    browser_worker_notify(browser, WorkerEvtConfigChange);
 
     return browser;
 }
@@ -400,9 +931,14 @@ BrowserWorker* file_browser_worker_alloc(
 void file_browser_worker_free(BrowserWorker* browser) {
     furi_assert(browser);
 
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtStop);
-    furi_thread_join(browser->thread);
-    furi_thread_free(browser->thread);
+    // Drops pending events and waits for running one
+    furi_work_free(browser->work);
+
+    browser_cache_deinit(&browser->cache, browser->storage);
+    furi_record_close(RECORD_STORAGE);
+
+    furi_string_free(browser->filename);
+    furi_string_free(browser->path);
 
     furi_string_free(browser->filter_extension);
     furi_string_free(browser->path_next);
@@ -458,14 +994,20 @@ void file_browser_worker_set_config(
     furi_string_set(browser->filter_extension, filter_ext);
     browser->skip_assets = skip_assets;
     browser->hide_dot_files = hide_dot_files;
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtConfigChange);
+    browser_worker_notify(browser, WorkerEvtConfigChange);
+}
+
+void file_browser_worker_set_sort(BrowserWorker* browser, bool sort_items) {
+    furi_assert(browser);
+    browser->sort_items = sort_items;
+    browser_worker_notify(browser, WorkerEvtFolderRefresh);
 }
 
 void file_browser_worker_folder_enter(BrowserWorker* browser, FuriString* path, int32_t item_idx) {
     furi_assert(browser);
     furi_string_set(browser->path_next, path);
     browser->item_sel_idx = item_idx;
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtFolderEnter);
+    browser_worker_notify(browser, WorkerEvtFolderEnter);
 }
 
 bool file_browser_worker_is_in_start_folder(BrowserWorker* browser) {
@@ -475,18 +1017,18 @@ bool file_browser_worker_is_in_start_folder(BrowserWorker* browser) {
 
 void file_browser_worker_folder_exit(BrowserWorker* browser) {
     furi_assert(browser);
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtFolderExit);
+    browser_worker_notify(browser, WorkerEvtFolderExit);
 }
 
 void file_browser_worker_folder_refresh(BrowserWorker* browser, int32_t item_idx) {
     furi_assert(browser);
     browser->item_sel_idx = item_idx;
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtFolderRefresh);
+    browser_worker_notify(browser, WorkerEvtFolderRefresh);
 }
 
 void file_browser_worker_load(BrowserWorker* browser, uint32_t offset, uint32_t count) {
     furi_assert(browser);
     browser->load_offset = offset;
     browser->load_count = count;
-    furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtLoad);
+    browser_worker_notify(browser, WorkerEvtLoad);
 }
@@ -55,6 +55,11 @@ void file_browser_worker_set_config(
     bool skip_assets,
     bool hide_dot_files);
 
+/** Enable sorting of folder listing: folders first, then case-insensitive by name
+ * @note Folders too big for RAM are sorted on SD card, listing them takes longer
+ */
+void file_browser_worker_set_sort(BrowserWorker* browser, bool sort_items);
+
 void file_browser_worker_folder_enter(BrowserWorker* browser, FuriString* path, int32_t item_idx);
 
 bool file_browser_worker_is_in_start_folder(BrowserWorker* browser);
@@ -2,16 +2,24 @@
 #include "gui/canvas.h"
 #include <furi.h>
 #include <gui/elements.h>
+#include <m-array.h>
 #include <stdint.h>
 
+#define TEXT_BOX_TEXT_WIDTH 120
+#define TEXT_BOX_LINES_ON_SCREEN 5
+
+ARRAY_DEF(TextBoxLineArray, uint32_t, M_POD_OPLIST);
+
 struct TextBox {
     View* view;
 };
 
 typedef struct {
     const char* text;
-    char* text_pos;
-    FuriString* text_formatted;
+    // Own copy of text, callers may change theirs while it is shown
+    FuriString* text_copy;
+    // Offsets of line starts in text, built once per text
+    TextBoxLineArray_t lines;
     int32_t scroll_pos;
     int32_t scroll_num;
     TextBoxFont font;
@@ -26,9 +34,6 @@ static void text_box_process_down(TextBox* text_box) {
         {
             if(model->scroll_pos < model->scroll_num - 1) {
                 model->scroll_pos++;
-                // Search next line start
-                while(*model->text_pos++ != '\n')
-                    ;
             }
         },
         true);
@@ -41,60 +46,61 @@ static void text_box_process_up(TextBox* text_box) {
         {
             if(model->scroll_pos > 0) {
                 model->scroll_pos--;
-                // Reach last symbol of previous line
-                model->text_pos--;
-                // Search previous line start
-                while((model->text_pos != model->text) && (*(--model->text_pos) != '\n'))
-                    ;
-                if(*model->text_pos == '\n') {
-                    model->text_pos++;
-                }
             }
         },
         true);
 }
 
-static void text_box_insert_endline(Canvas* canvas, TextBoxModel* model) {
+static void text_box_index_lines(Canvas* canvas, TextBoxModel* model) {
     size_t i = 0;
     size_t line_width = 0;
     const char* str = model->text;
-    size_t line_num = 0;
 
-    const size_t text_width = 120;
+    TextBoxLineArray_reset(model->lines);
+    TextBoxLineArray_push_back(model->lines, 0);
 
     while(str[i] != '\0') {
-        char symb = str[i++];
+        char symb = str[i];
         if(symb != '\n') {
             size_t glyph_width = canvas_glyph_width(canvas, symb);
-            if(line_width + glyph_width > text_width) {
-                line_num++;
+            if(line_width + glyph_width > TEXT_BOX_TEXT_WIDTH) {
+                TextBoxLineArray_push_back(model->lines, i);
                 line_width = 0;
-                furi_string_push_back(model->text_formatted, '\n');
             }
             line_width += glyph_width;
+            i++;
         } else {
-            line_num++;
+            i++;
+            TextBoxLineArray_push_back(model->lines, i);
             line_width = 0;
         }
-        furi_string_push_back(model->text_formatted, symb);
     }
-    line_num++;
-    model->text = furi_string_get_cstr(model->text_formatted);
-    model->text_pos = (char*)model->text;
-    if(model->focus == TextBoxFocusEnd && line_num > 5) {
-        // Set text position to 5th line from the end
-        for(uint8_t i = 0; i < line_num - 5; i++) {
-            while(*model->text_pos++ != '\n') {
-            };
-        }
-        model->scroll_num = line_num - 4;
-        model->scroll_pos = line_num - 5;
+
+    size_t line_num = TextBoxLineArray_size(model->lines);
+    if(model->focus == TextBoxFocusEnd && line_num > TEXT_BOX_LINES_ON_SCREEN) {
+        model->scroll_num = line_num - TEXT_BOX_LINES_ON_SCREEN + 1;
+        model->scroll_pos = line_num - TEXT_BOX_LINES_ON_SCREEN;
     } else {
-        model->scroll_num = MAX(line_num - 4, 0u);
+        model->scroll_num = line_num > TEXT_BOX_LINES_ON_SCREEN - 1 ?
+                                line_num - (TEXT_BOX_LINES_ON_SCREEN - 1) :
+                                0;
         model->scroll_pos = 0;
     }
 }
 
+static void text_box_draw_line(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    const char* line_start,
+    const char* line_end) {
+    for(const char* symb = line_start; symb < line_end; symb++) {
+        if(*symb == '\n' || *symb == '\0') break;
+        canvas_draw_glyph(canvas, x, y, (uint8_t)*symb);
+        x += canvas_glyph_width(canvas, *symb);
+    }
+}
+
 static void text_box_view_draw_callback(Canvas* canvas, void* _model) {
     TextBoxModel* model = _model;
 
@@ -105,13 +111,30 @@ static void text_box_view_draw_callback(Canvas* canvas, void* _model) {
         canvas_set_font(canvas, FontKeyboard);
     }
 
+    if(!model->text) {
+        return;
+    }
+
     if(!model->formatted) {
-        text_box_insert_endline(canvas, model);
+        text_box_index_lines(canvas, model);
         model->formatted = true;
     }
 
     elements_slightly_rounded_frame(canvas, 0, 0, 124, 64);
-    elements_multiline_text(canvas, 3, 11, model->text_pos);
+
+    // Only lines visible on screen are touched
+    uint8_t font_height = canvas_current_font_height(canvas);
+    size_t line_num = TextBoxLineArray_size(model->lines);
+    uint8_t y = 11;
+    for(size_t line = model->scroll_pos; (line < line_num) && (y < 64); line++) {
+        const char* line_start = model->text + *TextBoxLineArray_get(model->lines, line);
+        const char* line_end = (line + 1 < line_num) ?
+                                   model->text + *TextBoxLineArray_get(model->lines, line + 1) :
+                                   line_start + strlen(line_start);
+        text_box_draw_line(canvas, 3, y, line_start, line_end);
+        y += font_height;
+    }
+
     elements_scrollbar(canvas, model->scroll_pos, model->scroll_num);
 }
 
@@ -145,7 +168,8 @@ TextBox* text_box_alloc() {
         TextBoxModel * model,
         {
             model->text = NULL;
-            model->text_formatted = furi_string_alloc_set("");
+            model->text_copy = furi_string_alloc();
+            TextBoxLineArray_init(model->lines);
             model->formatted = false;
             model->font = TextBoxFontText;
         },
@@ -158,7 +182,13 @@ void text_box_free(TextBox* text_box) {
     furi_assert(text_box);
 
     with_view_model(
-        text_box->view, TextBoxModel * model, { furi_string_free(model->text_formatted); }, true);
+        text_box->view,
+        TextBoxModel * model,
+        {
+            furi_string_free(model->text_copy);
+            TextBoxLineArray_clear(model->lines);
+        },
+        true);
     view_free(text_box->view);
     free(text_box);
 }
@@ -176,7 +206,9 @@ void text_box_reset(TextBox* text_box) {
         TextBoxModel * model,
         {
             model->text = NULL;
-            furi_string_set(model->text_formatted, "");
+            furi_string_reset(model->text_copy);
+            TextBoxLineArray_reset(model->lines);
+            model->formatted = false;
             model->font = TextBoxFontText;
             model->focus = TextBoxFocusStart;
         },
@@ -191,9 +223,8 @@ void text_box_set_text(TextBox* text_box, const char* text) {
         text_box->view,
         TextBoxModel * model,
         {
-            model->text = text;
-            furi_string_reset(model->text_formatted);
-            furi_string_reserve(model->text_formatted, strlen(text));
+            furi_string_set(model->text_copy, text);
+            model->text = furi_string_get_cstr(model->text_copy);
             model->formatted = false;
         },
         true);
@@ -77,6 +77,21 @@ struct RpcSession {
     RpcSessionClosedCallback closed_callback;
     RpcSessionTerminatedCallback terminated_callback;
     void* context;
+
+    size_t transfer_chunk_size;
+    bool transfer_compression;
+
+    /* Encoded output is staged here and handed to transport when full */
+    uint8_t* tx_buffer;
+    size_t tx_buffer_used;
+
+    /* Response memory of handlers running in session thread */
+    uint8_t* arena;
+    size_t arena_used;
+
+#if SRV_RPC_DEBUG
+    RpcDebugAllocDict_t alloc_stats;
+#endif
 };
 
 struct Rpc {
@@ -168,6 +183,51 @@ size_t rpc_session_get_available_size(RpcSession* session) {
     return furi_stream_buffer_spaces_available(session->stream);
 }
 
+void rpc_session_set_transfer_chunk_size(RpcSession* session, size_t chunk_size) {
+    furi_assert(session);
+    session->transfer_chunk_size =
+        CLAMP(chunk_size, RPC_TRANSFER_CHUNK_SIZE_MAX, RPC_TRANSFER_CHUNK_SIZE_DEFAULT);
+}
+
+size_t rpc_session_get_transfer_chunk_size(RpcSession* session) {
+    furi_assert(session);
+    return session->transfer_chunk_size;
+}
+
+void rpc_session_set_transfer_compression(RpcSession* session, bool enable) {
+    furi_assert(session);
+    session->transfer_compression = enable;
+}
+
+bool rpc_session_get_transfer_compression(RpcSession* session) {
+    furi_assert(session);
+    return session->transfer_compression;
+}
+
+void* rpc_session_arena_alloc(RpcSession* session, size_t size) {
+    furi_assert(session);
+
+    size = (size + 3) & ~3;
+    if(session->arena_used + size > RPC_ARENA_SIZE) {
+        return NULL;
+    }
+
+    void* memory = &session->arena[session->arena_used];
+    session->arena_used += size;
+    return memory;
+}
+
+char* rpc_session_arena_strdup(RpcSession* session, const char* str) {
+    furi_assert(str);
+
+    size_t size = strlen(str) + 1;
+    char* copy = rpc_session_arena_alloc(session, size);
+    if(copy) {
+        memcpy(copy, str, size);
+    }
+    return copy;
+}
+
 bool rpc_pb_stream_read(pb_istream_t* istream, pb_byte_t* buf, size_t count) {
     furi_assert(istream);
     furi_assert(buf);
@@ -259,8 +319,21 @@ static int32_t rpc_session_worker(void* context) {
 
             if(handler && handler->message_handler) {
                 furi_check(furi_mutex_acquire(rpc->busy_mutex, FuriWaitForever) == FuriStatusOk);
+#if SRV_RPC_DEBUG
+                /* Only allocations of session thread, other threads keep running */
+                pb_size_t tag = session->decoded_message->which_content;
+                FuriThreadId thread_id = furi_thread_get_current_id();
+                uint32_t alloc_count = memmgr_heap_get_thread_alloc_count(thread_id);
+#endif
                 handler->message_handler(session->decoded_message, handler->context);
+#if SRV_RPC_DEBUG
+                alloc_count = memmgr_heap_get_thread_alloc_count(thread_id) - alloc_count;
+#endif
                 furi_check(furi_mutex_release(rpc->busy_mutex) == FuriStatusOk);
+                session->arena_used = 0;
+#if SRV_RPC_DEBUG
+                rpc_debug_account_allocations(session->alloc_stats, tag, alloc_count);
+#endif
             } else if(session->decoded_message->which_content == 0) {
                 /* Receiving zeroes means message is 0-length, which
                  * is valid for proto3: all fields are filled with default values.
@@ -331,8 +404,14 @@ static void rpc_session_free_callback(FuriThreadState thread_state, void* contex
                 rpc_systems[i].free(session->system_contexts[i]);
             }
         }
+#if SRV_RPC_DEBUG
+        rpc_debug_print_allocations(session->alloc_stats);
+        RpcDebugAllocDict_clear(session->alloc_stats);
+#endif
         free(session->system_contexts);
         free(session->decoded_message);
+        free(session->tx_buffer);
+        free(session->arena);
         RpcHandlerDict_clear(session->handlers);
         furi_stream_buffer_free(session->stream);
 
@@ -357,7 +436,16 @@ RpcSession* rpc_session_open(Rpc* rpc) {
     session->rpc = rpc;
     session->terminate = false;
     session->decode_error = false;
+    session->transfer_chunk_size = RPC_TRANSFER_CHUNK_SIZE_DEFAULT;
+    session->transfer_compression = false;
+    session->tx_buffer = malloc(RPC_BUFFER_SIZE);
+    session->tx_buffer_used = 0;
+    session->arena = malloc(RPC_ARENA_SIZE);
+    session->arena_used = 0;
     RpcHandlerDict_init(session->handlers);
+#if SRV_RPC_DEBUG
+    RpcDebugAllocDict_init(session->alloc_stats);
+#endif
 
     session->decoded_message = malloc(sizeof(PB_Main));
     session->decoded_message->cb_content.funcs.decode = rpc_pb_content_callback;
@@ -414,36 +502,67 @@ void rpc_add_handler(RpcSession* session, pb_size_t message_tag, RpcHandler* han
     RpcHandlerDict_set_at(session->handlers, message_tag, *handler);
 }
 
+static void rpc_tx_flush(RpcSession* session) {
+    if(!session->tx_buffer_used) return;
+
+#if SRV_RPC_DEBUG
+    rpc_debug_print_data("OUTPUT", session->tx_buffer, session->tx_buffer_used);
+#endif
+
+    if(session->send_bytes_callback) {
+        session->send_bytes_callback(
+            session->context, session->tx_buffer, session->tx_buffer_used);
+    }
+    session->tx_buffer_used = 0;
+}
+
+static bool rpc_pb_stream_write(pb_ostream_t* ostream, const pb_byte_t* buf, size_t count) {
+    RpcSession* session = ostream->state;
+
+    while(count) {
+        size_t part = MIN(count, (size_t)RPC_BUFFER_SIZE - session->tx_buffer_used);
+        memcpy(&session->tx_buffer[session->tx_buffer_used], buf, part);
+        session->tx_buffer_used += part;
+        buf += part;
+        count -= part;
+
+        if(session->tx_buffer_used == RPC_BUFFER_SIZE) {
+            rpc_tx_flush(session);
+        }
+    }
+
+    return true;
+}
+
 void rpc_send(RpcSession* session, PB_Main* message) {
     furi_assert(session);
     furi_assert(message);
 
-    pb_ostream_t ostream = PB_OSTREAM_SIZING;
-
 #if SRV_RPC_DEBUG
     FURI_LOG_I(TAG, "OUTPUT:");
     rpc_debug_print_message(message);
 #endif
 
+    /* Encoded straight into transport, big payloads don't need a copy of whole message */
+    furi_mutex_acquire(session->callbacks_mutex, FuriWaitForever);
+    pb_ostream_t ostream = {
+        .callback = rpc_pb_stream_write,
+        .state = session,
+        .max_size = SIZE_MAX,
+        .bytes_written = 0,
+        .errmsg = NULL,
+    };
+
     bool result = pb_encode_ex(&ostream, &PB_Main_msg, message, PB_ENCODE_DELIMITED);
     furi_check(result && ostream.bytes_written);
 
-    uint8_t* buffer = malloc(ostream.bytes_written);
-    ostream = pb_ostream_from_buffer(buffer, ostream.bytes_written);
-
-    pb_encode_ex(&ostream, &PB_Main_msg, message, PB_ENCODE_DELIMITED);
-
-#if SRV_RPC_DEBUG
-    rpc_debug_print_data("OUTPUT", buffer, ostream.bytes_written);
-#endif
-
-    furi_mutex_acquire(session->callbacks_mutex, FuriWaitForever);
-    if(session->send_bytes_callback) {
-        session->send_bytes_callback(session->context, buffer, ostream.bytes_written);
-    }
+    rpc_tx_flush(session);
     furi_mutex_release(session->callbacks_mutex);
+}
 
-    free(buffer);
+void rpc_send_and_reset_arena(RpcSession* session, PB_Main* message) {
+    rpc_send(session, message);
+    session->arena_used = 0;
 }
 
 void rpc_send_and_release(RpcSession* session, PB_Main* message) {
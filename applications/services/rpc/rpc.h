@@ -12,6 +12,10 @@ extern "C" {
 #define RPC_BUFFER_SIZE (1024)
 #define RPC_MAX_MESSAGE_SIZE (1536)
 
+/** Storage read payload size for hosts that didn't ask for another one */
+#define RPC_TRANSFER_CHUNK_SIZE_DEFAULT (512)
+#define RPC_TRANSFER_CHUNK_SIZE_MAX (8 * 1024)
+
 #define RECORD_RPC "rpc"
 
 /** Rpc interface. Used for opening session only. */
@@ -119,6 +123,24 @@ size_t rpc_session_feed(RpcSession* session, uint8_t* buffer, size_t size, TickT
  */
 size_t rpc_session_get_available_size(RpcSession* session);
 
+/** Set storage transfer chunk size, agreed with the host by transport layer
+ *
+ * @param   session     pointer to RpcSession descriptor
+ * @param   chunk_size  file data size in storage read responses, clamped to
+ *                      RPC_TRANSFER_CHUNK_SIZE_DEFAULT..RPC_TRANSFER_CHUNK_SIZE_MAX
+ */
+void rpc_session_set_transfer_chunk_size(RpcSession* session, size_t chunk_size);
+
+/** Enable compression of storage read payloads, host must have asked for it
+ *
+ * Every payload is a standalone furi_hal_compress block: 4 byte header
+ * and heatshrink data, or 0x00 and raw data if it doesn't compress.
+ *
+ * @param   session     pointer to RpcSession descriptor
+ * @param   enable      true to compress
+ */
+void rpc_session_set_transfer_compression(RpcSession* session, bool enable);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
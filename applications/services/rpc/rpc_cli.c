@@ -3,6 +3,8 @@
 #include <rpc/rpc.h>
 #include <furi_hal.h>
 #include <semphr.h>
+#include <toolbox/args.h>
+#include "rpc_i.h"
 
 #define TAG "RpcCli"
 
@@ -12,7 +14,7 @@ typedef struct {
     FuriSemaphore* terminate_semaphore;
 } CliRpc;
 
-#define CLI_READ_BUFFER_SIZE 64
+#define CLI_READ_BUFFER_SIZE 512
 
 static void rpc_cli_send_bytes_callback(void* context, uint8_t* bytes, size_t bytes_len) {
     furi_assert(context);
@@ -37,8 +39,29 @@ static void rpc_cli_session_terminated_callback(void* context) {
     furi_semaphore_release(cli_rpc->terminate_semaphore);
 }
 
+/* Options come as "chunk=<bytes>" and "compress" words after the command. Hosts that
+ * pass any get the accepted values back in one line, before the binary stream starts. */
+static void rpc_cli_apply_options(RpcSession* rpc_session, FuriString* args) {
+    if(furi_string_empty(args)) return;
+
+    FuriString* option = furi_string_alloc();
+    while(args_read_string_and_trim(args, option)) {
+        if(furi_string_start_with_str(option, "chunk=")) {
+            rpc_session_set_transfer_chunk_size(
+                rpc_session, atoi(furi_string_get_cstr(option) + strlen("chunk=")));
+        } else if(furi_string_cmp_str(option, "compress") == 0) {
+            rpc_session_set_transfer_compression(rpc_session, true);
+        }
+    }
+    furi_string_free(option);
+
+    printf(
+        "chunk=%u compress=%u\r\n",
+        rpc_session_get_transfer_chunk_size(rpc_session),
+        rpc_session_get_transfer_compression(rpc_session));
+}
+
 void rpc_cli_command_start_session(Cli* cli, FuriString* args, void* context) {
-    UNUSED(args);
     furi_assert(cli);
     furi_assert(context);
     Rpc* rpc = context;
@@ -54,6 +77,8 @@ void rpc_cli_command_start_session(Cli* cli, FuriString* args, void* context) {
         return;
     }
 
+    rpc_cli_apply_options(rpc_session, args);
+
     CliRpc cli_rpc = {.cli = cli, .session_close_request = false};
     cli_rpc.terminate_semaphore = furi_semaphore_alloc(1, 0);
     rpc_session_set_context(rpc_session, &cli_rpc);
@@ -1,5 +1,7 @@
 #include "rpc_i.h"
 
+#define TAG "RpcDebug"
+
 static size_t rpc_debug_print_file_msg(
     FuriString* str,
     const char* prefix,
@@ -257,3 +259,33 @@ void rpc_debug_print_message(const PB_Main* message) {
 
     furi_string_free(str);
 }
+
+void rpc_debug_account_allocations(
+    RpcDebugAllocDict_t stats,
+    pb_size_t message_tag,
+    uint32_t allocations) {
+    RpcDebugAllocStats* entry = RpcDebugAllocDict_get(stats, message_tag);
+    if(!entry) {
+        RpcDebugAllocStats empty = {0};
+        RpcDebugAllocDict_set_at(stats, message_tag, empty);
+        entry = RpcDebugAllocDict_get(stats, message_tag);
+    }
+
+    entry->commands++;
+    entry->allocations += allocations;
+    FURI_LOG_D(TAG, "Message(%d): %lu allocations", message_tag, allocations);
+}
+
+void rpc_debug_print_allocations(RpcDebugAllocDict_t stats) {
+    RpcDebugAllocDict_it_t it;
+    for(RpcDebugAllocDict_it(it, stats); !RpcDebugAllocDict_end_p(it);
+        RpcDebugAllocDict_next(it)) {
+        const RpcDebugAllocDict_itref_t* item = RpcDebugAllocDict_cref(it);
+        FURI_LOG_D(
+            TAG,
+            "Message(%d): %lu commands, %lu allocations",
+            item->key,
+            item->value.commands,
+            item->value.allocations);
+    }
+}
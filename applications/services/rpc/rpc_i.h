@@ -6,6 +6,10 @@
 #include <pb_encode.h>
 #include <flipper.pb.h>
 #include <cli/cli.h>
+#include <m-dict.h>
+
+/** Per-session memory for response fields, see rpc_session_arena_alloc() */
+#define RPC_ARENA_SIZE (1024)
 
 typedef void* (*RpcSystemAlloc)(RpcSession* session);
 typedef void (*RpcSystemFree)(void* context);
@@ -19,12 +23,31 @@ typedef struct {
 
 void rpc_send(RpcSession* session, PB_Main* main_message);
 
+/** Send message built from arena memory and reuse arena for the next one.
+ * Must be called from session thread, message must not be released.
+ */
+void rpc_send_and_reset_arena(RpcSession* session, PB_Main* main_message);
+
 void rpc_send_and_release(RpcSession* session, PB_Main* main_message);
 
 void rpc_send_and_release_empty(RpcSession* session, uint32_t command_id, PB_CommandStatus status);
 
 void rpc_add_handler(RpcSession* session, pb_size_t message_tag, RpcHandler* handler);
 
+/** Allocate response memory from session arena, without touching heap.
+ * Memory stays valid until message is sent with rpc_send_and_reset_arena() or
+ * handler returns. Only for handlers running in session thread.
+ *
+ * @return pointer to memory or NULL if arena is exhausted
+ */
+void* rpc_session_arena_alloc(RpcSession* session, size_t size);
+
+char* rpc_session_arena_strdup(RpcSession* session, const char* str);
+
+size_t rpc_session_get_transfer_chunk_size(RpcSession* session);
+
+bool rpc_session_get_transfer_compression(RpcSession* session);
+
 void* rpc_system_system_alloc(RpcSession* session);
 void* rpc_system_storage_alloc(RpcSession* session);
 void rpc_system_storage_free(void* ctx);
@@ -36,6 +59,18 @@ void* rpc_system_gpio_alloc(RpcSession* session);
 void rpc_system_gpio_free(void* ctx);
 void* rpc_system_property_alloc(RpcSession* session);
 
+typedef struct {
+    uint32_t commands;
+    uint32_t allocations;
+} RpcDebugAllocStats;
+
+DICT_DEF2(RpcDebugAllocDict, pb_size_t, M_DEFAULT_OPLIST, RpcDebugAllocStats, M_POD_OPLIST)
+
+void rpc_debug_account_allocations(
+    RpcDebugAllocDict_t stats,
+    pb_size_t message_tag,
+    uint32_t allocations);
+void rpc_debug_print_allocations(RpcDebugAllocDict_t stats);
 void rpc_debug_print_message(const PB_Main* message);
 void rpc_debug_print_data(const char* prefix, uint8_t* buffer, size_t size);
 
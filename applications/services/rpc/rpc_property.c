@@ -31,9 +31,13 @@ static void
     PB_Main* response = ctx->response;
 
     if(!strncmp(key, furi_string_get_cstr(ctx->subkey), furi_string_size(ctx->subkey))) {
-        response->content.system_device_info_response.key = strdup(key);
-        response->content.system_device_info_response.value = strdup(value);
-        rpc_send_and_release(session, response);
+        response->content.system_device_info_response.key = rpc_session_arena_strdup(session, key);
+        response->content.system_device_info_response.value =
+            rpc_session_arena_strdup(session, value);
+        furi_check(
+            response->content.system_device_info_response.key &&
+            response->content.system_device_info_response.value);
+        rpc_send_and_reset_arena(session, response);
     }
 
     if(last) {
@@ -62,16 +66,16 @@ static void rpc_system_property_get_process(const PB_Main* request, void* contex
         furi_string_right(subkey, sep_idx + 1);
     }
 
-    PB_Main* response = malloc(sizeof(PB_Main));
-
-    response->command_id = request->command_id;
-    response->command_status = PB_CommandStatus_OK;
-    response->has_next = true;
-    response->which_content = PB_Main_property_get_response_tag;
+    PB_Main response = {
+        .command_id = request->command_id,
+        .command_status = PB_CommandStatus_OK,
+        .has_next = true,
+        .which_content = PB_Main_property_get_response_tag,
+    };
 
     RpcPropertyContext property_context = {
         .session = session,
-        .response = response,
+        .response = &response,
         .subkey = subkey,
     };
 
@@ -88,8 +92,6 @@ static void rpc_system_property_get_process(const PB_Main* request, void* contex
 
     furi_string_free(subkey);
     furi_string_free(topkey);
-
-    free(response);
 }
 
 void* rpc_system_property_alloc(RpcSession* session) {
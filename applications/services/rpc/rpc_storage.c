@@ -9,7 +9,8 @@
 #include "storage/filesystem_api_defines.h"
 #include "storage/storage.h"
 #include <stdint.h>
-#include <lib/toolbox/md5.h>
+#include <furi_hal_compress.h>
+#include <lib/toolbox/hash_cache.h>
 #include <lib/toolbox/path.h>
 #include <update_util/lfs_backup.h>
 
@@ -17,7 +18,8 @@
 
 #define MAX_NAME_LENGTH 255
 
-static const size_t MAX_DATA_SIZE = 512;
+/* Encoder output for incompressible data: header plus one flag bit per literal byte */
+#define COMPRESS_OUTPUT_SIZE(size) ((size) + (size) / 8 + 8)
 
 typedef enum {
     RpcStorageStateIdle = 0,
@@ -234,12 +236,11 @@ static void rpc_system_storage_list_root(const PB_Main* request, void* context)
         response.content.storage_list_response.file[i].data = NULL;
         response.content.storage_list_response.file[i].size = 0;
         response.content.storage_list_response.file[i].type = PB_Storage_File_FileType_DIR;
-        char* str = malloc(strlen(hard_coded_dirs[i]) + 1);
-        strcpy(str, hard_coded_dirs[i]);
-        response.content.storage_list_response.file[i].name = str;
+        response.content.storage_list_response.file[i].name =
+            rpc_session_arena_strdup(session, hard_coded_dirs[i]);
     }
 
-    rpc_send_and_release(session, &response);
+    rpc_send_and_reset_arena(session, &response);
 }
 
 static void rpc_system_storage_list_process(const PB_Main* request, void* context) {
@@ -280,36 +281,43 @@ static void rpc_system_storage_list_process(const PB_Main* request, void* contex
         finish = true;
     }
 
+    /* Entry names live in session arena until response is sent, one read buffer for all */
+    char* name = malloc(MAX_NAME_LENGTH + 1);
+
     while(!finish) {
         FileInfo fileinfo;
-        char* name = malloc(MAX_NAME_LENGTH + 1);
         if(storage_dir_read(dir, &fileinfo, name, MAX_NAME_LENGTH)) {
             if(path_contains_only_ascii(name)) {
-                if(i == COUNT_OF(list->file)) {
+                char* entry_name = NULL;
+                if(i < (int)COUNT_OF(list->file)) {
+                    entry_name = rpc_session_arena_strdup(session, name);
+                }
+                if(!entry_name) {
                     list->file_count = i;
                     response.has_next = true;
-                    rpc_send_and_release(session, &response);
+                    rpc_send_and_reset_arena(session, &response);
                     i = 0;
+                    entry_name = rpc_session_arena_strdup(session, name);
+                    furi_check(entry_name);
                 }
                 list->file[i].type = (fileinfo.flags & FSF_DIRECTORY) ?
                                          PB_Storage_File_FileType_DIR :
                                          PB_Storage_File_FileType_FILE;
                 list->file[i].size = fileinfo.size;
                 list->file[i].data = NULL;
-                list->file[i].name = name;
+                list->file[i].name = entry_name;
                 ++i;
-            } else {
-                free(name);
             }
         } else {
             list->file_count = i;
             finish = true;
-            free(name);
         }
     }
 
+    free(name);
+
     response.has_next = false;
-    rpc_send_and_release(session, &response);
+    rpc_send_and_reset_arena(session, &response);
 
     storage_dir_close(dir);
     storage_file_free(dir);
@@ -330,8 +338,26 @@ static void rpc_system_storage_read_process(const PB_Main* request, void* contex
 
     rpc_system_storage_reset_state(rpc_storage, session, true);
 
-    /* use same message memory to send response */
+    /* Chunk size is agreed with the host, but must leave heap to everyone else */
+    size_t chunk_size = MIN(
+        rpc_session_get_transfer_chunk_size(session), memmgr_heap_get_max_free_block() / 4);
+    chunk_size = MAX(chunk_size, (size_t)RPC_TRANSFER_CHUNK_SIZE_DEFAULT);
+    FuriHalCompress* compress = NULL;
+    uint8_t* read_buffer = NULL;
+    size_t data_size = chunk_size;
+    if(rpc_session_get_transfer_compression(session)) {
+        compress = furi_hal_compress_alloc(chunk_size);
+        read_buffer = malloc(chunk_size);
+        data_size = COMPRESS_OUTPUT_SIZE(chunk_size);
+    }
+
+    /* same response and payload memory is used for every chunk */
     PB_Main* response = malloc(sizeof(PB_Main));
+    pb_bytes_array_t* data = malloc(PB_BYTES_ARRAY_T_ALLOCSIZE(data_size));
+    if(!read_buffer) {
+        read_buffer = data->bytes;
+    }
+
     const char* path = request->content.storage_read_request.path;
     Storage* fs_api = furi_record_open(RECORD_STORAGE);
     File* file = storage_file_alloc(fs_api);
@@ -343,31 +369,33 @@ static void rpc_system_storage_read_process(const PB_Main* request, void* contex
             response->command_id = request->command_id;
             response->which_content = PB_Main_storage_read_response_tag;
             response->command_status = PB_CommandStatus_OK;
+            response->content.storage_read_response.has_file = true;
+            response->content.storage_read_response.file.data = data;
 
-            size_t read_size = MIN(size_left, MAX_DATA_SIZE);
+            size_t read_size = MIN(size_left, chunk_size);
             if(read_size) {
-                response->content.storage_read_response.has_file = true;
-                response->content.storage_read_response.file.data =
-                    malloc(PB_BYTES_ARRAY_T_ALLOCSIZE(read_size));
-                uint8_t* buffer = &response->content.storage_read_response.file.data->bytes[0];
-                uint16_t* read_size_msg = &response->content.storage_read_response.file.data->size;
-
-                *read_size_msg = storage_file_read(file, buffer, read_size);
-                size_left -= *read_size_msg;
-                fs_operation_success = (*read_size_msg == read_size);
+                uint16_t was_read = storage_file_read(file, read_buffer, read_size);
+                size_left -= was_read;
+                fs_operation_success = (was_read == read_size);
+
+                if(fs_operation_success && compress) {
+                    size_t encoded_size = 0;
+                    fs_operation_success = furi_hal_compress_encode(
+                        compress, read_buffer, was_read, data->bytes, data_size, &encoded_size);
+                    data->size = encoded_size;
+                } else {
+                    data->size = was_read;
+                }
 
                 response->has_next = fs_operation_success && (size_left > 0);
             } else {
-                response->content.storage_read_response.file.data =
-                    malloc(PB_BYTES_ARRAY_T_ALLOCSIZE(0));
-                response->content.storage_read_response.file.data->size = 0;
-                response->content.storage_read_response.has_file = true;
+                data->size = 0;
                 response->has_next = false;
                 fs_operation_success = true;
             }
 
             if(fs_operation_success) {
-                rpc_send_and_release(session, response);
+                rpc_send(session, response);
             }
         } while((size_left != 0) && fs_operation_success);
     }
@@ -377,7 +405,12 @@ static void rpc_system_storage_read_process(const PB_Main* request, void* contex
             session, request->command_id, rpc_system_storage_get_file_error(file));
     }
 
+    free(data);
     free(response);
+    if(compress) {
+        furi_hal_compress_free(compress);
+        free(read_buffer);
+    }
     storage_file_close(file);
     storage_file_free(file);
 
@@ -569,24 +602,10 @@ static void rpc_system_storage_md5sum_process(const PB_Main* request, void* cont
     }
 
     Storage* fs_api = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(fs_api);
-
-    if(storage_file_open(file, filename, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        const uint16_t size_to_read = 512;
-        const uint8_t hash_size = 16;
-        uint8_t* data = malloc(size_to_read);
-        uint8_t* hash = malloc(sizeof(uint8_t) * hash_size);
-        md5_context* md5_ctx = malloc(sizeof(md5_context));
-
-        md5_starts(md5_ctx);
-        while(true) {
-            uint16_t read_size = storage_file_read(file, data, size_to_read);
-            if(read_size == 0) break;
-            md5_update(md5_ctx, data, read_size);
-        }
-        md5_finish(md5_ctx, hash);
-        free(md5_ctx);
+    HashCacheDigest digest;
+    FS_Error error = hash_cache_get(fs_api, filename, &digest);
 
+    if(error == FSE_OK) {
         PB_Main response = {
             .command_id = request->command_id,
             .command_status = PB_CommandStatus_OK,
@@ -597,22 +616,17 @@ static void rpc_system_storage_md5sum_process(const PB_Main* request, void* cont
         char* md5sum = response.content.storage_md5sum_response.md5sum;
         size_t md5sum_size = sizeof(response.content.storage_md5sum_response.md5sum);
         (void)md5sum_size;
-        furi_assert(hash_size <= ((md5sum_size - 1) / 2));
-        for(uint8_t i = 0; i < hash_size; i++) {
-            md5sum += snprintf(md5sum, md5sum_size, "%02x", hash[i]);
+        furi_assert(sizeof(digest.md5) <= ((md5sum_size - 1) / 2));
+        for(uint8_t i = 0; i < sizeof(digest.md5); i++) {
+            md5sum += snprintf(md5sum, md5sum_size, "%02x", digest.md5[i]);
         }
 
-        free(hash);
-        free(data);
-        storage_file_close(file);
         rpc_send_and_release(session, &response);
     } else {
         rpc_send_and_release_empty(
-            session, request->command_id, rpc_system_storage_get_file_error(file));
+            session, request->command_id, rpc_system_storage_get_error(error));
     }
 
-    storage_file_free(file);
-
     furi_record_close(RECORD_STORAGE);
 }
 
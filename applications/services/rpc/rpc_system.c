@@ -81,14 +81,15 @@ static void rpc_system_system_device_info_callback(
 
     furi_assert(key);
     furi_assert(value);
-    char* str_key = strdup(key);
-    char* str_value = strdup(value);
+    char* str_key = rpc_session_arena_strdup(ctx->session, key);
+    char* str_value = rpc_session_arena_strdup(ctx->session, value);
+    furi_check(str_key && str_value);
 
     ctx->response->has_next = !last;
     ctx->response->content.system_device_info_response.key = str_key;
     ctx->response->content.system_device_info_response.value = str_value;
 
-    rpc_send_and_release(ctx->session, ctx->response);
+    rpc_send_and_reset_arena(ctx->session, ctx->response);
 }
 
 static void rpc_system_system_device_info_process(const PB_Main* request, void* context) {
@@ -100,18 +101,17 @@ static void rpc_system_system_device_info_process(const PB_Main* request, void*
     RpcSession* session = (RpcSession*)context;
     furi_assert(session);
 
-    PB_Main* response = malloc(sizeof(PB_Main));
-    response->command_id = request->command_id;
-    response->which_content = PB_Main_system_device_info_response_tag;
-    response->command_status = PB_CommandStatus_OK;
+    PB_Main response = {
+        .command_id = request->command_id,
+        .which_content = PB_Main_system_device_info_response_tag,
+        .command_status = PB_CommandStatus_OK,
+    };
 
     RpcSystemContext device_info_context = {
         .session = session,
-        .response = response,
+        .response = &response,
     };
     furi_hal_info_get(rpc_system_system_device_info_callback, '_', &device_info_context);
-
-    free(response);
 }
 
 static void rpc_system_system_get_datetime_process(const PB_Main* request, void* context) {
@@ -238,14 +238,15 @@ static void rpc_system_system_power_info_callback(
 
     furi_assert(key);
     furi_assert(value);
-    char* str_key = strdup(key);
-    char* str_value = strdup(value);
+    char* str_key = rpc_session_arena_strdup(ctx->session, key);
+    char* str_value = rpc_session_arena_strdup(ctx->session, value);
+    furi_check(str_key && str_value);
 
     ctx->response->has_next = !last;
     ctx->response->content.system_device_info_response.key = str_key;
     ctx->response->content.system_device_info_response.value = str_value;
 
-    rpc_send_and_release(ctx->session, ctx->response);
+    rpc_send_and_reset_arena(ctx->session, ctx->response);
 }
 
 static void rpc_system_system_get_power_info_process(const PB_Main* request, void* context) {
@@ -257,18 +258,17 @@ static void rpc_system_system_get_power_info_process(const PB_Main* request, voi
     RpcSession* session = (RpcSession*)context;
     furi_assert(session);
 
-    PB_Main* response = malloc(sizeof(PB_Main));
-    response->command_id = request->command_id;
-    response->which_content = PB_Main_system_power_info_response_tag;
-    response->command_status = PB_CommandStatus_OK;
+    PB_Main response = {
+        .command_id = request->command_id,
+        .which_content = PB_Main_system_power_info_response_tag,
+        .command_status = PB_CommandStatus_OK,
+    };
 
     RpcSystemContext power_info_context = {
         .session = session,
-        .response = response,
+        .response = &response,
     };
     furi_hal_power_info_get(rpc_system_system_power_info_callback, '_', &power_info_context);
-
-    free(response);
 }
 
 #ifdef APP_UPDATER
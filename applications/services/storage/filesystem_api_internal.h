@@ -159,6 +159,12 @@ typedef struct {
  *      @param path path to new directory
  *      @return FS_Error error info
  * 
+ *  @var FS_Common_Api::rename
+ *      @brief Rename file/directory within the storage
+ *      @param old_path path to file/directory
+ *      @param new_path new path, must not exist
+ *      @return FS_Error error info
+ * 
  *  @var FS_Common_Api::fs_info
  *      @brief Get total and free space storage values
  *      @param fs_path path of fs
@@ -170,6 +176,7 @@ typedef struct {
     FS_Error (*const stat)(void* context, const char* path, FileInfo* fileinfo);
     FS_Error (*const remove)(void* context, const char* path);
     FS_Error (*const mkdir)(void* context, const char* path);
+    FS_Error (*const rename)(void* context, const char* old_path, const char* new_path);
     FS_Error (*const fs_info)(
         void* context,
         const char* fs_path,
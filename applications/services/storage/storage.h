@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
 #include "filesystem_api_defines.h"
 #include "storage_sd_api.h"
 
@@ -17,6 +18,12 @@ extern "C" {
 
 #define RECORD_STORAGE "storage"
 
+/** File digests cache, see lib/toolbox/hash_cache.h */
+#define STORAGE_HASH_CACHE_PATH EXT_PATH(".hash_cache")
+/** Prefix of spilled file browser listings, one per browser instance,
+ * see gui/modules/file_browser_worker.c */
+#define STORAGE_BROWSER_CACHE_PATH EXT_PATH(".browser.cache")
+
 typedef struct Storage Storage;
 
 /** Allocates and initializes a file descriptor
@@ -175,6 +182,39 @@ bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_
  */
 bool storage_dir_rewind(File* file);
 
+/** Directory entry, as stored in storage_dir_read_batch buffer */
+typedef struct {
+    FileInfo fileinfo;
+    uint16_t record_size; /**< record size with name and padding, offset to next record */
+    char name[];
+} StorageDirRecord;
+
+/** Longest name that can be stored in a record, including terminator */
+#define STORAGE_DIR_RECORD_NAME_MAX 256
+
+#define STORAGE_DIR_RECORD_SIZE(name_length) \
+    ((offsetof(StorageDirRecord, name) + (name_length) + 1 + 7) & ~(size_t)7)
+
+/** Buffer space that guarantees that at least one record fits */
+#define STORAGE_DIR_RECORD_MAX_SIZE STORAGE_DIR_RECORD_SIZE(STORAGE_DIR_RECORD_NAME_MAX - 1)
+
+/** Reads as many directory objects as fit into the buffer in one storage call
+ * @param file pointer to file object.
+ * @param buffer 8-byte aligned buffer, filled with StorageDirRecord records
+ * @param buffer_size buffer size, at least STORAGE_DIR_RECORD_MAX_SIZE
+ * @return number of records read. 0 means that there are no more objects
+ * (file error id is FSE_NOT_EXIST) or that an error occurred.
+ */
+uint16_t storage_dir_read_batch(File* file, void* buffer, size_t buffer_size);
+
+/** Gets next record from storage_dir_read_batch buffer
+ * @param record pointer to current record
+ * @return StorageDirRecord* pointer to next record, valid only within the returned count
+ */
+static inline StorageDirRecord* storage_dir_record_next(StorageDirRecord* record) {
+    return (StorageDirRecord*)((uint8_t*)record + record->record_size);
+}
+
 /******************* Common Functions *******************/
 
 /** Retrieves unix timestamp of last access
@@ -187,6 +227,24 @@ bool storage_dir_rewind(File* file);
  */
 FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp);
 
+/** Retrieves write generation of a path
+ *
+ * Generation changes every time the file at this path may have been written,
+ * truncated, removed, renamed, or when the storage was remounted. Generation
+ * of a directory also changes when an entry may have been created in or
+ * removed from it, so it can be used to validate a listing. Unrelated
+ * paths can share a generation, so a change doesn't guarantee the file itself
+ * was touched, but an unchanged generation guarantees it wasn't. Values of
+ * previous boots never match.
+ *
+ * @param      storage     The storage instance
+ * @param      path        path to file/directory
+ * @param      generation  the generation pointer
+ *
+ * @return     FS_Error operation result
+ */
+FS_Error storage_common_generation(Storage* storage, const char* path, uint32_t* generation);
+
 /** Retrieves information about a file/directory
  * @param app pointer to the api
  * @param path path to file/directory
@@ -202,22 +260,64 @@ FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* filei
  */
 FS_Error storage_common_remove(Storage* storage, const char* path);
 
+/** Copy progress callback, called from the storage thread after every copied chunk.
+ * Storage API must not be used from the callback.
+ * @param copied bytes copied so far
+ * @param total bytes to copy
+ * @param context callback context
+ * @return false to cancel the operation
+ */
+typedef bool (*StorageCopyCallback)(uint64_t copied, uint64_t total, void* context);
+
 /** Renames file/directory, file/directory must not be open
+ * Rename within one storage is done in place, between storages data is copied and then removed.
  * @param app pointer to the api
  * @param old_path old path
- * @param new_path new path
+ * @param new_path new path, must not exist
  * @return FS_Error operation result
  */
 FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path);
 
-/** Copy file, file must not be open
+/** Renames file/directory, reporting progress
  * @param app pointer to the api
  * @param old_path old path
- * @param new_path new path
+ * @param new_path new path, must not exist
+ * @param callback progress callback, may be NULL
+ * @param context callback context
+ * @return FS_Error operation result, FSE_DENIED if cancelled. Source is kept on failure.
+ */
+FS_Error storage_common_move(
+    Storage* storage,
+    const char* old_path,
+    const char* new_path,
+    StorageCopyCallback callback,
+    void* context);
+
+/** Copy file or directory, file must not be open
+ * Copy is done by the storage service, directories are copied recursively.
+ * @param app pointer to the api
+ * @param old_path old path
+ * @param new_path new path, must not exist
  * @return FS_Error operation result
  */
 FS_Error storage_common_copy(Storage* storage, const char* old_path, const char* new_path);
 
+/** Copy file or directory, reporting progress
+ * @param app pointer to the api
+ * @param old_path old path
+ * @param new_path new path, must not exist
+ * @param callback progress callback, may be NULL
+ * @param context callback context
+ * @return FS_Error operation result, FSE_DENIED if cancelled. Partially written file is
+ * removed, directories copied before failure are kept.
+ */
+FS_Error storage_common_copy_ex(
+    Storage* storage,
+    const char* old_path,
+    const char* new_path,
+    StorageCopyCallback callback,
+    void* context);
+
 /** Copy one folder contents into another with rename of all conflicting files
  * @param app pointer to the api
  * @param old_path old path
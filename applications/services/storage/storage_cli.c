@@ -3,13 +3,15 @@
 
 #include <cli/cli.h>
 #include <lib/toolbox/args.h>
-#include <lib/toolbox/md5.h>
+#include <lib/toolbox/hash_cache.h>
 #include <lib/toolbox/dir_walk.h>
 #include <storage/storage.h>
 #include <storage/storage_sd_api.h>
 #include <power/power_service/power.h>
+#include <sector_cache.h>
+#include "storages/storage_int.h"
 
-#define MAX_NAME_LENGTH 255
+#define LIST_BATCH_SIZE 1024
 
 static void storage_cli_print_usage() {
     printf("Usage:\r\n");
@@ -27,8 +29,8 @@ static void storage_cli_print_usage() {
     printf("\twrite\t - read text from cli and append it to file, stops by ctrl+c\r\n");
     printf(
         "\twrite_chunk\t - read data from cli and append it to file, <args> should contain how many bytes you want to write\r\n");
-    printf("\tcopy\t - copy file to new file, <args> must contain new path\r\n");
-    printf("\trename\t - move file to new file, <args> must contain new path\r\n");
+    printf("\tcopy\t - copy file or dir to new path, <args> must contain new path\r\n");
+    printf("\trename\t - move file or dir to new path, <args> must contain new path\r\n");
     printf("\tmkdir\t - creates a new directory\r\n");
     printf("\tmd5\t - md5 hash of the file\r\n");
     printf("\tstat\t - info about file or dir\r\n");
@@ -58,6 +60,19 @@ static void storage_cli_info(Cli* cli, FuriString* path) {
                 (uint32_t)(total_space / 1024),
                 (uint32_t)(free_space / 1024));
         }
+
+        StorageIntStats int_stats;
+        storage_int_get_stats(&int_stats);
+        printf(
+            "Cache: %lu bytes, lookahead %lu bytes\r\n"
+            "%lu reads (%lu KiB), %lu progs (%lu KiB), %lu erases\r\n",
+            int_stats.cache_size,
+            int_stats.lookahead_size,
+            int_stats.reads,
+            int_stats.bytes_read / 1024,
+            int_stats.progs,
+            int_stats.bytes_programmed / 1024,
+            int_stats.erases);
     } else if(furi_string_cmp_str(path, STORAGE_EXT_PATH_PREFIX) == 0) {
         SDInfo sd_info;
         FS_Error error = storage_sd_info(api, &sd_info);
@@ -72,6 +87,22 @@ static void storage_cli_info(Cli* cli, FuriString* path) {
                 sd_info.kb_total,
                 sd_info.kb_free);
         }
+
+        SectorCacheStats cache_stats;
+        sector_cache_get_stats(&cache_stats);
+        uint32_t lookups = cache_stats.hits + cache_stats.misses;
+        printf(
+            "Sector cache: %u/%u sectors, %u metadata, %u dirty\r\n"
+            "%lu hits, %lu misses (%lu%%), %lu evictions, %lu write-backs\r\n",
+            cache_stats.used,
+            cache_stats.capacity,
+            cache_stats.metadata,
+            cache_stats.dirty,
+            cache_stats.hits,
+            cache_stats.misses,
+            lookups ? (uint32_t)((uint64_t)cache_stats.hits * 100 / lookups) : 0,
+            cache_stats.evictions,
+            cache_stats.write_backs);
     } else {
         storage_cli_print_usage();
     }
@@ -116,22 +147,27 @@ static void storage_cli_list(Cli* cli, FuriString* path) {
         File* file = storage_file_alloc(api);
 
         if(storage_dir_open(file, furi_string_get_cstr(path))) {
-            FileInfo fileinfo;
-            char name[MAX_NAME_LENGTH];
+            uint8_t* batch = malloc(LIST_BATCH_SIZE);
             bool read_done = false;
+            uint16_t count;
 
-            while(storage_dir_read(file, &fileinfo, name, MAX_NAME_LENGTH)) {
+            while((count = storage_dir_read_batch(file, batch, LIST_BATCH_SIZE))) {
                 read_done = true;
-                if(fileinfo.flags & FSF_DIRECTORY) {
-                    printf("\t[D] %s\r\n", name);
-                } else {
-                    printf("\t[F] %s %lub\r\n", name, (uint32_t)(fileinfo.size));
+                StorageDirRecord* record = (StorageDirRecord*)batch;
+                for(uint16_t i = 0; i < count; i++, record = storage_dir_record_next(record)) {
+                    if(record->fileinfo.flags & FSF_DIRECTORY) {
+                        printf("\t[D] %s\r\n", record->name);
+                    } else {
+                        printf(
+                            "\t[F] %s %lub\r\n", record->name, (uint32_t)(record->fileinfo.size));
+                    }
                 }
             }
 
             if(!read_done) {
                 printf("\tEmpty\r\n");
             }
+            free(batch);
         } else {
             storage_cli_print_error(storage_file_get_error(file));
         }
@@ -403,8 +439,27 @@ static void storage_cli_timestamp(Cli* cli, FuriString* path) {
     furi_record_close(RECORD_STORAGE);
 }
 
+typedef struct {
+    Cli* cli;
+    uint8_t percent;
+} StorageCliCopyProgress;
+
+// Called from the storage thread: print through the session, not thread stdout
+static bool storage_cli_copy_progress(uint64_t copied, uint64_t total, void* context) {
+    StorageCliCopyProgress* progress = context;
+    uint8_t percent = total ? (copied * 100 / total) : 100;
+
+    if(percent != progress->percent) {
+        char text[16];
+        int length = snprintf(text, sizeof(text), "\r%u%%", percent);
+        cli_write(progress->cli, (uint8_t*)text, length);
+        progress->percent = percent;
+    }
+
+    return !cli_cmd_interrupt_received(progress->cli);
+}
+
 static void storage_cli_copy(Cli* cli, FuriString* old_path, FuriString* args) {
-    UNUSED(cli);
     Storage* api = furi_record_open(RECORD_STORAGE);
     FuriString* new_path;
     new_path = furi_string_alloc();
@@ -412,8 +467,16 @@ static void storage_cli_copy(Cli* cli, FuriString* old_path, FuriString* args) {
     if(!args_read_probably_quoted_string_and_trim(args, new_path)) {
         storage_cli_print_usage();
     } else {
-        FS_Error error = storage_common_copy(
-            api, furi_string_get_cstr(old_path), furi_string_get_cstr(new_path));
+        StorageCliCopyProgress progress = {.cli = cli, .percent = 0};
+        FS_Error error = storage_common_copy_ex(
+            api,
+            furi_string_get_cstr(old_path),
+            furi_string_get_cstr(new_path),
+            storage_cli_copy_progress,
+            &progress);
+        if(progress.percent) {
+            printf("\r\n");
+        }
 
         if(error != FSE_OK) {
             storage_cli_print_error(error);
@@ -437,7 +500,6 @@ static void storage_cli_remove(Cli* cli, FuriString* path) {
 }
 
 static void storage_cli_rename(Cli* cli, FuriString* old_path, FuriString* args) {
-    UNUSED(cli);
     Storage* api = furi_record_open(RECORD_STORAGE);
     FuriString* new_path;
     new_path = furi_string_alloc();
@@ -445,8 +507,16 @@ static void storage_cli_rename(Cli* cli, FuriString* old_path, FuriString* args)
     if(!args_read_probably_quoted_string_and_trim(args, new_path)) {
         storage_cli_print_usage();
     } else {
-        FS_Error error = storage_common_rename(
-            api, furi_string_get_cstr(old_path), furi_string_get_cstr(new_path));
+        StorageCliCopyProgress progress = {.cli = cli, .percent = 0};
+        FS_Error error = storage_common_move(
+            api,
+            furi_string_get_cstr(old_path),
+            furi_string_get_cstr(new_path),
+            storage_cli_copy_progress,
+            &progress);
+        if(progress.percent) {
+            printf("\r\n");
+        }
 
         if(error != FSE_OK) {
             storage_cli_print_error(error);
@@ -472,38 +542,18 @@ static void storage_cli_mkdir(Cli* cli, FuriString* path) {
 static void storage_cli_md5(Cli* cli, FuriString* path) {
     UNUSED(cli);
     Storage* api = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(api);
-
-    if(storage_file_open(file, furi_string_get_cstr(path), FSAM_READ, FSOM_OPEN_EXISTING)) {
-        const uint16_t buffer_size = 512;
-        const uint8_t hash_size = 16;
-        uint8_t* data = malloc(buffer_size);
-        uint8_t* hash = malloc(sizeof(uint8_t) * hash_size);
-        md5_context* md5_ctx = malloc(sizeof(md5_context));
-
-        md5_starts(md5_ctx);
-        while(true) {
-            uint16_t read_size = storage_file_read(file, data, buffer_size);
-            if(read_size == 0) break;
-            md5_update(md5_ctx, data, read_size);
-        }
-        md5_finish(md5_ctx, hash);
-        free(md5_ctx);
+    HashCacheDigest digest;
+    FS_Error error = hash_cache_get(api, furi_string_get_cstr(path), &digest);
 
-        for(uint8_t i = 0; i < hash_size; i++) {
-            printf("%02x", hash[i]);
+    if(error == FSE_OK) {
+        for(uint8_t i = 0; i < sizeof(digest.md5); i++) {
+            printf("%02x", digest.md5[i]);
         }
         printf("\r\n");
-
-        free(hash);
-        free(data);
     } else {
-        storage_cli_print_error(storage_file_get_error(file));
+        storage_cli_print_error(error);
     }
 
-    storage_file_close(file);
-    storage_file_free(file);
-
     furi_record_close(RECORD_STORAGE);
 }
 
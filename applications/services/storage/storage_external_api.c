@@ -3,12 +3,11 @@
 #include "storage.h"
 #include "storage_i.h"
 #include "storage_message.h"
-#include <toolbox/stream/file_stream.h>
 #include <toolbox/dir_walk.h>
 #include "toolbox/path.h"
 
-#define MAX_NAME_LENGTH 256
 #define MAX_EXT_LEN 16
+#define REMOVE_BATCH_SIZE 1024
 
 #define TAG "StorageAPI"
 
@@ -343,6 +342,24 @@ bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_
     return S_RETURN_BOOL;
 }
 
+uint16_t storage_dir_read_batch(File* file, void* buffer, size_t buffer_size) {
+    furi_assert(((uintptr_t)buffer & 7) == 0);
+    furi_assert(buffer_size >= STORAGE_DIR_RECORD_MAX_SIZE);
+    S_FILE_API_PROLOGUE;
+    S_API_PROLOGUE;
+
+    SAData data = {
+        .dreadbatch = {
+            .file = file,
+            .buffer = buffer,
+            .buffer_size = buffer_size,
+        }};
+
+    S_API_MESSAGE(StorageCommandDirReadBatch);
+    S_API_EPILOGUE;
+    return S_RETURN_UINT16;
+}
+
 bool storage_dir_rewind(File* file) {
     S_FILE_API_PROLOGUE;
     S_API_PROLOGUE;
@@ -364,6 +381,16 @@ FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t*
     return S_RETURN_ERROR;
 }
 
+FS_Error storage_common_generation(Storage* storage, const char* path, uint32_t* generation) {
+    S_API_PROLOGUE;
+
+    SAData data = {.cgeneration = {.path = path, .generation = generation}};
+
+    S_API_MESSAGE(StorageCommandCommonGeneration);
+    S_API_EPILOGUE;
+    return S_RETURN_ERROR;
+}
+
 FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
     S_API_PROLOGUE;
 
@@ -382,104 +409,53 @@ FS_Error storage_common_remove(Storage* storage, const char* path) {
     return S_RETURN_ERROR;
 }
 
-FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
-    FS_Error error = storage_common_copy(storage, old_path, new_path);
-    if(error == FSE_OK) {
-        if(storage_simply_remove_recursive(storage, old_path)) {
-            error = FSE_OK;
-        } else {
-            error = FSE_INTERNAL;
-        }
-    }
-
-    return error;
-}
-
-static FS_Error
-    storage_copy_recursive(Storage* storage, const char* old_path, const char* new_path) {
-    FS_Error error = storage_common_mkdir(storage, new_path);
-    DirWalk* dir_walk = dir_walk_alloc(storage);
-    FuriString* path;
-    FuriString* tmp_new_path;
-    FuriString* tmp_old_path;
-    FileInfo fileinfo;
-    path = furi_string_alloc();
-    tmp_new_path = furi_string_alloc();
-    tmp_old_path = furi_string_alloc();
-
-    do {
-        if(error != FSE_OK) break;
-
-        if(!dir_walk_open(dir_walk, old_path)) {
-            error = dir_walk_get_error(dir_walk);
-            break;
-        }
-
-        while(1) {
-            DirWalkResult res = dir_walk_read(dir_walk, path, &fileinfo);
-
-            if(res == DirWalkError) {
-                error = dir_walk_get_error(dir_walk);
-                break;
-            } else if(res == DirWalkLast) {
-                break;
-            } else {
-                furi_string_set(tmp_old_path, path);
-                furi_string_right(path, strlen(old_path));
-                furi_string_printf(tmp_new_path, "%s%s", new_path, furi_string_get_cstr(path));
+static FS_Error storage_common_copy_internal(
+    Storage* storage,
+    const char* old_path,
+    const char* new_path,
+    bool move,
+    StorageCopyCallback callback,
+    void* context) {
+    S_API_PROLOGUE;
 
-                if(fileinfo.flags & FSF_DIRECTORY) {
-                    error = storage_common_mkdir(storage, furi_string_get_cstr(tmp_new_path));
-                } else {
-                    error = storage_common_copy(
-                        storage,
-                        furi_string_get_cstr(tmp_old_path),
-                        furi_string_get_cstr(tmp_new_path));
-                }
+    SAData data = {
+        .ccopy = {
+            .old_path = old_path,
+            .new_path = new_path,
+            .move = move,
+            .callback = callback,
+            .context = context,
+        }};
 
-                if(error != FSE_OK) break;
-            }
-        }
+    S_API_MESSAGE(StorageCommandCommonCopy);
+    S_API_EPILOGUE;
+    return S_RETURN_ERROR;
+}
 
-    } while(false);
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    return storage_common_copy_internal(storage, old_path, new_path, true, NULL, NULL);
+}
 
-    furi_string_free(tmp_new_path);
-    furi_string_free(tmp_old_path);
-    furi_string_free(path);
-    dir_walk_free(dir_walk);
-    return error;
+FS_Error storage_common_move(
+    Storage* storage,
+    const char* old_path,
+    const char* new_path,
+    StorageCopyCallback callback,
+    void* context) {
+    return storage_common_copy_internal(storage, old_path, new_path, true, callback, context);
 }
 
 FS_Error storage_common_copy(Storage* storage, const char* old_path, const char* new_path) {
-    FS_Error error;
-
-    FileInfo fileinfo;
-    error = storage_common_stat(storage, old_path, &fileinfo);
-
-    if(error == FSE_OK) {
-        if(fileinfo.flags & FSF_DIRECTORY) {
-            error = storage_copy_recursive(storage, old_path, new_path);
-        } else {
-            Stream* stream_from = file_stream_alloc(storage);
-            Stream* stream_to = file_stream_alloc(storage);
-
-            do {
-                if(!file_stream_open(stream_from, old_path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
-                if(!file_stream_open(stream_to, new_path, FSAM_WRITE, FSOM_CREATE_NEW)) break;
-                stream_copy_full(stream_from, stream_to);
-            } while(false);
-
-            error = file_stream_get_error(stream_from);
-            if(error == FSE_OK) {
-                error = file_stream_get_error(stream_to);
-            }
-
-            stream_free(stream_from);
-            stream_free(stream_to);
-        }
-    }
+    return storage_common_copy_internal(storage, old_path, new_path, false, NULL, NULL);
+}
 
-    return error;
+FS_Error storage_common_copy_ex(
+    Storage* storage,
+    const char* old_path,
+    const char* new_path,
+    StorageCopyCallback callback,
+    void* context) {
+    return storage_common_copy_internal(storage, old_path, new_path, false, callback, context);
 }
 
 static FS_Error
@@ -587,22 +563,7 @@ FS_Error storage_common_merge(Storage* storage, const char* old_path, const char
             } else {
                 new_path_tmp = new_path;
             }
-            Stream* stream_from = file_stream_alloc(storage);
-            Stream* stream_to = file_stream_alloc(storage);
-
-            do {
-                if(!file_stream_open(stream_from, old_path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
-                if(!file_stream_open(stream_to, new_path_tmp, FSAM_WRITE, FSOM_CREATE_NEW)) break;
-                stream_copy_full(stream_from, stream_to);
-            } while(false);
-
-            error = file_stream_get_error(stream_from);
-            if(error == FSE_OK) {
-                error = file_stream_get_error(stream_to);
-            }
-
-            stream_free(stream_from);
-            stream_free(stream_to);
+            error = storage_common_copy(storage, old_path, new_path_tmp);
         }
     }
 
@@ -734,7 +695,6 @@ FuriPubSub* storage_get_pubsub(Storage* storage) {
 bool storage_simply_remove_recursive(Storage* storage, const char* path) {
     furi_assert(storage);
     furi_assert(path);
-    FileInfo fileinfo;
     bool result = false;
     FuriString* fullname;
     FuriString* cur_dir;
@@ -743,10 +703,9 @@ bool storage_simply_remove_recursive(Storage* storage, const char* path) {
         return true;
     }
 
-    char* name = malloc(MAX_NAME_LENGTH + 1);
+    uint8_t* batch = malloc(REMOVE_BATCH_SIZE);
     File* dir = storage_file_alloc(storage);
     cur_dir = furi_string_alloc_set(path);
-    bool go_deeper = false;
 
     while(1) {
         if(!storage_dir_open(dir, furi_string_get_cstr(cur_dir))) {
@@ -754,22 +713,31 @@ bool storage_simply_remove_recursive(Storage* storage, const char* path) {
             break;
         }
 
-        while(storage_dir_read(dir, &fileinfo, name, MAX_NAME_LENGTH)) {
-            if(fileinfo.flags & FSF_DIRECTORY) {
-                furi_string_cat_printf(cur_dir, "/%s", name);
-                go_deeper = true;
-                break;
+        // Take the whole batch before removing anything, directory is reopened for the next one
+        uint16_t count = storage_dir_read_batch(dir, batch, REMOVE_BATCH_SIZE);
+        storage_dir_close(dir);
+
+        const char* subdir = NULL;
+        StorageDirRecord* record = (StorageDirRecord*)batch;
+        for(uint16_t i = 0; i < count; i++, record = storage_dir_record_next(record)) {
+            if(record->fileinfo.flags & FSF_DIRECTORY) {
+                if(subdir == NULL) {
+                    subdir = record->name;
+                }
+                continue;
             }
 
-            fullname = furi_string_alloc_printf("%s/%s", furi_string_get_cstr(cur_dir), name);
+            fullname =
+                furi_string_alloc_printf("%s/%s", furi_string_get_cstr(cur_dir), record->name);
             FS_Error error = storage_common_remove(storage, furi_string_get_cstr(fullname));
             furi_check(error == FSE_OK);
             furi_string_free(fullname);
         }
-        storage_dir_close(dir);
 
-        if(go_deeper) {
-            go_deeper = false;
+        if(subdir) {
+            furi_string_cat_printf(cur_dir, "/%s", subdir);
+            continue;
+        } else if(count > 0) {
             continue;
         }
 
@@ -788,7 +756,7 @@ bool storage_simply_remove_recursive(Storage* storage, const char* path) {
 
     storage_file_free(dir);
     furi_string_free(cur_dir);
-    free(name);
+    free(batch);
     return result;
 }
 
@@ -1,4 +1,5 @@
 #include "storage_glue.h"
+#include "storage.h"
 #include <furi_hal.h>
 
 /****************** storage file ******************/
@@ -36,6 +37,9 @@ void storage_data_init(StorageData* storage) {
     storage->data = NULL;
     storage->status = StorageStatusNotReady;
     StorageFileList_init(storage->files);
+    /* Stamps of previous boots must not match: there is no way to tell what happened since */
+    storage->generation = furi_hal_random_get();
+    storage_data_generation_reset(storage);
 }
 
 bool storage_data_lock(StorageData* storage) {
@@ -90,6 +94,70 @@ uint32_t storage_data_get_timestamp(StorageData* storage) {
     return storage->timestamp;
 }
 
+static uint32_t storage_data_generation_bucket(FuriString* path) {
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    const char* str = furi_string_get_cstr(path);
+    while(*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619UL;
+    }
+    return hash % STORAGE_GENERATION_BUCKETS;
+}
+
+void storage_data_generation_reset(StorageData* storage) {
+    storage->generation++;
+    for(size_t i = 0; i < STORAGE_GENERATION_BUCKETS; i++) {
+        storage->generations[i] = storage->generation;
+    }
+}
+
+static bool storage_data_generation_is_cache(FuriString* path) {
+    /* Browser cache path is a prefix, every browser instance has own file */
+    return (furi_string_cmp_str(path, STORAGE_HASH_CACHE_PATH) == 0) ||
+           furi_string_start_with_str(path, STORAGE_BROWSER_CACHE_PATH);
+}
+
+void storage_data_generation_bump(StorageData* storage, FuriString* path) {
+    /* Cache updates would otherwise invalidate every file sharing their bucket */
+    if(storage_data_generation_is_cache(path)) return;
+
+    storage->generation++;
+    storage->generations[storage_data_generation_bucket(path)] = storage->generation;
+}
+
+void storage_data_generation_bump_entry(StorageData* storage, FuriString* path) {
+    storage_data_generation_bump(storage, path);
+    if(storage_data_generation_is_cache(path)) return;
+
+    /* Entry may appear or disappear, so directory listing changes too */
+    size_t separator = furi_string_search_rchar(path, '/');
+    if(separator != FURI_STRING_FAILURE && separator > 0) {
+        FuriString* parent = furi_string_alloc_set(path);
+        furi_string_left(parent, separator);
+        storage->generation++;
+        storage->generations[storage_data_generation_bucket(parent)] = storage->generation;
+        furi_string_free(parent);
+    }
+}
+
+void storage_data_generation_bump_file(StorageData* storage, const File* file) {
+    StorageFileList_it_t it;
+    for(StorageFileList_it(it, storage->files); !StorageFileList_end_p(it);
+        StorageFileList_next(it)) {
+        const StorageFile* storage_file = StorageFileList_cref(it);
+
+        if(storage_file->file->file_id == file->file_id) {
+            storage_data_generation_bump(storage, storage_file->path);
+            break;
+        }
+    }
+}
+
+uint32_t storage_data_get_generation(StorageData* storage, FuriString* path) {
+    return storage->generations[storage_data_generation_bucket(path)];
+}
+
 /****************** storage glue ******************/
 
 bool storage_has_file(const File* file, StorageData* storage_data) {
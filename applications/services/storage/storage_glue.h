@@ -10,6 +10,9 @@ extern "C" {
 
 typedef enum { ST_EXT = 0, ST_INT = 1, ST_ANY, ST_ERROR } StorageType;
 
+/* Paths are spread over buckets, a change bumps every path of its bucket */
+#define STORAGE_GENERATION_BUCKETS 64
+
 typedef struct StorageData StorageData;
 
 typedef struct {
@@ -44,6 +47,11 @@ StorageStatus storage_data_status(StorageData* storage);
 const char* storage_data_status_text(StorageData* storage);
 void storage_data_timestamp(StorageData* storage);
 uint32_t storage_data_get_timestamp(StorageData* storage);
+void storage_data_generation_reset(StorageData* storage);
+void storage_data_generation_bump(StorageData* storage, FuriString* path);
+void storage_data_generation_bump_entry(StorageData* storage, FuriString* path);
+void storage_data_generation_bump_file(StorageData* storage, const File* file);
+uint32_t storage_data_get_generation(StorageData* storage, FuriString* path);
 
 LIST_DEF(
     StorageFileList,
@@ -61,6 +69,8 @@ struct StorageData {
     StorageStatus status;
     StorageFileList_t files;
     uint32_t timestamp;
+    uint32_t generation;
+    uint32_t generations[STORAGE_GENERATION_BUCKETS];
 };
 
 bool storage_has_file(const File* file, StorageData* storage_data);
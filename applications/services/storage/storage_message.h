@@ -42,16 +42,35 @@ typedef struct {
     uint16_t name_length;
 } SADataDRead;
 
+typedef struct {
+    File* file;
+    void* buffer;
+    size_t buffer_size;
+} SADataDReadBatch;
+
 typedef struct {
     const char* path;
     uint32_t* timestamp;
 } SADataCTimestamp;
 
+typedef struct {
+    const char* path;
+    uint32_t* generation;
+} SADataCGeneration;
+
 typedef struct {
     const char* path;
     FileInfo* fileinfo;
 } SADataCStat;
 
+typedef struct {
+    const char* old_path;
+    const char* new_path;
+    bool move;
+    StorageCopyCallback callback;
+    void* context;
+} SADataCCopy;
+
 typedef struct {
     const char* fs_path;
     uint64_t* total_space;
@@ -82,9 +101,12 @@ typedef union {
 
     SADataDOpen dopen;
     SADataDRead dread;
+    SADataDReadBatch dreadbatch;
 
     SADataCTimestamp ctimestamp;
+    SADataCGeneration cgeneration;
     SADataCStat cstat;
+    SADataCCopy ccopy;
     SADataCFSInfo cfsinfo;
 
     SADataError error;
@@ -117,11 +139,14 @@ typedef enum {
     StorageCommandDirOpen,
     StorageCommandDirClose,
     StorageCommandDirRead,
+    StorageCommandDirReadBatch,
     StorageCommandDirRewind,
     StorageCommandCommonTimestamp,
+    StorageCommandCommonGeneration,
     StorageCommandCommonStat,
     StorageCommandCommonRemove,
     StorageCommandCommonMkDir,
+    StorageCommandCommonCopy,
     StorageCommandCommonFSInfo,
     StorageCommandSDFormat,
     StorageCommandSDUnmount,
@@ -116,6 +116,7 @@ bool storage_process_file_open(
         } else {
             if(access_mode & FSAM_WRITE) {
                 storage_data_timestamp(storage);
+                storage_data_generation_bump_entry(storage, real_path);
             }
             storage_push_storage_file(file, real_path, type, storage);
             FS_CALL(storage, file.open(storage, file, remove_vfs(path), access_mode, open_mode));
@@ -170,6 +171,7 @@ static uint16_t storage_process_file_write(
         file->error_id = FSE_INVALID_PARAMETER;
     } else {
         storage_data_timestamp(storage);
+        storage_data_generation_bump_file(storage, file);
         FS_CALL(storage, file.write(storage, file, buff, bytes_to_write));
     }
 
@@ -214,6 +216,7 @@ static bool storage_process_file_truncate(Storage* app, File* file) {
         file->error_id = FSE_INVALID_PARAMETER;
     } else {
         storage_data_timestamp(storage);
+        storage_data_generation_bump_file(storage, file);
         FS_CALL(storage, file.truncate(storage, file));
     }
 
@@ -323,6 +326,40 @@ bool storage_process_dir_read(
     return ret;
 }
 
+static uint16_t
+    storage_process_dir_read_batch(Storage* app, File* file, void* buffer, size_t buffer_size) {
+    uint16_t count = 0;
+    StorageData* storage = get_storage_by_file(file, app->storage);
+
+    if(storage == NULL) {
+        file->error_id = FSE_INVALID_PARAMETER;
+    } else {
+        uint8_t* cursor = buffer;
+
+        storage_data_lock(storage);
+        while(buffer_size >= STORAGE_DIR_RECORD_MAX_SIZE && count < UINT16_MAX) {
+            StorageDirRecord* record = (StorageDirRecord*)cursor;
+            if(!storage->fs_api->dir.read(
+                   storage, file, &record->fileinfo, record->name, STORAGE_DIR_RECORD_NAME_MAX)) {
+                break;
+            }
+
+            record->record_size = STORAGE_DIR_RECORD_SIZE(strlen(record->name));
+            cursor += record->record_size;
+            buffer_size -= record->record_size;
+            count++;
+        }
+        storage_data_unlock(storage);
+
+        // End of directory is reported by the next call, when there is nothing to return
+        if(count > 0) {
+            file->error_id = FSE_OK;
+        }
+    }
+
+    return count;
+}
+
 bool storage_process_dir_rewind(Storage* app, File* file) {
     bool ret = false;
     StorageData* storage = get_storage_by_file(file, app->storage);
@@ -353,6 +390,24 @@ static FS_Error
     return ret;
 }
 
+static FS_Error
+    storage_process_common_generation(Storage* app, const char* path, uint32_t* generation) {
+    FS_Error ret = FSE_OK;
+    StorageType type = storage_get_type_by_path(app, path);
+
+    if(storage_type_is_not_valid(type)) {
+        ret = FSE_INVALID_NAME;
+    } else {
+        StorageData* storage = storage_get_storage_by_type(app, type);
+        FuriString* real_path = furi_string_alloc_set(path);
+        storage_path_change_to_real_storage(real_path, type);
+        *generation = storage_data_get_generation(storage, real_path);
+        furi_string_free(real_path);
+    }
+
+    return ret;
+}
+
 static FS_Error storage_process_common_stat(Storage* app, const char* path, FileInfo* fileinfo) {
     FS_Error ret = FSE_OK;
     StorageType type = storage_get_type_by_path(app, path);
@@ -388,6 +443,7 @@ static FS_Error storage_process_common_remove(Storage* app, const char* path) {
         }
 
         storage_data_timestamp(storage);
+        storage_data_generation_bump_entry(storage, real_path);
         FS_CALL(storage, common.remove(storage, remove_vfs(path)));
     } while(false);
 
@@ -404,8 +460,12 @@ static FS_Error storage_process_common_mkdir(Storage* app, const char* path) {
         ret = FSE_INVALID_NAME;
     } else {
         StorageData* storage = storage_get_storage_by_type(app, type);
+        FuriString* real_path = furi_string_alloc_set(path);
+        storage_path_change_to_real_storage(real_path, type);
         storage_data_timestamp(storage);
+        storage_data_generation_bump_entry(storage, real_path);
         FS_CALL(storage, common.mkdir(storage, remove_vfs(path)));
+        furi_string_free(real_path);
     }
 
     return ret;
@@ -429,6 +489,347 @@ static FS_Error storage_process_common_fs_info(
     return ret;
 }
 
+/****************** Copy and Move ******************/
+
+/* Transfer buffer is a multiple of the sector size: FatFs moves whole sectors
+ * between card and buffer directly, bypassing its window */
+#define STORAGE_COPY_BUFFER_MIN 512
+#define STORAGE_COPY_BUFFER_MAX (16 * 1024)
+#define STORAGE_COPY_BATCH_SIZE 1024
+
+typedef struct StorageCopyFrame StorageCopyFrame;
+
+struct StorageCopyFrame {
+    File dir;
+    StorageDirRecord* record;
+    uint16_t records_left;
+    size_t old_length;
+    size_t new_length;
+    StorageCopyFrame* parent;
+    uint64_t batch[STORAGE_COPY_BATCH_SIZE / sizeof(uint64_t)];
+};
+
+typedef struct {
+    Storage* app;
+    FuriString* old_path;
+    FuriString* new_path;
+    uint8_t* buffer;
+    uint16_t buffer_size;
+    StorageCopyCallback callback;
+    void* context;
+    uint64_t copied;
+    uint64_t total;
+} StorageCopy;
+
+static void storage_copy_file_init(Storage* app, File* file) {
+    memset(file, 0, sizeof(File));
+    file->type = FileTypeClosed;
+    file->storage = app;
+}
+
+static FS_Error storage_copy_file(StorageCopy* copy) {
+    const char* new_path = furi_string_get_cstr(copy->new_path);
+    FS_Error error = FSE_OK;
+    File file_from;
+    File file_to;
+    storage_copy_file_init(copy->app, &file_from);
+    storage_copy_file_init(copy->app, &file_to);
+
+    bool from_opened = storage_process_file_open(
+        copy->app,
+        &file_from,
+        furi_string_get_cstr(copy->old_path),
+        FSAM_READ,
+        FSOM_OPEN_EXISTING);
+    bool to_opened = from_opened &&
+                     storage_process_file_open(
+                         copy->app, &file_to, new_path, FSAM_WRITE, FSOM_CREATE_NEW);
+
+    if(!from_opened) {
+        error = file_from.error_id;
+    } else if(!to_opened) {
+        error = file_to.error_id;
+    } else {
+        while(true) {
+            uint16_t was_read = storage_process_file_read(
+                copy->app, &file_from, copy->buffer, copy->buffer_size);
+            if(file_from.error_id != FSE_OK) {
+                error = file_from.error_id;
+                break;
+            }
+            if(was_read == 0) break;
+
+            uint16_t was_written =
+                storage_process_file_write(copy->app, &file_to, copy->buffer, was_read);
+            if(was_written != was_read) {
+                error = (file_to.error_id != FSE_OK) ? file_to.error_id : FSE_INTERNAL;
+                break;
+            }
+
+            copy->copied += was_read;
+            if(copy->callback && !copy->callback(copy->copied, copy->total, copy->context)) {
+                error = FSE_DENIED;
+                break;
+            }
+
+            if(was_read < copy->buffer_size) break;
+        }
+    }
+
+    storage_process_file_close(copy->app, &file_from);
+    if(from_opened) {
+        // closing flushes the destination, so it can fail too
+        if(!storage_process_file_close(copy->app, &file_to) && to_opened && error == FSE_OK) {
+            error = file_to.error_id;
+        }
+    }
+
+    if(to_opened && error != FSE_OK) {
+        storage_process_common_remove(copy->app, new_path);
+    }
+
+    return error;
+}
+
+static FS_Error storage_copy_frame_push(StorageCopy* copy, StorageCopyFrame** frame) {
+    StorageCopyFrame* child = malloc(sizeof(StorageCopyFrame));
+    storage_copy_file_init(copy->app, &child->dir);
+    child->records_left = 0;
+    child->old_length = furi_string_size(copy->old_path);
+    child->new_length = furi_string_size(copy->new_path);
+    child->parent = *frame;
+    *frame = child;
+
+    storage_process_dir_open(copy->app, &child->dir, furi_string_get_cstr(copy->old_path));
+    return child->dir.error_id;
+}
+
+static void storage_copy_frame_pop(StorageCopy* copy, StorageCopyFrame** frame) {
+    StorageCopyFrame* child = *frame;
+    storage_process_dir_close(copy->app, &child->dir);
+    *frame = child->parent;
+    free(child);
+
+    if(*frame) {
+        furi_string_left(copy->old_path, (*frame)->old_length);
+        furi_string_left(copy->new_path, (*frame)->new_length);
+    }
+}
+
+/* Walks the tree with an explicit stack: recursion would not fit in the storage thread stack */
+static FS_Error storage_copy_tree(StorageCopy* copy, bool count_only) {
+    StorageCopyFrame* frame = NULL;
+    size_t old_length = furi_string_size(copy->old_path);
+    size_t new_length = furi_string_size(copy->new_path);
+    FS_Error error = FSE_OK;
+
+    if(!count_only) {
+        error = storage_process_common_mkdir(copy->app, furi_string_get_cstr(copy->new_path));
+    }
+
+    if(error == FSE_OK) {
+        error = storage_copy_frame_push(copy, &frame);
+    }
+
+    while(frame && error == FSE_OK) {
+        if(frame->records_left == 0) {
+            frame->records_left = storage_process_dir_read_batch(
+                copy->app, &frame->dir, frame->batch, sizeof(frame->batch));
+            frame->record = (StorageDirRecord*)frame->batch;
+
+            if(frame->records_left == 0) {
+                if(frame->dir.error_id != FSE_NOT_EXIST) {
+                    error = frame->dir.error_id;
+                }
+                storage_copy_frame_pop(copy, &frame);
+                continue;
+            }
+        }
+
+        StorageDirRecord* record = frame->record;
+        frame->record = storage_dir_record_next(record);
+        frame->records_left--;
+
+        furi_string_cat_printf(copy->old_path, "/%s", record->name);
+        furi_string_cat_printf(copy->new_path, "/%s", record->name);
+
+        if(record->fileinfo.flags & FSF_DIRECTORY) {
+            if(!count_only) {
+                error =
+                    storage_process_common_mkdir(copy->app, furi_string_get_cstr(copy->new_path));
+            }
+            if(error == FSE_OK) {
+                error = storage_copy_frame_push(copy, &frame);
+            }
+        } else {
+            if(count_only) {
+                copy->total += record->fileinfo.size;
+            } else {
+                error = storage_copy_file(copy);
+            }
+            furi_string_left(copy->old_path, frame->old_length);
+            furi_string_left(copy->new_path, frame->new_length);
+        }
+    }
+
+    while(frame) {
+        storage_copy_frame_pop(copy, &frame);
+    }
+
+    furi_string_left(copy->old_path, old_length);
+    furi_string_left(copy->new_path, new_length);
+    return error;
+}
+
+/* Removes source tree after a move between storages. Directory is read in batches and closed
+ * before anything is removed from it */
+static FS_Error storage_copy_remove_tree(StorageCopy* copy) {
+    size_t root_length = furi_string_size(copy->old_path);
+    FS_Error error = FSE_OK;
+    File dir;
+
+    while(error == FSE_OK) {
+        uint16_t count = 0;
+        storage_copy_file_init(copy->app, &dir);
+        if(storage_process_dir_open(copy->app, &dir, furi_string_get_cstr(copy->old_path))) {
+            count = storage_process_dir_read_batch(
+                copy->app, &dir, copy->buffer, copy->buffer_size);
+        }
+        error = dir.error_id;
+        storage_process_dir_close(copy->app, &dir);
+
+        if(count == 0) {
+            if(error != FSE_NOT_EXIST) break;
+
+            error = storage_process_common_remove(copy->app, furi_string_get_cstr(copy->old_path));
+            if(error != FSE_OK || furi_string_size(copy->old_path) == root_length) break;
+
+            furi_string_left(copy->old_path, furi_string_search_rchar(copy->old_path, '/'));
+            continue;
+        }
+
+        size_t length = furi_string_size(copy->old_path);
+        const char* subdir = NULL;
+        StorageDirRecord* record = (StorageDirRecord*)copy->buffer;
+        for(uint16_t i = 0; i < count && error == FSE_OK;
+            i++, record = storage_dir_record_next(record)) {
+            if(record->fileinfo.flags & FSF_DIRECTORY) {
+                if(subdir == NULL) {
+                    subdir = record->name;
+                }
+                continue;
+            }
+
+            furi_string_cat_printf(copy->old_path, "/%s", record->name);
+            error = storage_process_common_remove(copy->app, furi_string_get_cstr(copy->old_path));
+            furi_string_left(copy->old_path, length);
+        }
+
+        if(error == FSE_OK && subdir) {
+            furi_string_cat_printf(copy->old_path, "/%s", subdir);
+        }
+    }
+
+    furi_string_left(copy->old_path, root_length);
+    return error;
+}
+
+static bool storage_copy_is_nested(const char* old_path, const char* new_path) {
+    size_t old_length = strlen(old_path);
+    return strncmp(old_path, new_path, old_length) == 0 && new_path[old_length] == '/';
+}
+
+static FS_Error storage_process_common_copy(
+    Storage* app,
+    const char* old_path,
+    const char* new_path,
+    bool move,
+    StorageCopyCallback callback,
+    void* context) {
+    StorageType old_type = storage_get_type_by_path(app, old_path);
+    StorageType new_type = storage_get_type_by_path(app, new_path);
+    FileInfo fileinfo;
+
+    if(storage_type_is_not_valid(old_type) || storage_type_is_not_valid(new_type)) {
+        return FSE_INVALID_NAME;
+    }
+
+    if(old_type == new_type &&
+       storage_copy_is_nested(remove_vfs(old_path), remove_vfs(new_path))) {
+        return FSE_INVALID_PARAMETER;
+    }
+
+    FS_Error error = storage_process_common_stat(app, new_path, &fileinfo);
+    if(error == FSE_OK) {
+        return FSE_EXIST;
+    }
+
+    error = storage_process_common_stat(app, old_path, &fileinfo);
+    if(error != FSE_OK) {
+        return error;
+    }
+
+    if(move && old_type == new_type) {
+        FS_Error ret = FSE_OK;
+        StorageData* storage = storage_get_storage_by_type(app, old_type);
+        FuriString* real_path;
+        real_path = furi_string_alloc_set(old_path);
+        storage_path_change_to_real_storage(real_path, old_type);
+
+        if(storage_path_already_open(real_path, storage->files)) {
+            ret = FSE_ALREADY_OPEN;
+        } else {
+            storage_data_timestamp(storage);
+            /* Whole subtree can change its paths, don't try to track it */
+            storage_data_generation_reset(storage);
+            FS_CALL(storage, common.rename(storage, remove_vfs(old_path), remove_vfs(new_path)));
+        }
+
+        furi_string_free(real_path);
+        return ret;
+    }
+
+    StorageCopy copy = {
+        .app = app,
+        .old_path = furi_string_alloc_set(old_path),
+        .new_path = furi_string_alloc_set(new_path),
+        .callback = callback,
+        .context = context,
+        .copied = 0,
+        .total = fileinfo.size,
+    };
+
+    // Leave at least half of the largest free block to everyone else
+    size_t buffer_size = memmgr_heap_get_max_free_block() / 2;
+    buffer_size = CLAMP(buffer_size, STORAGE_COPY_BUFFER_MAX, STORAGE_COPY_BUFFER_MIN);
+    copy.buffer_size = buffer_size & ~(STORAGE_COPY_BUFFER_MIN - 1);
+    copy.buffer = malloc(copy.buffer_size);
+
+    if(fileinfo.flags & FSF_DIRECTORY) {
+        if(callback) {
+            copy.total = 0;
+            error = storage_copy_tree(&copy, true);
+        }
+        if(error == FSE_OK) {
+            error = storage_copy_tree(&copy, false);
+        }
+        if(error == FSE_OK && move) {
+            error = storage_copy_remove_tree(&copy);
+        }
+    } else {
+        error = storage_copy_file(&copy);
+        if(error == FSE_OK && move) {
+            error = storage_process_common_remove(app, old_path);
+        }
+    }
+
+    free(copy.buffer);
+    furi_string_free(copy.old_path);
+    furi_string_free(copy.new_path);
+
+    return error;
+}
+
 /****************** Raw SD API ******************/
 // TODO think about implementing a custom storage API to split that kind of api linkage
 #include "storages/storage_ext.h"
@@ -441,6 +842,7 @@ static FS_Error storage_process_sd_format(Storage* app) {
     } else {
         ret = sd_format_card(&app->storage[ST_EXT]);
         storage_data_timestamp(&app->storage[ST_EXT]);
+        storage_data_generation_reset(&app->storage[ST_EXT]);
     }
 
     return ret;
@@ -562,6 +964,13 @@ void storage_process_message_internal(Storage* app, StorageMessage* message) {
             message->data->dread.name,
             message->data->dread.name_length);
         break;
+    case StorageCommandDirReadBatch:
+        message->return_data->uint16_value = storage_process_dir_read_batch(
+            app,
+            message->data->dreadbatch.file,
+            message->data->dreadbatch.buffer,
+            message->data->dreadbatch.buffer_size);
+        break;
     case StorageCommandDirRewind:
         message->return_data->bool_value =
             storage_process_dir_rewind(app, message->data->file.file);
@@ -570,6 +979,10 @@ void storage_process_message_internal(Storage* app, StorageMessage* message) {
         message->return_data->error_value = storage_process_common_timestamp(
             app, message->data->ctimestamp.path, message->data->ctimestamp.timestamp);
         break;
+    case StorageCommandCommonGeneration:
+        message->return_data->error_value = storage_process_common_generation(
+            app, message->data->cgeneration.path, message->data->cgeneration.generation);
+        break;
     case StorageCommandCommonStat:
         message->return_data->error_value = storage_process_common_stat(
             app, message->data->cstat.path, message->data->cstat.fileinfo);
@@ -582,6 +995,15 @@ void storage_process_message_internal(Storage* app, StorageMessage* message) {
         message->return_data->error_value =
             storage_process_common_mkdir(app, message->data->path.path);
         break;
+    case StorageCommandCommonCopy:
+        message->return_data->error_value = storage_process_common_copy(
+            app,
+            message->data->ccopy.old_path,
+            message->data->ccopy.new_path,
+            message->data->ccopy.move,
+            message->data->ccopy.callback,
+            message->data->ccopy.context);
+        break;
     case StorageCommandCommonFSInfo:
         message->return_data->error_value = storage_process_common_fs_info(
             app,
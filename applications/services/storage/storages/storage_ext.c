@@ -91,6 +91,8 @@ static bool sd_mount_card(StorageData* storage, bool notify) {
     }
 
     storage_data_timestamp(storage);
+    /* Card could have been changed anywhere while it was out */
+    storage_data_generation_reset(storage);
     storage_data_unlock(storage);
 
     return result;
@@ -107,6 +109,7 @@ FS_Error sd_unmount_card(StorageData* storage) {
     // TODO do i need to close the files?
 
     f_mount(0, sd_data->path, 0);
+    storage_data_generation_reset(storage);
     storage_data_unlock(storage);
     return storage_ext_parse_error(error);
 }
@@ -531,6 +534,18 @@ static FS_Error storage_ext_common_remove(void* ctx, const char* path) {
 #endif
 }
 
+static FS_Error storage_ext_common_rename(void* ctx, const char* old_path, const char* new_path) {
+    UNUSED(ctx);
+#ifdef FURI_RAM_EXEC
+    UNUSED(old_path);
+    UNUSED(new_path);
+    return FSE_NOT_READY;
+#else
+    SDError result = f_rename(old_path, new_path);
+    return storage_ext_parse_error(result);
+#endif
+}
+
 static FS_Error storage_ext_common_mkdir(void* ctx, const char* path) {
     UNUSED(ctx);
 #ifdef FURI_RAM_EXEC
@@ -610,6 +625,7 @@ static const FS_Api fs_api = {
             .stat = storage_ext_common_stat,
             .mkdir = storage_ext_common_mkdir,
             .remove = storage_ext_common_remove,
+            .rename = storage_ext_common_rename,
             .fs_info = storage_ext_common_fs_info,
         },
 };
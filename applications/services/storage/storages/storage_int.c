@@ -1,4 +1,5 @@
 #include "storage_int.h"
+#include "storage_int_config.h"
 #include <lfs.h>
 #include <furi_hal.h>
 #include <toolbox/path.h>
@@ -23,6 +24,8 @@ typedef struct {
     bool open;
 } LFSHandle;
 
+static StorageIntStats storage_int_stats;
+
 static LFSHandle* lfs_handle_alloc_file() {
     LFSHandle* handle = malloc(sizeof(LFSHandle));
     handle->data = malloc(sizeof(lfs_file_t));
@@ -84,6 +87,8 @@ static int storage_int_device_read(
         size,
         (void*)address);
 
+    storage_int_stats.reads++;
+    storage_int_stats.bytes_read += size;
     memcpy(buffer, (void*)address, size);
 
     return 0;
@@ -107,6 +112,9 @@ static int storage_int_device_prog(
         size,
         (void*)address);
 
+    storage_int_stats.progs++;
+    storage_int_stats.bytes_programmed += size;
+
     int ret = 0;
     while(size > 0) {
         furi_hal_flash_write_dword(address, *(uint64_t*)buffer);
@@ -124,6 +132,7 @@ static int storage_int_device_erase(const struct lfs_config* c, lfs_block_t bloc
 
     FURI_LOG_D(TAG, "Device erase: page %ld, translated page: %x", block, page);
 
+    storage_int_stats.erases++;
     furi_hal_flash_erase(page);
     return 0;
 }
@@ -156,8 +165,9 @@ static LFSData* storage_int_lfs_data_alloc() {
     lfs_data->config.block_size = furi_hal_flash_get_page_size();
     lfs_data->config.block_count = furi_hal_flash_get_free_page_count();
     lfs_data->config.block_cycles = furi_hal_flash_get_cycles_count();
-    lfs_data->config.cache_size = 16;
-    lfs_data->config.lookahead_size = 16;
+    storage_int_config_tune(&lfs_data->config, memmgr_get_free_heap());
+    storage_int_stats.cache_size = lfs_data->config.cache_size;
+    storage_int_stats.lookahead_size = lfs_data->config.lookahead_size;
 
     return lfs_data;
 };
@@ -674,6 +684,13 @@ static FS_Error storage_int_common_remove(void* ctx, const char* path) {
     return storage_int_parse_error(result);
 }
 
+static FS_Error storage_int_common_rename(void* ctx, const char* old_path, const char* new_path) {
+    StorageData* storage = ctx;
+    lfs_t* lfs = lfs_get_from_storage(storage);
+    int result = lfs_rename(lfs, old_path, new_path);
+    return storage_int_parse_error(result);
+}
+
 static FS_Error storage_int_common_mkdir(void* ctx, const char* path) {
     StorageData* storage = ctx;
     lfs_t* lfs = lfs_get_from_storage(storage);
@@ -731,6 +748,7 @@ static const FS_Api fs_api = {
             .stat = storage_int_common_stat,
             .mkdir = storage_int_common_mkdir,
             .remove = storage_int_common_remove,
+            .rename = storage_int_common_rename,
             .fs_info = storage_int_common_fs_info,
         },
 };
@@ -740,13 +758,16 @@ void storage_int_init(StorageData* storage) {
     LFSData* lfs_data = storage_int_lfs_data_alloc();
     FURI_LOG_I(
         TAG,
-        "Config: start %p, read %ld, write %ld, page size: %ld, page count: %ld, cycles: %ld",
+        "Config: start %p, read %ld, write %ld, page size: %ld, page count: %ld, cycles: %ld, "
+        "cache: %ld, lookahead: %ld",
         (void*)lfs_data->start_address,
         lfs_data->config.read_size,
         lfs_data->config.prog_size,
         lfs_data->config.block_size,
         lfs_data->config.block_count,
-        lfs_data->config.block_cycles);
+        lfs_data->config.block_cycles,
+        lfs_data->config.cache_size,
+        lfs_data->config.lookahead_size);
 
     storage_int_lfs_mount(lfs_data, storage);
 
@@ -754,3 +775,7 @@ void storage_int_init(StorageData* storage) {
     storage->api.tick = NULL;
     storage->fs_api = &fs_api;
 }
+
+void storage_int_get_stats(StorageIntStats* stats) {
+    *stats = storage_int_stats;
+}
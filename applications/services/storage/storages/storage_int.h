@@ -1,6 +1,7 @@
 #pragma once
 #include <furi.h>
 #include "../storage_glue.h"
+#include "storage_int_config.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,6 +9,9 @@ extern "C" {
 
 void storage_int_init(StorageData* storage);
 
+/** Get internal storage configuration and block device counters since boot */
+void storage_int_get_stats(StorageIntStats* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,28 @@
+#include "storage_int_config.h"
+
+#define STORAGE_INT_HEAP_SHARE 32
+
+static uint32_t storage_int_config_round_up(uint32_t value, uint32_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+void storage_int_config_tune(struct lfs_config* config, size_t free_heap) {
+    size_t budget = free_heap / STORAGE_INT_HEAP_SHARE / (2 + STORAGE_INT_CACHE_FILES);
+
+    /* Power of two, so it divides block size and is a multiple of read and prog sizes */
+    uint32_t cache_size = STORAGE_INT_CACHE_SIZE_MIN;
+    while(cache_size * 2 <= budget && cache_size * 2 <= STORAGE_INT_CACHE_SIZE_MAX &&
+          config->block_size % (cache_size * 2) == 0) {
+        cache_size *= 2;
+    }
+    cache_size = storage_int_config_round_up(
+        cache_size, config->read_size > config->prog_size ? config->read_size : config->prog_size);
+    config->cache_size = cache_size;
+
+    /* One bit per block, lfs wants a multiple of 8 bytes */
+    uint32_t lookahead_size = storage_int_config_round_up(config->block_count, 64) / 8;
+    if(lookahead_size > cache_size) {
+        lookahead_size = cache_size;
+    }
+    config->lookahead_size = lookahead_size;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+ * Internal storage littlefs tuning.
+ *
+ * Kept free of furi dependencies so scripts/lfs_flash_sim can benchmark the
+ * same configuration on host.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <lfs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STORAGE_INT_CACHE_SIZE_MIN 16
+#define STORAGE_INT_CACHE_SIZE_MAX 512
+/* Open files budgeted for, each one holds a cache of its own */
+#define STORAGE_INT_CACHE_FILES 4
+
+typedef struct {
+    uint32_t cache_size;
+    uint32_t lookahead_size;
+    uint32_t reads;
+    uint32_t progs;
+    uint32_t erases;
+    uint32_t bytes_read;
+    uint32_t bytes_programmed;
+} StorageIntStats;
+
+/** Set cache and lookahead sizes
+ *
+ * About 1/32 of free heap is split between read, program and file caches.
+ * Lookahead covers every block, so allocator scans flash once per pass.
+ *
+ * @param      config     lfs config with block device geometry filled in
+ * @param      free_heap  free heap at boot
+ */
+void storage_int_config_tune(struct lfs_config* config, size_t free_heap);
+
+#ifdef __cplusplus
+}
+#endif
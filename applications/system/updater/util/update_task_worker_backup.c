@@ -20,47 +20,68 @@
         break;          \
     }
 
+static void update_task_lfs_backup_progress_cb(uint32_t processed, uint32_t total, void* context) {
+    UpdateTask* update_task = context;
+    update_task_set_progress(
+        update_task, UpdateTaskStageLfsBackup, total ? (processed * 100ULL) / total : 0);
+}
+
+static void
+    update_task_lfs_restore_progress_cb(uint32_t processed, uint32_t total, void* context) {
+    UpdateTask* update_task = context;
+    update_task_set_progress(
+        update_task, UpdateTaskStageLfsRestore, total ? (processed * 100ULL) / total : 0);
+}
+
+static void update_task_get_legacy_backup_path(UpdateTask* update_task, FuriString* path) {
+    path_concat(
+        furi_string_get_cstr(update_task->update_path), LFS_BACKUP_DEFAULT_FILENAME, path);
+}
+
 static bool update_task_pre_update(UpdateTask* update_task) {
     bool success = false;
-    FuriString* backup_file_path;
-    backup_file_path = furi_string_alloc();
-    path_concat(
-        furi_string_get_cstr(update_task->update_path),
-        LFS_BACKUP_DEFAULT_FILENAME,
-        backup_file_path);
+    FuriString* legacy_backup_path = furi_string_alloc();
+    update_task_get_legacy_backup_path(update_task, legacy_backup_path);
+    /* Backup left in package by older firmware would be mistaken for a fresh one */
+    storage_simply_remove(update_task->storage, furi_string_get_cstr(legacy_backup_path));
+    furi_string_free(legacy_backup_path);
 
     update_task_set_progress(update_task, UpdateTaskStageLfsBackup, 0);
     /* to avoid bootloops */
     furi_hal_rtc_set_boot_mode(FuriHalRtcBootModeNormal);
-    if((success =
-            lfs_backup_create(update_task->storage, furi_string_get_cstr(backup_file_path)))) {
+    /* Backup outlives update package, next update only archives changed files */
+    if((success = lfs_backup_create_incremental(
+            update_task->storage,
+            LFS_BACKUP_INCREMENTAL_LOCATION,
+            update_task_lfs_backup_progress_cb,
+            update_task))) {
         furi_hal_rtc_set_boot_mode(FuriHalRtcBootModeUpdate);
     }
 
-    furi_string_free(backup_file_path);
     return success;
 }
 
 typedef struct {
     UpdateTask* update_task;
-    int32_t total_files, processed_files;
+    TarArchive* archive;
 } TarUnpackProgress;
 
 static bool update_task_resource_unpack_cb(const char* name, bool is_directory, void* context) {
     UNUSED(name);
     UNUSED(is_directory);
     TarUnpackProgress* unpack_progress = context;
-    unpack_progress->processed_files++;
+    /* Entry count is unknown until whole archive is decoded, follow file position instead */
+    uint32_t processed, total;
+    tar_archive_get_read_progress(unpack_progress->archive, &processed, &total);
     update_task_set_progress(
         unpack_progress->update_task,
         UpdateTaskStageProgress,
         /* For this stage, last 70% of progress = extraction */
-        30 + (unpack_progress->processed_files * 70) / (unpack_progress->total_files + 1));
+        30 + (total ? (processed * 70ULL) / total : 0));
     return true;
 }
 
-static void
-    update_task_cleanup_resources(UpdateTask* update_task, uint32_t n_approx_file_entries) {
+static void update_task_cleanup_resources(UpdateTask* update_task) {
     ResourceManifestReader* manifest_reader = resource_manifest_reader_alloc(update_task->storage);
     do {
         FURI_LOG_I(TAG, "Cleaning up old manifest");
@@ -69,10 +90,6 @@ static void
             break;
         }
 
-        /* We got # of entries in TAR file. Approx 1/4th is dir entries, we skip them */
-        n_approx_file_entries = n_approx_file_entries * 3 / 4 + 1;
-        uint32_t n_processed_files = 0;
-
         ResourceManifestEntry* entry_ptr = NULL;
         while((entry_ptr = resource_manifest_reader_next(manifest_reader))) {
             if(entry_ptr->type == ResourceManifestEntryTypeFile) {
@@ -80,7 +97,7 @@ static void
                     update_task,
                     UpdateTaskStageProgress,
                     /* For this stage, first 30% of progress = cleanup */
-                    (n_processed_files++ * 30) / (n_approx_file_entries + 1));
+                    resource_manifest_reader_get_progress(manifest_reader) * 30 / 100);
 
                 FuriString* file_path = furi_string_alloc();
                 path_concat(
@@ -102,20 +119,24 @@ static bool update_task_post_update(UpdateTask* update_task) {
 
     TarArchive* archive = tar_archive_alloc(update_task->storage);
     do {
-        path_concat(
-            furi_string_get_cstr(update_task->update_path),
-            LFS_BACKUP_DEFAULT_FILENAME,
-            file_path);
-
         update_task_set_progress(update_task, UpdateTaskStageLfsRestore, 0);
 
-        CHECK_RESULT(lfs_backup_unpack(update_task->storage, furi_string_get_cstr(file_path)));
+        /* Update was started by firmware that backs up into the package */
+        update_task_get_legacy_backup_path(update_task, file_path);
+        if(!lfs_backup_exists(update_task->storage, furi_string_get_cstr(file_path))) {
+            furi_string_set(file_path, LFS_BACKUP_INCREMENTAL_LOCATION);
+        }
+
+        CHECK_RESULT(lfs_backup_unpack_incremental(
+            update_task->storage,
+            furi_string_get_cstr(file_path),
+            update_task_lfs_restore_progress_cb,
+            update_task));
 
         if(update_task->state.groups & UpdateTaskStageGroupResources) {
             TarUnpackProgress progress = {
                 .update_task = update_task,
-                .total_files = 0,
-                .processed_files = 0,
+                .archive = archive,
             };
             update_task_set_progress(update_task, UpdateTaskStageResourcesUpdate, 0);
 
@@ -125,15 +146,15 @@ static bool update_task_post_update(UpdateTask* update_task) {
                 file_path);
 
             tar_archive_set_file_callback(archive, update_task_resource_unpack_cb, &progress);
-            CHECK_RESULT(
-                tar_archive_open(archive, furi_string_get_cstr(file_path), TAR_OPEN_MODE_READ));
+            CHECK_RESULT(tar_archive_open(
+                archive,
+                furi_string_get_cstr(file_path),
+                tar_archive_get_mode_for_path(furi_string_get_cstr(file_path))));
 
-            progress.total_files = tar_archive_get_entries_count(archive);
-            if(progress.total_files > 0) {
-                update_task_cleanup_resources(update_task, progress.total_files);
+            /* Bundle is opened and its header checked before old resources go away */
+            update_task_cleanup_resources(update_task);
 
-                CHECK_RESULT(tar_archive_unpack_to(archive, STORAGE_EXT_PATH_PREFIX, NULL));
-            }
+            CHECK_RESULT(tar_archive_unpack_to(archive, STORAGE_EXT_PATH_PREFIX, NULL));
         }
 
         if(update_task->state.groups & UpdateTaskStageGroupSplashscreen) {
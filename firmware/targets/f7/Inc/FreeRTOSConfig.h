@@ -44,7 +44,8 @@ extern uint32_t SystemCoreClock;
 /* Defaults to size_t for backward compatibility, but can be changed
    if lengths will always be less than the number of bytes in a size_t. */
 #define configMESSAGE_BUFFER_LENGTH_TYPE size_t
-#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1
+/* 0 - FuriThread, 1 - heap allocation counter */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 2
 #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 4
 
 /* Co-routine definitions. */
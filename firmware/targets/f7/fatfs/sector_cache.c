@@ -6,54 +6,327 @@
 #include <furi.h>
 #include <furi_hal_memory.h>
 
+#define TAG "SectorCache"
+
 #define SECTOR_SIZE 512
-#define N_SECTORS 8
+#define N_SECTORS_MIN 8
+#define N_SECTORS_MAX 64
+/* Cache takes at most 1/N of the largest free pool block */
+#define POOL_SHARE_DIVIDER 2
+/* Metadata sectors can take up to 3/4 of the cache */
+#define METADATA_SHARE_NUM 3
+#define METADATA_SHARE_DEN 4
+
+#define ENTRY_NONE UINT16_MAX
+
+typedef enum {
+    SectorCacheListData,
+    SectorCacheListMetadata,
+    SectorCacheListCount,
+} SectorCacheList;
 
 typedef struct {
-    uint32_t itr;
-    uint32_t sectors[N_SECTORS];
-    uint8_t sector_data[N_SECTORS][SECTOR_SIZE];
+    uint32_t sector;
+    uint16_t hash_next;
+    uint16_t prev;
+    uint16_t next;
+    uint8_t flags;
+    bool valid;
+} SectorCacheEntry;
+
+typedef struct {
+    uint16_t head; /* Most recently used */
+    uint16_t tail; /* Least recently used */
+    uint16_t count;
+} SectorCacheLru;
+
+typedef struct {
+    uint16_t n_sectors;
+    uint16_t hash_mask;
+    uint16_t* buckets;
+    SectorCacheEntry* entries;
+    uint8_t* sector_data;
+    SectorCacheLru lru[SectorCacheListCount];
+    uint16_t free_head;
+    SectorCacheWriteCallback write_callback;
+    SectorCacheStats stats;
 } SectorCache;
 
 static SectorCache* cache = NULL;
 
+static inline uint8_t* sector_cache_data(uint16_t index) {
+    return &cache->sector_data[(size_t)index * SECTOR_SIZE];
+}
+
+static inline SectorCacheList sector_cache_list(const SectorCacheEntry* entry) {
+    return (entry->flags & SectorCacheFlagMetadata) ? SectorCacheListMetadata :
+                                                      SectorCacheListData;
+}
+
+static void sector_cache_lru_remove(uint16_t index) {
+    SectorCacheEntry* entry = &cache->entries[index];
+    SectorCacheLru* lru = &cache->lru[sector_cache_list(entry)];
+
+    if(entry->prev != ENTRY_NONE) {
+        cache->entries[entry->prev].next = entry->next;
+    } else {
+        lru->head = entry->next;
+    }
+
+    if(entry->next != ENTRY_NONE) {
+        cache->entries[entry->next].prev = entry->prev;
+    } else {
+        lru->tail = entry->prev;
+    }
+
+    lru->count--;
+}
+
+static void sector_cache_lru_push(uint16_t index) {
+    SectorCacheEntry* entry = &cache->entries[index];
+    SectorCacheLru* lru = &cache->lru[sector_cache_list(entry)];
+
+    entry->prev = ENTRY_NONE;
+    entry->next = lru->head;
+    if(lru->head != ENTRY_NONE) {
+        cache->entries[lru->head].prev = index;
+    } else {
+        lru->tail = index;
+    }
+    lru->head = index;
+    lru->count++;
+}
+
+static uint16_t sector_cache_find(uint32_t n_sector) {
+    uint16_t index = cache->buckets[n_sector & cache->hash_mask];
+    while(index != ENTRY_NONE && cache->entries[index].sector != n_sector) {
+        index = cache->entries[index].hash_next;
+    }
+    return index;
+}
+
+static void sector_cache_hash_remove(uint16_t index) {
+    uint16_t* link = &cache->buckets[cache->entries[index].sector & cache->hash_mask];
+    while(*link != index) {
+        link = &cache->entries[*link].hash_next;
+    }
+    *link = cache->entries[index].hash_next;
+}
+
+static void sector_cache_set_flags(SectorCacheEntry* entry, uint8_t flags) {
+    if(entry->flags & SectorCacheFlagMetadata) cache->stats.metadata--;
+    if(entry->flags & SectorCacheFlagDirty) cache->stats.dirty--;
+    entry->flags = flags;
+    if(entry->flags & SectorCacheFlagMetadata) cache->stats.metadata++;
+    if(entry->flags & SectorCacheFlagDirty) cache->stats.dirty++;
+}
+
+static void sector_cache_release(uint16_t index) {
+    SectorCacheEntry* entry = &cache->entries[index];
+
+    sector_cache_lru_remove(index);
+    sector_cache_hash_remove(index);
+    sector_cache_set_flags(entry, SectorCacheFlagNone);
+    entry->valid = false;
+    entry->hash_next = cache->free_head;
+    cache->free_head = index;
+    cache->stats.used--;
+}
+
+static bool sector_cache_write_back(uint16_t index) {
+    SectorCacheEntry* entry = &cache->entries[index];
+
+    if(!(entry->flags & SectorCacheFlagDirty)) return true;
+    if(!cache->write_callback) return false;
+    if(!cache->write_callback(entry->sector, sector_cache_data(index))) {
+        FURI_LOG_E(TAG, "Write back of %lu failed", entry->sector);
+        return false;
+    }
+
+    sector_cache_set_flags(entry, entry->flags & ~SectorCacheFlagDirty);
+    cache->stats.write_backs++;
+    return true;
+}
+
+static uint16_t sector_cache_evict() {
+    SectorCacheLru* data = &cache->lru[SectorCacheListData];
+    SectorCacheLru* metadata = &cache->lru[SectorCacheListMetadata];
+    uint16_t metadata_max = cache->n_sectors * METADATA_SHARE_NUM / METADATA_SHARE_DEN;
+
+    SectorCacheLru* victim_list = data;
+    if(data->count == 0 || metadata->count > metadata_max) {
+        victim_list = metadata;
+    }
+
+    uint16_t victim = victim_list->tail;
+    if(victim == ENTRY_NONE || !sector_cache_write_back(victim)) {
+        return ENTRY_NONE;
+    }
+
+    sector_cache_release(victim);
+    cache->stats.evictions++;
+
+    uint16_t index = cache->free_head;
+    cache->free_head = cache->entries[index].hash_next;
+    return index;
+}
+
 void sector_cache_init() {
     if(cache == NULL) {
-        cache = furi_hal_memory_alloc(sizeof(SectorCache));
+        size_t entry_size = SECTOR_SIZE + sizeof(SectorCacheEntry) + sizeof(uint16_t);
+        size_t n_sectors = furi_hal_memory_max_pool_block() / POOL_SHARE_DIVIDER / entry_size;
+        n_sectors = MIN(MAX(n_sectors, (size_t)N_SECTORS_MIN), (size_t)N_SECTORS_MAX);
+
+        uint16_t n_buckets = 1;
+        while(n_buckets < n_sectors) n_buckets <<= 1;
+
+        /* Pool is never freed: take it once and keep for the whole uptime */
+        uint8_t* memory = furi_hal_memory_alloc(
+            sizeof(SectorCache) + n_sectors * (SECTOR_SIZE + sizeof(SectorCacheEntry)) +
+            n_buckets * sizeof(uint16_t));
+        if(memory != NULL) {
+            cache = (SectorCache*)memory;
+            memory += sizeof(SectorCache);
+            cache->sector_data = memory;
+            memory += n_sectors * SECTOR_SIZE;
+            cache->entries = (SectorCacheEntry*)memory;
+            memory += n_sectors * sizeof(SectorCacheEntry);
+            cache->buckets = (uint16_t*)memory;
+            cache->n_sectors = n_sectors;
+            cache->hash_mask = n_buckets - 1;
+            cache->write_callback = NULL;
+        }
     }
 
     if(cache != NULL) {
-        FURI_LOG_I("SectorCache", "Initializing sector cache");
-        memset(cache, 0, sizeof(SectorCache));
+        FURI_LOG_I(TAG, "Initializing sector cache, %u sectors", cache->n_sectors);
+        memset(cache->buckets, 0xFF, (cache->hash_mask + 1) * sizeof(uint16_t));
+        for(uint16_t i = 0; i < cache->n_sectors; i++) {
+            cache->entries[i].valid = false;
+            cache->entries[i].flags = SectorCacheFlagNone;
+            cache->entries[i].hash_next = (i + 1 < cache->n_sectors) ? i + 1 : ENTRY_NONE;
+        }
+        cache->free_head = 0;
+        for(size_t i = 0; i < SectorCacheListCount; i++) {
+            cache->lru[i].head = ENTRY_NONE;
+            cache->lru[i].tail = ENTRY_NONE;
+            cache->lru[i].count = 0;
+        }
+        memset(&cache->stats, 0, sizeof(SectorCacheStats));
+        cache->stats.capacity = cache->n_sectors;
     } else {
-        FURI_LOG_E("SectorCache", "Cannot enable sector cache");
+        FURI_LOG_E(TAG, "Cannot enable sector cache");
     }
 }
 
 uint8_t* sector_cache_get(uint32_t n_sector) {
-    if(cache != NULL && n_sector != 0) {
-        for(int sector_i = 0; sector_i < N_SECTORS; ++sector_i) {
-            if(cache->sectors[sector_i] == n_sector) {
-                return cache->sector_data[sector_i];
-            }
+    if(cache == NULL) return NULL;
+
+    uint16_t index = sector_cache_find(n_sector);
+    if(index == ENTRY_NONE) {
+        cache->stats.misses++;
+        return NULL;
+    }
+
+    cache->stats.hits++;
+    sector_cache_lru_remove(index);
+    sector_cache_lru_push(index);
+    return sector_cache_data(index);
+}
+
+bool sector_cache_put(uint32_t n_sector, const uint8_t* data, uint8_t flags) {
+    if(cache == NULL) return false;
+    if((flags & SectorCacheFlagDirty) && !cache->write_callback) return false;
+
+    uint16_t index = sector_cache_find(n_sector);
+    if(index != ENTRY_NONE) {
+        sector_cache_lru_remove(index);
+        /* Sector that was ever seen as metadata stays metadata */
+        flags |= cache->entries[index].flags & SectorCacheFlagMetadata;
+    } else {
+        index = cache->free_head;
+        if(index != ENTRY_NONE) {
+            cache->free_head = cache->entries[index].hash_next;
+        } else {
+            index = sector_cache_evict();
+            if(index == ENTRY_NONE) return false;
         }
+
+        SectorCacheEntry* entry = &cache->entries[index];
+        entry->sector = n_sector;
+        entry->valid = true;
+        entry->hash_next = cache->buckets[n_sector & cache->hash_mask];
+        cache->buckets[n_sector & cache->hash_mask] = index;
+        cache->stats.used++;
     }
-    return NULL;
+
+    memcpy(sector_cache_data(index), data, SECTOR_SIZE);
+    sector_cache_set_flags(&cache->entries[index], flags);
+    sector_cache_lru_push(index);
+    return true;
 }
 
-void sector_cache_put(uint32_t n_sector, uint8_t* data) {
+void sector_cache_update_range(uint32_t start_sector, uint32_t count, const uint8_t* data) {
     if(cache == NULL) return;
-    cache->sectors[cache->itr % N_SECTORS] = n_sector;
-    memcpy(cache->sector_data[cache->itr % N_SECTORS], data, SECTOR_SIZE);
-    cache->itr++;
+
+    for(uint16_t i = 0; i < cache->n_sectors; ++i) {
+        SectorCacheEntry* entry = &cache->entries[i];
+        if(entry->valid && (entry->sector >= start_sector) &&
+           (entry->sector - start_sector < count)) {
+            memcpy(
+                sector_cache_data(i),
+                &data[(size_t)(entry->sector - start_sector) * SECTOR_SIZE],
+                SECTOR_SIZE);
+            sector_cache_set_flags(entry, entry->flags & ~SectorCacheFlagDirty);
+        }
+    }
 }
 
 void sector_cache_invalidate_range(uint32_t start_sector, uint32_t end_sector) {
     if(cache == NULL) return;
-    for(int sector_i = 0; sector_i < N_SECTORS; ++sector_i) {
-        if((cache->sectors[sector_i] >= start_sector) &&
-           (cache->sectors[sector_i] <= end_sector)) {
-            cache->sectors[sector_i] = 0;
+
+    for(uint16_t i = 0; i < cache->n_sectors; ++i) {
+        SectorCacheEntry* entry = &cache->entries[i];
+        if(entry->valid && (entry->sector >= start_sector) && (entry->sector <= end_sector)) {
+            sector_cache_release(i);
         }
     }
-}
\ No newline at end of file
+}
+
+bool sector_cache_is_dirty_range(uint32_t start_sector, uint32_t count) {
+    if(cache == NULL || cache->stats.dirty == 0) return false;
+
+    for(uint16_t i = 0; i < cache->n_sectors; ++i) {
+        SectorCacheEntry* entry = &cache->entries[i];
+        if((entry->flags & SectorCacheFlagDirty) && (entry->sector >= start_sector) &&
+           (entry->sector - start_sector < count)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void sector_cache_set_write_callback(SectorCacheWriteCallback callback) {
+    if(cache == NULL) return;
+    cache->write_callback = callback;
+}
+
+bool sector_cache_flush() {
+    if(cache == NULL) return true;
+
+    bool result = true;
+    for(uint16_t i = 0; i < cache->n_sectors && cache->stats.dirty; ++i) {
+        if(cache->entries[i].valid && !sector_cache_write_back(i)) {
+            result = false;
+        }
+    }
+    return result;
+}
+
+void sector_cache_get_stats(SectorCacheStats* stats) {
+    if(cache == NULL) {
+        memset(stats, 0, sizeof(SectorCacheStats));
+    } else {
+        *stats = cache->stats;
+    }
+}
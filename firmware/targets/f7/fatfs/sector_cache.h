@@ -1,17 +1,45 @@
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum {
+    SectorCacheFlagNone = 0,
+    SectorCacheFlagMetadata = (1 << 0), /**< FAT, directory or boot sector, retained longer */
+    SectorCacheFlagDirty = (1 << 1), /**< Sector is newer than card, must be flushed */
+} SectorCacheFlag;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t write_backs;
+    uint16_t capacity; /**< Cache size in sectors */
+    uint16_t used;
+    uint16_t metadata;
+    uint16_t dirty;
+} SectorCacheStats;
+
+/**
+ * @brief Sector write callback, used to flush dirty sectors
+ * @param n_sector Sector number
+ * @param data Pointer to sector data
+ * @return true on success
+ */
+typedef bool (*SectorCacheWriteCallback)(uint32_t n_sector, const uint8_t* data);
+
 /**
  * @brief Init sector cache system
+ * Cache memory is taken from the memory pool on first call, cache size depends on
+ * available pool memory. Subsequent calls drop all cached sectors, including dirty ones.
  */
 void sector_cache_init();
 
 /**
- * @brief Get sector data from cache
+ * @brief Get sector data from cache, marks sector as recently used
  * @param n_sector Sector number
  * @return Pointer to sector data or NULL if not found
  */
@@ -19,10 +47,22 @@ uint8_t* sector_cache_get(uint32_t n_sector);
 
 /**
  * @brief Put sector data to cache
+ * Least recently used regular sector is replaced first, metadata sectors are replaced
+ * only when they take more than their share of the cache.
  * @param n_sector Sector number
  * @param data Pointer to sector data
+ * @param flags SectorCacheFlag combination
+ * @return true if sector was cached. Dirty sector that was not cached must be written by caller.
+ */
+bool sector_cache_put(uint32_t n_sector, const uint8_t* data, uint8_t flags);
+
+/**
+ * @brief Update cached sectors with data written to card, sectors that are not cached are skipped
+ * @param start_sector Start sector number
+ * @param count Number of sectors
+ * @param data Pointer to sectors data
  */
-void sector_cache_put(uint32_t n_sector, uint8_t* data);
+void sector_cache_update_range(uint32_t start_sector, uint32_t count, const uint8_t* data);
 
 /**
  * @brief Invalidate sector cache for given range
@@ -31,6 +71,32 @@ void sector_cache_put(uint32_t n_sector, uint8_t* data);
  */
 void sector_cache_invalidate_range(uint32_t start_sector, uint32_t end_sector);
 
+/**
+ * @brief Check if there are dirty sectors in given range
+ * @param start_sector Start sector number
+ * @param count Number of sectors
+ * @return true if at least one sector in range is dirty
+ */
+bool sector_cache_is_dirty_range(uint32_t start_sector, uint32_t count);
+
+/**
+ * @brief Set callback used to write dirty sectors on eviction and flush
+ * @param callback Write callback, NULL disables write-back: dirty puts are refused
+ */
+void sector_cache_set_write_callback(SectorCacheWriteCallback callback);
+
+/**
+ * @brief Write all dirty sectors to card
+ * @return true if all sectors were written
+ */
+bool sector_cache_flush();
+
+/**
+ * @brief Get cache statistics
+ * @param stats Pointer to statistics to fill
+ */
+void sector_cache_get_stats(SectorCacheStats* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -135,6 +135,9 @@ typedef struct {
 
 #define SD_MAX_TRY 100 /* Number of try */
 
+/* Card may hold DO low up to 250 ms (SDSC) or 500 ms (SDHC/SDXC) after write */
+#define SD_BUSY_TIMEOUT_US (500 * 1000)
+
 #define SD_CSD_STRUCT_V1 0x2 /* CSD struct version V1 */
 #define SD_CSD_STRUCT_V2 0x1 /* CSD struct version V2 */
 
@@ -162,7 +165,7 @@ typedef enum {
 #define SD_TOKEN_START_DATA_SINGLE_BLOCK_WRITE \
     0xFE /* Data token start byte, Start Single Block Write */
 #define SD_TOKEN_START_DATA_MULTIPLE_BLOCK_WRITE \
-    0xFD /* Data token start byte, Start Multiple Block Write */
+    0xFC /* Data token start byte, Start Multiple Block Write */
 #define SD_TOKEN_STOP_DATA_MULTIPLE_BLOCK_WRITE \
     0xFD /* Data toke stop byte, Stop Multiple Block Write */
 
@@ -270,6 +273,9 @@ static uint8_t SD_GoIdleState(void);
 static SD_CmdAnswer_typedef SD_SendCmd(uint8_t Cmd, uint32_t Arg, uint8_t Crc, uint8_t Answer);
 static uint8_t SD_WaitData(uint8_t data);
 static uint8_t SD_ReadData(void);
+static uint8_t SD_WaitNotBusy(void);
+static uint8_t SD_StopTransmission(void);
+static uint8_t SD_StopWriteTransmission(void);
 /** @defgroup STM32_ADAFRUIT_SD_Private_Function_Prototypes
   * @{
   */
@@ -432,58 +438,78 @@ uint8_t
     uint8_t retr = BSP_SD_ERROR;
     SD_CmdAnswer_typedef response;
     uint16_t BlockSize = 512;
-    uint8_t* cached_data;
-
-    bool single_sector_read = (NumOfBlocks == 1);
-    if(single_sector_read && (cached_data = sector_cache_get(ReadAddr))) {
-        memcpy(pData, cached_data, BlockSize);
-        return BSP_SD_OK;
-    }
 
     /* Send CMD16 (SD_CMD_SET_BLOCKLEN) to set the size of the block and 
-     Check if the SD acknowledged the set block length command: R1 response (0x00: no errors) */
-    response = SD_SendCmd(SD_CMD_SET_BLOCKLEN, BlockSize, 0xFF, SD_ANSWER_R1_EXPECTED);
-    SD_IO_CSState(1);
-    SD_IO_WriteByte(SD_DUMMY_BYTE);
-    if(response.r1 != SD_R1_NO_ERROR) {
-        goto error;
+     Check if the SD acknowledged the set block length command: R1 response (0x00: no errors).
+     High capacity cards have fixed 512 bytes block length and ignore this command */
+    if(flag_SDHC != 1) {
+        response = SD_SendCmd(SD_CMD_SET_BLOCKLEN, BlockSize, 0xFF, SD_ANSWER_R1_EXPECTED);
+        SD_IO_CSState(1);
+        SD_IO_WriteByte(SD_DUMMY_BYTE);
+        if(response.r1 != SD_R1_NO_ERROR) {
+            goto error;
+        }
     }
 
     /* Initialize the address */
     addr = (ReadAddr * ((flag_SDHC == 1) ? 1 : BlockSize));
 
-    /* Data transfer */
-    while(NumOfBlocks--) {
-        /* Send CMD17 (SD_CMD_READ_SINGLE_BLOCK) to read one block */
-        /* Check if the SD acknowledged the read block command: R1 response (0x00: no errors) */
-        response = SD_SendCmd(SD_CMD_READ_SINGLE_BLOCK, addr, 0xFF, SD_ANSWER_R1_EXPECTED);
+    if(NumOfBlocks > 1) {
+        /* Send CMD18 (SD_CMD_READ_MULT_BLOCK) to read all blocks in one transaction */
+        response = SD_SendCmd(SD_CMD_READ_MULT_BLOCK, addr, 0xFF, SD_ANSWER_R1_EXPECTED);
         if(response.r1 != SD_R1_NO_ERROR) {
             goto error;
         }
 
-        /* Now look for the data token to signify the start of the data */
-        if(SD_WaitData(SD_TOKEN_START_DATA_SINGLE_BLOCK_READ) == BSP_SD_OK) {
-            /* Read the SD block data : read NumByteToRead data */
-            SD_IO_WriteReadData(NULL, (uint8_t*)pData + offset, BlockSize);
+        while(NumOfBlocks--) {
+            /* Every block starts with its own data token */
+            if(SD_WaitData(SD_TOKEN_START_DATA_MULTIPLE_BLOCK_READ) != BSP_SD_OK) {
+                SD_StopTransmission();
+                goto error;
+            }
 
-            /* Set next read address*/
+            SD_IO_WriteReadData(NULL, (uint8_t*)pData + offset, BlockSize);
             offset += BlockSize;
-            addr = ((flag_SDHC == 1) ? (addr + 1) : (addr + BlockSize));
 
             /* get CRC bytes (not really needed by us, but required by SD) */
             SD_IO_WriteByte(SD_DUMMY_BYTE);
             SD_IO_WriteByte(SD_DUMMY_BYTE);
-        } else {
+        }
+
+        /* Card streams blocks until CMD12 (SD_CMD_STOP_TRANSMISSION) */
+        if(SD_StopTransmission() != BSP_SD_OK) {
             goto error;
         }
+    } else {
+        /* Data transfer */
+        while(NumOfBlocks--) {
+            /* Send CMD17 (SD_CMD_READ_SINGLE_BLOCK) to read one block */
+            /* Check if the SD acknowledged the read block command: R1 response (0x00: no errors) */
+            response = SD_SendCmd(SD_CMD_READ_SINGLE_BLOCK, addr, 0xFF, SD_ANSWER_R1_EXPECTED);
+            if(response.r1 != SD_R1_NO_ERROR) {
+                goto error;
+            }
 
-        /* End the command data read cycle */
-        SD_IO_CSState(1);
-        SD_IO_WriteByte(SD_DUMMY_BYTE);
-    }
+            /* Now look for the data token to signify the start of the data */
+            if(SD_WaitData(SD_TOKEN_START_DATA_SINGLE_BLOCK_READ) == BSP_SD_OK) {
+                /* Read the SD block data : read NumByteToRead data */
+                SD_IO_WriteReadData(NULL, (uint8_t*)pData + offset, BlockSize);
 
-    if(single_sector_read) {
-        sector_cache_put(ReadAddr, (uint8_t*)pData);
+                /* Set next read address*/
+                offset += BlockSize;
+                addr = ((flag_SDHC == 1) ? (addr + 1) : (addr + BlockSize));
+
+                /* get CRC bytes (not really needed by us, but required by SD) */
+                SD_IO_WriteByte(SD_DUMMY_BYTE);
+                SD_IO_WriteByte(SD_DUMMY_BYTE);
+            } else {
+                goto error;
+            }
+
+            /* End the command data read cycle */
+            SD_IO_CSState(1);
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+        }
     }
 
     retr = BSP_SD_OK;
@@ -517,55 +543,96 @@ uint8_t BSP_SD_WriteBlocks(
     uint8_t retr = BSP_SD_ERROR;
     SD_CmdAnswer_typedef response;
     uint16_t BlockSize = 512;
-    sector_cache_invalidate_range(WriteAddr, WriteAddr + NumOfBlocks);
 
     /* Send CMD16 (SD_CMD_SET_BLOCKLEN) to set the size of the block and 
-     Check if the SD acknowledged the set block length command: R1 response (0x00: no errors) */
-    response = SD_SendCmd(SD_CMD_SET_BLOCKLEN, BlockSize, 0xFF, SD_ANSWER_R1_EXPECTED);
-    SD_IO_CSState(1);
-    SD_IO_WriteByte(SD_DUMMY_BYTE);
-    if(response.r1 != SD_R1_NO_ERROR) {
-        goto error;
+     Check if the SD acknowledged the set block length command: R1 response (0x00: no errors).
+     High capacity cards have fixed 512 bytes block length and ignore this command */
+    if(flag_SDHC != 1) {
+        response = SD_SendCmd(SD_CMD_SET_BLOCKLEN, BlockSize, 0xFF, SD_ANSWER_R1_EXPECTED);
+        SD_IO_CSState(1);
+        SD_IO_WriteByte(SD_DUMMY_BYTE);
+        if(response.r1 != SD_R1_NO_ERROR) {
+            goto error;
+        }
     }
 
     /* Initialize the address */
     addr = (WriteAddr * ((flag_SDHC == 1) ? 1 : BlockSize));
 
-    /* Data transfer */
-    while(NumOfBlocks--) {
-        /* Send CMD24 (SD_CMD_WRITE_SINGLE_BLOCK) to write blocks  and
-       Check if the SD acknowledged the write block command: R1 response (0x00: no errors) */
-        response = SD_SendCmd(SD_CMD_WRITE_SINGLE_BLOCK, addr, 0xFF, SD_ANSWER_R1_EXPECTED);
+    if(NumOfBlocks > 1) {
+        /* Send CMD25 (SD_CMD_WRITE_MULT_BLOCK) to write all blocks in one transaction */
+        response = SD_SendCmd(SD_CMD_WRITE_MULT_BLOCK, addr, 0xFF, SD_ANSWER_R1_EXPECTED);
         if(response.r1 != SD_R1_NO_ERROR) {
             goto error;
         }
 
-        /* Send dummy byte for NWR timing : one byte between CMDWRITE and TOKEN */
-        SD_IO_WriteByte(SD_DUMMY_BYTE);
-        SD_IO_WriteByte(SD_DUMMY_BYTE);
-
-        /* Send the data token to signify the start of the data */
-        SD_IO_WriteByte(SD_TOKEN_START_DATA_SINGLE_BLOCK_WRITE);
+        while(NumOfBlocks--) {
+            /* Send dummy byte for NWR timing : one byte between CMDWRITE and TOKEN */
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
 
-        /* Write the block data to SD */
-        SD_IO_WriteReadData((uint8_t*)pData + offset, NULL, BlockSize);
+            SD_IO_WriteByte(SD_TOKEN_START_DATA_MULTIPLE_BLOCK_WRITE);
+            SD_IO_WriteReadData((uint8_t*)pData + offset, NULL, BlockSize);
+            offset += BlockSize;
 
-        /* Set next write address */
-        offset += BlockSize;
-        addr = ((flag_SDHC == 1) ? (addr + 1) : (addr + BlockSize));
+            /* Put CRC bytes (not really needed by us, but required by SD) */
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
 
-        /* Put CRC bytes (not really needed by us, but required by SD) */
-        SD_IO_WriteByte(SD_DUMMY_BYTE);
-        SD_IO_WriteByte(SD_DUMMY_BYTE);
+            /* Read data response, busy state is waited inside */
+            if(SD_GetDataResponse() != SD_DATA_OK) {
+                /* Card ignores further blocks: let it finish programming, abort
+                   transaction and read status (CMD13) to clear the error bits */
+                SD_WaitNotBusy();
+                SD_StopWriteTransmission();
+                SD_IO_CSState(1);
+                SD_IO_WriteByte(SD_DUMMY_BYTE);
+                BSP_SD_GetCardState();
+                goto error;
+            }
+        }
 
-        /* Read data response */
-        if(SD_GetDataResponse() != SD_DATA_OK) {
-            /* Set response value to failure */
+        /* Terminate transaction with Stop Tran token */
+        if(SD_StopWriteTransmission() != BSP_SD_OK) {
             goto error;
         }
+    } else {
+        /* Data transfer */
+        while(NumOfBlocks--) {
+            /* Send CMD24 (SD_CMD_WRITE_SINGLE_BLOCK) to write blocks  and
+           Check if the SD acknowledged the write block command: R1 response (0x00: no errors) */
+            response = SD_SendCmd(SD_CMD_WRITE_SINGLE_BLOCK, addr, 0xFF, SD_ANSWER_R1_EXPECTED);
+            if(response.r1 != SD_R1_NO_ERROR) {
+                goto error;
+            }
 
-        SD_IO_CSState(1);
-        SD_IO_WriteByte(SD_DUMMY_BYTE);
+            /* Send dummy byte for NWR timing : one byte between CMDWRITE and TOKEN */
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+
+            /* Send the data token to signify the start of the data */
+            SD_IO_WriteByte(SD_TOKEN_START_DATA_SINGLE_BLOCK_WRITE);
+
+            /* Write the block data to SD */
+            SD_IO_WriteReadData((uint8_t*)pData + offset, NULL, BlockSize);
+
+            /* Set next write address */
+            offset += BlockSize;
+            addr = ((flag_SDHC == 1) ? (addr + 1) : (addr + BlockSize));
+
+            /* Put CRC bytes (not really needed by us, but required by SD) */
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+
+            /* Read data response */
+            if(SD_GetDataResponse() != SD_DATA_OK) {
+                /* Set response value to failure */
+                goto error;
+            }
+
+            SD_IO_CSState(1);
+            SD_IO_WriteByte(SD_DUMMY_BYTE);
+        }
     }
     retr = BSP_SD_OK;
 
@@ -1046,6 +1113,67 @@ uint8_t SD_GoIdleState(void) {
     return BSP_SD_OK;
 }
 
+/**
+  * @brief  Waits until the SD card releases the busy state (DO held low)
+  * @param  None
+  * @retval BSP_SD_OK or BSP_SD_TIMEOUT
+  */
+uint8_t SD_WaitNotBusy(void) {
+    FuriHalCortexTimer timer = furi_hal_cortex_timer_get(SD_BUSY_TIMEOUT_US);
+
+    while(SD_IO_WriteByte(SD_DUMMY_BYTE) != 0xFF) {
+        if(furi_hal_cortex_timer_is_expired(timer)) {
+            return BSP_SD_TIMEOUT;
+        }
+    }
+
+    return BSP_SD_OK;
+}
+
+/**
+  * @brief  Terminates multiple block read with CMD12 (SD_CMD_STOP_TRANSMISSION).
+  *         Card may keep clocking out data of the next block while command is sent,
+  *         so the stuff byte after the command is skipped and R1 is the first byte
+  *         with MSB cleared, anything before it is not a response. Response is R1b.
+  * @param  None
+  * @retval SD status
+  */
+uint8_t SD_StopTransmission(void) {
+    uint8_t frame[SD_CMD_LENGTH] = {(SD_CMD_STOP_TRANSMISSION | 0x40), 0, 0, 0, 0, 0xFF};
+    uint8_t retr = BSP_SD_ERROR;
+
+    uint8_t response;
+    uint8_t timeout = 0x08;
+
+    SD_IO_WriteReadData(frame, NULL, SD_CMD_LENGTH);
+    SD_IO_WriteByte(SD_DUMMY_BYTE);
+
+    do {
+        response = SD_IO_WriteByte(SD_DUMMY_BYTE);
+        timeout--;
+    } while((response & 0x80) && timeout);
+
+    if(response == SD_R1_NO_ERROR) {
+        retr = SD_WaitNotBusy();
+    }
+
+    return retr;
+}
+
+/**
+  * @brief  Terminates multiple block write with Stop Tran token and waits
+  *         until the card finishes programming.
+  * @param  None
+  * @retval SD status
+  */
+uint8_t SD_StopWriteTransmission(void) {
+    SD_IO_WriteByte(SD_TOKEN_STOP_DATA_MULTIPLE_BLOCK_WRITE);
+    /* Busy is signalled one byte after the token */
+    SD_IO_WriteByte(SD_DUMMY_BYTE);
+
+    return SD_WaitNotBusy();
+}
+
 /**
   * @brief  Waits a data until a value different from SD_DUMMY_BITE
   * @param  None
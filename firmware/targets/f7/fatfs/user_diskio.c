@@ -35,9 +35,14 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "user_diskio.h"
+#include "fatfs.h"
+#include "sector_cache.h"
+#include <string.h>
 #include <furi_hal.h>
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+/* Keep FAT sectors in sector cache until CTRL_SYNC (issued by f_sync, f_close, etc) */
+#define USER_FAT_WRITE_BACK 1
 
 /* Private variables ---------------------------------------------------------*/
 /* Disk status */
@@ -53,6 +58,27 @@ static DSTATUS User_CheckStatus(BYTE lun) {
     return Stat;
 }
 
+/* FatFs reads and writes FAT, directory and boot sectors only through its window */
+static bool User_IsMetadata(const BYTE* buff) {
+    return buff == USERFatFS.win;
+}
+
+static bool User_IsFatSector(const BYTE* buff, DWORD sector) {
+    return User_IsMetadata(buff) && (USERFatFS.fs_type != 0) && (sector >= USERFatFS.fatbase) &&
+           (sector - USERFatFS.fatbase < USERFatFS.fsize * USERFatFS.n_fats);
+}
+
+/* Sector cache write back, bus is already acquired by the caller */
+static bool User_WriteSector(uint32_t sector, const uint8_t* data) {
+    if(BSP_SD_WriteBlocks((uint32_t*)data, sector, 1, SD_DATATIMEOUT) != MSD_OK) {
+        return false;
+    }
+    /* wait until the Write operation is finished */
+    while(BSP_SD_GetCardState() != MSD_OK) {
+    }
+    return true;
+}
+
 /* USER CODE END DECL */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -92,6 +118,9 @@ DSTATUS USER_initialize(BYTE pdrv) {
     furi_hal_sd_spi_handle = &furi_hal_spi_bus_handle_sd_fast;
 
     DSTATUS status = User_CheckStatus(pdrv);
+#if USER_FAT_WRITE_BACK
+    sector_cache_set_write_callback(User_WriteSector);
+#endif
 
     furi_hal_sd_spi_handle = NULL;
     furi_hal_spi_release(&furi_hal_spi_bus_handle_sd_fast);
@@ -128,11 +157,30 @@ DRESULT USER_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count) {
     furi_hal_spi_acquire(&furi_hal_spi_bus_handle_sd_fast);
     furi_hal_sd_spi_handle = &furi_hal_spi_bus_handle_sd_fast;
 
-    if(BSP_SD_ReadBlocks((uint32_t*)buff, (uint32_t)(sector), count, SD_DATATIMEOUT) == MSD_OK) {
-        /* wait until the read operation is finished */
-        while(BSP_SD_GetCardState() != MSD_OK) {
-        }
+    uint8_t* cached_data;
+    if(count == 1 && (cached_data = sector_cache_get(sector))) {
+        memcpy(buff, cached_data, _MIN_SS);
         res = RES_OK;
+    } else {
+        /* Card must not return data that is older than cached one */
+        if(sector_cache_is_dirty_range(sector, count)) {
+            sector_cache_flush();
+        }
+
+        if(BSP_SD_ReadBlocks((uint32_t*)buff, (uint32_t)(sector), count, SD_DATATIMEOUT) ==
+           MSD_OK) {
+            /* wait until the read operation is finished */
+            while(BSP_SD_GetCardState() != MSD_OK) {
+            }
+            res = RES_OK;
+
+            if(count == 1) {
+                sector_cache_put(
+                    sector,
+                    buff,
+                    User_IsMetadata(buff) ? SectorCacheFlagMetadata : SectorCacheFlagNone);
+            }
+        }
     }
 
     furi_hal_sd_spi_handle = NULL;
@@ -160,11 +208,25 @@ DRESULT USER_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count) {
     furi_hal_spi_acquire(&furi_hal_spi_bus_handle_sd_fast);
     furi_hal_sd_spi_handle = &furi_hal_spi_bus_handle_sd_fast;
 
-    if(BSP_SD_WriteBlocks((uint32_t*)buff, (uint32_t)(sector), count, SD_DATATIMEOUT) == MSD_OK) {
+    if(USER_FAT_WRITE_BACK && count == 1 && User_IsFatSector(buff, sector) &&
+       sector_cache_put(sector, buff, SectorCacheFlagMetadata | SectorCacheFlagDirty)) {
+        res = RES_OK;
+    } else if(
+        BSP_SD_WriteBlocks((uint32_t*)buff, (uint32_t)(sector), count, SD_DATATIMEOUT) ==
+        MSD_OK) {
         /* wait until the Write operation is finished */
         while(BSP_SD_GetCardState() != MSD_OK) {
         }
         res = RES_OK;
+
+        /* Directory sectors are read back soon, keep them */
+        if(count == 1 && User_IsMetadata(buff)) {
+            sector_cache_put(sector, buff, SectorCacheFlagMetadata);
+        } else {
+            sector_cache_update_range(sector, count, buff);
+        }
+    } else {
+        sector_cache_invalidate_range(sector, sector + count - 1);
     }
 
     furi_hal_sd_spi_handle = NULL;
@@ -197,7 +259,7 @@ DRESULT USER_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
     switch(cmd) {
     /* Make sure that no pending write process */
     case CTRL_SYNC:
-        res = RES_OK;
+        res = sector_cache_flush() ? RES_OK : RES_ERROR;
         break;
 
     /* Get number of sectors on the disk (DWORD) */
@@ -126,6 +126,10 @@ DICT_DEF2(
 /* Thread allocation tracing storage */
 static MemmgrHeapThreadDict_t memmgr_heap_thread_dict = {0};
 static volatile uint32_t memmgr_heap_thread_trace_depth = 0;
+static volatile uint32_t memmgr_heap_alloc_count = 0;
+
+/* Per-thread allocation counter lives in task local storage */
+#define MEMMGR_HEAP_ALLOC_COUNT_TLS_INDEX 1
 
 /* Initialize tracing storage on start */
 void memmgr_heap_init() {
@@ -191,6 +195,17 @@ size_t memmgr_heap_get_thread_memory(FuriThreadId thread_id) {
 #undef traceMALLOC
 static inline void traceMALLOC(void* pointer, size_t size) {
     FuriThreadId thread_id = furi_thread_get_current_id();
+
+    if(pointer) {
+        memmgr_heap_alloc_count++;
+        if(thread_id) {
+            uintptr_t count = (uintptr_t)pvTaskGetThreadLocalStoragePointer(
+                (TaskHandle_t)thread_id, MEMMGR_HEAP_ALLOC_COUNT_TLS_INDEX);
+            vTaskSetThreadLocalStoragePointer(
+                (TaskHandle_t)thread_id, MEMMGR_HEAP_ALLOC_COUNT_TLS_INDEX, (void*)(count + 1));
+        }
+    }
+
     if(thread_id && memmgr_heap_thread_trace_depth == 0) {
         memmgr_heap_thread_trace_depth++;
         MemmgrHeapAllocDict_t* alloc_dict =
@@ -218,6 +233,16 @@ static inline void traceFREE(void* pointer, size_t size) {
     }
 }
 
+uint32_t memmgr_heap_get_alloc_count() {
+    return memmgr_heap_alloc_count;
+}
+
+uint32_t memmgr_heap_get_thread_alloc_count(FuriThreadId thread_id) {
+    furi_assert(thread_id);
+    return (uint32_t)(uintptr_t)pvTaskGetThreadLocalStoragePointer(
+        (TaskHandle_t)thread_id, MEMMGR_HEAP_ALLOC_COUNT_TLS_INDEX);
+}
+
 size_t memmgr_heap_get_max_free_block() {
     size_t max_free_size = 0;
     BlockLink_t* pxBlock;
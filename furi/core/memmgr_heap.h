@@ -34,6 +34,24 @@ void memmgr_heap_disable_thread_trace(FuriThreadId taks_handle);
  */
 size_t memmgr_heap_get_thread_memory(FuriThreadId taks_handle);
 
+/** Memmgr heap get number of successful allocations since boot
+ *
+ * Counts allocations of all threads, wraps around on overflow.
+ *
+ * @return     allocation count
+ */
+uint32_t memmgr_heap_get_alloc_count();
+
+/** Memmgr heap get number of successful allocations made by thread
+ *
+ * Counts since thread start, wraps around on overflow.
+ *
+ * @param      thread_id  - thread id
+ *
+ * @return     allocation count
+ */
+uint32_t memmgr_heap_get_thread_alloc_count(FuriThreadId thread_id);
+
 /** Memmgr heap get the max contiguous block size on the heap
  *
  * @return     size_t max contiguous block size
@@ -2,28 +2,82 @@
 #include "memmgr.h"
 #include "check.h"
 #include "mutex.h"
+#include "kernel.h"
 
-#include <m-list.h>
+#include <stdatomic.h>
 
 struct FuriPubSubSubscription {
     FuriPubSubCallback callback;
     void* callback_context;
 };
 
-LIST_DEF(FuriPubSubSubscriptionList, FuriPubSubSubscription, M_POD_OPLIST);
-
+/* Immutable subscription array, replaced as a whole on every change */
+typedef struct FuriPubSubSnapshot {
+    struct FuriPubSubSnapshot* retired_next;
+    size_t count;
+    FuriPubSubSubscription* items[];
+} FuriPubSubSnapshot;
+
+/*
+ * Publishers don't lock: they register in readers[epoch & 1], load current
+ * snapshot and walk it. Writers serialize on mutex, swap snapshot pointer and
+ * put previous one on retired list. Retired snapshots (and unsubscribed items)
+ * are freed once every publisher that could have loaded them is gone: writer
+ * flips epoch twice, waiting for each readers counter to drain in turn, so
+ * new publishers never hold the wait up.
+ */
 struct FuriPubSub {
-    FuriPubSubSubscriptionList_t items;
+    _Atomic(FuriPubSubSnapshot*) snapshot;
+    atomic_uint epoch;
+    atomic_uint readers[2];
     FuriMutex* mutex;
+    FuriPubSubSnapshot* retired;
 };
 
+static FuriPubSubSnapshot* furi_pubsub_snapshot_alloc(size_t count) {
+    FuriPubSubSnapshot* snapshot =
+        malloc(sizeof(FuriPubSubSnapshot) + count * sizeof(FuriPubSubSubscription*));
+    snapshot->retired_next = NULL;
+    snapshot->count = count;
+    return snapshot;
+}
+
+static void furi_pubsub_retire(FuriPubSub* pubsub, FuriPubSubSnapshot* snapshot) {
+    FuriPubSubSnapshot* previous = atomic_exchange(&pubsub->snapshot, snapshot);
+    previous->retired_next = pubsub->retired;
+    pubsub->retired = previous;
+}
+
+static void furi_pubsub_free_retired(FuriPubSub* pubsub) {
+    while(pubsub->retired) {
+        FuriPubSubSnapshot* snapshot = pubsub->retired;
+        pubsub->retired = snapshot->retired_next;
+        free(snapshot);
+    }
+}
+
+/* Wait until no publisher can see anything retired so far */
+static void furi_pubsub_synchronize(FuriPubSub* pubsub) {
+    for(uint8_t pass = 0; pass < 2; pass++) {
+        unsigned index = atomic_fetch_add(&pubsub->epoch, 1) & 1;
+        while(atomic_load(&pubsub->readers[index])) {
+            furi_delay_tick(1);
+        }
+    }
+    furi_pubsub_free_retired(pubsub);
+}
+
 FuriPubSub* furi_pubsub_alloc() {
     FuriPubSub* pubsub = malloc(sizeof(FuriPubSub));
 
     pubsub->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
     furi_assert(pubsub->mutex);
 
-    FuriPubSubSubscriptionList_init(pubsub->items);
+    atomic_init(&pubsub->snapshot, furi_pubsub_snapshot_alloc(0));
+    atomic_init(&pubsub->epoch, 0);
+    atomic_init(&pubsub->readers[0], 0);
+    atomic_init(&pubsub->readers[1], 0);
+    pubsub->retired = NULL;
 
     return pubsub;
 }
@@ -31,9 +85,13 @@ FuriPubSub* furi_pubsub_alloc() {
 void furi_pubsub_free(FuriPubSub* pubsub) {
     furi_assert(pubsub);
 
-    furi_check(FuriPubSubSubscriptionList_size(pubsub->items) == 0);
+    FuriPubSubSnapshot* snapshot = atomic_load(&pubsub->snapshot);
+    furi_check(snapshot->count == 0);
+    furi_check(atomic_load(&pubsub->readers[0]) == 0);
+    furi_check(atomic_load(&pubsub->readers[1]) == 0);
 
-    FuriPubSubSubscriptionList_clear(pubsub->items);
+    furi_pubsub_free_retired(pubsub);
+    free(snapshot);
 
     furi_mutex_free(pubsub->mutex);
 
@@ -42,14 +100,26 @@ void furi_pubsub_free(FuriPubSub* pubsub) {
 
 FuriPubSubSubscription*
     furi_pubsub_subscribe(FuriPubSub* pubsub, FuriPubSubCallback callback, void* callback_context) {
-    furi_check(furi_mutex_acquire(pubsub->mutex, FuriWaitForever) == FuriStatusOk);
-    // put uninitialized item to the list
-    FuriPubSubSubscription* item = FuriPubSubSubscriptionList_push_raw(pubsub->items);
+    furi_assert(pubsub);
+    furi_assert(callback);
 
-    // initialize item
+    FuriPubSubSubscription* item = malloc(sizeof(FuriPubSubSubscription));
     item->callback = callback;
     item->callback_context = callback_context;
 
+    furi_check(furi_mutex_acquire(pubsub->mutex, FuriWaitForever) == FuriStatusOk);
+
+    FuriPubSubSnapshot* current = atomic_load(&pubsub->snapshot);
+    FuriPubSubSnapshot* snapshot = furi_pubsub_snapshot_alloc(current->count + 1);
+    memcpy(snapshot->items, current->items, current->count * sizeof(FuriPubSubSubscription*));
+    snapshot->items[current->count] = item;
+    furi_pubsub_retire(pubsub, snapshot);
+
+    // Nothing to wait for here, only free what is already unreachable
+    if(!atomic_load(&pubsub->readers[0]) && !atomic_load(&pubsub->readers[1])) {
+        furi_pubsub_free_retired(pubsub);
+    }
+
     furi_check(furi_mutex_release(pubsub->mutex) == FuriStatusOk);
 
     return item;
@@ -60,36 +130,41 @@ void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* pubsub_
     furi_assert(pubsub_subscription);
 
     furi_check(furi_mutex_acquire(pubsub->mutex, FuriWaitForever) == FuriStatusOk);
-    bool result = false;
-
-    // iterate over items
-    FuriPubSubSubscriptionList_it_t it;
-    for(FuriPubSubSubscriptionList_it(it, pubsub->items); !FuriPubSubSubscriptionList_end_p(it);
-        FuriPubSubSubscriptionList_next(it)) {
-        const FuriPubSubSubscription* item = FuriPubSubSubscriptionList_cref(it);
-
-        // if the iterator is equal to our element
-        if(item == pubsub_subscription) {
-            FuriPubSubSubscriptionList_remove(pubsub->items, it);
-            result = true;
-            break;
-        }
+
+    FuriPubSubSnapshot* current = atomic_load(&pubsub->snapshot);
+    size_t index = 0;
+    while(index < current->count && current->items[index] != pubsub_subscription) {
+        index++;
     }
+    furi_check(index < current->count);
+
+    FuriPubSubSnapshot* snapshot = furi_pubsub_snapshot_alloc(current->count - 1);
+    memcpy(snapshot->items, current->items, index * sizeof(FuriPubSubSubscription*));
+    memcpy(
+        snapshot->items + index,
+        current->items + index + 1,
+        (current->count - index - 1) * sizeof(FuriPubSubSubscription*));
+    furi_pubsub_retire(pubsub, snapshot);
+
+    // Callback may be running right now, caller is free to release its context after return
+    furi_pubsub_synchronize(pubsub);
+    free(pubsub_subscription);
 
     furi_check(furi_mutex_release(pubsub->mutex) == FuriStatusOk);
-    furi_check(result);
 }
 
 void furi_pubsub_publish(FuriPubSub* pubsub, void* message) {
-    furi_check(furi_mutex_acquire(pubsub->mutex, FuriWaitForever) == FuriStatusOk);
+    furi_assert(pubsub);
+
+    unsigned index = atomic_load(&pubsub->epoch) & 1;
+    atomic_fetch_add(&pubsub->readers[index], 1);
 
-    // iterate over subscribers
-    FuriPubSubSubscriptionList_it_t it;
-    for(FuriPubSubSubscriptionList_it(it, pubsub->items); !FuriPubSubSubscriptionList_end_p(it);
-        FuriPubSubSubscriptionList_next(it)) {
-        const FuriPubSubSubscription* item = FuriPubSubSubscriptionList_cref(it);
+    // Registered before loading, so writer can't free this snapshot under us
+    FuriPubSubSnapshot* snapshot = atomic_load(&pubsub->snapshot);
+    for(size_t i = 0; i < snapshot->count; i++) {
+        const FuriPubSubSubscription* item = snapshot->items[i];
         item->callback(message, item->callback_context);
     }
 
-    furi_check(furi_mutex_release(pubsub->mutex) == FuriStatusOk);
+    atomic_fetch_sub(&pubsub->readers[index], 1);
 }
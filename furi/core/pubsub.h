@@ -48,6 +48,9 @@ FuriPubSubSubscription*
  * 
  * No use of `pubsub_subscription` allowed after call of this method
  * Threadsafe, Reentrable.
+ * Waits for publishers that may still be calling the callback, so callback
+ * context can be freed right after. Must not be called from a callback of
+ * the same FuriPubSub.
  *
  * @param      pubsub               pointer to FuriPubSub instance
  * @param      pubsub_subscription  pointer to FuriPubSubSubscription instance
@@ -56,7 +59,9 @@ void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* pubsub_
 
 /** Publish message to FuriPubSub
  *
- * Threadsafe, Reentrable.
+ * Threadsafe, Reentrable, Lock-free: doesn't wait for subscribe, unsubscribe
+ * or other publishers. Subscription changes made during publish take effect
+ * for next messages.
  * 
  * @param      pubsub   pointer to FuriPubSub instance
  * @param      message  message pointer to publish
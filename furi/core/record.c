@@ -3,144 +3,211 @@
 #include "memmgr.h"
 #include "mutex.h"
 #include "event_flag.h"
+#include "kernel.h"
 
-#include <m-dict.h>
-#include <toolbox/m_cstr_dup.h>
+#include <stdatomic.h>
 
 #define FURI_RECORD_FLAG_READY (0x1)
-
-typedef struct {
+#define FURI_RECORD_DESTROYING (0x80000000UL)
+
+/* Open addressing index of known names, must stay power of 2 above 2x records count */
+#define FURI_RECORD_INDEX_SIZE (32)
+
+/*
+ * Record data is never freed: name is interned on first use and destroy only
+ * empties it, so open/close never take global lock. Holders count carries
+ * DESTROYING bit while destroy is running, openers that see it wait it out.
+ */
+typedef struct FuriRecordData {
+    const char* name;
+    struct FuriRecordData* next;
     FuriEventFlag* flags;
-    void* data;
-    size_t holders_count;
+    _Atomic(void*) data;
+    atomic_uint_least32_t holders_count;
 } FuriRecordData;
 
-DICT_DEF2(FuriRecordDataDict, const char*, M_CSTR_DUP_OPLIST, FuriRecordData, M_POD_OPLIST)
-
 typedef struct {
     FuriMutex* mutex;
-    FuriRecordDataDict_t records;
+    FuriRecordData known[FuriRecordIdCount];
+    uint8_t known_index[FURI_RECORD_INDEX_SIZE];
+    _Atomic(FuriRecordData*) other;
 } FuriRecord;
 
-static FuriRecord* furi_record = NULL;
+_Static_assert(FuriRecordIdCount * 2 < FURI_RECORD_INDEX_SIZE, "Record index is too small");
 
-static FuriRecordData* furi_record_get(const char* name) {
-    return FuriRecordDataDict_get(furi_record->records, name);
-}
+static const char* const furi_record_known_names[FuriRecordIdCount] = {
+#define FURI_RECORD_ID_NAME(id, name) name,
+    FURI_RECORD_ID_LIST(FURI_RECORD_ID_NAME)
+#undef FURI_RECORD_ID_NAME
+};
+
+static FuriRecord* furi_record = NULL;
 
-static void furi_record_put(const char* name, FuriRecordData* record_data) {
-    FuriRecordDataDict_set_at(furi_record->records, name, *record_data);
+static uint32_t furi_record_hash(const char* name) {
+    uint32_t hash = 2166136261UL;
+    while(*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+    }
+    return hash;
 }
 
-static void furi_record_erase(const char* name, FuriRecordData* record_data) {
-    furi_event_flag_free(record_data->flags);
-    FuriRecordDataDict_erase(furi_record->records, name);
+static void furi_record_data_init(FuriRecordData* record_data, const char* name) {
+    record_data->name = name;
+    record_data->next = NULL;
+    record_data->flags = furi_event_flag_alloc();
+    atomic_init(&record_data->data, NULL);
+    atomic_init(&record_data->holders_count, 0);
 }
 
 void furi_record_init() {
     furi_record = malloc(sizeof(FuriRecord));
     furi_record->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
     furi_check(furi_record->mutex);
-    FuriRecordDataDict_init(furi_record->records);
+    atomic_init(&furi_record->other, NULL);
+
+    // Index stores id + 1, zero is empty slot
+    memset(furi_record->known_index, 0, sizeof(furi_record->known_index));
+    for(size_t id = 0; id < FuriRecordIdCount; id++) {
+        furi_record_data_init(&furi_record->known[id], furi_record_known_names[id]);
+        uint32_t index = furi_record_hash(furi_record_known_names[id]);
+        while(furi_record->known_index[index % FURI_RECORD_INDEX_SIZE]) index++;
+        furi_record->known_index[index % FURI_RECORD_INDEX_SIZE] = id + 1;
+    }
+}
+
+static FuriRecordData* furi_record_known_get(const char* name) {
+    uint32_t index = furi_record_hash(name);
+    uint8_t id;
+    while((id = furi_record->known_index[index % FURI_RECORD_INDEX_SIZE])) {
+        const char* known_name = furi_record_known_names[id - 1];
+        if(known_name == name || strcmp(known_name, name) == 0) {
+            return &furi_record->known[id - 1];
+        }
+        index++;
+    }
+    return NULL;
 }
 
-static FuriRecordData* furi_record_data_get_or_create(const char* name) {
+static FuriRecordData* furi_record_other_get(const char* name) {
+    // List only grows at head, so it can be walked without lock
+    FuriRecordData* record_data = atomic_load(&furi_record->other);
+    while(record_data && strcmp(record_data->name, name) != 0) {
+        record_data = record_data->next;
+    }
+    return record_data;
+}
+
+static FuriRecordData* furi_record_data_get(const char* name, bool create) {
     furi_assert(furi_record);
-    FuriRecordData* record_data = furi_record_get(name);
+    furi_assert(name);
+
+    FuriRecordData* record_data = furi_record_known_get(name);
+    if(record_data) return record_data;
+
+    record_data = furi_record_other_get(name);
+    if(record_data || !create) return record_data;
+
+    furi_check(furi_mutex_acquire(furi_record->mutex, FuriWaitForever) == FuriStatusOk);
+    record_data = furi_record_other_get(name);
     if(!record_data) {
-        FuriRecordData new_record;
-        new_record.flags = furi_event_flag_alloc();
-        new_record.data = NULL;
-        new_record.holders_count = 0;
-        furi_record_put(name, &new_record);
-        record_data = furi_record_get(name);
+        size_t name_size = strlen(name) + 1;
+        record_data = malloc(sizeof(FuriRecordData) + name_size);
+        char* name_copy = (char*)(record_data + 1);
+        memcpy(name_copy, name, name_size);
+        furi_record_data_init(record_data, name_copy);
+        record_data->next = atomic_load(&furi_record->other);
+        atomic_store(&furi_record->other, record_data);
     }
+    furi_check(furi_mutex_release(furi_record->mutex) == FuriStatusOk);
+
     return record_data;
 }
 
-static void furi_record_lock() {
-    furi_check(furi_mutex_acquire(furi_record->mutex, FuriWaitForever) == FuriStatusOk);
+static void* furi_record_data_open(FuriRecordData* record_data) {
+    uint32_t holders_count = atomic_fetch_add(&record_data->holders_count, 1);
+    while(holders_count & FURI_RECORD_DESTROYING) {
+        furi_delay_tick(1);
+        holders_count = atomic_load(&record_data->holders_count);
+    }
+
+    // Destroy can't start while we are holding it, so data can be used as is
+    void* data = atomic_load(&record_data->data);
+    if(!data) {
+        // Wait for record to become ready
+        furi_check(
+            furi_event_flag_wait(
+                record_data->flags,
+                FURI_RECORD_FLAG_READY,
+                FuriFlagWaitAny | FuriFlagNoClear,
+                FuriWaitForever) == FURI_RECORD_FLAG_READY);
+        data = atomic_load(&record_data->data);
+    }
+
+    return data;
 }
 
-static void furi_record_unlock() {
-    furi_check(furi_mutex_release(furi_record->mutex) == FuriStatusOk);
+static void furi_record_data_close(FuriRecordData* record_data) {
+    uint32_t holders_count = atomic_fetch_sub(&record_data->holders_count, 1);
+    furi_assert(holders_count & ~FURI_RECORD_DESTROYING);
+    UNUSED(holders_count);
 }
 
 bool furi_record_exists(const char* name) {
     furi_assert(furi_record);
     furi_assert(name);
 
-    bool ret = false;
-
-    furi_record_lock();
-    ret = (furi_record_get(name) != NULL);
-    furi_record_unlock();
-
-    return ret;
+    FuriRecordData* record_data = furi_record_data_get(name, false);
+    return record_data && atomic_load(&record_data->data);
 }
 
 void furi_record_create(const char* name, void* data) {
     furi_assert(furi_record);
-
-    furi_record_lock();
+    furi_assert(data);
 
     // Get record data and fill it
-    FuriRecordData* record_data = furi_record_data_get_or_create(name);
-    furi_assert(record_data->data == NULL);
-    record_data->data = data;
+    FuriRecordData* record_data = furi_record_data_get(name, true);
+    void* expected = NULL;
+    furi_check(atomic_compare_exchange_strong(&record_data->data, &expected, data));
     furi_event_flag_set(record_data->flags, FURI_RECORD_FLAG_READY);
-
-    furi_record_unlock();
 }
 
 bool furi_record_destroy(const char* name) {
     furi_assert(furi_record);
 
-    bool ret = false;
-
-    furi_record_lock();
-
-    FuriRecordData* record_data = furi_record_get(name);
+    FuriRecordData* record_data = furi_record_data_get(name, false);
     furi_assert(record_data);
-    if(record_data->holders_count == 0) {
-        furi_record_erase(name, record_data);
-        ret = true;
+
+    uint32_t holders_count = 0;
+    if(!atomic_compare_exchange_strong(
+           &record_data->holders_count, &holders_count, FURI_RECORD_DESTROYING)) {
+        return false;
     }
 
-    furi_record_unlock();
+    furi_event_flag_clear(record_data->flags, FURI_RECORD_FLAG_READY);
+    atomic_store(&record_data->data, NULL);
+    atomic_fetch_and(&record_data->holders_count, ~FURI_RECORD_DESTROYING);
 
-    return ret;
+    return true;
 }
 
 void* furi_record_open(const char* name) {
-    furi_assert(furi_record);
-
-    furi_record_lock();
-
-    FuriRecordData* record_data = furi_record_data_get_or_create(name);
-    record_data->holders_count++;
-
-    furi_record_unlock();
-
-    // Wait for record to become ready
-    furi_check(
-        furi_event_flag_wait(
-            record_data->flags,
-            FURI_RECORD_FLAG_READY,
-            FuriFlagWaitAny | FuriFlagNoClear,
-            FuriWaitForever) == FURI_RECORD_FLAG_READY);
-
-    return record_data->data;
+    return furi_record_data_open(furi_record_data_get(name, true));
 }
 
 void furi_record_close(const char* name) {
-    furi_assert(furi_record);
-
-    furi_record_lock();
-
-    FuriRecordData* record_data = furi_record_get(name);
+    FuriRecordData* record_data = furi_record_data_get(name, false);
     furi_assert(record_data);
-    record_data->holders_count--;
+    furi_record_data_close(record_data);
+}
+
+void* furi_record_open_id(FuriRecordId id) {
+    furi_assert(furi_record);
+    furi_assert(id < FuriRecordIdCount);
+    return furi_record_data_open(&furi_record->known[id]);
+}
 
-    furi_record_unlock();
+void furi_record_close_id(FuriRecordId id) {
+    furi_assert(furi_record);
+    furi_assert(id < FuriRecordIdCount);
+    furi_record_data_close(&furi_record->known[id]);
 }
@@ -12,6 +12,31 @@
 extern "C" {
 #endif
 
+/** Records of firmware services, must match their RECORD_* names
+ *
+ * These names are interned at compile time: record API resolves them with
+ * hash lookup instead of global lock, and *_id functions index them directly.
+ */
+#define FURI_RECORD_ID_LIST(X)        \
+    X(Bt, "bt")                       \
+    X(Cli, "cli")                     \
+    X(Dialogs, "dialogs")             \
+    X(Dolphin, "dolphin")             \
+    X(Gui, "gui")                     \
+    X(InputEvents, "input_events")    \
+    X(Loader, "loader")               \
+    X(Notification, "notification")   \
+    X(Power, "power")                 \
+    X(Rpc, "rpc")                     \
+    X(Storage, "storage")
+
+typedef enum {
+#define FURI_RECORD_ID_ENUM(id, name) FuriRecordId##id,
+    FURI_RECORD_ID_LIST(FURI_RECORD_ID_ENUM)
+#undef FURI_RECORD_ID_ENUM
+    FuriRecordIdCount,
+} FuriRecordId;
+
 /** Initialize record storage For internal use only.
  */
 void furi_record_init();
@@ -19,6 +44,8 @@ void furi_record_init();
 /** Check if record exists
  *
  * @param      name  record name
+ *
+ * @return     true if record is created and not destroyed
  * @note       Thread safe. Create and destroy must be executed from the same
  *             thread.
  */
@@ -62,6 +89,22 @@ FURI_RETURNS_NONNULL void* furi_record_open(const char* name);
  */
 void furi_record_close(const char* name);
 
+/** Open record by interned id
+ *
+ * @param      id    record id
+ *
+ * @return     pointer to the record
+ * @note       Same as furi_record_open with record name, without name lookup
+ */
+FURI_RETURNS_NONNULL void* furi_record_open_id(FuriRecordId id);
+
+/** Close record by interned id
+ *
+ * @param      id    record id
+ * @note       Same as furi_record_close with record name, without name lookup
+ */
+void furi_record_close_id(FuriRecordId id);
+
 #ifdef __cplusplus
 }
 #endif
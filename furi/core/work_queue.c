@@ -0,0 +1,410 @@
+#include "work_queue.h"
+#include "check.h"
+#include "memmgr.h"
+#include "mutex.h"
+#include "semaphore.h"
+#include "thread.h"
+#include "timer.h"
+#include "kernel.h"
+
+#include <stdatomic.h>
+
+#define FURI_WORK_QUEUE_SYSTEM_WORKERS (2)
+#define FURI_WORK_QUEUE_SYSTEM_STACK_SIZE (2048)
+
+typedef enum {
+    FuriWorkStateIdle,
+    FuriWorkStateDelayed,
+    FuriWorkStatePending,
+} FuriWorkState;
+
+struct FuriWork {
+    FuriWorkQueue* queue;
+    FuriWork* next;
+    FuriWorkCallback callback;
+    void* context;
+    FuriTimer* timer;
+    FuriMutex* timer_mutex;
+    uint32_t delay;
+    uint32_t timer_seq;
+    uint32_t timer_armed_seq;
+    FuriWork* expired_next;
+    atomic_bool expired;
+    FuriWorkPriority priority;
+    FuriWorkState state;
+    FuriThreadId running_on;
+};
+
+/*
+ * Everything is guarded by queue mutex. Pending list is kept sorted by
+ * priority, FIFO inside of one priority. Workers drain it before sleeping on
+ * semaphore, so semaphore only has to wake sleeping ones.
+ *
+ * Timer service task never waits for queue mutex: expired timer pushes its
+ * work to lock-free expired list, workers move it to pending. Timer commands
+ * wait for timer task, so they are never sent with queue mutex held.
+ */
+struct FuriWorkQueue {
+    FuriMutex* mutex;
+    FuriSemaphore* semaphore;
+    FuriWork* pending;
+    _Atomic(FuriWork*) expired;
+    FuriThread** workers;
+    size_t workers_count;
+    bool started;
+    bool stop;
+};
+
+static FuriWorkQueue* furi_work_queue_system = NULL;
+
+static void furi_work_queue_lock(FuriWorkQueue* queue) {
+    furi_check(furi_mutex_acquire(queue->mutex, FuriWaitForever) == FuriStatusOk);
+}
+
+static void furi_work_queue_unlock(FuriWorkQueue* queue) {
+    furi_check(furi_mutex_release(queue->mutex) == FuriStatusOk);
+}
+
+static FuriWork* furi_work_queue_take(FuriWorkQueue* queue) {
+    // Work that is still running on other worker stays in place
+    FuriWork** link = &queue->pending;
+    while(*link && (*link)->running_on) {
+        link = &(*link)->next;
+    }
+
+    FuriWork* work = *link;
+    if(work) {
+        *link = work->next;
+        work->next = NULL;
+        work->state = FuriWorkStateIdle;
+        work->running_on = furi_thread_get_current_id();
+    }
+    return work;
+}
+
+static void furi_work_enqueue(FuriWork* work);
+
+/* Move expired delayed work to pending, called with queue mutex held */
+static void furi_work_queue_drain_expired(FuriWorkQueue* queue) {
+    FuriWork* work = atomic_exchange(&queue->expired, NULL);
+    while(work) {
+        FuriWork* next = work->expired_next;
+        work->expired_next = NULL;
+        atomic_store(&work->expired, false);
+        // Cancelled or submitted directly while timer was firing
+        if(work->state == FuriWorkStateDelayed) {
+            furi_work_enqueue(work);
+        }
+        work = next;
+    }
+}
+
+static int32_t furi_work_queue_worker(void* context) {
+    FuriWorkQueue* queue = context;
+
+    while(true) {
+        furi_work_queue_lock(queue);
+        furi_work_queue_drain_expired(queue);
+        FuriWork* work = furi_work_queue_take(queue);
+        bool stop = queue->stop;
+        furi_work_queue_unlock(queue);
+
+        if(work) {
+            work->callback(work->context);
+
+            furi_work_queue_lock(queue);
+            work->running_on = NULL;
+            furi_work_queue_unlock(queue);
+        } else if(stop) {
+            break;
+        } else {
+            furi_semaphore_acquire(queue->semaphore, FuriWaitForever);
+        }
+    }
+
+    return 0;
+}
+
+static void furi_work_queue_start(FuriWorkQueue* queue) {
+    for(size_t i = 0; i < queue->workers_count; i++) {
+        furi_thread_start(queue->workers[i]);
+    }
+    queue->started = true;
+}
+
+static void furi_work_enqueue(FuriWork* work) {
+    FuriWorkQueue* queue = work->queue;
+
+    FuriWork** link = &queue->pending;
+    while(*link && (*link)->priority >= work->priority) {
+        link = &(*link)->next;
+    }
+    work->next = *link;
+    *link = work;
+    work->state = FuriWorkStatePending;
+
+    if(!queue->started) {
+        furi_work_queue_start(queue);
+    }
+}
+
+static void furi_work_dequeue(FuriWork* work) {
+    FuriWork** link = &work->queue->pending;
+    while(*link != work) {
+        link = &(*link)->next;
+    }
+    *link = work->next;
+    work->next = NULL;
+}
+
+static void furi_work_timer_callback(void* context) {
+    FuriWork* work = context;
+    FuriWorkQueue* queue = work->queue;
+
+    // Already in expired list, not drained yet
+    if(atomic_exchange(&work->expired, true)) {
+        return;
+    }
+
+    FuriWork* head = atomic_load(&queue->expired);
+    do {
+        work->expired_next = head;
+    } while(!atomic_compare_exchange_weak(&queue->expired, &head, work));
+
+    furi_semaphore_release(queue->semaphore);
+}
+
+/*
+ * Bring timer in line with work state. Called after state change that involves
+ * delayed state, with queue mutex released. Timer mutex orders calls, so the
+ * last one sees the latest state and timer is never left running for work
+ * that is no longer delayed.
+ */
+static void furi_work_timer_sync(FuriWork* work) {
+    furi_check(furi_mutex_acquire(work->timer_mutex, FuriWaitForever) == FuriStatusOk);
+
+    furi_work_queue_lock(work->queue);
+    bool delayed = (work->state == FuriWorkStateDelayed);
+    bool rearm = delayed && (work->timer_armed_seq != work->timer_seq);
+    work->timer_armed_seq = work->timer_seq;
+    uint32_t delay = work->delay;
+    furi_work_queue_unlock(work->queue);
+
+    if(!delayed) {
+        furi_timer_stop(work->timer);
+    } else if(rearm) {
+        furi_timer_start(work->timer, delay);
+    }
+
+    furi_check(furi_mutex_release(work->timer_mutex) == FuriStatusOk);
+}
+
+void furi_work_queue_init() {
+    furi_assert(!furi_work_queue_system);
+    furi_work_queue_system = furi_work_queue_alloc(
+        "WorkQueue", FURI_WORK_QUEUE_SYSTEM_WORKERS, FURI_WORK_QUEUE_SYSTEM_STACK_SIZE);
+    for(size_t i = 0; i < FURI_WORK_QUEUE_SYSTEM_WORKERS; i++) {
+        furi_thread_mark_as_service(furi_work_queue_system->workers[i]);
+    }
+}
+
+FuriWorkQueue* furi_work_queue_get_system() {
+    furi_assert(furi_work_queue_system);
+    return furi_work_queue_system;
+}
+
+FuriWorkQueue* furi_work_queue_alloc(const char* name, size_t workers_count, size_t stack_size) {
+    furi_assert(workers_count > 0);
+
+    FuriWorkQueue* queue = malloc(sizeof(FuriWorkQueue));
+    queue->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    queue->semaphore = furi_semaphore_alloc(workers_count, 0);
+    queue->pending = NULL;
+    atomic_init(&queue->expired, NULL);
+    queue->started = false;
+    queue->stop = false;
+
+    queue->workers_count = workers_count;
+    queue->workers = malloc(sizeof(FuriThread*) * workers_count);
+    for(size_t i = 0; i < workers_count; i++) {
+        queue->workers[i] =
+            furi_thread_alloc_ex(name, stack_size, furi_work_queue_worker, queue);
+    }
+
+    return queue;
+}
+
+void furi_work_queue_free(FuriWorkQueue* queue) {
+    furi_assert(queue);
+    furi_assert(queue != furi_work_queue_system);
+
+    furi_work_queue_lock(queue);
+    furi_check(!queue->pending && !atomic_load(&queue->expired));
+    queue->stop = true;
+    furi_work_queue_unlock(queue);
+
+    if(queue->started) {
+        for(size_t i = 0; i < queue->workers_count; i++) {
+            furi_semaphore_release(queue->semaphore);
+        }
+        for(size_t i = 0; i < queue->workers_count; i++) {
+            furi_thread_join(queue->workers[i]);
+        }
+    }
+
+    for(size_t i = 0; i < queue->workers_count; i++) {
+        furi_thread_free(queue->workers[i]);
+    }
+
+    free(queue->workers);
+    furi_semaphore_free(queue->semaphore);
+    furi_mutex_free(queue->mutex);
+    free(queue);
+}
+
+FuriWork* furi_work_alloc(FuriWorkQueue* queue, FuriWorkCallback callback, void* context) {
+    furi_assert(queue);
+    furi_assert(callback);
+
+    FuriWork* work = malloc(sizeof(FuriWork));
+    work->queue = queue;
+    work->next = NULL;
+    work->callback = callback;
+    work->context = context;
+    work->timer = NULL;
+    work->timer_mutex = NULL;
+    work->delay = 0;
+    work->timer_seq = 0;
+    work->timer_armed_seq = 0;
+    work->expired_next = NULL;
+    atomic_init(&work->expired, false);
+    work->priority = FuriWorkPriorityNormal;
+    work->state = FuriWorkStateIdle;
+    work->running_on = NULL;
+
+    return work;
+}
+
+void furi_work_free(FuriWork* work) {
+    furi_assert(work);
+
+    furi_work_cancel(work);
+    furi_assert(work->running_on != furi_thread_get_current_id());
+    if(work->timer) {
+        furi_timer_free(work->timer);
+        furi_mutex_free(work->timer_mutex);
+
+        // Timer may have fired before it was stopped, take work out of expired list
+        furi_work_queue_lock(work->queue);
+        furi_work_queue_drain_expired(work->queue);
+        furi_work_queue_unlock(work->queue);
+    }
+
+    free(work);
+}
+
+void furi_work_set_priority(FuriWork* work, FuriWorkPriority priority) {
+    furi_assert(work);
+    furi_assert(priority <= FuriWorkPriorityHigh);
+
+    furi_work_queue_lock(work->queue);
+    work->priority = priority;
+    furi_work_queue_unlock(work->queue);
+}
+
+bool furi_work_submit(FuriWork* work) {
+    furi_assert(work);
+
+    furi_work_queue_lock(work->queue);
+    bool submitted = (work->state != FuriWorkStatePending);
+    bool was_delayed = (work->state == FuriWorkStateDelayed);
+    if(submitted) {
+        furi_work_enqueue(work);
+    }
+    furi_work_queue_unlock(work->queue);
+
+    if(submitted) {
+        furi_semaphore_release(work->queue->semaphore);
+    }
+    if(was_delayed) {
+        furi_work_timer_sync(work);
+    }
+
+    return submitted;
+}
+
+bool furi_work_submit_delayed(FuriWork* work, uint32_t ticks) {
+    furi_assert(work);
+
+    if(!ticks) {
+        return furi_work_submit(work);
+    }
+
+    furi_work_queue_lock(work->queue);
+    bool submitted = (work->state == FuriWorkStateIdle);
+    if(submitted) {
+        if(!work->timer) {
+            work->timer = furi_timer_alloc(furi_work_timer_callback, FuriTimerTypeOnce, work);
+            work->timer_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+        }
+        // Expiry of previous timer that is not drained yet must not count for this one
+        furi_work_queue_drain_expired(work->queue);
+        work->state = FuriWorkStateDelayed;
+        work->delay = ticks;
+        work->timer_seq++;
+        if(!work->queue->started) {
+            furi_work_queue_start(work->queue);
+        }
+    }
+    furi_work_queue_unlock(work->queue);
+
+    if(submitted) {
+        furi_work_timer_sync(work);
+    }
+
+    return submitted;
+}
+
+bool furi_work_cancel(FuriWork* work) {
+    furi_assert(work);
+
+    FuriThreadId current = furi_thread_get_current_id();
+    bool cancelled = false;
+
+    bool was_delayed = false;
+
+    furi_work_queue_lock(work->queue);
+    do {
+        cancelled |= (work->state != FuriWorkStateIdle);
+        if(work->state == FuriWorkStateDelayed) {
+            was_delayed = true;
+        } else if(work->state == FuriWorkStatePending) {
+            furi_work_dequeue(work);
+        }
+        work->state = FuriWorkStateIdle;
+
+        // Callback may submit its work again before returning, cancel that too
+        while(work->running_on && work->running_on != current) {
+            furi_work_queue_unlock(work->queue);
+            furi_delay_tick(1);
+            furi_work_queue_lock(work->queue);
+        }
+    } while(work->state != FuriWorkStateIdle);
+    furi_work_queue_unlock(work->queue);
+
+    if(was_delayed) {
+        furi_work_timer_sync(work);
+    }
+
+    return cancelled;
+}
+
+bool furi_work_is_pending(FuriWork* work) {
+    furi_assert(work);
+
+    furi_work_queue_lock(work->queue);
+    bool pending = (work->state != FuriWorkStateIdle);
+    furi_work_queue_unlock(work->queue);
+
+    return pending;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file work_queue.h
+ * FuriWorkQueue: deferred work on shared worker threads
+ */
+#pragma once
+
+#include "base.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FuriWorkQueue FuriWorkQueue;
+
+typedef struct FuriWork FuriWork;
+
+typedef void (*FuriWorkCallback)(void* context);
+
+/** Order in which pending work is taken by workers */
+typedef enum {
+    FuriWorkPriorityLow,
+    FuriWorkPriorityNormal,
+    FuriWorkPriorityHigh,
+} FuriWorkPriority;
+
+/** Initialize system work queue. For internal use only.
+ */
+void furi_work_queue_init();
+
+/** Get system work queue
+ *
+ * Shared by services and applications for occasional background jobs: small
+ * pool of workers with 2K stack each, started on first submit.
+ *
+ * @return     pointer to FuriWorkQueue instance
+ */
+FuriWorkQueue* furi_work_queue_get_system();
+
+/** Allocate work queue
+ *
+ * @param      name           worker thread name
+ * @param      workers_count  number of worker threads, started on first submit
+ * @param      stack_size     worker thread stack size
+ *
+ * @return     pointer to FuriWorkQueue instance
+ */
+FuriWorkQueue* furi_work_queue_alloc(const char* name, size_t workers_count, size_t stack_size);
+
+/** Free work queue, stops workers
+ *
+ * @param      queue  pointer to FuriWorkQueue instance
+ * @warning    all work of this queue must be freed before
+ */
+void furi_work_queue_free(FuriWorkQueue* queue);
+
+/** Allocate work
+ *
+ * @param      queue     queue to run work on
+ * @param      callback  work callback
+ * @param      context   callback context
+ *
+ * @return     pointer to FuriWork instance
+ */
+FuriWork* furi_work_alloc(FuriWorkQueue* queue, FuriWorkCallback callback, void* context);
+
+/** Free work, cancels it and waits for callback to return
+ *
+ * @param      work  pointer to FuriWork instance
+ */
+void furi_work_free(FuriWork* work);
+
+/** Set work priority, applies to next submit
+ *
+ * @param      work      pointer to FuriWork instance
+ * @param      priority  priority, FuriWorkPriorityNormal by default
+ */
+void furi_work_set_priority(FuriWork* work, FuriWorkPriority priority);
+
+/** Submit work to be run as soon as worker is available
+ *
+ * Work never runs on two workers at once: submitted while running, it is run
+ * again after callback returns. Delayed work is moved to queue immediately.
+ *
+ * @param      work  pointer to FuriWork instance
+ *
+ * @return     false if work is already pending
+ * @note       Thread safe, can be called from work callbacks and timers
+ */
+bool furi_work_submit(FuriWork* work);
+
+/** Submit work to be run after delay
+ *
+ * @param      work   pointer to FuriWork instance
+ * @param      ticks  delay in ticks
+ *
+ * @return     false if work is already pending or delayed
+ */
+bool furi_work_submit_delayed(FuriWork* work, uint32_t ticks);
+
+/** Cancel pending or delayed work, wait for running callback to return
+ *
+ * @param      work  pointer to FuriWork instance
+ *
+ * @return     true if work was pending or delayed
+ * @note       Doesn't wait when called from the callback of the same work
+ */
+bool furi_work_cancel(FuriWork* work);
+
+/** Check if work is pending or delayed
+ *
+ * @param      work  pointer to FuriWork instance
+ *
+ * @return     true if work is pending or delayed
+ */
+bool furi_work_is_pending(FuriWork* work);
+
+#ifdef __cplusplus
+}
+#endif
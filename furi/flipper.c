@@ -29,6 +29,8 @@ static void flipper_print_version(const char* target, const Version* version) {
 void flipper_init() {
     flipper_print_version("Firmware", furi_hal_version_get_firmware_version());
 
+    furi_work_queue_init();
+
     FURI_LOG_I(TAG, "starting services");
 
     for(size_t i = 0; i < FLIPPER_SERVICES_COUNT; i++) {
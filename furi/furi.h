@@ -17,6 +17,7 @@
 #include "core/thread.h"
 #include "core/timer.h"
 #include "core/valuemutex.h"
+#include "core/work_queue.h"
 #include "core/string.h"
 #include "core/stream_buffer.h"
 
@@ -8,8 +8,8 @@
 #pragma GCC optimize("O3,unroll-loops,Ofast")
 
 #define F_TIM (64000000.0)
-#define T_TIM 1562 //15.625 ns *100
-#define T_TIM_DIV2 781 //15.625 ns / 2 *100
+#define T_TIM DIGITAL_SIGNAL_T_TIM
+#define T_TIM_DIV2 DIGITAL_SIGNAL_T_TIM_DIV2
 
 DigitalSignal* digital_signal_alloc(uint32_t max_edges_cnt) {
     DigitalSignal* signal = malloc(sizeof(DigitalSignal));
@@ -100,6 +100,13 @@ void digital_signal_prepare_arr(DigitalSignal* signal) {
 
 void digital_signal_send(DigitalSignal* signal, const GpioPin* gpio) {
     furi_assert(signal);
+
+    digital_signal_prepare_arr(signal);
+    digital_signal_send_prepared(signal, gpio);
+}
+
+void digital_signal_send_prepared(DigitalSignal* signal, const GpioPin* gpio) {
+    furi_assert(signal);
     furi_assert(gpio);
 
     // Configure gpio as output
@@ -132,7 +139,6 @@ void digital_signal_send(DigitalSignal* signal, const GpioPin* gpio) {
     LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_1);
 
     // Init timer arr register buffer and DMA channel
-    digital_signal_prepare_arr(signal);
     dma_config.MemoryOrM2MDstAddress = (uint32_t)signal->reload_reg_buff;
     dma_config.PeriphOrM2MSrcAddress = (uint32_t) & (TIM2->ARR);
     dma_config.Direction = LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
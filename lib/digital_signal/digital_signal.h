@@ -10,6 +10,10 @@
 extern "C" {
 #endif
 
+/* Timer tick period, 15.625 ns * 100. Edge timings are in the same 0.01 ns units */
+#define DIGITAL_SIGNAL_T_TIM 1562
+#define DIGITAL_SIGNAL_T_TIM_DIV2 781
+
 typedef struct {
     bool start_level;
     uint32_t edge_cnt;
@@ -34,6 +38,13 @@ uint32_t digital_signal_get_edge(DigitalSignal* signal, uint32_t edge_num);
 
 void digital_signal_send(DigitalSignal* signal, const GpioPin* gpio);
 
+/** Send signal which reload register buffer is already filled
+ *
+ * Same as digital_signal_send() without digital_signal_prepare_arr(), for
+ * encoders that fill reload_reg_buff along with edge_timings.
+ */
+void digital_signal_send_prepared(DigitalSignal* signal, const GpioPin* gpio);
+
 #ifdef __cplusplus
 }
 #endif
@@ -220,6 +220,16 @@ InfraredMessage* infrared_common_decoder_check_ready(InfraredCommonDecoder* deco
     return message;
 }
 
+/* Idle decoder can only be advanced by a mark matching its preamble,
+ * any other timing is dropped without changing the decoder state. */
+bool infrared_common_decoder_is_idle(InfraredCommonDecoder* decoder) {
+    furi_assert(decoder);
+
+    return (decoder->protocol->timings.preamble_mark != 0) &&
+           (decoder->state == InfraredCommonDecoderStateWaitPreamble) &&
+           (decoder->timings_cnt == 0) && (decoder->databit_cnt == 0);
+}
+
 InfraredMessage*
     infrared_common_decode(InfraredCommonDecoder* decoder, bool level, uint32_t duration) {
     furi_assert(decoder);
@@ -15,6 +15,8 @@ typedef struct {
     InfraredDecoderReset reset;
     InfraredFree free;
     InfraredDecoderCheckReady check_ready;
+    InfraredDecoderIsIdle is_idle;
+    const InfraredTimings* timings;
 } InfraredDecoders;
 
 typedef struct {
@@ -26,6 +28,8 @@ typedef struct {
 
 struct InfraredDecoderHandler {
     void** ctx;
+    uint32_t* edges;
+    uint32_t total_edges;
 };
 
 struct InfraredEncoderHandler {
@@ -46,6 +50,8 @@ static const InfraredEncoderDecoder infrared_encoder_decoder[] = {
              .decode = infrared_decoder_nec_decode,
              .reset = infrared_decoder_nec_reset,
              .check_ready = infrared_decoder_nec_check_ready,
+             .is_idle = infrared_decoder_nec_is_idle,
+             .timings = &protocol_nec.timings,
              .free = infrared_decoder_nec_free},
         .encoder =
             {.alloc = infrared_encoder_nec_alloc,
@@ -60,6 +66,8 @@ static const InfraredEncoderDecoder infrared_encoder_decoder[] = {
              .decode = infrared_decoder_samsung32_decode,
              .reset = infrared_decoder_samsung32_reset,
              .check_ready = infrared_decoder_samsung32_check_ready,
+             .is_idle = infrared_decoder_samsung32_is_idle,
+             .timings = &protocol_samsung32.timings,
              .free = infrared_decoder_samsung32_free},
         .encoder =
             {.alloc = infrared_encoder_samsung32_alloc,
@@ -74,6 +82,7 @@ static const InfraredEncoderDecoder infrared_encoder_decoder[] = {
              .decode = infrared_decoder_rc5_decode,
              .reset = infrared_decoder_rc5_reset,
              .check_ready = infrared_decoder_rc5_check_ready,
+             .timings = &protocol_rc5.timings,
              .free = infrared_decoder_rc5_free},
         .encoder =
             {.alloc = infrared_encoder_rc5_alloc,
@@ -88,6 +97,8 @@ static const InfraredEncoderDecoder infrared_encoder_decoder[] = {
              .decode = infrared_decoder_rc6_decode,
              .reset = infrared_decoder_rc6_reset,
              .check_ready = infrared_decoder_rc6_check_ready,
+             .is_idle = infrared_decoder_rc6_is_idle,
+             .timings = &protocol_rc6.timings,
              .free = infrared_decoder_rc6_free},
         .encoder =
             {.alloc = infrared_encoder_rc6_alloc,
@@ -102,6 +113,8 @@ static const InfraredEncoderDecoder infrared_encoder_decoder[] = {
              .decode = infrared_decoder_sirc_decode,
              .reset = infrared_decoder_sirc_reset,
              .check_ready = infrared_decoder_sirc_check_ready,
+             .is_idle = infrared_decoder_sirc_is_idle,
+             .timings = &protocol_sirc.timings,
              .free = infrared_decoder_sirc_free},
         .encoder =
             {.alloc = infrared_encoder_sirc_alloc,
@@ -116,6 +129,8 @@ static const InfraredEncoderDecoder infrared_encoder_decoder[] = {
              .decode = infrared_decoder_kaseikyo_decode,
              .reset = infrared_decoder_kaseikyo_reset,
              .check_ready = infrared_decoder_kaseikyo_check_ready,
+             .is_idle = infrared_decoder_kaseikyo_is_idle,
+             .timings = &protocol_kaseikyo.timings,
              .free = infrared_decoder_kaseikyo_free},
         .encoder =
             {.alloc = infrared_encoder_kaseikyo_alloc,
@@ -130,19 +145,46 @@ static int infrared_find_index_by_protocol(InfraredProtocol protocol);
 static const InfraredProtocolSpecification*
     infrared_get_spec_by_protocol(InfraredProtocol protocol);
 
+/* Bitmask of decoders, which preamble mark matches given timing */
+static uint32_t infrared_get_preamble_matches(bool level, uint32_t duration) {
+    uint32_t matches = 0;
+
+    if(level) {
+        for(size_t i = 0; i < COUNT_OF(infrared_encoder_decoder); ++i) {
+            const InfraredTimings* timings = infrared_encoder_decoder[i].decoder.timings;
+            if(MATCH_TIMING(duration, timings->preamble_mark, timings->preamble_tolerance)) {
+                matches |= (1UL << i);
+            }
+        }
+    }
+
+    return matches;
+}
+
 const InfraredMessage*
     infrared_decode(InfraredDecoderHandler* handler, bool level, uint32_t duration) {
     furi_assert(handler);
 
     InfraredMessage* message = NULL;
     InfraredMessage* result = NULL;
+    uint32_t preamble_matches = infrared_get_preamble_matches(level, duration);
+
+    ++handler->total_edges;
 
     for(size_t i = 0; i < COUNT_OF(infrared_encoder_decoder); ++i) {
-        if(infrared_encoder_decoder[i].decoder.decode) {
-            message = infrared_encoder_decoder[i].decoder.decode(handler->ctx[i], level, duration);
-            if(!result && message) {
-                result = message;
-            }
+        const InfraredDecoders* decoder = &infrared_encoder_decoder[i].decoder;
+        if(!decoder->decode) continue;
+
+        /* Idle decoder drops everything except of its preamble mark, no need to call it */
+        if(!(preamble_matches & (1UL << i)) && decoder->is_idle &&
+           decoder->is_idle(handler->ctx[i])) {
+            continue;
+        }
+
+        ++handler->edges[i];
+        message = decoder->decode(handler->ctx[i], level, duration);
+        if(!result && message) {
+            result = message;
         }
     }
 
@@ -152,9 +194,12 @@ const InfraredMessage*
 InfraredDecoderHandler* infrared_alloc_decoder(void) {
     InfraredDecoderHandler* handler = malloc(sizeof(InfraredDecoderHandler));
     handler->ctx = malloc(sizeof(void*) * COUNT_OF(infrared_encoder_decoder));
+    handler->edges = malloc(sizeof(uint32_t) * COUNT_OF(infrared_encoder_decoder));
+    handler->total_edges = 0;
 
     for(size_t i = 0; i < COUNT_OF(infrared_encoder_decoder); ++i) {
         handler->ctx[i] = 0;
+        handler->edges[i] = 0;
         if(infrared_encoder_decoder[i].decoder.alloc)
             handler->ctx[i] = infrared_encoder_decoder[i].decoder.alloc();
     }
@@ -172,6 +217,7 @@ void infrared_free_decoder(InfraredDecoderHandler* handler) {
             infrared_encoder_decoder[i].decoder.free(handler->ctx[i]);
     }
 
+    free(handler->edges);
     free(handler->ctx);
     free(handler);
 }
@@ -190,17 +236,34 @@ const InfraredMessage* infrared_check_decoder_ready(InfraredDecoderHandler* hand
     InfraredMessage* result = NULL;
 
     for(size_t i = 0; i < COUNT_OF(infrared_encoder_decoder); ++i) {
-        if(infrared_encoder_decoder[i].decoder.check_ready) {
-            message = infrared_encoder_decoder[i].decoder.check_ready(handler->ctx[i]);
-            if(!result && message) {
-                result = message;
-            }
+        const InfraredDecoders* decoder = &infrared_encoder_decoder[i].decoder;
+        if(!decoder->check_ready) continue;
+        if(decoder->is_idle && decoder->is_idle(handler->ctx[i])) continue;
+
+        message = decoder->check_ready(handler->ctx[i]);
+        if(!result && message) {
+            result = message;
         }
     }
 
     return result;
 }
 
+uint32_t infrared_get_decoder_edge_count(
+    const InfraredDecoderHandler* handler,
+    InfraredProtocol protocol) {
+    furi_assert(handler);
+    int index = infrared_find_index_by_protocol(protocol);
+    furi_check(index >= 0);
+
+    return handler->edges[index];
+}
+
+uint32_t infrared_get_decoder_total_edge_count(const InfraredDecoderHandler* handler) {
+    furi_assert(handler);
+    return handler->total_edges;
+}
+
 InfraredEncoderHandler* infrared_alloc_encoder(void) {
     InfraredEncoderHandler* handler = malloc(sizeof(InfraredEncoderHandler));
     handler->handler = NULL;
@@ -102,6 +102,28 @@ void infrared_free_decoder(InfraredDecoderHandler* handler);
  */
 void infrared_reset_decoder(InfraredDecoderHandler* handler);
 
+/**
+ * Get amount of timings processed by the decoder of given protocol.
+ * Decoders which wait for a preamble are not called for timings that
+ * can't start their message, so this value shows how much work the
+ * decoder actually did. Protocol variants share one decoder and counter.
+ *
+ * \param[in]   handler     - handler to INFRARED decoders. Should be acquired with \c infrared_alloc_decoder().
+ * \param[in]   protocol    - protocol identifier.
+ * \return      amount of timings passed to the protocol decoder since allocation.
+ */
+uint32_t infrared_get_decoder_edge_count(
+    const InfraredDecoderHandler* handler,
+    InfraredProtocol protocol);
+
+/**
+ * Get amount of timings provided to infrared_decode().
+ *
+ * \param[in]   handler     - handler to INFRARED decoders. Should be acquired with \c infrared_alloc_decoder().
+ * \return      amount of timings provided since allocation.
+ */
+uint32_t infrared_get_decoder_total_edge_count(const InfraredDecoderHandler* handler);
+
 /**
  * Get protocol name by protocol enum.
  *
@@ -0,0 +1,188 @@
+#include "infrared_raw.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <core/check.h>
+#include <core/common_defines.h>
+
+#define INFRARED_RAW_FNV_OFFSET 2166136261UL
+#define INFRARED_RAW_FNV_PRIME 16777619UL
+
+typedef struct {
+    uint32_t min;
+    uint64_t sum;
+    uint32_t count;
+} InfraredRawSymbol;
+
+typedef struct {
+    InfraredRawSymbol symbols[INFRARED_RAW_SYMBOLS_MAX];
+    size_t symbols_count;
+} InfraredRawAlphabet;
+
+static inline uint32_t infrared_raw_tolerance(uint32_t duration) {
+    return MAX(duration * INFRARED_RAW_TOLERANCE_PERCENT / 100, INFRARED_RAW_TOLERANCE_MIN_US);
+}
+
+static int infrared_raw_compare_timings(const void* a, const void* b) {
+    uint32_t timing_a = *(const uint32_t*)a;
+    uint32_t timing_b = *(const uint32_t*)b;
+    return (timing_a > timing_b) - (timing_a < timing_b);
+}
+
+/* Symbols are sorted by duration, so symbol index is the rank of duration */
+static uint8_t infrared_raw_get_symbol(const InfraredRawAlphabet* alphabet, uint32_t timing) {
+    uint8_t index = 0;
+    while((index + 1U < alphabet->symbols_count) &&
+          (alphabet->symbols[index + 1].min <= timing)) {
+        ++index;
+    }
+    return index;
+}
+
+static bool infrared_raw_quantize(
+    InfraredRawAlphabet* alphabet,
+    const uint32_t* timings,
+    size_t timings_size,
+    uint8_t* symbols) {
+    uint32_t* sorted = malloc(timings_size * sizeof(uint32_t));
+    memcpy(sorted, timings, timings_size * sizeof(uint32_t));
+    qsort(sorted, timings_size, sizeof(uint32_t), infrared_raw_compare_timings);
+
+    bool success = true;
+    InfraredRawSymbol* symbol = NULL;
+    alphabet->symbols_count = 0;
+
+    for(size_t i = 0; i < timings_size; ++i) {
+        if(!symbol || (sorted[i] > symbol->min + infrared_raw_tolerance(symbol->min))) {
+            if(alphabet->symbols_count == INFRARED_RAW_SYMBOLS_MAX) {
+                success = false;
+                break;
+            }
+            symbol = &alphabet->symbols[alphabet->symbols_count++];
+            symbol->min = sorted[i];
+            symbol->sum = 0;
+            symbol->count = 0;
+        }
+        symbol->sum += sorted[i];
+        symbol->count++;
+    }
+
+    free(sorted);
+
+    if(success) {
+        for(size_t i = 0; i < timings_size; ++i) {
+            symbols[i] = infrared_raw_get_symbol(alphabet, timings[i]);
+        }
+    }
+
+    return success;
+}
+
+static inline bool infrared_raw_is_frame_gap(const uint32_t* timings, size_t index) {
+    return (index % 2) && (timings[index] >= INFRARED_RAW_FRAME_GAP_US);
+}
+
+/* Drops frames that repeat the previously kept one, returns new size */
+static size_t infrared_raw_collapse_repeats(uint32_t* timings, uint8_t* symbols, size_t size) {
+    size_t out = 0;
+    size_t last_start = 0;
+    size_t last_length = 0;
+    bool has_last = false;
+
+    for(size_t start = 0; start < size;) {
+        size_t end = start;
+        while((end < size) && !infrared_raw_is_frame_gap(timings, end)) {
+            ++end;
+        }
+
+        size_t length = end - start;
+        bool is_repeat = has_last && (length == last_length) &&
+                         !memcmp(&symbols[last_start], &symbols[start], length);
+
+        if(!is_repeat) {
+            size_t copy_length = MIN(length + 1, size - start);
+            memmove(&timings[out], &timings[start], copy_length * sizeof(uint32_t));
+            memmove(&symbols[out], &symbols[start], copy_length);
+            last_start = out;
+            last_length = length;
+            has_last = true;
+            out += copy_length;
+        }
+
+        start = end + 1;
+    }
+
+    if(out && infrared_raw_is_frame_gap(timings, out - 1)) {
+        --out;
+    }
+
+    return out;
+}
+
+size_t infrared_raw_normalize(uint32_t* timings, size_t timings_size) {
+    furi_assert(timings);
+
+    if(!timings_size) return 0;
+
+    InfraredRawAlphabet alphabet;
+    uint8_t* symbols = malloc(timings_size);
+    size_t new_size = timings_size;
+
+    if(infrared_raw_quantize(&alphabet, timings, timings_size, symbols)) {
+        uint32_t durations[INFRARED_RAW_SYMBOLS_MAX];
+        for(size_t i = 0; i < alphabet.symbols_count; ++i) {
+            const InfraredRawSymbol* symbol = &alphabet.symbols[i];
+            durations[i] = (symbol->sum + symbol->count / 2) / symbol->count;
+        }
+
+        for(size_t i = 0; i < timings_size; ++i) {
+            timings[i] = durations[symbols[i]];
+        }
+
+        new_size = infrared_raw_collapse_repeats(timings, symbols, timings_size);
+    }
+
+    free(symbols);
+    return new_size;
+}
+
+uint32_t infrared_raw_get_fingerprint(const uint32_t* timings, size_t timings_size) {
+    furi_assert(timings);
+
+    uint32_t hash = INFRARED_RAW_FNV_OFFSET;
+    hash = (hash ^ timings_size) * INFRARED_RAW_FNV_PRIME;
+
+    if(!timings_size) return hash;
+
+    InfraredRawAlphabet alphabet;
+    uint8_t* symbols = malloc(timings_size);
+
+    /* Signals with too many symbols fall back to size only */
+    if(infrared_raw_quantize(&alphabet, timings, timings_size, symbols)) {
+        hash = (hash ^ alphabet.symbols_count) * INFRARED_RAW_FNV_PRIME;
+        for(size_t i = 0; i < timings_size; ++i) {
+            hash = (hash ^ symbols[i]) * INFRARED_RAW_FNV_PRIME;
+        }
+    }
+
+    free(symbols);
+    return hash;
+}
+
+bool infrared_raw_is_similar(
+    const uint32_t* timings_a,
+    size_t size_a,
+    const uint32_t* timings_b,
+    size_t size_b) {
+    if(size_a != size_b) return false;
+
+    for(size_t i = 0; i < size_a; ++i) {
+        uint32_t shorter = MIN(timings_a[i], timings_b[i]);
+        uint32_t longer = MAX(timings_a[i], timings_b[i]);
+        if(longer - shorter > infrared_raw_tolerance(shorter)) {
+            return false;
+        }
+    }
+
+    return true;
+}
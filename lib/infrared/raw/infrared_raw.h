@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of distinct durations a normalized signal can consist of */
+#define INFRARED_RAW_SYMBOLS_MAX 16
+/** Relative tolerance, durations closer than this are treated as one symbol */
+#define INFRARED_RAW_TOLERANCE_PERCENT 25
+/** Absolute tolerance floor for short durations, us */
+#define INFRARED_RAW_TOLERANCE_MIN_US 100
+/** Minimal space between two frames of a repeated signal, us */
+#define INFRARED_RAW_FRAME_GAP_US 10000
+
+/**
+ * Normalize raw timings in place.
+ *
+ * Timings within tolerance of each other are quantized to a common duration
+ * (at most INFRARED_RAW_SYMBOLS_MAX of them), consecutive identical frames
+ * are collapsed into one and a trailing frame gap is dropped. Signals which
+ * don't fit into the symbol alphabet are left untouched.
+ *
+ * \param[in,out]   timings - array of timings, starting from mark.
+ * \param[in]       timings_size - timings array size.
+ * \return          new timings array size, never bigger than timings_size.
+ */
+size_t infrared_raw_normalize(uint32_t* timings, size_t timings_size);
+
+/**
+ * Calculate fingerprint of raw timings.
+ *
+ * Fingerprint depends only on the number of timings and the sequence of
+ * quantized symbols. Captures of the same button usually produce the same
+ * value, but a timing close to a symbol boundary can change it. Equal
+ * fingerprints don't guarantee equal signals and different fingerprints don't
+ * guarantee different signals, use infrared_raw_is_similar() to decide.
+ *
+ * \param[in]   timings - array of timings, starting from mark.
+ * \param[in]   timings_size - timings array size.
+ * \return      fingerprint value.
+ */
+uint32_t infrared_raw_get_fingerprint(const uint32_t* timings, size_t timings_size);
+
+/**
+ * Compare two raw timing arrays with tolerance.
+ *
+ * \param[in]   timings_a - first array of timings.
+ * \param[in]   size_a - first array size.
+ * \param[in]   timings_b - second array of timings.
+ * \param[in]   size_b - second array size.
+ * \return      true if arrays have the same size and all timings match.
+ */
+bool infrared_raw_is_similar(
+    const uint32_t* timings_a,
+    size_t size_a,
+    const uint32_t* timings_b,
+    size_t size_b);
+
+#ifdef __cplusplus
+}
+#endif
@@ -904,6 +904,161 @@ static void EccPoint_mult(uECC_word_t * result,
     uECC_vli_set(result + num_words, Ry[0], num_words);
 }
 
+#if uECC_SUPPORTS_secp256r1 && uECC_SECP256R1_COMB
+
+#include "secp256r1-comb.inc"
+
+/* Fixed-base comb for k * G on secp256r1, with signed odd digits as in mbed TLS ecp_comb.
+   Scalar is made odd (k or n - k) and recoded so that every column of the comb is an odd signed
+   digit, so each of uECC_COMB_SPACING steps is one doubling and one mixed addition of a table
+   point that is never the point at infinity. Table points are picked by scanning the whole table.
+*/
+
+/* dest = src if cond is 1, dest is kept if cond is 0. */
+static void vli_cond_set(uECC_word_t *dest,
+                         const uECC_word_t *src,
+                         uECC_word_t cond,
+                         wordcount_t num_words) {
+    uECC_word_t mask = (uECC_word_t)0 - cond;
+    wordcount_t i;
+    for (i = 0; i < num_words; ++i) {
+        dest[i] ^= (dest[i] ^ src[i]) & mask;
+    }
+}
+
+/* point = +-T[index], sign is in bit 7 of digit and index in bits 1-6. */
+static void comb_select(uECC_word_t *point, uint8_t digit, uECC_Curve curve) {
+    uECC_word_t neg_y[uECC_MAX_WORDS];
+    uECC_word_t index = (digit & 0x7F) >> 1;
+    uECC_word_t i;
+    wordcount_t num_words = curve->num_words;
+
+    for (i = 0; i < uECC_COMB_POINTS; ++i) {
+        uECC_word_t diff = i ^ index;
+        uECC_word_t equal = 1 ^ ((diff | ((uECC_word_t)0 - diff)) >> (uECC_WORD_BITS - 1));
+        vli_cond_set(point, comb_secp256r1[i], equal, num_words * 2);
+    }
+
+    uECC_vli_sub(neg_y, curve->p, point + num_words, num_words);
+    vli_cond_set(point + num_words, neg_y, digit >> 7, num_words);
+}
+
+/* (X1, Y1, Z1) += (x2, y2). Returns nonzero if the points were equal or opposite,
+   which the formula can't handle. */
+static uECC_word_t comb_add(uECC_word_t * X1,
+                            uECC_word_t * Y1,
+                            uECC_word_t * Z1,
+                            const uECC_word_t * point,
+                            uECC_Curve curve) {
+    uECC_word_t t1[uECC_MAX_WORDS];
+    uECC_word_t t2[uECC_MAX_WORDS];
+    uECC_word_t t3[uECC_MAX_WORDS];
+    uECC_word_t exceptional;
+    wordcount_t num_words = curve->num_words;
+
+    uECC_vli_modSquare_fast(t1, Z1, curve);                  /* t1 = z1^2 */
+    uECC_vli_modMult_fast(t2, point, t1, curve);             /* t2 = x2*z1^2 = U2 */
+    uECC_vli_modMult_fast(t1, t1, Z1, curve);                /* t1 = z1^3 */
+    uECC_vli_modMult_fast(t1, t1, point + num_words, curve); /* t1 = y2*z1^3 = S2 */
+    uECC_vli_modSub(t2, t2, X1, curve->p, num_words);        /* t2 = U2 - x1 = H */
+    uECC_vli_modSub(t1, t1, Y1, curve->p, num_words);        /* t1 = S2 - y1 = R */
+    exceptional = uECC_vli_isZero(t2, num_words);
+
+    uECC_vli_modMult_fast(Z1, Z1, t2, curve);                /* z3 = z1*H */
+    uECC_vli_modSquare_fast(t3, t2, curve);                  /* t3 = H^2 */
+    uECC_vli_modMult_fast(t2, t2, t3, curve);                /* t2 = H^3 */
+    uECC_vli_modMult_fast(X1, X1, t3, curve);                /* x1 = x1*H^2 = V */
+    uECC_vli_modMult_fast(Y1, Y1, t2, curve);                /* y1 = y1*H^3 */
+    uECC_vli_modSquare_fast(t3, t1, curve);                  /* t3 = R^2 */
+    uECC_vli_modSub(t3, t3, t2, curve->p, num_words);        /* t3 = R^2 - H^3 */
+    uECC_vli_modSub(t3, t3, X1, curve->p, num_words);
+    uECC_vli_modSub(t3, t3, X1, curve->p, num_words);        /* t3 = R^2 - H^3 - 2V = x3 */
+    uECC_vli_modSub(X1, X1, t3, curve->p, num_words);        /* x1 = V - x3 */
+    uECC_vli_modMult_fast(X1, X1, t1, curve);                /* x1 = R*(V - x3) */
+    uECC_vli_modSub(Y1, X1, Y1, curve->p, num_words);        /* y3 = R*(V - x3) - y1*H^3 */
+
+    uECC_vli_set(X1, t3, num_words);
+    return exceptional;
+}
+
+/* result = scalar * G for 0 < scalar < n. Returns 0 if an addition hit a special case, which only
+   happens for a negligible share of scalars; caller falls back to EccPoint_mult then. */
+static uECC_word_t EccPoint_mult_comb(uECC_word_t * result,
+                                      const uECC_word_t * scalar,
+                                      const uECC_word_t * initial_Z,
+                                      uECC_Curve curve) {
+    uECC_word_t X[uECC_MAX_WORDS];
+    uECC_word_t Y[uECC_MAX_WORDS];
+    uECC_word_t Z[uECC_MAX_WORDS];
+    uECC_word_t m[uECC_MAX_WORDS];
+    uECC_word_t point[uECC_MAX_WORDS * 2];
+    uint8_t digits[uECC_COMB_SPACING + 1];
+    uint8_t carry = 0;
+    uECC_word_t negate = (scalar[0] & 1) ^ 1;
+    uECC_word_t exceptional = 0;
+    wordcount_t num_words = curve->num_words;
+    bitcount_t i;
+    bitcount_t j;
+
+    /* n is odd, so n - k is odd for even k. n - k gives -(k * G), result is negated back. */
+    uECC_vli_sub(m, curve->n, scalar, num_words);
+    vli_cond_set(m, scalar, negate ^ 1, num_words);
+
+    for (i = 0; i < uECC_COMB_SPACING; ++i) {
+        digits[i] = 0;
+        for (j = 0; j < uECC_COMB_TEETH; ++j) {
+            bitcount_t bit = i + uECC_COMB_SPACING * j;
+            if (bit < curve->num_n_bits) {
+                digits[i] |= ((m[bit / uECC_WORD_BITS] >> (bit % uECC_WORD_BITS)) & 1) << j;
+            }
+        }
+    }
+    digits[uECC_COMB_SPACING] = 0;
+
+    /* Make every digit odd: even digit i takes digit i - 1 and the latter is negated, that keeps
+       2^(i-1) * d[i-1] + 2^i * d[i]. Tooth overflow is carried to the same tooth of digit i + 1. */
+    for (i = 1; i <= uECC_COMB_SPACING; ++i) {
+        uint8_t next_carry = digits[i] & carry;
+        uint8_t adjust;
+        digits[i] ^= carry;
+        carry = next_carry;
+
+        adjust = (digits[i] & 1) ^ 1;
+        carry |= digits[i] & (digits[i - 1] * adjust);
+        digits[i] ^= digits[i - 1] * adjust;
+        digits[i - 1] |= adjust << 7;
+    }
+
+    comb_select(point, digits[uECC_COMB_SPACING], curve);
+    uECC_vli_set(X, point, num_words);
+    uECC_vli_set(Y, point + num_words, num_words);
+    if (initial_Z) {
+        uECC_vli_set(Z, initial_Z, num_words);
+        apply_z(X, Y, Z, curve);
+    } else {
+        uECC_vli_clear(Z, num_words);
+        Z[0] = 1;
+    }
+
+    for (i = uECC_COMB_SPACING; i-- > 0;) {
+        curve->double_jacobian(X, Y, Z, curve);
+        comb_select(point, digits[i], curve);
+        exceptional |= comb_add(X, Y, Z, point, curve);
+    }
+
+    uECC_vli_modInv(Z, Z, curve->p, num_words);
+    apply_z(X, Y, Z, curve);
+
+    uECC_vli_sub(point, curve->p, Y, num_words);
+    vli_cond_set(Y, point, negate, num_words);
+
+    uECC_vli_set(result, X, num_words);
+    uECC_vli_set(result + num_words, Y, num_words);
+    return !exceptional;
+}
+
+#endif /* uECC_SUPPORTS_secp256r1 && uECC_SECP256R1_COMB */
+
 static uECC_word_t regularize_k(const uECC_word_t * const k,
                                 uECC_word_t *k0,
                                 uECC_word_t *k1,
@@ -964,6 +1119,9 @@ static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
         }
         initial_Z = p2[carry];
     }
+#if uECC_SUPPORTS_secp256r1 && uECC_SECP256R1_COMB
+    if (curve != &curve_secp256r1 || !EccPoint_mult_comb(result, private_key, initial_Z, curve))
+#endif
     EccPoint_mult(result, curve->G, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
 
     if (EccPoint_isZero(result, curve)) {
@@ -1278,6 +1436,9 @@ static int uECC_sign_with_k_internal(const uint8_t *private_key,
         }
         initial_Z = k2[carry];
     }
+#if uECC_SUPPORTS_secp256r1 && uECC_SECP256R1_COMB
+    if (curve != &curve_secp256r1 || !EccPoint_mult_comb(p, k, initial_Z, curve))
+#endif
     EccPoint_mult(p, curve->G, k2[!carry], initial_Z, num_n_bits + 1, curve);
     if (uECC_vli_isZero(p, num_words)) {
         return 0;
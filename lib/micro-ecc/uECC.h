@@ -69,6 +69,13 @@ the same endianness. */
     #define uECC_SUPPORTS_secp256k1 1
 #endif
 
+/* uECC_SECP256R1_COMB - If enabled (defined as nonzero), multiplication of the secp256r1
+generator (public key computation and signing) uses a fixed-base comb with a precomputed table of
+32 points kept in flash (2 KB) instead of the Montgomery ladder. Much faster, same results. */
+#ifndef uECC_SECP256R1_COMB
+    #define uECC_SECP256R1_COMB 1
+#endif
+
 /* Specifies whether compressed point format is supported.
    Set to 0 to disable point compression/decompression functions. */
 #ifndef uECC_SUPPORT_COMPRESSED_POINT
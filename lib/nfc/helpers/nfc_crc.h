@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CRC_A, CRC_B and iClass CRC are all CRC-16/CCITT with reflected polynomial 0x8408,
+ * they only differ in initial value and final inversion. CRC is sent low byte first. */
+#define NFC_CRC_A_INIT (0x6363)
+#define NFC_CRC_B_INIT (0xFFFF)
+#define NFC_CRC_ICLASS_INIT (0xE012)
+
+/** Update CRC with data bytes, table driven
+ *
+ * @param      crc   current CRC, one of NFC_CRC_*_INIT for new frame
+ * @param      data  data bytes
+ * @param      len   data length
+ *
+ * @return     updated CRC, without final inversion
+ */
+uint16_t nfc_crc16_update(uint16_t crc, const uint8_t* data, size_t len);
+
+/** Update CRC of frame after single byte change without going over frame again
+ *
+ * Works for every CRC type, initial value and final inversion cancel out.
+ *
+ * @param      crc          CRC of frame with old byte
+ * @param      old_byte     old byte value
+ * @param      new_byte     new byte value
+ * @param      bytes_after  number of frame bytes after changed one
+ *
+ * @return     CRC of frame with new byte
+ */
+uint16_t nfc_crc16_patch(uint16_t crc, uint8_t old_byte, uint8_t new_byte, size_t bytes_after);
+
+uint16_t nfc_crc_a(const uint8_t* data, size_t len);
+
+/** Append CRC_A after len bytes of data, data must have 2 more bytes */
+void nfc_crc_a_append(uint8_t* data, size_t len);
+
+uint16_t nfc_crc_b(const uint8_t* data, size_t len);
+
+/** Append CRC_B after len bytes of data, data must have 2 more bytes */
+void nfc_crc_b_append(uint8_t* data, size_t len);
+
+uint16_t nfc_crc_iclass(const uint8_t* data, size_t len);
+
+/** Append iClass CRC after len bytes of data, data must have 2 more bytes */
+void nfc_crc_iclass_append(uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
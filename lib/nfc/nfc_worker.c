@@ -737,6 +737,7 @@ void nfc_worker_emulate_mf_classic(NfcWorker* nfc_worker) {
         .data_changed = false,
     };
     NfcaSignal* nfca_signal = nfca_signal_alloc();
+    mf_classic_emulator_cache_signals(nfca_signal);
     tx_rx.nfca_signal = nfca_signal;
 
     rfal_platform_spi_acquire();
@@ -1004,6 +1005,7 @@ void nfc_worker_analyze_reader(NfcWorker* nfc_worker) {
         .data_changed = false,
     };
     NfcaSignal* nfca_signal = nfca_signal_alloc();
+    mf_classic_emulator_cache_signals(nfca_signal);
     tx_rx.nfca_signal = nfca_signal;
     reader_analyzer_prepare_tx_rx(reader_analyzer, &tx_rx, true);
     reader_analyzer_start(nfc_worker->reader_analyzer, ReaderAnalyzerModeMfkey);
@@ -725,6 +725,15 @@ uint8_t mf_classic_update_card(FuriHalNfcTxRxContext* tx_rx, MfClassicData* data
     return sectors_read;
 }
 
+void mf_classic_emulator_cache_signals(NfcaSignal* nfca_signal) {
+    furi_assert(nfca_signal);
+
+    // Plain NACK is the only transparent mode response that never changes
+    uint8_t nack = 0x04;
+    uint8_t parity = 0;
+    nfca_signal_cache_add(nfca_signal, &nack, 4, &parity);
+}
+
 bool mf_classic_emulator(MfClassicEmulator* emulator, FuriHalNfcTxRxContext* tx_rx) {
     furi_assert(emulator);
     furi_assert(tx_rx);
@@ -778,10 +787,7 @@ bool mf_classic_emulator(MfClassicEmulator* emulator, FuriHalNfcTxRxContext* tx_
             if(!is_encrypted) {
                 crypto1_word(&emulator->crypto, emulator->cuid ^ nonce, 0);
                 memcpy(tx_rx->tx_data, nt, sizeof(nt));
-                tx_rx->tx_parity[0] = 0;
-                for(size_t i = 0; i < sizeof(nt); i++) {
-                    tx_rx->tx_parity[0] |= nfc_util_odd_parity8(nt[i]) << (7 - i);
-                }
+                nfc_util_odd_parity(nt, tx_rx->tx_parity, sizeof(nt));
                 tx_rx->tx_bits = sizeof(nt) * 8;
                 tx_rx->tx_rx_type = FuriHalNfcTxRxTransparent;
             } else {
@@ -178,6 +178,9 @@ uint8_t mf_classic_update_card(FuriHalNfcTxRxContext* tx_rx, MfClassicData* data
 
 bool mf_classic_emulator(MfClassicEmulator* emulator, FuriHalNfcTxRxContext* tx_rx);
 
+/** Add static emulator responses to transparent mode signal cache */
+void mf_classic_emulator_cache_signals(NfcaSignal* nfca_signal);
+
 bool mf_classic_write_block(
     FuriHalNfcTxRxContext* tx_rx,
     MfClassicBlock* src_block,
@@ -1083,11 +1083,82 @@ static void mf_ul_make_ascii_mirror(MfUltralightEmulator* emulator, FuriString*
     }
 }
 
+static void mf_ul_read_image_update_pages(
+    MfUltralightEmulator* emulator,
+    uint16_t first_page,
+    uint16_t page_count) {
+    if(first_page >= emulator->read_image_pages) return;
+    if(page_count > emulator->read_image_pages - first_page)
+        page_count = emulator->read_image_pages - first_page;
+    uint16_t end_page = first_page + page_count;
+
+    memcpy(
+        &emulator->read_image[first_page * 4],
+        &emulator->data.data[first_page * 4],
+        page_count * 4);
+
+    if(emulator->supported_features & MfUltralightSupportAuth) {
+        // Blank out PWD and PACK pages
+        uint16_t pwd_page = emulator->page_num - 2;
+        for(uint16_t page = pwd_page; page < pwd_page + 2; ++page) {
+            if(page >= first_page && page < end_page) {
+                memset(&emulator->read_image[page * 4], 0, 4);
+            }
+        }
+    }
+
+    if(emulator->supported_features & MfUltralightSupportAsciiMirror) {
+        // Mirror has to be applied again if its pages were overwritten or if
+        // MIRROR_PAGE/MIRROR_BYTE in first config page could have moved it
+        uint16_t mirror_page = emulator->read_image_mirror_page;
+        uint16_t mirror_end_page = mirror_page + emulator->read_image_mirror_page_count;
+        uint16_t config_page = emulator->page_num - 4;
+        if((first_page < mirror_end_page && end_page > mirror_page) ||
+           (first_page <= config_page && end_page > config_page)) {
+            emulator->read_image_mirror_dirty = true;
+        }
+    }
+}
+
+static void mf_ul_read_image_update_mirror(MfUltralightEmulator* emulator) {
+    // Restore pages under previous mirror
+    uint8_t prev_mirror_page = emulator->read_image_mirror_page;
+    uint8_t prev_mirror_page_count = emulator->read_image_mirror_page_count;
+    emulator->read_image_mirror_page_count = 0;
+    mf_ul_read_image_update_pages(emulator, prev_mirror_page, prev_mirror_page_count);
+
+    if(emulator->supported_features & MfUltralightSupportAsciiMirror &&
+       emulator->config_cache.mirror.mirror_conf != MfUltralightMirrorNone) {
+        FuriString* ascii_mirror = furi_string_alloc();
+        mf_ul_make_ascii_mirror(emulator, ascii_mirror);
+        size_t ascii_mirror_len = furi_string_size(ascii_mirror);
+        const char* ascii_mirror_cptr = furi_string_get_cstr(ascii_mirror);
+        size_t mirror_offset =
+            emulator->config->mirror_page * 4 + emulator->config->mirror.mirror_byte;
+        size_t image_size = emulator->read_image_pages * 4;
+        if(ascii_mirror_len > 0 && mirror_offset < image_size) {
+            if(ascii_mirror_len > image_size - mirror_offset)
+                ascii_mirror_len = image_size - mirror_offset;
+            for(size_t i = 0; i < ascii_mirror_len; ++i) {
+                if(ascii_mirror_cptr[i] != ' ')
+                    emulator->read_image[mirror_offset + i] = (uint8_t)ascii_mirror_cptr[i];
+            }
+            emulator->read_image_mirror_page = mirror_offset / 4;
+            emulator->read_image_mirror_page_count =
+                (mirror_offset + ascii_mirror_len + 3) / 4 - mirror_offset / 4;
+        }
+        furi_string_free(ascii_mirror);
+    }
+
+    emulator->read_image_mirror_dirty = false;
+}
+
 static void mf_ul_increment_single_counter(MfUltralightEmulator* emulator) {
     if(!emulator->read_counter_incremented && emulator->config_cache.access.nfc_cnt_en) {
         if(emulator->data.counter[2] < 0xFFFFFF) {
             ++emulator->data.counter[2];
             emulator->data_changed = true;
+            emulator->read_image_mirror_dirty = true;
         }
         emulator->read_counter_incremented = true;
     }
@@ -1125,6 +1196,7 @@ static bool
         // Tag will lock out counter if final number is 0xFFFF, even if you try to roll it back
         emulator->data.counter[1] = 0xFFFF;
     }
+    mf_ul_read_image_update_pages(emulator, MF_UL_NTAG203_COUNTER_PAGE, 1);
     emulator->data_changed = true;
     return true;
 }
@@ -1225,10 +1297,16 @@ static void mf_ul_emulate_write(
     }
 
     memcpy(&emulator->data.data[write_page * 4], page_buff, 4);
+    mf_ul_read_image_update_pages(emulator, write_page, 1);
     emulator->data_changed = true;
 }
 
 void mf_ul_reset_emulation(MfUltralightEmulator* emulator, bool is_power_cycle) {
+    // ASCII mirror depends on MIRROR_CONF, counter access bits and authentication
+    bool prev_auth_success = emulator->auth_success;
+    uint8_t prev_mirror = emulator->config_cache.mirror.value;
+    uint8_t prev_access = emulator->config_cache.access.value;
+
     emulator->comp_write_cmd_started = false;
     emulator->sector_select_cmd_started = false;
     emulator->curr_sector = 0;
@@ -1251,6 +1329,7 @@ void mf_ul_reset_emulation(MfUltralightEmulator* emulator, bool is_power_cycle)
             emulator->data.counter[0] =
                 emulator->data.data[MF_UL_NTAG203_COUNTER_PAGE * 4] |
                 (emulator->data.data[MF_UL_NTAG203_COUNTER_PAGE * 4 + 1] << 8);
+            mf_ul_read_image_update_pages(emulator, MF_UL_NTAG203_COUNTER_PAGE, 1);
         }
     } else {
         if(emulator->config != NULL) {
@@ -1265,6 +1344,10 @@ void mf_ul_reset_emulation(MfUltralightEmulator* emulator, bool is_power_cycle)
         // Mark counter as dirty
         emulator->data.tearing[0] = 0;
     }
+    if(prev_auth_success || prev_mirror != emulator->config_cache.mirror.value ||
+       prev_access != emulator->config_cache.access.value) {
+        emulator->read_image_mirror_dirty = true;
+    }
 }
 
 void mf_ul_prepare_emulation(MfUltralightEmulator* emulator, MfUltralightData* data) {
@@ -1275,6 +1358,14 @@ void mf_ul_prepare_emulation(MfUltralightEmulator* emulator, MfUltralightData* d
     emulator->page_num = emulator->data.data_size / 4;
     emulator->data_changed = false;
     memset(&emulator->auth_attempt, 0, sizeof(MfUltralightAuth));
+    // NTAG I2C reads depend on selected sector, those are composed per command
+    emulator->read_image_pages = 0;
+    emulator->read_image_mirror_page_count = 0;
+    if(emulator->data.type < MfUltralightTypeNTAGI2C1K &&
+       emulator->page_num <= MF_UL_READ_IMAGE_MAX_PAGES) {
+        emulator->read_image_pages = emulator->page_num;
+        mf_ul_read_image_update_pages(emulator, 0, emulator->page_num);
+    }
     mf_ul_reset_emulation(emulator, true);
 }
 
@@ -1371,6 +1462,19 @@ bool mf_ul_prepare_emulation_response(
                             }
                             if(emulator->supported_features & MfUltralightSupportSingleCounter)
                                 mf_ul_increment_single_counter(emulator);
+                            if(emulator->read_image_pages) {
+                                if(emulator->read_image_mirror_dirty)
+                                    mf_ul_read_image_update_mirror(emulator);
+                                for(uint8_t i = 0; i < 4; ++i) {
+                                    memcpy(
+                                        &buff_tx[i * 4], &emulator->read_image[src_page * 4], 4);
+                                    ++src_page;
+                                    if(src_page >= last_page_plus_one) src_page = 0;
+                                }
+                                *data_type = FURI_HAL_NFC_TXRX_DEFAULT;
+                                command_parsed = true;
+                                break;
+                            }
                             if(emulator->supported_features & MfUltralightSupportAsciiMirror &&
                                emulator->config_cache.mirror.mirror_conf !=
                                    MfUltralightMirrorNone) {
@@ -1528,6 +1632,17 @@ bool mf_ul_prepare_emulation_response(
                                     if(emulator->supported_features &
                                        MfUltralightSupportSingleCounter)
                                         mf_ul_increment_single_counter(emulator);
+                                    if(emulator->read_image_pages) {
+                                        if(emulator->read_image_mirror_dirty)
+                                            mf_ul_read_image_update_mirror(emulator);
+                                        memcpy(
+                                            buff_tx,
+                                            &emulator->read_image[start_page * 4],
+                                            tx_bytes);
+                                        *data_type = FURI_HAL_NFC_TXRX_DEFAULT;
+                                        command_parsed = true;
+                                        break;
+                                    }
 
                                     // Copy requested pages
                                     memcpy(
@@ -1724,6 +1839,7 @@ bool mf_ul_prepare_emulation_response(
                     if((cnt_num < 3) && (emulator->data.counter[cnt_num] != 0x00FFFFFF) &&
                        (emulator->data.counter[cnt_num] + inc <= 0x00FFFFFF)) {
                         emulator->data.counter[cnt_num] += inc;
+                        if(cnt_num == 2) emulator->read_image_mirror_dirty = true;
                         // We're RAM-backed, so tearing never happens
                         emulator->data.tearing[cnt_num] = MF_UL_TEARING_FLAG_DEFAULT;
                         emulator->data_changed = true;
@@ -1767,6 +1883,7 @@ bool mf_ul_prepare_emulation_response(
                             tx_bytes = 2;
                             *data_type = FURI_HAL_NFC_TXRX_DEFAULT;
                             emulator->auth_success = true;
+                            emulator->read_image_mirror_dirty = true;
                             command_parsed = true;
                             if(emulator->data.curr_authlim != 0) {
                                 // Reset current AUTHLIM
@@ -1780,6 +1897,7 @@ bool mf_ul_prepare_emulation_response(
                             tx_bytes = 2;
                             *data_type = FURI_HAL_NFC_TXRX_DEFAULT;
                             emulator->auth_success = true;
+                            emulator->read_image_mirror_dirty = true;
                             command_parsed = true;
                         } else {
                             // Wrong password, increase negative verification count
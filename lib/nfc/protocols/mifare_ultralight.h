@@ -4,6 +4,8 @@
 
 // Largest tag is NTAG I2C Plus 2K, both data sectors plus SRAM
 #define MF_UL_MAX_DUMP_SIZE ((238 + 256 + 16) * 4)
+// Largest tag served from READ image is NTAG216, NTAG I2C reads are sector mapped
+#define MF_UL_READ_IMAGE_MAX_PAGES (231)
 
 #define MF_UL_TEARING_FLAG_DEFAULT (0xBD)
 
@@ -193,6 +195,15 @@ typedef struct {
     bool auth_attempted;
     MfUltralightAuth auth_attempt;
 
+    // Pages as READ and FAST_READ return them: PWD and PACK blanked, ASCII mirror applied.
+    // Updated per written page; mirror is rendered again only when its inputs change.
+    // read_image_pages is 0 when tag type is not served from image.
+    uint8_t read_image[MF_UL_READ_IMAGE_MAX_PAGES * 4];
+    uint16_t read_image_pages;
+    bool read_image_mirror_dirty;
+    uint8_t read_image_mirror_page;
+    uint8_t read_image_mirror_page_count;
+
     // TODO rework with reader analyzer
     MfUltralightAuthReceivedCallback auth_received_callback;
     void* context;
@@ -1,6 +1,7 @@
 #include "nfc_util.h"
 
 #include <furi.h>
+#include <string.h>
 
 static const uint8_t nfc_util_odd_byte_parity[256] = {
     1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0,
@@ -36,12 +37,22 @@ uint64_t nfc_util_bytes2num(uint8_t* src, uint8_t len) {
 }
 
 uint8_t nfc_util_even_parity32(uint32_t data) {
-    // data ^= data >> 16;
-    // data ^= data >> 8;
-    // return !nfc_util_odd_byte_parity[data];
-    return (__builtin_parity(data) & 0xFF);
+    // Folding keeps parity, Cortex-M4 has no parity instruction for __builtin_parity
+    data ^= data >> 16;
+    data ^= data >> 8;
+    return !nfc_util_odd_byte_parity[data & 0xFF];
 }
 
 uint8_t nfc_util_odd_parity8(uint8_t data) {
     return nfc_util_odd_byte_parity[data];
 }
+
+void nfc_util_odd_parity(const uint8_t* src, uint8_t* dst, uint8_t len) {
+    furi_assert(src);
+    furi_assert(dst);
+
+    memset(dst, 0, (len + 7) / 8);
+    for(uint8_t i = 0; i < len; i++) {
+        dst[i / 8] |= nfc_util_odd_byte_parity[src[i]] << (7 - (i & 0x07));
+    }
+}
@@ -9,3 +9,6 @@ uint64_t nfc_util_bytes2num(uint8_t* src, uint8_t len);
 uint8_t nfc_util_even_parity32(uint32_t data);
 
 uint8_t nfc_util_odd_parity8(uint8_t data);
+
+/** Pack odd parity bits of bytes, first byte parity is MSB of first parity byte */
+void nfc_util_odd_parity(const uint8_t* src, uint8_t* dst, uint8_t len);
@@ -2,18 +2,23 @@
 #include <string.h>
 #include <stdio.h>
 #include <furi.h>
+#include <lib/nfc/helpers/nfc_crc.h>
 
 #define NFCA_CMD_RATS (0xE0U)
 
-#define NFCA_CRC_INIT (0x6363)
-
 #define NFCA_F_SIG (13560000.0)
 #define T_SIG 7374 //73.746ns*100
 #define T_SIG_x8 58992 //T_SIG*8
-#define T_SIG_x8_x8 471936 //T_SIG*8*8
-#define T_SIG_x8_x9 530928 //T_SIG*8*9
 
 #define NFCA_SIGNAL_MAX_EDGES (1350)
+#define NFCA_SIGNAL_BIT_TRANSITIONS (8)
+/* Bit with parity takes 16 subcarrier half periods, byte with parity 9 bits */
+#define NFCA_SIGNAL_BIT_UNITS (16)
+#define NFCA_SIGNAL_BYTE_UNITS (NFCA_SIGNAL_BIT_UNITS * 9)
+
+#define NFCA_SIGNAL_CACHE_ENTRIES_MAX (8)
+#define NFCA_SIGNAL_CACHE_DATA_SIZE (8)
+#define NFCA_SIGNAL_CACHE_PARITY_SIZE (1)
 
 typedef struct {
     uint8_t cmd;
@@ -24,25 +29,49 @@ static uint8_t nfca_default_ats[] = {0x05, 0x78, 0x80, 0x80, 0x00};
 
 static uint8_t nfca_sleep_req[] = {0x50, 0x00};
 
-uint16_t nfca_get_crc16(uint8_t* buff, uint16_t len) {
-    uint16_t crc = NFCA_CRC_INIT;
-    uint8_t byte = 0;
-
-    for(uint8_t i = 0; i < len; i++) {
-        byte = buff[i];
-        byte ^= (uint8_t)(crc & 0xff);
-        byte ^= byte << 4;
-        crc = (crc >> 8) ^ (((uint16_t)byte) << 8) ^ (((uint16_t)byte) << 3) ^
-              (((uint16_t)byte) >> 4);
+/** Timer ticks from byte start to subcarrier half period inside byte */
+typedef struct {
+    uint16_t ticks;
+    uint16_t rest;
+} NfcaSignalOffset;
+
+#define NFCA_SIGNAL_OFFSET(unit)                         \
+    {                                                    \
+        .ticks = (unit)*T_SIG_x8 / DIGITAL_SIGNAL_T_TIM, \
+        .rest = (unit)*T_SIG_x8 % DIGITAL_SIGNAL_T_TIM,  \
     }
+#define NFCA_SIGNAL_OFFSETS_4(unit)                           \
+    NFCA_SIGNAL_OFFSET(unit), NFCA_SIGNAL_OFFSET((unit) + 1), \
+        NFCA_SIGNAL_OFFSET((unit) + 2), NFCA_SIGNAL_OFFSET((unit) + 3)
+#define NFCA_SIGNAL_OFFSETS_BIT(bit)                            \
+    NFCA_SIGNAL_OFFSETS_4((bit)*NFCA_SIGNAL_BIT_UNITS),         \
+        NFCA_SIGNAL_OFFSETS_4((bit)*NFCA_SIGNAL_BIT_UNITS + 4), \
+        NFCA_SIGNAL_OFFSETS_4((bit)*NFCA_SIGNAL_BIT_UNITS + 8), \
+        NFCA_SIGNAL_OFFSETS_4((bit)*NFCA_SIGNAL_BIT_UNITS + 12)
+
+/* Computed by compiler, shared by all instances */
+static const NfcaSignalOffset nfca_signal_offsets[] = {
+    NFCA_SIGNAL_OFFSETS_BIT(0),
+    NFCA_SIGNAL_OFFSETS_BIT(1),
+    NFCA_SIGNAL_OFFSETS_BIT(2),
+    NFCA_SIGNAL_OFFSETS_BIT(3),
+    NFCA_SIGNAL_OFFSETS_BIT(4),
+    NFCA_SIGNAL_OFFSETS_BIT(5),
+    NFCA_SIGNAL_OFFSETS_BIT(6),
+    NFCA_SIGNAL_OFFSETS_BIT(7),
+    NFCA_SIGNAL_OFFSETS_BIT(8),
+};
+
+_Static_assert(
+    COUNT_OF(nfca_signal_offsets) == NFCA_SIGNAL_BYTE_UNITS,
+    "nfca_signal_offsets size error");
 
-    return crc;
+uint16_t nfca_get_crc16(uint8_t* buff, uint16_t len) {
+    return nfc_crc_a(buff, len);
 }
 
 void nfca_append_crc16(uint8_t* buff, uint16_t len) {
-    uint16_t crc = nfca_get_crc16(buff, len);
-    buff[len] = (uint8_t)crc;
-    buff[len + 1] = (uint8_t)(crc >> 8);
+    nfc_crc_a_append(buff, len);
 }
 
 bool nfca_emulation_handler(
@@ -63,46 +92,121 @@ bool nfca_emulation_handler(
     return sleep;
 }
 
-static void nfca_add_bit(DigitalSignal* signal, bool bit) {
-    if(bit) {
-        signal->start_level = true;
-        for(size_t i = 0; i < 7; i++) {
-            signal->edge_timings[i] = T_SIG_x8;
-        }
-        signal->edge_timings[7] = T_SIG_x8_x9;
-        signal->edge_cnt = 8;
-    } else {
-        signal->start_level = false;
-        signal->edge_timings[0] = T_SIG_x8_x8;
-        for(size_t i = 1; i < 9; i++) {
-            signal->edge_timings[i] = T_SIG_x8;
+typedef struct {
+    uint16_t bits;
+    uint8_t data[NFCA_SIGNAL_CACHE_DATA_SIZE];
+    uint8_t parity[NFCA_SIGNAL_CACHE_PARITY_SIZE];
+    DigitalSignal* signal;
+} NfcaSignalCacheEntry;
+
+struct NfcaSignalCache {
+    NfcaSignalCacheEntry entries[NFCA_SIGNAL_CACHE_ENTRIES_MAX];
+    size_t entries_cnt;
+};
+
+typedef struct {
+    uint32_t transitions;
+    uint32_t last_unit;
+    uint32_t last_tick;
+} NfcaSignalEncoder;
+
+/*
+ * Every transition lies on grid of subcarrier half periods (units). Timer reload
+ * values are taken from rounded absolute transition time, as digital_signal_prepare_arr()
+ * does with carried remainder. Time of byte start is divided once, offsets inside byte
+ * come from table, so each transition costs an add and compare instead of division.
+ */
+static void nfca_signal_add_bits(
+    NfcaSignal* nfca_signal,
+    NfcaSignalEncoder* encoder,
+    uint32_t base,
+    uint16_t bits,
+    uint8_t count) {
+    DigitalSignal* signal = nfca_signal->tx_signal;
+    uint32_t base_time = base * T_SIG_x8 + DIGITAL_SIGNAL_T_TIM_DIV2;
+    uint32_t base_ticks = base_time / DIGITAL_SIGNAL_T_TIM;
+    uint32_t base_rest = base_time % DIGITAL_SIGNAL_T_TIM;
+
+    for(uint8_t i = 0; i < count; i++) {
+        if(encoder->transitions + NFCA_SIGNAL_BIT_TRANSITIONS > signal->edges_max_cnt) break;
+
+        // Bit one is modulated in first half of bit, zero in second one
+        uint32_t unit = i * NFCA_SIGNAL_BIT_UNITS;
+        if(!(bits & (1 << i))) unit += NFCA_SIGNAL_BIT_UNITS / 2;
+
+        for(uint8_t j = 0; j < NFCA_SIGNAL_BIT_TRANSITIONS; j++, unit++) {
+            const NfcaSignalOffset* offset = &nfca_signal_offsets[unit];
+            uint32_t tick = base_ticks + offset->ticks;
+            if(base_rest + offset->rest >= DIGITAL_SIGNAL_T_TIM) tick++;
+
+            // First transition starts signal
+            if(encoder->transitions) {
+                uint32_t edge = encoder->transitions - 1;
+                signal->edge_timings[edge] = (base + unit - encoder->last_unit) * T_SIG_x8;
+                signal->reload_reg_buff[edge] = tick - encoder->last_tick - 1;
+            }
+            encoder->transitions++;
+            encoder->last_unit = base + unit;
+            encoder->last_tick = tick;
         }
-        signal->edge_cnt = 9;
     }
 }
 
-static void nfca_add_byte(NfcaSignal* nfca_signal, uint8_t byte, bool parity) {
-    for(uint8_t i = 0; i < 8; i++) {
-        if(byte & (1 << i)) {
-            digital_signal_append(nfca_signal->tx_signal, nfca_signal->one);
-        } else {
-            digital_signal_append(nfca_signal->tx_signal, nfca_signal->zero);
-        }
-    }
-    if(parity) {
-        digital_signal_append(nfca_signal->tx_signal, nfca_signal->one);
+static void nfca_signal_encode_frame(
+    NfcaSignal* nfca_signal,
+    uint8_t* data,
+    uint16_t bits,
+    uint8_t* parity) {
+    DigitalSignal* signal = nfca_signal->tx_signal;
+    NfcaSignalEncoder encoder = {};
+    uint32_t end = NFCA_SIGNAL_BIT_UNITS;
+
+    signal->start_level = true;
+    // Start of frame
+    nfca_signal_add_bits(nfca_signal, &encoder, 0, 1, 1);
+
+    if(bits < 8) {
+        nfca_signal_add_bits(nfca_signal, &encoder, end, data[0], bits);
+        end += bits * NFCA_SIGNAL_BIT_UNITS;
     } else {
-        digital_signal_append(nfca_signal->tx_signal, nfca_signal->zero);
+        for(size_t i = 0; i < bits / 8; i++) {
+            uint16_t byte = data[i];
+            if(parity[i / 8] & (1 << (7 - (i & 0x07)))) byte |= 1 << 8;
+            nfca_signal_add_bits(nfca_signal, &encoder, end, byte, 9);
+            end += NFCA_SIGNAL_BYTE_UNITS;
+        }
     }
+
+    // Signal ends with modulation off till the end of last bit
+    signal->edge_timings[encoder.transitions - 1] = (end - encoder.last_unit) * T_SIG_x8;
+    signal->edge_cnt = encoder.transitions;
+}
+
+static size_t nfca_signal_parity_size(uint16_t bits) {
+    return bits < 8 ? 0 : (bits / 8 + 7) / 8;
+}
+
+static bool nfca_signal_cache_entry_match(
+    NfcaSignalCacheEntry* entry,
+    uint8_t* data,
+    uint16_t bits,
+    uint8_t* parity) {
+    return (entry->bits == bits) && !memcmp(entry->data, data, (bits + 7) / 8) &&
+           !memcmp(entry->parity, parity, nfca_signal_parity_size(bits));
+}
+
+static void nfca_signal_copy(DigitalSignal* dst, DigitalSignal* src) {
+    dst->start_level = src->start_level;
+    dst->edge_cnt = src->edge_cnt;
+    memcpy(dst->edge_timings, src->edge_timings, src->edge_cnt * sizeof(uint32_t));
+    memcpy(dst->reload_reg_buff, src->reload_reg_buff, src->edge_cnt * sizeof(uint32_t));
 }
 
 NfcaSignal* nfca_signal_alloc() {
     NfcaSignal* nfca_signal = malloc(sizeof(NfcaSignal));
-    nfca_signal->one = digital_signal_alloc(10);
-    nfca_signal->zero = digital_signal_alloc(10);
-    nfca_add_bit(nfca_signal->one, true);
-    nfca_add_bit(nfca_signal->zero, false);
     nfca_signal->tx_signal = digital_signal_alloc(NFCA_SIGNAL_MAX_EDGES);
+    nfca_signal->cache = malloc(sizeof(NfcaSignalCache));
+    nfca_signal->cache->entries_cnt = 0;
 
     return nfca_signal;
 }
@@ -110,8 +214,10 @@ NfcaSignal* nfca_signal_alloc() {
 void nfca_signal_free(NfcaSignal* nfca_signal) {
     furi_assert(nfca_signal);
 
-    digital_signal_free(nfca_signal->one);
-    digital_signal_free(nfca_signal->zero);
+    for(size_t i = 0; i < nfca_signal->cache->entries_cnt; i++) {
+        digital_signal_free(nfca_signal->cache->entries[i].signal);
+    }
+    free(nfca_signal->cache);
     digital_signal_free(nfca_signal->tx_signal);
     free(nfca_signal);
 }
@@ -121,22 +227,40 @@ void nfca_signal_encode(NfcaSignal* nfca_signal, uint8_t* data, uint16_t bits, u
     furi_assert(data);
     furi_assert(parity);
 
-    nfca_signal->tx_signal->edge_cnt = 0;
-    nfca_signal->tx_signal->start_level = true;
-    // Start of frame
-    digital_signal_append(nfca_signal->tx_signal, nfca_signal->one);
-
-    if(bits < 8) {
-        for(size_t i = 0; i < bits; i++) {
-            if(FURI_BIT(data[0], i)) {
-                digital_signal_append(nfca_signal->tx_signal, nfca_signal->one);
-            } else {
-                digital_signal_append(nfca_signal->tx_signal, nfca_signal->zero);
-            }
-        }
-    } else {
-        for(size_t i = 0; i < bits / 8; i++) {
-            nfca_add_byte(nfca_signal, data[i], parity[i / 8] & (1 << (7 - (i & 0x07))));
+    NfcaSignalCache* cache = nfca_signal->cache;
+    for(size_t i = 0; i < cache->entries_cnt; i++) {
+        NfcaSignalCacheEntry* entry = &cache->entries[i];
+        if(nfca_signal_cache_entry_match(entry, data, bits, parity)) {
+            nfca_signal_copy(nfca_signal->tx_signal, entry->signal);
+            return;
         }
     }
+
+    nfca_signal_encode_frame(nfca_signal, data, bits, parity);
+}
+
+bool nfca_signal_cache_add(
+    NfcaSignal* nfca_signal,
+    uint8_t* data,
+    uint16_t bits,
+    uint8_t* parity) {
+    furi_assert(nfca_signal);
+    furi_assert(data);
+    furi_assert(parity);
+
+    NfcaSignalCache* cache = nfca_signal->cache;
+    if(bits > NFCA_SIGNAL_CACHE_DATA_SIZE * 8) return false;
+    if(cache->entries_cnt == NFCA_SIGNAL_CACHE_ENTRIES_MAX) return false;
+
+    nfca_signal_encode_frame(nfca_signal, data, bits, parity);
+    DigitalSignal* tx_signal = nfca_signal->tx_signal;
+
+    NfcaSignalCacheEntry* entry = &cache->entries[cache->entries_cnt++];
+    entry->bits = bits;
+    memcpy(entry->data, data, (bits + 7) / 8);
+    memcpy(entry->parity, parity, nfca_signal_parity_size(bits));
+    entry->signal = digital_signal_alloc(tx_signal->edge_cnt);
+    nfca_signal_copy(entry->signal, tx_signal);
+
+    return true;
 }
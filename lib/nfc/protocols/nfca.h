@@ -5,10 +5,11 @@
 
 #include <lib/digital_signal/digital_signal.h>
 
+typedef struct NfcaSignalCache NfcaSignalCache;
+
 typedef struct {
-    DigitalSignal* one;
-    DigitalSignal* zero;
     DigitalSignal* tx_signal;
+    NfcaSignalCache* cache;
 } NfcaSignal;
 
 uint16_t nfca_get_crc16(uint8_t* buff, uint16_t len);
@@ -25,4 +26,17 @@ NfcaSignal* nfca_signal_alloc();
 
 void nfca_signal_free(NfcaSignal* nfca_signal);
 
+/** Encode frame into tx_signal
+ *
+ * Both edge timings and timer reload buffer are filled, signal is ready for
+ * digital_signal_send_prepared().
+ */
 void nfca_signal_encode(NfcaSignal* nfca_signal, uint8_t* data, uint16_t bits, uint8_t* parity);
+
+/** Keep encoded frame to copy it instead of encoding when it is sent again
+ *
+ * Meant for few static responses, every encode compares frame with each one.
+ *
+ * @return     false if frame is too long or cache is full
+ */
+bool nfca_signal_cache_add(NfcaSignal* nfca_signal, uint8_t* data, uint16_t bits, uint8_t* parity);
@@ -36,6 +36,7 @@ iButtonWorker* ibutton_worker_alloc() {
     worker->write_cb = NULL;
     worker->emulate_cb = NULL;
     worker->cb_ctx = NULL;
+    worker->read_context = NULL;
 
     worker->thread = furi_thread_alloc_ex("iButtonWorker", 2048, ibutton_worker_thread, worker);
 
@@ -31,6 +31,8 @@ typedef enum {
     iButtonWorkerEmulate = 3,
 } iButtonWorkerMode;
 
+typedef struct iButtonReadContext iButtonReadContext;
+
 struct iButtonWorker {
     iButtonKey* key_p;
     uint8_t* key_data;
@@ -49,6 +51,7 @@ struct iButtonWorker {
 
     ProtocolDict* protocols;
     iButtonProtocol protocol_to_encode;
+    iButtonReadContext* read_context;
 };
 
 extern const iButtonWorkerModeType ibutton_worker_modes[];
@@ -3,6 +3,8 @@
 #include "ibutton_worker_i.h"
 #include "ibutton_key_command.h"
 
+#define TAG "iButtonWorker"
+
 void ibutton_worker_mode_idle_start(iButtonWorker* worker);
 void ibutton_worker_mode_idle_tick(iButtonWorker* worker);
 void ibutton_worker_mode_idle_stop(iButtonWorker* worker);
@@ -27,7 +29,7 @@ const iButtonWorkerModeType ibutton_worker_modes[] = {
         .stop = ibutton_worker_mode_idle_stop,
     },
     {
-        .quant = 100,
+        .quant = 10,
         .start = ibutton_worker_mode_read_start,
         .tick = ibutton_worker_mode_read_tick,
         .stop = ibutton_worker_mode_read_stop,
@@ -62,25 +64,51 @@ void ibutton_worker_mode_idle_stop(iButtonWorker* worker) {
 
 /*********************** READ ***********************/
 
-typedef struct {
-    uint32_t last_dwt_value;
-    FuriStreamBuffer* stream;
-} iButtonReadContext;
+/**
+ * Read cycle: analog capture window, then one 1-Wire search.
+ *
+ * Comparator edges are timestamped by TIM2 input capture (1us) into a ring buffer.
+ * Both analog decoders are fed from the ring in one pass, the window ends on first decode.
+ * 1-Wire line stays released during the window, so the window is also the settle time
+ * before the search. Reset pulses are only sent between windows.
+ */
+#define IBUTTON_READ_WINDOW_MS 100
+#define IBUTTON_READ_POLL_MS 4
+#define IBUTTON_READ_RING_SIZE 256
+
+struct iButtonReadContext {
+    LevelDuration ring[IBUTTON_READ_RING_SIZE];
+    volatile uint32_t head;
+    uint32_t tail;
+    uint32_t last_pulse;
+    uint32_t overruns;
+};
 
-void ibutton_worker_comparator_callback(bool level, void* context) {
+static void ibutton_worker_read_capture(bool level, uint32_t duration, void* context) {
     iButtonReadContext* read_context = context;
+    uint32_t head = read_context->head;
 
-    uint32_t current_dwt_value = DWT->CYCCNT;
-
-    LevelDuration data =
-        level_duration_make(level, current_dwt_value - read_context->last_dwt_value);
-    furi_stream_buffer_send(read_context->stream, &data, sizeof(LevelDuration), 0);
+    // level == true: falling edge, duration is the high time since last rising edge
+    // level == false: rising edge, duration is the whole period
+    if(level) {
+        read_context->last_pulse = duration;
+        read_context->ring[head % IBUTTON_READ_RING_SIZE] = level_duration_make(true, duration);
+    } else {
+        uint32_t pulse = read_context->last_pulse;
+        uint32_t low_time = (duration > pulse) ? (duration - pulse) : duration;
+        read_context->last_pulse = 0;
+        read_context->ring[head % IBUTTON_READ_RING_SIZE] = level_duration_make(false, low_time);
+    }
 
-    read_context->last_dwt_value = current_dwt_value;
+    read_context->head = head + 1;
 }
 
 bool ibutton_worker_read_comparator(iButtonWorker* worker) {
-    bool result = false;
+    iButtonReadContext* read_context = worker->read_context;
+    ProtocolId decoded_index = PROTOCOL_NO;
+
+    // decoders work in cpu cycles, capture timer ticks once per microsecond
+    const uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
 
     protocol_dict_decoders_start(worker->protocols);
 
@@ -88,68 +116,71 @@ bool ibutton_worker_read_comparator(iButtonWorker* worker) {
     // pulldown pull pin, we sense the signal through the analog part of the RFID schematic
     furi_hal_rfid_pin_pull_pulldown();
 
-    iButtonReadContext read_context = {
-        .last_dwt_value = DWT->CYCCNT,
-        .stream = furi_stream_buffer_alloc(sizeof(LevelDuration) * 512, 1),
-    };
-
-    furi_hal_rfid_comp_set_callback(ibutton_worker_comparator_callback, &read_context);
-    furi_hal_rfid_comp_start();
+    read_context->head = 0;
+    read_context->tail = 0;
+    read_context->last_pulse = 0;
+    furi_hal_rfid_tim_read_capture_start(ibutton_worker_read_capture, read_context);
 
     uint32_t tick_start = furi_get_tick();
-    while(true) {
-        LevelDuration level;
-        size_t ret =
-            furi_stream_buffer_receive(read_context.stream, &level, sizeof(LevelDuration), 100);
-
-        if((furi_get_tick() - tick_start) > 100) {
-            break;
+    while(decoded_index == PROTOCOL_NO) {
+        furi_delay_ms(IBUTTON_READ_POLL_MS);
+        bool window_end = (furi_get_tick() - tick_start) >= IBUTTON_READ_WINDOW_MS;
+
+        uint32_t head = read_context->head;
+        if(head - read_context->tail > IBUTTON_READ_RING_SIZE) {
+            read_context->overruns++;
+            read_context->tail = head;
+            protocol_dict_decoders_start(worker->protocols);
         }
 
-        if(ret > 0) {
-            ProtocolId decoded_index = protocol_dict_decoders_feed(
-                worker->protocols,
-                level_duration_get_level(level),
-                level_duration_get_duration(level));
-
-            if(decoded_index == PROTOCOL_NO) continue;
-
-            protocol_dict_get_data(
-                worker->protocols, decoded_index, worker->key_data, ibutton_key_get_max_size());
+        while(read_context->tail != head) {
+            LevelDuration edge = read_context->ring[read_context->tail % IBUTTON_READ_RING_SIZE];
+            read_context->tail++;
 
-            switch(decoded_index) {
-            case iButtonProtocolCyfral:
-                furi_check(worker->key_p != NULL);
-                ibutton_key_set_type(worker->key_p, iButtonKeyCyfral);
-                ibutton_key_set_data(worker->key_p, worker->key_data, ibutton_key_get_max_size());
-                result = true;
-                break;
-            case iButtonProtocolMetakom:
-                furi_check(worker->key_p != NULL);
-                ibutton_key_set_type(worker->key_p, iButtonKeyMetakom);
-                ibutton_key_set_data(worker->key_p, worker->key_data, ibutton_key_get_max_size());
-                result = true;
-                break;
-                break;
-            default:
-                break;
-            }
+            decoded_index = protocol_dict_decoders_feed(
+                worker->protocols,
+                level_duration_get_level(edge),
+                level_duration_get_duration(edge) * cycles_per_us);
+            if(decoded_index != PROTOCOL_NO) break;
         }
+
+        if(window_end) break;
     }
 
-    furi_hal_rfid_comp_stop();
-    furi_hal_rfid_comp_set_callback(NULL, NULL);
+    furi_hal_rfid_tim_read_capture_stop();
     furi_hal_rfid_pins_reset();
 
-    furi_stream_buffer_free(read_context.stream);
+    if(read_context->overruns) {
+        FURI_LOG_W(TAG, "Capture ring overruns: %lu", read_context->overruns);
+        read_context->overruns = 0;
+    }
+
+    bool result = true;
+    switch(decoded_index) {
+    case iButtonProtocolCyfral:
+        furi_check(worker->key_p != NULL);
+        protocol_dict_get_data(
+            worker->protocols, decoded_index, worker->key_data, ibutton_key_get_max_size());
+        ibutton_key_set_type(worker->key_p, iButtonKeyCyfral);
+        ibutton_key_set_data(worker->key_p, worker->key_data, ibutton_key_get_max_size());
+        break;
+    case iButtonProtocolMetakom:
+        furi_check(worker->key_p != NULL);
+        protocol_dict_get_data(
+            worker->protocols, decoded_index, worker->key_data, ibutton_key_get_max_size());
+        ibutton_key_set_type(worker->key_p, iButtonKeyMetakom);
+        ibutton_key_set_data(worker->key_p, worker->key_data, ibutton_key_get_max_size());
+        break;
+    default:
+        result = false;
+        break;
+    }
 
     return result;
 }
 
 bool ibutton_worker_read_dallas(iButtonWorker* worker) {
     bool result = false;
-    onewire_host_start(worker->host);
-    furi_delay_ms(100);
     FURI_CRITICAL_ENTER();
     if(onewire_host_search(worker->host, worker->key_data, NORMAL_SEARCH)) {
         onewire_host_reset_search(worker->host);
@@ -176,23 +207,27 @@ bool ibutton_worker_read_dallas(iButtonWorker* worker) {
     } else {
         onewire_host_reset_search(worker->host);
     }
-    onewire_host_stop(worker->host);
     FURI_CRITICAL_EXIT();
     return result;
 }
 
 void ibutton_worker_mode_read_start(iButtonWorker* worker) {
-    UNUSED(worker);
+    worker->read_context = malloc(sizeof(iButtonReadContext));
+    worker->read_context->overruns = 0;
     furi_hal_power_enable_otg();
 }
 
 void ibutton_worker_mode_read_tick(iButtonWorker* worker) {
     bool valid = false;
-    if(ibutton_worker_read_dallas(worker)) {
+
+    // release the line, the capture window gives it time to settle before the search
+    onewire_host_start(worker->host);
+    if(ibutton_worker_read_comparator(worker)) {
         valid = true;
-    } else if(ibutton_worker_read_comparator(worker)) {
+    } else if(ibutton_worker_read_dallas(worker)) {
         valid = true;
     }
+    onewire_host_stop(worker->host);
 
     if(valid) {
         if(worker->read_cb != NULL) {
@@ -204,8 +239,9 @@ void ibutton_worker_mode_read_tick(iButtonWorker* worker) {
 }
 
 void ibutton_worker_mode_read_stop(iButtonWorker* worker) {
-    UNUSED(worker);
     furi_hal_power_disable_otg();
+    free(worker->read_context);
+    worker->read_context = NULL;
 }
 
 /*********************** EMULATE ***********************/
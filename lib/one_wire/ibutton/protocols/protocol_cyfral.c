@@ -74,7 +74,8 @@ static void protocol_cyfral_decoder_start(ProtocolCyfral* proto) {
     cyfral->period_time = 0;
     cyfral->bit_index = 0;
     cyfral->index = 0;
-    cyfral->nibble = 0;
+    // start nibble (0b0001) must be made of four received bits, not of reset value
+    cyfral->nibble = 0x0F;
     cyfral->data_valid = true;
     cyfral->max_period = CYFRAL_MAX_PERIOD_US * furi_hal_cortex_instructions_per_microsecond();
 
@@ -1,7 +1,7 @@
 #include "crc32_calc.h"
 #include <littlefs/lfs_util.h>
 
-#define CRC_DATA_BUFFER_MAX_LEN 512
+#define CRC_DATA_BUFFER_MAX_LEN 4096
 
 uint32_t crc32_calc_buffer(uint32_t crc, const void* buffer, size_t size) {
     // TODO: consider removing dependency on LFS
@@ -1,13 +1,26 @@
 #include "dir_walk.h"
-#include <m-list.h>
+#include <m-array.h>
 
-LIST_DEF(DirIndexList, uint32_t);
+/* Each open level keeps its own batch, so stepping out doesn't re-read the parent */
+#define DIR_WALK_BATCH_SIZE 1024
 
-struct DirWalk {
+typedef struct {
     File* file;
+    uint8_t* batch;
+    StorageDirRecord* record;
+    uint16_t records_left;
+    size_t path_length;
+} DirWalkFrame;
+
+ARRAY_DEF(DirWalkFrameArray, DirWalkFrame, M_POD_OPLIST);
+
+struct DirWalk {
+    Storage* storage;
     FuriString* path;
-    DirIndexList_t index_list;
-    uint32_t current_index;
+    /* Frames are kept allocated between walks, only first depth ones are in use */
+    DirWalkFrameArray_t frames;
+    size_t depth;
+    FS_Error error;
     bool recursive;
     DirWalkFilterCb filter_cb;
     void* filter_context;
@@ -15,18 +28,29 @@ struct DirWalk {
 
 DirWalk* dir_walk_alloc(Storage* storage) {
     DirWalk* dir_walk = malloc(sizeof(DirWalk));
+    dir_walk->storage = storage;
     dir_walk->path = furi_string_alloc();
-    dir_walk->file = storage_file_alloc(storage);
-    DirIndexList_init(dir_walk->index_list);
+    DirWalkFrameArray_init(dir_walk->frames);
+    dir_walk->depth = 0;
+    dir_walk->error = FSE_OK;
     dir_walk->recursive = true;
     dir_walk->filter_cb = NULL;
     return dir_walk;
 }
 
 void dir_walk_free(DirWalk* dir_walk) {
-    storage_file_free(dir_walk->file);
+    dir_walk_close(dir_walk);
+
+    DirWalkFrameArray_it_t it;
+    for(DirWalkFrameArray_it(it, dir_walk->frames); !DirWalkFrameArray_end_p(it);
+        DirWalkFrameArray_next(it)) {
+        DirWalkFrame* frame = DirWalkFrameArray_ref(it);
+        storage_file_free(frame->file);
+        free(frame->batch);
+    }
+
+    DirWalkFrameArray_clear(dir_walk->frames);
     furi_string_free(dir_walk->path);
-    DirIndexList_clear(dir_walk->index_list);
     free(dir_walk);
 }
 
@@ -39,10 +63,41 @@ void dir_walk_set_filter_cb(DirWalk* dir_walk, DirWalkFilterCb cb, void* context
     dir_walk->filter_context = context;
 }
 
+static bool dir_walk_push(DirWalk* dir_walk) {
+    if(dir_walk->depth == DirWalkFrameArray_size(dir_walk->frames)) {
+        DirWalkFrame* frame = DirWalkFrameArray_push_new(dir_walk->frames);
+        frame->file = storage_file_alloc(dir_walk->storage);
+        frame->batch = malloc(DIR_WALK_BATCH_SIZE);
+    }
+
+    DirWalkFrame* frame = DirWalkFrameArray_get(dir_walk->frames, dir_walk->depth);
+    dir_walk->depth++;
+    frame->records_left = 0;
+    frame->path_length = furi_string_size(dir_walk->path);
+
+    bool result = storage_dir_open(frame->file, furi_string_get_cstr(dir_walk->path));
+    dir_walk->error = storage_file_get_error(frame->file);
+    return result;
+}
+
+static void dir_walk_pop(DirWalk* dir_walk) {
+    dir_walk->depth--;
+    DirWalkFrame* frame = DirWalkFrameArray_get(dir_walk->frames, dir_walk->depth);
+
+    if(storage_file_is_open(frame->file)) {
+        storage_dir_close(frame->file);
+    }
+
+    if(dir_walk->depth > 0) {
+        DirWalkFrame* parent = DirWalkFrameArray_get(dir_walk->frames, dir_walk->depth - 1);
+        furi_string_left(dir_walk->path, parent->path_length);
+    }
+}
+
 bool dir_walk_open(DirWalk* dir_walk, const char* path) {
+    dir_walk_close(dir_walk);
     furi_string_set(dir_walk->path, path);
-    dir_walk->current_index = 0;
-    return storage_dir_open(dir_walk->file, path);
+    return dir_walk_push(dir_walk);
 }
 
 static bool dir_walk_filter(DirWalk* dir_walk, const char* name, FileInfo* fileinfo) {
@@ -55,88 +110,68 @@ static bool dir_walk_filter(DirWalk* dir_walk, const char* name, FileInfo* filei
 
 static DirWalkResult
     dir_walk_iter(DirWalk* dir_walk, FuriString* return_path, FileInfo* fileinfo) {
-    DirWalkResult result = DirWalkError;
-    char* name = malloc(256); // FIXME: remove magic number
-    FileInfo info;
-    bool end = false;
-
-    while(!end) {
-        storage_dir_read(dir_walk->file, &info, name, 255);
-
-        if(storage_file_get_error(dir_walk->file) == FSE_OK) {
-            result = DirWalkOK;
-            dir_walk->current_index++;
-
-            if(dir_walk_filter(dir_walk, name, &info)) {
-                if(return_path != NULL) {
-                    furi_string_printf(
-                        return_path, "%s/%s", furi_string_get_cstr(dir_walk->path), name);
-                }
+    while(dir_walk->depth > 0) {
+        // directory that failed to open is reported once, after its own entry
+        if(dir_walk->error != FSE_OK) {
+            return DirWalkError;
+        }
 
-                if(fileinfo != NULL) {
-                    memcpy(fileinfo, &info, sizeof(FileInfo));
+        DirWalkFrame* frame = DirWalkFrameArray_get(dir_walk->frames, dir_walk->depth - 1);
+
+        if(frame->records_left == 0) {
+            frame->records_left =
+                storage_dir_read_batch(frame->file, frame->batch, DIR_WALK_BATCH_SIZE);
+            frame->record = (StorageDirRecord*)frame->batch;
+
+            if(frame->records_left == 0) {
+                FS_Error error = storage_file_get_error(frame->file);
+                if(error != FSE_NOT_EXIST) {
+                    dir_walk->error = error;
+                    return DirWalkError;
+                } else if(dir_walk->depth == 1) {
+                    // keep the root open, like a plain directory read does
+                    dir_walk->error = error;
+                    return DirWalkLast;
+                } else {
+                    // step out
+                    dir_walk_pop(dir_walk);
+                    continue;
                 }
-
-                end = true;
             }
+        }
 
-            if((info.flags & FSF_DIRECTORY) && dir_walk->recursive) {
-                // step into
-                DirIndexList_push_back(dir_walk->index_list, dir_walk->current_index);
-                dir_walk->current_index = 0;
-                storage_dir_close(dir_walk->file);
+        StorageDirRecord* record = frame->record;
+        frame->record = storage_dir_record_next(record);
+        frame->records_left--;
 
-                furi_string_cat_printf(dir_walk->path, "/%s", name);
-                storage_dir_open(dir_walk->file, furi_string_get_cstr(dir_walk->path));
+        bool matched = dir_walk_filter(dir_walk, record->name, &record->fileinfo);
+        if(matched) {
+            if(return_path != NULL) {
+                furi_string_printf(
+                    return_path, "%s/%s", furi_string_get_cstr(dir_walk->path), record->name);
             }
-        } else if(storage_file_get_error(dir_walk->file) == FSE_NOT_EXIST) {
-            if(DirIndexList_size(dir_walk->index_list) == 0) {
-                // last
-                result = DirWalkLast;
-                end = true;
-            } else {
-                // step out
-                uint32_t index;
-                DirIndexList_pop_back(&index, dir_walk->index_list);
-                dir_walk->current_index = 0;
-
-                storage_dir_close(dir_walk->file);
-
-                size_t last_char = furi_string_search_rchar(dir_walk->path, '/');
-                if(last_char != FURI_STRING_FAILURE) {
-                    furi_string_left(dir_walk->path, last_char);
-                }
 
-                storage_dir_open(dir_walk->file, furi_string_get_cstr(dir_walk->path));
-
-                // rewind
-                while(true) {
-                    if(index == dir_walk->current_index) {
-                        result = DirWalkOK;
-                        break;
-                    }
+            if(fileinfo != NULL) {
+                memcpy(fileinfo, &record->fileinfo, sizeof(FileInfo));
+            }
+        }
 
-                    if(!storage_dir_read(dir_walk->file, &info, name, 255)) {
-                        result = DirWalkError;
-                        end = true;
-                        break;
-                    }
+        if((record->fileinfo.flags & FSF_DIRECTORY) && dir_walk->recursive) {
+            // step into, record memory stays valid: every frame owns its batch
+            furi_string_cat_printf(dir_walk->path, "/%s", record->name);
+            dir_walk_push(dir_walk);
+        }
 
-                    dir_walk->current_index++;
-                }
-            }
-        } else {
-            result = DirWalkError;
-            end = true;
+        if(matched) {
+            return DirWalkOK;
         }
     }
 
-    free(name);
-    return result;
+    return DirWalkError;
 }
 
 FS_Error dir_walk_get_error(DirWalk* dir_walk) {
-    return storage_file_get_error(dir_walk->file);
+    return dir_walk->error;
 }
 
 DirWalkResult dir_walk_read(DirWalk* dir_walk, FuriString* return_path, FileInfo* fileinfo) {
@@ -144,11 +179,10 @@ DirWalkResult dir_walk_read(DirWalk* dir_walk, FuriString* return_path, FileInfo
 }
 
 void dir_walk_close(DirWalk* dir_walk) {
-    if(storage_file_is_open(dir_walk->file)) {
-        storage_dir_close(dir_walk->file);
+    while(dir_walk->depth > 0) {
+        dir_walk_pop(dir_walk);
     }
 
-    DirIndexList_reset(dir_walk->index_list);
     furi_string_reset(dir_walk->path);
-    dir_walk->current_index = 0;
+    dir_walk->error = FSE_OK;
 }
@@ -0,0 +1,310 @@
+#include "hash_cache.h"
+#include "crc32_calc.h"
+#include "md5.h"
+
+#include <furi.h>
+
+#define TAG "HashCache"
+
+#define HASH_CACHE_SLOTS 512
+#define HASH_CACHE_CHUNK_SIZE_MAX 4096
+#define HASH_CACHE_CHUNK_SIZE_MIN 512
+#define HASH_CACHE_READER_STACK_SIZE 1024
+#define HASH_CACHE_PENDING_MAX 16
+#define HASH_CACHE_FLUSH_DELAY_MS 5000
+
+typedef struct {
+    uint32_t path_hash;
+    uint32_t path_crc;
+    uint32_t size;
+    uint32_t generation;
+    HashCacheDigest digest;
+    uint32_t entry_crc;
+} HashCacheEntry;
+
+typedef struct {
+    File* file;
+    uint8_t* buffers[2];
+    size_t sizes[2];
+    size_t chunk_size;
+    FuriMessageQueue* filled;
+    FuriMessageQueue* empty;
+} HashCacheReader;
+
+/** New entries are written in batches, so a burst of misses costs one file update */
+typedef struct {
+    FuriMutex* mutex;
+    FuriWork* flush;
+    HashCacheEntry entries[HASH_CACHE_PENDING_MAX];
+    size_t count;
+} HashCachePending;
+
+static HashCachePending* hash_cache_pending = NULL;
+
+static uint32_t hash_cache_path_hash(const char* path) {
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    while(*path) {
+        hash ^= (uint8_t)*path++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t hash_cache_entry_crc(const HashCacheEntry* entry) {
+    return crc32_calc_buffer(0, entry, offsetof(HashCacheEntry, entry_crc));
+}
+
+static bool hash_cache_load(Storage* storage, uint32_t slot, HashCacheEntry* entry) {
+    File* file = storage_file_alloc(storage);
+    bool result = false;
+
+    if(storage_file_open(file, STORAGE_HASH_CACHE_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_seek(file, slot * sizeof(HashCacheEntry), true) &&
+       storage_file_read(file, entry, sizeof(HashCacheEntry)) == sizeof(HashCacheEntry)) {
+        result = (entry->entry_crc == hash_cache_entry_crc(entry));
+    }
+
+    storage_file_free(file);
+    return result;
+}
+
+static void hash_cache_flush(void* context) {
+    HashCachePending* pending = context;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    furi_check(furi_mutex_acquire(pending->mutex, FuriWaitForever) == FuriStatusOk);
+    if(!storage_file_open(file, STORAGE_HASH_CACHE_PATH, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS)) {
+        FURI_LOG_W(TAG, "Store failed: %s", storage_file_get_error_desc(file));
+    } else {
+        for(size_t i = 0; i < pending->count; i++) {
+            HashCacheEntry* entry = &pending->entries[i];
+            uint32_t slot = entry->path_hash % HASH_CACHE_SLOTS;
+            /* Seek past the end grows the file, skipped slots read back with wrong crc */
+            if(!storage_file_seek(file, slot * sizeof(HashCacheEntry), true) ||
+               storage_file_write(file, entry, sizeof(HashCacheEntry)) !=
+                   sizeof(HashCacheEntry)) {
+                FURI_LOG_W(TAG, "Store failed: %s", storage_file_get_error_desc(file));
+                break;
+            }
+        }
+    }
+    pending->count = 0;
+    furi_check(furi_mutex_release(pending->mutex) == FuriStatusOk);
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static HashCachePending* hash_cache_pending_get() {
+    if(hash_cache_pending) return hash_cache_pending;
+
+    HashCachePending* pending = malloc(sizeof(HashCachePending));
+    pending->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    pending->flush = furi_work_alloc(furi_work_queue_get_system(), hash_cache_flush, pending);
+    pending->count = 0;
+
+    bool installed = false;
+    FURI_CRITICAL_ENTER();
+    if(!hash_cache_pending) {
+        hash_cache_pending = pending;
+        installed = true;
+    }
+    FURI_CRITICAL_EXIT();
+
+    if(!installed) {
+        furi_work_free(pending->flush);
+        furi_mutex_free(pending->mutex);
+        free(pending);
+    }
+    return hash_cache_pending;
+}
+
+static bool hash_cache_find_pending(HashCacheEntry* entry) {
+    HashCachePending* pending = hash_cache_pending_get();
+    bool result = false;
+
+    furi_check(furi_mutex_acquire(pending->mutex, FuriWaitForever) == FuriStatusOk);
+    for(size_t i = pending->count; i > 0; i--) {
+        if(pending->entries[i - 1].path_hash == entry->path_hash) {
+            *entry = pending->entries[i - 1];
+            result = true;
+            break;
+        }
+    }
+    furi_check(furi_mutex_release(pending->mutex) == FuriStatusOk);
+
+    return result;
+}
+
+static void hash_cache_store(HashCacheEntry* entry) {
+    HashCachePending* pending = hash_cache_pending_get();
+    entry->entry_crc = hash_cache_entry_crc(entry);
+
+    furi_check(furi_mutex_acquire(pending->mutex, FuriWaitForever) == FuriStatusOk);
+    size_t index = 0;
+    while(index < pending->count && pending->entries[index].path_hash != entry->path_hash) {
+        index++;
+    }
+    if(index == HASH_CACHE_PENDING_MAX) {
+        /* Flush is already submitted and will take the lock shortly */
+        index = HASH_CACHE_PENDING_MAX - 1;
+    } else if(index == pending->count) {
+        pending->count++;
+    }
+    pending->entries[index] = *entry;
+    bool full = (pending->count == HASH_CACHE_PENDING_MAX);
+    furi_check(furi_mutex_release(pending->mutex) == FuriStatusOk);
+
+    if(full) {
+        furi_work_submit(pending->flush);
+    } else {
+        furi_work_submit_delayed(pending->flush, furi_ms_to_ticks(HASH_CACHE_FLUSH_DELAY_MS));
+    }
+}
+
+static int32_t hash_cache_reader_thread(void* context) {
+    HashCacheReader* reader = context;
+    uint8_t index;
+
+    do {
+        furi_check(
+            furi_message_queue_get(reader->empty, &index, FuriWaitForever) == FuriStatusOk);
+        reader->sizes[index] =
+            storage_file_read(reader->file, reader->buffers[index], reader->chunk_size);
+        furi_check(
+            furi_message_queue_put(reader->filled, &index, FuriWaitForever) == FuriStatusOk);
+    } while(reader->sizes[index] == reader->chunk_size);
+
+    return 0;
+}
+
+static void hash_cache_digest_update(
+    md5_context* md5_ctx,
+    HashCacheDigest* digest,
+    const uint8_t* data,
+    size_t size) {
+    md5_update(md5_ctx, data, size);
+    digest->crc32 = crc32_calc_buffer(digest->crc32, data, size);
+}
+
+static FS_Error
+    hash_cache_compute(Storage* storage, const char* path, uint64_t size, HashCacheDigest* digest) {
+    File* file = storage_file_alloc(storage);
+    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FS_Error error = storage_file_get_error(file);
+        storage_file_free(file);
+        return error;
+    }
+
+    size_t chunk_size = memmgr_heap_get_max_free_block() / 4;
+    chunk_size = CLAMP(chunk_size, HASH_CACHE_CHUNK_SIZE_MAX, HASH_CACHE_CHUNK_SIZE_MIN);
+    chunk_size &= ~(HASH_CACHE_CHUNK_SIZE_MIN - 1);
+
+    md5_context* md5_ctx = malloc(sizeof(md5_context));
+    md5_starts(md5_ctx);
+    digest->crc32 = 0;
+
+    if(size <= chunk_size) {
+        uint8_t* buffer = malloc(chunk_size);
+        size_t read_size;
+        do {
+            read_size = storage_file_read(file, buffer, chunk_size);
+            hash_cache_digest_update(md5_ctx, digest, buffer, read_size);
+        } while(read_size == chunk_size);
+        free(buffer);
+    } else {
+        /* Next chunk is read by another thread while this one is hashed */
+        HashCacheReader reader = {
+            .file = file,
+            .buffers = {malloc(chunk_size), malloc(chunk_size)},
+            .chunk_size = chunk_size,
+            .filled = furi_message_queue_alloc(2, sizeof(uint8_t)),
+            .empty = furi_message_queue_alloc(2, sizeof(uint8_t)),
+        };
+        for(uint8_t index = 0; index < 2; index++) {
+            furi_message_queue_put(reader.empty, &index, 0);
+        }
+
+        FuriThread* thread = furi_thread_alloc_ex(
+            "HashCacheReader", HASH_CACHE_READER_STACK_SIZE, hash_cache_reader_thread, &reader);
+        furi_thread_start(thread);
+
+        uint8_t index;
+        size_t read_size;
+        do {
+            furi_check(
+                furi_message_queue_get(reader.filled, &index, FuriWaitForever) == FuriStatusOk);
+            /* Buffer and its size belong to reader again once index is returned */
+            read_size = reader.sizes[index];
+            hash_cache_digest_update(md5_ctx, digest, reader.buffers[index], read_size);
+            furi_message_queue_put(reader.empty, &index, 0);
+        } while(read_size == chunk_size);
+
+        furi_thread_join(thread);
+        furi_thread_free(thread);
+        furi_message_queue_free(reader.filled);
+        furi_message_queue_free(reader.empty);
+        free(reader.buffers[0]);
+        free(reader.buffers[1]);
+    }
+
+    md5_finish(md5_ctx, digest->md5);
+    free(md5_ctx);
+
+    FS_Error error = storage_file_get_error(file);
+    storage_file_close(file);
+    storage_file_free(file);
+    return error;
+}
+
+FS_Error hash_cache_get(Storage* storage, const char* path, HashCacheDigest* digest) {
+    furi_assert(storage);
+    furi_assert(path);
+    furi_assert(digest);
+
+    FileInfo fileinfo;
+    FS_Error error = storage_common_stat(storage, path, &fileinfo);
+    if(error != FSE_OK) {
+        return error;
+    } else if(fileinfo.flags & FSF_DIRECTORY) {
+        return FSE_INVALID_PARAMETER;
+    }
+
+    HashCacheEntry entry = {
+        .path_hash = hash_cache_path_hash(path),
+        .path_crc = crc32_calc_buffer(0, path, strlen(path)),
+        .size = fileinfo.size,
+    };
+    uint32_t slot = entry.path_hash % HASH_CACHE_SLOTS;
+
+    bool cacheable = (fileinfo.size <= UINT32_MAX) &&
+                     (storage_sd_status(storage) == FSE_OK) &&
+                     (strcmp(path, STORAGE_HASH_CACHE_PATH) != 0) &&
+                     (storage_common_generation(storage, path, &entry.generation) == FSE_OK);
+
+    if(cacheable) {
+        HashCacheEntry cached = {.path_hash = entry.path_hash};
+        if((hash_cache_find_pending(&cached) || hash_cache_load(storage, slot, &cached)) &&
+           cached.path_hash == entry.path_hash &&
+           cached.path_crc == entry.path_crc && cached.size == entry.size &&
+           cached.generation == entry.generation) {
+            *digest = cached.digest;
+            return FSE_OK;
+        }
+    }
+
+    error = hash_cache_compute(storage, path, fileinfo.size, digest);
+
+    /* Only store what was computed from a file that didn't change meanwhile */
+    uint32_t generation;
+    if(error == FSE_OK && cacheable &&
+       storage_common_generation(storage, path, &generation) == FSE_OK &&
+       generation == entry.generation) {
+        entry.digest = *digest;
+        hash_cache_store(&entry);
+    }
+
+    return error;
+}
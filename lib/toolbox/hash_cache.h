@@ -0,0 +1,38 @@
+/**
+ * @file hash_cache.h
+ * File digests with a cache on SD card
+ *
+ * Digests are stored in STORAGE_HASH_CACHE_PATH, keyed by path, size and storage
+ * write generation. Unchanged files are answered without reading them, entries
+ * don't survive reboot or card remount. New entries are kept in RAM and
+ * written to the card in batches, a few seconds after the first one.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HASH_CACHE_MD5_SIZE 16
+
+typedef struct {
+    uint8_t md5[HASH_CACHE_MD5_SIZE];
+    uint32_t crc32; /**< Same as crc32_calc_file() */
+} HashCacheDigest;
+
+/** Get digests of file contents
+ *
+ * @param      storage  The storage instance
+ * @param      path     path to file
+ * @param      digest   digests of file contents
+ *
+ * @return     FSE_OK or error of file read
+ */
+FS_Error hash_cache_get(Storage* storage, const char* path, HashCacheDigest* digest);
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,6 +26,7 @@
  *
  */
 #include <stdint.h>
+#include <string.h>
 
 #include "sha256.h"
 #include "hmac_sha256.h"
@@ -76,13 +77,17 @@ static void hmac_finish(const hmac_context* ctx, const uint8_t* K, uint8_t* resu
     ctx->finish_hash(ctx, result);
 }
 
-void hmac_sha256_init(hmac_sha256_context* ctx, const uint8_t* K) {
+static void hmac_sha256_setup(hmac_sha256_context* ctx) {
     ctx->hmac_ctx.init_hash = _hmac_sha256_init;
     ctx->hmac_ctx.update_hash = _hmac_sha256_update;
     ctx->hmac_ctx.finish_hash = _hmac_sha256_finish;
     ctx->hmac_ctx.block_size = 64;
     ctx->hmac_ctx.result_size = 32;
     ctx->hmac_ctx.tmp = ctx->tmp;
+}
+
+void hmac_sha256_init(hmac_sha256_context* ctx, const uint8_t* K) {
+    hmac_sha256_setup(ctx);
     hmac_init(&ctx->hmac_ctx, K);
 }
 
@@ -96,3 +101,36 @@ void hmac_sha256_update(
 void hmac_sha256_finish(const hmac_sha256_context* ctx, const uint8_t* K, uint8_t* hash_result) {
     hmac_finish(&ctx->hmac_ctx, K, hash_result);
 }
+
+void hmac_sha256_key_init(hmac_sha256_key* key, const uint8_t* K) {
+    uint8_t pad[SHA256_BLOCK_SIZE];
+    unsigned i;
+
+    for(i = 0; i < SHA256_DIGEST_SIZE; ++i) pad[i] = K[i] ^ 0x36;
+    for(; i < SHA256_BLOCK_SIZE; ++i) pad[i] = 0x36;
+    sha256_start(&key->inner);
+    sha256_update(&key->inner, pad, SHA256_BLOCK_SIZE);
+
+    for(i = 0; i < SHA256_DIGEST_SIZE; ++i) pad[i] = K[i] ^ 0x5c;
+    for(; i < SHA256_BLOCK_SIZE; ++i) pad[i] = 0x5c;
+    sha256_start(&key->outer);
+    sha256_update(&key->outer, pad, SHA256_BLOCK_SIZE);
+
+    memset(pad, 0, sizeof(pad));
+}
+
+void hmac_sha256_key_start(hmac_sha256_context* ctx, const hmac_sha256_key* key) {
+    hmac_sha256_setup(ctx);
+    memcpy(&ctx->sha_ctx, &key->inner, sizeof(sha256_context));
+}
+
+void hmac_sha256_key_finish(
+    hmac_sha256_context* ctx,
+    const hmac_sha256_key* key,
+    uint8_t* hash_result) {
+    sha256_finish(&ctx->sha_ctx, hash_result);
+
+    memcpy(&ctx->sha_ctx, &key->outer, sizeof(sha256_context));
+    sha256_update(&ctx->sha_ctx, hash_result, SHA256_DIGEST_SIZE);
+    sha256_finish(&ctx->sha_ctx, hash_result);
+}
@@ -24,6 +24,12 @@ typedef struct hmac_sha256_context {
     uint8_t tmp[32 * 2 + 64];
 } hmac_sha256_context;
 
+/* Inner and outer hash states after padded key block, for a key used many times */
+typedef struct hmac_sha256_key {
+    sha256_context inner;
+    sha256_context outer;
+} hmac_sha256_key;
+
 void hmac_sha256_init(hmac_sha256_context* ctx, const uint8_t* K);
 
 void hmac_sha256_update(
@@ -33,6 +39,16 @@ void hmac_sha256_update(
 
 void hmac_sha256_finish(const hmac_sha256_context* ctx, const uint8_t* K, uint8_t* hash_result);
 
+void hmac_sha256_key_init(hmac_sha256_key* key, const uint8_t* K);
+
+/* Same as hmac_sha256_init, but skips hashing of the key block */
+void hmac_sha256_key_start(hmac_sha256_context* ctx, const hmac_sha256_key* key);
+
+void hmac_sha256_key_finish(
+    hmac_sha256_context* ctx,
+    const hmac_sha256_key* key,
+    uint8_t* hash_result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -98,6 +98,10 @@ void md5_starts(md5_context* ctx) {
 void md5_process(md5_context* ctx, const unsigned char data[64]) {
     uint32_t X[16], A, B, C, D;
 
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    /* Block is already in host order: whole words instead of byte assembly */
+    memcpy(X, data, sizeof(X));
+#else
     GET_UINT32_LE(X[0], data, 0);
     GET_UINT32_LE(X[1], data, 4);
     GET_UINT32_LE(X[2], data, 8);
@@ -114,6 +118,7 @@ void md5_process(md5_context* ctx, const unsigned char data[64]) {
     GET_UINT32_LE(X[13], data, 52);
     GET_UINT32_LE(X[14], data, 56);
     GET_UINT32_LE(X[15], data, 60);
+#endif
 
 #define S(x, n) ((x << n) | ((x & 0xFFFFFFFF) >> (32 - n)))
 
@@ -149,7 +154,15 @@ void md5_process(md5_context* ctx, const unsigned char data[64]) {
 
 #undef F
 
-#define F(x, y, z) (y ^ (z & (x ^ y)))
+/* (x & z) | (y & ~z): terms never share bits, so they are added separately and
+ * the two ands don't depend on each other */
+#undef P
+#define P(a, b, c, d, k, s, t)    \
+    {                             \
+        a += X[k] + t + (c & ~d); \
+        a += (b & d);             \
+        a = S(a, s) + b;          \
+    }
 
     P(A, B, C, D, 1, 5, 0xF61E2562);
     P(D, A, B, C, 6, 9, 0xC040B340);
@@ -168,7 +181,12 @@ void md5_process(md5_context* ctx, const unsigned char data[64]) {
     P(C, D, A, B, 7, 14, 0x676F02D9);
     P(B, C, D, A, 12, 20, 0x8D2A4C8A);
 
-#undef F
+#undef P
+#define P(a, b, c, d, k, s, t)      \
+    {                               \
+        a += F(b, c, d) + X[k] + t; \
+        a = S(a, s) + b;            \
+    }
 
 #define F(x, y, z) (x ^ y ^ z)
 
@@ -177,7 +177,7 @@ void sha256_finish(sha256_context* ctx, unsigned char output[32]) {
 
     ctx->wbuf[last >> 2] = __builtin_bswap32(ctx->wbuf[last >> 2]);
     ctx->wbuf[last >> 2] &= 0xffffff80 << (8 * (~last & 3));
-    ctx->wbuf[last >> 2] |= 0x00000080 << (8 * (~last & 3));
+    ctx->wbuf[last >> 2] |= 0x00000080U << (8 * (~last & 3));
     ctx->wbuf[last >> 2] = __builtin_bswap32(ctx->wbuf[last >> 2]);
 
     if(last > SHA256_BLOCK_SIZE - 9) {
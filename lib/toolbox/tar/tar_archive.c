@@ -1,4 +1,5 @@
 #include "tar_archive.h"
+#include "tar_stream.h"
 
 #include <microtar.h>
 #include <storage/storage.h>
@@ -6,8 +7,11 @@
 #include <toolbox/path.h>
 
 #define TAG "TarArch"
-#define MAX_NAME_LEN 255
+#define DIR_BATCH_SIZE 1024
 #define FILE_BLOCK_SIZE 512
+/* Chunk for copying file data in and out of archive */
+#define FILE_COPY_CHUNK_SIZE 4096
+#define TAR_END_RECORDS_SIZE (2 * FILE_BLOCK_SIZE)
 
 #define FILE_OPEN_NTRIES 10
 #define FILE_OPEN_RETRY_DELAY 25
@@ -17,30 +21,34 @@ typedef struct TarArchive {
     mtar_t tar;
     tar_unpack_file_cb unpack_cb;
     void* unpack_cb_context;
+    /* Current header offset for tar_archive_unpack_file_at, if valid */
+    bool cursor_valid;
+    uint32_t cursor_offset;
 } TarArchive;
 
 /* API WRAPPER */
 static int mtar_storage_file_write(void* stream, const void* data, unsigned size) {
-    uint16_t bytes_written = storage_file_write(stream, data, size);
-    return (bytes_written == size) ? bytes_written : MTAR_EWRITEFAIL;
+    int32_t bytes_written = tar_stream_write(stream, data, size);
+    return (bytes_written == (int32_t)size) ? bytes_written : MTAR_EWRITEFAIL;
 }
 
 static int mtar_storage_file_read(void* stream, void* data, unsigned size) {
-    uint16_t bytes_read = storage_file_read(stream, data, size);
-    return (bytes_read == size) ? bytes_read : MTAR_EREADFAIL;
+    int32_t bytes_read = tar_stream_read(stream, data, size);
+    return (bytes_read == (int32_t)size) ? bytes_read : MTAR_EREADFAIL;
 }
 
 static int mtar_storage_file_seek(void* stream, unsigned offset) {
-    bool res = storage_file_seek(stream, offset, true);
+    bool res = tar_stream_seek(stream, offset);
     return res ? MTAR_ESUCCESS : MTAR_ESEEKFAIL;
 }
 
 static int mtar_storage_file_close(void* stream) {
+    bool res = true;
     if(stream) {
-        storage_file_close(stream);
-        storage_file_free(stream);
+        res = tar_stream_flush(stream);
+        tar_stream_free(stream);
     }
-    return MTAR_ESUCCESS;
+    return res ? MTAR_ESUCCESS : MTAR_EWRITEFAIL;
 }
 
 const struct mtar_ops filesystem_ops = {
@@ -55,6 +63,7 @@ TarArchive* tar_archive_alloc(Storage* storage) {
     TarArchive* archive = malloc(sizeof(TarArchive));
     archive->storage = storage;
     archive->unpack_cb = NULL;
+    archive->cursor_valid = false;
     return archive;
 }
 
@@ -66,6 +75,7 @@ bool tar_archive_open(TarArchive* archive, const char* path, TarOpenMode mode) {
 
     switch(mode) {
     case TAR_OPEN_MODE_READ:
+    case TAR_OPEN_MODE_READ_HEATSHRINK:
         mtar_access = MTAR_READ;
         access_mode = FSAM_READ;
         open_mode = FSOM_OPEN_EXISTING;
@@ -75,20 +85,56 @@ bool tar_archive_open(TarArchive* archive, const char* path, TarOpenMode mode) {
         access_mode = FSAM_WRITE;
         open_mode = FSOM_CREATE_ALWAYS;
         break;
+    case TAR_OPEN_MODE_APPEND:
+        mtar_access = MTAR_WRITE;
+        access_mode = FSAM_READ_WRITE;
+        open_mode = FSOM_OPEN_EXISTING;
+        break;
     default:
         return false;
     }
 
-    File* stream = storage_file_alloc(archive->storage);
-    if(!storage_file_open(stream, path, access_mode, open_mode)) {
-        storage_file_free(stream);
+    File* file = storage_file_alloc(archive->storage);
+    if(!storage_file_open(file, path, access_mode, open_mode)) {
+        storage_file_free(file);
+        return false;
+    }
+
+    uint32_t position = 0;
+    if(mode == TAR_OPEN_MODE_APPEND) {
+        /* Archive ends with two zeroed records, new entries go in their place */
+        uint64_t size = storage_file_size(file);
+        if((size < TAR_END_RECORDS_SIZE) || (size % FILE_BLOCK_SIZE)) {
+            storage_file_close(file);
+            storage_file_free(file);
+            return false;
+        }
+        position = size - TAR_END_RECORDS_SIZE;
+    }
+
+    TarStream* stream = tar_stream_alloc(file, mode == TAR_OPEN_MODE_READ_HEATSHRINK);
+    if(!stream) {
         return false;
     }
+    tar_stream_seek(stream, position);
+
     mtar_init(&archive->tar, mtar_access, &filesystem_ops, stream);
+    archive->tar.pos = position;
+    archive->cursor_valid = false;
 
     return true;
 }
 
+TarOpenMode tar_archive_get_mode_for_path(const char* path) {
+    furi_assert(path);
+    FuriString* path_str = furi_string_alloc_set(path);
+    char ext[8] = {0};
+    path_extract_extension(path_str, ext, sizeof(ext));
+    furi_string_free(path_str);
+    bool is_heatshrink = strcmp(ext, TAR_HEATSHRINK_EXTENSION) == 0;
+    return is_heatshrink ? TAR_OPEN_MODE_READ_HEATSHRINK : TAR_OPEN_MODE_READ;
+}
+
 void tar_archive_free(TarArchive* archive) {
     furi_assert(archive);
     if(mtar_is_open(&archive->tar)) {
@@ -112,6 +158,8 @@ static int tar_archive_entry_counter(mtar_t* tar, const mtar_header_t* header, v
 }
 
 int32_t tar_archive_get_entries_count(TarArchive* archive) {
+    furi_assert(archive);
+    archive->cursor_valid = false;
     int32_t counter = 0;
     if(mtar_foreach(&archive->tar, tar_archive_entry_counter, &counter) != MTAR_ESUCCESS) {
         counter = -1;
@@ -126,7 +174,19 @@ bool tar_archive_dir_add_element(TarArchive* archive, const char* dirpath) {
 
 bool tar_archive_finalize(TarArchive* archive) {
     furi_assert(archive);
-    return (mtar_finalize(&archive->tar) == MTAR_ESUCCESS);
+    /* Archive must be complete on disk once this returns, not on close */
+    return (mtar_finalize(&archive->tar) == MTAR_ESUCCESS) &&
+           tar_stream_flush(archive->tar.stream);
+}
+
+void tar_archive_get_read_progress(TarArchive* archive, uint32_t* processed, uint32_t* total) {
+    furi_assert(archive);
+    tar_stream_get_file_progress(archive->tar.stream, processed, total);
+}
+
+uint32_t tar_archive_get_position(TarArchive* archive) {
+    furi_assert(archive);
+    return archive->tar.pos;
 }
 
 bool tar_archive_store_data(
@@ -171,7 +231,7 @@ typedef struct {
 static bool archive_extract_current_file(TarArchive* archive, const char* dst_path) {
     mtar_t* tar = &archive->tar;
     File* out_file = storage_file_alloc(archive->storage);
-    uint8_t* readbuf = malloc(FILE_BLOCK_SIZE);
+    uint8_t* readbuf = malloc(FILE_COPY_CHUNK_SIZE);
 
     bool success = true;
     uint8_t n_tries = FILE_OPEN_NTRIES;
@@ -191,8 +251,8 @@ static bool archive_extract_current_file(TarArchive* archive, const char* dst_pa
         }
 
         while(!mtar_eof_data(tar)) {
-            int32_t readcnt = mtar_read_data(tar, readbuf, FILE_BLOCK_SIZE);
-            if(!readcnt || !storage_file_write(out_file, readbuf, readcnt)) {
+            int32_t readcnt = mtar_read_data(tar, readbuf, FILE_COPY_CHUNK_SIZE);
+            if(readcnt <= 0 || storage_file_write(out_file, readbuf, readcnt) != readcnt) {
                 success = false;
                 break;
             }
@@ -266,6 +326,7 @@ bool tar_archive_unpack_to(
     };
 
     FURI_LOG_I(TAG, "Restoring '%s'", destination);
+    archive->cursor_valid = false;
 
     return (mtar_foreach(&archive->tar, archive_extract_foreach_cb, &param) == MTAR_ESUCCESS);
 };
@@ -276,7 +337,7 @@ bool tar_archive_add_file(
     const char* archive_fname,
     const int32_t file_size) {
     furi_assert(archive);
-    uint8_t* file_buffer = malloc(FILE_BLOCK_SIZE);
+    uint8_t* file_buffer = malloc(FILE_COPY_CHUNK_SIZE);
     bool success = false;
     File* src_file = storage_file_alloc(archive->storage);
     uint8_t n_tries = FILE_OPEN_NTRIES;
@@ -297,7 +358,7 @@ bool tar_archive_add_file(
 
         success = true; // if file is empty, that's not an error
         uint16_t bytes_read = 0;
-        while((bytes_read = storage_file_read(src_file, file_buffer, FILE_BLOCK_SIZE))) {
+        while((bytes_read = storage_file_read(src_file, file_buffer, FILE_COPY_CHUNK_SIZE))) {
             success = tar_archive_file_add_data_block(archive, file_buffer, bytes_read);
             if(!success) {
                 break;
@@ -316,10 +377,9 @@ bool tar_archive_add_dir(TarArchive* archive, const char* fs_full_path, const ch
     furi_assert(archive);
     furi_check(path_prefix);
     File* directory = storage_file_alloc(archive->storage);
-    FileInfo file_info;
 
     FURI_LOG_I(TAG, "Backing up '%s', '%s'", fs_full_path, path_prefix);
-    char* name = malloc(MAX_NAME_LEN);
+    uint8_t* batch = malloc(DIR_BATCH_SIZE);
     bool success = false;
 
     do {
@@ -327,46 +387,55 @@ bool tar_archive_add_dir(TarArchive* archive, const char* fs_full_path, const ch
             break;
         }
 
+        FuriString* element_name = furi_string_alloc();
+        FuriString* element_fs_abs_path = furi_string_alloc();
+
         while(true) {
-            if(!storage_dir_read(directory, &file_info, name, MAX_NAME_LEN)) {
+            uint16_t count = storage_dir_read_batch(directory, batch, DIR_BATCH_SIZE);
+            if(!count) {
                 success = true; /* empty dir / no more files */
                 break;
             }
 
-            FuriString* element_name = furi_string_alloc();
-            FuriString* element_fs_abs_path = furi_string_alloc();
-
-            path_concat(fs_full_path, name, element_fs_abs_path);
-            if(strlen(path_prefix)) {
-                path_concat(path_prefix, name, element_name);
-            } else {
-                furi_string_set(element_name, name);
-            }
-
-            if(file_info.flags & FSF_DIRECTORY) {
-                success =
-                    tar_archive_dir_add_element(archive, furi_string_get_cstr(element_name)) &&
-                    tar_archive_add_dir(
+            StorageDirRecord* record = (StorageDirRecord*)batch;
+            for(uint16_t i = 0; i < count; i++, record = storage_dir_record_next(record)) {
+                path_concat(fs_full_path, record->name, element_fs_abs_path);
+                if(strlen(path_prefix)) {
+                    path_concat(path_prefix, record->name, element_name);
+                } else {
+                    furi_string_set(element_name, record->name);
+                }
+
+                if(record->fileinfo.flags & FSF_DIRECTORY) {
+                    success =
+                        tar_archive_dir_add_element(archive, furi_string_get_cstr(element_name)) &&
+                        tar_archive_add_dir(
+                            archive,
+                            furi_string_get_cstr(element_fs_abs_path),
+                            furi_string_get_cstr(element_name));
+                } else {
+                    success = tar_archive_add_file(
                         archive,
                         furi_string_get_cstr(element_fs_abs_path),
-                        furi_string_get_cstr(element_name));
-            } else {
-                success = tar_archive_add_file(
-                    archive,
-                    furi_string_get_cstr(element_fs_abs_path),
-                    furi_string_get_cstr(element_name),
-                    file_info.size);
+                        furi_string_get_cstr(element_name),
+                        record->fileinfo.size);
+                }
+
+                if(!success) {
+                    break;
+                }
             }
-            furi_string_free(element_name);
-            furi_string_free(element_fs_abs_path);
 
             if(!success) {
                 break;
             }
         }
+
+        furi_string_free(element_name);
+        furi_string_free(element_fs_abs_path);
     } while(false);
 
-    free(name);
+    free(batch);
     storage_file_free(directory);
     return success;
 }
@@ -378,8 +447,39 @@ bool tar_archive_unpack_file(
     furi_assert(archive);
     furi_assert(archive_fname);
     furi_assert(destination);
+    archive->cursor_valid = false;
     if(mtar_find(&archive->tar, archive_fname) != MTAR_ESUCCESS) {
         return false;
     }
     return archive_extract_current_file(archive, destination);
-}
\ No newline at end of file
+}
+
+bool tar_archive_unpack_file_at(TarArchive* archive, uint32_t offset, const char* destination) {
+    furi_assert(archive);
+    furi_assert(destination);
+    mtar_t* tar = &archive->tar;
+
+    int err = MTAR_ESUCCESS;
+    if(!archive->cursor_valid || offset <= archive->cursor_offset) {
+        /* Going back, or current entry data already consumed: walk from start */
+        archive->cursor_offset = 0;
+        err = mtar_rewind(tar);
+        if(err == MTAR_ESUCCESS) {
+            err = mtar_next(tar);
+        }
+    }
+
+    /* Headers are walked without reading file data, skipped by seeking */
+    while(err == MTAR_ESUCCESS && archive->cursor_offset < offset) {
+        uint32_t data_blocks = ROUND_UP_TO(mtar_get_header(tar)->size, FILE_BLOCK_SIZE);
+        archive->cursor_offset += FILE_BLOCK_SIZE * (1 + data_blocks);
+        err = mtar_next(tar);
+    }
+
+    archive->cursor_valid = (err == MTAR_ESUCCESS);
+    if(!archive->cursor_valid || archive->cursor_offset != offset ||
+       mtar_get_header(tar)->type != MTAR_TREG) {
+        return false;
+    }
+    return archive_extract_current_file(archive, destination);
+}
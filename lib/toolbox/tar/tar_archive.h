@@ -12,9 +12,14 @@ typedef struct TarArchive TarArchive;
 
 typedef struct Storage Storage;
 
+/* Heatshrink compressed archive, see tar_stream.h for format */
+#define TAR_HEATSHRINK_EXTENSION ".ths"
+
 typedef enum {
     TAR_OPEN_MODE_READ = 'r',
+    TAR_OPEN_MODE_READ_HEATSHRINK = 'h',
     TAR_OPEN_MODE_WRITE = 'w',
+    TAR_OPEN_MODE_APPEND = 'a', /* new entries replace end-of-archive records */
     TAR_OPEN_MODE_STDOUT = 's' /* to be implemented */
 } TarOpenMode;
 
@@ -22,6 +27,9 @@ TarArchive* tar_archive_alloc(Storage* storage);
 
 bool tar_archive_open(TarArchive* archive, const char* path, TarOpenMode mode);
 
+/* Read mode matching archive file extension */
+TarOpenMode tar_archive_get_mode_for_path(const char* path);
+
 void tar_archive_free(TarArchive* archive);
 
 /* High-level API  - assumes archive is open */
@@ -38,13 +46,21 @@ bool tar_archive_add_file(
 
 bool tar_archive_add_dir(TarArchive* archive, const char* fs_full_path, const char* path_prefix);
 
+/* Walks whole archive, for compressed ones that means decoding all of it */
 int32_t tar_archive_get_entries_count(TarArchive* archive);
 
+/* Archive file bytes consumed so far and file size, for progress of a single pass */
+void tar_archive_get_read_progress(TarArchive* archive, uint32_t* processed, uint32_t* total);
+
 bool tar_archive_unpack_file(
     TarArchive* archive,
     const char* archive_fname,
     const char* destination);
 
+/* Unpack file entry which header starts at offset, see tar_archive_get_position.
+ * Walk continues from previous call, increasing offsets take a single pass. */
+bool tar_archive_unpack_file_at(TarArchive* archive, uint32_t offset, const char* destination);
+
 /* Optional per-entry callback on unpacking - return false to skip entry */
 typedef bool (*tar_unpack_file_cb)(const char* name, bool is_directory, void* context);
 
@@ -70,6 +86,9 @@ bool tar_archive_store_data(
 
 bool tar_archive_finalize(TarArchive* archive);
 
+/* Offset in archive file, next header is written there */
+uint32_t tar_archive_get_position(TarArchive* archive);
+
 #ifdef __cplusplus
 }
 #endif
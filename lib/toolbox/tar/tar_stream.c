@@ -0,0 +1,299 @@
+#include "tar_stream.h"
+
+#include <furi.h>
+#include <heatshrink_decoder.h>
+
+#define TAG "TarStream"
+
+#define TAR_STREAM_BUFFER_SIZE 4096
+/* Kept before position on refill: microtar seeks back to header it just read */
+#define TAR_STREAM_KEEP_SIZE 512
+#define TAR_STREAM_INPUT_SIZE 4096
+#define TAR_STREAM_DECODER_INPUT_SIZE 256
+#define TAR_STREAM_DIRECT_CHUNK 0x8000
+
+/*
+ * Read window: buffer holds [window_offset, window_offset + window_size),
+ * file (or decoder) is positioned right after it.
+ * Write window: buffer holds pending bytes for [window_offset, position),
+ * file is positioned at window_offset.
+ */
+struct TarStream {
+    File* file;
+    uint8_t* buffer;
+    uint32_t window_offset;
+    uint32_t window_size;
+    uint32_t position;
+    bool dirty;
+
+    heatshrink_decoder* decoder;
+    uint8_t* decoder_buffer;
+    uint8_t* input;
+    uint32_t input_size;
+    uint32_t input_pos;
+    bool input_finished;
+};
+
+static bool tar_stream_read_header(TarStream* stream) {
+    TarHeatshrinkHeader header;
+    if(storage_file_read(stream->file, &header, sizeof(header)) != sizeof(header) ||
+       header.magic != TAR_HEATSHRINK_MAGIC || header.version != TAR_HEATSHRINK_VERSION) {
+        FURI_LOG_E(TAG, "Invalid heatshrink header");
+        return false;
+    }
+
+    /* Window size comes from the file, check it before it sizes an allocation */
+    if(header.window_sz2 < HEATSHRINK_MIN_WINDOW_BITS ||
+       header.window_sz2 > HEATSHRINK_MAX_WINDOW_BITS ||
+       header.lookahead_sz2 < HEATSHRINK_MIN_LOOKAHEAD_BITS ||
+       header.lookahead_sz2 >= header.window_sz2) {
+        FURI_LOG_E(TAG, "Unsupported window %u/%u", header.window_sz2, header.lookahead_sz2);
+        return false;
+    }
+
+    stream->decoder_buffer = malloc(TAR_STREAM_DECODER_INPUT_SIZE + (1 << header.window_sz2));
+    stream->decoder = heatshrink_decoder_alloc(
+        stream->decoder_buffer,
+        TAR_STREAM_DECODER_INPUT_SIZE,
+        header.window_sz2,
+        header.lookahead_sz2);
+    furi_check(stream->decoder);
+
+    stream->input = malloc(TAR_STREAM_INPUT_SIZE);
+    return true;
+}
+
+TarStream* tar_stream_alloc(File* file, bool heatshrink) {
+    furi_assert(file);
+    TarStream* stream = malloc(sizeof(TarStream));
+    memset(stream, 0, sizeof(TarStream));
+    stream->file = file;
+    stream->buffer = malloc(TAR_STREAM_BUFFER_SIZE);
+
+    if(heatshrink && !tar_stream_read_header(stream)) {
+        tar_stream_free(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+void tar_stream_free(TarStream* stream) {
+    furi_assert(stream);
+    storage_file_close(stream->file);
+    storage_file_free(stream->file);
+    if(stream->decoder) {
+        heatshrink_decoder_free(stream->decoder);
+    }
+    free(stream->decoder_buffer);
+    free(stream->input);
+    free(stream->buffer);
+    free(stream);
+}
+
+static uint32_t tar_stream_decode(TarStream* stream, uint8_t* data, uint32_t size) {
+    uint32_t decoded = 0;
+
+    while(decoded < size) {
+        size_t polled = 0;
+        HSD_poll_res poll_res =
+            heatshrink_decoder_poll(stream->decoder, data + decoded, size - decoded, &polled);
+        decoded += polled;
+        if(poll_res < 0) {
+            break;
+        } else if(poll_res == HSDR_POLL_MORE) {
+            continue;
+        }
+
+        if(stream->input_pos == stream->input_size) {
+            if(stream->input_finished) {
+                break;
+            }
+            stream->input_size =
+                storage_file_read(stream->file, stream->input, TAR_STREAM_INPUT_SIZE);
+            stream->input_pos = 0;
+            if(!stream->input_size) {
+                stream->input_finished = true;
+                if(heatshrink_decoder_finish(stream->decoder) != HSDR_FINISH_MORE) {
+                    break;
+                }
+                continue;
+            }
+        }
+
+        size_t sunk = 0;
+        if(heatshrink_decoder_sink(
+               stream->decoder,
+               stream->input + stream->input_pos,
+               stream->input_size - stream->input_pos,
+               &sunk) < 0) {
+            break;
+        }
+        stream->input_pos += sunk;
+    }
+
+    return decoded;
+}
+
+/* Refill read window, keeping a bit of data before position */
+static bool tar_stream_fill(TarStream* stream) {
+    uint32_t window_end = stream->window_offset + stream->window_size;
+    uint32_t keep = 0;
+    if(stream->position == window_end) {
+        keep = MIN(stream->window_size, (uint32_t)TAR_STREAM_KEEP_SIZE);
+    }
+    memmove(stream->buffer, stream->buffer + stream->window_size - keep, keep);
+    stream->window_offset = window_end - keep;
+    stream->window_size = keep;
+
+    uint8_t* data = stream->buffer + stream->window_size;
+    uint32_t size = TAR_STREAM_BUFFER_SIZE - stream->window_size;
+    uint32_t read_size = stream->decoder ? tar_stream_decode(stream, data, size) :
+                                           storage_file_read(stream->file, data, size);
+    stream->window_size += read_size;
+    return read_size > 0;
+}
+
+/* Continue reading at position outside of read window */
+static bool tar_stream_restart(TarStream* stream) {
+    if(!stream->decoder) {
+        stream->window_offset = stream->position;
+        stream->window_size = 0;
+        return storage_file_seek(stream->file, stream->position, true);
+    }
+
+    FURI_LOG_D(TAG, "Restarting decoder for %lu", stream->position);
+    heatshrink_decoder_reset(stream->decoder);
+    memset(
+        stream->decoder_buffer,
+        0,
+        TAR_STREAM_DECODER_INPUT_SIZE + (1 << stream->decoder->window_sz2));
+    stream->input_size = 0;
+    stream->input_pos = 0;
+    stream->input_finished = false;
+    stream->window_offset = 0;
+    stream->window_size = 0;
+    return storage_file_seek(stream->file, sizeof(TarHeatshrinkHeader), true);
+}
+
+int32_t tar_stream_read(TarStream* stream, void* data, uint32_t size) {
+    furi_assert(stream);
+    if(!tar_stream_flush(stream)) {
+        return -1;
+    }
+
+    uint8_t* out = data;
+    uint32_t done = 0;
+    while(done < size) {
+        uint32_t window_end = stream->window_offset + stream->window_size;
+
+        if(stream->position >= stream->window_offset && stream->position < window_end) {
+            uint32_t chunk = MIN(window_end - stream->position, size - done);
+            memcpy(
+                out + done, stream->buffer + (stream->position - stream->window_offset), chunk);
+            stream->position += chunk;
+            done += chunk;
+        } else if(stream->position < stream->window_offset) {
+            if(!tar_stream_restart(stream)) {
+                return -1;
+            }
+        } else if(!stream->decoder && stream->position > window_end) {
+            /* Plain archive, skip without reading */
+            if(!tar_stream_restart(stream)) {
+                return -1;
+            }
+        } else if(!stream->decoder && size - done >= TAR_STREAM_BUFFER_SIZE) {
+            /* Large read, bypass window */
+            uint32_t chunk = MIN(size - done, (uint32_t)TAR_STREAM_DIRECT_CHUNK);
+            if(storage_file_read(stream->file, out + done, chunk) != chunk) {
+                return -1;
+            }
+            stream->position += chunk;
+            done += chunk;
+            stream->window_offset = stream->position;
+            stream->window_size = 0;
+        } else if(!tar_stream_fill(stream)) {
+            return -1;
+        }
+    }
+
+    return done;
+}
+
+int32_t tar_stream_write(TarStream* stream, const void* data, uint32_t size) {
+    furi_assert(stream);
+    if(stream->decoder) {
+        return -1;
+    }
+
+    if(!stream->dirty) {
+        /* Drop read window, file is positioned after it */
+        if(stream->window_offset + stream->window_size != stream->position &&
+           !storage_file_seek(stream->file, stream->position, true)) {
+            return -1;
+        }
+        stream->window_offset = stream->position;
+        stream->window_size = 0;
+        stream->dirty = true;
+    }
+
+    const uint8_t* in = data;
+    uint32_t done = 0;
+    while(done < size) {
+        if(!stream->window_size && size - done >= TAR_STREAM_BUFFER_SIZE) {
+            uint32_t chunk = MIN(size - done, (uint32_t)TAR_STREAM_DIRECT_CHUNK);
+            if(storage_file_write(stream->file, in + done, chunk) != chunk) {
+                return -1;
+            }
+            done += chunk;
+            stream->position += chunk;
+            stream->window_offset = stream->position;
+            continue;
+        }
+
+        uint32_t chunk = MIN(TAR_STREAM_BUFFER_SIZE - stream->window_size, size - done);
+        memcpy(stream->buffer + stream->window_size, in + done, chunk);
+        stream->window_size += chunk;
+        stream->position += chunk;
+        done += chunk;
+
+        if(stream->window_size == TAR_STREAM_BUFFER_SIZE && !tar_stream_flush(stream)) {
+            return -1;
+        }
+        stream->dirty = true;
+    }
+
+    return done;
+}
+
+bool tar_stream_seek(TarStream* stream, uint32_t offset) {
+    furi_assert(stream);
+    bool success = tar_stream_flush(stream);
+    stream->position = offset;
+    return success;
+}
+
+bool tar_stream_flush(TarStream* stream) {
+    furi_assert(stream);
+    if(!stream->dirty) {
+        return true;
+    }
+
+    bool success = true;
+    if(stream->window_size) {
+        success = storage_file_write(stream->file, stream->buffer, stream->window_size) ==
+                  stream->window_size;
+    }
+    stream->window_offset += stream->window_size;
+    stream->window_size = 0;
+    stream->dirty = false;
+    return success;
+}
+
+void tar_stream_get_file_progress(TarStream* stream, uint32_t* processed, uint32_t* total) {
+    furi_assert(stream);
+    furi_assert(processed);
+    furi_assert(total);
+    *processed = storage_file_tell(stream->file);
+    *total = storage_file_size(stream->file);
+}
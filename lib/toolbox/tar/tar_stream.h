@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+ * Buffered archive stream used by tar_archive as microtar I/O backend.
+ *
+ * Reads are served from a large read-ahead window, short backward seeks
+ * (microtar re-reads headers) stay inside it. Writes are coalesced and
+ * hit the file in window sized chunks. Optionally decodes heatshrink
+ * compressed archive on the fly: forward seeks skip decoded data, backward
+ * seeks past the window restart decoding from the beginning.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compressed archive starts with this header, followed by heatshrink data */
+#define TAR_HEATSHRINK_MAGIC 0x53445348 /* "HSDS" */
+#define TAR_HEATSHRINK_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t window_sz2;
+    uint8_t lookahead_sz2;
+} __attribute__((packed)) TarHeatshrinkHeader;
+
+typedef struct TarStream TarStream;
+
+/** Wrap open file, stream takes ownership of it
+ *
+ * @param      file        file opened for reading or writing
+ * @param      heatshrink  file is heatshrink compressed, read only
+ *
+ * @return     stream instance, NULL if compressed file header is invalid
+ */
+TarStream* tar_stream_alloc(File* file, bool heatshrink);
+
+/** Drop pending writes, close and free file */
+void tar_stream_free(TarStream* stream);
+
+/** Read exactly size bytes
+ *
+ * @return     size on success, -1 on error or end of archive
+ */
+int32_t tar_stream_read(TarStream* stream, void* data, uint32_t size);
+
+/** Write size bytes, not supported for compressed archives
+ *
+ * @return     size on success, -1 on error
+ */
+int32_t tar_stream_write(TarStream* stream, const void* data, uint32_t size);
+
+/** Set position, actual file seek is deferred to next read or write */
+bool tar_stream_seek(TarStream* stream, uint32_t offset);
+
+/** Write out pending data */
+bool tar_stream_flush(TarStream* stream);
+
+/** Get how much of underlying file is consumed, for compressed archives too
+ *
+ * @param      processed  bytes read from file so far
+ * @param      total      file size
+ */
+void tar_stream_get_file_progress(TarStream* stream, uint32_t* processed, uint32_t* total);
+
+#ifdef __cplusplus
+}
+#endif
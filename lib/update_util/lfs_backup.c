@@ -1,6 +1,12 @@
 #include "lfs_backup.h"
 
 #include <toolbox/tar/tar_archive.h>
+#include <toolbox/path.h>
+#include <toolbox/crc32_calc.h>
+#include <toolbox/dir_walk.h>
+#include <toolbox/stream/file_stream.h>
+#include <toolbox/stream/buffered_file_stream.h>
+#include <m-dict.h>
 
 #include <bt/bt_settings_filename.h>
 #include <bt/bt_service/bt_keys_filename.h>
@@ -9,8 +15,33 @@
 #include <desktop/desktop_settings_filename.h>
 #include <notification/notification_settings_filename.h>
 
+#define TAG "LfsBackup"
+
 #define LFS_BACKUP_DEFAULT_LOCATION EXT_PATH(LFS_BACKUP_DEFAULT_FILENAME)
 
+/* Shared by every file read, crc check and archive write */
+#define LFS_BACKUP_BUFFER_SIZE 4096
+#define LFS_BACKUP_TAR_RECORD_SIZE 512
+#define LFS_BACKUP_TAR_END_SIZE (2 * LFS_BACKUP_TAR_RECORD_SIZE)
+/* Appending stops once archive would outgrow twice its live entries plus this */
+#define LFS_BACKUP_COMPACT_SLACK (64 * 1024)
+
+typedef struct {
+    bool is_directory;
+    uint32_t size;
+    uint32_t crc32;
+    uint32_t offset;
+} LfsBackupEntry;
+
+DICT_DEF2(LfsBackupManifest, FuriString*, FURI_STRING_OPLIST, LfsBackupEntry, M_POD_OPLIST)
+
+typedef struct {
+    LfsBackupProgressCallback callback;
+    void* context;
+    uint32_t processed;
+    uint32_t total;
+} LfsBackupProgress;
+
 static void backup_name_converter(FuriString* filename) {
     if(furi_string_empty(filename) || (furi_string_get_char(filename, 0) == '.')) {
         return;
@@ -49,3 +80,444 @@ bool lfs_backup_unpack(Storage* storage, const char* source) {
     const char* final_source = source && strlen(source) ? source : LFS_BACKUP_DEFAULT_LOCATION;
     return storage_int_restore(storage, final_source, backup_name_converter) == FSE_OK;
 }
+
+static void lfs_backup_progress_add(LfsBackupProgress* progress, uint32_t bytes) {
+    progress->processed += bytes;
+    if(progress->callback) {
+        progress->callback(progress->processed, progress->total, progress->context);
+    }
+}
+
+static uint32_t lfs_backup_tar_entry_size(uint32_t size) {
+    return LFS_BACKUP_TAR_RECORD_SIZE +
+           (size + LFS_BACKUP_TAR_RECORD_SIZE - 1) / LFS_BACKUP_TAR_RECORD_SIZE *
+               LFS_BACKUP_TAR_RECORD_SIZE;
+}
+
+static const char* lfs_backup_int_name(FuriString* path) {
+    return furi_string_get_cstr(path) + strlen(STORAGE_INT_PATH_PREFIX) + 1;
+}
+
+/* Crc32 of file contents, if file is still of expected size */
+static bool lfs_backup_file_crc(
+    Storage* storage,
+    const char* path,
+    uint32_t size,
+    uint8_t* buffer,
+    uint32_t* crc,
+    LfsBackupProgress* progress) {
+    File* file = storage_file_alloc(storage);
+    uint32_t total = 0;
+    *crc = 0;
+
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint16_t read_size;
+        while((read_size = storage_file_read(file, buffer, LFS_BACKUP_BUFFER_SIZE))) {
+            *crc = crc32_calc_buffer(*crc, buffer, read_size);
+            total += read_size;
+            if(progress) lfs_backup_progress_add(progress, read_size);
+        }
+    }
+
+    bool result = (storage_file_get_error(file) == FSE_OK) && (total == size);
+    storage_file_free(file);
+    return result;
+}
+
+/* Archive file, computing its crc32 on the way */
+static bool lfs_backup_archive_file(
+    TarArchive* archive,
+    Storage* storage,
+    const char* path,
+    const char* name,
+    uint32_t size,
+    uint8_t* buffer,
+    uint32_t* crc,
+    LfsBackupProgress* progress) {
+    File* file = storage_file_alloc(storage);
+    uint32_t total = 0;
+    bool success = false;
+    *crc = 0;
+
+    do {
+        if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) ||
+           !tar_archive_file_add_header(archive, name, size)) {
+            break;
+        }
+
+        success = true;
+        uint16_t read_size;
+        while((read_size = storage_file_read(file, buffer, LFS_BACKUP_BUFFER_SIZE))) {
+            *crc = crc32_calc_buffer(*crc, buffer, read_size);
+            total += read_size;
+            if(progress) lfs_backup_progress_add(progress, read_size);
+            if(total > size || !tar_archive_file_add_data_block(archive, buffer, read_size)) {
+                success = false;
+                break;
+            }
+        }
+
+        success = success && (total == size) && tar_archive_file_finalize(archive);
+    } while(false);
+
+    storage_file_free(file);
+    return success;
+}
+
+/* Manifest lines, in walk order so directories precede their contents:
+ * D:<name>
+ * F:<crc32>:<size>:<offset>:<name>
+ * A:<archive end offset, without end records>
+ * Manifest without A line is incomplete */
+typedef enum {
+    LfsBackupLineInvalid,
+    LfsBackupLineDirectory,
+    LfsBackupLineFile,
+    LfsBackupLineEnd,
+} LfsBackupLine;
+
+static LfsBackupLine
+    lfs_backup_parse_line(FuriString* line, LfsBackupEntry* entry, FuriString* name) {
+    furi_string_trim(line);
+    const char* str = furi_string_get_cstr(line);
+    int name_offset = 0;
+
+    memset(entry, 0, sizeof(LfsBackupEntry));
+
+    if(furi_string_start_with_str(line, "D:")) {
+        entry->is_directory = true;
+        furi_string_set_str(name, str + 2);
+        return LfsBackupLineDirectory;
+    } else if(furi_string_start_with_str(line, "A:")) {
+        entry->offset = strtoul(str + 2, NULL, 10);
+        return LfsBackupLineEnd;
+    } else if(furi_string_start_with_str(line, "F:")) {
+        int fields = sscanf(
+            str + 2, "%lx:%lu:%lu:%n", &entry->crc32, &entry->size, &entry->offset, &name_offset);
+        if(fields != 3 || name_offset == 0) {
+            return LfsBackupLineInvalid;
+        }
+        furi_string_set_str(name, str + 2 + name_offset);
+        return LfsBackupLineFile;
+    }
+
+    return LfsBackupLineInvalid;
+}
+
+/* Reads complete manifest matching archive. Returns total size of files or -1 */
+static int64_t lfs_backup_manifest_load(
+    Storage* storage,
+    const char* archive_path,
+    FuriString* manifest_path,
+    LfsBackupManifest_t manifest) {
+    Stream* stream = buffered_file_stream_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    FuriString* name = furi_string_alloc();
+    int64_t total = -1;
+    uint64_t total_files = 0;
+
+    if(buffered_file_stream_open(
+           stream, furi_string_get_cstr(manifest_path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+        LfsBackupEntry entry;
+        while(stream_read_line(stream, line)) {
+            LfsBackupLine type = lfs_backup_parse_line(line, &entry, name);
+            if(type == LfsBackupLineFile || type == LfsBackupLineDirectory) {
+                total_files += entry.size;
+                if(manifest) LfsBackupManifest_set_at(manifest, name, entry);
+            } else if(type == LfsBackupLineEnd) {
+                FileInfo fileinfo;
+                if(storage_common_stat(storage, archive_path, &fileinfo) == FSE_OK &&
+                   fileinfo.size == (uint64_t)entry.offset + LFS_BACKUP_TAR_END_SIZE) {
+                    total = total_files;
+                }
+                break;
+            }
+        }
+    }
+
+    if(total < 0 && manifest) {
+        LfsBackupManifest_reset(manifest);
+    }
+
+    furi_string_free(name);
+    furi_string_free(line);
+    buffered_file_stream_close(stream);
+    stream_free(stream);
+    return total;
+}
+
+/* Walks /int, calls back for every entry with name relative to it */
+typedef bool (*LfsBackupWalkCallback)(
+    FuriString* path,
+    FuriString* name,
+    const FileInfo* fileinfo,
+    void* context);
+
+static bool lfs_backup_walk(Storage* storage, LfsBackupWalkCallback callback, void* context) {
+    DirWalk* dir_walk = dir_walk_alloc(storage);
+    FuriString* path = furi_string_alloc();
+    FuriString* name = furi_string_alloc();
+    FileInfo fileinfo;
+
+    bool success = dir_walk_open(dir_walk, STORAGE_INT_PATH_PREFIX);
+    while(success) {
+        DirWalkResult result = dir_walk_read(dir_walk, path, &fileinfo);
+        if(result == DirWalkLast) break;
+        furi_string_set_str(name, lfs_backup_int_name(path));
+        success = (result == DirWalkOK) && callback(path, name, &fileinfo, context);
+    }
+
+    furi_string_free(name);
+    furi_string_free(path);
+    dir_walk_free(dir_walk);
+    return success;
+}
+
+typedef struct {
+    Storage* storage;
+    TarArchive* archive;
+    Stream* manifest_stream;
+    LfsBackupManifest_t manifest;
+    uint8_t* buffer;
+    LfsBackupProgress progress;
+    uint64_t live_size;
+    uint64_t append_size;
+} LfsBackupCreateContext;
+
+static bool lfs_backup_estimate_cb(
+    FuriString* path,
+    FuriString* name,
+    const FileInfo* fileinfo,
+    void* context) {
+    UNUSED(path);
+    LfsBackupCreateContext* create = context;
+
+    if(!(fileinfo->flags & FSF_DIRECTORY)) {
+        uint32_t entry_size = lfs_backup_tar_entry_size(fileinfo->size);
+        create->progress.total += fileinfo->size;
+        create->live_size += entry_size;
+
+        const LfsBackupEntry* old = LfsBackupManifest_cget(create->manifest, name);
+        if(!old || old->is_directory || old->size != fileinfo->size) {
+            create->append_size += entry_size;
+        }
+    }
+
+    return true;
+}
+
+static bool lfs_backup_create_cb(
+    FuriString* path,
+    FuriString* name,
+    const FileInfo* fileinfo,
+    void* context) {
+    LfsBackupCreateContext* create = context;
+    const char* name_cstr = furi_string_get_cstr(name);
+
+    if(fileinfo->flags & FSF_DIRECTORY) {
+        /* Keeps archive usable by plain unpack */
+        if(!LfsBackupManifest_cget(create->manifest, name) &&
+           !tar_archive_dir_add_element(create->archive, name_cstr)) {
+            return false;
+        }
+        return stream_write_format(create->manifest_stream, "D:%s\n", name_cstr) > 0;
+    }
+
+    LfsBackupEntry entry = {.size = fileinfo->size};
+    const LfsBackupEntry* old = LfsBackupManifest_cget(create->manifest, name);
+    if(old && old->is_directory) {
+        old = NULL;
+    }
+
+    bool unchanged = false;
+    if(old && old->size == entry.size) {
+        if(!lfs_backup_file_crc(
+               create->storage,
+               furi_string_get_cstr(path),
+               entry.size,
+               create->buffer,
+               &entry.crc32,
+               &create->progress)) {
+            return false;
+        }
+        unchanged = (old->crc32 == entry.crc32);
+    }
+
+    if(unchanged) {
+        entry.offset = old->offset;
+    } else {
+        FURI_LOG_D(TAG, "Archiving %s", name_cstr);
+        entry.offset = tar_archive_get_position(create->archive);
+        /* Progress was already counted if crc check came first */
+        if(!lfs_backup_archive_file(
+               create->archive,
+               create->storage,
+               furi_string_get_cstr(path),
+               name_cstr,
+               entry.size,
+               create->buffer,
+               &entry.crc32,
+               old && old->size == entry.size ? NULL : &create->progress)) {
+            return false;
+        }
+    }
+
+    return stream_write_format(
+               create->manifest_stream,
+               "F:%08lX:%lu:%lu:%s\n",
+               entry.crc32,
+               entry.size,
+               entry.offset,
+               name_cstr) > 0;
+}
+
+bool lfs_backup_create_incremental(
+    Storage* storage,
+    const char* destination,
+    LfsBackupProgressCallback callback,
+    void* context) {
+    furi_assert(destination);
+
+    FuriString* manifest_path =
+        furi_string_alloc_printf("%s" LFS_BACKUP_MANIFEST_SUFFIX, destination);
+    FuriString* temp_path =
+        furi_string_alloc_printf("%s.tmp", furi_string_get_cstr(manifest_path));
+
+    LfsBackupCreateContext create = {
+        .storage = storage,
+        .archive = tar_archive_alloc(storage),
+        .manifest_stream = file_stream_alloc(storage),
+        .buffer = malloc(LFS_BACKUP_BUFFER_SIZE),
+        .progress = {.callback = callback, .context = context},
+    };
+    LfsBackupManifest_init(create.manifest);
+
+    bool success = false;
+    do {
+        bool append =
+            lfs_backup_manifest_load(storage, destination, manifest_path, create.manifest) >= 0;
+
+        if(!lfs_backup_walk(storage, lfs_backup_estimate_cb, &create)) break;
+
+        FileInfo fileinfo;
+        if(append && storage_common_stat(storage, destination, &fileinfo) == FSE_OK &&
+           fileinfo.size + create.append_size > 2 * create.live_size + LFS_BACKUP_COMPACT_SLACK) {
+            FURI_LOG_I(TAG, "Compacting");
+            append = false;
+        }
+
+        if(!append) {
+            /* Old offsets are about to become invalid */
+            LfsBackupManifest_reset(create.manifest);
+            storage_simply_remove(storage, furi_string_get_cstr(manifest_path));
+        }
+
+        FURI_LOG_I(TAG, "%s %s", append ? "Appending to" : "Creating", destination);
+        if(!tar_archive_open(
+               create.archive, destination, append ? TAR_OPEN_MODE_APPEND : TAR_OPEN_MODE_WRITE) ||
+           !file_stream_open(
+               create.manifest_stream,
+               furi_string_get_cstr(temp_path),
+               FSAM_WRITE,
+               FSOM_CREATE_ALWAYS)) {
+            break;
+        }
+
+        if(!lfs_backup_walk(storage, lfs_backup_create_cb, &create)) break;
+
+        uint32_t archive_end = tar_archive_get_position(create.archive);
+        if(!tar_archive_finalize(create.archive) ||
+           !stream_write_format(create.manifest_stream, "A:%lu\n", archive_end) ||
+           !file_stream_close(create.manifest_stream)) {
+            break;
+        }
+
+        /* Until the rename, old manifest still describes archive correctly */
+        storage_simply_remove(storage, furi_string_get_cstr(manifest_path));
+        success = storage_common_rename(
+                      storage,
+                      furi_string_get_cstr(temp_path),
+                      furi_string_get_cstr(manifest_path)) == FSE_OK;
+    } while(false);
+
+    LfsBackupManifest_clear(create.manifest);
+    free(create.buffer);
+    stream_free(create.manifest_stream);
+    tar_archive_free(create.archive);
+    furi_string_free(temp_path);
+    furi_string_free(manifest_path);
+    return success;
+}
+
+bool lfs_backup_unpack_incremental(
+    Storage* storage,
+    const char* source,
+    LfsBackupProgressCallback callback,
+    void* context) {
+    furi_assert(source);
+
+    FuriString* manifest_path = furi_string_alloc_printf("%s" LFS_BACKUP_MANIFEST_SUFFIX, source);
+    LfsBackupProgress progress = {.callback = callback, .context = context};
+
+    int64_t total = lfs_backup_manifest_load(storage, source, manifest_path, NULL);
+    if(total < 0) {
+        FURI_LOG_W(TAG, "No valid manifest, restoring everything");
+        furi_string_free(manifest_path);
+        return lfs_backup_unpack(storage, source);
+    }
+    progress.total = total;
+
+    TarArchive* archive = tar_archive_alloc(storage);
+    Stream* stream = buffered_file_stream_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    FuriString* name = furi_string_alloc();
+    FuriString* path = furi_string_alloc();
+    uint8_t* buffer = malloc(LFS_BACKUP_BUFFER_SIZE);
+
+    bool success = tar_archive_open(archive, source, TAR_OPEN_MODE_READ) &&
+                   buffered_file_stream_open(
+                       stream, furi_string_get_cstr(manifest_path), FSAM_READ, FSOM_OPEN_EXISTING);
+
+    LfsBackupEntry entry;
+    while(success && stream_read_line(stream, line)) {
+        LfsBackupLine type = lfs_backup_parse_line(line, &entry, name);
+        if(type == LfsBackupLineEnd) {
+            break;
+        } else if(type == LfsBackupLineInvalid) {
+            continue;
+        }
+
+        backup_name_converter(name);
+        path_concat(STORAGE_INT_PATH_PREFIX, furi_string_get_cstr(name), path);
+
+        if(type == LfsBackupLineDirectory) {
+            success = storage_simply_mkdir(storage, furi_string_get_cstr(path));
+            continue;
+        }
+
+        FileInfo fileinfo;
+        uint32_t crc;
+        if(storage_common_stat(storage, furi_string_get_cstr(path), &fileinfo) == FSE_OK &&
+           fileinfo.size == entry.size &&
+           lfs_backup_file_crc(
+               storage, furi_string_get_cstr(path), entry.size, buffer, &crc, NULL) &&
+           crc == entry.crc32) {
+            FURI_LOG_D(TAG, "Unchanged %s", furi_string_get_cstr(name));
+        } else {
+            FURI_LOG_D(TAG, "Restoring %s", furi_string_get_cstr(name));
+            success =
+                tar_archive_unpack_file_at(archive, entry.offset, furi_string_get_cstr(path));
+        }
+        lfs_backup_progress_add(&progress, entry.size);
+    }
+
+    free(buffer);
+    furi_string_free(path);
+    furi_string_free(name);
+    furi_string_free(line);
+    buffered_file_stream_close(stream);
+    stream_free(stream);
+    tar_archive_free(archive);
+    furi_string_free(manifest_path);
+    return success;
+}
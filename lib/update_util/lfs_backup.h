@@ -4,15 +4,58 @@
 #include <storage/storage.h>
 
 #define LFS_BACKUP_DEFAULT_FILENAME "backup.tar"
+/* Kept between updates, so unchanged files are not archived again */
+#define LFS_BACKUP_INCREMENTAL_LOCATION EXT_PATH(".int_backup.tar")
+#define LFS_BACKUP_MANIFEST_SUFFIX ".manifest"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Progress callback, in bytes of file data processed */
+typedef void (*LfsBackupProgressCallback)(uint32_t processed, uint32_t total, void* context);
+
 bool lfs_backup_create(Storage* storage, const char* destination);
 bool lfs_backup_exists(Storage* storage, const char* source);
 bool lfs_backup_unpack(Storage* storage, const char* source);
 
+/** Create or update backup with a manifest of path, size and crc32 next to it
+ *
+ * Files matching the manifest are not archived again, changed ones are
+ * appended to the existing archive. Archive is rewritten from scratch when
+ * there is no valid manifest or stale entries take up more than live ones.
+ *
+ * @param      storage      Storage API pointer
+ * @param      destination  archive path, manifest is stored as path.manifest
+ * @param      callback     progress callback, may be NULL
+ * @param      context      callback context
+ *
+ * @return     true on success
+ */
+bool lfs_backup_create_incremental(
+    Storage* storage,
+    const char* destination,
+    LfsBackupProgressCallback callback,
+    void* context);
+
+/** Restore files that differ from backup, using its manifest
+ *
+ * Files with size and crc32 matching the manifest are left untouched. Falls
+ * back to full unpack when there is no valid manifest.
+ *
+ * @param      storage   Storage API pointer
+ * @param      source    archive path
+ * @param      callback  progress callback, may be NULL
+ * @param      context   callback context
+ *
+ * @return     true on success
+ */
+bool lfs_backup_unpack_incremental(
+    Storage* storage,
+    const char* source,
+    LfsBackupProgressCallback callback,
+    void* context);
+
 #ifdef __cplusplus
 }
 #endif
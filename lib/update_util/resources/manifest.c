@@ -113,3 +113,10 @@ ResourceManifestEntry* resource_manifest_reader_next(ResourceManifestReader* res
 
     return NULL;
 }
+
+uint8_t resource_manifest_reader_get_progress(ResourceManifestReader* resource_manifest) {
+    furi_assert(resource_manifest);
+
+    size_t size = stream_size(resource_manifest->stream);
+    return size ? (stream_tell(resource_manifest->stream) * 100ULL) / size : 0;
+}
@@ -52,6 +52,13 @@ bool resource_manifest_reader_open(ResourceManifestReader* resource_manifest, co
  */
 ResourceManifestEntry* resource_manifest_reader_next(ResourceManifestReader* resource_manifest);
 
+/**
+ * @brief Get reading progress of manifest file
+ * @param resource_manifest allocated object
+ * @return part of file read so far, 0-100
+ */
+uint8_t resource_manifest_reader_get_progress(ResourceManifestReader* resource_manifest);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include <furi_hal.h>
 #include <loader/loader.h>
 #include <lib/toolbox/path.h>
-#include <lib/toolbox/crc32_calc.h>
+#include <lib/toolbox/hash_cache.h>
 
 #define UPDATE_ROOT_DIR EXT_PATH("update")
 
@@ -137,7 +137,6 @@ UpdatePrepareResult update_operation_prepare(const char* manifest_file_path) {
     UpdatePrepareResult result = UpdatePrepareResultIntFull;
     Storage* storage = furi_record_open(RECORD_STORAGE);
     UpdateManifest* manifest = update_manifest_alloc();
-    File* file = storage_file_alloc(storage);
 
     uint64_t free_int_space;
     FuriString* stage_path;
@@ -172,14 +171,13 @@ UpdatePrepareResult update_operation_prepare(const char* manifest_file_path) {
         path_extract_dirname(manifest_file_path, stage_path);
         path_append(stage_path, furi_string_get_cstr(manifest->staged_loader_file));
 
-        if(!storage_file_open(
-               file, furi_string_get_cstr(stage_path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+        HashCacheDigest digest;
+        if(hash_cache_get(storage, furi_string_get_cstr(stage_path), &digest) != FSE_OK) {
             result = UpdatePrepareResultStageMissing;
             break;
         }
 
-        uint32_t crc = crc32_calc_file(file, NULL, NULL);
-        if(crc != manifest->staged_loader_crc) {
+        if(digest.crc32 != manifest->staged_loader_crc) {
             result = UpdatePrepareResultStageIntegrityError;
             break;
         }
@@ -194,7 +192,6 @@ UpdatePrepareResult update_operation_prepare(const char* manifest_file_path) {
     } while(false);
 
     furi_string_free(stage_path);
-    storage_file_free(file);
 
     update_manifest_free(manifest);
     furi_record_close(RECORD_STORAGE);
@@ -0,0 +1,49 @@
+import struct
+
+
+class HeatshrinkDataStreamHeader:
+    """Header of heatshrink compressed stream, see lib/toolbox/tar/tar_stream.h"""
+
+    MAGIC = 0x53445348  # "HSDS"
+    VERSION = 1
+    FORMAT = "<IBBB"
+
+    def __init__(self, window_sz2: int, lookahead_sz2: int):
+        self.window_sz2 = window_sz2
+        self.lookahead_sz2 = lookahead_sz2
+
+    def pack(self) -> bytes:
+        return struct.pack(
+            self.FORMAT, self.MAGIC, self.VERSION, self.window_sz2, self.lookahead_sz2
+        )
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "HeatshrinkDataStreamHeader":
+        magic, version, window_sz2, lookahead_sz2 = struct.unpack_from(cls.FORMAT, data)
+        if magic != cls.MAGIC or version != cls.VERSION:
+            raise ValueError("Not a heatshrink data stream")
+        return cls(window_sz2, lookahead_sz2)
+
+    @staticmethod
+    def size() -> int:
+        return struct.calcsize(HeatshrinkDataStreamHeader.FORMAT)
+
+
+def compress_stream(data: bytes, window_sz2: int, lookahead_sz2: int) -> bytes:
+    import heatshrink2
+
+    header = HeatshrinkDataStreamHeader(window_sz2, lookahead_sz2)
+    return header.pack() + heatshrink2.compress(
+        data, window_sz2=window_sz2, lookahead_sz2=lookahead_sz2
+    )
+
+
+def decompress_stream(data: bytes) -> bytes:
+    import heatshrink2
+
+    header = HeatshrinkDataStreamHeader.unpack(data)
+    return heatshrink2.decompress(
+        data[header.size() :],
+        window_sz2=header.window_sz2,
+        lookahead_sz2=header.lookahead_sz2,
+    )
@@ -0,0 +1,354 @@
+import time
+
+# Field numbers mirror assets/protobuf flipper.proto and storage.proto.
+# Only the messages needed for file transfers are covered, so the module
+# works without generated protobuf bindings.
+MAIN_COMMAND_ID = 1
+MAIN_COMMAND_STATUS = 2
+MAIN_HAS_NEXT = 3
+MAIN_EMPTY = 4
+MAIN_STORAGE_READ_REQUEST = 9
+MAIN_STORAGE_READ_RESPONSE = 10
+MAIN_STORAGE_WRITE_REQUEST = 11
+
+FILE_DATA = 4
+READ_REQUEST_PATH = 1
+READ_RESPONSE_FILE = 1
+WRITE_REQUEST_PATH = 1
+WRITE_REQUEST_FILE = 2
+
+STATUS_OK = 0
+STATUS_ERROR_DECODE = 2
+STATUS_ERROR_STORAGE_NOT_EXIST = 6
+
+CHUNK_SIZE_DEFAULT = 512
+CHUNK_SIZE_MAX = 8 * 1024
+
+# RPC_MAX_MESSAGE_SIZE: device decodes at most this many bytes per message,
+# length prefix included, and closes the session on anything bigger
+MESSAGE_SIZE_MAX = 1536
+
+WIRE_VARINT = 0
+WIRE_BYTES = 2
+
+
+def encode_varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def decode_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def encode_field(number, value):
+    if isinstance(value, (bytes, bytearray)):
+        return (
+            encode_varint((number << 3) | WIRE_BYTES)
+            + encode_varint(len(value))
+            + bytes(value)
+        )
+    return encode_varint((number << 3) | WIRE_VARINT) + encode_varint(int(value))
+
+
+def decode_fields(data):
+    fields = {}
+    pos = 0
+    while pos < len(data):
+        key, pos = decode_varint(data, pos)
+        number, wire = key >> 3, key & 0x07
+        if wire == WIRE_VARINT:
+            value, pos = decode_varint(data, pos)
+        elif wire == WIRE_BYTES:
+            length, pos = decode_varint(data, pos)
+            value = bytes(data[pos : pos + length])
+            pos += length
+        else:
+            raise ValueError(f"Unsupported wire type {wire}")
+        fields[number] = value
+    return fields
+
+
+def encode_main(command_id, content_tag, content, status=STATUS_OK, has_next=False):
+    message = encode_field(MAIN_COMMAND_ID, command_id)
+    if status:
+        message += encode_field(MAIN_COMMAND_STATUS, status)
+    if has_next:
+        message += encode_field(MAIN_HAS_NEXT, 1)
+    message += encode_field(content_tag, content)
+    return encode_varint(len(message)) + message
+
+
+def encode_file_data(data):
+    return encode_field(FILE_DATA, data)
+
+
+def compress_payload(data):
+    """Encode a chunk the way furi_hal_compress_encode does"""
+    import heatshrink2
+
+    packed = heatshrink2.compress(data, window_sz2=8, lookahead_sz2=4)
+    if len(packed) + 4 < len(data) + 1:
+        return bytes([1, 0]) + len(packed).to_bytes(2, "little") + packed
+    return b"\x00" + data
+
+
+def decompress_payload(data):
+    """Decode a furi_hal_compress block: header and heatshrink data or 0x00 and raw data"""
+    if not data:
+        return data
+    if data[0] == 0:
+        return data[1:]
+
+    import heatshrink2
+
+    size = int.from_bytes(data[2:4], "little")
+    return heatshrink2.decompress(data[4 : 4 + size], window_sz2=8, lookahead_sz2=4)
+
+
+class FlipperRpc:
+    """Storage transfers over a raw RPC session"""
+
+    def __init__(self, transport):
+        self.transport = transport
+        self.buffer = bytearray()
+        self.command_id = 0
+        self.chunk_size = CHUNK_SIZE_DEFAULT
+        self.compress = False
+
+    def start(self, chunk_size=CHUNK_SIZE_DEFAULT, compress=False):
+        """Open session: options are passed to start_rpc_session and echoed back"""
+        options = [f"chunk={chunk_size}"]
+        if compress:
+            options.append("compress")
+        self.transport.write(f"start_rpc_session {' '.join(options)}\r".encode())
+        # CLI echoes the command line first
+        reply = self._read_line()
+        while not reply.startswith("chunk="):
+            reply = self._read_line()
+        self.chunk_size, self.compress = chunk_size, compress
+        for option in reply.split():
+            name, _, value = option.partition("=")
+            if name == "chunk":
+                self.chunk_size = int(value)
+            elif name == "compress":
+                self.compress = value == "1"
+
+    def _read_line(self, timeout=2):
+        deadline = time.monotonic() + timeout
+        while b"\n" not in self.buffer:
+            if time.monotonic() > deadline:
+                raise TimeoutError("No reply to start_rpc_session")
+            self.buffer.extend(self.transport.read())
+        line, _, self.buffer = self.buffer.partition(b"\n")
+        return line.decode().strip()
+
+    def _read_main(self):
+        while True:
+            try:
+                length, pos = decode_varint(self.buffer, 0)
+                if len(self.buffer) >= pos + length:
+                    message = decode_fields(self.buffer[pos : pos + length])
+                    del self.buffer[: pos + length]
+                    return message
+            except IndexError:
+                pass
+            self.buffer.extend(self.transport.read())
+
+    def _check_status(self, message):
+        status = message.get(MAIN_COMMAND_STATUS, STATUS_OK)
+        if status != STATUS_OK:
+            raise IOError(f"Command {message[MAIN_COMMAND_ID]} failed: {status}")
+
+    def read_file(self, path):
+        self.command_id += 1
+        request = encode_field(READ_REQUEST_PATH, path.encode())
+        self.transport.write(
+            encode_main(self.command_id, MAIN_STORAGE_READ_REQUEST, request)
+        )
+
+        data = bytearray()
+        while True:
+            message = self._read_main()
+            self._check_status(message)
+            response = decode_fields(message.get(MAIN_STORAGE_READ_RESPONSE, b""))
+            chunk = decode_fields(response.get(READ_RESPONSE_FILE, b"")).get(
+                FILE_DATA, b""
+            )
+            data.extend(decompress_payload(chunk) if self.compress else chunk)
+            if not message.get(MAIN_HAS_NEXT):
+                return bytes(data)
+
+    def _encode_write(self, path, chunk, has_next):
+        request = encode_field(WRITE_REQUEST_PATH, path.encode())
+        request += encode_field(WRITE_REQUEST_FILE, encode_file_data(chunk))
+        return encode_main(
+            self.command_id, MAIN_STORAGE_WRITE_REQUEST, request, has_next=has_next
+        )
+
+    def write_chunk_size(self, path):
+        """Largest write payload whose request still fits into device message
+        size limit. Session chunk size applies to reads only, the device can't
+        decode bigger write requests."""
+        size = min(self.chunk_size, MESSAGE_SIZE_MAX)
+        while size > 0:
+            excess = len(self._encode_write(path, bytes(size), True)) - MESSAGE_SIZE_MAX
+            if excess <= 0:
+                return size
+            size -= excess
+        raise ValueError(f"Path is too long for a write request: {path}")
+
+    def write_file(self, path, data, window=8):
+        """Write requests are not acknowledged until the last chunk, so up to
+        `window` requests are batched into one transport write"""
+        self.command_id += 1
+        chunk_size = self.write_chunk_size(path)
+        chunks = [
+            data[i : i + chunk_size] for i in range(0, len(data), chunk_size)
+        ] or [b""]
+
+        pending = bytearray()
+        for index, chunk in enumerate(chunks):
+            pending += self._encode_write(path, chunk, index + 1 < len(chunks))
+            if (index + 1) % window == 0:
+                self.transport.write(bytes(pending))
+                pending.clear()
+        if pending:
+            self.transport.write(bytes(pending))
+
+        self._check_status(self._read_main())
+
+
+class SerialTransport:
+    def __init__(self, port):
+        self.port = port
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self):
+        return self.port.read(max(1, self.port.in_waiting))
+
+
+class LoopbackTransport:
+    """In-process stand-in for the device side of an RPC storage session
+
+    Mirrors rpc_system_storage_read_process() and the write handler closely
+    enough to measure host-side encoding, framing and decompression cost.
+    Messages over the device decode limit fail the way rpc_session_worker()
+    fails them: ERROR_DECODE and the session is closed.
+    """
+
+    def __init__(self):
+        self.files = {}
+        self.output = bytearray()
+        self.input = bytearray()
+        self.chunk_size = CHUNK_SIZE_DEFAULT
+        self.compress = False
+        self.session = False
+        self.closed = False
+        self.write_path = None
+        self.write_data = bytearray()
+
+    def write(self, data):
+        if self.closed:
+            return
+        self.input.extend(data)
+        if not self.session:
+            line, sep, rest = self.input.partition(b"\r")
+            if not sep:
+                return
+            self.input = bytearray(rest)
+            for option in line.decode().split()[1:]:
+                name, _, value = option.partition("=")
+                if name == "chunk":
+                    self.chunk_size = min(
+                        max(int(value), CHUNK_SIZE_DEFAULT), CHUNK_SIZE_MAX
+                    )
+                elif name == "compress":
+                    self.compress = True
+            self.output.extend(
+                f"chunk={self.chunk_size} compress={int(self.compress)}\r\n".encode()
+            )
+            self.session = True
+
+        while self.input:
+            try:
+                length, pos = decode_varint(self.input, 0)
+            except IndexError:
+                return
+            if pos + length > MESSAGE_SIZE_MAX:
+                self.input.clear()
+                self.output.extend(
+                    encode_main(0, MAIN_EMPTY, b"", status=STATUS_ERROR_DECODE)
+                )
+                self.closed = True
+                return
+            if len(self.input) < pos + length:
+                return
+            message = decode_fields(self.input[pos : pos + length])
+            del self.input[: pos + length]
+            self._process(message)
+
+    def read(self):
+        data = bytes(self.output)
+        self.output.clear()
+        return data
+
+    def _process(self, message):
+        command_id = message[MAIN_COMMAND_ID]
+        if MAIN_STORAGE_READ_REQUEST in message:
+            path = decode_fields(message[MAIN_STORAGE_READ_REQUEST])[READ_REQUEST_PATH]
+            self._read(command_id, path.decode())
+        elif MAIN_STORAGE_WRITE_REQUEST in message:
+            request = decode_fields(message[MAIN_STORAGE_WRITE_REQUEST])
+            self.write_path = request[WRITE_REQUEST_PATH].decode()
+            file = decode_fields(request.get(WRITE_REQUEST_FILE, b""))
+            self.write_data.extend(file.get(FILE_DATA, b""))
+            if not message.get(MAIN_HAS_NEXT):
+                self.files[self.write_path] = bytes(self.write_data)
+                self.write_data.clear()
+                self.output.extend(encode_main(command_id, MAIN_EMPTY, b""))
+
+    def _read(self, command_id, path):
+        if path not in self.files:
+            self.output.extend(
+                encode_main(
+                    command_id, MAIN_EMPTY, b"", status=STATUS_ERROR_STORAGE_NOT_EXIST
+                )
+            )
+            return
+
+        data = self.files[path]
+        offset = 0
+        while True:
+            chunk = data[offset : offset + self.chunk_size]
+            offset += len(chunk)
+            if self.compress and chunk:
+                chunk = compress_payload(chunk)
+            response = encode_field(READ_RESPONSE_FILE, encode_file_data(chunk))
+            self.output.extend(
+                encode_main(
+                    command_id,
+                    MAIN_STORAGE_READ_RESPONSE,
+                    response,
+                    has_next=offset < len(data),
+                )
+            )
+            if offset >= len(data):
+                return
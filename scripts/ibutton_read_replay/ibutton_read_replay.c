@@ -0,0 +1,593 @@
+/**
+ * Host replay test of iButton read mode latency
+ *
+ * Key edge captures are replayed through the real Cyfral and Metakom decoders
+ * driven by two models of iButton worker read mode:
+ *
+ * legacy: tick after 100 ms idle. 1-Wire host start, 100 ms delay, search,
+ * then comparator window: DWT timestamps from comparator ISR go through
+ * stream buffer, window lasts until first edge or timeout after 100 ms and
+ * result is reported at window end.
+ *
+ * capture: tick after 10 ms idle. 1-Wire line released during comparator
+ * window, edges captured by TIM2 at 1 us into ring buffer which is polled
+ * every 4 ms. Window ends on first decode or after 100 ms, search follows.
+ *
+ * Timer model: input capture latches exact edge time, counter is reset by
+ * ISR after random 0.5..3 us latency. DWT timestamp is taken with same
+ * latency.
+ *
+ * check: random keys of both protocols, with +-10% oscillator skew and +-5%
+ * edge jitter, from random frame phase, must decode to same protocol and
+ * data through both models.
+ *
+ * bench: read latency from key contact to reported key, for random contact
+ * moments, Cyfral, Metakom and DS1990 keys. Key starts to transmit 2 ms after
+ * contact. DS1990 search takes 1 ms without key and 20 ms with key.
+ *
+ * replay: same latency measurement for recorded capture of a key: text file
+ * with one "<level> <duration_us>" segment per line, level is 0 or 1 as seen
+ * on comparator output. Capture is looped to fill replay time.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o ibutton_read_replay -Iscripts/ibutton_read_replay/include -I. -Ilib \
+ *      scripts/ibutton_read_replay/ibutton_read_replay.c \
+ *      lib/toolbox/protocols/protocol_dict.c lib/one_wire/ibutton/protocols/protocol_*.c \
+ *      lib/one_wire/ibutton/protocols/ibutton_protocols.c
+ *  ./ibutton_read_replay check [keys]
+ *  ./ibutton_read_replay bench [contacts]
+ *  ./ibutton_read_replay replay <capture.txt> [contacts]
+ */
+
+#include <lib/toolbox/protocols/protocol_dict.h>
+#include <lib/one_wire/ibutton/protocols/ibutton_protocols.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPU_CYCLES_PER_US 64
+#define MS 1000.0
+
+#define LEGACY_QUANT_US (100 * MS)
+#define LEGACY_SETTLE_US (100 * MS)
+#define LEGACY_WINDOW_US (100 * MS)
+
+#define CAPTURE_QUANT_US (10 * MS)
+#define CAPTURE_WINDOW_US (100 * MS)
+#define CAPTURE_POLL_US (4 * MS)
+
+#define SEARCH_EMPTY_US (1 * MS)
+#define SEARCH_KEY_US (20 * MS)
+#define KEY_POWER_UP_US (2 * MS)
+
+#define CONTACT_SPAN_US (2000 * MS)
+#define READ_LIMIT_US (3000 * MS)
+#define SIGNAL_SPAN_US (CONTACT_SPAN_US + READ_LIMIT_US + KEY_POWER_UP_US)
+
+#define KEY_DATA_SIZE 4
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if(!(condition)) {                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                    \
+        }                                                                        \
+    } while(0)
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t random_u32(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state >> 16;
+}
+
+static double random_range(double min, double max) {
+    return min + (max - min) * (random_u32() / 4294967296.0);
+}
+
+static double isr_latency(void) {
+    return random_range(0.5, 3.0);
+}
+
+/* Comparator output edges, idle level is low: even edges rise, odd edges fall */
+typedef struct {
+    double* time;
+    size_t count;
+    size_t capacity;
+} Edges;
+
+static void edges_reset(Edges* edges) {
+    edges->count = 0;
+}
+
+static void edges_push(Edges* edges, double time) {
+    if(edges->count == edges->capacity) {
+        edges->capacity = edges->capacity ? edges->capacity * 2 : 1024;
+        edges->time = realloc(edges->time, edges->capacity * sizeof(double));
+        furi_check(edges->time);
+    }
+    edges->time[edges->count++] = time;
+}
+
+static size_t edges_first_after(const Edges* edges, double time) {
+    size_t low = 0;
+    size_t high = edges->count;
+    while(low < high) {
+        size_t mid = (low + high) / 2;
+        if(edges->time[mid] < time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* Appends segment, equal adjacent levels are merged */
+typedef struct {
+    Edges* edges;
+    bool level;
+    double time;
+} SignalBuilder;
+
+static void signal_append(SignalBuilder* builder, bool level, double duration) {
+    if(level != builder->level) {
+        edges_push(builder->edges, builder->time);
+        builder->level = level;
+    }
+    builder->time += duration;
+}
+
+static void signal_finish(SignalBuilder* builder) {
+    if(builder->level) {
+        edges_push(builder->edges, builder->time);
+        builder->level = false;
+    }
+}
+
+static void signal_from_encoder(
+    Edges* edges,
+    ProtocolDict* dict,
+    ProtocolId protocol,
+    double start,
+    double span,
+    double skew,
+    double jitter) {
+    SignalBuilder builder = {.edges = edges, .level = false, .time = start};
+
+    protocol_dict_encoder_start(dict, protocol);
+    // random frame phase
+    for(uint32_t skip = random_u32() % 160; skip > 0; skip--) {
+        protocol_dict_encoder_yield(dict, protocol);
+    }
+
+    while(builder.time < start + span) {
+        LevelDuration segment = protocol_dict_encoder_yield(dict, protocol);
+        double duration = (double)level_duration_get_duration(segment) / CPU_CYCLES_PER_US;
+        duration *= skew * (1.0 + random_range(-jitter, jitter));
+        signal_append(&builder, level_duration_get_level(segment), duration);
+    }
+    signal_finish(&builder);
+}
+
+typedef struct {
+    bool level;
+    double duration;
+} Segment;
+
+typedef struct {
+    Segment* segments;
+    size_t count;
+} Recording;
+
+static void
+    signal_from_recording(Edges* edges, const Recording* recording, double start, double span) {
+    SignalBuilder builder = {.edges = edges, .level = false, .time = start};
+    size_t index = random_u32() % recording->count;
+
+    while(builder.time < start + span) {
+        const Segment* segment = &recording->segments[index];
+        signal_append(&builder, segment->level, segment->duration);
+        index = (index + 1) % recording->count;
+    }
+    signal_finish(&builder);
+}
+
+typedef struct {
+    ProtocolDict* decoders;
+    Edges edges;
+    uint8_t data[KEY_DATA_SIZE];
+} Replay;
+
+static ProtocolId replay_feed(Replay* replay, bool level, uint32_t duration_us) {
+    ProtocolId decoded =
+        protocol_dict_decoders_feed(replay->decoders, level, duration_us * CPU_CYCLES_PER_US);
+    if(decoded != PROTOCOL_NO) {
+        memset(replay->data, 0, sizeof(replay->data));
+        protocol_dict_get_data(replay->decoders, decoded, replay->data, sizeof(replay->data));
+    }
+    return decoded;
+}
+
+/* Legacy comparator window, returns window end time */
+static double legacy_window(Replay* replay, double window_start, ProtocolId* decoded) {
+    const Edges* edges = &replay->edges;
+    size_t index = edges_first_after(edges, window_start);
+    double last_timestamp = window_start;
+    double time = window_start;
+
+    *decoded = PROTOCOL_NO;
+    protocol_dict_decoders_start(replay->decoders);
+
+    while(true) {
+        // stream buffer receive, 100 ms timeout
+        double timestamp = 0;
+        bool received = false;
+        if(index < edges->count) {
+            timestamp = edges->time[index] + isr_latency();
+            received = timestamp <= time + LEGACY_WINDOW_US;
+        }
+        time = received ? timestamp : time + LEGACY_WINDOW_US;
+
+        if(time - window_start > LEGACY_WINDOW_US) break;
+
+        if(received) {
+            // rising edge ends low segment
+            bool level = index % 2;
+            uint32_t cycles = (timestamp - last_timestamp) * CPU_CYCLES_PER_US;
+            last_timestamp = timestamp;
+            index++;
+
+            ProtocolId protocol = protocol_dict_decoders_feed(replay->decoders, level, cycles);
+            if(protocol != PROTOCOL_NO && *decoded == PROTOCOL_NO) {
+                *decoded = protocol;
+                memset(replay->data, 0, sizeof(replay->data));
+                protocol_dict_get_data(
+                    replay->decoders, protocol, replay->data, sizeof(replay->data));
+            }
+        }
+    }
+
+    return time;
+}
+
+/* Input capture window, returns window end time */
+static double capture_window(Replay* replay, double window_start, ProtocolId* decoded) {
+    const Edges* edges = &replay->edges;
+    size_t index = edges_first_after(edges, window_start);
+    double counter_reset = window_start;
+    uint32_t last_pulse = 0;
+    double poll = window_start;
+
+    *decoded = PROTOCOL_NO;
+    protocol_dict_decoders_start(replay->decoders);
+
+    while(true) {
+        poll += CAPTURE_POLL_US;
+        bool window_end = (poll - window_start) >= CAPTURE_WINDOW_US;
+
+        while(index < edges->count && edges->time[index] < poll) {
+            double edge = edges->time[index];
+            uint32_t counter = edge - counter_reset;
+            ProtocolId protocol;
+
+            if(index % 2) {
+                // falling edge, channel 3: high time since rising edge
+                last_pulse = counter;
+                protocol = replay_feed(replay, true, counter);
+            } else {
+                // rising edge, channel 4: period, counter reset in ISR
+                uint32_t low_time = (counter > last_pulse) ? (counter - last_pulse) : counter;
+                last_pulse = 0;
+                counter_reset = edge + isr_latency();
+                protocol = replay_feed(replay, false, low_time);
+            }
+            index++;
+
+            if(protocol != PROTOCOL_NO) {
+                *decoded = protocol;
+                return poll;
+            }
+        }
+
+        if(window_end) return poll;
+    }
+}
+
+typedef enum {
+    ReadModeLegacy,
+    ReadModeCapture,
+} ReadMode;
+
+typedef struct {
+    double latency;
+    ProtocolId protocol;
+    bool dallas;
+} ReadResult;
+
+/* Read mode from start at time 0, key contact at given time */
+static ReadResult read_mode_run(Replay* replay, ReadMode mode, double contact, bool dallas) {
+    ReadResult result = {.latency = -1, .protocol = PROTOCOL_NO, .dallas = false};
+    double time = 0;
+
+    while(time < contact + READ_LIMIT_US) {
+        ProtocolId decoded;
+
+        if(mode == ReadModeLegacy) {
+            time += LEGACY_QUANT_US + LEGACY_SETTLE_US;
+            if(dallas && contact <= time) {
+                result.latency = time + SEARCH_KEY_US - contact;
+                result.dallas = true;
+                break;
+            }
+            time += SEARCH_EMPTY_US;
+            time = legacy_window(replay, time, &decoded);
+        } else {
+            time += CAPTURE_QUANT_US;
+            time = capture_window(replay, time, &decoded);
+        }
+
+        if(decoded != PROTOCOL_NO) {
+            result.latency = time - contact;
+            result.protocol = decoded;
+            break;
+        }
+
+        if(mode == ReadModeCapture) {
+            if(dallas && contact <= time) {
+                result.latency = time + SEARCH_KEY_US - contact;
+                result.dallas = true;
+                break;
+            }
+            time += SEARCH_EMPTY_US;
+        }
+    }
+
+    return result;
+}
+
+static void random_key(ProtocolId protocol, uint8_t* data) {
+    memset(data, 0, KEY_DATA_SIZE);
+    if(protocol == iButtonProtocolCyfral) {
+        data[0] = random_u32();
+        data[1] = random_u32();
+    } else {
+        // every Metakom byte has even parity
+        for(size_t i = 0; i < 4; i++) {
+            uint8_t byte = random_u32() & 0x7F;
+            data[i] = byte | (__builtin_parity(byte) << 7);
+        }
+    }
+}
+
+static void key_signal(
+    Replay* replay,
+    ProtocolDict* encoders,
+    ProtocolId protocol,
+    const uint8_t* data,
+    double start,
+    double span) {
+    protocol_dict_set_data(encoders, protocol, data, KEY_DATA_SIZE);
+    double skew = random_range(0.9, 1.1);
+    signal_from_encoder(&replay->edges, encoders, protocol, start, span, skew, 0.05);
+}
+
+static int run_check(unsigned keys) {
+    ProtocolDict* encoders = protocol_dict_alloc(ibutton_protocols, iButtonProtocolMax);
+    Replay replay = {.decoders = protocol_dict_alloc(ibutton_protocols, iButtonProtocolMax)};
+    const ProtocolId protocols[] = {iButtonProtocolCyfral, iButtonProtocolMetakom};
+    uint8_t key[KEY_DATA_SIZE];
+
+    for(size_t p = 0; p < sizeof(protocols) / sizeof(protocols[0]); p++) {
+        unsigned legacy_ok = 0;
+        unsigned capture_ok = 0;
+
+        for(unsigned i = 0; i < keys; i++) {
+            random_key(protocols[p], key);
+            edges_reset(&replay.edges);
+            key_signal(&replay, encoders, protocols[p], key, MS, 2 * LEGACY_WINDOW_US);
+
+            ProtocolId decoded;
+            legacy_window(&replay, 0, &decoded);
+            CHECK(decoded == protocols[p]);
+            if(decoded == protocols[p] && !memcmp(replay.data, key, KEY_DATA_SIZE)) {
+                legacy_ok++;
+            }
+
+            capture_window(&replay, 0, &decoded);
+            CHECK(decoded == protocols[p]);
+            CHECK(!memcmp(replay.data, key, KEY_DATA_SIZE));
+            if(decoded == protocols[p] && !memcmp(replay.data, key, KEY_DATA_SIZE)) {
+                capture_ok++;
+            }
+        }
+
+        printf(
+            "%-8s legacy %u/%u, capture %u/%u decoded\n",
+            protocol_dict_get_name(replay.decoders, protocols[p]),
+            legacy_ok,
+            keys,
+            capture_ok,
+            keys);
+    }
+
+    protocol_dict_free(encoders);
+    protocol_dict_free(replay.decoders);
+    free(replay.edges.time);
+
+    printf(check_failures ? "FAILED: %u checks\n" : "OK\n", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latency(
+    const char* name,
+    const char* mode,
+    double* latency,
+    unsigned count,
+    unsigned failed) {
+    if(count == 0) {
+        printf("%-8s %-8s no reads, %u failed\n", name, mode, failed);
+        return;
+    }
+
+    qsort(latency, count, sizeof(double), compare_double);
+    double sum = 0;
+    for(unsigned i = 0; i < count; i++) {
+        sum += latency[i];
+    }
+
+    printf(
+        "%-8s %-8s mean %6.1f ms  p50 %6.1f ms  p95 %6.1f ms  max %6.1f ms  failed %u\n",
+        name,
+        mode,
+        sum / count / MS,
+        latency[count / 2] / MS,
+        latency[(count * 95) / 100] / MS,
+        latency[count - 1] / MS,
+        failed);
+}
+
+typedef enum {
+    KeySourceEncoder,
+    KeySourceRecording,
+    KeySourceDallas,
+} KeySource;
+
+static void run_latency(
+    const char* name,
+    KeySource source,
+    ProtocolId protocol,
+    const Recording* recording,
+    unsigned contacts) {
+    ProtocolDict* encoders = protocol_dict_alloc(ibutton_protocols, iButtonProtocolMax);
+    Replay replay = {.decoders = protocol_dict_alloc(ibutton_protocols, iButtonProtocolMax)};
+    const ReadMode modes[] = {ReadModeLegacy, ReadModeCapture};
+    const char* mode_names[] = {"legacy", "capture"};
+    double* latency = malloc(contacts * sizeof(double));
+    uint8_t key[KEY_DATA_SIZE];
+
+    for(size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        unsigned count = 0;
+        unsigned failed = 0;
+        unsigned decoded_as[iButtonProtocolMax] = {0};
+        // same contacts and keys for both modes
+        rng_state = 0x9E3779B97F4A7C15ULL;
+
+        for(unsigned i = 0; i < contacts; i++) {
+            double contact = random_range(0, CONTACT_SPAN_US);
+            double start = contact + KEY_POWER_UP_US;
+            edges_reset(&replay.edges);
+
+            if(source == KeySourceEncoder) {
+                random_key(protocol, key);
+                key_signal(&replay, encoders, protocol, key, start, SIGNAL_SPAN_US);
+            } else if(source == KeySourceRecording) {
+                signal_from_recording(&replay.edges, recording, start, SIGNAL_SPAN_US);
+            }
+
+            ReadResult result =
+                read_mode_run(&replay, modes[m], contact, source == KeySourceDallas);
+
+            bool valid = result.latency >= 0;
+            if(source == KeySourceEncoder) {
+                valid = valid && result.protocol == protocol &&
+                        !memcmp(replay.data, key, KEY_DATA_SIZE);
+            } else if(source == KeySourceDallas) {
+                valid = valid && result.dallas;
+            }
+
+            if(valid) {
+                latency[count++] = result.latency;
+                if(result.protocol != PROTOCOL_NO) decoded_as[result.protocol]++;
+            } else {
+                failed++;
+            }
+        }
+
+        print_latency(name, mode_names[m], latency, count, failed);
+        if(source == KeySourceRecording) {
+            for(size_t p = 0; p < iButtonProtocolMax; p++) {
+                printf(
+                    "%17s as %s: %u\n",
+                    "",
+                    protocol_dict_get_name(replay.decoders, p),
+                    decoded_as[p]);
+            }
+        }
+    }
+
+    free(latency);
+    protocol_dict_free(encoders);
+    protocol_dict_free(replay.decoders);
+    free(replay.edges.time);
+}
+
+static int run_bench(unsigned contacts) {
+    run_latency("Cyfral", KeySourceEncoder, iButtonProtocolCyfral, NULL, contacts);
+    run_latency("Metakom", KeySourceEncoder, iButtonProtocolMetakom, NULL, contacts);
+    run_latency("DS1990", KeySourceDallas, PROTOCOL_NO, NULL, contacts);
+    return 0;
+}
+
+static int run_replay(const char* path, unsigned contacts) {
+    FILE* file = fopen(path, "r");
+    if(!file) {
+        printf("cannot open %s\n", path);
+        return 2;
+    }
+
+    Recording recording = {0};
+    size_t capacity = 0;
+    int level;
+    double duration;
+    while(fscanf(file, "%d %lf", &level, &duration) == 2) {
+        if(recording.count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            recording.segments = realloc(recording.segments, capacity * sizeof(Segment));
+            furi_check(recording.segments);
+        }
+        recording.segments[recording.count++] = (Segment){.level = level, .duration = duration};
+    }
+    fclose(file);
+
+    if(recording.count == 0) {
+        printf("no segments in %s\n", path);
+        return 2;
+    }
+
+    printf("%zu segments\n", recording.count);
+    run_latency("recorded", KeySourceRecording, PROTOCOL_NO, &recording, contacts);
+    free(recording.segments);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        printf("usage: %s check [keys] | bench [contacts] | replay <file> [contacts]\n", argv[0]);
+        return 2;
+    }
+
+    if(!strcmp(argv[1], "check")) {
+        return run_check(argc > 2 ? strtoul(argv[2], NULL, 10) : 1000);
+    } else if(!strcmp(argv[1], "bench")) {
+        return run_bench(argc > 2 ? strtoul(argv[2], NULL, 10) : 2000);
+    } else if(!strcmp(argv[1], "replay") && argc > 2) {
+        return run_replay(argv[2], argc > 3 ? strtoul(argv[3], NULL, 10) : 2000);
+    }
+
+    printf("unknown mode %s\n", argv[1]);
+    return 2;
+}
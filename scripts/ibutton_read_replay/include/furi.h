@@ -0,0 +1,25 @@
+#pragma once
+
+/* Host shim: minimal subset of furi core used by iButton protocols */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef UNUSED
+#define UNUSED(X) (void)(X)
+#endif
+
+#define furi_check(x)                                                                 \
+    do {                                                                              \
+        if(!(x)) {                                                                    \
+            fprintf(stderr, "furi_check failed: %s:%d %s\n", __FILE__, __LINE__, #x); \
+            abort();                                                                  \
+        }                                                                             \
+    } while(0)
+
+#define furi_assert(x) furi_check(x)
+
+typedef struct FuriString FuriString;
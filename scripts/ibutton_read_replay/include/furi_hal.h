@@ -0,0 +1,9 @@
+#pragma once
+
+/* Host shim: cpu clock used by iButton protocol timings */
+
+#include <stdint.h>
+
+static inline uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
@@ -0,0 +1,103 @@
+#include "lfs_flash_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* STM32WB55 datasheet, typical */
+#define LFS_FLASH_SIM_PROG_DWORD_US 82
+#define LFS_FLASH_SIM_ERASE_PAGE_US 22350
+
+static int lfs_flash_sim_read(
+    const struct lfs_config* c,
+    lfs_block_t block,
+    lfs_off_t off,
+    void* buffer,
+    lfs_size_t size) {
+    LfsFlashSim* sim = c->context;
+
+    if(off % c->read_size || size % c->read_size) {
+        printf("Unaligned read: block %u, off %u, size %u\n", block, off, size);
+        return LFS_ERR_IO;
+    }
+
+    sim->stats.reads++;
+    sim->stats.bytes_read += size;
+    memcpy(buffer, sim->data + block * c->block_size + off, size);
+    return 0;
+}
+
+static int lfs_flash_sim_prog(
+    const struct lfs_config* c,
+    lfs_block_t block,
+    lfs_off_t off,
+    const void* buffer,
+    lfs_size_t size) {
+    LfsFlashSim* sim = c->context;
+    uint8_t* address = sim->data + block * c->block_size + off;
+    const uint8_t* data = buffer;
+
+    if(off % c->prog_size || size % c->prog_size) {
+        printf("Unaligned prog: block %u, off %u, size %u\n", block, off, size);
+        return LFS_ERR_IO;
+    }
+
+    for(lfs_size_t i = 0; i < size; i++) {
+        if(~address[i] & data[i]) {
+            printf("Prog over programmed bits: block %u, off %u\n", block, off + i);
+            return LFS_ERR_IO;
+        }
+        address[i] &= data[i];
+    }
+
+    sim->stats.progs++;
+    sim->stats.bytes_programmed += size;
+    sim->busy_us += (uint64_t)(size / c->prog_size) * LFS_FLASH_SIM_PROG_DWORD_US;
+    return 0;
+}
+
+static int lfs_flash_sim_erase(const struct lfs_config* c, lfs_block_t block) {
+    LfsFlashSim* sim = c->context;
+
+    sim->stats.erases++;
+    sim->busy_us += LFS_FLASH_SIM_ERASE_PAGE_US;
+    memset(sim->data + block * c->block_size, 0xFF, c->block_size);
+    return 0;
+}
+
+static int lfs_flash_sim_sync(const struct lfs_config* c) {
+    (void)c;
+    return 0;
+}
+
+void lfs_flash_sim_init(LfsFlashSim* sim, struct lfs_config* config, uint32_t block_count) {
+    memset(sim, 0, sizeof(LfsFlashSim));
+    sim->data = malloc((size_t)block_count * LFS_FLASH_SIM_BLOCK_SIZE);
+    memset(sim->data, 0xFF, (size_t)block_count * LFS_FLASH_SIM_BLOCK_SIZE);
+
+    memset(config, 0, sizeof(struct lfs_config));
+    config->context = sim;
+    config->read = lfs_flash_sim_read;
+    config->prog = lfs_flash_sim_prog;
+    config->erase = lfs_flash_sim_erase;
+    config->sync = lfs_flash_sim_sync;
+    config->read_size = LFS_FLASH_SIM_READ_SIZE;
+    config->prog_size = LFS_FLASH_SIM_PROG_SIZE;
+    config->block_size = LFS_FLASH_SIM_BLOCK_SIZE;
+    config->block_count = block_count;
+    config->block_cycles = LFS_FLASH_SIM_BLOCK_CYCLES;
+}
+
+void lfs_flash_sim_free(LfsFlashSim* sim) {
+    free(sim->data);
+    sim->data = NULL;
+}
+
+void lfs_flash_sim_reset_stats(LfsFlashSim* sim) {
+    uint32_t cache_size = sim->stats.cache_size;
+    uint32_t lookahead_size = sim->stats.lookahead_size;
+    memset(&sim->stats, 0, sizeof(StorageIntStats));
+    sim->stats.cache_size = cache_size;
+    sim->stats.lookahead_size = lookahead_size;
+    sim->busy_us = 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * RAM-backed internal flash for littlefs.
+ *
+ * Same geometry as storage_int.c sets up on STM32WB: 8 byte reads and double
+ * word programs, 4 KiB pages. Programs are checked against NOR semantics, so
+ * a bit can only go from 1 to 0 until its page is erased. Program and erase
+ * busy time is accumulated from datasheet typical values.
+ */
+
+#include <stdint.h>
+#include <lfs.h>
+#include <storage_int_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LFS_FLASH_SIM_READ_SIZE 8
+#define LFS_FLASH_SIM_PROG_SIZE 8
+#define LFS_FLASH_SIM_BLOCK_SIZE 4096
+#define LFS_FLASH_SIM_BLOCK_CYCLES 10000
+
+typedef struct {
+    uint8_t* data;
+    StorageIntStats stats;
+    uint64_t busy_us; /**< Simulated program and erase time */
+} LfsFlashSim;
+
+/** Allocate erased flash and fill in block device part of lfs config
+ *
+ * Cache and lookahead sizes are left for the caller to set.
+ *
+ * @param      sim          simulator instance
+ * @param      config       lfs config, context and callbacks point to sim
+ * @param      block_count  flash size in pages
+ */
+void lfs_flash_sim_init(LfsFlashSim* sim, struct lfs_config* config, uint32_t block_count);
+
+/** Free flash contents */
+void lfs_flash_sim_free(LfsFlashSim* sim);
+
+/** Clear counters and busy time, keep flash contents and config sizes */
+void lfs_flash_sim_reset_stats(LfsFlashSim* sim);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,222 @@
+/**
+ * Internal storage littlefs configuration benchmark on RAM-backed flash.
+ *
+ * Runs the same workload with the old fixed 16 byte caches and with
+ * storage_int_config_tune() for a range of free heap sizes, then reports
+ * block device calls, bytes, erases, simulated flash busy time and host time.
+ * Like the storage service, free space is checked before every file open.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o lfs_flash_sim_bench -Ilib/littlefs -Iscripts/lfs_flash_sim \
+ *      -Iapplications/services/storage/storages \
+ *      scripts/lfs_flash_sim/lfs_flash_sim.c scripts/lfs_flash_sim/lfs_flash_sim_bench.c \
+ *      applications/services/storage/storages/storage_int_config.c \
+ *      lib/littlefs/lfs.c lib/littlefs/lfs_util.c
+ *  ./lfs_flash_sim_bench 128
+ */
+
+#include "lfs_flash_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DIRS 4
+#define BENCH_FILES 48
+#define BENCH_IO_CHUNK 64
+#define BENCH_BLOCK_COUNT_DEFAULT 128
+
+static const uint32_t bench_file_sizes[] = {24, 200, 700, 2000, 6000, 16000};
+static const size_t bench_free_heaps[] = {32 * 1024, 64 * 1024, 128 * 1024, 192 * 1024};
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint8_t bench_pattern(uint32_t file, uint32_t offset) {
+    return (uint8_t)(file * 7 + offset + (offset >> 8));
+}
+
+static void bench_path(char* path, size_t size, uint32_t file) {
+    snprintf(path, size, "/d%u/f%u", file % BENCH_DIRS, file);
+}
+
+static bool bench_open(lfs_t* lfs, lfs_file_t* file, const char* path, int flags) {
+    /* storage_int_check_for_free_space() */
+    if(lfs_fs_size(lfs) < 0) return false;
+    return lfs_file_open(lfs, file, path, flags) == 0;
+}
+
+static bool bench_write_file(lfs_t* lfs, uint32_t index, uint32_t seed) {
+    char path[32];
+    bench_path(path, sizeof(path), index);
+    uint32_t size = bench_file_sizes[index % (sizeof(bench_file_sizes) / sizeof(uint32_t))];
+
+    lfs_file_t file;
+    if(!bench_open(lfs, &file, path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC)) return false;
+
+    uint8_t buffer[BENCH_IO_CHUNK];
+    for(uint32_t offset = 0; offset < size; offset += BENCH_IO_CHUNK) {
+        uint32_t chunk = size - offset < BENCH_IO_CHUNK ? size - offset : BENCH_IO_CHUNK;
+        for(uint32_t i = 0; i < chunk; i++) {
+            buffer[i] = bench_pattern(index + seed, offset + i);
+        }
+        if(lfs_file_write(lfs, &file, buffer, chunk) != (lfs_ssize_t)chunk) {
+            lfs_file_close(lfs, &file);
+            return false;
+        }
+    }
+
+    return lfs_file_close(lfs, &file) == 0;
+}
+
+static bool bench_read_file(lfs_t* lfs, uint32_t index, uint32_t seed) {
+    char path[32];
+    bench_path(path, sizeof(path), index);
+    uint32_t size = bench_file_sizes[index % (sizeof(bench_file_sizes) / sizeof(uint32_t))];
+
+    lfs_file_t file;
+    if(!bench_open(lfs, &file, path, LFS_O_RDONLY)) return false;
+
+    bool result = true;
+    uint8_t buffer[BENCH_IO_CHUNK];
+    uint32_t offset = 0;
+    lfs_ssize_t read_size;
+    while((read_size = lfs_file_read(lfs, &file, buffer, sizeof(buffer))) > 0) {
+        for(lfs_ssize_t i = 0; i < read_size; i++) {
+            if(buffer[i] != bench_pattern(index + seed, offset + i)) result = false;
+        }
+        offset += read_size;
+    }
+
+    lfs_file_close(lfs, &file);
+    return result && read_size == 0 && offset == size;
+}
+
+static bool bench_list(lfs_t* lfs) {
+    char path[16];
+    for(uint32_t d = 0; d < BENCH_DIRS; d++) {
+        snprintf(path, sizeof(path), "/d%u", d);
+        lfs_dir_t dir;
+        if(lfs_dir_open(lfs, &dir, path) != 0) return false;
+        struct lfs_info info;
+        while(lfs_dir_read(lfs, &dir, &info) > 0) {
+            struct lfs_info stat;
+            char file_path[LFS_NAME_MAX + 32];
+            snprintf(file_path, sizeof(file_path), "%s/%s", path, info.name);
+            if(info.type == LFS_TYPE_REG && lfs_stat(lfs, file_path, &stat) != 0) {
+                lfs_dir_close(lfs, &dir);
+                return false;
+            }
+        }
+        lfs_dir_close(lfs, &dir);
+    }
+    return true;
+}
+
+static bool bench_workload(lfs_t* lfs, const struct lfs_config* config) {
+    char path[32];
+
+    if(lfs_format(lfs, config) != 0 || lfs_mount(lfs, config) != 0) return false;
+
+    for(uint32_t d = 0; d < BENCH_DIRS; d++) {
+        snprintf(path, sizeof(path), "/d%u", d);
+        if(lfs_mkdir(lfs, path) != 0) return false;
+    }
+
+    for(uint32_t i = 0; i < BENCH_FILES; i++) {
+        if(!bench_write_file(lfs, i, 0)) return false;
+    }
+    for(uint32_t i = 0; i < BENCH_FILES; i++) {
+        if(!bench_read_file(lfs, i, 0)) return false;
+    }
+    if(!bench_list(lfs)) return false;
+
+    /* Remove every third file, rewrite every second one */
+    for(uint32_t i = 0; i < BENCH_FILES; i += 3) {
+        bench_path(path, sizeof(path), i);
+        if(lfs_remove(lfs, path) != 0) return false;
+    }
+    for(uint32_t i = 1; i < BENCH_FILES; i += 2) {
+        if(i % 3 && !bench_write_file(lfs, i, 1)) return false;
+    }
+
+    if(lfs_unmount(lfs) != 0 || lfs_mount(lfs, config) != 0) return false;
+
+    for(uint32_t i = 0; i < BENCH_FILES; i++) {
+        if(i % 3 == 0) continue;
+        if(!bench_read_file(lfs, i, i % 2)) return false;
+    }
+    if(!bench_list(lfs)) return false;
+
+    return lfs_unmount(lfs) == 0;
+}
+
+static bool bench_run(const char* name, uint32_t block_count, size_t free_heap) {
+    LfsFlashSim sim;
+    struct lfs_config config;
+    lfs_t lfs;
+
+    lfs_flash_sim_init(&sim, &config, block_count);
+    if(free_heap) {
+        storage_int_config_tune(&config, free_heap);
+    } else {
+        config.cache_size = 16;
+        config.lookahead_size = 16;
+    }
+    sim.stats.cache_size = config.cache_size;
+    sim.stats.lookahead_size = config.lookahead_size;
+
+    double start = bench_time();
+    bool result = bench_workload(&lfs, &config);
+    double elapsed = bench_time() - start;
+
+    printf(
+        "%-10s %5u %5u %8u %8u %7u %8u %6u %9.1f %8.1f %s\n",
+        name,
+        sim.stats.cache_size,
+        sim.stats.lookahead_size,
+        sim.stats.reads,
+        sim.stats.bytes_read / 1024,
+        sim.stats.progs,
+        sim.stats.bytes_programmed / 1024,
+        sim.stats.erases,
+        sim.busy_us / 1000.0,
+        elapsed * 1000.0,
+        result ? "OK" : "FAILED");
+
+    lfs_flash_sim_free(&sim);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    uint32_t block_count = argc > 1 ? (uint32_t)atoi(argv[1]) : BENCH_BLOCK_COUNT_DEFAULT;
+    int failed = 0;
+
+    printf("%u pages of %u bytes\n", block_count, LFS_FLASH_SIM_BLOCK_SIZE);
+    printf(
+        "%-10s %5s %5s %8s %8s %7s %8s %6s %9s %8s\n",
+        "heap",
+        "cache",
+        "look",
+        "reads",
+        "read KiB",
+        "progs",
+        "prog KiB",
+        "erases",
+        "flash ms",
+        "host ms");
+
+    if(!bench_run("fixed", block_count, 0)) failed++;
+    for(size_t i = 0; i < sizeof(bench_free_heaps) / sizeof(size_t); i++) {
+        char name[24];
+        snprintf(name, sizeof(name), "%zuK", bench_free_heaps[i] / 1024);
+        if(!bench_run(name, block_count, bench_free_heaps[i])) failed++;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * Host benchmark and self-test for lib/toolbox/md5.c
+ *
+ * Checks RFC 1321 test suite digests, then hashes a buffer in chunk sizes used
+ * by storage hashing and reports MB/s.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o md5_bench -Ilib/toolbox scripts/md5_bench/md5_bench.c lib/toolbox/md5.c
+ *  ./md5_bench
+ *
+ * Add -Os to see numbers closer to firmware build flags.
+ */
+
+#include "md5.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DATA_SIZE (1024 * 1024)
+#define BENCH_ROUNDS 64
+
+static const struct {
+    const char* input;
+    const char* digest;
+} md5_test_suite[] = {
+    {"", "d41d8cd98f00b204e9800998ecf8427e"},
+    {"a", "0cc175b9c0f1b6a831c399e269772661"},
+    {"abc", "900150983cd24fb0d6963f7d28e17f72"},
+    {"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+    {"abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+    {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+     "d174ab98d277d9f5a5611c2c9f419d9f"},
+    {"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+     "57edf4a22be3c955ac49da2e2107b67a"},
+};
+
+static void md5_to_hex(const unsigned char digest[16], char hex[33]) {
+    for(size_t i = 0; i < 16; i++) {
+        snprintf(&hex[i * 2], 3, "%02x", digest[i]);
+    }
+}
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void) {
+    int failed = 0;
+    unsigned char digest[16];
+    char hex[33];
+
+    for(size_t i = 0; i < sizeof(md5_test_suite) / sizeof(md5_test_suite[0]); i++) {
+        const char* input = md5_test_suite[i].input;
+        md5((const unsigned char*)input, strlen(input), digest);
+        md5_to_hex(digest, hex);
+        if(strcmp(hex, md5_test_suite[i].digest) != 0) {
+            printf("FAIL md5(\"%s\") = %s\n", input, hex);
+            failed++;
+        }
+    }
+
+    /* Unaligned input, fed in odd pieces */
+    static unsigned char data[BENCH_DATA_SIZE + 1];
+    for(size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char)(i * 31 + (i >> 8));
+    }
+    unsigned char reference[16];
+    md5(data + 1, BENCH_DATA_SIZE, reference);
+
+    md5_context ctx;
+    md5_starts(&ctx);
+    for(size_t offset = 0, piece = 1; offset < BENCH_DATA_SIZE; piece = piece * 3 % 1021 + 1) {
+        size_t size = piece < BENCH_DATA_SIZE - offset ? piece : BENCH_DATA_SIZE - offset;
+        md5_update(&ctx, data + 1 + offset, size);
+        offset += size;
+    }
+    md5_finish(&ctx, digest);
+    if(memcmp(digest, reference, sizeof(digest)) != 0) {
+        printf("FAIL piecewise update\n");
+        failed++;
+    }
+
+    const size_t chunks[] = {512, 4096, BENCH_DATA_SIZE};
+    for(size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        double start = bench_time();
+        for(int round = 0; round < BENCH_ROUNDS; round++) {
+            md5_starts(&ctx);
+            for(size_t offset = 0; offset < BENCH_DATA_SIZE; offset += chunks[c]) {
+                md5_update(&ctx, data, chunks[c]);
+            }
+            md5_finish(&ctx, digest);
+        }
+        double elapsed = bench_time() - start;
+        printf(
+            "chunk %7zu: %8.1f MB/s\n",
+            chunks[c],
+            BENCH_ROUNDS * (BENCH_DATA_SIZE / (1024.0 * 1024.0)) / elapsed);
+    }
+
+    printf(failed ? "%d check(s) failed\n" : "All checks passed\n", failed);
+    return failed ? 1 : 0;
+}
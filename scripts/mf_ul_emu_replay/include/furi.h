@@ -0,0 +1,112 @@
+#pragma once
+
+/* Host shim: minimal subset of furi core used by MIFARE Ultralight emulation */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef UNUSED
+#define UNUSED(X) (void)(X)
+#endif
+
+#define furi_check(x)                                                                 \
+    do {                                                                              \
+        if(!(x)) {                                                                    \
+            fprintf(stderr, "furi_check failed: %s:%d %s\n", __FILE__, __LINE__, #x); \
+            abort();                                                                  \
+        }                                                                             \
+    } while(0)
+
+#define furi_assert(x) furi_check(x)
+
+#define furi_crash(message)                                                     \
+    do {                                                                        \
+        fprintf(stderr, "furi_crash: %s:%d %s\n", __FILE__, __LINE__, message); \
+        abort();                                                                \
+    } while(0)
+
+// Logs are dropped; no format check because uint32_t is not long on host
+static inline void furi_log_host(const char* tag, const char* format, ...) {
+    (void)tag;
+    (void)format;
+}
+
+#define FURI_LOG_E(tag, format, ...) furi_log_host(tag, format, ##__VA_ARGS__)
+#define FURI_LOG_W(tag, format, ...) furi_log_host(tag, format, ##__VA_ARGS__)
+#define FURI_LOG_I(tag, format, ...) furi_log_host(tag, format, ##__VA_ARGS__)
+#define FURI_LOG_D(tag, format, ...) furi_log_host(tag, format, ##__VA_ARGS__)
+#define FURI_LOG_T(tag, format, ...) furi_log_host(tag, format, ##__VA_ARGS__)
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} FuriString;
+
+static inline FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    string->capacity = 16;
+    string->data = malloc(string->capacity);
+    string->data[0] = '\0';
+    string->size = 0;
+    return string;
+}
+
+static inline void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+static inline void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+static inline size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+static inline size_t furi_string_utf8_length(FuriString* string) {
+    return string->size;
+}
+
+static inline const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+static inline void furi_string_reserve_host(FuriString* string, size_t size) {
+    if(size + 1 > string->capacity) {
+        while(size + 1 > string->capacity) string->capacity *= 2;
+        string->data = realloc(string->data, string->capacity);
+    }
+}
+
+static inline void furi_string_cat(FuriString* string, const char* cstr) {
+    size_t len = strlen(cstr);
+    furi_string_reserve_host(string, string->size + len);
+    memcpy(&string->data[string->size], cstr, len + 1);
+    string->size += len;
+}
+
+static inline int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    furi_string_reserve_host(string, string->size + len);
+    va_start(args, format);
+    vsnprintf(&string->data[string->size], len + 1, format, args);
+    va_end(args);
+    string->size += len;
+    return len;
+}
+
+static inline void furi_string_trim(FuriString* string) {
+    while(string->size > 0 && string->data[string->size - 1] == ' ') {
+        string->data[--string->size] = '\0';
+    }
+}
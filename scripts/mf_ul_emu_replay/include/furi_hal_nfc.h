@@ -0,0 +1,71 @@
+#pragma once
+
+/* Host shim: NFC HAL types used by MIFARE Ultralight, no transceiver behind it */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FURI_HAL_NFC_UID_MAX_LEN 10
+#define FURI_HAL_NFC_DATA_BUFF_SIZE (512)
+#define FURI_HAL_NFC_PARITY_BUFF_SIZE (FURI_HAL_NFC_DATA_BUFF_SIZE / 8)
+
+// Distinct values instead of RFAL flags, emulation only reports them back
+#define FURI_HAL_NFC_TXRX_DEFAULT (0x01UL)
+#define FURI_HAL_NFC_TX_RAW_RX_DEFAULT (0x02UL)
+
+typedef enum {
+    FuriHalNfcTxRxTypeDefault,
+    FuriHalNfcTxRxTypeRxNoCrc,
+    FuriHalNfcTxRxTypeRxKeepPar,
+    FuriHalNfcTxRxTypeRaw,
+    FuriHalNfcTxRxTypeRxRaw,
+    FuriHalNfcTxRxTransparent,
+} FuriHalNfcTxRxType;
+
+typedef enum {
+    FuriHalNfcTypeA,
+    FuriHalNfcTypeB,
+    FuriHalNfcTypeF,
+    FuriHalNfcTypeV,
+} FuriHalNfcType;
+
+typedef enum {
+    FuriHalNfcInterfaceRf,
+    FuriHalNfcInterfaceIsoDep,
+    FuriHalNfcInterfaceNfcDep,
+} FuriHalNfcInterface;
+
+typedef struct {
+    FuriHalNfcType type;
+    FuriHalNfcInterface interface;
+    uint8_t uid_len;
+    uint8_t uid[10];
+    uint32_t cuid;
+    uint8_t atqa[2];
+    uint8_t sak;
+} FuriHalNfcDevData;
+
+typedef struct {
+    uint8_t tx_data[FURI_HAL_NFC_DATA_BUFF_SIZE];
+    uint8_t tx_parity[FURI_HAL_NFC_PARITY_BUFF_SIZE];
+    uint16_t tx_bits;
+    uint8_t rx_data[FURI_HAL_NFC_DATA_BUFF_SIZE];
+    uint8_t rx_parity[FURI_HAL_NFC_PARITY_BUFF_SIZE];
+    uint16_t rx_bits;
+    FuriHalNfcTxRxType tx_rx_type;
+} FuriHalNfcTxRxContext;
+
+static inline bool furi_hal_nfc_tx_rx(FuriHalNfcTxRxContext* tx_rx, uint16_t timeout_ms) {
+    (void)tx_rx;
+    (void)timeout_ms;
+    return false;
+}
+
+static inline bool furi_hal_nfc_activate_nfca(uint32_t timeout, uint32_t* cuid) {
+    (void)timeout;
+    (void)cuid;
+    return false;
+}
+
+static inline void furi_hal_nfc_sleep(void) {
+}
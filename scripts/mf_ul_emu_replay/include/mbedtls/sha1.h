@@ -0,0 +1,13 @@
+/**
+ * Host stand-in for mbedtls/sha1.h used by password generators, backed by OpenSSL SHA1.
+ */
+#pragma once
+
+#define OPENSSL_SUPPRESS_DEPRECATED
+#include <openssl/sha.h>
+
+static inline int
+    mbedtls_sha1(const unsigned char* input, size_t ilen, unsigned char output[20]) {
+    SHA1(input, ilen, output);
+    return 0;
+}
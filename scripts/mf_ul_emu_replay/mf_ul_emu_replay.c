@@ -0,0 +1,418 @@
+/**
+ * Host replay test and benchmark of MIFARE Ultralight/NTAG emulation READ image
+ *
+ * check: random command sequences are replayed into two emulators prepared
+ * from the same random dump. One serves READ and FAST_READ from read image,
+ * other one has read_image_pages cleared, so it composes every response as
+ * before: auth checks, PWD/PACK blanking and ASCII mirror per command.
+ * Responses, frame flags and emulator data must be equal after every command.
+ *
+ * Two legacy FAST_READ defects are fixed by read image and such commands are
+ * not replayed: buffer overrun when ASCII mirror starts past the end of
+ * requested window, and PACK returned unblanked when window starts on it.
+ *
+ * bench: nanoseconds per READ and FAST_READ over ASCII mirrored NTAG215 pages
+ * for both emulators.
+ *
+ * Build and run from the repository root:
+ *
+ * Config page bitfields need firmware enum size, hence -fshort-enums.
+ *
+ *  gcc -O2 -fshort-enums -o mf_ul_emu_replay -Iscripts/mf_ul_emu_replay/include -I. \
+ *      scripts/mf_ul_emu_replay/mf_ul_emu_replay.c lib/nfc/protocols/mifare_ultralight.c \
+ *      lib/nfc/protocols/nfc_util.c -lcrypto
+ *  ./mf_ul_emu_replay check [sequences]
+ *  ./mf_ul_emu_replay bench [reads]
+ */
+
+#include <lib/nfc/protocols/mifare_ultralight.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REPLAY_COMMANDS 400
+#define TX_BUFF_SIZE 1024
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if(!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while(0)
+
+typedef struct {
+    MfUltralightType type;
+    uint16_t pages;
+    const char* name;
+} TagLayout;
+
+static const TagLayout tag_layouts[] = {
+    {MfUltralightTypeUnknown, 16, "MFUL"},
+    {MfUltralightTypeNTAG203, 42, "NTAG203"},
+    {MfUltralightTypeUL11, 20, "UL11"},
+    {MfUltralightTypeUL21, 41, "UL21"},
+    {MfUltralightTypeNTAG213, 45, "NTAG213"},
+    {MfUltralightTypeNTAG215, 135, "NTAG215"},
+    {MfUltralightTypeNTAG216, 231, "NTAG216"},
+};
+
+#define TAG_LAYOUTS_COUNT (sizeof(tag_layouts) / sizeof(tag_layouts[0]))
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t random_u32(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state >> 16;
+}
+
+static uint8_t random_byte(void) {
+    return random_u32() & 0xFF;
+}
+
+static void random_dump(MfUltralightData* data, const TagLayout* layout) {
+    memset(data, 0, sizeof(MfUltralightData));
+    data->type = layout->type;
+    data->data_size = layout->pages * 4;
+    data->data_read = data->data_size;
+    for(size_t i = 0; i < data->data_size; i++) {
+        data->data[i] = random_byte();
+    }
+    for(size_t i = 0; i < sizeof(data->signature); i++) {
+        data->signature[i] = random_byte();
+    }
+    for(size_t i = 0; i < 3; i++) {
+        data->counter[i] = random_u32() & 0xFFFFFF;
+        data->tearing[i] = MF_UL_TEARING_FLAG_DEFAULT;
+    }
+
+    // Mostly unlocked, otherwise writes are rarely accepted
+    if(random_byte() & 3) {
+        data->data[10] = 0;
+        data->data[11] = 0;
+    }
+    if(layout->type == MfUltralightTypeNTAG203) {
+        if(random_byte() & 3) {
+            data->data[0x28 * 4] = 0;
+            data->data[0x28 * 4 + 1] = 0;
+        }
+    } else if(layout->type >= MfUltralightTypeUL21) {
+        uint16_t dynamic_lock_page = layout->pages - 5;
+        if(random_byte() & 3) memset(&data->data[dynamic_lock_page * 4], 0, 3);
+    }
+
+    MfUltralightConfigPages* config = mf_ultralight_get_config_pages(data);
+    if(config) {
+        config->mirror.mirror_conf = random_byte() & 3;
+        config->mirror.mirror_byte = random_byte() & 3;
+        config->mirror_page = random_byte() % (layout->pages + 8);
+        config->auth0 = (random_byte() & 1) ? 0xFF : random_byte() % layout->pages;
+        config->access.value = random_byte();
+        if(random_byte() & 1) config->access.cfglck = false;
+        config->access.authlim = 0;
+    }
+}
+
+typedef struct {
+    uint8_t rx[32];
+    uint16_t rx_bits;
+} ReplayCommand;
+
+static void replay_command_set(ReplayCommand* command, const uint8_t* rx, size_t rx_len) {
+    memcpy(command->rx, rx, rx_len);
+    command->rx_bits = rx_len * 8;
+}
+
+static uint16_t random_write_page(const TagLayout* layout) {
+    // UL11 config pages are not covered by lock check and crash it
+    uint16_t pages = layout->type == MfUltralightTypeUL11 ? 16 : layout->pages;
+    return 2 + random_u32() % (pages - 2);
+}
+
+static bool random_command(
+    ReplayCommand* command,
+    const TagLayout* layout,
+    MfUltralightEmulator* reference) {
+    uint8_t rx[32];
+    for(size_t i = 0; i < sizeof(rx); i++) {
+        rx[i] = random_byte();
+    }
+
+    switch(random_u32() % 12) {
+    case 0:
+    case 1:
+    case 2:
+        rx[0] = MF_UL_READ_CMD;
+        rx[1] = random_u32() % (layout->pages + 4);
+        replay_command_set(command, rx, 2);
+        break;
+    case 3:
+    case 4: {
+        rx[0] = MF_UL_FAST_READ_CMD;
+        rx[1] = random_u32() % (layout->pages + 2);
+        rx[2] = (random_byte() & 1) ? rx[1] + random_u32() % 8 : random_u32() % layout->pages;
+        if(reference->supported_features & MfUltralightSupportAsciiMirror &&
+           reference->config_cache.mirror.mirror_conf != MfUltralightMirrorNone) {
+            uint16_t mirror_offset =
+                reference->config->mirror_page * 4 + reference->config->mirror.mirror_byte;
+            if(rx[1] <= rx[2] && mirror_offset > (rx[2] + 1) * 4) return false;
+        }
+        if(reference->supported_features & MfUltralightSupportAuth &&
+           rx[1] == reference->page_num - 1)
+            return false;
+        replay_command_set(command, rx, 3);
+        break;
+    }
+    case 5:
+    case 6:
+        rx[0] = MF_UL_WRITE;
+        rx[1] = random_write_page(layout);
+        replay_command_set(command, rx, 6);
+        break;
+    case 7:
+        rx[0] = MF_UL_COMP_WRITE;
+        rx[1] = random_write_page(layout);
+        replay_command_set(command, rx, 2);
+        break;
+    case 8:
+        rx[0] = MF_UL_INC_CNT;
+        rx[1] = random_byte() % 3;
+        rx[3] = 0;
+        rx[4] = 0;
+        replay_command_set(command, rx, 6);
+        break;
+    case 9:
+        rx[0] = MF_UL_AUTH;
+        if(reference->config && (random_byte() & 1)) {
+            memcpy(&rx[1], reference->config->auth_data.pwd.raw, 4);
+        }
+        replay_command_set(command, rx, 5);
+        break;
+    case 10: {
+        static const uint8_t other_commands[] = {
+            MF_UL_READ_CNT,
+            MF_UL_GET_VERSION_CMD,
+            MF_UL_READ_SIG,
+            MF_UL_CHECK_TEARING,
+            MF_UL_HALT_START,
+        };
+        rx[0] = other_commands[random_u32() % sizeof(other_commands)];
+        rx[1] = random_byte() % 4;
+        replay_command_set(command, rx, rx[0] == MF_UL_GET_VERSION_CMD ? 1 : 2);
+        break;
+    }
+    default:
+        // Second part of COMPATIBILITY_WRITE or garbage
+        replay_command_set(command, rx, 16);
+        break;
+    }
+
+    return true;
+}
+
+static void prepare_emulators(
+    MfUltralightEmulator* cached,
+    MfUltralightEmulator* reference,
+    MfUltralightData* data) {
+    memset(cached, 0, sizeof(MfUltralightEmulator));
+    memset(reference, 0, sizeof(MfUltralightEmulator));
+    mf_ul_prepare_emulation(cached, data);
+    mf_ul_prepare_emulation(reference, data);
+    reference->read_image_pages = 0;
+}
+
+static bool replay_compare(
+    MfUltralightEmulator* cached,
+    MfUltralightEmulator* reference,
+    const ReplayCommand* command) {
+    static uint8_t rx[32];
+    static uint8_t tx_cached[TX_BUFF_SIZE];
+    static uint8_t tx_reference[TX_BUFF_SIZE];
+    uint16_t tx_bits_cached = 0;
+    uint16_t tx_bits_reference = 0;
+    uint32_t flags_cached = 0;
+    uint32_t flags_reference = 0;
+
+    // Emulation may modify rx buffer in place
+    memcpy(rx, command->rx, sizeof(rx));
+    bool ret_cached = mf_ul_prepare_emulation_response(
+        rx, command->rx_bits, tx_cached, &tx_bits_cached, &flags_cached, cached);
+    memcpy(rx, command->rx, sizeof(rx));
+    bool ret_reference = mf_ul_prepare_emulation_response(
+        rx, command->rx_bits, tx_reference, &tx_bits_reference, &flags_reference, reference);
+
+    bool equal = ret_cached == ret_reference && tx_bits_cached == tx_bits_reference &&
+                 flags_cached == flags_reference;
+    if(equal && tx_bits_cached != UINT16_MAX) {
+        equal = memcmp(tx_cached, tx_reference, (tx_bits_cached + 7) / 8) == 0;
+    }
+    equal = equal && memcmp(&cached->data, &reference->data, sizeof(MfUltralightData)) == 0;
+    equal = equal && cached->auth_success == reference->auth_success &&
+            cached->data_changed == reference->data_changed;
+    if(!equal) {
+        printf("mismatch on command %02X %02X (%u bits)\n", rx[0], rx[1], command->rx_bits);
+    }
+
+    return equal;
+}
+
+static void check_mirror_render(void) {
+    // Host printf must render counter the same way as firmware does
+    MfUltralightData* data = malloc(sizeof(MfUltralightData));
+    MfUltralightEmulator* emulator = malloc(sizeof(MfUltralightEmulator));
+    random_dump(data, &tag_layouts[5]);
+    MfUltralightConfigPages* config = mf_ultralight_get_config_pages(data);
+    config->mirror.mirror_conf = MfUltralightMirrorCounter;
+    config->mirror.mirror_byte = 0;
+    config->mirror_page = 10;
+    config->auth0 = 0xFF;
+    config->access.value = 0;
+    config->access.nfc_cnt_en = true;
+    data->counter[2] = 0x2A;
+
+    memset(emulator, 0, sizeof(MfUltralightEmulator));
+    mf_ul_prepare_emulation(emulator, data);
+    uint8_t rx[2] = {MF_UL_READ_CMD, 10};
+    uint8_t tx[TX_BUFF_SIZE];
+    uint16_t tx_bits = 0;
+    uint32_t flags = 0;
+    mf_ul_prepare_emulation_response(rx, 16, tx, &tx_bits, &flags, emulator);
+    CHECK(tx_bits == 16 * 8);
+    // Counter is incremented by first READ before mirror is applied
+    CHECK(memcmp(tx, "00002B", 6) == 0);
+
+    free(emulator);
+    free(data);
+}
+
+static int run_check(unsigned sequences) {
+    MfUltralightData* data = malloc(sizeof(MfUltralightData));
+    MfUltralightEmulator* cached = malloc(sizeof(MfUltralightEmulator));
+    MfUltralightEmulator* reference = malloc(sizeof(MfUltralightEmulator));
+    unsigned commands_replayed = 0;
+
+    check_mirror_render();
+
+    for(size_t layout_index = 0; layout_index < TAG_LAYOUTS_COUNT; layout_index++) {
+        const TagLayout* layout = &tag_layouts[layout_index];
+        unsigned layout_failures = 0;
+        for(unsigned sequence = 0; sequence < sequences; sequence++) {
+            random_dump(data, layout);
+            prepare_emulators(cached, reference, data);
+            for(unsigned i = 0; i < REPLAY_COMMANDS; i++) {
+                if((random_byte() & 0x3F) == 0) {
+                    mf_ul_reset_emulation(cached, true);
+                    mf_ul_reset_emulation(reference, true);
+                    continue;
+                }
+                ReplayCommand command;
+                if(!random_command(&command, layout, reference)) continue;
+                commands_replayed++;
+                if(!replay_compare(cached, reference, &command)) {
+                    layout_failures++;
+                    break;
+                }
+            }
+        }
+        CHECK(layout_failures == 0);
+        printf("%-8s %u sequences, %u failed\n", layout->name, sequences, layout_failures);
+    }
+
+    free(reference);
+    free(cached);
+    free(data);
+
+    printf("%u commands replayed\n", commands_replayed);
+    printf(check_failures ? "FAILED: %u checks\n" : "OK\n", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+static double bench_command(
+    MfUltralightEmulator* emulator,
+    const uint8_t* command,
+    size_t command_len,
+    unsigned reads) {
+    static uint8_t rx[32];
+    static uint8_t tx[TX_BUFF_SIZE];
+    uint16_t tx_bits;
+    uint32_t flags;
+    volatile uint8_t sink = 0;
+
+    uint64_t start = bench_now_ns();
+    for(unsigned i = 0; i < reads; i++) {
+        memcpy(rx, command, command_len);
+        mf_ul_prepare_emulation_response(rx, command_len * 8, tx, &tx_bits, &flags, emulator);
+        sink ^= tx[0];
+    }
+    (void)sink;
+
+    return (double)(bench_now_ns() - start) / reads;
+}
+
+static int run_bench(unsigned reads) {
+    MfUltralightData* data = malloc(sizeof(MfUltralightData));
+    MfUltralightEmulator* cached = malloc(sizeof(MfUltralightEmulator));
+    MfUltralightEmulator* reference = malloc(sizeof(MfUltralightEmulator));
+
+    random_dump(data, &tag_layouts[5]);
+    MfUltralightConfigPages* config = mf_ultralight_get_config_pages(data);
+    config->mirror.mirror_conf = MfUltralightMirrorUidCounter;
+    config->mirror.mirror_byte = 1;
+    config->mirror_page = 8;
+    config->auth0 = 0xFF;
+    config->access.value = 0;
+    config->access.nfc_cnt_en = true;
+    prepare_emulators(cached, reference, data);
+
+    const uint8_t read_mirror[] = {MF_UL_READ_CMD, 8};
+    const uint8_t read_plain[] = {MF_UL_READ_CMD, 40};
+    const uint8_t fast_read_all[] = {MF_UL_FAST_READ_CMD, 0, 63};
+
+    printf("command             reference   read image\n");
+    printf(
+        "READ mirror pages   %8.1f ns %8.1f ns\n",
+        bench_command(reference, read_mirror, sizeof(read_mirror), reads),
+        bench_command(cached, read_mirror, sizeof(read_mirror), reads));
+    printf(
+        "READ plain pages    %8.1f ns %8.1f ns\n",
+        bench_command(reference, read_plain, sizeof(read_plain), reads),
+        bench_command(cached, read_plain, sizeof(read_plain), reads));
+    printf(
+        "FAST_READ 64 pages  %8.1f ns %8.1f ns\n",
+        bench_command(reference, fast_read_all, sizeof(fast_read_all), reads),
+        bench_command(cached, fast_read_all, sizeof(fast_read_all), reads));
+
+    free(reference);
+    free(cached);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        printf("usage: %s check [sequences] | bench [reads]\n", argv[0]);
+        return 2;
+    }
+
+    if(!strcmp(argv[1], "check")) {
+        return run_check(argc > 2 ? strtoul(argv[2], NULL, 10) : 200);
+    } else if(!strcmp(argv[1], "bench")) {
+        return run_bench(argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000);
+    }
+
+    printf("unknown mode %s\n", argv[1]);
+    return 2;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+/* Host shim: minimal subset of furi core used by NFC utilities */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define furi_check(x)                                                                 \
+    do {                                                                              \
+        if(!(x)) {                                                                    \
+            fprintf(stderr, "furi_check failed: %s:%d %s\n", __FILE__, __LINE__, #x); \
+            abort();                                                                  \
+        }                                                                             \
+    } while(0)
+
+#define furi_assert(x) furi_check(x)
@@ -0,0 +1,197 @@
+/**
+ * Host check and benchmark of table driven NFC CRC and parity
+ *
+ * check: CRC_A, CRC_B and iClass CRC against bitwise update previously used
+ * in nfca.c and rfal_picopass.c for random frames of every length up to 300
+ * bytes, incremental single byte update against full CRC, 32 bit even parity
+ * against __builtin_parity and packed odd parity against per byte parity.
+ *
+ * bench: nanoseconds per frame for bitwise and table CRC, single byte update
+ * against full CRC, and 32 bit parity.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o nfc_crc_bench -Iscripts/nfc_crc_bench/include -I. \
+ *      scripts/nfc_crc_bench/nfc_crc_bench.c lib/nfc/helpers/nfc_crc.c \
+ *      lib/nfc/protocols/nfc_util.c
+ *  ./nfc_crc_bench check
+ *  ./nfc_crc_bench bench [frames]
+ */
+
+#include <lib/nfc/helpers/nfc_crc.h>
+#include <lib/nfc/protocols/nfc_util.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_FRAME_LEN 300
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if(!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while(0)
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t random_u32(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state >> 16;
+}
+
+static void random_frame(uint8_t* data, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        data[i] = random_u32();
+    }
+}
+
+// Previous CRC update from nfca.c and rfal_picopass.c
+static uint16_t crc16_bitwise(uint16_t crc, const uint8_t* data, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i] ^ (uint8_t)(crc & 0xff);
+        byte ^= byte << 4;
+        crc = (crc >> 8) ^ (((uint16_t)byte) << 8) ^ (((uint16_t)byte) << 3) ^
+              (((uint16_t)byte) >> 4);
+    }
+    return crc;
+}
+
+static int run_check(void) {
+    uint8_t data[MAX_FRAME_LEN + 2];
+
+    // ISO/IEC 14443-3 examples
+    const uint8_t crc_a_zero[] = {0x00, 0x00};
+    const uint8_t crc_a_example[] = {0x12, 0x34};
+    const uint8_t crc_b_zero[] = {0x00, 0x00, 0x00};
+    const uint8_t crc_b_example[] = {0x0F, 0xAA, 0xFF};
+    CHECK(nfc_crc_a(crc_a_zero, sizeof(crc_a_zero)) == 0x1EA0);
+    CHECK(nfc_crc_a(crc_a_example, sizeof(crc_a_example)) == 0xCF26);
+    CHECK(nfc_crc_b(crc_b_zero, sizeof(crc_b_zero)) == 0xC6CC);
+    CHECK(nfc_crc_b(crc_b_example, sizeof(crc_b_example)) == 0xD1FC);
+
+    for(size_t len = 0; len <= MAX_FRAME_LEN; len++) {
+        for(unsigned round = 0; round < 16; round++) {
+            random_frame(data, len);
+            CHECK(nfc_crc_a(data, len) == crc16_bitwise(NFC_CRC_A_INIT, data, len));
+            uint16_t crc_b_bitwise = ~crc16_bitwise(NFC_CRC_B_INIT, data, len);
+            CHECK(nfc_crc_b(data, len) == crc_b_bitwise);
+            CHECK(nfc_crc_iclass(data, len) == crc16_bitwise(NFC_CRC_ICLASS_INIT, data, len));
+
+            // Frame with appended CRC_A has zero residue
+            nfc_crc_a_append(data, len);
+            CHECK(crc16_bitwise(NFC_CRC_A_INIT, data, len + 2) == 0);
+
+            if(len == 0) continue;
+            size_t pos = random_u32() % len;
+            uint8_t new_byte = random_u32();
+            size_t bytes_after = len - pos - 1;
+            uint16_t crc_a = nfc_crc_a(data, len);
+            uint16_t crc_b = nfc_crc_b(data, len);
+            crc_a = nfc_crc16_patch(crc_a, data[pos], new_byte, bytes_after);
+            crc_b = nfc_crc16_patch(crc_b, data[pos], new_byte, bytes_after);
+            data[pos] = new_byte;
+            CHECK(crc_a == nfc_crc_a(data, len));
+            CHECK(crc_b == nfc_crc_b(data, len));
+        }
+    }
+
+    for(unsigned round = 0; round < 100000; round++) {
+        uint32_t value = random_u32() ^ (random_u32() << 16);
+        CHECK(nfc_util_even_parity32(value) == __builtin_parity(value));
+    }
+
+    uint8_t parity[(MAX_FRAME_LEN + 7) / 8];
+    random_frame(data, MAX_FRAME_LEN);
+    nfc_util_odd_parity(data, parity, 255);
+    for(size_t i = 0; i < 255; i++) {
+        CHECK(((parity[i / 8] >> (7 - (i % 8))) & 1) == nfc_util_odd_parity8(data[i]));
+    }
+
+    printf(check_failures ? "FAILED: %u checks\n" : "OK\n", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+static int run_bench(unsigned frames) {
+    static const size_t lengths[] = {2, 18, 64, 256};
+    uint8_t data[MAX_FRAME_LEN];
+    volatile uint32_t sink = 0;
+    random_frame(data, sizeof(data));
+
+    printf("frame      bitwise      table    1 byte patch\n");
+    for(size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        size_t len = lengths[i];
+
+        uint64_t start = bench_now_ns();
+        for(unsigned j = 0; j < frames; j++) {
+            data[0] = j;
+            sink ^= crc16_bitwise(NFC_CRC_A_INIT, data, len);
+        }
+        double bitwise_ns = (double)(bench_now_ns() - start) / frames;
+
+        start = bench_now_ns();
+        for(unsigned j = 0; j < frames; j++) {
+            data[0] = j;
+            sink ^= nfc_crc_a(data, len);
+        }
+        double table_ns = (double)(bench_now_ns() - start) / frames;
+
+        // Last byte changes, as in counter or status byte at response end
+        uint16_t crc = nfc_crc_a(data, len);
+        start = bench_now_ns();
+        for(unsigned j = 0; j < frames; j++) {
+            uint8_t new_byte = j;
+            crc = nfc_crc16_patch(crc, data[len - 1], new_byte, 0);
+            data[len - 1] = new_byte;
+        }
+        double patch_ns = (double)(bench_now_ns() - start) / frames;
+        sink ^= crc;
+
+        printf("%3zu B  %8.1f ns %8.1f ns %8.1f ns\n", len, bitwise_ns, table_ns, patch_ns);
+    }
+
+    uint64_t start = bench_now_ns();
+    for(unsigned j = 0; j < frames; j++) {
+        sink ^= __builtin_parity(j * 0x9E3779B9U);
+    }
+    double builtin_ns = (double)(bench_now_ns() - start) / frames;
+    start = bench_now_ns();
+    for(unsigned j = 0; j < frames; j++) {
+        sink ^= nfc_util_even_parity32(j * 0x9E3779B9U);
+    }
+    double table_ns = (double)(bench_now_ns() - start) / frames;
+    printf("parity32 %8.2f ns builtin %8.2f ns table\n", builtin_ns, table_ns);
+
+    (void)sink;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        printf("usage: %s check | bench [frames]\n", argv[0]);
+        return 2;
+    }
+
+    if(!strcmp(argv[1], "check")) {
+        return run_check();
+    } else if(!strcmp(argv[1], "bench")) {
+        return run_bench(argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000);
+    }
+
+    printf("unknown mode %s\n", argv[1]);
+    return 2;
+}
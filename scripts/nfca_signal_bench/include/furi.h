@@ -0,0 +1,27 @@
+#pragma once
+
+/* Host shim: minimal subset of furi core used by NFC-A signal encoder */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef UNUSED
+#define UNUSED(X) (void)(X)
+#endif
+
+#ifndef COUNT_OF
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#endif
+
+#define furi_check(x)                                                                 \
+    do {                                                                              \
+        if(!(x)) {                                                                    \
+            fprintf(stderr, "furi_check failed: %s:%d %s\n", __FILE__, __LINE__, #x); \
+            abort();                                                                  \
+        }                                                                             \
+    } while(0)
+
+#define furi_assert(x) furi_check(x)
@@ -0,0 +1,9 @@
+#pragma once
+
+/* Host shim: GPIO pin type for digital signal header */
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t pin;
+} GpioPin;
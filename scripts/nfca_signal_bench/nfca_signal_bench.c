@@ -0,0 +1,340 @@
+/**
+ * Host check and benchmark of NFC-A transparent mode signal encoding
+ *
+ * check: nfca_signal_encode() against previous encoder, which appended one
+ * DigitalSignal per bit and computed timer reload values with division per
+ * edge in digital_signal_prepare_arr(). Edge timings and reload values must
+ * be equal for random frames of every length, cached frames too.
+ *
+ * bench: nanoseconds per frame for previous encoder with reload preparation,
+ * table driven encoder and cached frame copy.
+ *
+ * digital_signal.c needs STM32 LL headers, so its allocation and reload
+ * preparation are repeated below as they are in lib/digital_signal.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o nfca_signal_bench -Iscripts/nfca_signal_bench/include -I. \
+ *      scripts/nfca_signal_bench/nfca_signal_bench.c lib/nfc/protocols/nfca.c \
+ *      lib/nfc/helpers/nfc_crc.c
+ *  ./nfca_signal_bench check
+ *  ./nfca_signal_bench bench [frames]
+ */
+
+#include <lib/nfc/protocols/nfca.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define T_SIG_x8 58992
+#define T_SIG_x8_x8 471936
+#define T_SIG_x8_x9 530928
+
+#define MAX_EDGES 1350
+#define MAX_BYTES 18
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if(!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while(0)
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint8_t random_byte(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state >> 24;
+}
+
+/* lib/digital_signal/digital_signal.c */
+
+DigitalSignal* digital_signal_alloc(uint32_t max_edges_cnt) {
+    DigitalSignal* signal = malloc(sizeof(DigitalSignal));
+    signal->start_level = true;
+    signal->edges_max_cnt = max_edges_cnt;
+    signal->edge_timings = malloc(max_edges_cnt * sizeof(uint32_t));
+    signal->reload_reg_buff = malloc(max_edges_cnt * sizeof(uint32_t));
+    signal->edge_cnt = 0;
+
+    return signal;
+}
+
+void digital_signal_free(DigitalSignal* signal) {
+    free(signal->edge_timings);
+    free(signal->reload_reg_buff);
+    free(signal);
+}
+
+bool digital_signal_append(DigitalSignal* signal_a, DigitalSignal* signal_b) {
+    if(signal_a->edges_max_cnt < signal_a->edge_cnt + signal_b->edge_cnt) {
+        return false;
+    }
+
+    bool end_level = signal_a->start_level;
+    if(signal_a->edge_cnt) {
+        end_level = signal_a->start_level ^ !(signal_a->edge_cnt % 2);
+    }
+    uint8_t start_copy = 0;
+    if(end_level == signal_b->start_level) {
+        if(signal_a->edge_cnt) {
+            signal_a->edge_timings[signal_a->edge_cnt - 1] += signal_b->edge_timings[0];
+            start_copy += 1;
+        } else {
+            signal_a->edge_timings[signal_a->edge_cnt] += signal_b->edge_timings[0];
+        }
+    }
+
+    for(size_t i = 0; i < signal_b->edge_cnt - start_copy; i++) {
+        signal_a->edge_timings[signal_a->edge_cnt + i] = signal_b->edge_timings[start_copy + i];
+    }
+    signal_a->edge_cnt += signal_b->edge_cnt - start_copy;
+
+    return true;
+}
+
+void digital_signal_prepare_arr(DigitalSignal* signal) {
+    uint32_t t_signal_rest = signal->edge_timings[0];
+    uint32_t r_count_tick_arr = 0;
+    uint32_t r_rest_div = 0;
+
+    for(size_t i = 0; i < signal->edge_cnt - 1; i++) {
+        r_count_tick_arr = t_signal_rest / DIGITAL_SIGNAL_T_TIM;
+        r_rest_div = t_signal_rest % DIGITAL_SIGNAL_T_TIM;
+        t_signal_rest = signal->edge_timings[i + 1] + r_rest_div;
+
+        if(r_rest_div < DIGITAL_SIGNAL_T_TIM_DIV2) {
+            signal->reload_reg_buff[i] = r_count_tick_arr - 1;
+        } else {
+            signal->reload_reg_buff[i] = r_count_tick_arr;
+            t_signal_rest -= DIGITAL_SIGNAL_T_TIM;
+        }
+    }
+}
+
+/* Previous encoder from lib/nfc/protocols/nfca.c */
+
+typedef struct {
+    DigitalSignal* one;
+    DigitalSignal* zero;
+    DigitalSignal* tx_signal;
+} LegacySignal;
+
+static void legacy_add_bit(DigitalSignal* signal, bool bit) {
+    if(bit) {
+        signal->start_level = true;
+        for(size_t i = 0; i < 7; i++) {
+            signal->edge_timings[i] = T_SIG_x8;
+        }
+        signal->edge_timings[7] = T_SIG_x8_x9;
+        signal->edge_cnt = 8;
+    } else {
+        signal->start_level = false;
+        signal->edge_timings[0] = T_SIG_x8_x8;
+        for(size_t i = 1; i < 9; i++) {
+            signal->edge_timings[i] = T_SIG_x8;
+        }
+        signal->edge_cnt = 9;
+    }
+}
+
+static void legacy_add_byte(LegacySignal* legacy, uint8_t byte, bool parity) {
+    for(uint8_t i = 0; i < 8; i++) {
+        if(byte & (1 << i)) {
+            digital_signal_append(legacy->tx_signal, legacy->one);
+        } else {
+            digital_signal_append(legacy->tx_signal, legacy->zero);
+        }
+    }
+    if(parity) {
+        digital_signal_append(legacy->tx_signal, legacy->one);
+    } else {
+        digital_signal_append(legacy->tx_signal, legacy->zero);
+    }
+}
+
+static LegacySignal* legacy_alloc(void) {
+    LegacySignal* legacy = malloc(sizeof(LegacySignal));
+    legacy->one = digital_signal_alloc(10);
+    legacy->zero = digital_signal_alloc(10);
+    legacy_add_bit(legacy->one, true);
+    legacy_add_bit(legacy->zero, false);
+    legacy->tx_signal = digital_signal_alloc(MAX_EDGES);
+    return legacy;
+}
+
+static void legacy_free(LegacySignal* legacy) {
+    digital_signal_free(legacy->one);
+    digital_signal_free(legacy->zero);
+    digital_signal_free(legacy->tx_signal);
+    free(legacy);
+}
+
+static void legacy_encode(LegacySignal* legacy, uint8_t* data, uint16_t bits, uint8_t* parity) {
+    legacy->tx_signal->edge_cnt = 0;
+    legacy->tx_signal->start_level = true;
+    // Start of frame
+    digital_signal_append(legacy->tx_signal, legacy->one);
+
+    if(bits < 8) {
+        for(size_t i = 0; i < bits; i++) {
+            if(data[0] & (1 << i)) {
+                digital_signal_append(legacy->tx_signal, legacy->one);
+            } else {
+                digital_signal_append(legacy->tx_signal, legacy->zero);
+            }
+        }
+    } else {
+        for(size_t i = 0; i < bits / 8; i++) {
+            legacy_add_byte(legacy, data[i], parity[i / 8] & (1 << (7 - (i & 0x07))));
+        }
+    }
+    digital_signal_prepare_arr(legacy->tx_signal);
+}
+
+/* Modes */
+
+static bool signal_equal(DigitalSignal* ref, DigitalSignal* dut) {
+    if(ref->start_level != dut->start_level || ref->edge_cnt != dut->edge_cnt) return false;
+    if(memcmp(ref->edge_timings, dut->edge_timings, ref->edge_cnt * sizeof(uint32_t))) {
+        return false;
+    }
+    // Reload value of last edge is never sent
+    return memcmp(
+               ref->reload_reg_buff,
+               dut->reload_reg_buff,
+               (ref->edge_cnt - 1) * sizeof(uint32_t)) == 0;
+}
+
+static void random_frame(uint8_t* data, uint8_t* parity) {
+    for(size_t i = 0; i < MAX_BYTES; i++) data[i] = random_byte();
+    for(size_t i = 0; i < 3; i++) parity[i] = random_byte();
+}
+
+static int check_main(void) {
+    LegacySignal* legacy = legacy_alloc();
+    NfcaSignal* nfca_signal = nfca_signal_alloc();
+    uint8_t data[MAX_BYTES];
+    uint8_t parity[3];
+
+    for(unsigned round = 0; round < 200; round++) {
+        for(uint16_t bits = 0; bits < 8; bits++) {
+            random_frame(data, parity);
+            legacy_encode(legacy, data, bits, parity);
+            nfca_signal_encode(nfca_signal, data, bits, parity);
+            CHECK(signal_equal(legacy->tx_signal, nfca_signal->tx_signal));
+        }
+        for(uint16_t bytes = 1; bytes <= MAX_BYTES; bytes++) {
+            random_frame(data, parity);
+            legacy_encode(legacy, data, bytes * 8, parity);
+            nfca_signal_encode(nfca_signal, data, bytes * 8, parity);
+            CHECK(signal_equal(legacy->tx_signal, nfca_signal->tx_signal));
+        }
+    }
+
+    // Cached frames, including frame that differs only in parity
+    uint8_t nack = 0x04;
+    uint8_t atqa[2] = {0x44, 0x00};
+    uint8_t atqa_parity = 0x80;
+    uint8_t other_parity = 0x40;
+    CHECK(nfca_signal_cache_add(nfca_signal, &nack, 4, parity));
+    CHECK(nfca_signal_cache_add(nfca_signal, atqa, 16, &atqa_parity));
+
+    legacy_encode(legacy, &nack, 4, parity);
+    nfca_signal_encode(nfca_signal, &nack, 4, parity);
+    CHECK(signal_equal(legacy->tx_signal, nfca_signal->tx_signal));
+    legacy_encode(legacy, atqa, 16, &atqa_parity);
+    nfca_signal_encode(nfca_signal, atqa, 16, &atqa_parity);
+    CHECK(signal_equal(legacy->tx_signal, nfca_signal->tx_signal));
+    legacy_encode(legacy, atqa, 16, &other_parity);
+    nfca_signal_encode(nfca_signal, atqa, 16, &other_parity);
+    CHECK(signal_equal(legacy->tx_signal, nfca_signal->tx_signal));
+
+    // Frame longer than cache entry is refused
+    CHECK(!nfca_signal_cache_add(nfca_signal, data, MAX_BYTES * 8, parity));
+
+    nfca_signal_free(nfca_signal);
+    legacy_free(legacy);
+
+    printf("%s\n", check_failures ? "FAILED" : "OK");
+    return check_failures ? 1 : 0;
+}
+
+static void bench_frame(const char* name, uint16_t bits, size_t frames) {
+    LegacySignal* legacy = legacy_alloc();
+    NfcaSignal* nfca_signal = nfca_signal_alloc();
+    uint8_t data[MAX_BYTES];
+    uint8_t parity[3];
+    random_frame(data, parity);
+
+    uint64_t start = bench_now_ns();
+    for(size_t i = 0; i < frames; i++) {
+        data[0] = i;
+        legacy_encode(legacy, data, bits, parity);
+    }
+    double legacy_ns = (double)(bench_now_ns() - start) / frames;
+
+    start = bench_now_ns();
+    for(size_t i = 0; i < frames; i++) {
+        data[0] = i;
+        nfca_signal_encode(nfca_signal, data, bits, parity);
+    }
+    double table_ns = (double)(bench_now_ns() - start) / frames;
+
+    double cached_ns = 0;
+    if(nfca_signal_cache_add(nfca_signal, data, bits, parity)) {
+        start = bench_now_ns();
+        for(size_t i = 0; i < frames; i++) {
+            nfca_signal_encode(nfca_signal, data, bits, parity);
+        }
+        cached_ns = (double)(bench_now_ns() - start) / frames;
+    }
+
+    printf(
+        "%-10s %4u edges: legacy %7.0f ns, table %7.0f ns, cached ",
+        name,
+        (unsigned)nfca_signal->tx_signal->edge_cnt,
+        legacy_ns,
+        table_ns);
+    if(cached_ns) {
+        printf("%7.0f ns\n", cached_ns);
+    } else {
+        printf("      - \n");
+    }
+
+    nfca_signal_free(nfca_signal);
+    legacy_free(legacy);
+}
+
+static int bench_main(size_t frames) {
+    bench_frame("nack", 4, frames);
+    bench_frame("atqa", 2 * 8, frames);
+    bench_frame("uid+bcc", 5 * 8, frames);
+    bench_frame("block", MAX_BYTES * 8, frames);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "check") == 0) {
+        return check_main();
+    } else if(argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main(argc > 2 ? (size_t)atoi(argv[2]) : 100000);
+    }
+
+    printf("Usage: %s check | bench [frames]\n", argv[0]);
+    return 1;
+}
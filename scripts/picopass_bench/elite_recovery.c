@@ -0,0 +1,395 @@
+/**
+ * Host runner for iClass elite key recovery from captured reader MACs
+ *
+ * check: bitsliced reader MAC against loclass_opt_doReaderMAC for random keys
+ * and challenges, and recovery finding planted key in every batch position.
+ *
+ * bench: keys per second of recovery over random candidates:
+ *  - scalar     elite diversification and loclass_opt_doReaderMAC per key
+ *  - bitsliced  iclass_elite_recovery_check_keys with 1 to N threads
+ *
+ * recover: search dictionary for key matching captures. Captures are read
+ * either from log written by Picopass app (lines of "csn <hex> cc_nr <hex>
+ * mac <hex>") or from binary loclass dump of 24 byte records (CSN, CC_NR, MAC).
+ *
+ * Build and run from the repository root, add -DLOCLASS_BS_WORD=uint64_t for
+ * 64 lanes:
+ *
+ *  gcc -O2 -pthread -o elite_recovery -Iscripts/picopass_bench/include \
+ *      -Iapplications/plugins/picopass/lib/loclass scripts/picopass_bench/elite_recovery.c \
+ *      applications/plugins/picopass/helpers/iclass_elite_recovery.c \
+ *      applications/plugins/picopass/lib/loclass/optimized_*.c -lcrypto
+ *  ./elite_recovery check
+ *  ./elite_recovery bench [keys] [threads]
+ *  ./elite_recovery recover <captures> [dictionary]
+ */
+
+#include "../../applications/plugins/picopass/helpers/iclass_elite_recovery.h"
+
+#include <optimized_cipher.h>
+#include <optimized_cipher_bs.h>
+#include <optimized_elite.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define KEY_LEN 8
+#define CHUNK_KEYS 4096
+#define MAX_CAPTURES 64
+#define MAX_THREADS 64
+
+#define ASSET_PATH "assets/resources/picopass/assets/iclass_elite_dict.txt"
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if(!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while(0)
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static void random_bytes(uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        data[i] = rng_state >> 24;
+    }
+}
+
+static void capture_make(IclassEliteMac* capture, const uint8_t* key) {
+    uint8_t div_key[8];
+    uint8_t key_copy[KEY_LEN];
+
+    memcpy(key_copy, key, KEY_LEN);
+    random_bytes(capture->csn, sizeof(capture->csn));
+    random_bytes(capture->cc_nr, sizeof(capture->cc_nr));
+    loclass_iclass_calc_div_key(capture->csn, key_copy, div_key, true);
+    loclass_opt_doReaderMAC(capture->cc_nr, div_key, capture->mac);
+}
+
+/* Captures */
+
+static bool parse_hex(const char* hex, uint8_t* data, size_t size) {
+    if(strlen(hex) != size * 2) return false;
+    for(size_t i = 0; i < size; i++) {
+        unsigned byte;
+        if(sscanf(&hex[i * 2], "%2x", &byte) != 1) return false;
+        data[i] = byte;
+    }
+    return true;
+}
+
+static size_t captures_load(const char* path, IclassEliteMac* captures) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return 0;
+
+    size_t count = 0;
+    size_t path_len = strlen(path);
+    if(path_len > 4 && strcmp(&path[path_len - 4], ".bin") == 0) {
+        uint8_t record[24];
+        while(count < MAX_CAPTURES && fread(record, sizeof(record), 1, file) == 1) {
+            memcpy(captures[count].csn, &record[0], 8);
+            memcpy(captures[count].cc_nr, &record[8], 12);
+            memcpy(captures[count].mac, &record[20], 4);
+            count++;
+        }
+    } else {
+        char csn[32], cc_nr[32], mac[32];
+        char line[256];
+        while(count < MAX_CAPTURES && fgets(line, sizeof(line), file)) {
+            if(sscanf(line, "csn %31s cc_nr %31s mac %31s", csn, cc_nr, mac) != 3) continue;
+            IclassEliteMac* capture = &captures[count];
+            if(parse_hex(csn, capture->csn, sizeof(capture->csn)) &&
+               parse_hex(cc_nr, capture->cc_nr, sizeof(capture->cc_nr)) &&
+               parse_hex(mac, capture->mac, sizeof(capture->mac))) {
+                count++;
+            }
+        }
+    }
+
+    fclose(file);
+    return count;
+}
+
+static uint8_t* dict_load(const char* path, size_t* keys_count) {
+    FILE* file = fopen(path, "r");
+    if(!file) return NULL;
+
+    size_t capacity = 1024;
+    uint8_t* keys = malloc(capacity * KEY_LEN);
+    char line[64];
+    *keys_count = 0;
+    while(fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] == '#') continue;
+        if(*keys_count == capacity) {
+            capacity *= 2;
+            keys = realloc(keys, capacity * KEY_LEN);
+        }
+        if(parse_hex(line, &keys[*keys_count * KEY_LEN], KEY_LEN)) (*keys_count)++;
+    }
+
+    fclose(file);
+    return keys;
+}
+
+/* Search */
+
+typedef struct {
+    IclassEliteRecovery* recovery;
+    const uint8_t* keys;
+    size_t keys_count;
+    pthread_mutex_t mutex;
+    size_t next;
+    bool found;
+    size_t key_found;
+} Search;
+
+static void* search_worker(void* context) {
+    Search* search = context;
+
+    while(true) {
+        pthread_mutex_lock(&search->mutex);
+        size_t offset = search->next;
+        bool done = search->found || offset >= search->keys_count;
+        search->next += CHUNK_KEYS;
+        pthread_mutex_unlock(&search->mutex);
+        if(done) break;
+
+        size_t count = search->keys_count - offset;
+        if(count > CHUNK_KEYS) count = CHUNK_KEYS;
+        size_t key_found;
+        if(iclass_elite_recovery_check_keys(
+               search->recovery, &search->keys[offset * KEY_LEN], count, &key_found)) {
+            pthread_mutex_lock(&search->mutex);
+            search->found = true;
+            search->key_found = offset + key_found;
+            pthread_mutex_unlock(&search->mutex);
+        }
+    }
+
+    return NULL;
+}
+
+static bool search_run(
+    IclassEliteRecovery* recovery,
+    const uint8_t* keys,
+    size_t keys_count,
+    unsigned threads,
+    size_t* key_found) {
+    Search search = {
+        .recovery = recovery,
+        .keys = keys,
+        .keys_count = keys_count,
+    };
+    pthread_t thread[MAX_THREADS];
+
+    pthread_mutex_init(&search.mutex, NULL);
+    for(unsigned i = 0; i < threads; i++) {
+        pthread_create(&thread[i], NULL, search_worker, &search);
+    }
+    for(unsigned i = 0; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    pthread_mutex_destroy(&search.mutex);
+
+    *key_found = search.key_found;
+    return search.found;
+}
+
+static bool search_scalar(
+    const IclassEliteMac* captures,
+    const uint8_t* keys,
+    size_t keys_count,
+    size_t* key_found) {
+    uint8_t key_index[8];
+    uint8_t key[KEY_LEN];
+    uint8_t div_key[8];
+    uint8_t mac[4];
+
+    loclass_hash1((uint8_t*)captures[0].csn, key_index);
+    for(size_t i = 0; i < keys_count; i++) {
+        memcpy(key, &keys[i * KEY_LEN], KEY_LEN);
+        loclass_iclass_calc_elite_div_key(
+            (uint8_t*)captures[0].csn, key_index, key, div_key);
+        loclass_opt_doReaderMAC((uint8_t*)captures[0].cc_nr, div_key, mac);
+        if(memcmp(mac, captures[0].mac, sizeof(mac)) == 0) {
+            *key_found = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Modes */
+
+static int check_main(void) {
+    uint8_t div_keys[LOCLASS_BS_LANES][8];
+    uint8_t cc_nr[12];
+    uint8_t mac[4];
+
+    for(unsigned round = 0; round < 200; round++) {
+        size_t count = 1 + round % LOCLASS_BS_LANES;
+        random_bytes(&div_keys[0][0], sizeof(div_keys));
+        random_bytes(cc_nr, sizeof(cc_nr));
+        // Duplicate key checks that every equal lane is reported
+        if(count > 2) memcpy(div_keys[count - 1], div_keys[0], 8);
+
+        for(size_t target = 0; target < count; target++) {
+            loclass_opt_doReaderMAC(cc_nr, div_keys[target], mac);
+            LoclassBsWord expected = 0;
+            for(size_t i = 0; i < count; i++) {
+                uint8_t lane_mac[4];
+                loclass_opt_doReaderMAC(cc_nr, div_keys[i], lane_mac);
+                if(memcmp(lane_mac, mac, sizeof(mac)) == 0) {
+                    expected |= (LoclassBsWord)1 << i;
+                }
+            }
+            LoclassBsWord match =
+                loclass_opt_doReaderMAC_bs(cc_nr, (const uint8_t(*)[8])div_keys, count, mac);
+            CHECK(match == expected);
+        }
+    }
+
+    // Planted key found at every position in and across bitsliced batches
+    size_t keys_count = LOCLASS_BS_LANES * 3 + 5;
+    uint8_t* keys = malloc(keys_count * KEY_LEN);
+    uint8_t key[KEY_LEN];
+    IclassEliteMac captures[2];
+    random_bytes(keys, keys_count * KEY_LEN);
+    for(size_t position = 0; position < keys_count; position += 7) {
+        memcpy(key, &keys[position * KEY_LEN], KEY_LEN);
+        capture_make(&captures[0], key);
+        capture_make(&captures[1], key);
+        IclassEliteRecovery* recovery = iclass_elite_recovery_alloc(captures, 2);
+        size_t key_found = SIZE_MAX;
+        CHECK(iclass_elite_recovery_check_keys(recovery, keys, keys_count, &key_found));
+        CHECK(key_found == position);
+        iclass_elite_recovery_free(recovery);
+    }
+
+    // Second capture rejects key matching only first one
+    random_bytes(key, KEY_LEN);
+    capture_make(&captures[0], &keys[0]);
+    capture_make(&captures[1], key);
+    IclassEliteRecovery* recovery = iclass_elite_recovery_alloc(captures, 2);
+    size_t key_found;
+    CHECK(!iclass_elite_recovery_check_keys(recovery, keys, keys_count, &key_found));
+    iclass_elite_recovery_free(recovery);
+    free(keys);
+
+    printf("%u lanes, %s\n", (unsigned)LOCLASS_BS_LANES, check_failures ? "FAILED" : "OK");
+    return check_failures ? 1 : 0;
+}
+
+static int bench_main(size_t keys_count, unsigned max_threads) {
+    uint8_t* keys = malloc(keys_count * KEY_LEN);
+    uint8_t key[KEY_LEN];
+    IclassEliteMac captures[2];
+    size_t key_found;
+
+    random_bytes(keys, keys_count * KEY_LEN);
+    random_bytes(key, KEY_LEN);
+    capture_make(&captures[0], key);
+    capture_make(&captures[1], key);
+
+    uint64_t start = bench_now_ns();
+    search_scalar(captures, keys, keys_count, &key_found);
+    double seconds = (bench_now_ns() - start) / 1e9;
+    printf("%-12s %9.0f keys/s\n", "scalar", keys_count / seconds);
+
+    IclassEliteRecovery* recovery = iclass_elite_recovery_alloc(captures, 2);
+    for(unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        start = bench_now_ns();
+        search_run(recovery, keys, keys_count, threads, &key_found);
+        seconds = (bench_now_ns() - start) / 1e9;
+        printf(
+            "bitsliced/%-2u %9.0f keys/s (%u lanes)\n",
+            threads,
+            keys_count / seconds,
+            (unsigned)LOCLASS_BS_LANES);
+    }
+    iclass_elite_recovery_free(recovery);
+
+    free(keys);
+    return 0;
+}
+
+static int recover_main(const char* captures_path, const char* dict_path) {
+    IclassEliteMac captures[MAX_CAPTURES];
+    size_t captures_count = captures_load(captures_path, captures);
+    if(!captures_count) {
+        printf("No captures in %s\n", captures_path);
+        return 1;
+    }
+
+    size_t keys_count;
+    uint8_t* keys = dict_load(dict_path, &keys_count);
+    if(!keys) {
+        printf("Failed to read %s\n", dict_path);
+        return 1;
+    }
+
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if(threads < 1) threads = 1;
+    if(threads > MAX_THREADS) threads = MAX_THREADS;
+
+    IclassEliteRecovery* recovery = iclass_elite_recovery_alloc(captures, captures_count);
+    size_t key_found;
+    uint64_t start = bench_now_ns();
+    bool found = search_run(recovery, keys, keys_count, threads, &key_found);
+    double seconds = (bench_now_ns() - start) / 1e9;
+    iclass_elite_recovery_free(recovery);
+
+    printf(
+        "%zu captures, %zu keys, %ld threads, %.3f s\n",
+        captures_count,
+        keys_count,
+        threads,
+        seconds);
+    if(found) {
+        printf("Key: ");
+        for(size_t i = 0; i < KEY_LEN; i++) printf("%02X", keys[key_found * KEY_LEN + i]);
+        printf("\n");
+    } else {
+        printf("Key not found\n");
+    }
+
+    free(keys);
+    return found ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "check") == 0) {
+        return check_main();
+    } else if(argc > 1 && strcmp(argv[1], "bench") == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        unsigned threads = argc > 3 ? (unsigned)atoi(argv[3]) : (cpus > 0 ? cpus : 1);
+        if(threads > MAX_THREADS) threads = MAX_THREADS;
+        return bench_main(argc > 2 ? (size_t)atoi(argv[2]) : 100000, threads ? threads : 1);
+    } else if(argc > 2 && strcmp(argv[1], "recover") == 0) {
+        return recover_main(argv[2], argc > 3 ? argv[3] : ASSET_PATH);
+    }
+
+    printf(
+        "Usage: %s check | bench [keys] [threads] | recover <captures> [dictionary]\n",
+        argv[0]);
+    return 1;
+}
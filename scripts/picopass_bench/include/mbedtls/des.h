@@ -0,0 +1,32 @@
+/**
+ * Host stand-in for mbedtls/des.h used by loclass, backed by OpenSSL DES.
+ */
+#pragma once
+
+#define OPENSSL_SUPPRESS_DEPRECATED
+#include <openssl/des.h>
+
+typedef struct {
+    DES_key_schedule schedule;
+    int mode;
+} mbedtls_des_context;
+
+static inline int mbedtls_des_setkey_enc(mbedtls_des_context* ctx, const unsigned char key[8]) {
+    DES_set_key_unchecked((const_DES_cblock*)key, &ctx->schedule);
+    ctx->mode = DES_ENCRYPT;
+    return 0;
+}
+
+static inline int mbedtls_des_setkey_dec(mbedtls_des_context* ctx, const unsigned char key[8]) {
+    DES_set_key_unchecked((const_DES_cblock*)key, &ctx->schedule);
+    ctx->mode = DES_DECRYPT;
+    return 0;
+}
+
+static inline int mbedtls_des_crypt_ecb(
+    mbedtls_des_context* ctx,
+    const unsigned char input[8],
+    unsigned char output[8]) {
+    DES_ecb_encrypt((const_DES_cblock*)input, (DES_cblock*)output, &ctx->schedule, ctx->mode);
+    return 0;
+}
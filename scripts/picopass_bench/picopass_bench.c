@@ -0,0 +1,476 @@
+/**
+ * Host simulation of iClass elite dictionary attack done by picopass_auth()
+ *
+ * check: loclass hash2 against key table from optimized_elite.c, batched
+ * elite diversification against loclass_iclass_calc_div_key, binary index
+ * against text dictionary, and every mode below finding key on simulated card.
+ *
+ * bench: keys per second over dictionary that does not contain card key:
+ *  - text      dictionary parsed line by line, every key fully diversified
+ *  - index     keys read in batches from binary index, CSN hash1 done once
+ *  - pipeline  as index, next batch diversified on second thread while card
+ *              exchanges for current batch are in flight
+ *
+ * Card exchange (READCHECK and CHECK, about 8 ms at 26.48 kbit/s) is
+ * simulated with fixed latency, both as sleep and as busy wait like RFAL
+ * blocking transceive does. Process is pinned to one CPU as on device.
+ * Diversification can be repeated to approximate slower device CPU.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -pthread -o picopass_bench -Iscripts/picopass_bench/include \
+ *      -Iapplications/plugins/picopass/lib/loclass scripts/picopass_bench/picopass_bench.c \
+ *      applications/plugins/picopass/lib/loclass/optimized_*.c -lcrypto
+ *  ./picopass_bench check
+ *  ./picopass_bench bench [keys] [exchange_us] [cpu_repeat]
+ */
+
+#define _GNU_SOURCE
+#include <optimized_cipher.h>
+#include <optimized_elite.h>
+#include <optimized_ikeys.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define KEY_LEN 8
+#define KEY_LINE_LEN 17
+#define BATCH_SIZE 16
+
+#define INDEX_MAGIC 0x44454349
+#define INDEX_VERSION 1
+
+#define TEXT_PATH "/tmp/picopass_bench_dict.txt"
+#define INDEX_PATH "/tmp/picopass_bench_dict.bin"
+#define ASSET_PATH "assets/resources/picopass/assets/iclass_elite_dict.txt"
+
+/* Same layout as IclassEliteDictHeader */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t key_len;
+    uint32_t total_keys;
+    uint32_t source_size;
+    uint32_t source_timestamp;
+} IndexHeader;
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if(!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while(0)
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Simulated card */
+
+typedef struct {
+    uint8_t csn[8];
+    uint8_t ccnr[12];
+    uint8_t mac[4];
+    unsigned exchange_us;
+    bool busy_wait;
+    unsigned cpu_repeat;
+} Card;
+
+static void card_init(Card* card, const uint8_t* key) {
+    static const uint8_t csn[8] = {0x8E, 0x4A, 0x2F, 0x00, 0xF7, 0xFF, 0x12, 0xE0};
+    static const uint8_t cc[8] = {0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t div_key[8];
+
+    memcpy(card->csn, csn, sizeof(csn));
+    memset(card->ccnr, 0, sizeof(card->ccnr));
+    memcpy(card->ccnr, cc, sizeof(cc));
+    loclass_iclass_calc_div_key(card->csn, (uint8_t*)key, div_key, true);
+    loclass_opt_doReaderMAC(card->ccnr, div_key, card->mac);
+}
+
+static bool card_check(Card* card, const uint8_t* div_key) {
+    uint8_t mac[4];
+    loclass_opt_doReaderMAC(card->ccnr, (uint8_t*)div_key, mac);
+
+    if(card->busy_wait) {
+        uint64_t until = bench_now_ns() + card->exchange_us * 1000ULL;
+        while(bench_now_ns() < until) {
+        }
+    } else if(card->exchange_us) {
+        struct timespec ts = {0, card->exchange_us * 1000L};
+        nanosleep(&ts, NULL);
+    }
+
+    return memcmp(mac, card->mac, sizeof(mac)) == 0;
+}
+
+static void card_div_key(Card* card, const uint8_t* key_index, uint8_t* key, uint8_t* div_key) {
+    for(unsigned i = 0; i < card->cpu_repeat; i++) {
+        if(key_index) {
+            loclass_iclass_calc_elite_div_key(card->csn, key_index, key, div_key);
+        } else {
+            loclass_iclass_calc_div_key(card->csn, key, div_key, true);
+        }
+    }
+}
+
+/* Dictionaries */
+
+static bool parse_line(const char* line, uint8_t* key) {
+    if(line[0] == '#' || strlen(line) != KEY_LINE_LEN) return false;
+    for(size_t i = 0; i < KEY_LEN; i++) {
+        unsigned byte;
+        if(sscanf(&line[i * 2], "%2x", &byte) != 1) return false;
+        key[i] = byte;
+    }
+    return true;
+}
+
+static int key_cmp(const void* a, const void* b) {
+    return memcmp(a, b, KEY_LEN);
+}
+
+static void dict_write_text(size_t random_keys, const uint8_t* extra_key) {
+    FILE* out = fopen(TEXT_PATH, "w");
+    FILE* in = fopen(ASSET_PATH, "r");
+    char line[128];
+    if(in) {
+        while(fgets(line, sizeof(line), in)) fputs(line, out);
+        fclose(in);
+    }
+
+    srand(1);
+    fprintf(out, "# random\n");
+    for(size_t i = 0; i < random_keys; i++) {
+        for(size_t j = 0; j < KEY_LEN; j++) fprintf(out, "%02X", rand() & 0xFF);
+        fprintf(out, "\n");
+    }
+    if(extra_key) {
+        for(size_t j = 0; j < KEY_LEN; j++) fprintf(out, "%02X", extra_key[j]);
+        fprintf(out, "\n");
+    }
+    fclose(out);
+}
+
+/* Host version of iclass_elite_dict_build_index() */
+static size_t dict_build_index(void) {
+    FILE* in = fopen(TEXT_PATH, "r");
+    char line[128];
+    uint8_t key[KEY_LEN];
+
+    size_t keys_count = 0;
+    while(fgets(line, sizeof(line), in)) {
+        if(parse_line(line, key)) keys_count++;
+    }
+    rewind(in);
+
+    uint8_t* keys = malloc(keys_count * KEY_LEN + 1);
+    size_t keys_read = 0;
+    while(keys_read < keys_count && fgets(line, sizeof(line), in)) {
+        if(parse_line(line, &keys[keys_read * KEY_LEN])) keys_read++;
+    }
+    fclose(in);
+
+    qsort(keys, keys_count, KEY_LEN, key_cmp);
+    size_t unique_count = keys_count ? 1 : 0;
+    for(size_t i = 1; i < keys_count; i++) {
+        uint8_t* last_key = &keys[(unique_count - 1) * KEY_LEN];
+        if(!memcmp(&keys[i * KEY_LEN], last_key, KEY_LEN)) continue;
+        memmove(last_key + KEY_LEN, &keys[i * KEY_LEN], KEY_LEN);
+        unique_count++;
+    }
+
+    struct stat st;
+    stat(TEXT_PATH, &st);
+    IndexHeader header = {
+        .magic = INDEX_MAGIC,
+        .version = INDEX_VERSION,
+        .key_len = KEY_LEN,
+        .total_keys = unique_count,
+        .source_size = st.st_size,
+        .source_timestamp = st.st_mtime,
+    };
+    FILE* out = fopen(INDEX_PATH, "wb");
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(keys, KEY_LEN, unique_count, out);
+    fclose(out);
+    free(keys);
+
+    return unique_count;
+}
+
+static FILE* dict_open_index(uint32_t* total_keys) {
+    FILE* in = fopen(INDEX_PATH, "rb");
+    IndexHeader header;
+    if(fread(&header, sizeof(header), 1, in) != 1 || header.magic != INDEX_MAGIC) {
+        fclose(in);
+        return NULL;
+    }
+    *total_keys = header.total_keys;
+    return in;
+}
+
+/* Attack modes, return keys tried and found key */
+
+static size_t attack_text(Card* card, uint8_t* found) {
+    FILE* in = fopen(TEXT_PATH, "r");
+    char line[128];
+    uint8_t key[KEY_LEN];
+    uint8_t div_key[KEY_LEN];
+    size_t tried = 0;
+
+    while(fgets(line, sizeof(line), in)) {
+        if(!parse_line(line, key)) continue;
+        tried++;
+        card_div_key(card, NULL, key, div_key);
+        if(card_check(card, div_key)) {
+            memcpy(found, key, KEY_LEN);
+            break;
+        }
+    }
+
+    fclose(in);
+    return tried;
+}
+
+typedef struct {
+    uint8_t keys[BATCH_SIZE][KEY_LEN];
+    uint8_t div_keys[BATCH_SIZE][KEY_LEN];
+    size_t count;
+} Batch;
+
+typedef struct {
+    Card* card;
+    FILE* dict;
+    uint8_t key_index[8];
+    Batch batch[2];
+    Batch* next;
+    sem_t request;
+    sem_t ready;
+    bool stop;
+} Batches;
+
+static void batch_fill(Batches* batches) {
+    Batch* batch = batches->next;
+    batch->count = fread(batch->keys, KEY_LEN, BATCH_SIZE, batches->dict);
+    for(size_t i = 0; i < batch->count; i++) {
+        card_div_key(batches->card, batches->key_index, batch->keys[i], batch->div_keys[i]);
+    }
+}
+
+static size_t attack_batches(Batches* batches, bool pipeline, uint8_t* found) {
+    size_t tried = 0;
+    bool fill_pending = false;
+
+    if(pipeline) {
+        sem_post(&batches->request);
+        sem_wait(&batches->ready);
+    } else {
+        batch_fill(batches);
+    }
+
+    while(batches->next->count) {
+        Batch* batch = batches->next;
+        if(pipeline && batch->count == BATCH_SIZE) {
+            batches->next = (batch == &batches->batch[0]) ? &batches->batch[1] : &batches->batch[0];
+            sem_post(&batches->request);
+            fill_pending = true;
+        }
+
+        size_t i;
+        for(i = 0; i < batch->count; i++) {
+            tried++;
+            if(card_check(batches->card, batch->div_keys[i])) {
+                memcpy(found, batch->keys[i], KEY_LEN);
+                break;
+            }
+        }
+        if(i < batch->count || batch->count < BATCH_SIZE) break;
+
+        if(pipeline) {
+            sem_wait(&batches->ready);
+            fill_pending = false;
+        } else {
+            batch_fill(batches);
+        }
+    }
+
+    if(fill_pending) sem_wait(&batches->ready);
+    return tried;
+}
+
+static void* batch_filler(void* context) {
+    Batches* batches = context;
+    while(true) {
+        sem_wait(&batches->request);
+        if(batches->stop) break;
+        batch_fill(batches);
+        sem_post(&batches->ready);
+    }
+    return NULL;
+}
+
+static size_t attack_index(Card* card, bool pipeline, uint8_t* found) {
+    Batches batches = {.card = card};
+    uint32_t total_keys;
+    batches.dict = dict_open_index(&total_keys);
+    loclass_hash1(card->csn, batches.key_index);
+    batches.next = &batches.batch[0];
+
+    pthread_t filler;
+    if(pipeline) {
+        sem_init(&batches.request, 0, 0);
+        sem_init(&batches.ready, 0, 0);
+        pthread_create(&filler, NULL, batch_filler, &batches);
+    }
+
+    size_t tried = attack_batches(&batches, pipeline, found);
+
+    if(pipeline) {
+        batches.stop = true;
+        sem_post(&batches.request);
+        pthread_join(filler, NULL);
+        sem_destroy(&batches.request);
+        sem_destroy(&batches.ready);
+    }
+    fclose(batches.dict);
+    return tried;
+}
+
+/* Check */
+
+static int check_main(void) {
+    // High security key table from optimized_elite.c
+    static const uint8_t hs_key[8] = {0x5B, 0x7C, 0x62, 0xC4, 0x91, 0xC1, 0x1B, 0x39};
+    static const uint8_t hs_table_row0[16] = {
+        0xF1, 0x35, 0x59, 0xA1, 0x0D, 0x5A, 0x26, 0x7F,
+        0x18, 0x60, 0x0B, 0x96, 0x8A, 0xC0, 0x25, 0xC1,
+    };
+    static const uint8_t hs_table_row7[16] = {
+        0x43, 0x08, 0xA0, 0x2F, 0xFE, 0xB3, 0x26, 0xD7,
+        0x98, 0x0B, 0x34, 0x7B, 0x47, 0x70, 0xA0, 0xAB,
+    };
+    uint8_t keytable[128];
+    loclass_hash2((uint8_t*)hs_key, keytable);
+    CHECK(!memcmp(keytable, hs_table_row0, 16));
+    CHECK(!memcmp(&keytable[112], hs_table_row7, 16));
+
+    // Batched diversification matches full one
+    srand(2);
+    for(size_t i = 0; i < 1000; i++) {
+        uint8_t csn[8], key[8], key_index[8], div_key[8], div_key_batched[8];
+        for(size_t j = 0; j < 8; j++) {
+            csn[j] = rand();
+            key[j] = rand();
+        }
+        loclass_iclass_calc_div_key(csn, key, div_key, true);
+        loclass_hash1(csn, key_index);
+        loclass_iclass_calc_elite_div_key(csn, key_index, key, div_key_batched);
+        CHECK(!memcmp(div_key, div_key_batched, 8));
+    }
+
+    // Index holds sorted unique keys of text dictionary
+    static const uint8_t card_key[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    dict_write_text(500, card_key);
+    size_t index_keys = dict_build_index();
+    uint32_t total_keys = 0;
+    FILE* index = dict_open_index(&total_keys);
+    CHECK(index && total_keys == index_keys);
+    uint8_t prev[KEY_LEN] = {0}, key[KEY_LEN];
+    size_t keys_read = 0;
+    while(index && fread(key, KEY_LEN, 1, index) == 1) {
+        CHECK(!keys_read || memcmp(prev, key, KEY_LEN) < 0);
+        memcpy(prev, key, KEY_LEN);
+        keys_read++;
+    }
+    if(index) fclose(index);
+    CHECK(keys_read == total_keys);
+    // Card key is also in sample dictionary, index keeps one of them
+    printf("index: %zu unique keys\n", keys_read);
+
+    // Every mode finds key on card
+    Card card = {.cpu_repeat = 1};
+    card_init(&card, card_key);
+    uint8_t found[KEY_LEN];
+    memset(found, 0, sizeof(found));
+    attack_text(&card, found);
+    CHECK(!memcmp(found, card_key, KEY_LEN));
+    for(int pipeline = 0; pipeline < 2; pipeline++) {
+        memset(found, 0, sizeof(found));
+        attack_index(&card, pipeline, found);
+        CHECK(!memcmp(found, card_key, KEY_LEN));
+    }
+
+    printf("%s\n", check_failures ? "FAILED" : "OK");
+    return check_failures ? 1 : 0;
+}
+
+/* Bench */
+
+static void bench_run(const char* name, Card* card, int mode) {
+    uint8_t found[KEY_LEN];
+    uint64_t start = bench_now_ns();
+    size_t tried = mode < 0 ? attack_text(card, found) : attack_index(card, mode, found);
+    double seconds = (bench_now_ns() - start) / 1e9;
+    printf("%-10s %8zu keys %10.1f keys/s\n", name, tried, tried / seconds);
+}
+
+static int bench_main(size_t keys, unsigned exchange_us, unsigned cpu_repeat) {
+    // Single CPU as on device
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(0, &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+
+    static const uint8_t card_key[8] = {0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+    Card card = {.cpu_repeat = cpu_repeat};
+    card_init(&card, card_key);
+    dict_write_text(keys, NULL);
+    dict_build_index();
+
+    printf("Diversification only, repeated %u times per key\n", cpu_repeat);
+    bench_run("text", &card, -1);
+    bench_run("index", &card, 0);
+
+    for(int busy = 0; busy < 2; busy++) {
+        card.exchange_us = exchange_us;
+        card.busy_wait = busy;
+        printf(
+            "\nCard exchange %u us, %s\n",
+            exchange_us,
+            busy ? "busy wait" : "sleep while waiting");
+        bench_run("text", &card, -1);
+        bench_run("index", &card, 0);
+        bench_run("pipeline", &card, 1);
+    }
+
+    unlink(TEXT_PATH);
+    unlink(INDEX_PATH);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "check") == 0) {
+        return check_main();
+    } else if(argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main(
+            argc > 2 ? (size_t)atoi(argv[2]) : 1000,
+            argc > 3 ? (unsigned)atoi(argv[3]) : 8000,
+            argc > 4 ? (unsigned)atoi(argv[4]) : 1);
+    }
+
+    printf("Usage: %s check | bench [keys] [exchange_us] [cpu_repeat]\n", argv[0]);
+    return 1;
+}
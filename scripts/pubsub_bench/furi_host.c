@@ -0,0 +1,49 @@
+/* Host implementation of furi core primitives used by furi/core/pubsub.c */
+
+#include <stddef.h>
+#include <core/check.h>
+#include <core/kernel.h>
+#include <core/mutex.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+void __furi_crash() {
+    fprintf(stderr, "furi_crash\n");
+    abort();
+}
+
+void __furi_halt() {
+    fprintf(stderr, "furi_halt\n");
+    abort();
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    (void)type;
+    pthread_mutex_t* mutex = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(mutex, NULL);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    pthread_mutex_destroy(instance);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    (void)timeout;
+    return pthread_mutex_lock(instance) ? FuriStatusError : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    return pthread_mutex_unlock(instance) ? FuriStatusError : FuriStatusOk;
+}
+
+/* 1 kHz tick, same as firmware */
+void furi_delay_tick(uint32_t ticks) {
+    struct timespec ts = {.tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+/* Host shim: never in interrupt, interrupts never masked */
+
+#include <stdint.h>
+
+static inline uint32_t __get_PRIMASK(void) {
+    return 0;
+}
+
+static inline uint32_t __get_IPSR(void) {
+    return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+/* Host shim: scheduler is always running, threads are pthreads */
+
+#include "FreeRTOS.h"
+
+#define taskSCHEDULER_SUSPENDED ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING ((BaseType_t)2)
+
+static inline BaseType_t xTaskGetSchedulerState(void) {
+    return taskSCHEDULER_RUNNING;
+}
@@ -0,0 +1,424 @@
+/**
+ * FuriPubSub stress test and publish latency benchmark on host threads.
+ *
+ * stress: publishers run flat out while other threads subscribe and
+ * unsubscribe in a loop. Checks that permanent subscriber gets every message
+ * and that no callback runs after its unsubscribe has returned (contexts are
+ * poisoned right after unsubscribe and kept in quarantine before free).
+ *
+ * bench: publish latency percentiles for N subscribers and P publishers with
+ * subscription churn in background, for furi_pubsub and for a mutex guarded
+ * list like the one it replaced. "slow" runs have one subscriber spinning
+ * for 20 us per message.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -pthread -o pubsub_bench -Iscripts/pubsub_bench/include -Ifuri \
+ *      scripts/pubsub_bench/pubsub_bench.c scripts/pubsub_bench/furi_host.c \
+ *      furi/core/pubsub.c
+ *  ./pubsub_bench stress 10
+ *  ./pubsub_bench bench
+ *
+ * Add -fsanitize=thread or -fsanitize=address to check for races and use
+ * after free during stress run.
+ */
+
+#include <core/pubsub.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STRESS_PUBLISHERS 4
+#define STRESS_CHURNERS 3
+#define STRESS_QUARANTINE 64
+#define STRESS_ALIVE 0xA11FE
+#define STRESS_DEAD 0xDEAD
+
+#define BENCH_SAMPLES 20000
+#define BENCH_SLOW_NS 20000
+#define BENCH_CHURN_NS 100000
+#define BENCH_MAX_SUBSCRIBERS 16
+#define BENCH_MAX_PUBLISHERS 4
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_sleep_ns(uint64_t ns) {
+    struct timespec ts = {.tv_sec = ns / 1000000000ULL, .tv_nsec = ns % 1000000000ULL};
+    nanosleep(&ts, NULL);
+}
+
+static void bench_spin_ns(uint64_t ns) {
+    uint64_t end = bench_now_ns() + ns;
+    while(bench_now_ns() < end) {
+    }
+}
+
+/* Stress */
+
+typedef struct {
+    atomic_uint magic;
+    atomic_uint hits;
+} StressContext;
+
+static FuriPubSub* stress_pubsub;
+static atomic_bool stress_stop;
+static atomic_ulong stress_published;
+static atomic_ulong stress_delivered;
+static atomic_ulong stress_errors;
+static atomic_ulong stress_churns;
+
+static void stress_anchor_cb(const void* message, void* context) {
+    (void)message;
+    (void)context;
+    atomic_fetch_add(&stress_delivered, 1);
+}
+
+static void stress_churn_cb(const void* message, void* context) {
+    (void)message;
+    StressContext* stress_context = context;
+    if(atomic_load(&stress_context->magic) != STRESS_ALIVE) {
+        atomic_fetch_add(&stress_errors, 1);
+    }
+    atomic_fetch_add(&stress_context->hits, 1);
+}
+
+static void* stress_publisher(void* arg) {
+    (void)arg;
+    uint32_t message = 0;
+    while(!atomic_load(&stress_stop)) {
+        furi_pubsub_publish(stress_pubsub, &message);
+        atomic_fetch_add(&stress_published, 1);
+        message++;
+    }
+    return NULL;
+}
+
+static void* stress_churner(void* arg) {
+    unsigned seed = (unsigned)(uintptr_t)arg;
+    StressContext* quarantine[STRESS_QUARANTINE] = {0};
+    size_t quarantine_pos = 0;
+
+    while(!atomic_load(&stress_stop)) {
+        StressContext* context = malloc(sizeof(StressContext));
+        atomic_init(&context->magic, STRESS_ALIVE);
+        atomic_init(&context->hits, 0);
+
+        FuriPubSubSubscription* subscription =
+            furi_pubsub_subscribe(stress_pubsub, stress_churn_cb, context);
+        if(rand_r(&seed) % 2) {
+            bench_sleep_ns(rand_r(&seed) % 50000);
+        }
+        furi_pubsub_unsubscribe(stress_pubsub, subscription);
+
+        // From here on callback must never see this context
+        atomic_store(&context->magic, STRESS_DEAD);
+        free(quarantine[quarantine_pos]);
+        quarantine[quarantine_pos] = context;
+        quarantine_pos = (quarantine_pos + 1) % STRESS_QUARANTINE;
+        atomic_fetch_add(&stress_churns, 1);
+    }
+
+    for(size_t i = 0; i < STRESS_QUARANTINE; i++) {
+        free(quarantine[i]);
+    }
+    return NULL;
+}
+
+static int stress_run(unsigned seconds) {
+    pthread_t publishers[STRESS_PUBLISHERS];
+    pthread_t churners[STRESS_CHURNERS];
+
+    stress_pubsub = furi_pubsub_alloc();
+    FuriPubSubSubscription* anchor = furi_pubsub_subscribe(stress_pubsub, stress_anchor_cb, NULL);
+
+    for(size_t i = 0; i < STRESS_CHURNERS; i++) {
+        pthread_create(&churners[i], NULL, stress_churner, (void*)(uintptr_t)(i + 1));
+    }
+    for(size_t i = 0; i < STRESS_PUBLISHERS; i++) {
+        pthread_create(&publishers[i], NULL, stress_publisher, NULL);
+    }
+
+    bench_sleep_ns((uint64_t)seconds * 1000000000ULL);
+    atomic_store(&stress_stop, true);
+
+    for(size_t i = 0; i < STRESS_PUBLISHERS; i++) {
+        pthread_join(publishers[i], NULL);
+    }
+    for(size_t i = 0; i < STRESS_CHURNERS; i++) {
+        pthread_join(churners[i], NULL);
+    }
+
+    furi_pubsub_unsubscribe(stress_pubsub, anchor);
+    furi_pubsub_free(stress_pubsub);
+
+    unsigned long published = atomic_load(&stress_published);
+    unsigned long delivered = atomic_load(&stress_delivered);
+    unsigned long errors = atomic_load(&stress_errors);
+    printf(
+        "published %lu, delivered to anchor %lu, churns %lu, late callbacks %lu\n",
+        published,
+        delivered,
+        atomic_load(&stress_churns),
+        errors);
+
+    bool ok = (published == delivered) && !errors;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+/* Benchmark */
+
+typedef struct {
+    void* (*alloc)(void);
+    void (*free)(void* pubsub);
+    void* (*subscribe)(void* pubsub, FuriPubSubCallback callback, void* context);
+    void (*unsubscribe)(void* pubsub, void* subscription);
+    void (*publish)(void* pubsub, void* message);
+} BenchApi;
+
+/* What furi_pubsub was: mutex held while walking subscribers */
+typedef struct {
+    pthread_mutex_t mutex;
+    size_t count;
+    struct {
+        FuriPubSubCallback callback;
+        void* context;
+    } items[BENCH_MAX_SUBSCRIBERS + 4];
+} MutexPubSub;
+
+static void* mutex_pubsub_alloc(void) {
+    MutexPubSub* pubsub = calloc(1, sizeof(MutexPubSub));
+    pthread_mutex_init(&pubsub->mutex, NULL);
+    return pubsub;
+}
+
+static void mutex_pubsub_free(void* pubsub) {
+    pthread_mutex_destroy(&((MutexPubSub*)pubsub)->mutex);
+    free(pubsub);
+}
+
+static void* mutex_pubsub_subscribe(void* instance, FuriPubSubCallback callback, void* context) {
+    MutexPubSub* pubsub = instance;
+    pthread_mutex_lock(&pubsub->mutex);
+    size_t index = pubsub->count++;
+    pubsub->items[index].callback = callback;
+    pubsub->items[index].context = context;
+    pthread_mutex_unlock(&pubsub->mutex);
+    return context;
+}
+
+static void mutex_pubsub_unsubscribe(void* instance, void* subscription) {
+    MutexPubSub* pubsub = instance;
+    pthread_mutex_lock(&pubsub->mutex);
+    for(size_t i = 0; i < pubsub->count; i++) {
+        if(pubsub->items[i].context == subscription) {
+            memmove(
+                &pubsub->items[i],
+                &pubsub->items[i + 1],
+                (pubsub->count - i - 1) * sizeof(pubsub->items[0]));
+            pubsub->count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+}
+
+static void mutex_pubsub_publish(void* instance, void* message) {
+    MutexPubSub* pubsub = instance;
+    pthread_mutex_lock(&pubsub->mutex);
+    for(size_t i = 0; i < pubsub->count; i++) {
+        pubsub->items[i].callback(message, pubsub->items[i].context);
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+}
+
+static const BenchApi bench_mutex_api = {
+    .alloc = mutex_pubsub_alloc,
+    .free = mutex_pubsub_free,
+    .subscribe = mutex_pubsub_subscribe,
+    .unsubscribe = mutex_pubsub_unsubscribe,
+    .publish = mutex_pubsub_publish,
+};
+
+static void* furi_pubsub_bench_alloc(void) {
+    return furi_pubsub_alloc();
+}
+
+static void furi_pubsub_bench_free(void* pubsub) {
+    furi_pubsub_free(pubsub);
+}
+
+static void* furi_pubsub_bench_subscribe(void* pubsub, FuriPubSubCallback callback, void* context) {
+    return furi_pubsub_subscribe(pubsub, callback, context);
+}
+
+static void furi_pubsub_bench_unsubscribe(void* pubsub, void* subscription) {
+    furi_pubsub_unsubscribe(pubsub, subscription);
+}
+
+static void furi_pubsub_bench_publish(void* pubsub, void* message) {
+    furi_pubsub_publish(pubsub, message);
+}
+
+static const BenchApi bench_furi_api = {
+    .alloc = furi_pubsub_bench_alloc,
+    .free = furi_pubsub_bench_free,
+    .subscribe = furi_pubsub_bench_subscribe,
+    .unsubscribe = furi_pubsub_bench_unsubscribe,
+    .publish = furi_pubsub_bench_publish,
+};
+
+typedef struct {
+    const BenchApi* api;
+    void* pubsub;
+    atomic_bool stop;
+    uint64_t* samples;
+} BenchRun;
+
+static atomic_ulong bench_sink;
+
+static void bench_fast_cb(const void* message, void* context) {
+    (void)context;
+    atomic_fetch_add(&bench_sink, *(const uint32_t*)message);
+}
+
+static void bench_slow_cb(const void* message, void* context) {
+    bench_fast_cb(message, context);
+    bench_spin_ns(BENCH_SLOW_NS);
+}
+
+static void* bench_publisher(void* arg) {
+    BenchRun* run = arg;
+    uint32_t message = 1;
+    for(size_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint64_t start = bench_now_ns();
+        run->api->publish(run->pubsub, &message);
+        run->samples[i] = bench_now_ns() - start;
+    }
+    return NULL;
+}
+
+static void* bench_churner(void* arg) {
+    BenchRun* run = arg;
+    while(!atomic_load(&run->stop)) {
+        void* subscription = run->api->subscribe(run->pubsub, bench_fast_cb, &bench_sink);
+        bench_sleep_ns(BENCH_CHURN_NS);
+        run->api->unsubscribe(run->pubsub, subscription);
+    }
+    return NULL;
+}
+
+static int bench_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_run(
+    const char* name,
+    const BenchApi* api,
+    size_t subscribers,
+    size_t publishers,
+    bool slow) {
+    BenchRun runs[BENCH_MAX_PUBLISHERS];
+    pthread_t threads[BENCH_MAX_PUBLISHERS];
+    pthread_t churner;
+    void* subscriptions[BENCH_MAX_SUBSCRIBERS];
+    uint64_t* samples = malloc(sizeof(uint64_t) * BENCH_SAMPLES * publishers);
+
+    void* pubsub = api->alloc();
+    for(size_t i = 0; i < subscribers; i++) {
+        bool slow_one = slow && (i == 0);
+        subscriptions[i] =
+            api->subscribe(pubsub, slow_one ? bench_slow_cb : bench_fast_cb, &subscriptions[i]);
+    }
+
+    BenchRun churn = {.api = api, .pubsub = pubsub};
+    atomic_init(&churn.stop, false);
+    pthread_create(&churner, NULL, bench_churner, &churn);
+
+    uint64_t start = bench_now_ns();
+    for(size_t i = 0; i < publishers; i++) {
+        runs[i].api = api;
+        runs[i].pubsub = pubsub;
+        runs[i].samples = samples + i * BENCH_SAMPLES;
+        pthread_create(&threads[i], NULL, bench_publisher, &runs[i]);
+    }
+    for(size_t i = 0; i < publishers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    atomic_store(&churn.stop, true);
+    pthread_join(churner, NULL);
+    for(size_t i = 0; i < subscribers; i++) {
+        api->unsubscribe(pubsub, subscriptions[i]);
+    }
+    api->free(pubsub);
+
+    size_t count = BENCH_SAMPLES * publishers;
+    qsort(samples, count, sizeof(uint64_t), bench_compare);
+    printf(
+        "%-6s %4zu %4zu %-4s %9.2f %9.2f %9.2f %10.1f %9.0f\n",
+        name,
+        subscribers,
+        publishers,
+        slow ? "slow" : "fast",
+        samples[count / 2] / 1000.0,
+        samples[count * 99 / 100] / 1000.0,
+        samples[count - 1] / 1000.0,
+        elapsed / 1e6,
+        count / (elapsed / 1e9));
+    free(samples);
+}
+
+static int bench_main(void) {
+    static const size_t subscriber_counts[] = {1, 4, 16};
+    static const size_t publisher_counts[] = {1, 4};
+
+    printf(
+        "%-6s %4s %4s %-4s %9s %9s %9s %10s %9s\n",
+        "impl",
+        "subs",
+        "pubs",
+        "cb",
+        "p50 us",
+        "p99 us",
+        "max us",
+        "total ms",
+        "msg/s");
+
+    for(size_t slow = 0; slow < 2; slow++) {
+        for(size_t s = 0; s < sizeof(subscriber_counts) / sizeof(size_t); s++) {
+            for(size_t p = 0; p < sizeof(publisher_counts) / sizeof(size_t); p++) {
+                size_t subscribers = subscriber_counts[s];
+                size_t publishers = publisher_counts[p];
+                if(slow && publishers == 1 && subscribers > 1) continue;
+                bench_run("mutex", &bench_mutex_api, subscribers, publishers, slow);
+                bench_run("furi", &bench_furi_api, subscribers, publishers, slow);
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "stress") == 0) {
+        return stress_run(argc > 2 ? (unsigned)atoi(argv[2]) : 5);
+    } else if(argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main();
+    }
+
+    printf("Usage: %s stress [seconds] | bench\n", argv[0]);
+    return 1;
+}
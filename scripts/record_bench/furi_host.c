@@ -0,0 +1,117 @@
+/* Host implementation of furi core primitives used by furi/core/record.c */
+
+#include <stddef.h>
+#include <core/check.h>
+#include <core/event_flag.h>
+#include <core/kernel.h>
+#include <core/mutex.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t flags;
+} HostEventFlag;
+
+void __furi_crash() {
+    fprintf(stderr, "furi_crash\n");
+    abort();
+}
+
+void __furi_halt() {
+    fprintf(stderr, "furi_halt\n");
+    abort();
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    (void)type;
+    pthread_mutex_t* mutex = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(mutex, NULL);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    pthread_mutex_destroy(instance);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    (void)timeout;
+    return pthread_mutex_lock(instance) ? FuriStatusError : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    return pthread_mutex_unlock(instance) ? FuriStatusError : FuriStatusOk;
+}
+
+FuriEventFlag* furi_event_flag_alloc() {
+    HostEventFlag* event_flag = malloc(sizeof(HostEventFlag));
+    pthread_mutex_init(&event_flag->mutex, NULL);
+    pthread_cond_init(&event_flag->cond, NULL);
+    event_flag->flags = 0;
+    return event_flag;
+}
+
+void furi_event_flag_free(FuriEventFlag* instance) {
+    HostEventFlag* event_flag = instance;
+    pthread_cond_destroy(&event_flag->cond);
+    pthread_mutex_destroy(&event_flag->mutex);
+    free(event_flag);
+}
+
+uint32_t furi_event_flag_set(FuriEventFlag* instance, uint32_t flags) {
+    HostEventFlag* event_flag = instance;
+    pthread_mutex_lock(&event_flag->mutex);
+    event_flag->flags |= flags;
+    uint32_t result = event_flag->flags;
+    pthread_cond_broadcast(&event_flag->cond);
+    pthread_mutex_unlock(&event_flag->mutex);
+    return result;
+}
+
+uint32_t furi_event_flag_clear(FuriEventFlag* instance, uint32_t flags) {
+    HostEventFlag* event_flag = instance;
+    pthread_mutex_lock(&event_flag->mutex);
+    uint32_t result = event_flag->flags;
+    event_flag->flags &= ~flags;
+    pthread_mutex_unlock(&event_flag->mutex);
+    return result;
+}
+
+uint32_t furi_event_flag_get(FuriEventFlag* instance) {
+    HostEventFlag* event_flag = instance;
+    pthread_mutex_lock(&event_flag->mutex);
+    uint32_t result = event_flag->flags;
+    pthread_mutex_unlock(&event_flag->mutex);
+    return result;
+}
+
+/* Only FuriFlagWaitAny and FuriWaitForever, as used by record.c */
+uint32_t furi_event_flag_wait(
+    FuriEventFlag* instance,
+    uint32_t flags,
+    uint32_t options,
+    uint32_t timeout) {
+    (void)timeout;
+    HostEventFlag* event_flag = instance;
+    pthread_mutex_lock(&event_flag->mutex);
+    while(!(event_flag->flags & flags)) {
+        pthread_cond_wait(&event_flag->cond, &event_flag->mutex);
+    }
+    uint32_t result = event_flag->flags & flags;
+    if(!(options & FuriFlagNoClear)) {
+        event_flag->flags &= ~flags;
+    }
+    pthread_mutex_unlock(&event_flag->mutex);
+    return result;
+}
+
+/* 1 kHz tick, same as firmware */
+void furi_delay_tick(uint32_t ticks) {
+    struct timespec ts = {.tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/* Host shim: only what furi/core headers need to compile */
+
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
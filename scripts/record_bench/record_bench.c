@@ -0,0 +1,272 @@
+/**
+ * Furi record open/close benchmark and destroy race check on host threads.
+ *
+ * bench: open/close pairs per second for
+ *  - legacy: global mutex, string keyed dict lookup and event flag wait on
+ *    every open, as furi/core/record.c did before names were interned;
+ *  - name: furi_record_open/close with known service name;
+ *  - id: furi_record_open_id/close_id;
+ *  - other: furi_record_open/close with name outside of interned list.
+ * Each with 1 and 4 threads hammering the same record.
+ *
+ * race: threads open and close records while owner keeps destroying and
+ * creating them again with new data. Opened data must always be alive.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -pthread -o record_bench -Iscripts/record_bench/include -Ifuri \
+ *      scripts/record_bench/record_bench.c scripts/record_bench/furi_host.c \
+ *      furi/core/record.c
+ *  ./record_bench bench
+ *  ./record_bench race 5
+ *
+ * Add -fsanitize=thread to check record.c for data races.
+ */
+
+#include <stddef.h>
+#include <core/record.h>
+#include <core/event_flag.h>
+#include <core/mutex.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_ITERATIONS 2000000
+#define BENCH_MAX_THREADS 4
+#define BENCH_LEGACY_BUCKETS 16
+
+#define RACE_OPENERS 4
+#define RACE_ALIVE 0xA11FE
+#define RACE_DEAD 0xDEAD
+#define RACE_QUARANTINE 64
+
+/* Same as applications/services/storage/storage.h */
+#define RECORD_STORAGE "storage"
+
+static const char* const bench_other_name = "bench/other";
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Legacy: what furi_record was, dict replaced with chained hash of strdup'ed keys */
+
+typedef struct LegacyRecord {
+    char* name;
+    struct LegacyRecord* next;
+    FuriEventFlag* flags;
+    void* data;
+    size_t holders_count;
+} LegacyRecord;
+
+static struct {
+    FuriMutex* mutex;
+    LegacyRecord* buckets[BENCH_LEGACY_BUCKETS];
+} legacy;
+
+static LegacyRecord* legacy_get(const char* name) {
+    uint32_t hash = 0;
+    for(const char* c = name; *c; c++) hash = hash * 31 + (uint8_t)*c;
+    LegacyRecord** bucket = &legacy.buckets[hash % BENCH_LEGACY_BUCKETS];
+    LegacyRecord* record = *bucket;
+    while(record && strcmp(record->name, name)) record = record->next;
+    if(!record) {
+        record = calloc(1, sizeof(LegacyRecord));
+        record->name = strdup(name);
+        record->flags = furi_event_flag_alloc();
+        record->next = *bucket;
+        *bucket = record;
+    }
+    return record;
+}
+
+static void legacy_create(const char* name, void* data) {
+    furi_mutex_acquire(legacy.mutex, FuriWaitForever);
+    LegacyRecord* record = legacy_get(name);
+    record->data = data;
+    furi_event_flag_set(record->flags, 1);
+    furi_mutex_release(legacy.mutex);
+}
+
+static void* legacy_open(const char* name) {
+    furi_mutex_acquire(legacy.mutex, FuriWaitForever);
+    LegacyRecord* record = legacy_get(name);
+    record->holders_count++;
+    furi_mutex_release(legacy.mutex);
+    furi_event_flag_wait(record->flags, 1, FuriFlagWaitAny | FuriFlagNoClear, FuriWaitForever);
+    return record->data;
+}
+
+static void legacy_close(const char* name) {
+    furi_mutex_acquire(legacy.mutex, FuriWaitForever);
+    legacy_get(name)->holders_count--;
+    furi_mutex_release(legacy.mutex);
+}
+
+/* Bench */
+
+typedef enum {
+    BenchModeLegacy,
+    BenchModeName,
+    BenchModeId,
+    BenchModeOther,
+} BenchMode;
+
+static const char* const bench_mode_names[] = {"legacy", "name", "id", "other"};
+
+static atomic_ulong bench_sink;
+
+static void* bench_worker(void* arg) {
+    BenchMode mode = (BenchMode)(uintptr_t)arg;
+    unsigned long sink = 0;
+    for(size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        void* data;
+        if(mode == BenchModeLegacy) {
+            data = legacy_open(RECORD_STORAGE);
+            legacy_close(RECORD_STORAGE);
+        } else if(mode == BenchModeName) {
+            data = furi_record_open(RECORD_STORAGE);
+            furi_record_close(RECORD_STORAGE);
+        } else if(mode == BenchModeId) {
+            data = furi_record_open_id(FuriRecordIdStorage);
+            furi_record_close_id(FuriRecordIdStorage);
+        } else {
+            data = furi_record_open(bench_other_name);
+            furi_record_close(bench_other_name);
+        }
+        sink += (uintptr_t)data;
+    }
+    atomic_fetch_add(&bench_sink, sink);
+    return NULL;
+}
+
+static void bench_run(BenchMode mode, size_t threads) {
+    pthread_t workers[BENCH_MAX_THREADS];
+    double start = bench_time();
+    for(size_t i = 0; i < threads; i++) {
+        pthread_create(&workers[i], NULL, bench_worker, (void*)(uintptr_t)mode);
+    }
+    for(size_t i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double elapsed = bench_time() - start;
+    double pairs = (double)BENCH_ITERATIONS * threads;
+    printf(
+        "%-7s %7zu %10.1f %12.0f\n",
+        bench_mode_names[mode],
+        threads,
+        elapsed * 1e9 / pairs,
+        pairs / elapsed);
+}
+
+static int bench_main(void) {
+    static uint32_t storage;
+
+    legacy.mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    legacy_create(RECORD_STORAGE, &storage);
+    furi_record_create(RECORD_STORAGE, &storage);
+    furi_record_create(bench_other_name, &storage);
+
+    printf("%-7s %7s %10s %12s\n", "mode", "threads", "ns/pair", "pairs/s");
+    for(size_t threads = 1; threads <= BENCH_MAX_THREADS; threads *= 4) {
+        for(BenchMode mode = BenchModeLegacy; mode <= BenchModeOther; mode++) {
+            bench_run(mode, threads);
+        }
+    }
+    return 0;
+}
+
+/* Race */
+
+typedef struct {
+    atomic_uint magic;
+} RaceData;
+
+static atomic_bool race_stop;
+static atomic_ulong race_opens;
+static atomic_ulong race_errors;
+
+static void* race_opener(void* arg) {
+    const char* name = arg;
+    while(!atomic_load(&race_stop)) {
+        RaceData* data = furi_record_open(name);
+        if(atomic_load(&data->magic) != RACE_ALIVE) {
+            atomic_fetch_add(&race_errors, 1);
+        }
+        furi_record_close(name);
+        atomic_fetch_add(&race_opens, 1);
+    }
+    return NULL;
+}
+
+static int race_main(unsigned seconds) {
+    static const char* const names[] = {RECORD_STORAGE, "bench/race"};
+    pthread_t openers[RACE_OPENERS];
+    RaceData* quarantine[RACE_QUARANTINE] = {0};
+    size_t quarantine_pos = 0;
+    unsigned long cycles = 0, busy = 0;
+
+    for(size_t i = 0; i < 2; i++) {
+        RaceData* data = malloc(sizeof(RaceData));
+        atomic_init(&data->magic, RACE_ALIVE);
+        furi_record_create(names[i], data);
+    }
+    for(size_t i = 0; i < RACE_OPENERS; i++) {
+        pthread_create(&openers[i], NULL, race_opener, (void*)names[i % 2]);
+    }
+
+    double end = bench_time() + seconds;
+    while(bench_time() < end) {
+        const char* name = names[cycles % 2];
+        RaceData* data = furi_record_open(name);
+        furi_record_close(name);
+        if(!furi_record_destroy(name)) {
+            busy++;
+            continue;
+        }
+        // Nobody can open it now, until created again
+        atomic_store(&data->magic, RACE_DEAD);
+        free(quarantine[quarantine_pos]);
+        quarantine[quarantine_pos] = data;
+        quarantine_pos = (quarantine_pos + 1) % RACE_QUARANTINE;
+
+        data = malloc(sizeof(RaceData));
+        atomic_init(&data->magic, RACE_ALIVE);
+        furi_record_create(name, data);
+        cycles++;
+    }
+
+    atomic_store(&race_stop, true);
+    for(size_t i = 0; i < RACE_OPENERS; i++) {
+        pthread_join(openers[i], NULL);
+    }
+
+    unsigned long errors = atomic_load(&race_errors);
+    printf(
+        "opens %lu, destroy cycles %lu, busy destroys %lu, dead data opened %lu\n",
+        atomic_load(&race_opens),
+        cycles,
+        busy,
+        errors);
+    printf("%s\n", errors ? "FAILED" : "OK");
+    return errors ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    furi_record_init();
+
+    if(argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main();
+    } else if(argc > 1 && strcmp(argv[1], "race") == 0) {
+        return race_main(argc > 2 ? (unsigned)atoi(argv[2]) : 5);
+    }
+
+    printf("Usage: %s bench | race [seconds]\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+
+from flipper.app import App
+from flipper.rpc import FlipperRpc, LoopbackTransport, SerialTransport
+from flipper.utils.cdc import resolve_port
+
+import os
+import time
+
+
+class Main(App):
+    def init(self):
+        self.parser.add_argument("-p", "--port", help="CDC Port", default="auto")
+        self.parser.add_argument(
+            "--loopback",
+            help="Use in-process device emulation instead of a real device",
+            action="store_true",
+        )
+        self.parser.add_argument(
+            "-c",
+            "--chunk",
+            help="Read chunk size, writes are limited by device message size",
+            type=int,
+            default=8192,
+        )
+        self.parser.add_argument(
+            "-w",
+            "--window",
+            help="Write requests batched per transport write",
+            type=int,
+            default=8,
+        )
+        self.parser.add_argument(
+            "-z", "--compress", help="Compress read payloads", action="store_true"
+        )
+        self.parser.add_argument(
+            "-s", "--size", help="Test file size", type=int, default=1024 * 1024
+        )
+        self.parser.add_argument(
+            "--pattern",
+            help="Test file contents",
+            choices=["random", "text"],
+            default="random",
+        )
+        self.parser.add_argument(
+            "flipper_path", nargs="?", help="Flipper path", default="/ext/rpc_bench.bin"
+        )
+        self.parser.set_defaults(func=self.bench)
+
+    def _make_data(self):
+        if self.args.pattern == "random":
+            return os.urandom(self.args.size)
+        line = b"RAW_Data: 500 -1000 500 -500 1000 -500\n"
+        return (line * (self.args.size // len(line) + 1))[: self.args.size]
+
+    def _open(self):
+        if self.args.loopback:
+            return None, LoopbackTransport()
+
+        import serial
+
+        if not (port := resolve_port(self.logger, self.args.port)):
+            return None, None
+        serial_port = serial.Serial(port, timeout=1)
+        serial_port.reset_input_buffer()
+        return serial_port, SerialTransport(serial_port)
+
+    def bench(self):
+        serial_port, transport = self._open()
+        if not transport:
+            return 1
+
+        rpc = FlipperRpc(transport)
+        rpc.start(self.args.chunk, self.args.compress)
+        self.logger.info(
+            f"Session: read chunk {rpc.chunk_size}, "
+            f"write chunk {rpc.write_chunk_size(self.args.flipper_path)}, "
+            f"compress {rpc.compress}"
+        )
+
+        data = self._make_data()
+        mb = len(data) / (1024 * 1024)
+
+        start = time.monotonic()
+        rpc.write_file(self.args.flipper_path, data, self.args.window)
+        elapsed = time.monotonic() - start
+        self.logger.info(f"Write: {mb / elapsed:.3f} MB/s")
+
+        start = time.monotonic()
+        received = rpc.read_file(self.args.flipper_path)
+        elapsed = time.monotonic() - start
+        self.logger.info(f"Read: {mb / elapsed:.3f} MB/s")
+
+        if serial_port:
+            serial_port.close()
+
+        if received != data:
+            self.logger.error("Data mismatch")
+            return 1
+        return 0
+
+
+if __name__ == "__main__":
+    Main()()
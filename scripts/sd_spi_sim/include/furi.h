@@ -0,0 +1,45 @@
+#pragma once
+
+/* Host shim: minimal subset of furi core used by SD card driver */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef UNUSED
+#define UNUSED(X) (void)(X)
+#endif
+
+#ifndef __IO
+#define __IO volatile
+#endif
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define furi_check(x)                                                                 \
+    do {                                                                              \
+        if(!(x)) {                                                                    \
+            fprintf(stderr, "furi_check failed: %s:%d %s\n", __FILE__, __LINE__, #x); \
+            abort();                                                                  \
+        }                                                                             \
+    } while(0)
+
+#define furi_assert(x) furi_check(x)
+
+/* Firmware formats uint32_t as long, which it is not on host: arguments are dropped */
+#define FURI_LOG_E(tag, format, ...) fprintf(stderr, "[E][%s] %s\n", tag, format)
+#define FURI_LOG_W(tag, format, ...) fprintf(stderr, "[W][%s] %s\n", tag, format)
+#define FURI_LOG_I(tag, format, ...) fprintf(stderr, "[I][%s] %s\n", tag, format)
+#define FURI_LOG_D(tag, format, ...) UNUSED(tag)
+#define FURI_LOG_T(tag, format, ...) UNUSED(tag)
+
+/** Delays advance simulated time, they never sleep */
+void furi_delay_us(uint32_t microseconds);
+void furi_delay_ms(uint32_t milliseconds);
@@ -0,0 +1,73 @@
+#pragma once
+
+/* Host shim: GPIO, power and SPI bus stubs for SD card driver */
+
+#include <furi.h>
+
+typedef struct {
+    uint32_t pin;
+} GpioPin;
+
+typedef enum {
+    GpioModeInput,
+    GpioModeOutputPushPull,
+    GpioModeAltFunctionPushPull,
+} GpioMode;
+
+typedef enum {
+    GpioPullNo,
+    GpioPullUp,
+    GpioPullDown,
+} GpioPull;
+
+typedef enum {
+    GpioSpeedLow,
+    GpioSpeedMedium,
+    GpioSpeedHigh,
+    GpioSpeedVeryHigh,
+} GpioSpeed;
+
+typedef enum {
+    GpioAltFn5SPI2 = 5,
+    GpioAltFnUnused = 16,
+} GpioAltFn;
+
+typedef struct {
+    /** SPI clock of this handle, used to model transfer time */
+    uint32_t frequency;
+    const GpioPin* miso;
+    const GpioPin* mosi;
+    const GpioPin* sck;
+    const GpioPin* cs;
+} FuriHalSpiBusHandle;
+
+extern FuriHalSpiBusHandle furi_hal_spi_bus_handle_sd_fast;
+extern FuriHalSpiBusHandle furi_hal_spi_bus_handle_sd_slow;
+extern FuriHalSpiBusHandle* furi_hal_sd_spi_handle;
+
+void furi_hal_spi_acquire(FuriHalSpiBusHandle* handle);
+void furi_hal_spi_release(FuriHalSpiBusHandle* handle);
+
+void furi_hal_gpio_init_ex(
+    const GpioPin* gpio,
+    const GpioMode mode,
+    const GpioPull pull,
+    const GpioSpeed speed,
+    const GpioAltFn alt_fn);
+void furi_hal_gpio_write(const GpioPin* gpio, const bool state);
+
+typedef struct {
+    uint32_t start;
+    uint32_t value;
+} FuriHalCortexTimer;
+
+/* Timers run on simulated card time */
+FuriHalCortexTimer furi_hal_cortex_timer_get(uint32_t timeout_us);
+bool furi_hal_cortex_timer_is_expired(FuriHalCortexTimer cortex_timer);
+
+void furi_hal_power_enable_external_3_3v(void);
+void furi_hal_power_disable_external_3_3v(void);
+
+void hal_sd_detect_init(void);
+void hal_sd_detect_set_low(void);
+bool hal_sd_detect(void);
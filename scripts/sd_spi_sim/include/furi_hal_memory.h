@@ -0,0 +1,12 @@
+#pragma once
+
+/* Host shim: dedicated memory pool is plain heap */
+
+#include <stdlib.h>
+
+/* Free SRAM2 on a device with BLE stack running */
+#define SD_SPI_SIM_POOL_SIZE (40 * 1024)
+
+#define furi_hal_memory_alloc(size) malloc(size)
+#define furi_hal_memory_get_free() SD_SPI_SIM_POOL_SIZE
+#define furi_hal_memory_max_pool_block() SD_SPI_SIM_POOL_SIZE
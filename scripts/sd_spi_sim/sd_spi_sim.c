@@ -0,0 +1,584 @@
+#include "sd_spi_sim.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <furi.h>
+#include <furi_hal.h>
+#include <stm32_adafruit_sd.h>
+
+#define TAG "SdSpiSim"
+
+#define SD_SPI_SIM_CMD_GO_IDLE_STATE 0
+#define SD_SPI_SIM_CMD_SEND_IF_COND 8
+#define SD_SPI_SIM_CMD_SEND_CSD 9
+#define SD_SPI_SIM_CMD_SEND_CID 10
+#define SD_SPI_SIM_CMD_STOP_TRANSMISSION 12
+#define SD_SPI_SIM_CMD_SEND_STATUS 13
+#define SD_SPI_SIM_CMD_SET_BLOCKLEN 16
+#define SD_SPI_SIM_CMD_READ_SINGLE_BLOCK 17
+#define SD_SPI_SIM_CMD_READ_MULT_BLOCK 18
+#define SD_SPI_SIM_CMD_WRITE_SINGLE_BLOCK 24
+#define SD_SPI_SIM_CMD_WRITE_MULT_BLOCK 25
+#define SD_SPI_SIM_CMD_SD_ERASE_GRP_START 32
+#define SD_SPI_SIM_CMD_SD_ERASE_GRP_END 33
+#define SD_SPI_SIM_CMD_ERASE 38
+#define SD_SPI_SIM_CMD_SD_APP_OP_COND 41
+#define SD_SPI_SIM_CMD_APP_CMD 55
+#define SD_SPI_SIM_CMD_READ_OCR 58
+
+#define SD_SPI_SIM_QUEUE_SIZE 1024
+#define SD_SPI_SIM_CS_GUARD_US 10
+#define SD_SPI_SIM_R1_IDLE 0x01
+#define SD_SPI_SIM_R1_ILLEGAL_COMMAND 0x04
+#define SD_SPI_SIM_R1_ADDRESS_ERROR 0x20
+#define SD_SPI_SIM_R1_PARAMETER_ERROR 0x40
+#define SD_SPI_SIM_TOKEN_SINGLE 0xFE
+#define SD_SPI_SIM_TOKEN_MULTI_WRITE 0xFC
+#define SD_SPI_SIM_TOKEN_STOP_TRAN 0xFD
+#define SD_SPI_SIM_DATA_ACCEPTED 0xE5
+/* Garbage clocked out after CMD12, driver must not take it for R1 */
+#define SD_SPI_SIM_STUFF_BYTE 0x3F
+#define SD_SPI_SIM_NCR_BYTE 0xBF
+/* R2 status of a failed write: out of range */
+#define SD_SPI_SIM_R2_OUT_OF_RANGE 0x80
+
+typedef enum {
+    SdSpiSimStateCommand,
+    SdSpiSimStateReadSingle,
+    SdSpiSimStateReadMulti,
+    SdSpiSimStateWriteSingle,
+    SdSpiSimStateWriteMulti,
+} SdSpiSimState;
+
+typedef struct {
+    FILE* image;
+    uint32_t sectors;
+    SdSpiSimConfig config;
+    SdSpiSimStats stats;
+
+    uint64_t time_ns;
+    bool selected;
+    bool idle;
+    bool app_cmd;
+    uint8_t op_cond_attempts;
+    SdSpiSimState state;
+
+    uint8_t frame[6];
+    size_t frame_length;
+
+    /* Bytes card is going to clock out, not before ready_ns */
+    uint8_t queue[SD_SPI_SIM_QUEUE_SIZE];
+    size_t queue_head;
+    size_t queue_length;
+    uint64_t ready_ns;
+    /* DO is held low until busy_ns */
+    uint64_t busy_ns;
+    /* Reported and cleared by CMD13 */
+    uint8_t r2;
+
+    uint32_t block_address;
+    bool stream_started;
+    uint8_t block[SD_SPI_SIM_BLOCK_SIZE + 2];
+    size_t block_length;
+    bool block_receiving;
+    bool block_failed;
+} SdSpiSim;
+
+static const SdSpiSimConfig sd_spi_sim_default_config = {
+    .read_latency_us = 300,
+    .read_stream_latency_us = 20,
+    .write_busy_us = 900,
+    .write_stream_busy_us = 120,
+    .write_stop_busy_us = 900,
+};
+
+static SdSpiSim sim = {0};
+
+static const GpioPin sd_spi_sim_pin = {0};
+
+FuriHalSpiBusHandle furi_hal_spi_bus_handle_sd_fast = {
+    .frequency = 16000000,
+    .miso = &sd_spi_sim_pin,
+    .mosi = &sd_spi_sim_pin,
+    .sck = &sd_spi_sim_pin,
+    .cs = &sd_spi_sim_pin,
+};
+
+FuriHalSpiBusHandle furi_hal_spi_bus_handle_sd_slow = {
+    .frequency = 2000000,
+    .miso = &sd_spi_sim_pin,
+    .mosi = &sd_spi_sim_pin,
+    .sck = &sd_spi_sim_pin,
+    .cs = &sd_spi_sim_pin,
+};
+
+FuriHalSpiBusHandle* furi_hal_sd_spi_handle = NULL;
+
+static void sd_spi_sim_queue_clear(void) {
+    sim.queue_head = 0;
+    sim.queue_length = 0;
+    sim.ready_ns = 0;
+}
+
+static void sd_spi_sim_queue_push(uint8_t byte) {
+    furi_check(sim.queue_length < SD_SPI_SIM_QUEUE_SIZE);
+    sim.queue[(sim.queue_head + sim.queue_length) % SD_SPI_SIM_QUEUE_SIZE] = byte;
+    sim.queue_length++;
+}
+
+static void sd_spi_sim_queue_push_r1(uint8_t r1) {
+    /* NCR: one byte before response */
+    sd_spi_sim_queue_push(0xFF);
+    sd_spi_sim_queue_push(r1);
+}
+
+static uint8_t sd_spi_sim_queue_pop(void) {
+    uint8_t byte = sim.queue[sim.queue_head];
+    sim.queue_head = (sim.queue_head + 1) % SD_SPI_SIM_QUEUE_SIZE;
+    sim.queue_length--;
+    return byte;
+}
+
+static uint8_t sd_spi_sim_r1(void) {
+    return sim.idle ? SD_SPI_SIM_R1_IDLE : 0x00;
+}
+
+static bool sd_spi_sim_image_io(uint32_t block, uint8_t* data, bool write) {
+    if(block >= sim.sectors) return false;
+    if(fseek(sim.image, (long)block * SD_SPI_SIM_BLOCK_SIZE, SEEK_SET)) return false;
+    size_t done = write ? fwrite(data, SD_SPI_SIM_BLOCK_SIZE, 1, sim.image) :
+                          fread(data, SD_SPI_SIM_BLOCK_SIZE, 1, sim.image);
+    return done == 1;
+}
+
+static void sd_spi_sim_queue_block(uint32_t latency_us) {
+    uint8_t data[SD_SPI_SIM_BLOCK_SIZE];
+
+    if(!sd_spi_sim_image_io(sim.block_address, data, false)) {
+        /* Data error token: out of range */
+        sd_spi_sim_queue_push(0x08);
+        sim.state = SdSpiSimStateCommand;
+        return;
+    }
+
+    sim.ready_ns = sim.time_ns + (uint64_t)latency_us * 1000;
+    sd_spi_sim_queue_push(SD_SPI_SIM_TOKEN_SINGLE);
+    for(size_t i = 0; i < SD_SPI_SIM_BLOCK_SIZE; i++) {
+        sd_spi_sim_queue_push(data[i]);
+    }
+    /* CRC is not checked in SPI mode */
+    sd_spi_sim_queue_push(0x00);
+    sd_spi_sim_queue_push(0x00);
+
+    sim.block_address++;
+    sim.stats.blocks_read++;
+}
+
+static void sd_spi_sim_push_register(const uint8_t* data) {
+    sd_spi_sim_queue_push(SD_SPI_SIM_TOKEN_SINGLE);
+    for(size_t i = 0; i < 16; i++) {
+        sd_spi_sim_queue_push(data[i]);
+    }
+    sd_spi_sim_queue_push(0x00);
+    sd_spi_sim_queue_push(0x00);
+}
+
+static void sd_spi_sim_push_csd(void) {
+    /* CSD version 2.0, READ_BL_LEN 9, capacity = (C_SIZE + 1) * 512KiB */
+    uint32_t c_size = sim.sectors / 1024 - 1;
+    uint8_t csd[16] = {
+        0x40,
+        0x0E,
+        0x00,
+        0x32,
+        0x5B,
+        0x59,
+        0x00,
+        (uint8_t)((c_size >> 16) & 0x3F),
+        (uint8_t)(c_size >> 8),
+        (uint8_t)c_size,
+        0x7F,
+        0x80,
+        0x0A,
+        0x40,
+        0x00,
+        0x01,
+    };
+    sd_spi_sim_push_register(csd);
+}
+
+static void sd_spi_sim_push_cid(void) {
+    uint8_t cid[16] = {
+        0x03, 'S', 'D', 'S', 'I', 'M', 'C', 'D', 0x10, 0x12, 0x34, 0x56, 0x78, 0x01, 0x6A, 0x01};
+    sd_spi_sim_push_register(cid);
+}
+
+static bool sd_spi_sim_check_address(uint32_t address) {
+    if(address >= sim.sectors) {
+        sd_spi_sim_queue_push_r1(SD_SPI_SIM_R1_ADDRESS_ERROR);
+        return false;
+    }
+    sim.block_address = address;
+    return true;
+}
+
+static void sd_spi_sim_execute(void) {
+    uint8_t cmd = sim.frame[0] & 0x3F;
+    uint32_t arg = ((uint32_t)sim.frame[1] << 24) | ((uint32_t)sim.frame[2] << 16) |
+                   ((uint32_t)sim.frame[3] << 8) | sim.frame[4];
+    bool app_cmd = sim.app_cmd;
+    sim.app_cmd = false;
+    sim.stats.cmd_count[cmd]++;
+
+    if(cmd == SD_SPI_SIM_CMD_STOP_TRANSMISSION) {
+        bool streaming = (sim.state == SdSpiSimStateReadMulti);
+        sd_spi_sim_queue_clear();
+        sim.state = SdSpiSimStateCommand;
+        if(streaming) {
+            sd_spi_sim_queue_push(SD_SPI_SIM_STUFF_BYTE);
+            sd_spi_sim_queue_push(SD_SPI_SIM_NCR_BYTE);
+        }
+        sd_spi_sim_queue_push_r1(sd_spi_sim_r1());
+        sim.busy_ns = sim.time_ns + 8 * 1000;
+        return;
+    }
+
+    if(sim.state != SdSpiSimStateCommand) {
+        /* Only CMD12 is accepted while streaming */
+        return;
+    }
+
+    bool init_cmd =
+        (cmd == SD_SPI_SIM_CMD_GO_IDLE_STATE) || (cmd == SD_SPI_SIM_CMD_SEND_IF_COND) ||
+        (cmd == SD_SPI_SIM_CMD_APP_CMD) || (cmd == SD_SPI_SIM_CMD_SD_APP_OP_COND) ||
+        (cmd == SD_SPI_SIM_CMD_READ_OCR);
+    if(sim.idle && !init_cmd) {
+        sd_spi_sim_queue_push_r1(SD_SPI_SIM_R1_IDLE | SD_SPI_SIM_R1_ILLEGAL_COMMAND);
+        return;
+    }
+
+    switch(cmd) {
+    case SD_SPI_SIM_CMD_GO_IDLE_STATE:
+        sim.idle = true;
+        sim.op_cond_attempts = 0;
+        sd_spi_sim_queue_push_r1(SD_SPI_SIM_R1_IDLE);
+        break;
+    case SD_SPI_SIM_CMD_SEND_IF_COND:
+        sd_spi_sim_queue_push_r1(sd_spi_sim_r1());
+        sd_spi_sim_queue_push(0x00);
+        sd_spi_sim_queue_push(0x00);
+        sd_spi_sim_queue_push((arg >> 8) & 0x0F);
+        sd_spi_sim_queue_push(arg & 0xFF);
+        break;
+    case SD_SPI_SIM_CMD_APP_CMD:
+        sim.app_cmd = true;
+        sd_spi_sim_queue_push_r1(sd_spi_sim_r1());
+        break;
+    case SD_SPI_SIM_CMD_SD_APP_OP_COND:
+        if(!app_cmd) {
+            sd_spi_sim_queue_push_r1(sd_spi_sim_r1() | SD_SPI_SIM_R1_ILLEGAL_COMMAND);
+            break;
+        }
+        /* Card leaves idle state on second attempt, like real ones do after a while */
+        if(++sim.op_cond_attempts >= 2) sim.idle = false;
+        sd_spi_sim_queue_push_r1(sd_spi_sim_r1());
+        break;
+    case SD_SPI_SIM_CMD_READ_OCR:
+        sd_spi_sim_queue_push_r1(sd_spi_sim_r1());
+        /* Power up done, CCS set: high capacity card */
+        sd_spi_sim_queue_push(sim.idle ? 0x00 : 0xC0);
+        sd_spi_sim_queue_push(0xFF);
+        sd_spi_sim_queue_push(0x80);
+        sd_spi_sim_queue_push(0x00);
+        break;
+    case SD_SPI_SIM_CMD_SEND_CSD:
+        sd_spi_sim_queue_push_r1(0x00);
+        sd_spi_sim_push_csd();
+        break;
+    case SD_SPI_SIM_CMD_SEND_CID:
+        sd_spi_sim_queue_push_r1(0x00);
+        sd_spi_sim_push_cid();
+        break;
+    case SD_SPI_SIM_CMD_SEND_STATUS:
+        sd_spi_sim_queue_push_r1(0x00);
+        sd_spi_sim_queue_push(sim.r2);
+        sim.r2 = 0x00;
+        break;
+    case SD_SPI_SIM_CMD_SET_BLOCKLEN:
+        sd_spi_sim_queue_push_r1(
+            arg == SD_SPI_SIM_BLOCK_SIZE ? 0x00 : SD_SPI_SIM_R1_PARAMETER_ERROR);
+        break;
+    case SD_SPI_SIM_CMD_READ_SINGLE_BLOCK:
+        if(sd_spi_sim_check_address(arg)) {
+            sd_spi_sim_queue_push_r1(0x00);
+            sim.state = SdSpiSimStateReadSingle;
+        }
+        break;
+    case SD_SPI_SIM_CMD_READ_MULT_BLOCK:
+        if(sd_spi_sim_check_address(arg)) {
+            sd_spi_sim_queue_push_r1(0x00);
+            sim.state = SdSpiSimStateReadMulti;
+            sim.stream_started = false;
+        }
+        break;
+    case SD_SPI_SIM_CMD_WRITE_SINGLE_BLOCK:
+        if(sd_spi_sim_check_address(arg)) {
+            sd_spi_sim_queue_push_r1(0x00);
+            sim.state = SdSpiSimStateWriteSingle;
+            sim.block_receiving = false;
+        }
+        break;
+    case SD_SPI_SIM_CMD_WRITE_MULT_BLOCK:
+        if(sd_spi_sim_check_address(arg)) {
+            sd_spi_sim_queue_push_r1(0x00);
+            sim.state = SdSpiSimStateWriteMulti;
+            sim.block_receiving = false;
+            sim.block_failed = false;
+        }
+        break;
+    case SD_SPI_SIM_CMD_SD_ERASE_GRP_START:
+    case SD_SPI_SIM_CMD_SD_ERASE_GRP_END:
+        sd_spi_sim_queue_push_r1(0x00);
+        break;
+    case SD_SPI_SIM_CMD_ERASE:
+        sd_spi_sim_queue_push_r1(0x00);
+        sim.busy_ns = sim.time_ns + 1000 * 1000;
+        break;
+    default:
+        sd_spi_sim_queue_push_r1(SD_SPI_SIM_R1_ILLEGAL_COMMAND);
+        break;
+    }
+}
+
+static void sd_spi_sim_receive_write(uint8_t in) {
+    bool multi = (sim.state == SdSpiSimStateWriteMulti);
+
+    if(!sim.block_receiving) {
+        if(multi && in == SD_SPI_SIM_TOKEN_STOP_TRAN) {
+            /* Busy starts one byte after Stop Tran token */
+            sd_spi_sim_queue_push(0xFF);
+            sim.busy_ns = sim.time_ns + (uint64_t)sim.config.write_stop_busy_us * 1000;
+            sim.state = SdSpiSimStateCommand;
+            sim.block_failed = false;
+        } else if(sim.block_failed) {
+            /* Only Stop Tran is accepted after a failed block */
+        } else if(in == (multi ? SD_SPI_SIM_TOKEN_MULTI_WRITE : SD_SPI_SIM_TOKEN_SINGLE)) {
+            sim.block_receiving = true;
+            sim.block_length = 0;
+        }
+        return;
+    }
+
+    sim.block[sim.block_length++] = in;
+    if(sim.block_length < sizeof(sim.block)) return;
+
+    sim.block_receiving = false;
+    if(sd_spi_sim_image_io(sim.block_address, sim.block, true)) {
+        sd_spi_sim_queue_push(SD_SPI_SIM_DATA_ACCEPTED);
+        uint32_t busy_us = multi ? sim.config.write_stream_busy_us : sim.config.write_busy_us;
+        sim.busy_ns = sim.time_ns + (uint64_t)busy_us * 1000;
+        sim.block_address++;
+        sim.stats.blocks_written++;
+    } else {
+        /* Write error data response, card ignores next blocks until Stop Tran */
+        sd_spi_sim_queue_push(0xED);
+        sim.busy_ns = sim.time_ns + (uint64_t)sim.config.write_busy_us * 1000;
+        sim.r2 = SD_SPI_SIM_R2_OUT_OF_RANGE;
+        sim.block_failed = multi;
+    }
+
+    if(!multi) sim.state = SdSpiSimStateCommand;
+}
+
+static uint8_t sd_spi_sim_exchange(uint8_t in) {
+    uint32_t frequency = furi_hal_sd_spi_handle ? furi_hal_sd_spi_handle->frequency : 2000000;
+    sim.time_ns += 8ULL * 1000000000ULL / frequency;
+
+    if(!sim.selected) return 0xFF;
+    sim.stats.bytes++;
+
+    /* Output is shifted out while input is shifted in */
+    uint8_t out = 0xFF;
+    if(sim.queue_length) {
+        if(sim.time_ns >= sim.ready_ns) out = sd_spi_sim_queue_pop();
+    } else if(sim.time_ns < sim.busy_ns) {
+        out = 0x00;
+    }
+
+    if(sim.state == SdSpiSimStateWriteSingle || sim.state == SdSpiSimStateWriteMulti) {
+        if(!sim.queue_length && sim.time_ns >= sim.busy_ns) {
+            sd_spi_sim_receive_write(in);
+        }
+    } else if(sim.frame_length || (in & 0xC0) == 0x40) {
+        sim.frame[sim.frame_length++] = in;
+        if(sim.frame_length == sizeof(sim.frame)) {
+            sim.frame_length = 0;
+            sd_spi_sim_execute();
+        }
+    }
+
+    /* Data of the read commands follows R1 after access time */
+    if(!sim.queue_length) {
+        if(sim.state == SdSpiSimStateReadSingle) {
+            sd_spi_sim_queue_block(sim.config.read_latency_us);
+            sim.state = SdSpiSimStateCommand;
+        } else if(sim.state == SdSpiSimStateReadMulti) {
+            sd_spi_sim_queue_block(
+                sim.stream_started ? sim.config.read_stream_latency_us :
+                                     sim.config.read_latency_us);
+            sim.stream_started = true;
+        }
+    }
+
+    return out;
+}
+
+bool sd_spi_sim_open(const char* path, uint32_t sectors) {
+    furi_check(sectors && (sectors % 1024) == 0);
+
+    memset(&sim, 0, sizeof(sim));
+    sim.config = sd_spi_sim_default_config;
+    sim.sectors = sectors;
+    sim.idle = true;
+
+    sim.image = fopen(path, "r+b");
+    if(!sim.image) sim.image = fopen(path, "w+b");
+    if(!sim.image) {
+        FURI_LOG_E(TAG, "Cannot open image %s", path);
+        return false;
+    }
+
+    /* Extend image to card capacity */
+    fseek(sim.image, 0, SEEK_END);
+    long size = ftell(sim.image);
+    long capacity = (long)sectors * SD_SPI_SIM_BLOCK_SIZE;
+    if(size < capacity) {
+        fseek(sim.image, capacity - 1, SEEK_SET);
+        fputc(0, sim.image);
+        fflush(sim.image);
+    }
+
+    return true;
+}
+
+void sd_spi_sim_close(void) {
+    if(sim.image) {
+        fclose(sim.image);
+        sim.image = NULL;
+    }
+}
+
+void sd_spi_sim_set_config(const SdSpiSimConfig* config) {
+    sim.config = *config;
+}
+
+const SdSpiSimConfig* sd_spi_sim_get_config(void) {
+    return &sim.config;
+}
+
+uint64_t sd_spi_sim_get_time_us(void) {
+    return sim.time_ns / 1000;
+}
+
+void sd_spi_sim_advance_us(uint32_t microseconds) {
+    sim.time_ns += (uint64_t)microseconds * 1000;
+}
+
+const SdSpiSimStats* sd_spi_sim_get_stats(void) {
+    return &sim.stats;
+}
+
+void sd_spi_sim_reset_stats(void) {
+    memset(&sim.stats, 0, sizeof(sim.stats));
+}
+
+/* SD_IO_* layer, replaces spi_sd_hal.c */
+
+void SD_IO_Init(void) {
+    SD_IO_CSState(1);
+    for(uint8_t counter = 0; counter <= 200; counter++) {
+        SD_IO_WriteByte(0xFF);
+    }
+}
+
+void SD_IO_CSState(uint8_t val) {
+    /* Same guard times as the real bus driver */
+    sd_spi_sim_advance_us(SD_SPI_SIM_CS_GUARD_US);
+    sim.selected = (val == 0);
+}
+
+void SD_IO_WriteReadData(const uint8_t* DataIn, uint8_t* DataOut, uint16_t DataLength) {
+    for(uint16_t i = 0; i < DataLength; i++) {
+        uint8_t out = sd_spi_sim_exchange(DataIn ? DataIn[i] : 0xFF);
+        if(DataOut) DataOut[i] = out;
+    }
+}
+
+uint8_t SD_IO_WriteByte(uint8_t Data) {
+    return sd_spi_sim_exchange(Data);
+}
+
+/* Host shims */
+
+void furi_delay_us(uint32_t microseconds) {
+    sd_spi_sim_advance_us(microseconds);
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    sd_spi_sim_advance_us(milliseconds * 1000);
+}
+
+FuriHalCortexTimer furi_hal_cortex_timer_get(uint32_t timeout_us) {
+    FuriHalCortexTimer timer = {
+        .start = (uint32_t)sd_spi_sim_get_time_us(),
+        .value = timeout_us,
+    };
+    return timer;
+}
+
+bool furi_hal_cortex_timer_is_expired(FuriHalCortexTimer cortex_timer) {
+    return (uint32_t)sd_spi_sim_get_time_us() - cortex_timer.start >= cortex_timer.value;
+}
+
+void furi_hal_spi_acquire(FuriHalSpiBusHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_spi_release(FuriHalSpiBusHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_gpio_init_ex(
+    const GpioPin* gpio,
+    const GpioMode mode,
+    const GpioPull pull,
+    const GpioSpeed speed,
+    const GpioAltFn alt_fn) {
+    UNUSED(gpio);
+    UNUSED(mode);
+    UNUSED(pull);
+    UNUSED(speed);
+    UNUSED(alt_fn);
+}
+
+void furi_hal_gpio_write(const GpioPin* gpio, const bool state) {
+    UNUSED(gpio);
+    UNUSED(state);
+}
+
+void furi_hal_power_enable_external_3_3v(void) {
+    sim.idle = true;
+}
+
+void furi_hal_power_disable_external_3_3v(void) {
+}
+
+void hal_sd_detect_init(void) {
+}
+
+void hal_sd_detect_set_low(void) {
+}
+
+bool hal_sd_detect(void) {
+    return true;
+}
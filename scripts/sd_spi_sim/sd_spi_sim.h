@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * SD card SPI protocol simulator.
+ *
+ * Implements SD_IO_* layer of the SD card driver on top of a disk image file.
+ * Card is modeled byte by byte: command frames, R1/R1b/R2/R3/R7 responses,
+ * data tokens, CMD18 streaming until CMD12 and CMD25 streaming until Stop Tran
+ * token. Access latency and programming busy time are modeled against the SPI
+ * clock, so simulated time is what the driver would spend on a real bus.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SD_SPI_SIM_BLOCK_SIZE 512
+
+typedef struct {
+    uint32_t read_latency_us; /**< CMD17 and first CMD18 block access time */
+    uint32_t read_stream_latency_us; /**< Gap between CMD18 blocks */
+    uint32_t write_busy_us; /**< CMD24 programming time */
+    uint32_t write_stream_busy_us; /**< Programming time of a CMD25 block */
+    uint32_t write_stop_busy_us; /**< Busy time after Stop Tran token */
+} SdSpiSimConfig;
+
+typedef struct {
+    uint64_t bytes; /**< Bytes clocked while card was selected */
+    uint64_t blocks_read;
+    uint64_t blocks_written;
+    uint32_t cmd_count[64];
+} SdSpiSimStats;
+
+/** Open disk image, image is created or extended to given size
+ *
+ * @param      path     image file path
+ * @param      sectors  card capacity in 512 byte sectors, multiple of 1024
+ *
+ * @return     true on success
+ */
+bool sd_spi_sim_open(const char* path, uint32_t sectors);
+
+/** Flush and close disk image */
+void sd_spi_sim_close(void);
+
+/** Replace timing model, defaults are taken from a typical class 10 card */
+void sd_spi_sim_set_config(const SdSpiSimConfig* config);
+
+/** Get current timing model */
+const SdSpiSimConfig* sd_spi_sim_get_config(void);
+
+/** Get simulated time, us */
+uint64_t sd_spi_sim_get_time_us(void);
+
+/** Advance simulated time */
+void sd_spi_sim_advance_us(uint32_t microseconds);
+
+/** Get card statistics */
+const SdSpiSimStats* sd_spi_sim_get_stats(void);
+
+/** Reset card statistics */
+void sd_spi_sim_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,389 @@
+/**
+ * SD card driver and FatFs benchmark on top of SD SPI protocol simulator.
+ *
+ * Runs the real firmware SD card driver and FatFs against a disk image and
+ * reports sectors per second in simulated bus time: what the driver would get
+ * on the real SPI bus with the timing model from sd_spi_sim.c.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o sd_spi_sim_bench -Iscripts/sd_spi_sim/include -Iscripts/sd_spi_sim \
+ *      -Ifirmware/targets/f7/fatfs -Ilib -Ilib/fatfs \
+ *      scripts/sd_spi_sim/sd_spi_sim.c scripts/sd_spi_sim/sd_spi_sim_bench.c \
+ *      firmware/targets/f7/fatfs/stm32_adafruit_sd.c \
+ *      firmware/targets/f7/fatfs/sector_cache.c firmware/targets/f7/fatfs/user_diskio.c \
+ *      firmware/targets/f7/fatfs/fatfs.c firmware/targets/f7/fatfs/syscall.c \
+ *      lib/fatfs/ff.c lib/fatfs/ff_gen_drv.c lib/fatfs/diskio.c lib/fatfs/option/unicode.c
+ *  ./sd_spi_sim_bench /tmp/sd.img 64
+ */
+
+#include "sd_spi_sim.h"
+
+#include <string.h>
+#include <time.h>
+#include <furi.h>
+#include <furi_hal.h>
+#include <fatfs.h>
+#include <sector_cache.h>
+
+#define BENCH_TRANSFER_SECTORS 64
+#define BENCH_RANDOM_COUNT 2000
+#define BENCH_FILE_CHUNK (16 * 1024)
+#define BENCH_DIRS 8
+#define BENCH_DIR_FILES 64
+
+typedef uint8_t (
+    *BenchTransfer)(uint32_t* data, uint32_t address, uint32_t count, uint32_t timeout);
+
+static uint32_t bench_sectors;
+static uint32_t bench_random_state = 0x12345678;
+static uint8_t bench_buffer[BENCH_TRANSFER_SECTORS * SD_SPI_SIM_BLOCK_SIZE];
+
+static uint32_t bench_random(void) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 17;
+    bench_random_state ^= bench_random_state << 5;
+    return bench_random_state;
+}
+
+static double bench_wall_time_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_report(const char* name, uint64_t sectors, uint64_t start_us, double wall_s) {
+    uint64_t bus_us = sd_spi_sim_get_time_us() - start_us;
+    const SdSpiSimStats* stats = sd_spi_sim_get_stats();
+    printf(
+        "%-28s %8llu sectors %10.0f sectors/s (%7.1f KiB/s) wall %.2fs "
+        "CMD17 %u CMD18 %u CMD24 %u CMD25 %u CMD12 %u\n",
+        name,
+        (unsigned long long)sectors,
+        sectors * 1e6 / (double)bus_us,
+        sectors * 1e6 / (double)bus_us / 2.0,
+        bench_wall_time_s() - wall_s,
+        stats->cmd_count[17],
+        stats->cmd_count[18],
+        stats->cmd_count[24],
+        stats->cmd_count[25],
+        stats->cmd_count[12]);
+}
+
+static bool bench_driver_transfer(
+    BenchTransfer transfer,
+    uint32_t address,
+    uint32_t count,
+    bool single_block_commands) {
+    bool result = true;
+
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_sd_fast);
+    furi_hal_sd_spi_handle = &furi_hal_spi_bus_handle_sd_fast;
+
+    if(single_block_commands) {
+        for(uint32_t i = 0; i < count && result; i++) {
+            result = transfer(
+                         (uint32_t*)(bench_buffer + i * SD_SPI_SIM_BLOCK_SIZE),
+                         address + i,
+                         1,
+                         SD_DATATIMEOUT) == MSD_OK;
+        }
+    } else {
+        result = transfer((uint32_t*)bench_buffer, address, count, SD_DATATIMEOUT) == MSD_OK;
+    }
+
+    furi_hal_sd_spi_handle = NULL;
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_sd_fast);
+
+    return result;
+}
+
+static bool bench_driver_sequential(const char* name, BenchTransfer transfer, bool single) {
+    uint32_t total = MIN(bench_sectors, 16 * 1024);
+    sd_spi_sim_reset_stats();
+    uint64_t start_us = sd_spi_sim_get_time_us();
+    double wall_s = bench_wall_time_s();
+
+    for(uint32_t address = 0; address < total; address += BENCH_TRANSFER_SECTORS) {
+        for(size_t i = 0; i < sizeof(bench_buffer); i++) {
+            bench_buffer[i] = (uint8_t)(address + i);
+        }
+        if(!bench_driver_transfer(transfer, address, BENCH_TRANSFER_SECTORS, single)) {
+            printf("%s: transfer failed at %u\n", name, address);
+            return false;
+        }
+    }
+
+    bench_report(name, total, start_us, wall_s);
+    return true;
+}
+
+static bool bench_driver_random(const char* name, BenchTransfer transfer) {
+    sd_spi_sim_reset_stats();
+    uint64_t start_us = sd_spi_sim_get_time_us();
+    double wall_s = bench_wall_time_s();
+
+    for(uint32_t i = 0; i < BENCH_RANDOM_COUNT; i++) {
+        uint32_t address = bench_random() % bench_sectors;
+        if(!bench_driver_transfer(transfer, address, 1, false)) {
+            printf("%s: transfer failed at %u\n", name, address);
+            return false;
+        }
+    }
+
+    bench_report(name, BENCH_RANDOM_COUNT, start_us, wall_s);
+    return true;
+}
+
+static bool bench_driver_verify(void) {
+    static uint8_t expected[sizeof(bench_buffer)];
+    uint32_t address = 5 * BENCH_TRANSFER_SECTORS;
+
+    for(size_t i = 0; i < sizeof(expected); i++) {
+        expected[i] = (uint8_t)(bench_random() >> 11);
+    }
+    memcpy(bench_buffer, expected, sizeof(bench_buffer));
+
+    if(!bench_driver_transfer(BSP_SD_WriteBlocks, address, BENCH_TRANSFER_SECTORS, false)) {
+        return false;
+    }
+    memset(bench_buffer, 0, sizeof(bench_buffer));
+    if(!bench_driver_transfer(BSP_SD_ReadBlocks, address, BENCH_TRANSFER_SECTORS, false)) {
+        return false;
+    }
+    if(memcmp(bench_buffer, expected, sizeof(bench_buffer))) return false;
+
+    /* Single block path must agree with streamed data */
+    memset(bench_buffer, 0, sizeof(bench_buffer));
+    if(!bench_driver_transfer(BSP_SD_ReadBlocks, address + 3, 1, false)) return false;
+    return memcmp(bench_buffer, &expected[3 * SD_SPI_SIM_BLOCK_SIZE], SD_SPI_SIM_BLOCK_SIZE) == 0;
+}
+
+static bool bench_fatfs(void) {
+    static uint8_t work[_MAX_SS * 4];
+    static uint8_t chunk[BENCH_FILE_CHUNK];
+    uint32_t file_size = MIN(bench_sectors / 4, 8 * 1024) * SD_SPI_SIM_BLOCK_SIZE;
+    UINT done;
+
+    MX_FATFS_Init();
+    if(f_mkfs(USERPath, FM_ANY, 0, work, sizeof(work)) != FR_OK) {
+        printf("f_mkfs failed\n");
+        return false;
+    }
+    if(f_mount(&USERFatFS, USERPath, 1) != FR_OK) {
+        printf("f_mount failed\n");
+        return false;
+    }
+
+    sd_spi_sim_reset_stats();
+    uint64_t start_us = sd_spi_sim_get_time_us();
+    double wall_s = bench_wall_time_s();
+    if(f_open(&USERFile, "bench.bin", FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) return false;
+    for(uint32_t offset = 0; offset < file_size; offset += sizeof(chunk)) {
+        for(size_t i = 0; i < sizeof(chunk); i++) {
+            chunk[i] = (uint8_t)((offset + i) * 7);
+        }
+        if(f_write(&USERFile, chunk, sizeof(chunk), &done) != FR_OK || done != sizeof(chunk)) {
+            return false;
+        }
+    }
+    if(f_close(&USERFile) != FR_OK) return false;
+    bench_report("fatfs sequential write", file_size / _MAX_SS, start_us, wall_s);
+
+    sd_spi_sim_reset_stats();
+    start_us = sd_spi_sim_get_time_us();
+    wall_s = bench_wall_time_s();
+    if(f_open(&USERFile, "bench.bin", FA_READ) != FR_OK) return false;
+    for(uint32_t offset = 0; offset < file_size; offset += sizeof(chunk)) {
+        if(f_read(&USERFile, chunk, sizeof(chunk), &done) != FR_OK || done != sizeof(chunk)) {
+            return false;
+        }
+        for(size_t i = 0; i < sizeof(chunk); i++) {
+            if(chunk[i] != (uint8_t)((offset + i) * 7)) {
+                printf("fatfs: data mismatch at %zu\n", offset + i);
+                return false;
+            }
+        }
+    }
+    bench_report("fatfs sequential read", file_size / _MAX_SS, start_us, wall_s);
+
+    sd_spi_sim_reset_stats();
+    start_us = sd_spi_sim_get_time_us();
+    wall_s = bench_wall_time_s();
+    for(uint32_t i = 0; i < BENCH_RANDOM_COUNT; i++) {
+        uint32_t offset = (bench_random() % (file_size / _MAX_SS)) * _MAX_SS;
+        if(f_lseek(&USERFile, offset) != FR_OK) return false;
+        if(f_read(&USERFile, chunk, _MAX_SS, &done) != FR_OK || done != _MAX_SS) return false;
+        if(chunk[0] != (uint8_t)(offset * 7)) {
+            printf("fatfs: data mismatch at %u\n", offset);
+            return false;
+        }
+    }
+    bench_report("fatfs random read", BENCH_RANDOM_COUNT, start_us, wall_s);
+
+    f_close(&USERFile);
+    return true;
+}
+
+static SectorCacheStats bench_cache_start;
+
+static uint64_t bench_ops_start(void) {
+    sd_spi_sim_reset_stats();
+    sector_cache_get_stats(&bench_cache_start);
+    return sd_spi_sim_get_time_us();
+}
+
+static void bench_report_ops(const char* name, uint32_t ops, uint64_t start_us) {
+    uint64_t bus_us = sd_spi_sim_get_time_us() - start_us;
+    const SdSpiSimStats* stats = sd_spi_sim_get_stats();
+    SectorCacheStats cache;
+    sector_cache_get_stats(&cache);
+    cache.hits -= bench_cache_start.hits;
+    cache.misses -= bench_cache_start.misses;
+    cache.evictions -= bench_cache_start.evictions;
+    cache.write_backs -= bench_cache_start.write_backs;
+
+    printf(
+        "%-28s %8u ops %10.0f ops/s, card %llu/%llu sectors read/written, "
+        "cache %u/%u hits/misses %u evictions %u write-backs\n",
+        name,
+        (unsigned)ops,
+        ops * 1e6 / (double)bus_us,
+        (unsigned long long)stats->blocks_read,
+        (unsigned long long)stats->blocks_written,
+        (unsigned)cache.hits,
+        (unsigned)cache.misses,
+        (unsigned)cache.evictions,
+        (unsigned)cache.write_backs);
+}
+
+/* File manager like workload: lots of small files, directory scans and stats */
+static bool bench_fatfs_metadata(void) {
+    static uint8_t data[700];
+    char path[32];
+    UINT done;
+    FILINFO info;
+    DIR dir;
+
+    uint64_t start_us = bench_ops_start();
+    for(uint32_t d = 0; d < BENCH_DIRS; d++) {
+        snprintf(path, sizeof(path), "dir%u", (unsigned)d);
+        if(f_mkdir(path) != FR_OK) return false;
+        for(uint32_t f = 0; f < BENCH_DIR_FILES; f++) {
+            snprintf(path, sizeof(path), "dir%u/Flipper file %03u.txt", (unsigned)d, (unsigned)f);
+            if(f_open(&USERFile, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) return false;
+            if(f_write(&USERFile, data, sizeof(data), &done) != FR_OK) return false;
+            if(f_close(&USERFile) != FR_OK) return false;
+        }
+    }
+    bench_report_ops("fatfs create small files", BENCH_DIRS * BENCH_DIR_FILES, start_us);
+
+    start_us = bench_ops_start();
+    uint32_t ops = 0;
+    for(uint32_t d = 0; d < BENCH_DIRS; d++) {
+        /* Listing is refreshed after every opened file, like file browser does */
+        for(uint32_t f = 0; f < BENCH_DIR_FILES; f += 8) {
+            snprintf(path, sizeof(path), "dir%u", (unsigned)d);
+            if(f_opendir(&dir, path) != FR_OK) return false;
+            uint32_t found = 0;
+            while(f_readdir(&dir, &info) == FR_OK && info.fname[0]) {
+                found++;
+            }
+            f_closedir(&dir);
+            if(found != BENCH_DIR_FILES) return false;
+
+            snprintf(path, sizeof(path), "dir%u/Flipper file %03u.txt", (unsigned)d, (unsigned)f);
+            if(f_stat(path, &info) != FR_OK || info.fsize != sizeof(data)) return false;
+            if(f_open(&USERFile, path, FA_READ) != FR_OK) return false;
+            if(f_read(&USERFile, data, sizeof(data), &done) != FR_OK) return false;
+            if(f_close(&USERFile) != FR_OK) return false;
+            ops += found + 2;
+        }
+    }
+    bench_report_ops("fatfs browse and open", ops, start_us);
+
+    start_us = bench_ops_start();
+    for(uint32_t d = 0; d < BENCH_DIRS; d++) {
+        for(uint32_t f = 0; f < BENCH_DIR_FILES; f += 2) {
+            snprintf(path, sizeof(path), "dir%u/Flipper file %03u.txt", (unsigned)d, (unsigned)f);
+            if(f_unlink(path) != FR_OK) return false;
+        }
+    }
+    bench_report_ops("fatfs unlink", BENCH_DIRS * BENCH_DIR_FILES / 2, start_us);
+
+    f_mount(NULL, USERPath, 0);
+    return true;
+}
+
+/* Transfers running past the end of the card must fail and leave card usable */
+static bool bench_driver_errors(void) {
+    uint32_t address = bench_sectors - 2;
+
+    if(bench_driver_transfer(BSP_SD_WriteBlocks, address, BENCH_TRANSFER_SECTORS, false)) {
+        return false;
+    }
+    if(bench_driver_transfer(BSP_SD_ReadBlocks, address, BENCH_TRANSFER_SECTORS, false)) {
+        return false;
+    }
+    if(!bench_driver_verify()) return false;
+
+    /* Slow SDHC card may stay busy after Stop Tran up to 500 ms, driver must wait it out */
+    SdSpiSimConfig config = *sd_spi_sim_get_config();
+    SdSpiSimConfig slow_config = config;
+    slow_config.write_stop_busy_us = 400 * 1000;
+    sd_spi_sim_set_config(&slow_config);
+    bool result = bench_driver_transfer(BSP_SD_WriteBlocks, 0, BENCH_TRANSFER_SECTORS, false);
+    sd_spi_sim_set_config(&config);
+
+    return result && bench_driver_verify();
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        printf("Usage: %s <image> [size_mb]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t size_mb = argc > 2 ? strtoul(argv[2], NULL, 10) : 64;
+    bench_sectors = size_mb * 2048;
+    if(!sd_spi_sim_open(argv[1], bench_sectors)) return 1;
+
+    if(BSP_SD_Init(true) != MSD_OK) {
+        printf("BSP_SD_Init failed\n");
+        return 1;
+    }
+
+    SD_CardInfo info;
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_sd_fast);
+    furi_hal_sd_spi_handle = &furi_hal_spi_bus_handle_sd_fast;
+    uint8_t status = BSP_SD_GetCardInfo(&info);
+    furi_hal_sd_spi_handle = NULL;
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_sd_fast);
+    if(status != MSD_OK || info.LogBlockNbr != bench_sectors) {
+        printf("BSP_SD_GetCardInfo failed\n");
+        return 1;
+    }
+    printf(
+        "Card: %u sectors, bus %u Hz\n",
+        (unsigned)info.LogBlockNbr,
+        (unsigned)furi_hal_spi_bus_handle_sd_fast.frequency);
+
+    bool result = bench_driver_verify();
+    if(!result) printf("Driver data verification failed\n");
+    result = result && bench_driver_errors();
+    if(!result) printf("Driver error recovery failed\n");
+
+    result = result && bench_driver_sequential("write, single block", BSP_SD_WriteBlocks, true);
+    result = result && bench_driver_sequential("write, multi block", BSP_SD_WriteBlocks, false);
+    result = result && bench_driver_sequential("read, single block", BSP_SD_ReadBlocks, true);
+    result = result && bench_driver_sequential("read, multi block", BSP_SD_ReadBlocks, false);
+    result = result && bench_driver_random("random write", BSP_SD_WriteBlocks);
+    result = result && bench_driver_random("random read", BSP_SD_ReadBlocks);
+    result = result && bench_fatfs();
+    result = result && bench_fatfs_metadata();
+
+    sd_spi_sim_close();
+
+    printf("%s\n", result ? "OK" : "FAILED");
+    return result ? 0 : 1;
+}
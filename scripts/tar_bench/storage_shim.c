@@ -0,0 +1,76 @@
+#include <storage/storage.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct File {
+    FILE* fp;
+};
+
+StorageShimStats storage_shim_stats;
+
+File* storage_file_alloc(Storage* storage) {
+    (void)storage;
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    const char* mode = "rb";
+    if(access_mode == FSAM_READ_WRITE) {
+        mode = open_mode == FSOM_CREATE_ALWAYS ? "w+b" : "r+b";
+    } else if(access_mode == FSAM_WRITE) {
+        mode = "wb";
+    }
+
+    storage_shim_stats.opens++;
+    file->fp = fopen(path, mode);
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->fp) {
+        fclose(file->fp);
+        file->fp = NULL;
+    }
+    return true;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->fp != NULL;
+}
+
+uint16_t storage_file_read(File* file, void* buff, uint16_t bytes_to_read) {
+    size_t read_size = fread(buff, 1, bytes_to_read, file->fp);
+    storage_shim_stats.reads++;
+    storage_shim_stats.bytes_read += read_size;
+    return read_size;
+}
+
+uint16_t storage_file_write(File* file, const void* buff, uint16_t bytes_to_write) {
+    size_t write_size = fwrite(buff, 1, bytes_to_write, file->fp);
+    storage_shim_stats.writes++;
+    storage_shim_stats.bytes_written += write_size;
+    return write_size;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    storage_shim_stats.seeks++;
+    return fseek(file->fp, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    long position = ftell(file->fp);
+    fseek(file->fp, 0, SEEK_END);
+    long size = ftell(file->fp);
+    fseek(file->fp, position, SEEK_SET);
+    return size;
+}
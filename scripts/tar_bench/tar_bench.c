@@ -0,0 +1,344 @@
+/**
+ * Resources archive unpacking benchmark.
+ *
+ * Unpacks a tar archive the same way updater does (entry count pass, then
+ * extraction pass) with microtar on top of:
+ *  - storage file calls for every microtar request and 512 byte copy chunks,
+ *    as tar_archive did before tar_stream was added;
+ *  - tar_stream read-ahead window and 4 KiB copy chunks;
+ *  - tar_stream decoding heatshrink compressed copy of the same archive,
+ *    compressed here with update.py settings.
+ * Storage calls are counted by host shim, each one is a message to storage
+ * service and a FatFs call on device. Extracted data is checked to match.
+ *
+ * Build and run from the repository root, resources archive can be made with
+ * `tar --format=ustar -C assets/resources -cf /tmp/resources.tar .` or taken
+ * from update package built with --resources-compression=none:
+ *
+ *  gcc -O2 -o tar_bench -Iscripts/tar_bench/include -Ilib/toolbox/tar -Ilib/heatshrink \
+ *      -Ilib/microtar/src scripts/tar_bench/tar_bench.c scripts/tar_bench/storage_shim.c \
+ *      lib/toolbox/tar/tar_stream.c lib/heatshrink/heatshrink_decoder.c \
+ *      lib/heatshrink/heatshrink_encoder.c lib/microtar/src/microtar.c
+ *  ./tar_bench /tmp/resources.tar /tmp/tar_bench
+ */
+
+#include <furi.h>
+#include <storage/storage.h>
+#include <tar_stream.h>
+#include <microtar.h>
+#include <heatshrink_encoder.h>
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/* Same as RESOURCE_HEATSHRINK_* in scripts/update.py */
+#define BENCH_WINDOW_SZ2 13
+#define BENCH_LOOKAHEAD_SZ2 6
+
+#define BENCH_PATH_SIZE 512
+
+typedef enum {
+    BenchModeDirect,
+    BenchModeBuffered,
+    BenchModeHeatshrink,
+} BenchMode;
+
+typedef struct {
+    const char* dest;
+    uint8_t* buffer;
+    uint32_t chunk_size;
+    uint32_t files;
+    uint32_t crc;
+    uint64_t bytes;
+    bool failed;
+} BenchExtract;
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t bench_crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for(int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+/* tar_archive ops before tar_stream */
+static int bench_direct_read(void* stream, void* data, unsigned size) {
+    uint16_t bytes_read = storage_file_read(stream, data, size);
+    return (bytes_read == size) ? bytes_read : MTAR_EREADFAIL;
+}
+
+static int bench_direct_write(void* stream, const void* data, unsigned size) {
+    uint16_t bytes_written = storage_file_write(stream, data, size);
+    return (bytes_written == size) ? bytes_written : MTAR_EWRITEFAIL;
+}
+
+static int bench_direct_seek(void* stream, unsigned offset) {
+    return storage_file_seek(stream, offset, true) ? MTAR_ESUCCESS : MTAR_ESEEKFAIL;
+}
+
+static int bench_direct_close(void* stream) {
+    storage_file_free(stream);
+    return MTAR_ESUCCESS;
+}
+
+static const struct mtar_ops bench_direct_ops = {
+    .read = bench_direct_read,
+    .write = bench_direct_write,
+    .seek = bench_direct_seek,
+    .close = bench_direct_close,
+};
+
+/* tar_archive ops now */
+static int bench_stream_read(void* stream, void* data, unsigned size) {
+    int32_t bytes_read = tar_stream_read(stream, data, size);
+    return (bytes_read == (int32_t)size) ? bytes_read : MTAR_EREADFAIL;
+}
+
+static int bench_stream_write(void* stream, const void* data, unsigned size) {
+    int32_t bytes_written = tar_stream_write(stream, data, size);
+    return (bytes_written == (int32_t)size) ? bytes_written : MTAR_EWRITEFAIL;
+}
+
+static int bench_stream_seek(void* stream, unsigned offset) {
+    return tar_stream_seek(stream, offset) ? MTAR_ESUCCESS : MTAR_ESEEKFAIL;
+}
+
+static int bench_stream_close(void* stream) {
+    bool res = tar_stream_flush(stream);
+    tar_stream_free(stream);
+    return res ? MTAR_ESUCCESS : MTAR_EWRITEFAIL;
+}
+
+static const struct mtar_ops bench_stream_ops = {
+    .read = bench_stream_read,
+    .write = bench_stream_write,
+    .seek = bench_stream_seek,
+    .close = bench_stream_close,
+};
+
+static bool bench_compress(const char* source, const char* destination) {
+    FILE* in = fopen(source, "rb");
+    FILE* out = fopen(destination, "wb");
+    if(!in || !out) {
+        if(in) fclose(in);
+        if(out) fclose(out);
+        return false;
+    }
+
+    TarHeatshrinkHeader header = {
+        .magic = TAR_HEATSHRINK_MAGIC,
+        .version = TAR_HEATSHRINK_VERSION,
+        .window_sz2 = BENCH_WINDOW_SZ2,
+        .lookahead_sz2 = BENCH_LOOKAHEAD_SZ2,
+    };
+    fwrite(&header, sizeof(header), 1, out);
+
+    uint8_t* window = malloc(2 << BENCH_WINDOW_SZ2);
+    heatshrink_encoder* encoder =
+        heatshrink_encoder_alloc(window, BENCH_WINDOW_SZ2, BENCH_LOOKAHEAD_SZ2);
+    uint8_t input[4096];
+    uint8_t output[4096];
+    size_t size;
+    bool finishing = false;
+
+    while(true) {
+        size_t input_size = finishing ? 0 : fread(input, 1, sizeof(input), in);
+        size_t input_pos = 0;
+        if(!input_size && !finishing) {
+            finishing = true;
+        }
+
+        while(input_pos < input_size) {
+            heatshrink_encoder_sink(
+                encoder, input + input_pos, input_size - input_pos, &size);
+            input_pos += size;
+            HSE_poll_res res;
+            do {
+                res = heatshrink_encoder_poll(encoder, output, sizeof(output), &size);
+                fwrite(output, 1, size, out);
+            } while(res == HSER_POLL_MORE);
+        }
+
+        if(finishing) {
+            while(heatshrink_encoder_finish(encoder) == HSER_FINISH_MORE) {
+                heatshrink_encoder_poll(encoder, output, sizeof(output), &size);
+                fwrite(output, 1, size, out);
+            }
+            break;
+        }
+    }
+
+    heatshrink_encoder_free(encoder);
+    free(window);
+    fclose(in);
+    fclose(out);
+    return true;
+}
+
+static void bench_mkdir(const char* path) {
+    if(mkdir(path, 0755) && errno != EEXIST) {
+        fprintf(stderr, "mkdir %s: %d\n", path, errno);
+    }
+}
+
+static int bench_count_cb(mtar_t* tar, const mtar_header_t* header, void* param) {
+    UNUSED(tar);
+    UNUSED(header);
+    (*(uint32_t*)param)++;
+    return 0;
+}
+
+static int bench_extract_cb(mtar_t* tar, const mtar_header_t* header, void* param) {
+    BenchExtract* extract = param;
+    char path[BENCH_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", extract->dest, header->name);
+
+    if(header->type == MTAR_TDIR) {
+        bench_mkdir(path);
+        return 0;
+    } else if(header->type != MTAR_TREG) {
+        return 0;
+    }
+
+    File* file = storage_file_alloc(NULL);
+    if(!storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        storage_file_free(file);
+        extract->failed = true;
+        return -1;
+    }
+
+    while(!mtar_eof_data(tar)) {
+        int32_t readcnt = mtar_read_data(tar, extract->buffer, extract->chunk_size);
+        if(readcnt <= 0 || storage_file_write(file, extract->buffer, readcnt) != readcnt) {
+            extract->failed = true;
+            break;
+        }
+        extract->crc = bench_crc32(extract->crc, extract->buffer, readcnt);
+        extract->bytes += readcnt;
+    }
+
+    storage_file_free(file);
+    extract->files++;
+    return extract->failed ? -1 : 0;
+}
+
+static bool bench_run(
+    const char* name,
+    BenchMode mode,
+    const char* archive_path,
+    const char* out_root,
+    BenchExtract* extract) {
+    char dest[BENCH_PATH_SIZE];
+    snprintf(dest, sizeof(dest), "%s/%s", out_root, name);
+    bench_mkdir(dest);
+
+    memset(extract, 0, sizeof(BenchExtract));
+    extract->dest = dest;
+    extract->chunk_size = mode == BenchModeDirect ? 512 : 4096;
+    extract->buffer = malloc(extract->chunk_size);
+    memset(&storage_shim_stats, 0, sizeof(storage_shim_stats));
+
+    double start = bench_time();
+
+    File* file = storage_file_alloc(NULL);
+    if(!storage_file_open(file, archive_path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_free(file);
+        free(extract->buffer);
+        return false;
+    }
+    uint64_t archive_size = storage_file_size(file);
+
+    mtar_t tar;
+    if(mode == BenchModeDirect) {
+        mtar_init(&tar, MTAR_READ, &bench_direct_ops, file);
+    } else {
+        TarStream* stream = tar_stream_alloc(file, mode == BenchModeHeatshrink);
+        if(!stream) {
+            free(extract->buffer);
+            return false;
+        }
+        mtar_init(&tar, MTAR_READ, &bench_stream_ops, stream);
+    }
+
+    /* Reads and seeks are archive side, writes go to extracted files */
+    uint32_t entries = 0;
+    bool success = mtar_foreach(&tar, bench_count_cb, &entries) == MTAR_ESUCCESS;
+    StorageShimStats count_stats = storage_shim_stats;
+    success = success && mtar_foreach(&tar, bench_extract_cb, extract) == MTAR_ESUCCESS;
+    mtar_close(&tar);
+
+    double elapsed = bench_time() - start;
+    StorageShimStats* stats = &storage_shim_stats;
+
+    printf(
+        "%-11s %8lu %7u %6u %6u %7u %7u %7u %8.1f %s\n",
+        name,
+        (unsigned long)archive_size,
+        entries,
+        count_stats.reads,
+        count_stats.seeks,
+        stats->reads - count_stats.reads,
+        stats->seeks - count_stats.seeks,
+        stats->writes,
+        elapsed * 1000.0,
+        success && !extract->failed ? "OK" : "FAILED");
+
+    free(extract->buffer);
+    return success && !extract->failed;
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        printf("Usage: %s <resources.tar> <output dir>\n", argv[0]);
+        return 1;
+    }
+
+    char compressed[BENCH_PATH_SIZE];
+    bench_mkdir(argv[2]);
+    snprintf(compressed, sizeof(compressed), "%s/resources.ths", argv[2]);
+    if(!bench_compress(argv[1], compressed)) {
+        printf("Failed to compress %s\n", argv[1]);
+        return 1;
+    }
+
+    printf(
+        "%-11s %8s %7s %6s %6s %7s %7s %7s %8s\n",
+        "mode",
+        "size",
+        "entries",
+        "c.read",
+        "c.seek",
+        "u.read",
+        "u.seek",
+        "writes",
+        "host ms");
+
+    BenchExtract reference, extract;
+    int failed = 0;
+    if(!bench_run("direct", BenchModeDirect, argv[1], argv[2], &reference)) failed++;
+    if(!bench_run("buffered", BenchModeBuffered, argv[1], argv[2], &extract) ||
+       extract.crc != reference.crc || extract.bytes != reference.bytes) {
+        failed++;
+    }
+    if(!bench_run("heatshrink", BenchModeHeatshrink, compressed, argv[2], &extract) ||
+       extract.crc != reference.crc || extract.bytes != reference.bytes) {
+        failed++;
+    }
+
+    printf(
+        "%u files, %llu bytes extracted, crc %08X\n",
+        reference.files,
+        (unsigned long long)reference.bytes,
+        reference.crc);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,362 @@
+/**
+ * Host known-answer tests and benchmark for U2F crypto: lib/toolbox sha256.c,
+ * hmac_sha256.c and secp256r1 in lib/micro-ecc.
+ *
+ * Checks FIPS 180-2 SHA-256 and RFC 4231 HMAC-SHA256 vectors, for HMAC also
+ * with precomputed key, and RFC 6979 P-256 key and signature. k * G is checked
+ * against values made with Python for edge scalars and against Montgomery
+ * ladder (uECC_shared_secret with G) for random ones. Then reports latency of HMAC with and without precomputed
+ * key and of P-256 public key, sign and verify.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -o u2f_bench -Ilib/toolbox -Ilib/micro-ecc scripts/u2f_bench/u2f_bench.c \
+ *      lib/toolbox/sha256.c lib/toolbox/hmac_sha256.c lib/micro-ecc/uECC.c
+ *  ./u2f_bench
+ *
+ * Add -DuECC_SECP256R1_COMB=0 for ladder baseline, -DuECC_WORD_SIZE=4 for
+ * 32-bit arithmetic as on device. Comb table is made by p256_comb.py.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sha256.h"
+#include "hmac_sha256.h"
+#include "uECC.h"
+#include "types.h"
+
+#define BENCH_RANDOM_SCALARS 1000
+#define BENCH_ROUNDS 200
+#define BENCH_HMAC_ROUNDS 100000
+
+/* Defined in uECC.c for testing, not exported by uECC.h */
+int uECC_sign_with_k(
+    const uint8_t* private_key,
+    const uint8_t* message_hash,
+    unsigned hash_size,
+    const uint8_t* k,
+    uint8_t* signature,
+    uECC_Curve curve);
+
+static const struct {
+    const char* input;
+    size_t repeat;
+    const char* digest;
+} sha256_test_suite[] = {
+    {"", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+    {"abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+    {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+     1,
+     "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+    {"a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+};
+
+/* RFC 4231 cases 1-4, keys are shorter than 32 bytes and zero padded as HMAC does */
+static const struct {
+    const char* key;
+    const char* data;
+    const char* mac;
+} hmac_test_suite[] = {
+    {"0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b",
+     "4869205468657265",
+     "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+    {"4a656665",
+     "7768617420646f2079612077616e7420666f72206e6f7468696e673f",
+     "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+    {"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+     "dddddddddddddddddddddddddddddddddddddddddddddddddd"
+     "dddddddddddddddddddddddddddddddddddddddddddddddddd",
+     "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe"},
+    {"0102030405060708090a0b0c0d0e0f10111213141516171819",
+     "cdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcd"
+     "cdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcd",
+     "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b"},
+};
+
+/* RFC 6979 A.2.5, P-256 with SHA-256, message "sample" */
+static const char* const p256_private =
+    "c9afa9d845ba75166b5c215767b1d6934e50c3db36e89b127b8a622b120f6721";
+static const char* const p256_public =
+    "60fed4ba255a9d31c961eb74c6356d68c049b8923b61fa6ce669622e60f29fb6"
+    "7903fe1008b8bc99a41ae9e95628bc64f2f1b20c2d7e9f5177a3c294d4462299";
+static const char* const p256_k =
+    "a6e3c57dd01abe90086538398355dd4c3b17aa873382b0f24d6129493d8aad60";
+static const char* const p256_signature =
+    "efd48b2aacb6a8fd1140dd9cd45e81d69d2c877b56aaf991c34d0ea84eaf3716"
+    "f7cb1c942d657c41d436c7a1b6e29f65f3e900dbb9aff4064dc4ab2f843acda8";
+
+/* Generator */
+static const char* const p256_g =
+    "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"
+    "4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5";
+
+/* k * G for edge scalars 1, 2, 3, n - 3, n - 2, n - 1, 2^255 and 0x55..55, made with Python */
+static const struct {
+    const char* k;
+    const char* public_key;
+} p256_edge_suite[] = {
+    {"0000000000000000000000000000000000000000000000000000000000000001",
+     "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"
+     "4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5"},
+    {"0000000000000000000000000000000000000000000000000000000000000002",
+     "7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978"
+     "07775510db8ed040293d9ac69f7430dbba7dade63ce982299e04b79d227873d1"},
+    {"0000000000000000000000000000000000000000000000000000000000000003",
+     "5ecbe4d1a6330a44c8f7ef951d4bf165e6c6b721efada985fb41661bc6e7fd6c"
+     "8734640c4998ff7e374b06ce1a64a2ecd82ab036384fb83d9a79b127a27d5032"},
+    {"ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc63254e",
+     "5ecbe4d1a6330a44c8f7ef951d4bf165e6c6b721efada985fb41661bc6e7fd6c"
+     "78cb9bf2b6670082c8b4f931e59b5d1327d54fcac7b047c265864ed85d82afcd"},
+    {"ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc63254f",
+     "7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978"
+     "f888aaee24712fc0d6c26539608bcf244582521ac3167dd661fb4862dd878c2e"},
+    {"ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632550",
+     "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"
+     "b01cbd1c01e58065711814b583f061e9d431cca994cea1313449bf97c840ae0a"},
+    {"8000000000000000000000000000000000000000000000000000000000000000",
+     "77b20a912e6b23135066e911891524bc4efe3560e3e92350b52dec8f375f2b54"
+     "a3dc291825cea3f7f7b10bfcdd038a72df623da1e850e0f1caa801fcd6cc67ff"},
+    {"5555555555555555555555555555555555555555555555555555555555555555",
+     "57e977f6db7e33c3fe7acf2842ed987009caf56d458682fca447b7d3d762ab34"
+     "c5ab3770ba573bdff5414065640ffb5b346dfa84dec4db4d68e5f59cc471c2ec"},
+};
+
+static size_t hex_to_bytes(const char* hex, uint8_t* bytes) {
+    size_t size = strlen(hex) / 2;
+    for(size_t i = 0; i < size; i++) {
+        unsigned value;
+        sscanf(hex + i * 2, "%2x", &value);
+        bytes[i] = value;
+    }
+    return size;
+}
+
+static void bytes_to_hex(const uint8_t* bytes, size_t size, char* hex) {
+    for(size_t i = 0; i < size; i++) {
+        snprintf(&hex[i * 2], 3, "%02x", bytes[i]);
+    }
+}
+
+static bool check_hex(const char* name, const uint8_t* bytes, size_t size, const char* expected) {
+    char hex[256];
+    bytes_to_hex(bytes, size, hex);
+    if(strcmp(hex, expected) != 0) {
+        printf("FAIL %s = %s\n", name, hex);
+        return false;
+    }
+    return true;
+}
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int bench_rng(uint8_t* dest, unsigned size) {
+    for(unsigned i = 0; i < size; i++) {
+        dest[i] = rand();
+    }
+    return 1;
+}
+
+static int check_sha256(void) {
+    int failed = 0;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256_context ctx;
+
+    for(size_t i = 0; i < sizeof(sha256_test_suite) / sizeof(sha256_test_suite[0]); i++) {
+        const char* input = sha256_test_suite[i].input;
+        sha256_start(&ctx);
+        for(size_t r = 0; r < sha256_test_suite[i].repeat; r++) {
+            sha256_update(&ctx, (const uint8_t*)input, strlen(input));
+        }
+        sha256_finish(&ctx, digest);
+        failed += !check_hex("sha256", digest, sizeof(digest), sha256_test_suite[i].digest);
+    }
+
+    return failed;
+}
+
+static int check_hmac(void) {
+    int failed = 0;
+    uint8_t key[SHA256_DIGEST_SIZE];
+    uint8_t data[128];
+    uint8_t mac[SHA256_DIGEST_SIZE];
+    hmac_sha256_context ctx;
+    hmac_sha256_key precomputed;
+
+    for(size_t i = 0; i < sizeof(hmac_test_suite) / sizeof(hmac_test_suite[0]); i++) {
+        memset(key, 0, sizeof(key));
+        hex_to_bytes(hmac_test_suite[i].key, key);
+        size_t data_size = hex_to_bytes(hmac_test_suite[i].data, data);
+
+        hmac_sha256_init(&ctx, key);
+        hmac_sha256_update(&ctx, data, data_size);
+        hmac_sha256_finish(&ctx, key, mac);
+        failed += !check_hex("hmac", mac, sizeof(mac), hmac_test_suite[i].mac);
+
+        hmac_sha256_key_init(&precomputed, key);
+        for(int round = 0; round < 2; round++) {
+            hmac_sha256_key_start(&ctx, &precomputed);
+            hmac_sha256_update(&ctx, data, 1);
+            hmac_sha256_update(&ctx, data + 1, data_size - 1);
+            hmac_sha256_key_finish(&ctx, &precomputed, mac);
+            failed += !check_hex("hmac key", mac, sizeof(mac), hmac_test_suite[i].mac);
+        }
+    }
+
+    return failed;
+}
+
+static int check_p256(void) {
+    int failed = 0;
+    uECC_Curve curve = uECC_secp256r1();
+    uint8_t private_key[32];
+    uint8_t public_key[64];
+    uint8_t k[32];
+    uint8_t hash[SHA256_DIGEST_SIZE];
+    uint8_t signature[64];
+
+    hex_to_bytes(p256_private, private_key);
+    hex_to_bytes(p256_k, k);
+    sha256((const uint8_t*)"sample", 6, hash);
+
+    failed += !uECC_compute_public_key(private_key, public_key, curve);
+    failed += !check_hex("public key", public_key, sizeof(public_key), p256_public);
+    failed += !uECC_sign_with_k(private_key, hash, sizeof(hash), k, signature, curve);
+    failed += !check_hex("signature", signature, sizeof(signature), p256_signature);
+    failed += !uECC_verify(public_key, hash, sizeof(hash), signature, curve);
+
+    for(size_t i = 0; i < sizeof(p256_edge_suite) / sizeof(p256_edge_suite[0]); i++) {
+        hex_to_bytes(p256_edge_suite[i].k, private_key);
+        if(!uECC_compute_public_key(private_key, public_key, curve)) {
+            // Montgomery ladder gives up on 1, n - 2 and n - 1, comb must handle all of them
+            printf("%s edge scalar %zu\n", uECC_SECP256R1_COMB ? "FAIL" : "SKIP", i);
+            failed += uECC_SECP256R1_COMB;
+            continue;
+        }
+        failed += !check_hex(
+            "edge public key", public_key, sizeof(public_key), p256_edge_suite[i].public_key);
+    }
+
+    /* Random scalars against ladder, x of k * G is shared secret of k and G */
+    uint8_t g[64];
+    uint8_t x[32];
+    hex_to_bytes(p256_g, g);
+
+    for(int i = 0; i < BENCH_RANDOM_SCALARS; i++) {
+        uECC_make_key(public_key, private_key, curve);
+        if(!uECC_valid_public_key(public_key, curve) ||
+           !uECC_shared_secret(g, private_key, x, curve) || memcmp(x, public_key, 32) != 0) {
+            printf("FAIL k * G mismatch for random scalar %d\n", i);
+            failed++;
+            continue;
+        }
+
+        bench_rng(hash, sizeof(hash));
+        if(!uECC_sign(private_key, hash, sizeof(hash), signature, curve) ||
+           !uECC_verify(public_key, hash, sizeof(hash), signature, curve)) {
+            printf("FAIL sign and verify for random scalar %d\n", i);
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+static void bench_p256(void) {
+    uECC_Curve curve = uECC_secp256r1();
+    uint8_t private_keys[BENCH_ROUNDS][32];
+    uint8_t public_key[64];
+    uint8_t hash[SHA256_DIGEST_SIZE];
+    uint8_t signature[64];
+
+    for(int i = 0; i < BENCH_ROUNDS; i++) {
+        uECC_make_key(public_key, private_keys[i], curve);
+    }
+    bench_rng(hash, sizeof(hash));
+
+    double start = bench_time();
+    for(int i = 0; i < BENCH_ROUNDS; i++) {
+        uECC_compute_public_key(private_keys[i], public_key, curve);
+    }
+    double public_time = bench_time() - start;
+
+    start = bench_time();
+    for(int i = 0; i < BENCH_ROUNDS; i++) {
+        uECC_sign(private_keys[i], hash, sizeof(hash), signature, curve);
+    }
+    double sign_time = bench_time() - start;
+
+    uECC_compute_public_key(private_keys[0], public_key, curve);
+    uECC_sign(private_keys[0], hash, sizeof(hash), signature, curve);
+    start = bench_time();
+    for(int i = 0; i < BENCH_ROUNDS; i++) {
+        uECC_verify(public_key, hash, sizeof(hash), signature, curve);
+    }
+    double verify_time = bench_time() - start;
+
+    printf(
+        "p256 (%s, %d-bit words): public key %7.1f us, sign %7.1f us, verify %7.1f us\n",
+        uECC_SECP256R1_COMB ? "comb" : "ladder",
+        uECC_WORD_SIZE * 8,
+        public_time * 1e6 / BENCH_ROUNDS,
+        sign_time * 1e6 / BENCH_ROUNDS,
+        verify_time * 1e6 / BENCH_ROUNDS);
+}
+
+static void bench_hmac(void) {
+    uint8_t key[SHA256_DIGEST_SIZE] = {0};
+    uint8_t data[64] = {0};
+    uint8_t mac[SHA256_DIGEST_SIZE];
+    hmac_sha256_context ctx;
+    hmac_sha256_key precomputed;
+
+    /* Same as U2F key derivation: HMAC of app id and nonce */
+    double start = bench_time();
+    for(int i = 0; i < BENCH_HMAC_ROUNDS; i++) {
+        hmac_sha256_init(&ctx, key);
+        hmac_sha256_update(&ctx, data, sizeof(data));
+        hmac_sha256_finish(&ctx, key, mac);
+        data[0] = mac[0];
+    }
+    double plain_time = bench_time() - start;
+
+    hmac_sha256_key_init(&precomputed, key);
+    start = bench_time();
+    for(int i = 0; i < BENCH_HMAC_ROUNDS; i++) {
+        hmac_sha256_key_start(&ctx, &precomputed);
+        hmac_sha256_update(&ctx, data, sizeof(data));
+        hmac_sha256_key_finish(&ctx, &precomputed, mac);
+        data[0] = mac[0];
+    }
+    double precomputed_time = bench_time() - start;
+
+    printf(
+        "hmac 64 bytes: %5.2f us, with precomputed key %5.2f us\n",
+        plain_time * 1e6 / BENCH_HMAC_ROUNDS,
+        precomputed_time * 1e6 / BENCH_HMAC_ROUNDS);
+}
+
+int main(void) {
+    int failed = 0;
+
+    srand(1);
+    uECC_set_rng(bench_rng);
+
+    failed += check_sha256();
+    failed += check_hmac();
+    failed += check_p256();
+
+    bench_hmac();
+    bench_p256();
+
+    printf(failed ? "%d check(s) failed\n" : "All checks passed\n", failed);
+    return failed ? 1 : 0;
+}
@@ -4,12 +4,14 @@ from flipper.app import App
 from flipper.utils.fff import FlipperFormatFile
 from flipper.assets.coprobin import CoproBinary, get_stack_type
 from flipper.assets.obdata import OptionBytesData, ObReferenceValues
+from flipper.assets.heatshrink_stream import compress_stream
 from os.path import basename, join, exists
 import os
 import shutil
 import zlib
 import tarfile
 import math
+import io
 
 from slideshow import Main as SlideshowMain
 
@@ -18,10 +20,13 @@ class Main(App):
     UPDATE_MANIFEST_VERSION = 2
     UPDATE_MANIFEST_NAME = "update.fuf"
 
-    #  No compression, plain tar
+    #  Plain tar, optionally heatshrink compressed as a whole
     RESOURCE_TAR_MODE = "w:"
     RESOURCE_TAR_FORMAT = tarfile.USTAR_FORMAT
     RESOURCE_FILE_NAME = "resources.tar"
+    RESOURCE_COMPRESSED_FILE_NAME = "resources.ths"
+    RESOURCE_HEATSHRINK_WINDOW_SZ2 = 13
+    RESOURCE_HEATSHRINK_LOOKAHEAD_SZ2 = 6
     RESOURCE_ENTRY_NAME_MAX_LENGTH = 100
 
     WHITELISTED_STACK_TYPES = set(
@@ -52,6 +57,13 @@ class Main(App):
             "--dfu", dest="dfu", default="", required=False
         )
         self.parser_generate.add_argument("-r", dest="resources", required=False)
+        self.parser_generate.add_argument(
+            "--resources-compression",
+            dest="resources_compression",
+            choices=("heatshrink", "none"),
+            default="heatshrink",
+            required=False,
+        )
         self.parser_generate.add_argument("--stage", dest="stage", required=True)
         self.parser_generate.add_argument(
             "--radio", dest="radiobin", default="", required=False
@@ -124,9 +136,16 @@ class Main(App):
                 self.args.radiobin, join(self.args.directory, radiobin_basename)
             )
         if self.args.resources:
-            resources_basename = self.RESOURCE_FILE_NAME
+            compress = self.args.resources_compression == "heatshrink"
+            resources_basename = (
+                self.RESOURCE_COMPRESSED_FILE_NAME
+                if compress
+                else self.RESOURCE_FILE_NAME
+            )
             if not self.package_resources(
-                self.args.resources, join(self.args.directory, resources_basename)
+                self.args.resources,
+                join(self.args.directory, resources_basename),
+                compress,
             ):
                 return 3
 
@@ -213,16 +232,34 @@ class Main(App):
             raise ValueError("Resource name too long")
         return tarinfo
 
-    def package_resources(self, srcdir: str, dst_name: str):
+    def package_resources(self, srcdir: str, dst_name: str, compress: bool = False):
         try:
-            with tarfile.open(
-                dst_name, self.RESOURCE_TAR_MODE, format=self.RESOURCE_TAR_FORMAT
-            ) as tarball:
-                tarball.add(
-                    srcdir,
-                    arcname="",
-                    filter=self._tar_filter,
+            with io.BytesIO() as tar_data:
+                with tarfile.open(
+                    fileobj=tar_data,
+                    mode=self.RESOURCE_TAR_MODE,
+                    format=self.RESOURCE_TAR_FORMAT,
+                ) as tarball:
+                    tarball.add(
+                        srcdir,
+                        arcname="",
+                        filter=self._tar_filter,
+                    )
+                data = tar_data.getvalue()
+
+            if compress:
+                plain_size = len(data)
+                data = compress_stream(
+                    data,
+                    self.RESOURCE_HEATSHRINK_WINDOW_SZ2,
+                    self.RESOURCE_HEATSHRINK_LOOKAHEAD_SZ2,
                 )
+                self.logger.info(
+                    f"Resources compressed: {plain_size} -> {len(data)} bytes"
+                )
+
+            with open(dst_name, "wb") as f:
+                f.write(data)
             return True
         except ValueError as e:
             self.logger.error(f"Cannot package resources: {e}")
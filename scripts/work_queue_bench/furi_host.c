@@ -0,0 +1,254 @@
+/* Host implementation of furi core primitives used by furi/core/work_queue.c */
+
+#include <stddef.h>
+#include <core/check.h>
+#include <core/kernel.h>
+#include <core/mutex.h>
+#include <core/semaphore.h>
+#include <core/thread.h>
+#include <core/timer.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct FuriThread {
+    pthread_t pthread;
+    FuriThreadCallback callback;
+    void* context;
+    size_t stack_size;
+    bool started;
+};
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max_count;
+} HostSemaphore;
+
+/* One pthread per timer, sleeping until deadline or change */
+typedef struct {
+    pthread_t pthread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    FuriTimerCallback callback;
+    void* context;
+    struct timespec deadline;
+    bool active;
+    bool exit;
+} HostTimer;
+
+static __thread FuriThread* host_current_thread;
+
+void __furi_crash() {
+    fprintf(stderr, "furi_crash\n");
+    abort();
+}
+
+void __furi_halt() {
+    fprintf(stderr, "furi_halt\n");
+    abort();
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    (void)type;
+    pthread_mutex_t* mutex = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(mutex, NULL);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    pthread_mutex_destroy(instance);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    (void)timeout;
+    return pthread_mutex_lock(instance) ? FuriStatusError : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    return pthread_mutex_unlock(instance) ? FuriStatusError : FuriStatusOk;
+}
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count) {
+    HostSemaphore* semaphore = malloc(sizeof(HostSemaphore));
+    pthread_mutex_init(&semaphore->mutex, NULL);
+    pthread_cond_init(&semaphore->cond, NULL);
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    return semaphore;
+}
+
+void furi_semaphore_free(FuriSemaphore* instance) {
+    HostSemaphore* semaphore = instance;
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->mutex);
+    free(semaphore);
+}
+
+/* Only FuriWaitForever, as used by work_queue.c */
+FuriStatus furi_semaphore_acquire(FuriSemaphore* instance, uint32_t timeout) {
+    (void)timeout;
+    HostSemaphore* semaphore = instance;
+    pthread_mutex_lock(&semaphore->mutex);
+    while(!semaphore->count) {
+        pthread_cond_wait(&semaphore->cond, &semaphore->mutex);
+    }
+    semaphore->count--;
+    pthread_mutex_unlock(&semaphore->mutex);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_semaphore_release(FuriSemaphore* instance) {
+    HostSemaphore* semaphore = instance;
+    FuriStatus status = FuriStatusErrorResource;
+    pthread_mutex_lock(&semaphore->mutex);
+    if(semaphore->count < semaphore->max_count) {
+        semaphore->count++;
+        pthread_cond_signal(&semaphore->cond);
+        status = FuriStatusOk;
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+    return status;
+}
+
+FuriThread* furi_thread_alloc() {
+    return calloc(1, sizeof(FuriThread));
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    (void)name;
+    FuriThread* thread = furi_thread_alloc();
+    thread->stack_size = stack_size;
+    thread->callback = callback;
+    thread->context = context;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    free(thread);
+}
+
+void furi_thread_mark_as_service(FuriThread* thread) {
+    (void)thread;
+}
+
+static void* furi_thread_body(void* context) {
+    FuriThread* thread = context;
+    host_current_thread = thread;
+    thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    thread->started = true;
+    pthread_create(&thread->pthread, NULL, furi_thread_body, thread);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    if(thread->started) {
+        pthread_join(thread->pthread, NULL);
+        thread->started = false;
+    }
+    return true;
+}
+
+/* Threads not started by furi get stable id from thread local address */
+FuriThreadId furi_thread_get_current_id() {
+    return host_current_thread ? (FuriThreadId)host_current_thread :
+                                 (FuriThreadId)&host_current_thread;
+}
+
+static void host_timer_deadline(struct timespec* deadline, uint32_t ticks) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += ticks / 1000;
+    deadline->tv_nsec += (ticks % 1000) * 1000000L;
+    if(deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+static void* host_timer_body(void* context) {
+    HostTimer* timer = context;
+    pthread_mutex_lock(&timer->mutex);
+    while(!timer->exit) {
+        if(!timer->active) {
+            pthread_cond_wait(&timer->cond, &timer->mutex);
+        } else if(
+            pthread_cond_timedwait(&timer->cond, &timer->mutex, &timer->deadline) != 0 &&
+            timer->active) {
+            timer->active = false;
+            pthread_mutex_unlock(&timer->mutex);
+            timer->callback(timer->context);
+            pthread_mutex_lock(&timer->mutex);
+        }
+    }
+    pthread_mutex_unlock(&timer->mutex);
+    return NULL;
+}
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback func, FuriTimerType type, void* context) {
+    (void)type;
+    HostTimer* timer = calloc(1, sizeof(HostTimer));
+    pthread_mutex_init(&timer->mutex, NULL);
+    pthread_cond_init(&timer->cond, NULL);
+    timer->callback = func;
+    timer->context = context;
+    pthread_create(&timer->pthread, NULL, host_timer_body, timer);
+    return timer;
+}
+
+/* Like firmware: returns after callback in progress, if any, is done */
+void furi_timer_free(FuriTimer* instance) {
+    HostTimer* timer = instance;
+    pthread_mutex_lock(&timer->mutex);
+    timer->exit = true;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->mutex);
+    pthread_join(timer->pthread, NULL);
+    pthread_cond_destroy(&timer->cond);
+    pthread_mutex_destroy(&timer->mutex);
+    free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* instance, uint32_t ticks) {
+    HostTimer* timer = instance;
+    pthread_mutex_lock(&timer->mutex);
+    host_timer_deadline(&timer->deadline, ticks);
+    timer->active = true;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->mutex);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* instance) {
+    HostTimer* timer = instance;
+    pthread_mutex_lock(&timer->mutex);
+    timer->active = false;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->mutex);
+    return FuriStatusOk;
+}
+
+uint32_t furi_timer_is_running(FuriTimer* instance) {
+    HostTimer* timer = instance;
+    pthread_mutex_lock(&timer->mutex);
+    uint32_t active = timer->active;
+    pthread_mutex_unlock(&timer->mutex);
+    return active;
+}
+
+/* 1 kHz tick, same as firmware */
+void furi_delay_tick(uint32_t ticks) {
+    struct timespec ts = {.tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
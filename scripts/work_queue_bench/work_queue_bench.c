@@ -0,0 +1,339 @@
+/**
+ * FuriWorkQueue checks and wakeup latency benchmark on host threads.
+ *
+ * check: priority order, delayed work and its cancel, then several threads
+ * submit, delay and cancel their works on 3 workers while callbacks submit
+ * themselves again. Work must never run on two workers at once and must not
+ * be running once cancel has returned.
+ *
+ * bench: latency from submit to callback start and back, for work on a
+ * shared queue and for dedicated thread woken with semaphore as workers like
+ * BrowserWorker do with thread flags. Stack budget on device is printed for
+ * comparison: every dedicated worker reserves its stack while it exists.
+ *
+ * Build and run from the repository root:
+ *
+ *  gcc -O2 -pthread -o work_queue_bench -Iscripts/work_queue_bench/include -Ifuri \
+ *      scripts/work_queue_bench/work_queue_bench.c scripts/work_queue_bench/furi_host.c \
+ *      furi/core/work_queue.c
+ *  ./work_queue_bench check 5
+ *  ./work_queue_bench bench
+ *
+ * Add -fsanitize=thread to check work_queue.c for data races.
+ */
+
+#include <stddef.h>
+#include <core/work_queue.h>
+#include <core/semaphore.h>
+#include <core/thread.h>
+#include <core/kernel.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK_WORKERS 3
+#define CHECK_SUBMITTERS 4
+#define CHECK_WORKS_PER_SUBMITTER 8
+
+#define BENCH_ROUNDS 20000
+#define BENCH_STACK_SIZE 2048
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned check_failures;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if(!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while(0)
+
+/* Priority and delay */
+
+typedef struct {
+    FuriSemaphore* gate;
+    char order[8];
+    atomic_uint order_pos;
+} CheckOrder;
+
+static CheckOrder check_order;
+
+static void check_gate_cb(void* context) {
+    (void)context;
+    furi_semaphore_acquire(check_order.gate, FuriWaitForever);
+}
+
+static void check_order_cb(void* context) {
+    check_order.order[atomic_fetch_add(&check_order.order_pos, 1)] = *(const char*)context;
+}
+
+static void check_priority(void) {
+    static const char tags[] = "lnhH";
+    static const FuriWorkPriority priorities[] = {
+        FuriWorkPriorityLow,
+        FuriWorkPriorityNormal,
+        FuriWorkPriorityHigh,
+        FuriWorkPriorityHigh,
+    };
+
+    FuriWorkQueue* queue = furi_work_queue_alloc("Check", 1, BENCH_STACK_SIZE);
+    check_order.gate = furi_semaphore_alloc(1, 0);
+
+    // Single worker is held by gate until everything is queued
+    FuriWork* gate = furi_work_alloc(queue, check_gate_cb, NULL);
+    furi_work_submit(gate);
+    furi_delay_tick(10);
+
+    FuriWork* works[4];
+    for(size_t i = 0; i < 4; i++) {
+        works[i] = furi_work_alloc(queue, check_order_cb, (void*)&tags[i]);
+        furi_work_set_priority(works[i], priorities[i]);
+        CHECK(furi_work_submit(works[i]));
+    }
+    CHECK(!furi_work_submit(works[0]));
+    CHECK(furi_work_is_pending(works[0]));
+
+    furi_semaphore_release(check_order.gate);
+    while(atomic_load(&check_order.order_pos) < 4) furi_delay_tick(1);
+    for(size_t i = 0; i < 4; i++) {
+        furi_work_free(works[i]);
+    }
+    furi_work_free(gate);
+    CHECK(memcmp(check_order.order, "hHnl", 4) == 0);
+
+    // Delayed work runs after delay, cancelled one never runs
+    atomic_store(&check_order.order_pos, 0);
+    memset(check_order.order, 0, sizeof(check_order.order));
+    FuriWork* delayed = furi_work_alloc(queue, check_order_cb, (void*)&tags[0]);
+    FuriWork* cancelled = furi_work_alloc(queue, check_order_cb, (void*)&tags[1]);
+
+    uint64_t start = bench_now_ns();
+    CHECK(furi_work_submit_delayed(delayed, 50));
+    CHECK(furi_work_submit_delayed(cancelled, 20));
+    CHECK(!furi_work_submit_delayed(delayed, 10));
+    CHECK(furi_work_cancel(cancelled));
+    while(furi_work_is_pending(delayed)) furi_delay_tick(1);
+    uint64_t elapsed_ms = (bench_now_ns() - start) / 1000000;
+    furi_delay_tick(40);
+    furi_work_free(delayed);
+    furi_work_free(cancelled);
+
+    CHECK(elapsed_ms >= 50 && elapsed_ms < 100);
+    CHECK(strcmp(check_order.order, "l") == 0);
+
+    furi_semaphore_free(check_order.gate);
+    furi_work_queue_free(queue);
+}
+
+/* Concurrent submit and cancel */
+
+typedef struct {
+    FuriWork* work;
+    atomic_uint active;
+    atomic_uint runs;
+    atomic_uint resubmits;
+} CheckWork;
+
+static atomic_ulong check_overlaps;
+static atomic_ulong check_late;
+static atomic_bool check_stop;
+
+static void check_work_cb(void* context) {
+    CheckWork* check_work = context;
+    if(atomic_fetch_add(&check_work->active, 1)) {
+        atomic_fetch_add(&check_overlaps, 1);
+    }
+    atomic_fetch_add(&check_work->runs, 1);
+    if(rand() % 4 == 0) {
+        atomic_fetch_add(&check_work->resubmits, 1);
+        furi_work_submit(check_work->work);
+    }
+    for(volatile int i = rand() % 2000; i > 0; i--) {
+    }
+    atomic_fetch_sub(&check_work->active, 1);
+}
+
+static void* check_submitter(void* arg) {
+    CheckWork* works = arg;
+    unsigned seed = (unsigned)(uintptr_t)arg;
+    while(!atomic_load(&check_stop)) {
+        CheckWork* check_work = &works[rand_r(&seed) % CHECK_WORKS_PER_SUBMITTER];
+        switch(rand_r(&seed) % 4) {
+        case 0:
+        case 1:
+            furi_work_submit(check_work->work);
+            break;
+        case 2:
+            furi_work_submit_delayed(check_work->work, 1 + rand_r(&seed) % 3);
+            break;
+        default:
+            furi_work_cancel(check_work->work);
+            if(atomic_load(&check_work->active)) {
+                atomic_fetch_add(&check_late, 1);
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void check_concurrent(unsigned seconds) {
+    static CheckWork works[CHECK_SUBMITTERS][CHECK_WORKS_PER_SUBMITTER];
+    pthread_t submitters[CHECK_SUBMITTERS];
+    FuriWorkQueue* queue = furi_work_queue_alloc("Check", CHECK_WORKERS, BENCH_STACK_SIZE);
+
+    for(size_t i = 0; i < CHECK_SUBMITTERS; i++) {
+        for(size_t j = 0; j < CHECK_WORKS_PER_SUBMITTER; j++) {
+            works[i][j].work = furi_work_alloc(queue, check_work_cb, &works[i][j]);
+            furi_work_set_priority(works[i][j].work, j % 3);
+        }
+        pthread_create(&submitters[i], NULL, check_submitter, works[i]);
+    }
+
+    furi_delay_tick(seconds * 1000);
+    atomic_store(&check_stop, true);
+    for(size_t i = 0; i < CHECK_SUBMITTERS; i++) {
+        pthread_join(submitters[i], NULL);
+    }
+
+    unsigned long runs = 0, resubmits = 0;
+    for(size_t i = 0; i < CHECK_SUBMITTERS; i++) {
+        for(size_t j = 0; j < CHECK_WORKS_PER_SUBMITTER; j++) {
+            furi_work_free(works[i][j].work);
+            CHECK(!atomic_load(&works[i][j].active));
+            runs += atomic_load(&works[i][j].runs);
+            resubmits += atomic_load(&works[i][j].resubmits);
+        }
+    }
+    furi_work_queue_free(queue);
+
+    printf(
+        "runs %lu, resubmits from callback %lu, overlapping runs %lu, running after cancel %lu\n",
+        runs,
+        resubmits,
+        atomic_load(&check_overlaps),
+        atomic_load(&check_late));
+    CHECK(runs > 0);
+    CHECK(!atomic_load(&check_overlaps));
+    CHECK(!atomic_load(&check_late));
+}
+
+static int check_main(unsigned seconds) {
+    check_priority();
+    check_concurrent(seconds);
+    printf("%s\n", check_failures ? "FAILED" : "OK");
+    return check_failures ? 1 : 0;
+}
+
+/* Bench */
+
+typedef struct {
+    FuriSemaphore* request;
+    FuriSemaphore* response;
+    uint64_t submitted;
+    uint64_t started;
+    bool stop;
+} BenchPing;
+
+static void bench_work_cb(void* context) {
+    BenchPing* ping = context;
+    ping->started = bench_now_ns();
+    furi_semaphore_release(ping->response);
+}
+
+static int32_t bench_thread(void* context) {
+    BenchPing* ping = context;
+    while(true) {
+        furi_semaphore_acquire(ping->request, FuriWaitForever);
+        if(ping->stop) break;
+        ping->started = bench_now_ns();
+        furi_semaphore_release(ping->response);
+    }
+    return 0;
+}
+
+static int bench_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_print(const char* name, uint64_t* samples) {
+    qsort(samples, BENCH_ROUNDS, sizeof(uint64_t), bench_compare);
+    printf(
+        "%-10s %9.2f %9.2f %9.2f\n",
+        name,
+        samples[BENCH_ROUNDS / 2] / 1000.0,
+        samples[BENCH_ROUNDS * 99 / 100] / 1000.0,
+        samples[BENCH_ROUNDS - 1] / 1000.0);
+}
+
+static int bench_main(void) {
+    static uint64_t samples[BENCH_ROUNDS];
+    BenchPing ping = {
+        .request = furi_semaphore_alloc(1, 0),
+        .response = furi_semaphore_alloc(1, 0),
+    };
+
+    printf("%-10s %9s %9s %9s\n", "wakeup", "p50 us", "p99 us", "max us");
+
+    FuriThread* thread = furi_thread_alloc_ex("Bench", BENCH_STACK_SIZE, bench_thread, &ping);
+    furi_thread_start(thread);
+    for(size_t i = 0; i < BENCH_ROUNDS; i++) {
+        ping.submitted = bench_now_ns();
+        furi_semaphore_release(ping.request);
+        furi_semaphore_acquire(ping.response, FuriWaitForever);
+        samples[i] = ping.started - ping.submitted;
+    }
+    ping.stop = true;
+    furi_semaphore_release(ping.request);
+    furi_thread_join(thread);
+    furi_thread_free(thread);
+    bench_print("thread", samples);
+
+    FuriWorkQueue* queue = furi_work_queue_alloc("Bench", 2, BENCH_STACK_SIZE);
+    FuriWork* work = furi_work_alloc(queue, bench_work_cb, &ping);
+    for(size_t i = 0; i < BENCH_ROUNDS; i++) {
+        ping.submitted = bench_now_ns();
+        furi_work_submit(work);
+        furi_semaphore_acquire(ping.response, FuriWaitForever);
+        samples[i] = ping.started - ping.submitted;
+    }
+    furi_work_free(work);
+    furi_work_queue_free(queue);
+    bench_print("work", samples);
+
+    furi_semaphore_free(ping.request);
+    furi_semaphore_free(ping.response);
+
+    printf("\nStack reserved on device, %d bytes each:\n", BENCH_STACK_SIZE);
+    for(size_t workers = 1; workers <= 4; workers++) {
+        printf(
+            "%zu concurrent workers: dedicated threads %5zu, system queue %5d\n",
+            workers,
+            workers * BENCH_STACK_SIZE,
+            2 * BENCH_STACK_SIZE);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "check") == 0) {
+        return check_main(argc > 2 ? (unsigned)atoi(argv[2]) : 5);
+    } else if(argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main();
+    }
+
+    printf("Usage: %s check [seconds] | bench\n", argv[0]);
+    return 1;
+}